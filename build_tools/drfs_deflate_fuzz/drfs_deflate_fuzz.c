@@ -0,0 +1,320 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Fuzzes the deflate encoder behind DRFS_COMPRESSED files. Each iteration generates some data, writes it through dr_fs
+// in randomly sized pieces, and then checks the file two ways:
+//
+// - The raw file is decompressed with zlib, which is the reference implementation of deflate and gzip and shares no
+//   code with dr_fs. It has to decompress without error, end exactly at the end of the file and give back the original
+//   data. This is what catches encoder bugs that dr_fs' own decoder happens to agree with.
+// - The file is read back through dr_fs with DRFS_COMPRESSED, which covers tinfl and the gzip trailer checks.
+//
+// The data is a mix of random bytes, long runs, small alphabets, text and repeats at distances near the edge of the
+// window, since those are what exercise the match finder, the block splitting and the stored block fallback.
+//
+// Building (zlib is only needed by this tool, not by the engine):
+//
+//     gcc -O2 -std=gnu99 drfs_deflate_fuzz.c -o drfs_deflate_fuzz -lz
+//
+// Usage:
+//
+//     drfs_deflate_fuzz [iterations] [seed] [temp directory]
+//
+// Returns 0 if every iteration passed.
+
+#define DR_FS_IMPLEMENTATION
+#include "../../source/external/dr_fs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define FUZZ_MAX_SIZE   (1024*1024)
+
+static uint64_t g_rngState;
+
+static uint32_t fuzz_rand()
+{
+    // xorshift64*
+    g_rngState ^= g_rngState >> 12;
+    g_rngState ^= g_rngState << 25;
+    g_rngState ^= g_rngState >> 27;
+    return (uint32_t)((g_rngState * 2685821657736338717ULL) >> 32);
+}
+
+static uint32_t fuzz_rand_range(uint32_t count)
+{
+    return (count == 0) ? 0 : fuzz_rand() % count;
+}
+
+// Picks a size, biased towards small sizes and sizes around the encoder's internal buffer boundaries.
+static size_t fuzz_pick_size()
+{
+    switch (fuzz_rand_range(4))
+    {
+        case 0:  return fuzz_rand_range(300);
+        case 1:  return fuzz_rand_range(70000);
+        case 2:  return (size_t)(1 << (15 + fuzz_rand_range(5))) + fuzz_rand_range(64) - 32;
+        default: return fuzz_rand_range(FUZZ_MAX_SIZE);
+    }
+}
+
+static const char* g_fuzzWords[] = {
+    "the ", "game ", "engine ", "vertex ", "texture ", "{\n", "}\n", "    ", "return ", "0.000000 ", "drge_", "\n"
+};
+
+static const char* fuzz_generate(uint8_t* pData, size_t size)
+{
+    int kind = (int)fuzz_rand_range(7);
+    size_t i = 0;
+
+    switch (kind)
+    {
+        case 0:
+        {
+            for (i = 0; i < size; ++i) {
+                pData[i] = (uint8_t)fuzz_rand();
+            }
+            return "random";
+        }
+
+        case 1:
+        {
+            while (i < size) {
+                uint8_t value = (uint8_t)fuzz_rand_range(3);
+                size_t runLength = 1 + fuzz_rand_range((fuzz_rand_range(4) == 0) ? 2000 : 20);
+                for (size_t j = 0; j < runLength && i < size; ++j) {
+                    pData[i++] = value;
+                }
+            }
+            return "runs";
+        }
+
+        case 2:
+        {
+            uint32_t alphabetSize = 2 + fuzz_rand_range(6);
+            for (i = 0; i < size; ++i) {
+                pData[i] = (uint8_t)('a' + fuzz_rand_range(alphabetSize));
+            }
+            return "alphabet";
+        }
+
+        case 3:
+        {
+            while (i < size) {
+                const char* word = g_fuzzWords[fuzz_rand_range(sizeof(g_fuzzWords) / sizeof(g_fuzzWords[0]))];
+                for (size_t j = 0; word[j] != '\0' && i < size; ++j) {
+                    pData[i++] = (uint8_t)word[j];
+                }
+            }
+            return "text";
+        }
+
+        case 4:
+        {
+            // Random data repeated at distances near the edge of the 32 KB window, with the odd mutation.
+            size_t period = 32768 - 64 + fuzz_rand_range(128);
+            for (i = 0; i < size; ++i) {
+                if (i < period || fuzz_rand_range(5000) == 0) {
+                    pData[i] = (uint8_t)fuzz_rand();
+                } else {
+                    pData[i] = pData[i - period];
+                }
+            }
+            return "far repeats";
+        }
+
+        case 5:
+        {
+            // Copies of earlier data of every length, including ones longer than the longest match.
+            while (i < size) {
+                if (i > 0 && fuzz_rand_range(2) == 0) {
+                    size_t dist = 1 + fuzz_rand_range((uint32_t)(i < 32768 ? i : 32768));
+                    size_t length = 3 + fuzz_rand_range(300);
+                    for (size_t j = 0; j < length && i < size; ++j, ++i) {
+                        pData[i] = pData[i - dist];
+                    }
+                } else {
+                    pData[i++] = (uint8_t)fuzz_rand();
+                }
+            }
+            return "copies";
+        }
+
+        default:
+        {
+            // Alternating stretches of compressible and incompressible data, which is what makes the encoder choose
+            // between dynamic and stored blocks.
+            while (i < size) {
+                size_t length = 1 + fuzz_rand_range(40000);
+                bool isRandom = fuzz_rand_range(2) == 0;
+                for (size_t j = 0; j < length && i < size; ++j, ++i) {
+                    pData[i] = isRandom ? (uint8_t)fuzz_rand() : (uint8_t)(j & 0x0F);
+                }
+            }
+            return "mixed";
+        }
+    }
+}
+
+static bool fuzz_write_compressed(drfs_context* pContext, const char* path, const uint8_t* pData, size_t size)
+{
+    drfs_file* pFile;
+    if (drfs_open(pContext, path, DRFS_WRITE | DRFS_TRUNCATE | DRFS_COMPRESSED, &pFile) != drfs_success) {
+        printf("Failed to open %s for writing.\n", path);
+        return false;
+    }
+
+    bool result = true;
+    size_t offset = 0;
+    while (offset < size)
+    {
+        size_t chunkSize = (fuzz_rand_range(3) == 0) ? 1 + fuzz_rand_range(16) : 1 + fuzz_rand_range(65536);
+        if (chunkSize > size - offset) {
+            chunkSize = size - offset;
+        }
+
+        size_t bytesWritten;
+        if (drfs_write(pFile, pData + offset, chunkSize, &bytesWritten) != drfs_success || bytesWritten != chunkSize) {
+            printf("Failed to write to %s.\n", path);
+            result = false;
+            break;
+        }
+
+        offset += chunkSize;
+    }
+
+    drfs_close(pFile);
+    return result;
+}
+
+static uint8_t* fuzz_read_file(drfs_context* pContext, const char* path, unsigned int accessMode, size_t maxSize, size_t* pSizeOut)
+{
+    drfs_file* pFile;
+    if (drfs_open(pContext, path, DRFS_READ | accessMode, &pFile) != drfs_success) {
+        return NULL;
+    }
+
+    uint8_t* pData = malloc(maxSize + 1);
+    size_t size = 0;
+    for (;;)
+    {
+        size_t bytesRead;
+        if (drfs_read(pFile, pData + size, maxSize + 1 - size, &bytesRead) != drfs_success || bytesRead == 0) {
+            break;
+        }
+
+        size += bytesRead;
+        if (size == maxSize + 1) {
+            break;
+        }
+    }
+
+    drfs_close(pFile);
+
+    *pSizeOut = size;
+    return pData;
+}
+
+static bool fuzz_check_with_zlib(const uint8_t* pCompressed, size_t compressedSize, const uint8_t* pExpected, size_t expectedSize)
+{
+    uint8_t* pDecompressed = malloc(expectedSize + 1);
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) {     // 15 + 16 means gzip with a 32 KB window.
+        free(pDecompressed);
+        return false;
+    }
+
+    zs.next_in   = (Bytef*)pCompressed;
+    zs.avail_in  = (uInt)compressedSize;
+    zs.next_out  = pDecompressed;
+    zs.avail_out = (uInt)(expectedSize + 1);
+    int zresult = inflate(&zs, Z_FINISH);
+
+    bool result = true;
+    if (zresult != Z_STREAM_END) {
+        printf("  zlib: inflate returned %d (%s).\n", zresult, (zs.msg != NULL) ? zs.msg : "no message");
+        result = false;
+    } else if (zs.avail_in != 0) {
+        printf("  zlib: %u bytes left over after the end of the stream.\n", zs.avail_in);
+        result = false;
+    } else if (zs.total_out != expectedSize || memcmp(pDecompressed, pExpected, expectedSize) != 0) {
+        printf("  zlib: decompressed %lu bytes that don't match the original %zu bytes.\n", zs.total_out, expectedSize);
+        result = false;
+    }
+
+    inflateEnd(&zs);
+    free(pDecompressed);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int iterationCount = (argc > 1) ? (unsigned int)strtoul(argv[1], NULL, 10) : 1000;
+    uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+    const char* tempDir = (argc > 3) ? argv[3] : "/tmp";
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/drfs_deflate_fuzz.gz", tempDir);
+
+    drfs_context* pContext = drfs_create_context();
+    if (pContext == NULL) {
+        return 1;
+    }
+
+    uint8_t* pData = malloc(FUZZ_MAX_SIZE);
+    unsigned int failureCount = 0;
+    unsigned long long totalSize = 0;
+    unsigned long long totalCompressedSize = 0;
+
+    for (unsigned int iIteration = 0; iIteration < iterationCount; ++iIteration)
+    {
+        // Every iteration gets it's own seed so a failure can be reproduced on it's own.
+        g_rngState = (seed * 0x9E3779B97F4A7C15ULL) ^ (iIteration + 1);
+        if (g_rngState == 0) {
+            g_rngState = 1;
+        }
+
+        size_t size = fuzz_pick_size();
+        const char* kind = fuzz_generate(pData, size);
+
+        bool passed = fuzz_write_compressed(pContext, path, pData, size);
+
+        size_t compressedSize = 0;
+        uint8_t* pCompressed = NULL;
+        if (passed) {
+            pCompressed = fuzz_read_file(pContext, path, 0, FUZZ_MAX_SIZE * 2, &compressedSize);
+            passed = pCompressed != NULL && fuzz_check_with_zlib(pCompressed, compressedSize, pData, size);
+        }
+
+        if (passed) {
+            size_t readBackSize;
+            uint8_t* pReadBack = fuzz_read_file(pContext, path, DRFS_COMPRESSED, FUZZ_MAX_SIZE, &readBackSize);
+            if (pReadBack == NULL || readBackSize != size || memcmp(pReadBack, pData, size) != 0) {
+                printf("  dr_fs: reading back with DRFS_COMPRESSED gave %zu bytes that don't match the original.\n", readBackSize);
+                passed = false;
+            }
+
+            free(pReadBack);
+        }
+
+        if (!passed) {
+            printf("FAILED: iteration %u, seed %llu, %s data, %zu bytes.\n", iIteration, (unsigned long long)seed, kind, size);
+            failureCount += 1;
+        }
+
+        totalSize           += size;
+        totalCompressedSize += compressedSize;
+        free(pCompressed);
+    }
+
+    printf("%u of %u iterations passed. %llu bytes compressed to %llu bytes.\n", iterationCount - failureCount, iterationCount, totalSize, totalCompressedSize);
+
+    drfs_delete_file(pContext, path);
+    drfs_delete_context(pContext);
+    free(pData);
+
+    return (failureCount == 0) ? 0 : 1;
+}
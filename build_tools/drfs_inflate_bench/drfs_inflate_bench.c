@@ -0,0 +1,241 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Measures how fast files are read out of Zip archives through dr_fs, which is dominated by inflating and the CRC-32
+// check. Every file in each archive is read in full, several times over, and the best pass is reported in MB/s of
+// uncompressed data.
+//
+// The fast inflate path is chosen at compile time, so build this twice and run both on the same archives to compare it
+// against the original byte-at-a-time loop from miniz:
+//
+//     gcc -O2 -std=gnu99 drfs_inflate_bench.c -o drfs_inflate_bench_fast
+//     gcc -O2 -std=gnu99 -DDR_FS_NO_FAST_INFLATE drfs_inflate_bench.c -o drfs_inflate_bench_slow
+//
+// Usage:
+//
+//     drfs_inflate_bench [--passes N] <archive.zip> [archive.zip ...]
+//
+// Archives must have the .zip extension for dr_fs to open them.
+
+#define DR_FS_IMPLEMENTATION
+#include "../../source/external/dr_fs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    char** ppPaths;
+    size_t count;
+    size_t capacity;
+    uint64_t totalSize;
+} bench_file_list;
+
+static double bench_get_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static void bench_add_file(bench_file_list* pList, const char* relativePath, uint64_t size)
+{
+    if (pList->count == pList->capacity) {
+        pList->capacity = (pList->capacity == 0) ? 256 : pList->capacity * 2;
+        pList->ppPaths  = realloc(pList->ppPaths, pList->capacity * sizeof(*pList->ppPaths));
+    }
+
+    pList->ppPaths[pList->count++] = strdup(relativePath);
+    pList->totalSize += size;
+}
+
+static uint32_t bench_read_u16(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t bench_read_u32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Collects the path of every file in the archive from it's central directory. This doesn't use drfs_begin() because
+// dr_fs can't iterate over directories that are only implied by the paths of the files in them, which is how most
+// tools write Zip files.
+static bool bench_gather_files(const char* archivePath, bench_file_list* pList)
+{
+    FILE* pFile = fopen(archivePath, "rb");
+    if (pFile == NULL) {
+        return false;
+    }
+
+    fseek(pFile, 0, SEEK_END);
+    long fileSize = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+
+    uint8_t* pData = malloc(fileSize);
+    bool result = fread(pData, 1, fileSize, pFile) == (size_t)fileSize;
+    fclose(pFile);
+
+    // The end of central directory record is at the end of the file, followed by a comment of up to 64 KB.
+    long eocdPos = -1;
+    for (long pos = fileSize - 22; result && pos >= 0 && pos >= fileSize - 22 - 65535; --pos) {
+        if (bench_read_u32(pData + pos) == 0x06054b50) {
+            eocdPos = pos;
+            break;
+        }
+    }
+
+    if (eocdPos == -1) {
+        free(pData);
+        return false;
+    }
+
+    uint32_t entryCount = bench_read_u16(pData + eocdPos + 10);
+    uint32_t entryPos   = bench_read_u32(pData + eocdPos + 16);
+    for (uint32_t iEntry = 0; iEntry < entryCount; ++iEntry)
+    {
+        if (entryPos + 46 > (uint32_t)fileSize || bench_read_u32(pData + entryPos) != 0x02014b50) {
+            break;
+        }
+
+        uint32_t uncompressedSize = bench_read_u32(pData + entryPos + 24);
+        uint32_t nameLength       = bench_read_u16(pData + entryPos + 28);
+        uint32_t extraLength      = bench_read_u16(pData + entryPos + 30);
+        uint32_t commentLength    = bench_read_u16(pData + entryPos + 32);
+
+        char name[DRFS_MAX_PATH];
+        if (nameLength > 0 && nameLength < sizeof(name)) {
+            memcpy(name, pData + entryPos + 46, nameLength);
+            name[nameLength] = '\0';
+            if (name[nameLength - 1] != '/') {
+                bench_add_file(pList, name, uncompressedSize);
+            }
+        }
+
+        entryPos += 46 + nameLength + extraLength + commentLength;
+    }
+
+    free(pData);
+    return true;
+}
+
+// Reads every file in the list. Returns the number of bytes read, which is 0 if anything failed.
+static uint64_t bench_read_files(drfs_archive* pArchive, const bench_file_list* pList, void* pBuffer, size_t bufferSize)
+{
+    uint64_t totalBytesRead = 0;
+    for (size_t iFile = 0; iFile < pList->count; ++iFile)
+    {
+        drfs_file* pFile;
+        if (drfs_open_file_from_archive(pArchive, pList->ppPaths[iFile], DRFS_READ, &pFile) != drfs_success) {
+            printf("Failed to open %s\n", pList->ppPaths[iFile]);
+            return 0;
+        }
+
+        // dr_fs reports reading at the end of the file as an error, so only read up to the size.
+        uint64_t bytesRemaining = drfs_size(pFile);
+        while (bytesRemaining > 0)
+        {
+            size_t bytesToRead = (bytesRemaining < bufferSize) ? (size_t)bytesRemaining : bufferSize;
+            size_t bytesRead;
+            if (drfs_read(pFile, pBuffer, bytesToRead, &bytesRead) != drfs_success || bytesRead == 0) {
+                printf("Failed to read %s\n", pList->ppPaths[iFile]);
+                drfs_close(pFile);
+                return 0;
+            }
+
+            totalBytesRead += bytesRead;
+            bytesRemaining -= bytesRead;
+        }
+
+        drfs_close(pFile);
+    }
+
+    return totalBytesRead;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int passCount = 5;
+    int firstArchive = 1;
+    if (argc > 2 && strcmp(argv[1], "--passes") == 0) {
+        passCount = (unsigned int)strtoul(argv[2], NULL, 10);
+        firstArchive = 3;
+    }
+
+    if (firstArchive >= argc) {
+        printf("Usage: drfs_inflate_bench [--passes N] <archive.zip> [archive.zip ...]\n");
+        return 1;
+    }
+
+#ifdef DR_FS_NO_FAST_INFLATE
+    printf("Fast inflate path: off\n");
+#else
+    printf("Fast inflate path: on\n");
+#endif
+
+    drfs_context* pContext = drfs_create_context();
+    if (pContext == NULL) {
+        return 1;
+    }
+
+    size_t bufferSize = 1024*1024;
+    void* pBuffer = malloc(bufferSize);
+
+    uint64_t grandTotalSize = 0;
+    double grandTotalSeconds = 0;
+
+    for (int iArg = firstArchive; iArg < argc; ++iArg)
+    {
+        const char* archivePath = argv[iArg];
+
+        bench_file_list files;
+        memset(&files, 0, sizeof(files));
+        bench_gather_files(archivePath, &files);
+
+        drfs_archive* pArchive;
+        if (files.count == 0 || drfs_open_archive(pContext, archivePath, DRFS_READ, &pArchive) != drfs_success) {
+            printf("%s: could not be opened, or has no files.\n", archivePath);
+            continue;
+        }
+
+        // The first pass is a warm up so the archive is in the page cache.
+        double bestSeconds = 0;
+        for (unsigned int iPass = 0; iPass <= passCount; ++iPass)
+        {
+            double startSeconds = bench_get_seconds();
+            uint64_t bytesRead = bench_read_files(pArchive, &files, pBuffer, bufferSize);
+            double seconds = bench_get_seconds() - startSeconds;
+
+            if (bytesRead != files.totalSize) {
+                printf("%s: read %llu bytes, expected %llu.\n", archivePath, (unsigned long long)bytesRead, (unsigned long long)files.totalSize);
+                break;
+            }
+
+            if (iPass > 0 && (bestSeconds == 0 || seconds < bestSeconds)) {
+                bestSeconds = seconds;
+            }
+        }
+
+        if (bestSeconds > 0) {
+            printf("%s: %zu files, %.1f MB, %.1f ms, %.1f MB/s\n", archivePath, files.count, files.totalSize / 1000000.0, bestSeconds * 1000, files.totalSize / 1000000.0 / bestSeconds);
+            grandTotalSize    += files.totalSize;
+            grandTotalSeconds += bestSeconds;
+        }
+
+        drfs_close_archive(pArchive);
+        for (size_t iFile = 0; iFile < files.count; ++iFile) {
+            free(files.ppPaths[iFile]);
+        }
+        free(files.ppPaths);
+    }
+
+    if (grandTotalSeconds > 0) {
+        printf("Total: %.1f MB, %.1f MB/s\n", grandTotalSize / 1000000.0, grandTotalSize / 1000000.0 / grandTotalSeconds);
+    }
+
+    free(pBuffer);
+    drfs_delete_context(pContext);
+    return 0;
+}
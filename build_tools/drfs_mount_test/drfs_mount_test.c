@@ -0,0 +1,226 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Checks that files in a mounted Zip archive can be found through the mount index. The archive is written by hand
+// without entries for it's directories, which is how most tools write Zip files, so every directory in it is only
+// implied by the paths of the files inside it.
+//
+// Building:
+//
+//     gcc -O2 -std=gnu99 drfs_mount_test.c -o drfs_mount_test
+//
+// Usage:
+//
+//     drfs_mount_test [temp directory]
+//
+// Returns 0 if every check passed.
+
+#define DR_FS_IMPLEMENTATION
+#include "../../source/external/dr_fs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    const char* path;
+    const char* content;
+} test_zip_entry;
+
+static const test_zip_entry g_testEntries[] = {
+    {"readme.txt",                      "readme"},
+    {"textures/wall.txt",               "wall"},
+    {"textures/stone/floor.txt",        "floor"},
+    {"textures/stone/moss/rock.txt",    "rock"}
+};
+
+#define TEST_ENTRY_COUNT    (sizeof(g_testEntries) / sizeof(g_testEntries[0]))
+
+static unsigned int g_failureCount = 0;
+
+static void test_write_u16(FILE* pFile, uint32_t value)
+{
+    fputc(value & 0xFF, pFile);
+    fputc((value >> 8) & 0xFF, pFile);
+}
+
+static void test_write_u32(FILE* pFile, uint32_t value)
+{
+    test_write_u16(pFile, value & 0xFFFF);
+    test_write_u16(pFile, value >> 16);
+}
+
+// Writes a Zip file with every entry stored uncompressed and no entries for directories.
+static bool test_write_zip(const char* path)
+{
+    FILE* pFile = fopen(path, "wb");
+    if (pFile == NULL) {
+        return false;
+    }
+
+    uint32_t localHeaderOffsets[TEST_ENTRY_COUNT];
+    for (size_t iEntry = 0; iEntry < TEST_ENTRY_COUNT; ++iEntry)
+    {
+        const test_zip_entry* pEntry = &g_testEntries[iEntry];
+        uint32_t size = (uint32_t)strlen(pEntry->content);
+        uint32_t crc  = (uint32_t)drfs_mz_crc32(MZ_CRC32_INIT, (const mz_uint8*)pEntry->content, size);
+
+        localHeaderOffsets[iEntry] = (uint32_t)ftell(pFile);
+        test_write_u32(pFile, 0x04034b50);
+        test_write_u16(pFile, 20);      // Version needed to extract.
+        test_write_u16(pFile, 0);       // Flags.
+        test_write_u16(pFile, 0);       // Stored.
+        test_write_u16(pFile, 0);       // Time.
+        test_write_u16(pFile, 0x21);    // Date.
+        test_write_u32(pFile, crc);
+        test_write_u32(pFile, size);
+        test_write_u32(pFile, size);
+        test_write_u16(pFile, (uint32_t)strlen(pEntry->path));
+        test_write_u16(pFile, 0);       // Extra field length.
+        fputs(pEntry->path, pFile);
+        fwrite(pEntry->content, 1, size, pFile);
+    }
+
+    uint32_t centralDirectoryOffset = (uint32_t)ftell(pFile);
+    for (size_t iEntry = 0; iEntry < TEST_ENTRY_COUNT; ++iEntry)
+    {
+        const test_zip_entry* pEntry = &g_testEntries[iEntry];
+        uint32_t size = (uint32_t)strlen(pEntry->content);
+        uint32_t crc  = (uint32_t)drfs_mz_crc32(MZ_CRC32_INIT, (const mz_uint8*)pEntry->content, size);
+
+        test_write_u32(pFile, 0x02014b50);
+        test_write_u16(pFile, 20);      // Version made by.
+        test_write_u16(pFile, 20);      // Version needed to extract.
+        test_write_u16(pFile, 0);       // Flags.
+        test_write_u16(pFile, 0);       // Stored.
+        test_write_u16(pFile, 0);       // Time.
+        test_write_u16(pFile, 0x21);    // Date.
+        test_write_u32(pFile, crc);
+        test_write_u32(pFile, size);
+        test_write_u32(pFile, size);
+        test_write_u16(pFile, (uint32_t)strlen(pEntry->path));
+        test_write_u16(pFile, 0);       // Extra field length.
+        test_write_u16(pFile, 0);       // Comment length.
+        test_write_u16(pFile, 0);       // Disk number.
+        test_write_u16(pFile, 0);       // Internal attributes.
+        test_write_u32(pFile, 0);       // External attributes.
+        test_write_u32(pFile, localHeaderOffsets[iEntry]);
+        fputs(pEntry->path, pFile);
+    }
+
+    uint32_t centralDirectorySize = (uint32_t)ftell(pFile) - centralDirectoryOffset;
+    test_write_u32(pFile, 0x06054b50);
+    test_write_u16(pFile, 0);
+    test_write_u16(pFile, 0);
+    test_write_u16(pFile, TEST_ENTRY_COUNT);
+    test_write_u16(pFile, TEST_ENTRY_COUNT);
+    test_write_u32(pFile, centralDirectorySize);
+    test_write_u32(pFile, centralDirectoryOffset);
+    test_write_u16(pFile, 0);           // Comment length.
+
+    bool result = ferror(pFile) == 0;
+    fclose(pFile);
+    return result;
+}
+
+static void test_check_file(drfs_context* pContext, const char* path, const char* expectedContent)
+{
+    drfs_file* pFile;
+    drfs_result result = drfs_open(pContext, path, DRFS_READ, &pFile);
+    if (result != drfs_success) {
+        printf("FAILED: Opening \"%s\" returned %d.\n", path, result);
+        g_failureCount += 1;
+        return;
+    }
+
+    char content[64];
+    size_t expectedSize = strlen(expectedContent);
+    size_t bytesRead = 0;
+    if (drfs_size(pFile) != expectedSize || drfs_read(pFile, content, expectedSize, &bytesRead) != drfs_success || bytesRead != expectedSize || memcmp(content, expectedContent, expectedSize) != 0) {
+        printf("FAILED: \"%s\" doesn't have the expected content.\n", path);
+        g_failureCount += 1;
+    }
+
+    drfs_close(pFile);
+}
+
+static void test_check_directory(drfs_context* pContext, const char* zipPath, const char* path, unsigned int expectedChildCount)
+{
+    drfs_file_info fi;
+    if (drfs_get_file_info(pContext, path, &fi) != drfs_success || (fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0) {
+        printf("FAILED: \"%s\" isn't reported as a directory.\n", path);
+        g_failureCount += 1;
+    }
+
+    // Iteration doesn't go through mount points, so the directory is iterated inside the archive. The implied
+    // directories are found once for each file inside them, but must only be listed once.
+    char absolutePath[DRFS_MAX_PATH];
+    snprintf(absolutePath, sizeof(absolutePath), "%s/%s", zipPath, path);
+
+    drfs_iterator iterator;
+    unsigned int childCount = 0;
+    if (drfs_begin(pContext, absolutePath, &iterator)) {
+        do {
+            childCount += 1;
+        } while (drfs_next(pContext, &iterator));
+
+        drfs_end(pContext, &iterator);
+    }
+
+    if (childCount != expectedChildCount) {
+        printf("FAILED: \"%s\" has %u children, expected %u.\n", path, childCount, expectedChildCount);
+        g_failureCount += 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* tempDir = (argc > 1) ? argv[1] : "/tmp";
+
+    char zipPath[4096];
+    snprintf(zipPath, sizeof(zipPath), "%s/drfs_mount_test.zip", tempDir);
+    if (!test_write_zip(zipPath)) {
+        printf("Failed to write %s.\n", zipPath);
+        return 1;
+    }
+
+    drfs_context* pContext = drfs_create_context();
+    if (pContext == NULL) {
+        return 1;
+    }
+
+    drfs_result result = drfs_mount(pContext, zipPath, 0);
+    if (result != drfs_success) {
+        printf("FAILED: Mounting %s returned %d.\n", zipPath, result);
+        g_failureCount += 1;
+    } else {
+        for (size_t iEntry = 0; iEntry < TEST_ENTRY_COUNT; ++iEntry) {
+            test_check_file(pContext, g_testEntries[iEntry].path, g_testEntries[iEntry].content);
+        }
+
+        // Paths are normalized before they're looked up in the index.
+        test_check_file(pContext, "./textures/wall.txt",                "wall");
+        test_check_file(pContext, "textures/stone/../wall.txt",         "wall");
+        test_check_file(pContext, "textures//stone/./moss/rock.txt",    "rock");
+        test_check_file(pContext, "textures\\stone\\floor.txt",         "floor");
+
+        drfs_file* pFile;
+        if (drfs_open(pContext, "../textures/wall.txt", DRFS_READ, &pFile) == drfs_success) {
+            printf("FAILED: \"../textures/wall.txt\" was found even though it's outside of the mount point.\n");
+            g_failureCount += 1;
+            drfs_close(pFile);
+        }
+
+        test_check_directory(pContext, zipPath, "textures",          2);
+        test_check_directory(pContext, zipPath, "textures/stone",    2);
+    }
+
+    drfs_delete_context(pContext);
+    remove(zipPath);
+
+    if (g_failureCount == 0) {
+        printf("All checks passed.\n");
+    }
+
+    return (g_failureCount == 0) ? 0 : 1;
+}
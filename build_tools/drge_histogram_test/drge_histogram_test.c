@@ -0,0 +1,130 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Checks the edges of the frame time histograms: samples of zero, samples too big for the buckets, and that every value
+// from 0 to the largest 64-bit integer lands in a bucket that's in range and in order.
+//
+// This includes the whole engine the same way a game does, so it's built with the same libraries:
+//
+//     gcc -O2 -std=gnu99 drge_histogram_test.c -o drge_histogram_test -lX11 -lpthread -ldl -lm
+//
+// Returns 0 if every check passed. A bucketing bug that loops forever is caught by a timeout.
+
+#define DR_GE_DISABLE_EDITOR
+#include "../../dr_ge.c"
+
+#include <limits.h>
+#include <signal.h>
+
+static unsigned int g_failureCount = 0;
+
+static void test_check(bool condition, const char* description)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", description);
+        g_failureCount += 1;
+    }
+}
+
+static void test_on_timeout(int signal)
+{
+    (void)signal;
+    printf("FAILED: Timed out. Recording a sample probably never finished.\n");
+    exit(1);
+}
+
+static void test_bucket_indices()
+{
+    // Every power of 2 and the values either side of it, which are where the bucket boundaries are. For the smallest
+    // powers these overlap, so values are only compared with the previous one when they're bigger.
+    unsigned long long prevValue = 0;
+    unsigned int prevIndex = 0;
+    bool isInRange = true;
+    bool isInOrder = true;
+    bool isUnderUpperBound = true;
+    for (unsigned int bit = 0; bit < 64; ++bit)
+    {
+        unsigned long long values[3];
+        values[0] = (1ULL << bit) - 1;
+        values[1] = (1ULL << bit);
+        values[2] = (1ULL << bit) + 1;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            unsigned int index = drge_histogram_bucket_index(values[i]);
+            isInRange = isInRange && index < DRGE_HISTOGRAM_BUCKET_COUNT;
+            isInOrder = isInOrder && (values[i] < prevValue || index >= prevIndex);
+            if (index < DRGE_HISTOGRAM_BUCKET_COUNT - 1) {
+                isUnderUpperBound = isUnderUpperBound && values[i] < drge_histogram_bucket_upper_bound(index);
+            }
+
+            prevValue = values[i];
+            prevIndex = index;
+        }
+    }
+
+    test_check(isInRange, "A bucket index is out of range.");
+    test_check(isInOrder, "Bucket indices don't increase with the value.");
+    test_check(isUnderUpperBound, "A value is at or above the upper bound of it's bucket.");
+    test_check(drge_histogram_bucket_index(~0ULL) == DRGE_HISTOGRAM_BUCKET_COUNT - 1, "The largest value isn't in the last bucket.");
+    test_check(drge_histogram_bucket_index(0) == 0, "Zero isn't in the first bucket.");
+}
+
+static void test_zero_samples()
+{
+    drge_histogram histogram;
+    drge_init_histogram(&histogram);
+
+    for (int i = 0; i < 100; ++i) {
+        drge_histogram_record(&histogram, 0);
+    }
+    drge_histogram_record(&histogram, -5);  // Recorded as 0.
+
+    drge_histogram_summary summary;
+    drge_summarize_histogram(&histogram, &summary);
+    test_check(summary.sampleCount == 101, "Zero samples weren't all counted.");
+    test_check(summary.min == 0 && summary.max == 0 && summary.avg == 0, "The minimum, average or maximum of zero samples isn't 0.");
+    test_check(summary.p50 == 0 && summary.p99 == 0, "The percentiles of zero samples aren't capped to the maximum of 0.");
+}
+
+static void test_large_samples()
+{
+    long long tickFrequency = drge_get_tick_frequency();
+    long long samples[] = {
+        tickFrequency * 300,            // Past the start of the last bucket.
+        tickFrequency * 86400 - 1,      // Just under a day.
+        tickFrequency * 86400,          // A day, which used to turn into ~0 microseconds.
+        tickFrequency * 86400 * 365,
+        LLONG_MAX
+    };
+
+    drge_histogram histogram;
+    drge_init_histogram(&histogram);
+
+    unsigned int sampleCount = sizeof(samples) / sizeof(samples[0]);
+    for (unsigned int i = 0; i < sampleCount; ++i) {
+        drge_histogram_record(&histogram, samples[i]);
+    }
+
+    test_check(drge_atomic_load_64(&histogram.buckets[DRGE_HISTOGRAM_BUCKET_COUNT - 1]) == sampleCount, "Large samples weren't put in the last bucket.");
+    test_check(drge_atomic_load_64(&histogram.sampleCount) == sampleCount, "Large samples weren't all counted.");
+    test_check(drge_atomic_load_64(&histogram.maxTicks) == LLONG_MAX, "The maximum isn't the largest sample.");
+
+    double p99 = drge_histogram_get_percentile(&histogram, 0.99);
+    test_check(p99 > 0 && p99 <= LLONG_MAX * 1000.0 / tickFrequency, "The 99th percentile of large samples is out of range.");
+}
+
+int main()
+{
+    signal(SIGALRM, test_on_timeout);
+    alarm(10);
+
+    test_bucket_indices();
+    test_zero_samples();
+    test_large_samples();
+
+    if (g_failureCount == 0) {
+        printf("All checks passed.\n");
+    }
+
+    return (g_failureCount == 0) ? 0 : 1;
+}
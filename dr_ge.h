@@ -116,6 +116,14 @@
 #endif
 
 // dr_ge headers.
+#include "source/drge_memory.h"
+#include "source/drge_strings.h"
+#include "source/drge_logger.h"
+#include "source/drge_input.h"
+#include "source/drge_jobs.h"
+#include "source/drge_profiler.h"
+#include "source/drge_stats.h"
+#include "source/drge_replay.h"
 #include "source/drge_context.h"
 #include "source/drge_platform_layer.h"
 #include "source/drge_graphics.h"
@@ -150,6 +158,27 @@
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 #ifdef DR_GE_IMPLEMENTATION
+// Route the libraries' allocations through DRGE_MALLOC() so they're tagged and counted. See drge_memory.h.
+#define STBI_MALLOC(sz)             DRGE_MALLOC((sz), DRGE_MEMORY_TAG_ASSETS)
+#define STBI_REALLOC(p, sz)         DRGE_REALLOC((p), (sz), DRGE_MEMORY_TAG_ASSETS)
+#define STBI_FREE(p)                DRGE_FREE((p))
+#define STBIR_MALLOC(sz, c)         DRGE_MALLOC((sz), DRGE_MEMORY_TAG_ASSETS)
+#define STBIR_FREE(p, c)            DRGE_FREE((p))
+#define DRFS_MALLOC(sz)             DRGE_MALLOC((sz), DRGE_MEMORY_TAG_VFS)
+#define DRFS_CALLOC(count, sz)      DRGE_CALLOC((count), (sz), DRGE_MEMORY_TAG_VFS)
+#define DRFS_REALLOC(p, sz)         DRGE_REALLOC((p), (sz), DRGE_MEMORY_TAG_VFS)
+#define DRFS_FREE(p)                DRGE_FREE((p))
+#define DRGUI_MALLOC(sz)            DRGE_MALLOC((sz), DRGE_MEMORY_TAG_GUI)
+#define DRGUI_FREE(p)               DRGE_FREE((p))
+#define DRAUDIO_MALLOC(sz)          DRGE_MALLOC((sz), DRGE_MEMORY_TAG_AUDIO)
+#define DRAUDIO_FREE(p)             DRGE_FREE((p))
+#define DRWAV_MALLOC(sz)            DRGE_MALLOC((sz), DRGE_MEMORY_TAG_AUDIO)
+#define DRWAV_FREE(p)               DRGE_FREE((p))
+#define DRFLAC_MALLOC(sz)           DRGE_MALLOC((sz), DRGE_MEMORY_TAG_AUDIO)
+#define DRFLAC_FREE(p)              DRGE_FREE((p))
+#define DRVK_MALLOC(sz)             DRGE_MALLOC((sz), DRGE_MEMORY_TAG_GRAPHICS)
+#define DRVK_FREE(p)                DRGE_FREE((p))
+
 // stb_image
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_NO_STDIO
@@ -171,6 +200,14 @@
 // dr_ge source files.
 #include "source/drge_context.c"
 #include "source/drge_platform_layer.c"
+#include "source/drge_logger.c"
+#include "source/drge_memory.c"
+#include "source/drge_strings.c"
+#include "source/drge_input.c"
+#include "source/drge_jobs.c"
+#include "source/drge_profiler.c"
+#include "source/drge_stats.c"
+#include "source/drge_replay.c"
 #include "source/drge_graphics.c"
 #include "source/drge_assets.c"
 
@@ -86,7 +86,7 @@ drge_asset* drge__load_image_asset_from_file(drge_context* pContext, drfs_file*
     }
 
     size_t imageDataSize = imageWidth*imageHeight*4;
-    drge_image_asset* pImageAsset = malloc(sizeof(drge_image_asset) - sizeof(pImageAsset->pImageData) + imageDataSize);
+    drge_image_asset* pImageAsset = DRGE_LARGE_ALLOC(sizeof(drge_image_asset) - sizeof(pImageAsset->pImageData) + imageDataSize, DRGE_MEMORY_TAG_ASSETS);
     if (pImageAsset == NULL) {
         stbi_image_free(pImageData);
         return NULL;
@@ -111,7 +111,7 @@ void drge__unload_image_asset(drge_asset* pAsset)
         return;
     }
 
-    free(pImageAsset);
+    DRGE_FREE(pImageAsset);
 }
 
 
@@ -125,7 +125,7 @@ drge_asset* drge__load_model_asset_from_file(drge_context* pContext, drfs_file*
 
     // TODO: Implement Me.
 
-    drge_model_asset* pModelAsset = malloc(sizeof(drge_model_asset));
+    drge_model_asset* pModelAsset = DRGE_MALLOC(sizeof(drge_model_asset), DRGE_MEMORY_TAG_ASSETS);
     if (pModelAsset == NULL) {
         return NULL;
     }
@@ -143,7 +143,7 @@ void drge__unload_model_asset(drge_asset* pAsset)
         return;
     }
 
-    free(pModelAsset);
+    DRGE_FREE(pModelAsset);
 }
 
 
@@ -164,6 +164,19 @@ void drge__uncache_asset(drge_asset* pAsset)
 }
 
 
+// Frees an asset that's been loaded, whatever it's type is.
+static void drge__delete_asset(drge_asset* pAsset)
+{
+    assert(pAsset != NULL);
+
+    switch (pAsset->type)
+    {
+    case drge_asset_type_image: drge__unload_image_asset(pAsset); break;
+    case drge_asset_type_model: drge__unload_model_asset(pAsset); break;
+    default: break;
+    }
+}
+
 drge_asset* drge_load_asset(drge_context* pContext, const char* path)
 {
     drge_asset_type type = drge_get_asset_type_from_path(path);
@@ -213,7 +226,11 @@ drge_asset* drge_load_asset(drge_context* pContext, const char* path)
     pAsset->type           = type;
     pAsset->pContext       = pContext;
     pAsset->referenceCount = 0;
-    strcpy_s(pAsset->absolutePath, sizeof(pAsset->absolutePath), fi.absolutePath);
+    pAsset->pAbsolutePath  = drge_intern_string(fi.absolutePath);
+    if (pAsset->pAbsolutePath == NULL) {
+        drge__delete_asset(pAsset);  // Out of memory.
+        return NULL;
+    }
 
     // Grab the asset so that the reference counter is incremented and the asset added to the cache.
     drge_grab_asset(pAsset);
@@ -231,12 +248,7 @@ void drge_unload_asset(drge_asset* pAsset)
         return; // Reference count is still >0. Just return early.
     }
 
-    switch (pAsset->type)
-    {
-    case drge_asset_type_image: drge__unload_image_asset(pAsset); break;
-    case drge_asset_type_model: drge__unload_model_asset(pAsset); break;
-    default: break;
-    }
+    drge__delete_asset(pAsset);
 }
 
 
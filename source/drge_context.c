@@ -7,6 +7,12 @@ static void drge_load_default_config(drge_context* pContext)
     }
 
     strcpy_s(pContext->name, sizeof(pContext->name), "My Game");
+    drge_init_input_map(&pContext->input);
+    pContext->stepRate         = 60;
+    pContext->maxStepsPerFrame = 8;
+    pContext->maxFrameRate     = 0;
+    pContext->frameArenaSize   = 4*1024*1024;
+    pContext->windowOptions    = DRGE_WINDOW_CENTERED;
 }
 
 typedef struct
@@ -26,6 +32,85 @@ static size_t drge_load_config_read(void* pUserData, void* pDataOut, size_t byte
     return bytesRead;
 }
 
+// Parses a list of processors such as "0,2,4-7" into an affinity mask. Returns false if the list is invalid.
+static bool drge_parse_processor_list(const char* list, unsigned long long* pMaskOut)
+{
+    assert(list != NULL);
+    assert(pMaskOut != NULL);
+
+    unsigned long long mask = 0;
+    while (*list != '\0')
+    {
+        char* pEnd;
+        long first = strtol(list, &pEnd, 10);
+        long last  = first;
+        if (pEnd == list) {
+            return false;
+        }
+
+        list = pEnd;
+        if (*list == '-') {
+            list += 1;
+            last = strtol(list, &pEnd, 10);
+            if (pEnd == list) {
+                return false;
+            }
+
+            list = pEnd;
+        }
+
+        if (first < 0 || last > 63 || first > last) {
+            return false;
+        }
+
+        for (long i = first; i <= last; ++i) {
+            mask |= 1ULL << i;
+        }
+
+        while (*list == ',' || *list == ' ') {
+            list += 1;
+        }
+    }
+
+    *pMaskOut = mask;
+    return mask != 0;
+}
+
+// Retrieves the DRGE_THREAD_PRIORITY_* with the given name. Returns false if there isn't one.
+static bool drge_parse_thread_priority(const char* name, int* pPriorityOut)
+{
+    assert(name != NULL);
+    assert(pPriorityOut != NULL);
+
+    static const char* priorityNames[] = {"lowest", "low", "normal", "high", "highest", "realtime"};
+    for (int i = 0; i < (int)(sizeof(priorityNames)/sizeof(priorityNames[0])); ++i) {
+        if (_stricmp(name, priorityNames[i]) == 0) {
+            *pPriorityOut = DRGE_THREAD_PRIORITY_LOWEST + i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Retrieves the thread role of a config key made up of the name of a role followed by the given suffix, such as
+// "RenderThreadAffinity". Returns -1 if the key doesn't match.
+static int drge_get_thread_role_from_config_key(const char* key, const char* suffix)
+{
+    assert(key != NULL);
+    assert(suffix != NULL);
+
+    for (int role = 0; role < DRGE_THREAD_ROLE_COUNT; ++role) {
+        const char* roleName = drge_get_thread_role_name(role);
+        size_t roleNameLength = strlen(roleName);
+        if (strncmp(key, roleName, roleNameLength) == 0 && strcmp(key + roleNameLength, suffix) == 0) {
+            return role;
+        }
+    }
+
+    return -1;
+}
+
 static void drge_load_config_pair(void* pUserData, const char* key, const char* value)
 {
     drge_load_config_data* pData = pUserData;
@@ -51,6 +136,185 @@ static void drge_load_config_pair(void* pUserData, const char* key, const char*
         drfs_insert_base_directory(pVFS, absolutePath, drfs_get_base_directory_count(pVFS) - 1);
         return;
     }
+
+    if (strcmp(key, "Mount") == 0)
+    {
+        // Mount points are listed in order of priority from lowest to highest so that patches can be listed after the content
+        // they replace. Relative paths are relative to the executable's directory, which is always the last base directory.
+        drfs_context* pVFS = drge_get_vfs(pContext);
+        assert(drfs_get_base_directory_count(pVFS) > 0);
+
+        char absolutePath[DRFS_MAX_PATH];
+        drpath_to_absolute(value, drfs_get_base_directory_by_index(pVFS, drfs_get_base_directory_count(pVFS) - 1), absolutePath, sizeof(absolutePath));
+
+        if (drfs_mount(pVFS, absolutePath, (int)drfs_get_mount_count(pVFS)) != drfs_success) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Failed to mount %s", absolutePath);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "StepRate") == 0)
+    {
+        int stepRate = atoi(value);
+        if (stepRate <= 0 || stepRate > 1000) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid step rate \"%s\". Must be between 1 and 1000.", value);
+            return;
+        }
+
+        pContext->stepRate = (unsigned int)stepRate;
+        return;
+    }
+
+    if (strcmp(key, "MaxStepsPerFrame") == 0)
+    {
+        int maxStepsPerFrame = atoi(value);
+        if (maxStepsPerFrame <= 0) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid maximum steps per frame \"%s\". Must be at least 1.", value);
+            return;
+        }
+
+        pContext->maxStepsPerFrame = (unsigned int)maxStepsPerFrame;
+        return;
+    }
+
+    if (strcmp(key, "MaxFrameRate") == 0)
+    {
+        int maxFrameRate = atoi(value);
+        if (maxFrameRate < 0) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid maximum frame rate \"%s\". Must be 0 or more.", value);
+            return;
+        }
+
+        pContext->maxFrameRate = (unsigned int)maxFrameRate;
+        return;
+    }
+
+    if (strcmp(key, "HugePages") == 0)
+    {
+        if (_stricmp(value, "off") == 0) {
+            drge_set_large_page_mode(DRGE_LARGE_PAGES_OFF);
+        } else if (_stricmp(value, "transparent") == 0) {
+            drge_set_large_page_mode(DRGE_LARGE_PAGES_TRANSPARENT);
+        } else if (_stricmp(value, "explicit") == 0) {
+            drge_set_large_page_mode(DRGE_LARGE_PAGES_EXPLICIT);
+        } else {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid huge page mode \"%s\". Must be off, transparent or explicit.", value);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "FrameArenaSize") == 0)
+    {
+        int frameArenaSizeKB = atoi(value);
+        if (frameArenaSizeKB <= 0) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid frame arena size \"%s\". Must be at least 1.", value);
+            return;
+        }
+
+        pContext->frameArenaSize = (size_t)frameArenaSizeKB * 1024;
+        return;
+    }
+
+    int threadRole = drge_get_thread_role_from_config_key(key, "ThreadAffinity");
+    if (threadRole != -1)
+    {
+        drge_thread_config config;
+        drge_get_thread_config(threadRole, &config);
+
+        if (!drge_parse_processor_list(value, &config.affinityMask)) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid processor list \"%s\" for %s. Must be processor numbers or ranges between 0 and 63, such as \"0,2,4-7\".", value, key);
+            return;
+        }
+
+        config.isAffinityMaskSet        = true;
+        config.pinOneProcessorPerThread = (threadRole == DRGE_THREAD_ROLE_JOB_WORKER);
+        if (!drge_set_thread_config(threadRole, &config)) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_WARNING, DRGE_LOG_CATEGORY_CONFIG, "Failed to apply %s \"%s\". The processors may not be available to the process.", key, value);
+        }
+
+        return;
+    }
+
+    threadRole = drge_get_thread_role_from_config_key(key, "ThreadPriority");
+    if (threadRole != -1)
+    {
+        drge_thread_config config;
+        drge_get_thread_config(threadRole, &config);
+
+        if (!drge_parse_thread_priority(value, &config.priority)) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid thread priority \"%s\" for %s. Must be lowest, low, normal, high, highest or realtime.", value, key);
+            return;
+        }
+
+        config.isPrioritySet = true;
+        if (!drge_set_thread_config(threadRole, &config)) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_WARNING, DRGE_LOG_CATEGORY_CONFIG, "Failed to apply %s \"%s\". Raising the priority of a thread usually needs extra permissions.", key, value);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "WindowMode") == 0)
+    {
+        if (_stricmp(value, "windowed") == 0) {
+            pContext->windowOptions = DRGE_WINDOW_CENTERED;
+        } else if (_stricmp(value, "borderless") == 0) {
+            pContext->windowOptions = DRGE_WINDOW_FULLSCREEN | DRGE_WINDOW_BORDERLESS;
+        } else if (_stricmp(value, "fullscreen") == 0) {
+            pContext->windowOptions = DRGE_WINDOW_FULLSCREEN;
+        } else {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Invalid window mode \"%s\". Must be windowed, borderless or fullscreen.", value);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "PipelinedRendering") == 0)
+    {
+        // The command line can only turn it on.
+        if (!dr_cmdline_key_exists(&pContext->cmdline, "pipelined")) {
+            pContext->isPipelined = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "Action") == 0)
+    {
+        if (drge_input_map_add_action(&pContext->input, value) == DRGE_INVALID_INPUT_ID) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Failed to declare action \"%s\". The name is invalid or there are more than %d actions.", value, DRGE_MAX_INPUT_ACTIONS);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "Axis") == 0)
+    {
+        if (drge_input_map_add_axis(&pContext->input, value) == DRGE_INVALID_INPUT_ID) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Failed to declare axis \"%s\". The name is invalid or there are more than %d axes.", value, DRGE_MAX_INPUT_AXES);
+        }
+
+        return;
+    }
+
+    if (strcmp(key, "LogLevel") == 0)
+    {
+        // The command line takes precedence.
+        if (dr_cmdline_key_exists(&pContext->cmdline, "log-level")) {
+            return;
+        }
+
+        int level = drge_get_log_level_by_name(value);
+        if (level == -1) {
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_WARNING, DRGE_LOG_CATEGORY_CONFIG, "Unknown log level \"%s\"", value);
+            return;
+        }
+
+        drge_set_log_level(pContext, level);
+        return;
+    }
 }
 
 static void drge_load_config_error(void* pUserData, const char* message, unsigned int line)
@@ -58,7 +322,7 @@ static void drge_load_config_error(void* pUserData, const char* message, unsigne
     drge_load_config_data* pData = pUserData;
     assert(pData != NULL);
 
-    drge_errorf(pData->pContext, "[CONFIG]:%d %s", line, message);
+    drge_log_messagef(pData->pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_CONFIG, "Line %d: %s", line, message);
 }
 
 static void drge_load_config(drge_context* pContext)
@@ -98,299 +362,1701 @@ static void drge_open_log_file(drge_context* pContext)
     drpath_append(logPath, sizeof(logPath), "dr_log.log");
 
     pContext->pLogFile;
-    drfs_open(drge_get_vfs(pContext), logPath, DRFS_WRITE | DRFS_TRUNCATE | DRFS_CREATE_DIRS, &pContext->pLogFile);
+    if (drfs_open(drge_get_vfs(pContext), logPath, DRFS_WRITE | DRFS_TRUNCATE | DRFS_CREATE_DIRS, &pContext->pLogFile) == drfs_success) {
+        drge_logger_set_file(pContext->pLogger, pContext->pLogFile);
+    }
 }
 
-static drge_context* drge_create_context_cmdline(dr_cmdline cmdline)
+static bool drge_apply_log_cmdline_callback(const char* key, const char* value, void* pUserData)
 {
-    drge_init_window_system();
+    drge_context* pContext = pUserData;
+    assert(pContext != NULL);
 
-    drge_context* pContext = malloc(sizeof(*pContext));
-    if (pContext == NULL) {
-        return NULL;
+    if (strcmp(key, "log-level") == 0) {
+        int level = drge_get_log_level_by_name(value);
+        if (level != -1) {
+            drge_set_log_level(pContext, level);
+        }
     }
 
-    memset(pContext, 0, sizeof(*pContext));
-    pContext->cmdline  = cmdline;
+    if (strcmp(key, "log-category") == 0) {
+        int category = drge_get_log_category_by_name(value);
+        if (category != -1) {
+            drge_set_log_category_enabled(pContext, category, true);
+        }
+    }
 
+    return true;
+}
 
-#ifdef DR_GE_PORTABLE
-    pContext->isPortable = true;
-#else
-    pContext->isPortable = dr_cmdline_key_exists(&cmdline, "portable");
-#endif
-    pContext->isTerminalOutputDisabled = dr_cmdline_key_exists(&cmdline, "silent");
-    pContext->wantsToClose = false;
+static void drge_apply_log_cmdline(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    // When categories are listed explicitly on the command line they are the only ones that are enabled.
+    if (dr_cmdline_key_exists(&pContext->cmdline, "log-category")) {
+        pContext->logCategoryMask = 0;
+    }
+
+    dr_parse_cmdline(&pContext->cmdline, drge_apply_log_cmdline_callback, pContext);
+}
+
+static bool drge_apply_trace_cmdline_callback(const char* key, const char* value, void* pUserData)
+{
+    drge_context* pContext = pUserData;
+    assert(pContext != NULL);
+
+    if (strcmp(key, "trace") == 0) {
+        strncpy_s(pContext->tracePath, sizeof(pContext->tracePath), value, _TRUNCATE);
+    }
+
+    if (strcmp(key, "trace-first-frame") == 0) {
+        pContext->traceFirstFrame = strtoull(value, NULL, 10);
+    }
+
+    if (strcmp(key, "trace-frame-count") == 0) {
+        pContext->traceFrameCount = strtoull(value, NULL, 10);
+    }
+
+    return true;
+}
+
+static void drge_apply_trace_cmdline(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    pContext->tracePath[0]    = '\0';
+    pContext->traceFirstFrame = 0;
+    pContext->traceFrameCount = 300;
+    dr_parse_cmdline(&pContext->cmdline, drge_apply_trace_cmdline_callback, pContext);
+}
+
+// Stops the trace that was requested with --trace and writes it out.
+static void drge_finish_trace(drge_context* pContext)
+{
+    assert(pContext != NULL);
+    assert(pContext->tracePath[0] != '\0');
+
+    drge_end_trace();
+
+    drfs_file* pFile;
+    if (drfs_open(drge_get_vfs(pContext), pContext->tracePath, DRFS_WRITE | DRFS_TRUNCATE | DRFS_CREATE_DIRS, &pFile) != drfs_success) {
+        drge_errorf(pContext, "Failed to open trace file %s", pContext->tracePath);
+    } else {
+        drge_trace_stats stats;
+        if (drge_write_trace(pFile, &stats)) {
+            drge_logf(pContext, "Trace written to %s", pContext->tracePath);
+        } else {
+            drge_errorf(pContext, "Failed to write trace file %s", pContext->tracePath);
+        }
+
+        if (stats.droppedEventCount > 0) {
+            drge_warningf(pContext, "%llu trace events were dropped. Trace fewer frames, or increase DRGE_PROFILER_MAX_EVENTS_PER_THREAD.", stats.droppedEventCount);
+        }
+
+        // The GPU track is empty when the device doesn't support timestamps or the scopes were lost somewhere.
+        if (stats.gpuScopeCount == 0 && drge_atomic_load_64(&pContext->isGraphicsWorldInitialized) && pContext->pGraphicsWorld != NULL && pContext->pGraphicsWorld->timestampQueryPool != NULL) {
+            drge_warning(pContext, "The trace has no GPU scopes even though the device supports timestamps.");
+        }
+
+        drfs_close(pFile);
+    }
+
+    pContext->tracePath[0] = '\0';
+}
+
+static bool drge_apply_run_cmdline_callback(const char* key, const char* value, void* pUserData)
+{
+    drge_context* pContext = pUserData;
+    assert(pContext != NULL);
+
+    if (strcmp(key, "frames") == 0) {
+        pContext->maxFrameCount = strtoull(value, NULL, 10);
+    }
+
+    // The interval is optional.
+    if (strcmp(key, "stats") == 0) {
+        pContext->statsLogInterval = (value != NULL) ? atof(value) : 10;
+    }
+
+    // Playing back a replay takes precedence over recording one.
+    if (strcmp(key, "replay") == 0) {
+        strncpy_s(pContext->replayPath, sizeof(pContext->replayPath), value, _TRUNCATE);
+        pContext->isReplaying = true;
+    }
+
+    if (strcmp(key, "record") == 0 && !pContext->isReplaying) {
+        strncpy_s(pContext->replayPath, sizeof(pContext->replayPath), value, _TRUNCATE);
+    }
+
+    return true;
+}
+
+static const char* g_drgeFrameTimeNames[DRGE_FRAME_TIME_COUNT] = {
+    "Frame",
+    "Step",
+    "Render",
+    "Input"
+};
+
+// Writes a summary of each frame timing to the log.
+static void drge_log_frame_time_stats(drge_context* pContext, const char* label)
+{
+    assert(pContext != NULL);
+    assert(label != NULL);
+
+    for (int timing = 0; timing < DRGE_FRAME_TIME_COUNT; ++timing) {
+        drge_histogram_summary summary;
+        drge_get_frame_time_stats(pContext, timing, &summary);
+        if (summary.sampleCount == 0) {
+            continue;
+        }
+
+        drge_logf(pContext, "%s: %-6s p50 %7.3f ms, p95 %7.3f ms, p99 %7.3f ms, max %7.3f ms (avg %7.3f ms over %llu frames)",
+            label, g_drgeFrameTimeNames[timing], summary.p50, summary.p95, summary.p99, summary.max, summary.avg, summary.sampleCount);
+    }
+}
+
+// Writes the memory counters for each tag that has been used to the log. When intervalSeconds is not zero the number of
+// allocations per second since the previous call is included as well.
+static void drge_log_memory_stats(drge_context* pContext, const char* label, double intervalSeconds)
+{
+    assert(pContext != NULL);
+    assert(label != NULL);
+
+    for (int tag = 0; tag < DRGE_MEMORY_TAG_COUNT; ++tag) {
+        drge_memory_stats stats;
+        drge_get_memory_stats(tag, &stats);
+        if (stats.allocationCount == 0) {
+            continue;
+        }
+
+        if (intervalSeconds > 0) {
+            double allocationsPerSecond = (stats.allocationCount - pContext->statsAllocationCounts[tag]) / intervalSeconds;
+            drge_logf(pContext, "%s: Memory %-8s live %10.1f KB in %6lld allocations, peak %10.1f KB, %8.1f allocations per second",
+                label, drge_get_memory_tag_name(tag), stats.liveBytes / 1024.0, stats.liveAllocationCount, stats.peakBytes / 1024.0, allocationsPerSecond);
+        } else {
+            drge_logf(pContext, "%s: Memory %-8s live %10.1f KB in %6lld allocations, peak %10.1f KB, %8llu allocations in total",
+                label, drge_get_memory_tag_name(tag), stats.liveBytes / 1024.0, stats.liveAllocationCount, stats.peakBytes / 1024.0, stats.allocationCount);
+        }
+
+        pContext->statsAllocationCounts[tag] = stats.allocationCount;
+    }
+
+    drge_large_block_stats largeBlockStats;
+    drge_get_large_block_stats(&largeBlockStats);
+    if (largeBlockStats.blockCount > 0 || largeBlockStats.fallbackCount > 0) {
+        drge_logf(pContext, "%s: Memory large blocks %lld, %.1f KB mapped, %.1f KB explicit huge pages, %.1f KB transparent huge pages (%.1f KB in the process), %lld fallbacks",
+            label, largeBlockStats.blockCount, largeBlockStats.mappedBytes / 1024.0, largeBlockStats.hugePageBytes / 1024.0, largeBlockStats.transparentHugePageBytes / 1024.0,
+            largeBlockStats.processTransparentHugePageBytes / 1024.0, largeBlockStats.fallbackCount);
+    }
+}
+
+// Writes the peak usage of the frame arenas to the log, for sizing them.
+static void drge_log_frame_arena_stats(drge_context* pContext, const char* label)
+{
+    assert(pContext != NULL);
+    assert(label != NULL);
+
+    long long peakOffset = 0;
+    long long failedAllocationCount = 0;
+    for (unsigned int iArena = 0; iArena < pContext->frameArenaCount; ++iArena) {
+        if (pContext->frameArenas[iArena].peakOffset > peakOffset) {
+            peakOffset = pContext->frameArenas[iArena].peakOffset;
+        }
+
+        failedAllocationCount += pContext->frameArenas[iArena].failedAllocationCount;
+    }
+
+    if (peakOffset > 0 || failedAllocationCount > 0) {
+        drge_logf(pContext, "%s: Frame arena peak %.1f KB of %.1f KB, %lld failed allocations", label, peakOffset / 1024.0, pContext->frameArenaSize / 1024.0, failedAllocationCount);
+    }
+}
+
+#define DRGE_MAX_STARTUP_PHASES 8
+
+typedef struct
+{
+    // The name of the phase, for the log.
+    const char* name;
+
+    // The tick counts at the start and end of the phase.
+    long long startTicks;
+    long long endTicks;
+} drge_startup_phase;
+
+// Records the timing of each phase of context creation so it can be written to the log once the log file is open. Each
+// thread taking part in startup records into it's own profile.
+typedef struct
+{
+    drge_startup_phase phases[DRGE_MAX_STARTUP_PHASES];
+    unsigned int phaseCount;
+} drge_startup_profile;
+
+static unsigned int drge_begin_startup_phase(drge_startup_profile* pProfile, const char* name)
+{
+    assert(pProfile != NULL);
+    assert(pProfile->phaseCount < DRGE_MAX_STARTUP_PHASES);
+
+    unsigned int iPhase = pProfile->phaseCount++;
+    pProfile->phases[iPhase].name       = name;
+    pProfile->phases[iPhase].startTicks = drge_get_ticks();
+    pProfile->phases[iPhase].endTicks   = pProfile->phases[iPhase].startTicks;
+
+    return iPhase;
+}
+
+static void drge_end_startup_phase(drge_startup_profile* pProfile, unsigned int iPhase)
+{
+    assert(pProfile != NULL);
+    assert(iPhase < pProfile->phaseCount);
+
+    pProfile->phases[iPhase].endTicks = drge_get_ticks();
+}
+
+static void drge_log_startup_profile(drge_context* pContext, const drge_startup_profile* pProfile, const char* label)
+{
+    assert(pContext != NULL);
+    assert(pProfile != NULL);
+    assert(label != NULL);
+
+    double msPerTick = 1000.0 / drge_get_tick_frequency();
+    for (unsigned int iPhase = 0; iPhase < pProfile->phaseCount; ++iPhase) {
+        const drge_startup_phase* pPhase = &pProfile->phases[iPhase];
+        drge_log_messagef(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, "%s: %-16s %8.2f ms (at +%.2f ms)",
+            label, pPhase->name, (pPhase->endTicks - pPhase->startTicks) * msPerTick, (pPhase->startTicks - pContext->startupTicks) * msPerTick);
+    }
+}
+
+
+// Creates the Vulkan context and graphics world on the graphics init thread. See drge_begin_graphics_init().
+static int drge_init_graphics_proc(void* pUserData)
+{
+    drge_context* pContext = pUserData;
+    assert(pContext != NULL);
+
+    drge_profile_set_thread_name("Graphics init");
+    drge_set_current_thread_name("Graphics init");
+
+    drge_startup_profile profile;
+    profile.phaseCount = 0;
+
+    unsigned int iPhase = drge_begin_startup_phase(&profile, "Vulkan");
+    pContext->pVulkan = drvkCreateContext(NULL);
+    drge_end_startup_phase(&profile, iPhase);
+
+    iPhase = drge_begin_startup_phase(&profile, "Graphics world");
+    pContext->pGraphicsWorld = drge_create_graphics_world(pContext->pVulkan);
+    drge_end_startup_phase(&profile, iPhase);
+
+    drge_log_startup_profile(pContext, &profile, "Graphics");
+    return 0;
+}
+
+// Makes sure the Vulkan context has been created, waiting on the graphics init thread if it's running. When it wasn't
+// started ahead of time only the Vulkan context is created.
+//
+// This must be called with graphicsInitLock locked.
+static void drge_finish_vulkan_init_locked(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (pContext->isVulkanInitialized) {
+        return;
+    }
+
+    if (pContext->graphicsInitThread != NULL) {
+        long long waitStartTicks = drge_get_ticks();
+        dr_wait_and_delete_thread(pContext->graphicsInitThread);
+        pContext->graphicsInitThread = NULL;
+
+        drge_log_messagef(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, "Graphics: %-16s %8.2f ms", "Wait", (drge_get_ticks() - waitStartTicks) * 1000.0 / drge_get_tick_frequency());
+
+        // The thread creates the world as well.
+        drge_atomic_store_64(&pContext->isGraphicsWorldInitialized, 1);
+    } else {
+        long long startTicks = drge_get_ticks();
+        pContext->pVulkan = drvkCreateContext(NULL);
+
+        drge_log_messagef(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, "Graphics: %-16s %8.2f ms", "Vulkan", (drge_get_ticks() - startTicks) * 1000.0 / drge_get_tick_frequency());
+    }
+
+    drge_atomic_store_64(&pContext->isVulkanInitialized, 1);
+}
+
+// Makes sure the Vulkan context has been created.
+static void drge_finish_vulkan_init(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (drge_atomic_load_64(&pContext->isVulkanInitialized)) {
+        return;
+    }
+
+    dr_lock_mutex(pContext->graphicsInitLock);
+    {
+        drge_finish_vulkan_init_locked(pContext);
+    }
+    dr_unlock_mutex(pContext->graphicsInitLock);
+}
+
+// Makes sure both the Vulkan context and the graphics world have been created.
+static void drge_finish_graphics_init(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (drge_atomic_load_64(&pContext->isGraphicsWorldInitialized)) {
+        return;
+    }
+
+    dr_lock_mutex(pContext->graphicsInitLock);
+    {
+        drge_finish_vulkan_init_locked(pContext);
+
+        if (!pContext->isGraphicsWorldInitialized)
+        {
+            long long startTicks = drge_get_ticks();
+            pContext->pGraphicsWorld = drge_create_graphics_world(pContext->pVulkan);
+
+            drge_log_messagef(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, "Graphics: %-16s %8.2f ms", "Graphics world", (drge_get_ticks() - startTicks) * 1000.0 / drge_get_tick_frequency());
+            drge_atomic_store_64(&pContext->isGraphicsWorldInitialized, 1);
+        }
+    }
+    dr_unlock_mutex(pContext->graphicsInitLock);
+}
+
+// Waits for any in-progress graphics initialization and then deletes the graphics objects.
+static void drge_uninit_graphics(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (pContext->graphicsInitThread != NULL) {
+        dr_wait_and_delete_thread(pContext->graphicsInitThread);
+        pContext->graphicsInitThread = NULL;
+    }
+
+    drge_delete_graphics_world(pContext->pGraphicsWorld);
+    pContext->pGraphicsWorld = NULL;
+
+    drvkDeleteContext(pContext->pVulkan);
+    pContext->pVulkan = NULL;
+
+    pContext->isVulkanInitialized        = 0;
+    pContext->isGraphicsWorldInitialized = 0;
+}
+
+static drge_context* drge_create_context_cmdline(dr_cmdline cmdline)
+{
+    long long startupTicks = drge_get_ticks();
+
+    drge_startup_profile profile;
+    profile.phaseCount = 0;
+
+    // There's no window in headless mode so the window system is left alone. This means headless mode works on machines
+    // without a display.
+    unsigned int iPhase;
+    if (!dr_cmdline_key_exists(&cmdline, "headless")) {
+        iPhase = drge_begin_startup_phase(&profile, "Window system");
+        drge_init_window_system();
+        drge_end_startup_phase(&profile, iPhase);
+    }
+
+    drge_context* pContext = DRGE_MALLOC(sizeof(*pContext), DRGE_MEMORY_TAG_GENERAL);
+    if (pContext == NULL) {
+        return NULL;
+    }
+
+    memset(pContext, 0, sizeof(*pContext));
+    pContext->cmdline  = cmdline;
+    pContext->startupTicks = startupTicks;
+
+
+#ifdef DR_GE_PORTABLE
+    pContext->isPortable = true;
+#else
+    pContext->isPortable = dr_cmdline_key_exists(&cmdline, "portable");
+#endif
+    pContext->isTerminalOutputDisabled = dr_cmdline_key_exists(&cmdline, "silent");
+    pContext->isPipelined = dr_cmdline_key_exists(&cmdline, "pipelined");
+    pContext->isHeadless = dr_cmdline_key_exists(&cmdline, "headless");
+    pContext->isRenderingEnabled = !pContext->isHeadless || dr_cmdline_key_exists(&cmdline, "headless-render");
+    pContext->wantsToClose = false;
+    dr_parse_cmdline(&cmdline, drge_apply_run_cmdline_callback, pContext);
+
+    drge_reset_frame_time_stats(pContext);
+    pContext->statsLogTicks = startupTicks;
+
+
+    // The logger. This needs to be created before anything that might want to post a message. Messages that are written
+    // out before the log file is opened only go to the terminal.
+    pContext->pLogger = drge_create_logger(!pContext->isTerminalOutputDisabled);
+    if (pContext->pLogger == NULL) {
+        goto on_error;
+    }
+
+    pContext->logLevel        = DRGE_LOG_LEVEL_INFO;
+    pContext->logCategoryMask = (1U << DRGE_LOG_CATEGORY_COUNT) - 1;
+    drge_apply_log_cmdline(pContext);
+
+    // The main thread isn't renamed because on Linux that would also rename the process.
+    drge_profile_set_thread_name("Main");
+    drge_register_current_thread(DRGE_THREAD_ROLE_MAIN, NULL);
+    drge_apply_trace_cmdline(pContext);
+
+
+    // The job system. This is sized to the machine, and needs to be created before anything that might want to use it.
+    iPhase = drge_begin_startup_phase(&profile, "Job system");
+    pContext->pJobs = drge_create_job_system(0);
+    if (pContext->pJobs == NULL) {
+        goto on_error;
+    }
+    drge_end_startup_phase(&profile, iPhase);
+
+    drge_debugf(pContext, DRGE_LOG_CATEGORY_GENERAL, "Job system started with %u worker threads.", drge_get_job_worker_count(pContext->pJobs));
+
+
+    // Graphics. This is created on first use, but a game is going to need it straight away so it's started in the
+    // background now. This way it runs in parallel with everything else. The editor only needs graphics for some kinds
+    // of files so it doesn't get started early for editor sessions, nor when running headless without rendering.
+    pContext->graphicsInitLock = drutil_create_mutex();
+    if (pContext->graphicsInitLock == NULL) {
+        goto on_error;
+    }
+
+    if (!dr_cmdline_key_exists(&cmdline, "editor") && pContext->isRenderingEnabled) {
+        drge_begin_graphics_init(pContext);
+    }
+
+
+    // The file system. The lowest priority base path is always the directory containing the executable.
+    iPhase = drge_begin_startup_phase(&profile, "File system");
+    pContext->pVFS = drfs_create_context();
+    if (pContext->pVFS == NULL) {
+        goto on_error;
+    }
+
+    char executableDirPath[DRFS_MAX_PATH];
+    if (!dr_get_executable_path(executableDirPath, sizeof(executableDirPath))) {
+        // This is actually a critical error because we need a reliable relative path to load assets and whatnot.
+        goto on_error;
+    }
+
+    drfs_add_base_directory(pContext->pVFS, drpath_base_path(executableDirPath));
+    drge_end_startup_phase(&profile, iPhase);
+
+
+    // The config file. This needs to be done after initializing the file system so we can load the file. Needs to come
+    // before loading the config file because the config contains the game name which we need for determining where to
+    // place the log file.
+    iPhase = drge_begin_startup_phase(&profile, "Config");
+    drge_load_config(pContext);
+    drge_end_startup_phase(&profile, iPhase);
+
+    // The log file. Always do this after loading the config.
+    iPhase = drge_begin_startup_phase(&profile, "Log file");
+    drge_open_log_file(pContext);
+    drge_end_startup_phase(&profile, iPhase);
+
+
+    drge_log_startup_profile(pContext, &profile, "Startup");
+    drge_log_messagef(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, "Startup: %-16s %8.2f ms", "Total", (drge_get_ticks() - startupTicks) * 1000.0 / drge_get_tick_frequency());
+
+    return pContext;
+
+
+on_error:
+    drge_uninit_graphics(pContext);
+
+    if (pContext->graphicsInitLock) {
+        dr_delete_mutex(pContext->graphicsInitLock);
+    }
+
+    if (pContext->pJobs) {
+        drge_delete_job_system(pContext->pJobs);
+    }
+
+    if (pContext->pLogger) {
+        drge_delete_logger(pContext->pLogger);
+    }
+
+    if (pContext->pLogFile) {
+        drfs_close(pContext->pLogFile);
+    }
+
+    if (pContext->pVFS) {
+        drfs_delete_context(pContext->pVFS);
+    }
+
+    drge_unregister_current_thread();
+    DRGE_FREE(pContext);
+    return NULL;
+}
+
+drge_context* drge_create_context(int argc, char** argv)
+{
+    dr_cmdline cmdline;
+    dr_init_cmdline(&cmdline, argc, argv);          // Won't fail in practice.
+
+    return drge_create_context_cmdline(cmdline);
+}
+
+drge_context* drge_create_context_win32(char* cmdlineStr)
+{
+    dr_cmdline cmdline;
+    dr_init_cmdline_win32(&cmdline, cmdlineStr);    // Won't fail in practice.
+
+    return drge_create_context_cmdline(cmdline);
+}
+
+void drge_delete_context(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return;
+    }
+
+    drge_uninit_graphics(pContext);
+    dr_delete_mutex(pContext->graphicsInitLock);
+    drge_delete_job_system(pContext->pJobs);
+
+    // If the game closed before the last traced frame, write out what was recorded.
+    if (pContext->tracePath[0] != '\0' && drge_is_tracing()) {
+        drge_finish_trace(pContext);
+    }
+
+    // Anything that's still live at this point is either owned by the logger, the file system or the context itself, or
+    // has been leaked.
+    drge_log_memory_stats(pContext, "Shutdown", 0);
+
+    // The logger needs to be deleted before closing the log file so that everything still in flight is written out.
+    drge_delete_logger(pContext->pLogger);
+    drfs_close(pContext->pLogFile);
+    drfs_delete_context(pContext->pVFS);
+
+    bool isHeadless = pContext->isHeadless;
+    drge_unregister_current_thread();
+    DRGE_FREE(pContext);
+
+    // Every other thread has stopped by now so it's safe to free their trace buffers.
+    drge_uninit_profiler();
+
+    if (!isHeadless) {
+        drge_uninit_window_system();
+    }
+}
+
+
+int drge_run(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return -1;  // No context.
+    }
+
+#ifndef DR_GE_DISABLE_EDITOR
+    if (dr_cmdline_key_exists(&pContext->cmdline, "editor"))
+    {
+        return drge_open_and_run_editor(pContext);
+    }
+    else
+#endif
+    {
+        return drge_run_game(pContext);
+    }
+}
+
+static int drge_render_thread_proc(void* pUserData)
+{
+    drge_context* pContext = pUserData;
+    assert(pContext != NULL);
+
+    drge_profile_set_thread_name("Render");
+    drge_register_current_thread(DRGE_THREAD_ROLE_RENDER, "Render");
+
+    for (;;)
+    {
+        dr_wait_semaphore(pContext->renderStateReadySemaphore);
+
+        // The stop request is posted to the same semaphore as the render states, but the wake up it causes can be used
+        // up by a render state that was posted before it. The flag is only honoured once every render state that was
+        // posted has been rendered so that the last frame isn't dropped.
+        if (drge_atomic_load_64(&pContext->isRenderThreadStopping) && drge_atomic_load_64(&pContext->renderStateRenderedCount) == drge_atomic_load_64(&pContext->renderStatePostedCount)) {
+            break;
+        }
+
+        long long renderStartTicks = drge_get_ticks();
+
+        DRGE_PROFILE_SCOPE("Render")
+        {
+            drge_render(pContext, &pContext->renderStates[pContext->renderStateReadIndex]);
+        }
+
+        if (drge_atomic_exchange_64(&pContext->isRenderTimeResetPending, 0)) {
+            drge_init_histogram(&pContext->frameTimes[DRGE_FRAME_TIME_RENDER]);
+        }
+
+        drge_histogram_record(&pContext->frameTimes[DRGE_FRAME_TIME_RENDER], drge_get_ticks() - renderStartTicks);
+
+        pContext->renderStateReadIndex ^= 1;
+        drge_atomic_fetch_add_64(&pContext->renderStateRenderedCount, 1);
+        dr_release_semaphore(pContext->renderStateFreeSemaphore);
+    }
+
+    drge_unregister_current_thread();
+    return 0;
+}
+
+// Starts the render thread for pipelined mode. If anything fails the game just runs single threaded.
+static void drge_start_render_thread(drge_context* pContext)
+{
+    assert(pContext != NULL);
+    assert(pContext->renderThread == NULL);
+
+    pContext->renderStateWriteIndex    = 0;
+    pContext->renderStateReadIndex     = 0;
+    pContext->isRenderThreadStopping   = 0;
+    pContext->renderStatePostedCount   = 0;
+    pContext->renderStateRenderedCount = 0;
+    pContext->isRenderTimeResetPending = 0;
+
+    pContext->renderStateFreeSemaphore = dr_create_semaphore(2);
+    if (pContext->renderStateFreeSemaphore == NULL) {
+        goto on_error;
+    }
+
+    pContext->renderStateReadySemaphore = dr_create_semaphore(0);
+    if (pContext->renderStateReadySemaphore == NULL) {
+        goto on_error;
+    }
+
+    pContext->renderThread = dr_create_thread(drge_render_thread_proc, pContext);
+    if (pContext->renderThread == NULL) {
+        goto on_error;
+    }
+
+    return;
+
+
+on_error:
+    drge_warning(pContext, "Failed to start the render thread. Pipelined rendering is disabled.");
+
+    if (pContext->renderStateReadySemaphore != NULL) {
+        dr_delete_semaphore(pContext->renderStateReadySemaphore);
+        pContext->renderStateReadySemaphore = NULL;
+    }
+
+    if (pContext->renderStateFreeSemaphore != NULL) {
+        dr_delete_semaphore(pContext->renderStateFreeSemaphore);
+        pContext->renderStateFreeSemaphore = NULL;
+    }
+}
+
+// Waits for the render thread to render everything that's been handed to it and then stops it.
+static void drge_stop_render_thread(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (pContext->renderThread == NULL) {
+        return;
+    }
+
+    // The render thread keeps going after seeing the flag until it's caught up with every render state posted before
+    // this, so the extra post is what wakes it up for the last time.
+    drge_atomic_store_64(&pContext->isRenderThreadStopping, 1);
+    dr_release_semaphore(pContext->renderStateReadySemaphore);
+    dr_wait_and_delete_thread(pContext->renderThread);
+    pContext->renderThread = NULL;
+
+    // A reset that came in after the last frame was rendered is still owed.
+    if (drge_atomic_exchange_64(&pContext->isRenderTimeResetPending, 0)) {
+        drge_init_histogram(&pContext->frameTimes[DRGE_FRAME_TIME_RENDER]);
+    }
+
+    dr_delete_semaphore(pContext->renderStateReadySemaphore);
+    dr_delete_semaphore(pContext->renderStateFreeSemaphore);
+    pContext->renderStateReadySemaphore = NULL;
+    pContext->renderStateFreeSemaphore  = NULL;
+}
+
+static unsigned long long drge_get_replay_time_us(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    return (unsigned long long)((drge_get_ticks() - pContext->replayStartTicks) * 1000000.0 / drge_get_tick_frequency());
+}
+
+// Sets the state of an action, recording the change if a replay is being recorded.
+static void drge_update_action(drge_context* pContext, unsigned int actionID, bool isDown)
+{
+    assert(pContext != NULL);
+    assert(actionID < pContext->input.actionCount);
+
+    if (pContext->input.actionStates[actionID] == isDown) {
+        return;
+    }
+
+    pContext->input.actionStates[actionID] = isDown;
+
+    if (pContext->pReplay != NULL && !pContext->isReplaying) {
+        drge_replay_event e;
+        memset(&e, 0, sizeof(e));
+        e.type   = isDown ? DRGE_REPLAY_EVENT_ACTION_DOWN : DRGE_REPLAY_EVENT_ACTION_UP;
+        e.timeUS = drge_get_replay_time_us(pContext);
+        e.id     = actionID;
+        drge_replay_write(pContext->pReplay, &e);
+    }
+}
+
+// Sets the value of an axis, recording the change if a replay is being recorded.
+static void drge_update_axis(drge_context* pContext, unsigned int axisID, float value)
+{
+    assert(pContext != NULL);
+    assert(axisID < pContext->input.axisCount);
+
+    if (pContext->input.axisValues[axisID] == value) {
+        return;
+    }
+
+    pContext->input.axisValues[axisID] = value;
+
+    if (pContext->pReplay != NULL && !pContext->isReplaying) {
+        drge_replay_event e;
+        memset(&e, 0, sizeof(e));
+        e.type      = DRGE_REPLAY_EVENT_AXIS;
+        e.timeUS    = drge_get_replay_time_us(pContext);
+        e.id        = axisID;
+        e.axisValue = value;
+        drge_replay_write(pContext->pReplay, &e);
+    }
+}
+
+// Starts recording or playing back the replay that was requested with --record or --replay. The step settings are
+// taken from the replay when playing back, because the game would step differently without them.
+static void drge_begin_replay(drge_context* pContext)
+{
+    assert(pContext != NULL);
+    assert(pContext->pReplay == NULL);
+
+    if (pContext->replayPath[0] == '\0') {
+        return;
+    }
+
+    pContext->replayFrameCount = 0;
+    pContext->replayStartTicks = drge_get_ticks();
+
+    if (pContext->isReplaying)
+    {
+        if (drfs_open(drge_get_vfs(pContext), pContext->replayPath, DRFS_READ, &pContext->pReplayFile) != drfs_success) {
+            drge_errorf(pContext, "Failed to open replay %s", pContext->replayPath);
+            return;
+        }
+
+        drge_replay_header header;
+        pContext->pReplay = drge_open_replay(pContext->pReplayFile, &header);
+        if (pContext->pReplay == NULL) {
+            drge_errorf(pContext, "%s is not a replay, or was recorded by a different version", pContext->replayPath);
+            goto on_error;
+        }
+
+        if (header.stepRate == 0 || header.stepRate > 1000 || header.maxStepsPerFrame == 0) {
+            drge_errorf(pContext, "%s has invalid step settings", pContext->replayPath);
+            goto on_error;
+        }
+
+        if (header.actionCount != pContext->input.actionCount || header.axisCount != pContext->input.axisCount) {
+            drge_warningf(pContext, "%s was recorded with %u actions and %u axes, but %u actions and %u axes are declared. Input will not play back correctly.",
+                pContext->replayPath, header.actionCount, header.axisCount, pContext->input.actionCount, pContext->input.axisCount);
+        }
+
+        pContext->stepRate         = header.stepRate;
+        pContext->maxStepsPerFrame = header.maxStepsPerFrame;
+        drge_logf(pContext, "Playing back replay %s", pContext->replayPath);
+    }
+    else
+    {
+        if (drfs_open(drge_get_vfs(pContext), pContext->replayPath, DRFS_WRITE | DRFS_TRUNCATE | DRFS_CREATE_DIRS, &pContext->pReplayFile) != drfs_success) {
+            drge_errorf(pContext, "Failed to open replay %s for writing", pContext->replayPath);
+            return;
+        }
+
+        drge_replay_header header;
+        header.stepRate         = pContext->stepRate;
+        header.maxStepsPerFrame = pContext->maxStepsPerFrame;
+        header.actionCount      = pContext->input.actionCount;
+        header.axisCount        = pContext->input.axisCount;
+
+        pContext->pReplay = drge_create_replay_recorder(pContext->pReplayFile, &header);
+        if (pContext->pReplay == NULL) {
+            goto on_error;
+        }
+
+        drge_logf(pContext, "Recording replay to %s", pContext->replayPath);
+    }
+
+    return;
+
+
+on_error:
+    drfs_close(pContext->pReplayFile);
+    pContext->pReplayFile = NULL;
+}
+
+// Finishes recording or playing back the replay.
+static void drge_end_replay(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (pContext->pReplay == NULL) {
+        return;
+    }
+
+    if (drge_delete_replay(pContext->pReplay)) {
+        drge_logf(pContext, "Replay %s: %llu frames %s", pContext->replayPath, pContext->replayFrameCount, pContext->isReplaying ? "played back" : "recorded");
+    } else {
+        drge_errorf(pContext, "Failed to write replay %s", pContext->replayPath);
+    }
+
+    drfs_close(pContext->pReplayFile);
+    pContext->pReplay     = NULL;
+    pContext->pReplayFile = NULL;
+}
+
+// Applies the input events of the replay that's being played back up to the next frame or step event, which is returned
+// in pEventOut. Returns false at the end of the replay, or if the next one of these isn't of the given type, which means
+// the game isn't stepping the same way it did when it was recorded.
+static bool drge_play_replay_events(drge_context* pContext, int untilType, drge_replay_event* pEventOut)
+{
+    assert(pContext != NULL);
+    assert(pContext->pReplay != NULL);
+    assert(pEventOut != NULL);
+
+    drge_replay_event e;
+    while (drge_replay_read(pContext->pReplay, &e))
+    {
+        switch (e.type)
+        {
+            case DRGE_REPLAY_EVENT_FRAME:
+            case DRGE_REPLAY_EVENT_STEP:
+            {
+                *pEventOut = e;
+                return e.type == untilType;
+            }
+
+            case DRGE_REPLAY_EVENT_ACTION_DOWN:
+            case DRGE_REPLAY_EVENT_ACTION_UP:
+            {
+                if (e.id < pContext->input.actionCount) {
+                    drge_update_action(pContext, e.id, e.type == DRGE_REPLAY_EVENT_ACTION_DOWN);
+                }
+            } break;
+
+            case DRGE_REPLAY_EVENT_AXIS:
+            {
+                if (e.id < pContext->input.axisCount) {
+                    drge_update_axis(pContext, e.id, e.axisValue);
+                }
+            } break;
+        }
+    }
+
+    return false;
+}
+
+// Applies the input for the next frame of the replay that's being played back and retrieves the time the frame advanced
+// the game by. Returns false at the end of the replay.
+static bool drge_play_replay_frame(drge_context* pContext, double* pFrameSecondsOut)
+{
+    assert(pContext != NULL);
+    assert(pFrameSecondsOut != NULL);
+
+    drge_replay_event e;
+    if (!drge_play_replay_events(pContext, DRGE_REPLAY_EVENT_FRAME, &e)) {
+        return false;
+    }
+
+    *pFrameSecondsOut = e.frameSeconds;
+    return true;
+}
+
+// Marks the end of a step in the replay that's being recorded, or applies the input that changed while the step was
+// running in the replay that's being played back. Without this, input changed by a step would be played back at the start
+// of the next frame instead of being seen by the rest of the frame.
+static void drge_end_replay_step(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    if (pContext->pReplay == NULL) {
+        return;
+    }
+
+    drge_replay_event e;
+    if (pContext->isReplaying) {
+        if (!drge_play_replay_events(pContext, DRGE_REPLAY_EVENT_STEP, &e)) {
+            drge_end_replay(pContext);
+            drge_request_close(pContext);
+        }
+    } else {
+        memset(&e, 0, sizeof(e));
+        e.type   = DRGE_REPLAY_EVENT_STEP;
+        e.timeUS = drge_get_replay_time_us(pContext);
+        drge_replay_write(pContext->pReplay, &e);
+    }
+}
+
+// The main loop for headless mode. There's no window so there are no events to handle. Frames are run back to back
+// without any frame limiting, and each one steps the game exactly once so that every run does the same amount of work.
+static int drge_headless_main_loop(drge_context* pContext)
+{
+    assert(pContext != NULL);
+
+    pContext->fixedFrameSeconds = 1.0 / pContext->stepRate;
+
+    // Without this Ctrl+C would kill the process before the statistics are logged.
+    drge_close_on_interrupt(pContext);
+
+    unsigned long long firstFrameIndex = pContext->frameIndex;
+    long long startTicks = drge_get_ticks();
+
+    while (!drge_wants_to_close(pContext)) {
+        drge_do_frame(pContext);
+    }
+
+    long long totalTicks = drge_get_ticks() - startTicks;
+    unsigned long long frameCount = pContext->frameIndex - firstFrameIndex;
+
+    drge_close_on_interrupt(NULL);
+
+    if (frameCount > 0 && totalTicks > 0) {
+        double seconds = (double)totalTicks / drge_get_tick_frequency();
+        drge_logf(pContext, "Headless: %llu frames in %.2f s (%.1f frames per second)", frameCount, seconds, frameCount / seconds);
+        drge_log_frame_time_stats(pContext, "Headless");
+    }
+
+    return 0;
+}
+
+int drge_run_game(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return -1;
+    }
+
+    if (!pContext->isHeadless) {
+        pContext->pWindow = drge_create_window(pContext, pContext->name, 640, 480, pContext->windowOptions);
+        if (pContext->pWindow == NULL) {
+            return -2;  // Failed to create the game window.
+        }
+    }
+
+    pContext->pTimer = drge_create_timer();
+    if (pContext->pTimer == NULL) {
+        return -3;  // Failed to create the timer.
+    }
+
+    // Graphics is needed for the first frame so make sure it's ready before entering the main loop. This will usually
+    // have been started in the background when the context was created.
+    if (pContext->isRenderingEnabled)
+    {
+        if (drge_get_graphics_world(pContext) == NULL && pContext->isHeadless) {
+            drge_warning(pContext, "Graphics is not available. Headless frames will not be rendered.");
+        }
+
+        if (pContext->isPipelined) {
+            drge_start_render_thread(pContext);
+        }
+    }
+
+    // Pipelined mode needs a third frame arena because the render thread can still be rendering a frame when the
+    // simulation thread starts the frame after next.
+    pContext->frameArenaCount = (pContext->renderThread != NULL) ? 3 : 2;
+    for (unsigned int iArena = 0; iArena < pContext->frameArenaCount; ++iArena) {
+        if (!drge_init_arena(&pContext->frameArenas[iArena], pContext->frameArenaSize, DRGE_MEMORY_TAG_GENERAL)) {
+            drge_warning(pContext, "Failed to allocate the frame arenas. drge_frame_alloc() will always fail.");
+            break;
+        }
+    }
+
+    // Raw input needs a window to get focus from.
+    drge_init_raw_input_queue(&pContext->rawInputQueue);
+    if (pContext->pWindow != NULL) {
+        pContext->pRawInput = drge_start_raw_input(&pContext->rawInputQueue);
+        if (pContext->pRawInput == NULL) {
+            drge_logf(pContext, "Raw input is not available.");
+        }
+    }
+
+    drge_begin_replay(pContext);
+
+    int result;
+    if (pContext->isHeadless) {
+        result = drge_headless_main_loop(pContext);
+    } else {
+        result = drge_main_loop(pContext);
+    }
+
+    drge_end_replay(pContext);
+    drge_stop_render_thread(pContext);
+
+    drge_stop_raw_input(pContext->pRawInput);
+    pContext->pRawInput = NULL;
+
+    pContext->pFrameArena = NULL;
+    for (unsigned int iArena = 0; iArena < pContext->frameArenaCount; ++iArena) {
+        drge_uninit_arena(&pContext->frameArenas[iArena]);
+    }
+
+    drge_delete_timer(pContext->pTimer);
+    drge_delete_window(pContext->pWindow);
+    return result;
+}
+
+#ifndef DR_GE_DISABLE_EDITOR
+int drge_open_and_run_editor(drge_context* pContext)
+{
+    if (pContext == NULL || pContext->pEditor != NULL) {
+        return -1;
+    }
+
+    // The editor should not already be open.
+    if (pContext->pEditor != NULL) {
+        return -2;
+    }
+
+    pContext->pEditor = drge_create_editor(pContext);
+    if (pContext->pEditor == NULL) {
+        return -3;
+    }
+
+    int result = drge_editor_run(pContext->pEditor);
+
+    drge_delete_editor(pContext->pEditor);
+    pContext->pEditor = NULL;
+
+    return result;
+}
+#endif
+
+
+bool drge_wants_to_close(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return false;
+    }
+
+    return pContext->wantsToClose;
+}
+
+void drge_request_close(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return;
+    }
+
+    pContext->wantsToClose = true;
+}
+
+
+static int drge_startup_and_run_cmdline(dr_cmdline cmdline)
+{
+    drge_context* pContext = drge_create_context_cmdline(cmdline);
+    if (pContext == NULL) {
+        return -1;  // Failed to create the main context.
+    }
+
+    int result = drge_run(pContext);
+
+    drge_delete_context(pContext);
+    return result;
+}
+
+int drge_startup_and_run(int argc, char** argv)
+{
+    dr_cmdline cmdline;
+    dr_init_cmdline(&cmdline, argc, argv);          // Won't fail in practice.
+
+    return drge_startup_and_run_cmdline(cmdline);
+}
+
+int drge_startup_and_run_winmain(char* cmdlineStr)
+{
+    dr_cmdline cmdline;
+    dr_init_cmdline_win32(&cmdline, cmdlineStr);    // Won't fail in practice.
+
+    return drge_startup_and_run_cmdline(cmdline);
+}
+
+
+// Moves the raw input events at the start of the next step of the replay that's being played back into the step's list.
+// The events are given ticks that are the same distance from endTicks as they were from the end of the step when they
+// were recorded.
+static void drge_play_replay_raw_input(drge_context* pContext, long long endTicks)
+{
+    assert(pContext != NULL);
+    assert(pContext->pReplay != NULL);
+
+    drge_replay_event e;
+    while (pContext->stepRawInputEventCount < DRGE_RAW_INPUT_QUEUE_SIZE && drge_replay_peek(pContext->pReplay, &e) && e.type == DRGE_REPLAY_EVENT_RAW_INPUT)
+    {
+        drge_replay_read(pContext->pReplay, &e);
+
+        e.rawInput.ticks = endTicks - (long long)(e.rawInputAgeUS * (drge_get_tick_frequency() / 1000000.0));
+        pContext->stepRawInputEvents[pContext->stepRawInputEventCount++] = e.rawInput;
+    }
+}
+
+// Adds a raw input event that was handed to a step to the replay that's being recorded.
+static void drge_record_replay_raw_input(drge_context* pContext, const drge_raw_input_event* pEvent, long long endTicks)
+{
+    assert(pContext != NULL);
+    assert(pContext->pReplay != NULL);
+    assert(pEvent != NULL);
+
+    drge_replay_event e;
+    memset(&e, 0, sizeof(e));
+    e.type          = DRGE_REPLAY_EVENT_RAW_INPUT;
+    e.timeUS        = drge_get_replay_time_us(pContext);
+    e.rawInput      = *pEvent;
+    e.rawInputAgeUS = (unsigned long long)((endTicks - pEvent->ticks) * 1000000.0 / drge_get_tick_frequency());
+    drge_replay_write(pContext->pReplay, &e);
+}
+
+// Moves the raw input events that arrived before endTicks off the queue and into the step's list.
+static void drge_gather_step_raw_input(drge_context* pContext, long long endTicks)
+{
+    assert(pContext != NULL);
+
+    pContext->stepRawInputEventCount = 0;
+
+    // When playing back a replay the step's raw input comes from the replay. Live input is still drained so it doesn't
+    // pile up, but it's thrown away.
+    bool isReplaying = pContext->pReplay != NULL && pContext->isReplaying;
+    if (isReplaying) {
+        drge_play_replay_raw_input(pContext, endTicks);
+    }
+
+    if (pContext->pRawInput == NULL) {
+        return;
+    }
+
+    // Events that don't fit are left on the queue for the next step.
+    long long nowTicks = drge_get_ticks();
+    drge_raw_input_event e;
+    while ((isReplaying || pContext->stepRawInputEventCount < DRGE_RAW_INPUT_QUEUE_SIZE) && drge_peek_raw_input(&pContext->rawInputQueue, &e) && e.ticks < endTicks)
+    {
+        drge_pop_raw_input(&pContext->rawInputQueue, &e);
+        if (isReplaying) {
+            continue;
+        }
+
+        drge_histogram_record(&pContext->frameTimes[DRGE_FRAME_TIME_INPUT], nowTicks - e.ticks);
+        pContext->stepRawInputEvents[pContext->stepRawInputEventCount++] = e;
+
+        if (pContext->pReplay != NULL) {
+            drge_record_replay_raw_input(pContext, &e, endTicks);
+        }
+    }
+}
+
+void drge_do_frame(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return;
+    }
+
+    if (pContext->tracePath[0] != '\0' && pContext->frameIndex == pContext->traceFirstFrame) {
+        drge_begin_trace();
+    }
+
+    DRGE_PROFILE_BEGIN("Frame");
+
+    // Nothing from the frame that last used this arena can still be in use. See drge_frame_alloc().
+    if (pContext->frameArenaCount > 0) {
+        pContext->pFrameArena = &pContext->frameArenas[pContext->frameIndex % pContext->frameArenaCount];
+        drge_reset_arena(pContext->pFrameArena);
+    }
+
+    // This function is called by drge_main_loop() whenever the game needs to be stepped and rendered. We step the game
+    // first, and then render. In pipelined mode the rendering is handed off to the render thread.
+    //
+    // The game is stepped with a fixed time step so that it behaves the same regardless of frame rate. The time that
+    // has passed since the last frame is added to an accumulator which is consumed one step at a time. What's left over
+    // is less than a full step and is used to interpolate between steps when rendering.
+    double stepSeconds = 1.0 / pContext->stepRate;
+    double frameSeconds = drge_tick_timer(pContext->pTimer);
+
+    // The first frame's time includes everything that happened before the main loop, so it's left out of the stats.
+    if (pContext->frameIndex > 0) {
+        drge_histogram_record(&pContext->frameTimes[DRGE_FRAME_TIME_TOTAL], (long long)(frameSeconds * drge_get_tick_frequency()));
+    }
+
+    if (pContext->fixedFrameSeconds > 0) {
+        frameSeconds = pContext->fixedFrameSeconds;
+    }
+
+    // When playing back a replay the frame time comes from the replay, along with any input that arrived before the
+    // frame. Otherwise the frame time is recorded after the input that arrived before it, if recording.
+    if (pContext->pReplay != NULL)
+    {
+        if (pContext->isReplaying) {
+            if (drge_play_replay_frame(pContext, &frameSeconds)) {
+                pContext->replayFrameCount += 1;
+            } else {
+                drge_end_replay(pContext);
+                drge_request_close(pContext);
+                frameSeconds = 0;
+            }
+        } else {
+            drge_replay_event e;
+            memset(&e, 0, sizeof(e));
+            e.type         = DRGE_REPLAY_EVENT_FRAME;
+            e.timeUS       = drge_get_replay_time_us(pContext);
+            e.frameSeconds = frameSeconds;
+            drge_replay_write(pContext->pReplay, &e);
+            pContext->replayFrameCount += 1;
+        }
+    }
+
+    pContext->stepAccumulator += frameSeconds;
+
+    long long stepStartTicks = drge_get_ticks();
+    unsigned int stepCount = 0;
+    while (pContext->stepAccumulator >= stepSeconds)
+    {
+        if (stepCount == pContext->maxStepsPerFrame) {
+            // The game can't keep up. Trying to catch up on the next frame would only make that frame even slower, so
+            // drop the backlog and let the game slow down instead.
+            drge_debugf(pContext, DRGE_LOG_CATEGORY_GENERAL, "Dropped %.2f ms of steps", pContext->stepAccumulator * 1000);
+            pContext->stepAccumulator -= stepSeconds * (long long)(pContext->stepAccumulator / stepSeconds);
+            break;
+        }
+
+        // The step covers the stretch of real time ending where the accumulator says it ends, so it gets the raw input
+        // that arrived before then. Anything later is left for the next step.
+        drge_gather_step_raw_input(pContext, stepStartTicks - (long long)((pContext->stepAccumulator - stepSeconds) * drge_get_tick_frequency()));
+
+        DRGE_PROFILE_SCOPE("Step")
+        {
+            drge_step(pContext, stepSeconds);
+        }
+
+        drge_end_replay_step(pContext);
 
+        pContext->stepRawInputEventCount = 0;
 
-    // The file system. The lowest priority base path is always the directory containing the executable.
-    pContext->pVFS = drfs_create_context();
-    if (pContext->pVFS == NULL) {
-        goto on_error;
+        pContext->stepAccumulator -= stepSeconds;
+        stepCount += 1;
     }
 
-    char executableDirPath[DRFS_MAX_PATH];
-    if (!dr_get_executable_path(executableDirPath, sizeof(executableDirPath))) {
-        // This is actually a critical error because we need a reliable relative path to load assets and whatnot.
-        goto on_error;
+    if (stepCount > 0) {
+        drge_histogram_record(&pContext->frameTimes[DRGE_FRAME_TIME_STEP], drge_get_ticks() - stepStartTicks);
     }
 
-    drfs_add_base_directory(pContext->pVFS, drpath_base_path(executableDirPath));
+    if (pContext->renderThread != NULL)
+    {
+        // Pipelined. The render state that's about to be overwritten was handed to the render thread two frames ago,
+        // so this only blocks if rendering is taking longer than simulating.
+        DRGE_PROFILE_SCOPE("Wait for render thread")
+        {
+            dr_wait_semaphore(pContext->renderStateFreeSemaphore);
+        }
 
+        drge_render_state* pState = &pContext->renderStates[pContext->renderStateWriteIndex];
+        pState->frameIndex  = pContext->frameIndex;
+        pState->alpha       = pContext->stepAccumulator / stepSeconds;
+        pState->pFrameArena = pContext->pFrameArena;
 
-    // The config file. This needs to be done after initializing the file system so we can load the file. Needs to come
-    // before loading the config file because the config contains the game name which we need for determining where to
-    // place the log file.
-    drge_load_config(pContext);
+        DRGE_PROFILE_SCOPE("Build render state")
+        {
+            drge_build_render_state(pContext, pState);
+        }
 
-    // The log file. Always do this after loading the config.
-    drge_open_log_file(pContext);
+        pContext->renderStateWriteIndex ^= 1;
+        drge_atomic_fetch_add_64(&pContext->renderStatePostedCount, 1);
+        dr_release_semaphore(pContext->renderStateReadySemaphore);
+    }
+    else if (pContext->isRenderingEnabled)
+    {
+        long long renderStartTicks = drge_get_ticks();
 
+        drge_render_state* pState = &pContext->renderStates[0];
+        pState->frameIndex  = pContext->frameIndex;
+        pState->alpha       = pContext->stepAccumulator / stepSeconds;
+        pState->pFrameArena = pContext->pFrameArena;
 
-    // Graphics.
-    pContext->pVulkan = drvkCreateContext(NULL);
-    pContext->pGraphicsWorld = drge_create_graphics_world(pContext->pVulkan);
+        DRGE_PROFILE_SCOPE("Build render state")
+        {
+            drge_build_render_state(pContext, pState);
+        }
 
-    return pContext;
+        DRGE_PROFILE_SCOPE("Render")
+        {
+            drge_render(pContext, pState);
+        }
 
+        drge_histogram_record(&pContext->frameTimes[DRGE_FRAME_TIME_RENDER], drge_get_ticks() - renderStartTicks);
+    }
 
-on_error:
-    drvkDeleteContext(pContext->pVulkan);
+    DRGE_PROFILE_END();
+    pContext->frameIndex += 1;
 
-    if (pContext->pLogFile) {
-        drfs_close(pContext->pLogFile);
+    if (pContext->tracePath[0] != '\0' && pContext->frameIndex == pContext->traceFirstFrame + pContext->traceFrameCount) {
+        drge_finish_trace(pContext);
     }
 
-    if (pContext->pVFS) {
-        drfs_delete_context(pContext->pVFS);
+    if (pContext->statsLogInterval > 0) {
+        long long nowTicks = drge_get_ticks();
+        if (nowTicks - pContext->statsLogTicks >= (long long)(pContext->statsLogInterval * drge_get_tick_frequency())) {
+            drge_log_frame_time_stats(pContext, "Stats");
+            drge_log_memory_stats(pContext, "Stats", (double)(nowTicks - pContext->statsLogTicks) / drge_get_tick_frequency());
+            drge_log_frame_arena_stats(pContext, "Stats");
+            drge_reset_frame_time_stats(pContext);
+            pContext->statsLogTicks = nowTicks;
+        }
     }
 
-    free(pContext);
-    return NULL;
+    if (pContext->maxFrameCount > 0 && pContext->frameIndex >= pContext->maxFrameCount) {
+        drge_request_close(pContext);
+    }
 }
 
-drge_context* drge_create_context(int argc, char** argv)
+void drge_set_max_frame_rate(drge_context* pContext, unsigned int maxFrameRate)
 {
-    dr_cmdline cmdline;
-    dr_init_cmdline(&cmdline, argc, argv);          // Won't fail in practice.
+    if (pContext == NULL) {
+        return;
+    }
 
-    return drge_create_context_cmdline(cmdline);
+    pContext->maxFrameRate = maxFrameRate;
 }
 
-drge_context* drge_create_context_win32(char* cmdlineStr)
+unsigned int drge_get_max_frame_rate(drge_context* pContext)
 {
-    dr_cmdline cmdline;
-    dr_init_cmdline_win32(&cmdline, cmdlineStr);    // Won't fail in practice.
+    if (pContext == NULL) {
+        return 0;
+    }
 
-    return drge_create_context_cmdline(cmdline);
+    return pContext->maxFrameRate;
 }
 
-void drge_delete_context(drge_context* pContext)
+void drge_set_idle(drge_context* pContext, bool isIdle)
 {
     if (pContext == NULL) {
         return;
     }
 
-    drfs_close(pContext->pLogFile);
-    drfs_delete_context(pContext->pVFS);
-    free(pContext);
-
-    drge_uninit_window_system();
+    pContext->isIdle = isIdle;
 }
 
-
-int drge_run(drge_context* pContext)
+bool drge_is_idle(drge_context* pContext)
 {
     if (pContext == NULL) {
-        return -1;  // No context.
+        return false;
     }
 
-#ifndef DR_GE_DISABLE_EDITOR
-    if (dr_cmdline_key_exists(&pContext->cmdline, "editor"))
-    {
-        return drge_open_and_run_editor(pContext);
-    }
-    else
-#endif
-    {
-        return drge_run_game(pContext);
-    }
+    return pContext->isIdle;
 }
 
-int drge_run_game(drge_context* pContext)
+void* drge_frame_alloc(drge_context* pContext, size_t size)
 {
     if (pContext == NULL) {
-        return -1;
+        return NULL;
     }
 
-    pContext->pWindow = drge_create_window(pContext, pContext->name, 640, 480, DRGE_WINDOW_CENTERED);
-    if (pContext->pWindow == NULL) {
-        return -2;  // Failed to create the game window.
+    return drge_arena_alloc(pContext->pFrameArena, size);
+}
+
+drge_arena* drge_get_frame_arena(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return NULL;
     }
 
-    pContext->pTimer = drge_create_timer();
-    if (pContext->pTimer == NULL) {
-        return -3;  // Failed to create the timer.
+    return pContext->pFrameArena;
+}
+
+void drge_get_frame_time_stats(drge_context* pContext, int timing, drge_histogram_summary* pSummaryOut)
+{
+    if (pSummaryOut == NULL) {
+        return;
     }
 
-    int result = drge_main_loop(pContext);
+    if (pContext == NULL || timing < 0 || timing >= DRGE_FRAME_TIME_COUNT) {
+        memset(pSummaryOut, 0, sizeof(*pSummaryOut));
+        return;
+    }
 
-    drge_delete_timer(pContext->pTimer);
-    drge_delete_window(pContext->pWindow);
-    return result;
+    drge_summarize_histogram(&pContext->frameTimes[timing], pSummaryOut);
 }
 
-#ifndef DR_GE_DISABLE_EDITOR
-int drge_open_and_run_editor(drge_context* pContext)
+void drge_reset_frame_time_stats(drge_context* pContext)
 {
-    if (pContext == NULL || pContext->pEditor != NULL) {
-        return -1;
+    if (pContext == NULL) {
+        return;
     }
 
-    // The editor should not already be open.
-    if (pContext->pEditor != NULL) {
-        return -2;
+    // Clearing a histogram while another thread records into it can lose the clear, so the render thread clears the
+    // render timings itself. Everything else is recorded on this thread.
+    for (int timing = 0; timing < DRGE_FRAME_TIME_COUNT; ++timing) {
+        if (timing == DRGE_FRAME_TIME_RENDER && pContext->renderThread != NULL) {
+            drge_atomic_store_64(&pContext->isRenderTimeResetPending, 1);
+        } else {
+            drge_init_histogram(&pContext->frameTimes[timing]);
+        }
     }
+}
 
-    pContext->pEditor = drge_create_editor(pContext);
-    if (pContext->pEditor == NULL) {
-        return -3;
+void drge_step(drge_context* pContext, double dtSeconds)
+{
+    if (pContext == NULL) {
+        return;
     }
 
-    int result = drge_editor_run(pContext->pEditor);
+    (void)dtSeconds;
+}
 
-    drge_delete_editor(pContext->pEditor);
-    pContext->pEditor = NULL;
+void drge_build_render_state(drge_context* pContext, drge_render_state* pState)
+{
+    if (pContext == NULL || pState == NULL) {
+        return;
+    }
+}
 
-    return result;
+void drge_render(drge_context* pContext, const drge_render_state* pState)
+{
+    if (pContext == NULL || pState == NULL) {
+        return;
+    }
 }
-#endif
 
 
-bool drge_wants_to_close(drge_context* pContext)
+
+drfs_context* drge_get_vfs(drge_context* pContext)
 {
     if (pContext == NULL) {
-        return false;
+        return NULL;
     }
 
-    return pContext->wantsToClose;
+    return pContext->pVFS;
 }
 
-void drge_request_close(drge_context* pContext)
+void drge_begin_graphics_init(drge_context* pContext)
 {
     if (pContext == NULL) {
         return;
     }
 
-    pContext->wantsToClose = true;
+    if (drge_atomic_load_64(&pContext->isVulkanInitialized)) {
+        return;
+    }
+
+    dr_lock_mutex(pContext->graphicsInitLock);
+    {
+        // If the thread can't be created it'll just be done synchronously on first use.
+        if (!pContext->isVulkanInitialized && pContext->graphicsInitThread == NULL) {
+            pContext->graphicsInitThread = dr_create_thread(drge_init_graphics_proc, pContext);
+        }
+    }
+    dr_unlock_mutex(pContext->graphicsInitLock);
 }
 
+drvk_context* drge_get_vulkan(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return NULL;
+    }
+
+    drge_finish_vulkan_init(pContext);
+    return pContext->pVulkan;
+}
 
-static int drge_startup_and_run_cmdline(dr_cmdline cmdline)
+drge_graphics_world* drge_get_graphics_world(drge_context* pContext)
 {
-    drge_context* pContext = drge_create_context_cmdline(cmdline);
     if (pContext == NULL) {
-        return -1;  // Failed to create the main context.
+        return NULL;
     }
 
-    int result = drge_run(pContext);
+    drge_finish_graphics_init(pContext);
+    return pContext->pGraphicsWorld;
+}
 
-    drge_delete_context(pContext);
-    return result;
+bool drge_is_portable(drge_context* pContext)
+{
+    if (pContext == NULL) {
+        return false;
+    }
+
+    return pContext->isPortable;
 }
 
-int drge_startup_and_run(int argc, char** argv)
+bool drge_is_headless(drge_context* pContext)
 {
-    dr_cmdline cmdline;
-    dr_init_cmdline(&cmdline, argc, argv);          // Won't fail in practice.
+    if (pContext == NULL) {
+        return false;
+    }
 
-    return drge_startup_and_run_cmdline(cmdline);
+    return pContext->isHeadless;
 }
 
-int drge_startup_and_run_winmain(char* cmdlineStr)
+drge_job_system* drge_get_job_system(drge_context* pContext)
 {
-    dr_cmdline cmdline;
-    dr_init_cmdline_win32(&cmdline, cmdlineStr);    // Won't fail in practice.
+    if (pContext == NULL) {
+        return NULL;
+    }
 
-    return drge_startup_and_run_cmdline(cmdline);
+    return pContext->pJobs;
 }
 
 
-void drge_do_frame(drge_context* pContext)
+int drge_get_action_id(drge_context* pContext, const char* name)
 {
     if (pContext == NULL) {
-        return;
+        return DRGE_INVALID_INPUT_ID;
     }
 
-    // This function is called by gtge_main_loop() whenever the game needs to be stepped and rendered. We are keeping it simple and doing
-    // everything in a single thread. We step the game first, and then render.
-    drge_step(pContext);
-    drge_render(pContext);
+    return drge_input_map_find_action(&pContext->input, name);
 }
 
-void drge_step(drge_context* pContext)
+int drge_get_axis_id(drge_context* pContext, const char* name)
 {
     if (pContext == NULL) {
-        return;
+        return DRGE_INVALID_INPUT_ID;
     }
 
-    //double dtSeconds = drge_tick_timer(pContext->pTimer);
+    return drge_input_map_find_axis(&pContext->input, name);
 }
 
-void drge_render(drge_context* pContext)
+bool drge_is_action_down(drge_context* pContext, int actionID)
 {
-    if (pContext == NULL) {
+    // The unsigned cast handles DRGE_INVALID_INPUT_ID and other negative IDs in the same comparison.
+    if (pContext == NULL || (unsigned int)actionID >= pContext->input.actionCount) {
+        return false;
+    }
+
+    return pContext->input.actionStates[actionID];
+}
+
+float drge_get_axis(drge_context* pContext, int axisID)
+{
+    if (pContext == NULL || (unsigned int)axisID >= pContext->input.axisCount) {
+        return 0;
+    }
+
+    return pContext->input.axisValues[axisID];
+}
+
+void drge_set_action_down(drge_context* pContext, int actionID, bool isDown)
+{
+    if (pContext == NULL || (unsigned int)actionID >= pContext->input.actionCount) {
+        return;
+    }
+
+    if (pContext->pReplay != NULL && pContext->isReplaying) {
         return;
     }
+
+    drge_update_action(pContext, (unsigned int)actionID, isDown);
 }
 
+void drge_set_axis(drge_context* pContext, int axisID, float value)
+{
+    if (pContext == NULL || (unsigned int)axisID >= pContext->input.axisCount) {
+        return;
+    }
+
+    if (value < -1) {
+        value = -1;
+    }
+    if (value > 1) {
+        value = 1;
+    }
 
-drfs_context* drge_get_vfs(drge_context* pContext)
+    if (pContext->pReplay != NULL && pContext->isReplaying) {
+        return;
+    }
+
+    drge_update_axis(pContext, (unsigned int)axisID, value);
+}
+
+const drge_raw_input_event* drge_get_step_raw_input(drge_context* pContext, unsigned int* pCountOut)
 {
-    if (pContext == NULL) {
+    if (pCountOut != NULL) {
+        *pCountOut = 0;
+    }
+
+    if (pContext == NULL || pCountOut == NULL) {
         return NULL;
     }
 
-    return pContext->pVFS;
+    *pCountOut = pContext->stepRawInputEventCount;
+    return pContext->stepRawInputEvents;
 }
 
-bool drge_is_portable(drge_context* pContext)
+
+bool drge_is_log_enabled(drge_context* pContext, int level, int category)
 {
-    if (pContext == NULL) {
+    if (pContext == NULL || level < DRGE_MIN_LOG_LEVEL || level < pContext->logLevel) {
         return false;
     }
 
-    return pContext->isPortable;
+    // Warnings and errors are never filtered by category.
+    if (level < DRGE_LOG_LEVEL_WARNING && (category < 0 || category >= DRGE_LOG_CATEGORY_COUNT || (pContext->logCategoryMask & (1U << category)) == 0)) {
+        return false;
+    }
+
+    return true;
 }
 
+void drge_set_log_level(drge_context* pContext, int level)
+{
+    if (pContext == NULL || level < 0 || level >= DRGE_LOG_LEVEL_COUNT) {
+        return;
+    }
 
-void drge_log(drge_context* pContext, const char* message)
+    pContext->logLevel = level;
+}
+
+void drge_set_log_category_enabled(drge_context* pContext, int category, bool enabled)
 {
-    if (pContext == NULL || message == NULL) {
+    if (pContext == NULL || category < 0 || category >= DRGE_LOG_CATEGORY_COUNT) {
         return;
     }
 
-    // Log file.
-    if (pContext->pLogFile != NULL)
-    {
-        char dateTime[64];
-        dr_datetime_short(dr_now(), dateTime, sizeof(dateTime));
+    if (enabled) {
+        pContext->logCategoryMask |= (1U << category);
+    } else {
+        pContext->logCategoryMask &= ~(1U << category);
+    }
+}
+
+static void drge_log_messagev(drge_context* pContext, int level, int category, const char* format, va_list args)
+{
+    assert(pContext != NULL);
+    assert(format != NULL);
 
-        drfs_write_string(pContext->pLogFile, "[");
-        drfs_write_string(pContext->pLogFile, dateTime);
-        drfs_write_string(pContext->pLogFile, "]");
-        drfs_write_line  (pContext->pLogFile, message);
-        drfs_flush(pContext->pLogFile);
+    // The filter must be checked before formatting. Most debug messages are thrown away, and formatting is by far the
+    // most expensive part of posting a message.
+    if (!drge_is_log_enabled(pContext, level, category)) {
+        return;
     }
 
+    char msg[4096];
+    vsnprintf(msg, sizeof(msg), format, args);
+
+    drge_logger_post(pContext->pLogger, level, category, msg);
+}
+
+void drge_log_message(drge_context* pContext, int level, int category, const char* message)
+{
+    if (pContext == NULL || message == NULL) {
+        return;
+    }
 
-    // Terminal.
-    if (!pContext->isTerminalOutputDisabled) {
-        printf("%s\n", message);
+    if (!drge_is_log_enabled(pContext, level, category)) {
+        return;
     }
+
+    // The file and terminal output is done on the logger's thread.
+    drge_logger_post(pContext->pLogger, level, category, message);
 }
 
-void drge_logf(drge_context* pContext, const char* format, ...)
+void drge_log_messagef(drge_context* pContext, int level, int category, const char* format, ...)
 {
     if (pContext == NULL || format == NULL) {
         return;
@@ -398,18 +2064,31 @@ void drge_logf(drge_context* pContext, const char* format, ...)
 
     va_list args;
     va_start(args, format);
-    {
-        char msg[4096];
-        vsnprintf(msg, sizeof(msg), format, args);
+    drge_log_messagev(pContext, level, category, format, args);
+    va_end(args);
+}
+
+
+void drge_log(drge_context* pContext, const char* message)
+{
+    drge_log_message(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, message);
+}
 
-        drge_log(pContext, msg);
+void drge_logf(drge_context* pContext, const char* format, ...)
+{
+    if (pContext == NULL || format == NULL) {
+        return;
     }
+
+    va_list args;
+    va_start(args, format);
+    drge_log_messagev(pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_GENERAL, format, args);
     va_end(args);
 }
 
 void drge_warning(drge_context* pContext, const char* message)
 {
-    drge_logf(pContext, "[WARNING] %s", message);
+    drge_log_message(pContext, DRGE_LOG_LEVEL_WARNING, DRGE_LOG_CATEGORY_GENERAL, message);
 }
 
 void drge_warningf(drge_context* pContext, const char* format, ...)
@@ -420,18 +2099,14 @@ void drge_warningf(drge_context* pContext, const char* format, ...)
 
     va_list args;
     va_start(args, format);
-    {
-        char msg[4096];
-        vsnprintf(msg, sizeof(msg), format, args);
-
-        drge_warning(pContext, msg);
-    }
+    drge_log_messagev(pContext, DRGE_LOG_LEVEL_WARNING, DRGE_LOG_CATEGORY_GENERAL, format, args);
     va_end(args);
 }
 
 void drge_error(drge_context* pContext, const char* message)
 {
-    drge_logf(pContext, "[ERROR] %s", message);
+    // Errors are flushed as soon as the log thread sees them rather than at the end of the batch interval.
+    drge_log_message(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_GENERAL, message);
 }
 
 void drge_errorf(drge_context* pContext, const char* format, ...)
@@ -442,12 +2117,7 @@ void drge_errorf(drge_context* pContext, const char* format, ...)
 
     va_list args;
     va_start(args, format);
-    {
-        char msg[4096];
-        vsnprintf(msg, sizeof(msg), format, args);
-
-        drge_error(pContext, msg);
-    }
+    drge_log_messagev(pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_GENERAL, format, args);
     va_end(args);
 }
 
@@ -2,9 +2,37 @@
 
 typedef struct drge_window drge_window;
 typedef struct drge_timer drge_timer;
+typedef struct drge_raw_input drge_raw_input;
 typedef struct drge_editor drge_editor;
 typedef struct drge_graphics_world drge_graphics_world;
 
+// A snapshot of everything that's needed to render a frame. This is built on the simulation thread at the end of each
+// frame and handed to drge_render(), which must not look at live simulation state. This is what allows the simulation
+// of one frame to run at the same time as the rendering of the previous one in pipelined mode.
+typedef struct
+{
+    // The index of the frame the snapshot was built by.
+    unsigned long long frameIndex;
+
+    // How far between the previous step and the next one the frame is, between 0 and 1. Use this to interpolate
+    // between the previous and current state for smooth motion when the frame rate is higher than the step rate.
+    double alpha;
+
+    // The frame arena of the frame the snapshot was built by. Use this rather than drge_frame_alloc() for transient
+    // memory needed while rendering, because in pipelined mode the simulation thread has moved on to the next frame.
+    drge_arena* pFrameArena;
+} drge_render_state;
+
+// The maximum number of frame arenas. Two are used normally, and three in pipelined mode.
+#define DRGE_MAX_FRAME_ARENAS   3
+
+// The frame timings that are tracked by the context. See drge_get_frame_time_stats().
+#define DRGE_FRAME_TIME_TOTAL   0   // The time from the start of one frame to the start of the next.
+#define DRGE_FRAME_TIME_STEP    1   // The time spent stepping the game, for frames that step at least once.
+#define DRGE_FRAME_TIME_RENDER  2   // The time spent rendering. In pipelined mode this is measured on the render thread.
+#define DRGE_FRAME_TIME_INPUT   3   // The time from a raw input event arriving to the step it belongs to starting.
+#define DRGE_FRAME_TIME_COUNT   4
+
 typedef struct drge_context drge_context;
 struct drge_context
 {
@@ -25,10 +53,37 @@ struct drge_context
     // The log file.
     drfs_file* pLogFile;
 
+    // The logger. All log output goes through this so that the thread posting a message never waits on file I/O.
+    drge_logger* pLogger;
+
+    // Messages below this level are discarded before they are formatted.
+    int logLevel;
 
-    // The dr_vulkan context that we'll use for rendering and compute.
+    // A bit for each log category that is enabled. Messages in disabled categories are discarded before they are
+    // formatted, unless they are warnings or errors.
+    unsigned int logCategoryMask;
+
+    // The job system. This is shared by every subsystem that wants to do work in parallel.
+    drge_job_system* pJobs;
+
+
+    // The dr_vulkan context that we'll use for rendering and compute. This is created on first use, so always access it
+    // with drge_get_vulkan().
     drvk_context* pVulkan;
 
+    // Guards the creation of the Vulkan context and graphics world.
+    dr_mutex graphicsInitLock;
+
+    // The thread that's creating the Vulkan context and graphics world in the background, if any.
+    dr_thread graphicsInitThread;
+
+    // Set to 1 once the Vulkan context has been created, whether or not it was successful.
+    volatile long long isVulkanInitialized;
+
+    // Set to 1 once the graphics world has been created, whether or not it was successful. Tools like the model editor
+    // only need the Vulkan context, so the world is created separately on first use.
+    volatile long long isGraphicsWorldInitialized;
+
 
 #ifndef DR_GE_DISABLE_EDITOR
     // A pointer to the object representing the editor.
@@ -42,6 +97,12 @@ struct drge_context
     // Whether or not terminal output is disabled.
     bool isTerminalOutputDisabled;
 
+    // Whether or not the game is running without a window, from --headless.
+    bool isHeadless;
+
+    // The time the context started being created, from drge_get_ticks(). Used for logging startup timing.
+    long long startupTicks;
+
     // Whether or not the context is wanting to close. This is the variable that controls the main game loop.
     bool wantsToClose;
 
@@ -51,6 +112,147 @@ struct drge_context
     // The game name. This is loaded from the config and used as the window title.
     char name[64];
 
+    // The options the game window is created with. This is a combination of DRGE_WINDOW_*.
+    unsigned int windowOptions;
+
+    // The actions and axes declared in the config, and their current state.
+    drge_input_map input;
+
+    // The number of times per second the game is stepped.
+    unsigned int stepRate;
+
+    // The maximum number of steps that will be run in a single frame.
+    unsigned int maxStepsPerFrame;
+
+    // The maximum number of frames per second, or 0 for no limit.
+    unsigned int maxFrameRate;
+
+    // The size of each frame arena in bytes.
+    size_t frameArenaSize;
+
+
+    //// Stepping ////
+
+    // The amount of time that has passed that has not yet been stepped, in seconds. This is always less than a single
+    // step after drge_do_frame() returns.
+    double stepAccumulator;
+
+    // Whether or not the game is idle. See drge_set_idle().
+    bool isIdle;
+
+    // The number of frames that have been started.
+    unsigned long long frameIndex;
+
+    // The arenas backing drge_frame_alloc(). Each frame uses the next one in turn, and resets it before using it.
+    drge_arena frameArenas[DRGE_MAX_FRAME_ARENAS];
+    unsigned int frameArenaCount;
+
+    // The arena of the current frame.
+    drge_arena* pFrameArena;
+
+    // When not zero, each frame advances the game by exactly this many seconds rather than by the time that has actually
+    // passed. Headless mode uses this so that runs are repeatable regardless of how fast the machine is.
+    double fixedFrameSeconds;
+
+    // The game closes after this many frames, or 0 for no limit. Set with --frames.
+    unsigned long long maxFrameCount;
+
+
+    //// Raw Input ////
+
+    // The thread reading raw input, or null if raw input isn't available.
+    drge_raw_input* pRawInput;
+
+    // The queue the input thread pushes raw input onto.
+    drge_raw_input_queue rawInputQueue;
+
+    // The raw input events for the step that's running. See drge_get_step_raw_input().
+    drge_raw_input_event stepRawInputEvents[DRGE_RAW_INPUT_QUEUE_SIZE];
+    unsigned int stepRawInputEventCount;
+
+
+    //// Rendering ////
+
+    // Whether or not rendering is pipelined with simulation. This is set from the config or command line and must not
+    // be changed while the game is running.
+    bool isPipelined;
+
+    // Whether or not frames are rendered. This is always on unless running headless without --headless-render.
+    bool isRenderingEnabled;
+
+    // The render states. In pipelined mode the simulation thread builds one while the render thread renders the
+    // other. In single threaded mode only the first one is used.
+    drge_render_state renderStates[2];
+
+    // The index of the render state the simulation thread will build next.
+    unsigned int renderStateWriteIndex;
+
+    // The index of the render state the render thread will render next.
+    unsigned int renderStateReadIndex;
+
+    // The render thread, in pipelined mode.
+    dr_thread renderThread;
+
+    // The number of render states that can be built without overwriting one that hasn't been rendered yet.
+    dr_semaphore renderStateFreeSemaphore;
+
+    // The number of render states that have been built and are waiting to be rendered.
+    dr_semaphore renderStateReadySemaphore;
+
+    // Set to 1 when the render thread should exit. The render thread only exits once it's rendered every render state
+    // that's been posted, which it knows from comparing these counts.
+    volatile long long isRenderThreadStopping;
+    volatile long long renderStatePostedCount;
+    volatile long long renderStateRenderedCount;
+
+    // Set to 1 when the render timings need to be cleared. The render thread records into them, so it's the one that
+    // clears them. See drge_reset_frame_time_stats().
+    volatile long long isRenderTimeResetPending;
+
+
+    //// Profiling ////
+
+    // The file to write a trace to, from --trace. This is cleared once the trace has been written.
+    char tracePath[DRFS_MAX_PATH];
+
+    // The first frame to trace and the number of frames to trace, from --trace-first-frame and --trace-frame-count.
+    unsigned long long traceFirstFrame;
+    unsigned long long traceFrameCount;
+
+
+    //// Statistics ////
+
+    // Frame timing histograms, indexed by DRGE_FRAME_TIME_*. These are always recorded.
+    drge_histogram frameTimes[DRGE_FRAME_TIME_COUNT];
+
+    // How often the frame timing statistics are written to the log in seconds, from --stats, or 0 to never write them.
+    double statsLogInterval;
+
+    // When the frame timing statistics were last written to the log, from drge_get_ticks().
+    long long statsLogTicks;
+
+    // The number of allocations for each memory tag when the statistics were last written to the log. Used for the
+    // allocation rate.
+    unsigned long long statsAllocationCounts[DRGE_MEMORY_TAG_COUNT];
+
+
+    //// Replays ////
+
+    // The file to record a replay to with --record, or play one back from with --replay.
+    char replayPath[DRFS_MAX_PATH];
+
+    // Whether or not replayPath is being played back rather than recorded.
+    bool isReplaying;
+
+    // The replay that's being recorded or played back, and the file it's in.
+    drge_replay* pReplay;
+    drfs_file* pReplayFile;
+
+    // When recording started, from drge_get_ticks(). Events are timestamped relative to this.
+    long long replayStartTicks;
+
+    // The number of frames that have been recorded or played back.
+    unsigned long long replayFrameCount;
 
 
 
@@ -78,6 +280,9 @@ void drge_delete_context(drge_context* pContext);
 int drge_run(drge_context* pContext);
 
 // Enters into the main game loop.
+//
+// With --headless, no window is created and the game is run as fast as possible with a fixed time step for each frame.
+// Frame timing statistics are logged when it closes.
 int drge_run_game(drge_context* pContext);
 
 #ifndef DR_GE_DISABLE_EDITOR
@@ -106,13 +311,74 @@ int drge_startup_and_run_winmain(char* cmdlineStr);
 
 
 // Updates and renders a single frame.
+//
+// The game is stepped at a fixed rate regardless of the frame rate. Depending on how much time has passed since the
+// previous frame, this will step the game zero or more times before rendering. The number of steps per frame is capped
+// so that a slow frame can't snowball into ever slower frames; when the cap is hit the game slows down instead.
+//
+// In pipelined mode this only steps the game and builds a render state. The render state is then rendered on the
+// render thread while the next frame is being stepped.
 void drge_do_frame(drge_context* pContext);
 
-// Steps the game by a single frame. This does not render anything.
-void drge_step(drge_context* pContext);
+// Sets the maximum number of frames per second. Set to 0 for no limit.
+void drge_set_max_frame_rate(drge_context* pContext, unsigned int maxFrameRate);
+
+// Retrieves the maximum number of frames per second, or 0 if there is no limit.
+unsigned int drge_get_max_frame_rate(drge_context* pContext);
+
+// Puts the game into or out of idle mode.
+//
+// While idle, the main loop only does a frame when a window event arrives and otherwise sleeps. Use this when nothing
+// is animating, such as on a static menu screen, so the game doesn't use any CPU while it sits there. Time spent
+// waiting for events is not stepped.
+void drge_set_idle(drge_context* pContext, bool isIdle);
+
+// Determines whether or not the game is in idle mode.
+bool drge_is_idle(drge_context* pContext);
+
+// Allocates transient memory that stays valid until the end of the next frame. This is just a pointer increment, and
+// the memory is never freed; it's reused two frames later. Use it for scratch data such as formatted strings, culling
+// lists and command lists. The memory is aligned to 16 bytes and is not cleared.
+//
+// This can be called from any thread, including jobs, as long as the memory is not allocated or used past the end of
+// the next frame. Returns null if the frame arena is full or if the game loop is not running. The size of the arena is
+// set with FrameArenaSize in the config.
+void* drge_frame_alloc(drge_context* pContext, size_t size);
+
+// Retrieves the arena of the current frame. See drge_frame_alloc().
+drge_arena* drge_get_frame_arena(drge_context* pContext);
+
+// Retrieves a summary of one of the frame timings, which is one of DRGE_FRAME_TIME_*. This covers every frame since the
+// statistics were last reset. The statistics are reset each time they're written to the log when --stats is used.
+//
+// The percentiles are accurate to within 12.5%, which is enough to tell a hitch from normal variation. The minimum,
+// average and maximum are exact.
+void drge_get_frame_time_stats(drge_context* pContext, int timing, drge_histogram_summary* pSummaryOut);
+
+// Clears the frame timing statistics. Use this after loading to get statistics for gameplay only.
+//
+// In pipelined mode the render timings are cleared by the render thread before it records it's next sample, so they can
+// still show the frame that was being rendered when this was called.
+void drge_reset_frame_time_stats(drge_context* pContext);
+
+// Retrieves the raw input events for the step that's running, oldest first. Each step gets the events that arrived
+// during the stretch of real time it covers, so fast input is spread across steps rather than bunched up on the first
+// step of a frame. Only call this from drge_step(). The events are only valid until the step returns.
+//
+// Raw input is recorded in replays. While a replay is being played back the events come from the replay, with their
+// ticks placed the same distance from the end of the step as when they were recorded.
+const drge_raw_input_event* drge_get_step_raw_input(drge_context* pContext, unsigned int* pCountOut);
+
+// Steps the game by a single fixed time step. This does not render anything.
+void drge_step(drge_context* pContext, double dtSeconds);
+
+// Fills the given render state with a snapshot of the current state of the game. This is called on the simulation
+// thread after stepping.
+void drge_build_render_state(drge_context* pContext, drge_render_state* pState);
 
-// Renders the game based on it's current state.
-void drge_render(drge_context* pContext);
+// Renders the given render state. In pipelined mode this is called on the render thread at the same time as the next
+// frame is being stepped, so it must only read from the render state and never from live simulation state.
+void drge_render(drge_context* pContext, const drge_render_state* pState);
 
 
 // Retrieves a pointer to the object representing the file system of the given context.
@@ -121,6 +387,88 @@ drfs_context* drge_get_vfs(drge_context* pContext);
 // Determines whether or not the game is running in portable mode.
 bool drge_is_portable(drge_context* pContext);
 
+// Determines whether or not the game is running headless, which is without a window. Frames are only rendered in
+// headless mode when --headless-render is used, in which case they are rendered offscreen.
+bool drge_is_headless(drge_context* pContext);
+
+// Retrieves the job system of the given context. Use this for anything that should run in parallel rather than creating
+// threads.
+drge_job_system* drge_get_job_system(drge_context* pContext);
+
+
+// Starts creating the Vulkan context and graphics world on a background thread and returns immediately. Does nothing if
+// they have already been created or are being created.
+//
+// Graphics is created on first use, but it's slow to initialize so it's worth calling this as early as possible when
+// it's known that graphics will be needed. This is done automatically when creating a context, except for editor
+// sessions.
+void drge_begin_graphics_init(drge_context* pContext);
+
+// Retrieves the Vulkan context, creating it if necessary. This will block if it's being created in the background. This
+// doesn't create the graphics world, unless it was already being created in the background.
+//
+// Returns null if Vulkan is not available.
+drvk_context* drge_get_vulkan(drge_context* pContext);
+
+// Retrieves the graphics world, creating it if necessary. This will block if it's being created in the background.
+//
+// Returns null if Vulkan is not available.
+drge_graphics_world* drge_get_graphics_world(drge_context* pContext);
+
+
+// Retrieves the ID of the action with the given name, as declared with "Action" in the config. Returns
+// DRGE_INVALID_INPUT_ID if no such action exists.
+//
+// This does a string lookup so it should be called once and the ID kept for polling with drge_is_action_down().
+int drge_get_action_id(drge_context* pContext, const char* name);
+
+// Retrieves the ID of the axis with the given name, as declared with "Axis" in the config. Returns
+// DRGE_INVALID_INPUT_ID if no such axis exists.
+//
+// This does a string lookup so it should be called once and the ID kept for polling with drge_get_axis().
+int drge_get_axis_id(drge_context* pContext, const char* name);
+
+// Determines whether or not the given action is currently down. Returns false for invalid IDs.
+bool drge_is_action_down(drge_context* pContext, int actionID);
+
+// Retrieves the current value of the given axis, between -1 and +1. Returns 0 for invalid IDs.
+float drge_get_axis(drge_context* pContext, int axisID);
+
+// Sets whether or not the given action is down. This is how the platform layer and input bindings feed input to the game.
+//
+// Changes are recorded when recording a replay with --record. While a replay is being played back this does nothing,
+// because the input comes from the replay instead.
+void drge_set_action_down(drge_context* pContext, int actionID, bool isDown);
+
+// Sets the value of the given axis. The value is clamped to between -1 and +1. This is recorded and ignored in the same
+// way as drge_set_action_down() when a replay is being recorded or played back.
+void drge_set_axis(drge_context* pContext, int axisID, float value);
+
+
+// Determines whether or not a message of the given level and category would be logged. Use this to skip work that
+// is only needed for building a log message.
+bool drge_is_log_enabled(drge_context* pContext, int level, int category);
+
+// Sets the minimum level of messages that are logged. This cannot go below DRGE_MIN_LOG_LEVEL.
+void drge_set_log_level(drge_context* pContext, int level);
+
+// Enables or disables logging of messages in the given category. Warnings and errors are always logged.
+void drge_set_log_category_enabled(drge_context* pContext, int category, bool enabled);
+
+// Posts a log message with the given level and category.
+void drge_log_message(drge_context* pContext, int level, int category, const char* message);
+
+// Posts a formatted log message with the given level and category. Nothing is formatted if the message is filtered.
+void drge_log_messagef(drge_context* pContext, int level, int category, const char* format, ...);
+
+// Posts a formatted debug message. This compiles to nothing when DRGE_MIN_LOG_LEVEL is above DRGE_LOG_LEVEL_DEBUG,
+// including the evaluation of the arguments.
+#if DRGE_MIN_LOG_LEVEL <= DRGE_LOG_LEVEL_DEBUG
+#define drge_debugf(pContext, category, ...) drge_log_messagef((pContext), DRGE_LOG_LEVEL_DEBUG, (category), __VA_ARGS__)
+#else
+#define drge_debugf(pContext, category, ...) ((void)0)
+#endif
+
 
 // Posts a log message.
 void drge_log(drge_context* pContext, const char* message);
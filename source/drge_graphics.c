@@ -63,7 +63,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
         return NULL;
     }
 
-    drge_graphics_world* pWorld = malloc(sizeof(*pWorld));
+    drge_graphics_world* pWorld = DRGE_MALLOC(sizeof(*pWorld), DRGE_MEMORY_TAG_GRAPHICS);
     if (pWorld == NULL) {
         return NULL;
     }
@@ -75,7 +75,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
     drvk_queue* pQueues[2];
     VkResult result = drvkFindQueuesWithFlags(pWorld->pVulkan, pWorld->primaryDeviceIndex, VK_QUEUE_GRAPHICS_BIT, 2, pQueues);
     if (result != VK_SUCCESS) {
-        free(pWorld);
+        DRGE_FREE(pWorld);
         return NULL;
     }
     
@@ -90,7 +90,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
     bufferAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     result = vkAllocateCommandBuffers(pWorld->primaryDevice, &bufferAllocInfo, &pWorld->resourceCmdBuffer);
     if (result != VK_SUCCESS) {
-        free(pWorld);
+        DRGE_FREE(pWorld);
         return NULL;
     }
 
@@ -101,7 +101,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
     pWorld->hostTransferBufferSize = 0;
     result = drge_graphics_world__resize_host_transfer_buffer(pWorld, 2048*2048*4);
     if (result != VK_SUCCESS) {
-        free(pWorld);
+        DRGE_FREE(pWorld);
         return NULL;
     }
 
@@ -112,6 +112,31 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
 
 
 
+    // GPU profiling. Not every device supports timestamps so this is optional.
+    pWorld->timestampQueryPool = NULL;
+    pWorld->timestampPeriod    = 1;
+    pWorld->gpuScopeCount      = 0;
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(drvkGetPhysicalDevice(pVulkan, pWorld->primaryDeviceIndex), &deviceProperties);
+    if (deviceProperties.limits.timestampComputeAndGraphics)
+    {
+        VkQueryPoolCreateInfo queryPoolInfo;
+        queryPoolInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.pNext              = NULL;
+        queryPoolInfo.flags              = 0;
+        queryPoolInfo.queryType          = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount         = DRGE_GRAPHICS_MAX_GPU_SCOPES*2;
+        queryPoolInfo.pipelineStatistics = 0;
+        if (vkCreateQueryPool(pWorld->primaryDevice, &queryPoolInfo, NULL, &pWorld->timestampQueryPool) != VK_SUCCESS) {
+            pWorld->timestampQueryPool = NULL;
+        }
+
+        pWorld->timestampPeriod = deviceProperties.limits.timestampPeriod;
+    }
+
+
+
     // Everything below is temp.
     //pWorld->pGraphicsQueue = drvkFindFirstQueueWithFlags(pVulkan, 0, VK_QUEUE_GRAPHICS_BIT);
     pWorld->pGraphicsQueue = pQueues[1];
@@ -207,6 +232,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
         return NULL;
     }
 
+    uint32_t clearScope = drge_graphics_world_begin_gpu_scope(pWorld, setupCmdBuffer[0], "Clear render target");
     {
         VkImageMemoryBarrier barrier;
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -245,6 +271,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
         barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         vkCmdPipelineBarrier(setupCmdBuffer[0], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
     }
+    drge_graphics_world_end_gpu_scope(pWorld, setupCmdBuffer[0], clearScope);
 
     result = vkEndCommandBuffer(setupCmdBuffer[0]);
     if (result != VK_SUCCESS) {
@@ -302,6 +329,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
         return NULL;
     }
 
+    uint32_t readbackScope = drge_graphics_world_begin_gpu_scope(pWorld, setupCmdBuffer[1], "Read back render target");
     {
         VkImageMemoryBarrier barrier;
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -344,6 +372,7 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
         barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
         vkCmdPipelineBarrier(setupCmdBuffer[1], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
     }
+    drge_graphics_world_end_gpu_scope(pWorld, setupCmdBuffer[1], readbackScope);
 
     result = vkEndCommandBuffer(setupCmdBuffer[1]);
     if (result != VK_SUCCESS) {
@@ -369,6 +398,8 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
         return NULL;
     }
 
+    drge_graphics_world_collect_gpu_scopes(pWorld);
+
 
     VkMappedMemoryRange memoryRange;
     memoryRange.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
@@ -405,7 +436,91 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan)
 
 void drge_delete_graphics_world(drge_graphics_world* pWorld)
 {
-    free(pWorld);
+    if (pWorld == NULL) {
+        return;
+    }
+
+    if (pWorld->timestampQueryPool) {
+        vkDestroyQueryPool(pWorld->primaryDevice, pWorld->timestampQueryPool, NULL);
+    }
+
+    DRGE_FREE(pWorld);
+}
+
+
+
+//// Profiling ////
+
+uint32_t drge_graphics_world_begin_gpu_scope(drge_graphics_world* pWorld, VkCommandBuffer cmdBuffer, const char* name)
+{
+    if (pWorld == NULL || cmdBuffer == NULL || pWorld->timestampQueryPool == NULL) {
+        return DRGE_INVALID_GPU_SCOPE;
+    }
+
+    if (pWorld->gpuScopeCount == DRGE_GRAPHICS_MAX_GPU_SCOPES) {
+        return DRGE_INVALID_GPU_SCOPE;
+    }
+
+    uint32_t scopeIndex = pWorld->gpuScopeCount++;
+    pWorld->gpuScopeNames[scopeIndex]       = name;
+    pWorld->gpuScopeRecordTicks[scopeIndex] = drge_get_ticks();
+
+    vkCmdResetQueryPool(cmdBuffer, pWorld->timestampQueryPool, scopeIndex*2, 2);
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pWorld->timestampQueryPool, scopeIndex*2 + 0);
+
+    return scopeIndex;
+}
+
+void drge_graphics_world_end_gpu_scope(drge_graphics_world* pWorld, VkCommandBuffer cmdBuffer, uint32_t scopeIndex)
+{
+    if (pWorld == NULL || cmdBuffer == NULL || scopeIndex >= pWorld->gpuScopeCount) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pWorld->timestampQueryPool, scopeIndex*2 + 1);
+}
+
+void drge_graphics_world_collect_gpu_scopes(drge_graphics_world* pWorld)
+{
+    if (pWorld == NULL || pWorld->gpuScopeCount == 0) {
+        return;
+    }
+
+    // Each query gives back it's timestamp followed by whether or not it's available. A scope that was never ended, or
+    // hasn't finished executing, won't be available and is skipped rather than waited on.
+    uint64_t results[DRGE_GRAPHICS_MAX_GPU_SCOPES*2][2];
+    VkResult result = vkGetQueryPoolResults(pWorld->primaryDevice, pWorld->timestampQueryPool, 0, pWorld->gpuScopeCount*2, sizeof(results), results, sizeof(results[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result == VK_SUCCESS || result == VK_NOT_READY)
+    {
+        // GPU timestamps are on a different clock to drge_get_ticks(). A scope can't start on the GPU before it was
+        // recorded on the CPU, so the earliest scope is lined up with the time it was recorded and everything else is
+        // placed relative to it. Durations and the spacing between scopes are exact.
+        uint32_t earliestScope = DRGE_INVALID_GPU_SCOPE;
+        for (uint32_t iScope = 0; iScope < pWorld->gpuScopeCount; ++iScope) {
+            if (results[iScope*2 + 0][1] && results[iScope*2 + 1][1]) {
+                if (earliestScope == DRGE_INVALID_GPU_SCOPE || results[iScope*2][0] < results[earliestScope*2][0]) {
+                    earliestScope = iScope;
+                }
+            }
+        }
+
+        if (earliestScope != DRGE_INVALID_GPU_SCOPE)
+        {
+            double ticksPerTimestamp = pWorld->timestampPeriod * (drge_get_tick_frequency() / 1000000000.0);
+            uint64_t baseTimestamp = results[earliestScope*2][0];
+            long long baseTicks = pWorld->gpuScopeRecordTicks[earliestScope];
+
+            for (uint32_t iScope = 0; iScope < pWorld->gpuScopeCount; ++iScope) {
+                if (results[iScope*2 + 0][1] && results[iScope*2 + 1][1]) {
+                    long long beginTicks = baseTicks + (long long)((results[iScope*2 + 0][0] - baseTimestamp) * ticksPerTimestamp);
+                    long long endTicks   = baseTicks + (long long)((results[iScope*2 + 1][0] - baseTimestamp) * ticksPerTimestamp);
+                    drge_profile_gpu_scope(pWorld->gpuScopeNames[iScope], beginTicks, endTicks);
+                }
+            }
+        }
+    }
+
+    pWorld->gpuScopeCount = 0;
 }
 
 
@@ -516,7 +631,7 @@ drge_graphics_resource* drge_graphics_world_create_texture_resource(drge_graphic
 
 
     // Everything should be good at this point.
-    drge_graphics_texture_resource* pTextureResource = malloc(sizeof(*pTextureResource));
+    drge_graphics_texture_resource* pTextureResource = DRGE_MALLOC(sizeof(*pTextureResource), DRGE_MEMORY_TAG_GRAPHICS);
     if (pTextureResource == NULL) {
         goto on_error;
     }
@@ -558,7 +673,7 @@ void drge_graphics_world_delete_texture_resource(drge_graphics_resource* pResour
     vkDestroyImage(pResource->pWorld->primaryDevice, pTextureResource->image, NULL);
     vkFreeMemory(pResource->pWorld->primaryDevice, pTextureResource->imageMemory, NULL);
 
-    free(pTextureResource);
+    DRGE_FREE(pTextureResource);
 }
 
 size_t drge_graphics_world_get_texture_data(drge_graphics_resource* pResource, void* pDataOut)
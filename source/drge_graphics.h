@@ -110,6 +110,12 @@ struct drge_graphics_mesh_resource
 };
 
 
+// The maximum number of GPU scopes that can be recorded between calls to drge_graphics_world_collect_gpu_scopes().
+#define DRGE_GRAPHICS_MAX_GPU_SCOPES    64
+
+// The value returned by drge_graphics_world_begin_gpu_scope() when the scope is not being recorded.
+#define DRGE_INVALID_GPU_SCOPE          UINT32_MAX
+
 struct drge_graphics_world
 {
     // The Vulkan context.
@@ -138,6 +144,21 @@ struct drge_graphics_world
     VkDeviceSize hostTransferBufferSize;
 
 
+    // The query pool GPU scope timestamps are written to. There are two queries for each scope, one for the beginning
+    // and one for the end. This is null if the device doesn't support timestamps.
+    VkQueryPool timestampQueryPool;
+
+    // The number of nanoseconds per timestamp tick.
+    float timestampPeriod;
+
+    // The number of GPU scopes that have been recorded since they were last collected.
+    uint32_t gpuScopeCount;
+
+    // The name of each GPU scope, and the time it was recorded on the CPU.
+    const char* gpuScopeNames[DRGE_GRAPHICS_MAX_GPU_SCOPES];
+    long long gpuScopeRecordTicks[DRGE_GRAPHICS_MAX_GPU_SCOPES];
+
+
     // TEMP. Everything below is just for testing and getting the basics working.
     drvk_queue* pGraphicsQueue;
 
@@ -152,6 +173,24 @@ drge_graphics_world* drge_create_graphics_world(drvk_context* pVulkan);
 void drge_delete_graphics_world(drge_graphics_world* pWorld);
 
 
+//// Profiling ////
+
+// Begins a GPU profiling scope by writing a timestamp into the given command buffer. Scopes can be nested, but must not
+// span command buffers. The name is not copied, so use a string literal.
+//
+// Scopes are recorded whether or not a trace is in progress so that the ones from creating the world make it into the
+// first trace. Returns the index of the scope to pass to drge_graphics_world_end_gpu_scope(), or DRGE_INVALID_GPU_SCOPE
+// if the device doesn't support timestamps or too many scopes have been recorded since they were last collected.
+uint32_t drge_graphics_world_begin_gpu_scope(drge_graphics_world* pWorld, VkCommandBuffer cmdBuffer, const char* name);
+
+// Ends a GPU profiling scope by writing a timestamp into the given command buffer.
+void drge_graphics_world_end_gpu_scope(drge_graphics_world* pWorld, VkCommandBuffer cmdBuffer, uint32_t scopeIndex);
+
+// Reads back the timestamps of the GPU scopes recorded since the last call and passes them on to the profiler. Call this
+// once the command buffers containing the scopes have finished executing. Scopes that haven't finished are dropped.
+void drge_graphics_world_collect_gpu_scopes(drge_graphics_world* pWorld);
+
+
 //// Resources ////
 
 // Creates a texture resource.
@@ -0,0 +1,136 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+static int drge_input_find_name(const char (*names)[DRGE_MAX_INPUT_NAME_LENGTH], unsigned int count, const char* name)
+{
+    assert(names != NULL);
+    assert(name != NULL);
+
+    for (unsigned int i = 0; i < count; ++i) {
+        if (strcmp(names[i], name) == 0) {
+            return (int)i;
+        }
+    }
+
+    return DRGE_INVALID_INPUT_ID;
+}
+
+static int drge_input_add_name(char (*names)[DRGE_MAX_INPUT_NAME_LENGTH], unsigned int* pCount, unsigned int maxCount, const char* name)
+{
+    assert(names != NULL);
+    assert(pCount != NULL);
+    assert(name != NULL);
+
+    int existingID = drge_input_find_name((const char (*)[DRGE_MAX_INPUT_NAME_LENGTH])names, *pCount, name);
+    if (existingID != DRGE_INVALID_INPUT_ID) {
+        return existingID;
+    }
+
+    if (*pCount == maxCount || name[0] == '\0' || strlen(name) >= DRGE_MAX_INPUT_NAME_LENGTH) {
+        return DRGE_INVALID_INPUT_ID;
+    }
+
+    strcpy_s(names[*pCount], DRGE_MAX_INPUT_NAME_LENGTH, name);
+    return (int)(*pCount)++;
+}
+
+
+void drge_init_input_map(drge_input_map* pInputMap)
+{
+    if (pInputMap == NULL) {
+        return;
+    }
+
+    memset(pInputMap, 0, sizeof(*pInputMap));
+}
+
+int drge_input_map_add_action(drge_input_map* pInputMap, const char* name)
+{
+    if (pInputMap == NULL || name == NULL) {
+        return DRGE_INVALID_INPUT_ID;
+    }
+
+    return drge_input_add_name(pInputMap->actionNames, &pInputMap->actionCount, DRGE_MAX_INPUT_ACTIONS, name);
+}
+
+int drge_input_map_add_axis(drge_input_map* pInputMap, const char* name)
+{
+    if (pInputMap == NULL || name == NULL) {
+        return DRGE_INVALID_INPUT_ID;
+    }
+
+    return drge_input_add_name(pInputMap->axisNames, &pInputMap->axisCount, DRGE_MAX_INPUT_AXES, name);
+}
+
+int drge_input_map_find_action(const drge_input_map* pInputMap, const char* name)
+{
+    if (pInputMap == NULL || name == NULL) {
+        return DRGE_INVALID_INPUT_ID;
+    }
+
+    return drge_input_find_name(pInputMap->actionNames, pInputMap->actionCount, name);
+}
+
+int drge_input_map_find_axis(const drge_input_map* pInputMap, const char* name)
+{
+    if (pInputMap == NULL || name == NULL) {
+        return DRGE_INVALID_INPUT_ID;
+    }
+
+    return drge_input_find_name(pInputMap->axisNames, pInputMap->axisCount, name);
+}
+
+
+void drge_init_raw_input_queue(drge_raw_input_queue* pQueue)
+{
+    if (pQueue == NULL) {
+        return;
+    }
+
+    drge_atomic_store_64(&pQueue->pushCount,    0);
+    drge_atomic_store_64(&pQueue->popCount,     0);
+    drge_atomic_store_64(&pQueue->droppedCount, 0);
+}
+
+bool drge_push_raw_input(drge_raw_input_queue* pQueue, const drge_raw_input_event* pEvent)
+{
+    if (pQueue == NULL || pEvent == NULL) {
+        return false;
+    }
+
+    long long pushCount = drge_atomic_load_64(&pQueue->pushCount);
+    if (pushCount - drge_atomic_load_64(&pQueue->popCount) >= DRGE_RAW_INPUT_QUEUE_SIZE) {
+        drge_atomic_fetch_add_64(&pQueue->droppedCount, 1);
+        return false;
+    }
+
+    // The event needs to be written before the count is published since the store is what makes it visible.
+    pQueue->events[pushCount & (DRGE_RAW_INPUT_QUEUE_SIZE - 1)] = *pEvent;
+    drge_atomic_store_64(&pQueue->pushCount, pushCount + 1);
+    return true;
+}
+
+bool drge_peek_raw_input(drge_raw_input_queue* pQueue, drge_raw_input_event* pEventOut)
+{
+    if (pQueue == NULL || pEventOut == NULL) {
+        return false;
+    }
+
+    long long popCount = drge_atomic_load_64(&pQueue->popCount);
+    if (popCount == drge_atomic_load_64(&pQueue->pushCount)) {
+        return false;
+    }
+
+    *pEventOut = pQueue->events[popCount & (DRGE_RAW_INPUT_QUEUE_SIZE - 1)];
+    return true;
+}
+
+bool drge_pop_raw_input(drge_raw_input_queue* pQueue, drge_raw_input_event* pEventOut)
+{
+    if (!drge_peek_raw_input(pQueue, pEventOut)) {
+        return false;
+    }
+
+    // The event is copied out before the slot is handed back to the pushing thread.
+    drge_atomic_fetch_add_64(&pQueue->popCount, 1);
+    return true;
+}
@@ -0,0 +1,116 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Input is exposed to the game as named actions and axes which are declared in config.cfg. An action is either down or
+// up, and an axis ranges between -1 and +1. Names are resolved to dense integer IDs when the config is loaded so that
+// polling input at run time is just an array lookup - look up the ID once and keep hold of it.
+
+// The maximum number of actions and axes that can be declared.
+#define DRGE_MAX_INPUT_ACTIONS      256
+#define DRGE_MAX_INPUT_AXES         64
+
+// The maximum length of an action or axis name, including the null terminator.
+#define DRGE_MAX_INPUT_NAME_LENGTH  64
+
+// The ID returned when an action or axis could not be found or declared.
+#define DRGE_INVALID_INPUT_ID       -1
+
+typedef struct
+{
+    // The number of actions and axes that have been declared. IDs are indices in the range [0, count).
+    unsigned int actionCount;
+    unsigned int axisCount;
+
+    // The state of each action and axis, indexed by ID.
+    bool actionStates[DRGE_MAX_INPUT_ACTIONS];
+    float axisValues[DRGE_MAX_INPUT_AXES];
+
+    // The names of each action and axis, indexed by ID. These are only used for resolving IDs so they're kept after the
+    // state to keep the state that's read every frame close together.
+    char actionNames[DRGE_MAX_INPUT_ACTIONS][DRGE_MAX_INPUT_NAME_LENGTH];
+    char axisNames[DRGE_MAX_INPUT_AXES][DRGE_MAX_INPUT_NAME_LENGTH];
+} drge_input_map;
+
+
+// Initializes an empty input map.
+void drge_init_input_map(drge_input_map* pInputMap);
+
+// Declares an action and returns it's ID. If an action with the same name has already been declared the existing ID is
+// returned.
+//
+// Returns DRGE_INVALID_INPUT_ID if the name is too long or the maximum number of actions has been reached.
+int drge_input_map_add_action(drge_input_map* pInputMap, const char* name);
+
+// Declares an axis and returns it's ID. If an axis with the same name has already been declared the existing ID is
+// returned.
+//
+// Returns DRGE_INVALID_INPUT_ID if the name is too long or the maximum number of axes has been reached.
+int drge_input_map_add_axis(drge_input_map* pInputMap, const char* name);
+
+// Retrieves the ID of the action with the given name, or DRGE_INVALID_INPUT_ID if it has not been declared.
+int drge_input_map_find_action(const drge_input_map* pInputMap, const char* name);
+
+// Retrieves the ID of the axis with the given name, or DRGE_INVALID_INPUT_ID if it has not been declared.
+int drge_input_map_find_axis(const drge_input_map* pInputMap, const char* name);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Raw Input
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Raw input is mouse input straight from the device, before pointer acceleration and without being merged into one
+// event per frame. It's read on an input thread of it's own and timestamped as soon as it arrives, then handed to the
+// step it belongs to through a queue. See drge_get_step_raw_input().
+
+// Raw input event types.
+#define DRGE_RAW_INPUT_MOTION       0
+#define DRGE_RAW_INPUT_BUTTON_DOWN  1
+#define DRGE_RAW_INPUT_BUTTON_UP    2
+
+// The number of events the queue can hold. Must be a power of 2.
+#define DRGE_RAW_INPUT_QUEUE_SIZE   1024
+
+typedef struct
+{
+    // One of DRGE_RAW_INPUT_*.
+    int type;
+
+    // The button, for button events. 1 is the left button, 2 is the middle button and 3 is the right button. 4 and 5
+    // are the wheel being scrolled up and down.
+    unsigned int button;
+
+    // How far the mouse moved, for motion events. This is in device units and is not accelerated.
+    float deltaX;
+    float deltaY;
+
+    // When the event arrived, from drge_get_ticks().
+    long long ticks;
+} drge_raw_input_event;
+
+// A queue for passing raw input events from one thread to another without locking. Only one thread can push and only
+// one thread can pop.
+typedef struct
+{
+    // The number of events that have been pushed and popped. These only ever go up.
+    volatile long long pushCount;
+    volatile long long popCount;
+
+    // The number of events that were dropped because the queue was full.
+    volatile long long droppedCount;
+
+    drge_raw_input_event events[DRGE_RAW_INPUT_QUEUE_SIZE];
+} drge_raw_input_queue;
+
+
+// Initializes an empty raw input queue.
+void drge_init_raw_input_queue(drge_raw_input_queue* pQueue);
+
+// Adds an event to the end of a queue. Returns false, and drops the event, if the queue is full.
+bool drge_push_raw_input(drge_raw_input_queue* pQueue, const drge_raw_input_event* pEvent);
+
+// Retrieves the event at the front of a queue without removing it. Returns false if the queue is empty.
+bool drge_peek_raw_input(drge_raw_input_queue* pQueue, drge_raw_input_event* pEventOut);
+
+// Removes the event at the front of a queue. Returns false if the queue is empty.
+bool drge_pop_raw_input(drge_raw_input_queue* pQueue, drge_raw_input_event* pEventOut);
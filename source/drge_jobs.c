@@ -0,0 +1,747 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+#define DRGE_JOB_QUEUE_MASK             (DRGE_MAX_JOBS_PER_WORKER - 1)
+
+// The number of times an idle worker looks for a job, yielding in between, before going to sleep. Jobs tend to come
+// in bursts so this saves a round trip through the kernel for each one.
+#define DRGE_JOB_WORKER_SPIN_COUNT      64
+
+struct drge_job
+{
+    // The procedure to run and it's user data.
+    drge_job_proc proc;
+    void* pUserData;
+
+    // The counter to decrement when the job has finished. Can be null.
+    drge_job_counter* pCounter;
+
+    // The next job in the list of jobs waiting on the same counter.
+    drge_job* pNextWaitingJob;
+
+    // Set to 1 while the job is in flight. This is cleared by whichever thread ran the job, after which the thread that
+    // owns the job's memory is free to reuse it.
+    volatile long long isInUse;
+};
+
+typedef struct
+{
+    // The job system that owns the worker.
+    drge_job_system* pJobs;
+
+    // The worker's thread. This is null for the thread that created the job system.
+    dr_thread thread;
+
+    // The state for picking which worker to steal from.
+    unsigned int stealSeed;
+
+
+    // The worker's queue is a Chase-Lev deque. The worker pushes and pops jobs at the bottom, and other threads steal
+    // from the top. The two ends are kept on their own cache lines since they're written by different threads.
+    char padding0[64];
+
+    // The position one past the most recently pushed job. Only ever written by the worker.
+    volatile long long bottom;
+
+    char padding1[64 - sizeof(long long)];
+
+    // The position of the oldest job. Advanced by the worker when it pops the last job, and by thieves.
+    volatile long long top;
+
+    char padding2[64 - sizeof(long long)];
+
+    // The jobs in the queue, indexed by position & DRGE_JOB_QUEUE_MASK.
+    drge_job* volatile queue[DRGE_JOB_QUEUE_MASK + 1];
+
+
+    // The memory for jobs that are started from this worker's thread. This is used as a ring, and only ever touched by
+    // this worker's thread except for clearing the isInUse flag.
+    drge_job jobs[DRGE_MAX_JOBS_PER_WORKER];
+    unsigned int nextJob;
+} drge_job_worker;
+
+struct drge_job_system
+{
+    // The number of worker threads, not including the thread that created the job system.
+    unsigned int workerCount;
+
+    // The workers. The first one is the thread that created the job system, which doesn't have a thread of it's own
+    // but has a queue like any other worker so that it can start jobs quickly.
+    drge_job_worker* pWorkers[DRGE_MAX_JOB_WORKERS + 1];
+
+
+    // The number of workers that are asleep, or about to go to sleep.
+    volatile long long sleepingWorkerCount;
+
+    // The semaphore sleeping workers wait on.
+    dr_semaphore wakeSemaphore;
+
+    // Set to 1 when the workers should exit.
+    volatile long long isStopping;
+
+
+    // Jobs started from threads that aren't part of the job system go onto this queue, since only a worker can push
+    // to it's own queue. All of the shared state is guarded by sharedLock except for sharedQueueCount, which can be
+    // read without the lock to save locking it when the queue is empty.
+    dr_mutex sharedLock;
+    volatile long long sharedQueueCount;
+    unsigned int sharedQueueHead;
+    drge_job* sharedQueue[DRGE_JOB_QUEUE_MASK + 1];
+    drge_job sharedJobs[DRGE_MAX_JOBS_PER_WORKER];
+    unsigned int nextSharedJob;
+};
+
+// The worker that belongs to the calling thread, if any.
+static DRGE_THREAD_LOCAL drge_job_worker* g_drgeCurrentJobWorker = NULL;
+
+
+static drge_job_worker* drge_jobs_get_current_worker(drge_job_system* pJobs)
+{
+    drge_job_worker* pWorker = g_drgeCurrentJobWorker;
+    if (pWorker == NULL || pWorker->pJobs != pJobs) {
+        return NULL;
+    }
+
+    return pWorker;
+}
+
+
+// Pushes a job onto the bottom of the worker's queue. Must only be called from the worker's thread. Returns false if
+// the queue is full.
+static bool drge_job_worker_push(drge_job_worker* pWorker, drge_job* pJob)
+{
+    assert(pWorker != NULL);
+    assert(pJob != NULL);
+
+    long long bottom = pWorker->bottom;
+    long long top = drge_atomic_load_64(&pWorker->top);
+    if (bottom - top > DRGE_JOB_QUEUE_MASK) {
+        return false;
+    }
+
+    drge_atomic_store_ptr(&pWorker->queue[bottom & DRGE_JOB_QUEUE_MASK], pJob);
+    drge_atomic_store_64(&pWorker->bottom, bottom + 1);
+    return true;
+}
+
+// Pops the most recently pushed job off the bottom of the worker's queue. Must only be called from the worker's thread.
+static drge_job* drge_job_worker_pop(drge_job_worker* pWorker)
+{
+    assert(pWorker != NULL);
+
+    // Claim the bottom job before looking at the top. The fence makes sure a thief either sees the new bottom, or this
+    // sees the thief's new top, so that they can't both take the same job.
+    long long bottom = pWorker->bottom - 1;
+    drge_atomic_store_64(&pWorker->bottom, bottom);
+    drge_atomic_fence();
+    long long top = drge_atomic_load_64(&pWorker->top);
+
+    if (top > bottom) {
+        drge_atomic_store_64(&pWorker->bottom, bottom + 1);    // The queue was empty.
+        return NULL;
+    }
+
+    drge_job* pJob = drge_atomic_load_ptr(&pWorker->queue[bottom & DRGE_JOB_QUEUE_MASK]);
+    if (top == bottom) {
+        // This is the last job, so a thief could be going for it as well. Whoever advances the top gets it.
+        if (drge_atomic_compare_exchange_64(&pWorker->top, top, top + 1) != top) {
+            pJob = NULL;
+        }
+
+        drge_atomic_store_64(&pWorker->bottom, bottom + 1);
+    }
+
+    return pJob;
+}
+
+// Steals the oldest job off the top of the worker's queue. Can be called from any thread. This returns null if the
+// queue is empty or another thread got to the job first.
+static drge_job* drge_job_worker_steal(drge_job_worker* pWorker)
+{
+    assert(pWorker != NULL);
+
+    long long top = drge_atomic_load_64(&pWorker->top);
+    drge_atomic_fence();
+    long long bottom = drge_atomic_load_64(&pWorker->bottom);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    drge_job* pJob = drge_atomic_load_ptr(&pWorker->queue[top & DRGE_JOB_QUEUE_MASK]);
+    if (drge_atomic_compare_exchange_64(&pWorker->top, top, top + 1) != top) {
+        return NULL;
+    }
+
+    return pJob;
+}
+
+
+static drge_job* drge_jobs_pop_shared(drge_job_system* pJobs)
+{
+    assert(pJobs != NULL);
+
+    if (drge_atomic_load_64(&pJobs->sharedQueueCount) == 0) {
+        return NULL;
+    }
+
+    drge_job* pJob = NULL;
+
+    dr_lock_mutex(pJobs->sharedLock);
+    {
+        if (pJobs->sharedQueueCount > 0) {
+            pJob = pJobs->sharedQueue[pJobs->sharedQueueHead & DRGE_JOB_QUEUE_MASK];
+            pJobs->sharedQueueHead += 1;
+            drge_atomic_fetch_add_64(&pJobs->sharedQueueCount, -1);
+        }
+    }
+    dr_unlock_mutex(pJobs->sharedLock);
+
+    return pJob;
+}
+
+// Finds a job for the calling thread to run. pWorker is the calling thread's worker, or null if it's not part of the
+// job system.
+static drge_job* drge_jobs_find_job(drge_job_system* pJobs, drge_job_worker* pWorker)
+{
+    assert(pJobs != NULL);
+
+    drge_job* pJob;
+    if (pWorker != NULL) {
+        pJob = drge_job_worker_pop(pWorker);
+        if (pJob != NULL) {
+            return pJob;
+        }
+    }
+
+    pJob = drge_jobs_pop_shared(pJobs);
+    if (pJob != NULL) {
+        return pJob;
+    }
+
+    // Start stealing from a random worker so that thieves don't all pile onto the same one.
+    unsigned int firstVictim;
+    if (pWorker != NULL) {
+        pWorker->stealSeed = pWorker->stealSeed*1103515245 + 12345;
+        firstVictim = pWorker->stealSeed >> 16;
+    } else {
+        firstVictim = (unsigned int)drge_get_ticks();
+    }
+
+    unsigned int totalWorkerCount = pJobs->workerCount + 1;
+    for (unsigned int i = 0; i < totalWorkerCount; ++i) {
+        drge_job_worker* pVictim = pJobs->pWorkers[(firstVictim + i) % totalWorkerCount];
+        if (pVictim == pWorker) {
+            continue;
+        }
+
+        pJob = drge_job_worker_steal(pVictim);
+        if (pJob != NULL) {
+            return pJob;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void drge_job_counter_lock(drge_job_counter* pCounter)
+{
+    assert(pCounter != NULL);
+
+    while (drge_atomic_compare_exchange_64(&pCounter->lock, 0, 1) != 0) {
+        while (drge_atomic_load_64(&pCounter->lock) != 0) {
+            drge_yield_thread();
+        }
+    }
+}
+
+static void drge_job_counter_unlock(drge_job_counter* pCounter)
+{
+    assert(pCounter != NULL);
+    drge_atomic_store_64(&pCounter->lock, 0);
+}
+
+
+static void drge_jobs_wake_worker(drge_job_system* pJobs)
+{
+    assert(pJobs != NULL);
+
+    // Pairs with the fence a worker goes through between saying it's going to sleep and checking for jobs one last
+    // time. Either the worker sees the new job, or this sees the worker.
+    drge_atomic_fence();
+    if (drge_atomic_load_64(&pJobs->sleepingWorkerCount) > 0) {
+        dr_release_semaphore(pJobs->wakeSemaphore);
+    }
+}
+
+// Running a job can make waiting jobs ready, and making a job ready can mean running it straight away, hence this
+// forward declaration.
+static void drge_jobs_execute(drge_job_system* pJobs, drge_job* pJob);
+
+// Makes a job available to be run. The job must not be waiting on anything.
+static void drge_jobs_enqueue(drge_job_system* pJobs, drge_job* pJob)
+{
+    assert(pJobs != NULL);
+    assert(pJob != NULL);
+
+    drge_job_worker* pWorker = drge_jobs_get_current_worker(pJobs);
+    if (pWorker != NULL) {
+        if (!drge_job_worker_push(pWorker, pJob)) {
+            drge_jobs_execute(pJobs, pJob);     // The queue is full. Just run it here.
+            return;
+        }
+    } else {
+        bool isQueued = false;
+
+        dr_lock_mutex(pJobs->sharedLock);
+        {
+            if (pJobs->sharedQueueCount <= DRGE_JOB_QUEUE_MASK) {
+                pJobs->sharedQueue[(pJobs->sharedQueueHead + (unsigned int)pJobs->sharedQueueCount) & DRGE_JOB_QUEUE_MASK] = pJob;
+                drge_atomic_fetch_add_64(&pJobs->sharedQueueCount, 1);
+                isQueued = true;
+            }
+        }
+        dr_unlock_mutex(pJobs->sharedLock);
+
+        if (!isQueued) {
+            drge_jobs_execute(pJobs, pJob);
+            return;
+        }
+    }
+
+    drge_jobs_wake_worker(pJobs);
+}
+
+static void drge_jobs_decrement_counter(drge_job_system* pJobs, drge_job_counter* pCounter)
+{
+    assert(pJobs != NULL);
+    assert(pCounter != NULL);
+
+    // Only the decrement that brings the counter to zero needs the lock. It has to hold it from the decrement until
+    // it's done with the counter so that a thread waiting on the counter can't free it out from under it. See
+    // drge_is_job_counter_done().
+    long long count = drge_atomic_load_64(&pCounter->count);
+    while (count > 1) {
+        long long prevCount = drge_atomic_compare_exchange_64(&pCounter->count, count, count - 1);
+        if (prevCount == count) {
+            return;
+        }
+
+        count = prevCount;
+    }
+
+    drge_job* pWaitingJob = NULL;
+
+    drge_job_counter_lock(pCounter);
+    {
+        if (drge_atomic_fetch_add_64(&pCounter->count, -1) == 1) {
+            pWaitingJob = pCounter->pFirstWaitingJob;
+            pCounter->pFirstWaitingJob = NULL;
+        }
+    }
+    drge_job_counter_unlock(pCounter);
+
+    while (pWaitingJob != NULL) {
+        drge_job* pNextWaitingJob = pWaitingJob->pNextWaitingJob;
+        drge_jobs_enqueue(pJobs, pWaitingJob);
+        pWaitingJob = pNextWaitingJob;
+    }
+}
+
+static void drge_jobs_execute(drge_job_system* pJobs, drge_job* pJob)
+{
+    assert(pJobs != NULL);
+    assert(pJob != NULL);
+
+    drge_job_counter* pCounter = pJob->pCounter;
+
+    DRGE_PROFILE_SCOPE("Job")
+    {
+        pJob->proc(pJob->pUserData);
+    }
+
+    // The job's memory can be reused as soon as this is cleared, so nothing in it can be touched after this point.
+    drge_atomic_store_64(&pJob->isInUse, 0);
+
+    if (pCounter != NULL) {
+        drge_jobs_decrement_counter(pJobs, pCounter);
+    }
+}
+
+// Runs a single job if one is available. Returns false if there was nothing to run.
+static bool drge_jobs_run_one(drge_job_system* pJobs, drge_job_worker* pWorker)
+{
+    assert(pJobs != NULL);
+
+    drge_job* pJob = drge_jobs_find_job(pJobs, pWorker);
+    if (pJob == NULL) {
+        return false;
+    }
+
+    drge_jobs_execute(pJobs, pJob);
+    return true;
+}
+
+// Retrieves the memory for a new job. If the calling thread already has the maximum number of jobs in flight this runs
+// other jobs until one of them finishes.
+static drge_job* drge_jobs_alloc_job(drge_job_system* pJobs, drge_job_worker* pWorker)
+{
+    assert(pJobs != NULL);
+
+    drge_job* pJob;
+    if (pWorker != NULL) {
+        for (;;) {
+            pJob = &pWorker->jobs[pWorker->nextJob & DRGE_JOB_QUEUE_MASK];
+            if (drge_atomic_load_64(&pJob->isInUse) == 0) {
+                break;
+            }
+
+            if (!drge_jobs_run_one(pJobs, pWorker)) {
+                drge_yield_thread();
+            }
+        }
+
+        pWorker->nextJob += 1;
+        drge_atomic_store_64(&pJob->isInUse, 1);
+    } else {
+        dr_lock_mutex(pJobs->sharedLock);
+        for (;;) {
+            pJob = &pJobs->sharedJobs[pJobs->nextSharedJob & DRGE_JOB_QUEUE_MASK];
+            if (drge_atomic_load_64(&pJob->isInUse) == 0) {
+                break;
+            }
+
+            dr_unlock_mutex(pJobs->sharedLock);
+            if (!drge_jobs_run_one(pJobs, NULL)) {
+                drge_yield_thread();
+            }
+            dr_lock_mutex(pJobs->sharedLock);
+        }
+
+        pJobs->nextSharedJob += 1;
+        drge_atomic_store_64(&pJob->isInUse, 1);    // Must be set before releasing the lock so no other thread takes it.
+        dr_unlock_mutex(pJobs->sharedLock);
+    }
+
+    return pJob;
+}
+
+
+static int drge_job_worker_thread_proc(void* pUserData)
+{
+    drge_job_worker* pWorker = pUserData;
+    assert(pWorker != NULL);
+
+    drge_job_system* pJobs = pWorker->pJobs;
+    g_drgeCurrentJobWorker = pWorker;
+    drge_profile_set_thread_name("Job worker");
+
+    unsigned int workerIndex = 0;
+    while (pJobs->pWorkers[workerIndex] != pWorker) {
+        workerIndex += 1;
+    }
+
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "Job worker %u", workerIndex);
+    drge_register_current_thread(DRGE_THREAD_ROLE_JOB_WORKER, threadName);
+
+    unsigned int idleCount = 0;
+    while (drge_atomic_load_64(&pJobs->isStopping) == 0) {
+        if (drge_jobs_run_one(pJobs, pWorker)) {
+            idleCount = 0;
+            continue;
+        }
+
+        if (idleCount < DRGE_JOB_WORKER_SPIN_COUNT) {
+            idleCount += 1;
+            drge_yield_thread();
+            continue;
+        }
+
+        // Say we're going to sleep before checking for jobs one last time. Anything that starts a job after this will
+        // see that there's a sleeping worker and wake one up.
+        drge_atomic_fetch_add_64(&pJobs->sleepingWorkerCount, 1);
+        drge_atomic_fence();
+
+        drge_job* pJob = drge_jobs_find_job(pJobs, pWorker);
+        if (pJob == NULL && drge_atomic_load_64(&pJobs->isStopping) == 0) {
+            dr_wait_semaphore(pJobs->wakeSemaphore);
+        }
+
+        drge_atomic_fetch_add_64(&pJobs->sleepingWorkerCount, -1);
+
+        if (pJob != NULL) {
+            drge_jobs_execute(pJobs, pJob);
+        }
+
+        idleCount = 0;
+    }
+
+    g_drgeCurrentJobWorker = NULL;
+    drge_unregister_current_thread();
+    return 0;
+}
+
+
+drge_job_system* drge_create_job_system(unsigned int workerCount)
+{
+    if (workerCount == 0) {
+        unsigned int cpuCount = drge_get_cpu_count();
+        workerCount = (cpuCount > 1) ? cpuCount - 1 : 1;
+    }
+
+    if (workerCount > DRGE_MAX_JOB_WORKERS) {
+        workerCount = DRGE_MAX_JOB_WORKERS;
+    }
+
+
+    drge_job_system* pJobs = DRGE_MALLOC(sizeof(*pJobs), DRGE_MEMORY_TAG_GENERAL);
+    if (pJobs == NULL) {
+        return NULL;
+    }
+
+    memset(pJobs, 0, sizeof(*pJobs));
+
+    pJobs->wakeSemaphore = dr_create_semaphore(0);
+    if (pJobs->wakeSemaphore == NULL) {
+        goto on_error;
+    }
+
+    pJobs->sharedLock = drutil_create_mutex();
+    if (pJobs->sharedLock == NULL) {
+        goto on_error;
+    }
+
+    for (unsigned int i = 0; i < workerCount + 1; ++i) {
+        drge_job_worker* pWorker = DRGE_MALLOC(sizeof(*pWorker), DRGE_MEMORY_TAG_GENERAL);
+        if (pWorker == NULL) {
+            goto on_error;
+        }
+
+        memset(pWorker, 0, sizeof(*pWorker));
+        pWorker->pJobs = pJobs;
+        pWorker->stealSeed = i + 1;
+        pJobs->pWorkers[i] = pWorker;
+    }
+
+    // The calling thread is the first worker. The worker count needs to be set before starting any threads because
+    // workers look at every other worker's queue when they're out of jobs.
+    g_drgeCurrentJobWorker = pJobs->pWorkers[0];
+    pJobs->workerCount = workerCount;
+
+    for (unsigned int i = 1; i < workerCount + 1; ++i) {
+        pJobs->pWorkers[i]->thread = dr_create_thread(drge_job_worker_thread_proc, pJobs->pWorkers[i]);
+        if (pJobs->pWorkers[i]->thread == NULL) {
+            goto on_error;
+        }
+    }
+
+    return pJobs;
+
+
+on_error:
+    drge_delete_job_system(pJobs);
+    return NULL;
+}
+
+void drge_delete_job_system(drge_job_system* pJobs)
+{
+    if (pJobs == NULL) {
+        return;
+    }
+
+    drge_atomic_store_64(&pJobs->isStopping, 1);
+    for (unsigned int i = 0; i < pJobs->workerCount; ++i) {
+        dr_release_semaphore(pJobs->wakeSemaphore);
+    }
+
+    for (unsigned int i = 1; i < pJobs->workerCount + 1; ++i) {
+        if (pJobs->pWorkers[i] != NULL && pJobs->pWorkers[i]->thread != NULL) {
+            dr_wait_and_delete_thread(pJobs->pWorkers[i]->thread);
+        }
+    }
+
+    if (g_drgeCurrentJobWorker != NULL && g_drgeCurrentJobWorker->pJobs == pJobs) {
+        g_drgeCurrentJobWorker = NULL;
+    }
+
+    for (unsigned int i = 0; i < DRGE_MAX_JOB_WORKERS + 1; ++i) {
+        DRGE_FREE(pJobs->pWorkers[i]);
+    }
+
+    if (pJobs->sharedLock != NULL) {
+        dr_delete_mutex(pJobs->sharedLock);
+    }
+
+    if (pJobs->wakeSemaphore != NULL) {
+        dr_delete_semaphore(pJobs->wakeSemaphore);
+    }
+
+    DRGE_FREE(pJobs);
+}
+
+unsigned int drge_get_job_worker_count(drge_job_system* pJobs)
+{
+    if (pJobs == NULL) {
+        return 0;
+    }
+
+    return pJobs->workerCount;
+}
+
+
+void drge_init_job_counter(drge_job_counter* pCounter)
+{
+    if (pCounter == NULL) {
+        return;
+    }
+
+    pCounter->count = 0;
+    pCounter->lock = 0;
+    pCounter->pFirstWaitingJob = NULL;
+}
+
+void drge_run_job(drge_job_system* pJobs, drge_job_proc proc, void* pUserData, drge_job_counter* pCounter, drge_job_counter* pDependency)
+{
+    if (pJobs == NULL || proc == NULL) {
+        return;
+    }
+
+    drge_job* pJob = drge_jobs_alloc_job(pJobs, drge_jobs_get_current_worker(pJobs));
+    pJob->proc = proc;
+    pJob->pUserData = pUserData;
+    pJob->pCounter = pCounter;
+    pJob->pNextWaitingJob = NULL;
+
+    if (pCounter != NULL) {
+        drge_atomic_fetch_add_64(&pCounter->count, 1);
+    }
+
+    // If the dependency hasn't finished the job is parked on it, and is started by whichever job brings it to zero.
+    if (pDependency != NULL) {
+        bool isWaiting = false;
+
+        drge_job_counter_lock(pDependency);
+        {
+            if (drge_atomic_load_64(&pDependency->count) != 0) {
+                pJob->pNextWaitingJob = pDependency->pFirstWaitingJob;
+                pDependency->pFirstWaitingJob = pJob;
+                isWaiting = true;
+            }
+        }
+        drge_job_counter_unlock(pDependency);
+
+        if (isWaiting) {
+            return;
+        }
+    }
+
+    drge_jobs_enqueue(pJobs, pJob);
+}
+
+bool drge_is_job_counter_done(drge_job_counter* pCounter)
+{
+    if (pCounter == NULL) {
+        return true;
+    }
+
+    if (drge_atomic_load_64(&pCounter->count) != 0) {
+        return false;
+    }
+
+    // The thread that brought the counter to zero holds the lock until it's done with it. Waiting for the lock here
+    // means the caller is free to delete the counter as soon as this returns.
+    drge_job_counter_lock(pCounter);
+    drge_job_counter_unlock(pCounter);
+
+    return true;
+}
+
+void drge_wait_for_job_counter(drge_job_system* pJobs, drge_job_counter* pCounter)
+{
+    if (pJobs == NULL || pCounter == NULL) {
+        return;
+    }
+
+    drge_job_worker* pWorker = drge_jobs_get_current_worker(pJobs);
+    while (!drge_is_job_counter_done(pCounter)) {
+        if (!drge_jobs_run_one(pJobs, pWorker)) {
+            drge_yield_thread();
+        }
+    }
+}
+
+
+typedef struct
+{
+    drge_parallel_for_proc proc;
+    void* pUserData;
+    unsigned int count;
+    unsigned int batchSize;
+
+    // The first index of the next batch to be done.
+    volatile long long nextIndex;
+} drge_parallel_for_data;
+
+// Each parallel-for job keeps taking batches until there's none left. This balances the load on its own when some
+// batches take longer than others, without needing a job for every batch.
+static void drge_parallel_for_job(void* pUserData)
+{
+    drge_parallel_for_data* pData = pUserData;
+    assert(pData != NULL);
+
+    for (;;) {
+        long long firstIndex = drge_atomic_fetch_add_64(&pData->nextIndex, pData->batchSize);
+        if (firstIndex >= pData->count) {
+            break;
+        }
+
+        unsigned int count = pData->count - (unsigned int)firstIndex;
+        if (count > pData->batchSize) {
+            count = pData->batchSize;
+        }
+
+        pData->proc(pData->pUserData, (unsigned int)firstIndex, count);
+    }
+}
+
+void drge_parallel_for(drge_job_system* pJobs, unsigned int count, unsigned int batchSize, drge_parallel_for_proc proc, void* pUserData)
+{
+    if (proc == NULL || count == 0) {
+        return;
+    }
+
+    if (pJobs == NULL) {
+        proc(pUserData, 0, count);
+        return;
+    }
+
+    unsigned int threadCount = pJobs->workerCount + 1;
+    if (batchSize == 0) {
+        // A few batches per thread so that threads that finish early have something left to pick up.
+        batchSize = count / (threadCount*4);
+        if (batchSize == 0) {
+            batchSize = 1;
+        }
+    }
+
+    drge_parallel_for_data data;
+    data.proc = proc;
+    data.pUserData = pUserData;
+    data.count = count;
+    data.batchSize = batchSize;
+    data.nextIndex = 0;
+
+    unsigned int batchCount = (count - 1)/batchSize + 1;
+    unsigned int jobCount = (batchCount < threadCount) ? batchCount : threadCount;
+
+    // The calling thread is one of the threads doing batches so it doesn't need a job.
+    drge_job_counter counter;
+    drge_init_job_counter(&counter);
+    for (unsigned int i = 1; i < jobCount; ++i) {
+        drge_run_job(pJobs, drge_parallel_for_job, &data, &counter, NULL);
+    }
+
+    drge_parallel_for_job(&data);
+    drge_wait_for_job_counter(pJobs, &counter);
+}
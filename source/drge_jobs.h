@@ -0,0 +1,87 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The job system is the engine's shared thread pool. Rather than each subsystem creating it's own threads, work is
+// split up into small jobs which are run on a fixed set of worker threads sized to the machine.
+//
+// Each worker has it's own queue of jobs. A job that's started from a worker goes onto that worker's queue, and the
+// worker takes the most recently started job first so it's working with data that's still in cache. A worker that
+// runs out of jobs steals the oldest job from another worker's queue. The thread that created the job system takes
+// part as well, but only while it's waiting on a counter.
+//
+// Completion is tracked with counters. Every job that's started against a counter increments it, and decrements it
+// when it finishes. A job can also depend on a counter, in which case it's not started until the counter reaches
+// zero, which is how chains of dependent work are built without blocking any thread.
+
+typedef struct drge_job_system drge_job_system;
+typedef struct drge_job drge_job;
+
+// The procedure that's run by a job.
+typedef void (* drge_job_proc)(void* pUserData);
+
+// The procedure that's run for each batch of drge_parallel_for(). This is called for the items in the range
+// [firstIndex, firstIndex + count).
+typedef void (* drge_parallel_for_proc)(void* pUserData, unsigned int firstIndex, unsigned int count);
+
+// Tracks completion of a group of jobs. Initialize this with drge_init_job_counter() and treat it as opaque.
+//
+// A counter must not be deleted or reused until drge_wait_for_job_counter() has returned for it, or
+// drge_is_job_counter_done() has returned true.
+typedef struct
+{
+    // The number of jobs started against the counter that haven't finished.
+    volatile long long count;
+
+    // A spin lock guarding the list of waiting jobs.
+    volatile long long lock;
+
+    // The jobs that depend on this counter, and will be started when it reaches zero.
+    drge_job* pFirstWaitingJob;
+} drge_job_counter;
+
+// The maximum number of worker threads.
+#define DRGE_MAX_JOB_WORKERS        64
+
+// The maximum number of jobs each thread can have in flight at a time. Must be a power of 2. A thread that tries to
+// start a job when it's already at the limit runs other jobs until one of it's own finishes.
+#define DRGE_MAX_JOBS_PER_WORKER    4096
+
+
+// Creates a job system and starts it's worker threads.
+//
+// The calling thread takes part in running jobs when it waits on a counter, so a workerCount of 0 creates one worker
+// for each logical processor except one.
+drge_job_system* drge_create_job_system(unsigned int workerCount);
+
+// Stops the worker threads and deletes the job system.
+//
+// This must only be called from the thread that created the job system, and only when every job has finished.
+void drge_delete_job_system(drge_job_system* pJobs);
+
+// Retrieves the number of worker threads, not including the thread that created the job system.
+unsigned int drge_get_job_worker_count(drge_job_system* pJobs);
+
+
+// Initializes a counter.
+void drge_init_job_counter(drge_job_counter* pCounter);
+
+// Starts a job.
+//
+// pCounter is optional, and is incremented straight away and decremented when the job has finished. pDependency is also
+// optional; when it's set the job is not started until that counter reaches zero.
+//
+// This can be called from any thread, including from inside a job. Jobs started from threads that are not part of the
+// job system go onto a shared queue, which is slower.
+void drge_run_job(drge_job_system* pJobs, drge_job_proc proc, void* pUserData, drge_job_counter* pCounter, drge_job_counter* pDependency);
+
+// Determines whether or not every job started against the given counter has finished.
+bool drge_is_job_counter_done(drge_job_counter* pCounter);
+
+// Waits for every job started against the given counter to finish. The calling thread runs other jobs while it waits,
+// so this is safe to call from inside a job.
+void drge_wait_for_job_counter(drge_job_system* pJobs, drge_job_counter* pCounter);
+
+// Calls proc for every item in the range [0, count) in batches of batchSize, spread across the worker threads. This
+// returns when every batch has been done. The calling thread does batches as well.
+//
+// Set batchSize to 0 to have it picked based on the number of worker threads.
+void drge_parallel_for(drge_job_system* pJobs, unsigned int count, unsigned int batchSize, drge_parallel_for_proc proc, void* pUserData);
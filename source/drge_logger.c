@@ -0,0 +1,568 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The number of bytes of a slot that are available for record data.
+#define DRGE_LOGGER_SLOT_PAYLOAD_SIZE   (DRGE_LOGGER_SLOT_SIZE - sizeof(long long))
+
+// The maximum length of a single message. A record can take up at most half of the ring buffer so that a producer
+// waiting on a full buffer is guaranteed to make progress.
+#define DRGE_LOGGER_MAX_MESSAGE_LENGTH  ((DRGE_LOGGER_SLOT_COUNT/2)*DRGE_LOGGER_SLOT_PAYLOAD_SIZE - sizeof(drge_logger_record_header))
+
+// The maximum number of bytes a record adds to a batch on top of it's message. This is the "[<date time>]" prefix, the
+// level and category tags and the new line character.
+#define DRGE_LOGGER_MAX_PREFIX_LENGTH   128
+
+// The size of the buffers the log thread formats batches into. Always big enough to hold the largest possible record.
+#define DRGE_LOGGER_BATCH_BUFFER_SIZE   (DRGE_LOGGER_MAX_MESSAGE_LENGTH + DRGE_LOGGER_MAX_PREFIX_LENGTH + 1)
+
+// The granularity in milliseconds at which the log thread checks whether or not it should cut it's batch interval short.
+#define DRGE_LOGGER_POLL_INTERVAL_MS    5
+
+typedef struct
+{
+    // The position the slot is at in the stream of records. For the slot at position p, this is p while the slot is
+    // free, and p+1 when it's the first slot of a record that has been published. The log thread sets it to
+    // p+DRGE_LOGGER_SLOT_COUNT when it's done with the slot, which makes it free for the next lap of the ring.
+    volatile long long sequence;
+
+    // The slot's portion of the record data.
+    char data[DRGE_LOGGER_SLOT_PAYLOAD_SIZE];
+} drge_logger_slot;
+
+// The structure at the start of every record. The message follows immediately after it and runs on into as many
+// subsequent slots as needed.
+typedef struct
+{
+    // The time the message was posted, from drge_get_ticks().
+    long long ticks;
+
+    // The log level.
+    unsigned int level;
+
+    // The log category.
+    unsigned int category;
+
+    // The length of the message, not including a null terminator which is not stored.
+    unsigned int length;
+
+    // The number of slots the record takes up, including this one.
+    unsigned int slotCount;
+} drge_logger_record_header;
+
+struct drge_logger
+{
+    // The ring buffer.
+    drge_logger_slot slots[DRGE_LOGGER_SLOT_COUNT];
+
+    // Keeps the position of the next record on it's own cache line because every producer hammers it.
+    char padding0[64];
+
+    // The position of the next slot to be claimed by a producer.
+    volatile long long head;
+
+    char padding1[64 - sizeof(long long)];
+
+    // The position of the next record to be read by the log thread. Only ever touched by the log thread.
+    long long tail;
+
+    // All records before this position have been written and flushed. Used by drge_logger_flush().
+    volatile long long flushedPosition;
+
+    // Set to 1 when the wake semaphore has been released and the log thread has not yet started draining. This is
+    // what keeps producers from making a system call for every message.
+    volatile long long isWakePending;
+
+    // Set to 1 when the log thread should skip the rest of it's batch interval and flush straight away.
+    volatile long long isFlushRequested;
+
+    // Set to 1 when the logger is being deleted.
+    volatile long long isStopping;
+
+    // The semaphore the log thread waits on while there's nothing to do.
+    dr_semaphore wakeSemaphore;
+
+    // The log thread.
+    dr_thread thread;
+
+    // Held by the log thread while it's writing a batch so that the log file can be swapped out safely.
+    dr_mutex fileLock;
+
+    // The log file. Can be null.
+    drfs_file* pFile;
+
+    // Whether or not messages are also printed to stdout.
+    bool isTerminalOutputEnabled;
+
+
+    // The wall clock time and the tick count at the time the logger was created. Timestamps are stored as ticks and
+    // converted to wall clock time using these when they are written out.
+    time_t baseTime;
+    long long baseTicks;
+    long long tickFrequency;
+
+    // The last timestamp that was formatted. Consecutive messages tend to land in the same second, so this saves
+    // formatting the same date time string over and over.
+    time_t cachedTime;
+    char cachedDateTime[64];
+
+
+    // The batch that's being built for the log file.
+    char fileBatch[DRGE_LOGGER_BATCH_BUFFER_SIZE];
+    size_t fileBatchSize;
+
+    // The batch that's being built for the terminal.
+    char terminalBatch[DRGE_LOGGER_BATCH_BUFFER_SIZE];
+    size_t terminalBatchSize;
+};
+
+
+static void drge_logger_write_record_bytes(drge_logger* pLogger, long long position, size_t offset, const void* pData, size_t dataSize)
+{
+    assert(pLogger != NULL);
+
+    const char* pRunningData = pData;
+    while (dataSize > 0)
+    {
+        drge_logger_slot* pSlot = &pLogger->slots[(position + offset/DRGE_LOGGER_SLOT_PAYLOAD_SIZE) & (DRGE_LOGGER_SLOT_COUNT-1)];
+        size_t slotOffset = offset % DRGE_LOGGER_SLOT_PAYLOAD_SIZE;
+
+        size_t bytesToCopy = DRGE_LOGGER_SLOT_PAYLOAD_SIZE - slotOffset;
+        if (bytesToCopy > dataSize) {
+            bytesToCopy = dataSize;
+        }
+
+        memcpy(pSlot->data + slotOffset, pRunningData, bytesToCopy);
+
+        pRunningData += bytesToCopy;
+        offset       += bytesToCopy;
+        dataSize     -= bytesToCopy;
+    }
+}
+
+static void drge_logger_read_record_bytes(drge_logger* pLogger, long long position, size_t offset, void* pDataOut, size_t dataSize)
+{
+    assert(pLogger != NULL);
+
+    char* pRunningDataOut = pDataOut;
+    while (dataSize > 0)
+    {
+        drge_logger_slot* pSlot = &pLogger->slots[(position + offset/DRGE_LOGGER_SLOT_PAYLOAD_SIZE) & (DRGE_LOGGER_SLOT_COUNT-1)];
+        size_t slotOffset = offset % DRGE_LOGGER_SLOT_PAYLOAD_SIZE;
+
+        size_t bytesToCopy = DRGE_LOGGER_SLOT_PAYLOAD_SIZE - slotOffset;
+        if (bytesToCopy > dataSize) {
+            bytesToCopy = dataSize;
+        }
+
+        memcpy(pRunningDataOut, pSlot->data + slotOffset, bytesToCopy);
+
+        pRunningDataOut += bytesToCopy;
+        offset          += bytesToCopy;
+        dataSize        -= bytesToCopy;
+    }
+}
+
+static void drge_logger_wake(drge_logger* pLogger)
+{
+    assert(pLogger != NULL);
+
+    // Only the producer that flips the flag releases the semaphore. Everybody else knows the log thread is already
+    // on it's way.
+    if (drge_atomic_compare_exchange_64(&pLogger->isWakePending, 0, 1) == 0) {
+        dr_release_semaphore(pLogger->wakeSemaphore);
+    }
+}
+
+static const char* drge_logger_format_timestamp(drge_logger* pLogger, long long ticks)
+{
+    assert(pLogger != NULL);
+
+    time_t t = pLogger->baseTime + (time_t)((ticks - pLogger->baseTicks) / pLogger->tickFrequency);
+    if (t != pLogger->cachedTime) {
+        dr_datetime_short(t, pLogger->cachedDateTime, sizeof(pLogger->cachedDateTime));
+        pLogger->cachedTime = t;
+    }
+
+    return pLogger->cachedDateTime;
+}
+
+static void drge_logger_format_tags(unsigned int level, unsigned int category, char* tagsOut, size_t tagsOutSize)
+{
+    assert(tagsOut != NULL);
+    assert(tagsOutSize > 0);
+
+    tagsOut[0] = '\0';
+
+    if (level != DRGE_LOG_LEVEL_INFO && level < DRGE_LOG_LEVEL_COUNT) {
+        strcat_s(tagsOut, tagsOutSize, "[");
+        strcat_s(tagsOut, tagsOutSize, drge_get_log_level_name(level));
+        strcat_s(tagsOut, tagsOutSize, "] ");
+    }
+
+    if (category != DRGE_LOG_CATEGORY_GENERAL && category < DRGE_LOG_CATEGORY_COUNT) {
+        strcat_s(tagsOut, tagsOutSize, "[");
+        strcat_s(tagsOut, tagsOutSize, drge_get_log_category_name(category));
+        strcat_s(tagsOut, tagsOutSize, "] ");
+    }
+}
+
+// Writes out the current batches. Must be called with the file lock held.
+static void drge_logger_write_batches(drge_logger* pLogger)
+{
+    assert(pLogger != NULL);
+
+    if (pLogger->fileBatchSize > 0) {
+        if (pLogger->pFile != NULL) {
+            drfs_write(pLogger->pFile, pLogger->fileBatch, pLogger->fileBatchSize, NULL);
+        }
+
+        pLogger->fileBatchSize = 0;
+    }
+
+    if (pLogger->terminalBatchSize > 0) {
+        fwrite(pLogger->terminalBatch, 1, pLogger->terminalBatchSize, stdout);
+        pLogger->terminalBatchSize = 0;
+    }
+}
+
+// Writes out and flushes every record that has been published. Only called from one thread at a time.
+static void drge_logger_drain(drge_logger* pLogger)
+{
+    assert(pLogger != NULL);
+
+    // The flush request is consumed before reading any records so that it's always honoured by this drain or the
+    // next one. Every drain ends in a flush anyway, so all this does is stop the request cutting the next batch
+    // interval short.
+    drge_atomic_exchange_64(&pLogger->isFlushRequested, 0);
+
+    dr_lock_mutex(pLogger->fileLock);
+    {
+        for (;;)
+        {
+            long long position = pLogger->tail;
+            if (drge_atomic_load_64(&pLogger->slots[position & (DRGE_LOGGER_SLOT_COUNT-1)].sequence) != position + 1) {
+                break;  // Nothing else has been published.
+            }
+
+            drge_logger_record_header header;
+            drge_logger_read_record_bytes(pLogger, position, 0, &header, sizeof(header));
+
+            if (pLogger->fileBatchSize     + DRGE_LOGGER_MAX_PREFIX_LENGTH + header.length > sizeof(pLogger->fileBatch) ||
+                pLogger->terminalBatchSize + DRGE_LOGGER_MAX_PREFIX_LENGTH + header.length > sizeof(pLogger->terminalBatch)) {
+                drge_logger_write_batches(pLogger);
+            }
+
+            // Log file. The format is "[<date time>][<level>] [<category>] <message>\n" where the level tag is omitted
+            // for info messages and the category tag is omitted for general messages.
+            char* pFileRecord = pLogger->fileBatch + pLogger->fileBatchSize;
+            int timestampLength = snprintf(pFileRecord, DRGE_LOGGER_MAX_PREFIX_LENGTH, "[%s]", drge_logger_format_timestamp(pLogger, header.ticks));
+            if (timestampLength < 0 || timestampLength >= DRGE_LOGGER_MAX_PREFIX_LENGTH) {
+                timestampLength = 0;
+            }
+
+            char tags[64];
+            drge_logger_format_tags(header.level, header.category, tags, sizeof(tags));
+
+            size_t tagsLength = strlen(tags);
+            memcpy(pFileRecord + timestampLength, tags, tagsLength);
+
+            size_t prefixLength = timestampLength + tagsLength;
+            drge_logger_read_record_bytes(pLogger, position, sizeof(header), pFileRecord + prefixLength, header.length);
+            pFileRecord[prefixLength + header.length] = '\n';
+            pLogger->fileBatchSize += prefixLength + header.length + 1;
+
+            // Terminal. Everything but the timestamp.
+            if (pLogger->isTerminalOutputEnabled) {
+                memcpy(pLogger->terminalBatch + pLogger->terminalBatchSize, pFileRecord + timestampLength, tagsLength + header.length + 1);
+                pLogger->terminalBatchSize += tagsLength + header.length + 1;
+            }
+
+            // Hand the slots back to the producers. The data has already been copied out so it's safe for them to be
+            // overwritten as soon as this is done.
+            for (unsigned int iSlot = 0; iSlot < header.slotCount; ++iSlot) {
+                drge_atomic_store_64(&pLogger->slots[(position + iSlot) & (DRGE_LOGGER_SLOT_COUNT-1)].sequence, position + iSlot + DRGE_LOGGER_SLOT_COUNT);
+            }
+
+            pLogger->tail = position + header.slotCount;
+        }
+
+        drge_logger_write_batches(pLogger);
+
+        if (pLogger->pFile != NULL) {
+            drfs_flush(pLogger->pFile);
+        }
+
+        if (pLogger->isTerminalOutputEnabled) {
+            fflush(stdout);
+        }
+
+        drge_atomic_store_64(&pLogger->flushedPosition, pLogger->tail);
+    }
+    dr_unlock_mutex(pLogger->fileLock);
+}
+
+static int drge_logger_thread_proc(void* pData)
+{
+    drge_logger* pLogger = pData;
+    assert(pLogger != NULL);
+
+    drge_profile_set_thread_name("Log");
+    drge_register_current_thread(DRGE_THREAD_ROLE_LOG, "Log");
+
+    for (;;)
+    {
+        dr_wait_semaphore(pLogger->wakeSemaphore);
+
+        // Give other messages a chance to arrive so they can all be written and flushed together. Errors and
+        // shutdown cut this short.
+        for (unsigned int waited = 0; waited < DRGE_LOGGER_BATCH_INTERVAL_MS; waited += DRGE_LOGGER_POLL_INTERVAL_MS)
+        {
+            if (drge_atomic_load_64(&pLogger->isFlushRequested) || drge_atomic_load_64(&pLogger->isStopping)) {
+                break;
+            }
+
+            dr_sleep(DRGE_LOGGER_POLL_INTERVAL_MS);
+        }
+
+        // The stop flag needs to be checked before draining so that nothing posted before drge_delete_logger() is
+        // missed. The wake flag is cleared before draining so that a record published after the drain has looked for
+        // it is guaranteed to wake us up again.
+        bool isStopping = drge_atomic_load_64(&pLogger->isStopping) != 0;
+        drge_atomic_store_64(&pLogger->isWakePending, 0);
+
+        drge_logger_drain(pLogger);
+
+        if (isStopping) {
+            break;
+        }
+    }
+
+    drge_unregister_current_thread();
+    return 0;
+}
+
+
+drge_logger* drge_create_logger(bool isTerminalOutputEnabled)
+{
+    drge_logger* pLogger = DRGE_MALLOC(sizeof(*pLogger), DRGE_MEMORY_TAG_GENERAL);
+    if (pLogger == NULL) {
+        return NULL;
+    }
+
+    for (long long iSlot = 0; iSlot < DRGE_LOGGER_SLOT_COUNT; ++iSlot) {
+        pLogger->slots[iSlot].sequence = iSlot;
+    }
+
+    pLogger->head                    = 0;
+    pLogger->tail                    = 0;
+    pLogger->flushedPosition         = 0;
+    pLogger->isWakePending           = 0;
+    pLogger->isFlushRequested        = 0;
+    pLogger->isStopping              = 0;
+    pLogger->wakeSemaphore           = NULL;
+    pLogger->thread                  = NULL;
+    pLogger->pFile                   = NULL;
+    pLogger->isTerminalOutputEnabled = isTerminalOutputEnabled;
+    pLogger->baseTime                = dr_now();
+    pLogger->baseTicks               = drge_get_ticks();
+    pLogger->tickFrequency           = drge_get_tick_frequency();
+    pLogger->cachedTime              = 0;
+    pLogger->cachedDateTime[0]       = '\0';
+    pLogger->fileBatchSize           = 0;
+    pLogger->terminalBatchSize       = 0;
+
+    pLogger->fileLock = drutil_create_mutex();
+    if (pLogger->fileLock == NULL) {
+        goto on_error;
+    }
+
+    pLogger->wakeSemaphore = dr_create_semaphore(0);
+    if (pLogger->wakeSemaphore == NULL) {
+        goto on_error;
+    }
+
+    pLogger->thread = dr_create_thread(drge_logger_thread_proc, pLogger);
+    if (pLogger->thread == NULL) {
+        goto on_error;
+    }
+
+    return pLogger;
+
+
+on_error:
+    if (pLogger->wakeSemaphore != NULL) {
+        dr_delete_semaphore(pLogger->wakeSemaphore);
+    }
+
+    if (pLogger->fileLock != NULL) {
+        dr_delete_mutex(pLogger->fileLock);
+    }
+
+    DRGE_FREE(pLogger);
+    return NULL;
+}
+
+void drge_delete_logger(drge_logger* pLogger)
+{
+    if (pLogger == NULL) {
+        return;
+    }
+
+    drge_atomic_store_64(&pLogger->isStopping, 1);
+    dr_release_semaphore(pLogger->wakeSemaphore);
+    dr_wait_and_delete_thread(pLogger->thread);
+
+    // Anything that was posted while the log thread was shutting down.
+    drge_logger_drain(pLogger);
+
+    dr_delete_semaphore(pLogger->wakeSemaphore);
+    dr_delete_mutex(pLogger->fileLock);
+    DRGE_FREE(pLogger);
+}
+
+void drge_logger_set_file(drge_logger* pLogger, drfs_file* pFile)
+{
+    if (pLogger == NULL) {
+        return;
+    }
+
+    dr_lock_mutex(pLogger->fileLock);
+    {
+        pLogger->pFile = pFile;
+    }
+    dr_unlock_mutex(pLogger->fileLock);
+}
+
+void drge_logger_post(drge_logger* pLogger, int level, int category, const char* message)
+{
+    if (pLogger == NULL || message == NULL) {
+        return;
+    }
+
+    size_t length = strlen(message);
+    if (length > DRGE_LOGGER_MAX_MESSAGE_LENGTH) {
+        length = DRGE_LOGGER_MAX_MESSAGE_LENGTH;
+    }
+
+    drge_logger_record_header header;
+    header.ticks     = drge_get_ticks();
+    header.level     = (unsigned int)level;
+    header.category  = (unsigned int)category;
+    header.length    = (unsigned int)length;
+    header.slotCount = (unsigned int)((sizeof(header) + length + DRGE_LOGGER_SLOT_PAYLOAD_SIZE-1) / DRGE_LOGGER_SLOT_PAYLOAD_SIZE);
+
+    // Claim a run of consecutive slots. The log thread frees slots strictly in order, so if the last slot of the run
+    // is free for this lap of the ring then so are all of the ones before it.
+    long long position;
+    for (;;)
+    {
+        position = drge_atomic_load_64(&pLogger->head);
+
+        long long lastPosition = position + header.slotCount - 1;
+        long long sequence = drge_atomic_load_64(&pLogger->slots[lastPosition & (DRGE_LOGGER_SLOT_COUNT-1)].sequence);
+        if (sequence == lastPosition) {
+            if (drge_atomic_compare_exchange_64(&pLogger->head, position, position + header.slotCount) == position) {
+                break;
+            }
+        } else if (sequence < lastPosition) {
+            // The buffer is full. Make sure the log thread is awake and wait for it to catch up.
+            drge_atomic_store_64(&pLogger->isFlushRequested, 1);
+            drge_logger_wake(pLogger);
+            dr_sleep(0);
+        } else {
+            // Another thread claimed the slots first. Try again with the new head.
+        }
+    }
+
+    drge_logger_write_record_bytes(pLogger, position, 0, &header, sizeof(header));
+    drge_logger_write_record_bytes(pLogger, position, sizeof(header), message, length);
+
+    // Publishing the first slot is what makes the whole record visible to the log thread.
+    drge_atomic_store_64(&pLogger->slots[position & (DRGE_LOGGER_SLOT_COUNT-1)].sequence, position + 1);
+
+    if (level >= DRGE_LOG_LEVEL_ERROR) {
+        drge_atomic_store_64(&pLogger->isFlushRequested, 1);
+    }
+
+    drge_logger_wake(pLogger);
+}
+
+void drge_logger_flush(drge_logger* pLogger)
+{
+    if (pLogger == NULL) {
+        return;
+    }
+
+    long long position = drge_atomic_load_64(&pLogger->head);
+
+    drge_atomic_store_64(&pLogger->isFlushRequested, 1);
+    drge_logger_wake(pLogger);
+
+    while (drge_atomic_load_64(&pLogger->flushedPosition) < position) {
+        dr_sleep(1);
+    }
+}
+
+
+static const char* g_drgeLogLevelNames[DRGE_LOG_LEVEL_COUNT] = {
+    "DEBUG",
+    "INFO",
+    "WARNING",
+    "ERROR"
+};
+
+static const char* g_drgeLogCategoryNames[DRGE_LOG_CATEGORY_COUNT] = {
+    "GENERAL",
+    "CONFIG",
+    "FILES",
+    "GRAPHICS",
+    "ASSETS",
+    "EDITOR"
+};
+
+const char* drge_get_log_level_name(int level)
+{
+    if (level < 0 || level >= DRGE_LOG_LEVEL_COUNT) {
+        return NULL;
+    }
+
+    return g_drgeLogLevelNames[level];
+}
+
+int drge_get_log_level_by_name(const char* name)
+{
+    if (name == NULL) {
+        return -1;
+    }
+
+    for (int iLevel = 0; iLevel < DRGE_LOG_LEVEL_COUNT; ++iLevel) {
+        if (_stricmp(name, g_drgeLogLevelNames[iLevel]) == 0) {
+            return iLevel;
+        }
+    }
+
+    return -1;
+}
+
+const char* drge_get_log_category_name(int category)
+{
+    if (category < 0 || category >= DRGE_LOG_CATEGORY_COUNT) {
+        return NULL;
+    }
+
+    return g_drgeLogCategoryNames[category];
+}
+
+int drge_get_log_category_by_name(const char* name)
+{
+    if (name == NULL) {
+        return -1;
+    }
+
+    for (int iCategory = 0; iCategory < DRGE_LOG_CATEGORY_COUNT; ++iCategory) {
+        if (_stricmp(name, g_drgeLogCategoryNames[iCategory]) == 0) {
+            return iCategory;
+        }
+    }
+
+    return -1;
+}
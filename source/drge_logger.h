@@ -0,0 +1,86 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The logger moves all log I/O off the calling thread. Posting a message copies it, along with a timestamp, into a
+// bounded ring buffer and returns. A dedicated log thread drains the buffer in batches, writes each batch to the log
+// file and terminal in one go, and flushes at most once per batch interval, or immediately when an error is posted.
+//
+// Any number of threads can post at the same time. When the buffer is full the posting thread waits for the log
+// thread to catch up rather than dropping the message.
+
+typedef struct drge_logger drge_logger;
+
+// Log levels, in order of increasing severity.
+#define DRGE_LOG_LEVEL_DEBUG    0
+#define DRGE_LOG_LEVEL_INFO     1
+#define DRGE_LOG_LEVEL_WARNING  2
+#define DRGE_LOG_LEVEL_ERROR    3
+#define DRGE_LOG_LEVEL_COUNT    4
+
+// Log categories. These identify the subsystem a message came from so that chatty subsystems can be filtered out
+// individually. Messages in the general category are written without a category tag.
+#define DRGE_LOG_CATEGORY_GENERAL   0
+#define DRGE_LOG_CATEGORY_CONFIG    1
+#define DRGE_LOG_CATEGORY_FILES     2
+#define DRGE_LOG_CATEGORY_GRAPHICS  3
+#define DRGE_LOG_CATEGORY_ASSETS    4
+#define DRGE_LOG_CATEGORY_EDITOR    5
+#define DRGE_LOG_CATEGORY_COUNT     6
+
+// The minimum level of messages that are compiled in at all. Calls to drge_debugf() compile to nothing when this is
+// above DRGE_LOG_LEVEL_DEBUG, which is the default for release builds.
+#ifndef DRGE_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define DRGE_MIN_LOG_LEVEL  DRGE_LOG_LEVEL_INFO
+#else
+#define DRGE_MIN_LOG_LEVEL  DRGE_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// The size of a single slot in the logger's ring buffer. A message occupies as many consecutive slots as it needs.
+#define DRGE_LOGGER_SLOT_SIZE           256
+
+// The number of slots in the logger's ring buffer. Must be a power of 2.
+#define DRGE_LOGGER_SLOT_COUNT          1024
+
+// The amount of time in milliseconds the log thread waits for more messages to arrive before writing a batch.
+#define DRGE_LOGGER_BATCH_INTERVAL_MS   50
+
+
+// Creates a logger and starts its log thread.
+drge_logger* drge_create_logger(bool isTerminalOutputEnabled);
+
+// Writes out any remaining messages, stops the log thread and deletes the logger.
+//
+// This does not close the log file.
+void drge_delete_logger(drge_logger* pLogger);
+
+// Sets the file the log thread writes to. Messages that are written out while no file is set only go to the terminal.
+//
+// This waits for any in-progress batch to finish writing, so the previous file can be closed as soon as this returns.
+void drge_logger_set_file(drge_logger* pLogger, drfs_file* pFile);
+
+// Posts a message to the logger. The message is copied, so it can be freed as soon as this returns.
+//
+// The logger does no filtering of it's own. The level and category tags are added by the log thread, so the message
+// should not include them.
+//
+// Messages longer than what fits in half the ring buffer are truncated.
+void drge_logger_post(drge_logger* pLogger, int level, int category, const char* message);
+
+// Blocks until every message posted before this call has been written and flushed.
+void drge_logger_flush(drge_logger* pLogger);
+
+
+// Retrieves the name of the given log level, such as "WARNING". Returns null if the level is invalid.
+const char* drge_get_log_level_name(int level);
+
+// Retrieves the log level with the given name. The comparison is not case sensitive. Returns -1 if the name is not a
+// valid level.
+int drge_get_log_level_by_name(const char* name);
+
+// Retrieves the name of the given log category, such as "CONFIG". Returns null if the category is invalid.
+const char* drge_get_log_category_name(int category);
+
+// Retrieves the log category with the given name. The comparison is not case sensitive. Returns -1 if the name is not
+// a valid category.
+int drge_get_log_category_by_name(const char* name);
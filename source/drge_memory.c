@@ -0,0 +1,653 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+// The size of the header in front of each allocation. This is 16 so that allocations keep the alignment of the
+// underlying allocator.
+#define DRGE_MEMORY_HEADER_SIZE 16
+
+typedef struct
+{
+    // The size of the allocation, not including the header.
+    unsigned long long size;
+
+    // The DRGE_MEMORY_TAG_* the allocation was made with.
+    int tag;
+
+    // A combination of DRGE_MEMORY_FLAG_*.
+    unsigned int flags;
+} drge_memory_header;
+
+// Set on large blocks, which are mapped from the operating system rather than coming from the allocator.
+#define DRGE_MEMORY_FLAG_LARGE_BLOCK    0x01
+
+// Set on large blocks that are backed by explicit huge pages.
+#define DRGE_MEMORY_FLAG_HUGE_PAGES     0x02
+
+// Set on large blocks that were marked for transparent huge pages.
+#define DRGE_MEMORY_FLAG_TRANSPARENT    0x04
+
+typedef struct
+{
+    volatile long long liveBytes;
+    volatile long long liveAllocationCount;
+    volatile long long peakBytes;
+    volatile long long allocationCount;
+    volatile long long allocatedBytes;
+} drge_memory_counters;
+
+static void* drge_default_malloc(size_t size, void* pUserData)
+{
+    (void)pUserData;
+    return malloc(size);
+}
+
+static void* drge_default_realloc(void* p, size_t size, void* pUserData)
+{
+    (void)pUserData;
+    return realloc(p, size);
+}
+
+static void drge_default_free(void* p, void* pUserData)
+{
+    (void)pUserData;
+    free(p);
+}
+
+static drge_allocator g_drgeAllocator = { drge_default_malloc, drge_default_realloc, drge_default_free, NULL };
+static drge_memory_counters g_drgeMemoryCounters[DRGE_MEMORY_TAG_COUNT];
+
+static const char* g_drgeMemoryTagNames[DRGE_MEMORY_TAG_COUNT] = {
+    "general",
+    "assets",
+    "vfs",
+    "gui",
+    "audio",
+    "graphics",
+    "strings"
+};
+
+static void drge_memory_on_alloc(int tag, unsigned long long size)
+{
+    assert(tag >= 0 && tag < DRGE_MEMORY_TAG_COUNT);
+
+    drge_memory_counters* pCounters = &g_drgeMemoryCounters[tag];
+    drge_atomic_fetch_add_64(&pCounters->allocationCount, 1);
+    drge_atomic_fetch_add_64(&pCounters->allocatedBytes, (long long)size);
+    drge_atomic_fetch_add_64(&pCounters->liveAllocationCount, 1);
+
+    long long liveBytes = drge_atomic_fetch_add_64(&pCounters->liveBytes, (long long)size) + (long long)size;
+    long long peakBytes = drge_atomic_load_64(&pCounters->peakBytes);
+    while (liveBytes > peakBytes) {
+        long long prevPeakBytes = drge_atomic_compare_exchange_64(&pCounters->peakBytes, peakBytes, liveBytes);
+        if (prevPeakBytes == peakBytes) {
+            break;
+        }
+        peakBytes = prevPeakBytes;
+    }
+}
+
+static void drge_memory_on_free(int tag, unsigned long long size)
+{
+    assert(tag >= 0 && tag < DRGE_MEMORY_TAG_COUNT);
+
+    drge_memory_counters* pCounters = &g_drgeMemoryCounters[tag];
+    drge_atomic_fetch_add_64(&pCounters->liveAllocationCount, -1);
+    drge_atomic_fetch_add_64(&pCounters->liveBytes, -(long long)size);
+}
+
+
+// Large blocks have a bigger header so that the data is aligned to a cache line. The header of a normal allocation is
+// at the end of it.
+#define DRGE_LARGE_BLOCK_HEADER_SIZE    64
+
+// The size of a transparent huge page. Explicit huge pages can be a different size, which is read from the system.
+#define DRGE_HUGE_PAGE_SIZE             (2*1024*1024)
+
+static volatile long long g_drgeLargePageMode = DRGE_LARGE_PAGES_TRANSPARENT;
+static volatile long long g_drgeLargeBlockCount = 0;
+static volatile long long g_drgeLargeBlockMappedBytes = 0;
+static volatile long long g_drgeHugePageBytes = 0;
+static volatile long long g_drgeTransparentHugePageBytes = 0;
+static volatile long long g_drgeHugePageFallbackCount = 0;
+
+static size_t drge_round_up_to(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+#ifdef _WIN32
+// Retrieves the number of bytes that are mapped for a large block. The block is mapped with it's header, which is
+// included in totalSize.
+static size_t drge_get_large_block_mapped_size(size_t totalSize, unsigned int flags)
+{
+    if ((flags & DRGE_MEMORY_FLAG_HUGE_PAGES) != 0) {
+        return drge_round_up_to(totalSize, GetLargePageMinimum());
+    }
+
+    return drge_round_up_to(totalSize, 4096);
+}
+
+// Maps the memory for a large block. Windows doesn't have transparent huge pages, so they're either explicit or not
+// used at all.
+static void* drge_map_large_block(size_t totalSize, unsigned int* pFlagsOut)
+{
+    assert(pFlagsOut != NULL);
+
+    if (drge_atomic_load_64(&g_drgeLargePageMode) == DRGE_LARGE_PAGES_EXPLICIT) {
+        SIZE_T largePageSize = GetLargePageMinimum();
+        if (largePageSize > 0) {
+            void* pMapping = VirtualAlloc(NULL, drge_round_up_to(totalSize, largePageSize), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (pMapping != NULL) {
+                *pFlagsOut = DRGE_MEMORY_FLAG_LARGE_BLOCK | DRGE_MEMORY_FLAG_HUGE_PAGES;
+                return pMapping;
+            }
+        }
+
+        drge_atomic_fetch_add_64(&g_drgeHugePageFallbackCount, 1);
+    }
+
+    *pFlagsOut = DRGE_MEMORY_FLAG_LARGE_BLOCK;
+    return VirtualAlloc(NULL, totalSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+static void drge_unmap_large_block(void* pMapping, size_t size, unsigned int flags)
+{
+    size_t mappedSize = drge_get_large_block_mapped_size(DRGE_LARGE_BLOCK_HEADER_SIZE + size, flags);
+
+    drge_atomic_fetch_add_64(&g_drgeLargeBlockCount, -1);
+    drge_atomic_fetch_add_64(&g_drgeLargeBlockMappedBytes, -(long long)mappedSize);
+    if ((flags & DRGE_MEMORY_FLAG_HUGE_PAGES) != 0) {
+        drge_atomic_fetch_add_64(&g_drgeHugePageBytes, -(long long)mappedSize);
+    }
+
+    VirtualFree(pMapping, 0, MEM_RELEASE);
+}
+#else
+// The size of the pages MAP_HUGETLB gives out, which is the default hugetlbfs page size. This is 2 MB on x86-64 but
+// can be anything from 64 KB to 1 GB depending on the architecture and kernel command line. 0 means it hasn't been read
+// yet and -1 means it isn't available.
+static volatile long long g_drgeExplicitHugePageSize = 0;
+
+static size_t drge_get_explicit_huge_page_size()
+{
+    long long hugePageSize = drge_atomic_load_64(&g_drgeExplicitHugePageSize);
+    if (hugePageSize == 0) {
+        hugePageSize = -1;
+
+        FILE* pFile = fopen("/proc/meminfo", "r");
+        if (pFile != NULL) {
+            char line[256];
+            while (fgets(line, sizeof(line), pFile) != NULL) {
+                long long kb;
+                if (sscanf(line, "Hugepagesize: %lld kB", &kb) == 1) {
+                    if (kb > 0) {
+                        hugePageSize = kb * 1024;
+                    }
+                    break;
+                }
+            }
+
+            fclose(pFile);
+        }
+
+        // Threads that get here at the same time all read the same value so it doesn't matter which one wins.
+        drge_atomic_store_64(&g_drgeExplicitHugePageSize, hugePageSize);
+    }
+
+    return (hugePageSize > 0) ? (size_t)hugePageSize : 0;
+}
+
+static size_t drge_get_large_block_mapped_size(size_t totalSize, unsigned int flags)
+{
+    if ((flags & DRGE_MEMORY_FLAG_HUGE_PAGES) != 0) {
+        return drge_round_up_to(totalSize, drge_get_explicit_huge_page_size());
+    }
+
+    return drge_round_up_to(totalSize, (size_t)sysconf(_SC_PAGESIZE));
+}
+
+// Maps the memory for a large block, trying explicit huge pages first if they're enabled, then transparent huge pages.
+static void* drge_map_large_block(size_t totalSize, unsigned int* pFlagsOut)
+{
+    assert(pFlagsOut != NULL);
+
+    long long mode = drge_atomic_load_64(&g_drgeLargePageMode);
+    size_t mappedSize = drge_get_large_block_mapped_size(totalSize, 0);
+
+#ifdef MAP_HUGETLB
+    if (mode == DRGE_LARGE_PAGES_EXPLICIT) {
+        // The mapping is a whole number of huge pages. When the size of them can't be found out there's no way of
+        // knowing how much is mapped, so transparent huge pages are used instead.
+        size_t hugePageSize = drge_get_explicit_huge_page_size();
+        if (hugePageSize > 0 && totalSize <= (size_t)-1 - hugePageSize) {
+            void* pMapping = mmap(NULL, drge_round_up_to(totalSize, hugePageSize), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (pMapping != MAP_FAILED) {
+                *pFlagsOut = DRGE_MEMORY_FLAG_LARGE_BLOCK | DRGE_MEMORY_FLAG_HUGE_PAGES;
+                return pMapping;
+            }
+        }
+
+        // The hugetlbfs pool is empty or hasn't been reserved.
+        drge_atomic_fetch_add_64(&g_drgeHugePageFallbackCount, 1);
+    }
+#endif
+
+#ifdef MADV_HUGEPAGE
+    if (mode != DRGE_LARGE_PAGES_OFF) {
+        // Transparent huge pages only cover whole 2 MB ranges that are aligned to 2 MB, so the block is placed on a 2 MB
+        // boundary by mapping an extra 2 MB and trimming it off. The end of the block isn't rounded up, so the last
+        // partial 2 MB just gets normal pages rather than wasting memory.
+        unsigned char* pOverMapping = mmap(NULL, mappedSize + DRGE_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pOverMapping == MAP_FAILED) {
+            return NULL;
+        }
+
+        unsigned char* pMapping = (unsigned char*)(((uintptr_t)pOverMapping + DRGE_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(DRGE_HUGE_PAGE_SIZE - 1));
+        size_t headSize = (size_t)(pMapping - pOverMapping);
+        size_t tailSize = DRGE_HUGE_PAGE_SIZE - headSize;
+        if (headSize > 0) {
+            munmap(pOverMapping, headSize);
+        }
+        if (tailSize > 0) {
+            munmap(pMapping + mappedSize, tailSize);
+        }
+
+        *pFlagsOut = DRGE_MEMORY_FLAG_LARGE_BLOCK;
+        if (madvise(pMapping, mappedSize, MADV_HUGEPAGE) == 0) {
+            *pFlagsOut |= DRGE_MEMORY_FLAG_TRANSPARENT;
+        } else {
+            drge_atomic_fetch_add_64(&g_drgeHugePageFallbackCount, 1);   // The kernel was built without them.
+        }
+
+        return pMapping;
+    }
+#endif
+
+    void* pMapping = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pMapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    *pFlagsOut = DRGE_MEMORY_FLAG_LARGE_BLOCK;
+    return pMapping;
+}
+
+static void drge_unmap_large_block(void* pMapping, size_t size, unsigned int flags)
+{
+    size_t mappedSize = drge_get_large_block_mapped_size(DRGE_LARGE_BLOCK_HEADER_SIZE + size, flags);
+
+    drge_atomic_fetch_add_64(&g_drgeLargeBlockCount, -1);
+    drge_atomic_fetch_add_64(&g_drgeLargeBlockMappedBytes, -(long long)mappedSize);
+    if ((flags & DRGE_MEMORY_FLAG_HUGE_PAGES) != 0) {
+        drge_atomic_fetch_add_64(&g_drgeHugePageBytes, -(long long)mappedSize);
+    }
+    if ((flags & DRGE_MEMORY_FLAG_TRANSPARENT) != 0) {
+        drge_atomic_fetch_add_64(&g_drgeTransparentHugePageBytes, -(long long)(mappedSize & ~(size_t)(DRGE_HUGE_PAGE_SIZE - 1)));
+    }
+
+    munmap(pMapping, mappedSize);
+}
+#endif
+
+
+void drge_set_allocator(const drge_allocator* pAllocator)
+{
+    if (pAllocator == NULL || pAllocator->onMalloc == NULL || pAllocator->onRealloc == NULL || pAllocator->onFree == NULL) {
+        g_drgeAllocator.onMalloc  = drge_default_malloc;
+        g_drgeAllocator.onRealloc = drge_default_realloc;
+        g_drgeAllocator.onFree    = drge_default_free;
+        g_drgeAllocator.pUserData = NULL;
+        return;
+    }
+
+    g_drgeAllocator = *pAllocator;
+}
+
+void* drge_malloc(size_t size, int tag)
+{
+    if (tag < 0 || tag >= DRGE_MEMORY_TAG_COUNT) {
+        tag = DRGE_MEMORY_TAG_GENERAL;
+    }
+
+    if (size > (size_t)-1 - DRGE_MEMORY_HEADER_SIZE) {
+        return NULL;
+    }
+
+    unsigned char* pBlock = g_drgeAllocator.onMalloc(DRGE_MEMORY_HEADER_SIZE + size, g_drgeAllocator.pUserData);
+    if (pBlock == NULL) {
+        return NULL;
+    }
+
+    drge_memory_header* pHeader = (drge_memory_header*)pBlock;
+    pHeader->size  = size;
+    pHeader->tag   = tag;
+    pHeader->flags = 0;
+
+    drge_memory_on_alloc(tag, size);
+    return pBlock + DRGE_MEMORY_HEADER_SIZE;
+}
+
+void* drge_calloc(size_t count, size_t size, int tag)
+{
+    if (size > 0 && count > (size_t)-1 / size) {
+        return NULL;
+    }
+
+    void* p = drge_malloc(count * size, tag);
+    if (p == NULL) {
+        return NULL;
+    }
+
+    memset(p, 0, count * size);
+    return p;
+}
+
+void* drge_realloc(void* p, size_t size, int tag)
+{
+    if (p == NULL) {
+        return drge_malloc(size, tag);
+    }
+
+    if (size > (size_t)-1 - DRGE_MEMORY_HEADER_SIZE) {
+        return NULL;
+    }
+
+    unsigned char* pOldBlock = (unsigned char*)p - DRGE_MEMORY_HEADER_SIZE;
+    drge_memory_header oldHeader = *(drge_memory_header*)pOldBlock;
+
+    // Large blocks can't be resized in place, so they're moved to a new one.
+    if ((oldHeader.flags & DRGE_MEMORY_FLAG_LARGE_BLOCK) != 0) {
+        void* pNew = drge_large_alloc(size, oldHeader.tag);
+        if (pNew == NULL) {
+            return NULL;
+        }
+
+        memcpy(pNew, p, (oldHeader.size < size) ? (size_t)oldHeader.size : size);
+        drge_free(p);
+        return pNew;
+    }
+
+    unsigned char* pNewBlock = g_drgeAllocator.onRealloc(pOldBlock, DRGE_MEMORY_HEADER_SIZE + size, g_drgeAllocator.pUserData);
+    if (pNewBlock == NULL) {
+        return NULL;    // The old block is left alone, as with realloc().
+    }
+
+    ((drge_memory_header*)pNewBlock)->size = size;
+
+    drge_memory_on_free(oldHeader.tag, oldHeader.size);
+    drge_memory_on_alloc(oldHeader.tag, size);
+    return pNewBlock + DRGE_MEMORY_HEADER_SIZE;
+}
+
+void drge_free(void* p)
+{
+    if (p == NULL) {
+        return;
+    }
+
+    unsigned char* pBlock = (unsigned char*)p - DRGE_MEMORY_HEADER_SIZE;
+    drge_memory_header* pHeader = (drge_memory_header*)pBlock;
+
+    drge_memory_on_free(pHeader->tag, pHeader->size);
+
+    if ((pHeader->flags & DRGE_MEMORY_FLAG_LARGE_BLOCK) != 0) {
+        drge_unmap_large_block((unsigned char*)p - DRGE_LARGE_BLOCK_HEADER_SIZE, pHeader->size, pHeader->flags);
+        return;
+    }
+
+    g_drgeAllocator.onFree(pBlock, g_drgeAllocator.pUserData);
+}
+
+void drge_get_memory_stats(int tag, drge_memory_stats* pStatsOut)
+{
+    if (pStatsOut == NULL) {
+        return;
+    }
+
+    memset(pStatsOut, 0, sizeof(*pStatsOut));
+
+    if (tag < 0 || tag >= DRGE_MEMORY_TAG_COUNT) {
+        return;
+    }
+
+    drge_memory_counters* pCounters = &g_drgeMemoryCounters[tag];
+    pStatsOut->liveBytes           = drge_atomic_load_64(&pCounters->liveBytes);
+    pStatsOut->liveAllocationCount = drge_atomic_load_64(&pCounters->liveAllocationCount);
+    pStatsOut->peakBytes           = drge_atomic_load_64(&pCounters->peakBytes);
+    pStatsOut->allocationCount     = (unsigned long long)drge_atomic_load_64(&pCounters->allocationCount);
+    pStatsOut->allocatedBytes      = (unsigned long long)drge_atomic_load_64(&pCounters->allocatedBytes);
+}
+
+const char* drge_get_memory_tag_name(int tag)
+{
+    if (tag < 0 || tag >= DRGE_MEMORY_TAG_COUNT) {
+        return NULL;
+    }
+
+    return g_drgeMemoryTagNames[tag];
+}
+
+
+void drge_set_large_page_mode(int mode)
+{
+    if (mode < DRGE_LARGE_PAGES_OFF || mode > DRGE_LARGE_PAGES_EXPLICIT) {
+        return;
+    }
+
+    drge_atomic_store_64(&g_drgeLargePageMode, mode);
+}
+
+void* drge_large_alloc(size_t size, int tag)
+{
+    if (size < DRGE_LARGE_BLOCK_MIN_SIZE) {
+        return drge_malloc(size, tag);
+    }
+
+    if (tag < 0 || tag >= DRGE_MEMORY_TAG_COUNT) {
+        tag = DRGE_MEMORY_TAG_GENERAL;
+    }
+
+    if (size > (size_t)-1 - DRGE_LARGE_BLOCK_HEADER_SIZE - DRGE_HUGE_PAGE_SIZE*2) {
+        return NULL;
+    }
+
+    unsigned int flags;
+    unsigned char* pMapping = drge_map_large_block(DRGE_LARGE_BLOCK_HEADER_SIZE + size, &flags);
+    if (pMapping == NULL) {
+        return NULL;
+    }
+
+    drge_memory_header* pHeader = (drge_memory_header*)(pMapping + DRGE_LARGE_BLOCK_HEADER_SIZE - DRGE_MEMORY_HEADER_SIZE);
+    pHeader->size  = size;
+    pHeader->tag   = tag;
+    pHeader->flags = flags;
+
+    size_t mappedSize = drge_get_large_block_mapped_size(DRGE_LARGE_BLOCK_HEADER_SIZE + size, flags);
+    drge_atomic_fetch_add_64(&g_drgeLargeBlockCount, 1);
+    drge_atomic_fetch_add_64(&g_drgeLargeBlockMappedBytes, (long long)mappedSize);
+    if ((flags & DRGE_MEMORY_FLAG_HUGE_PAGES) != 0) {
+        drge_atomic_fetch_add_64(&g_drgeHugePageBytes, (long long)mappedSize);
+    }
+    if ((flags & DRGE_MEMORY_FLAG_TRANSPARENT) != 0) {
+        drge_atomic_fetch_add_64(&g_drgeTransparentHugePageBytes, (long long)(mappedSize & ~(size_t)(DRGE_HUGE_PAGE_SIZE - 1)));
+    }
+
+    drge_memory_on_alloc(tag, size);
+    return pMapping + DRGE_LARGE_BLOCK_HEADER_SIZE;
+}
+
+void drge_get_large_block_stats(drge_large_block_stats* pStatsOut)
+{
+    if (pStatsOut == NULL) {
+        return;
+    }
+
+    memset(pStatsOut, 0, sizeof(*pStatsOut));
+    pStatsOut->blockCount               = drge_atomic_load_64(&g_drgeLargeBlockCount);
+    pStatsOut->mappedBytes              = drge_atomic_load_64(&g_drgeLargeBlockMappedBytes);
+    pStatsOut->hugePageBytes            = drge_atomic_load_64(&g_drgeHugePageBytes);
+    pStatsOut->transparentHugePageBytes = drge_atomic_load_64(&g_drgeTransparentHugePageBytes);
+    pStatsOut->fallbackCount            = drge_atomic_load_64(&g_drgeHugePageFallbackCount);
+
+#ifdef __linux__
+    FILE* pFile = fopen("/proc/self/smaps_rollup", "r");
+    if (pFile != NULL) {
+        char line[256];
+        while (fgets(line, sizeof(line), pFile) != NULL) {
+            long long kb;
+            if (sscanf(line, "AnonHugePages: %lld kB", &kb) == 1) {
+                pStatsOut->processTransparentHugePageBytes = kb * 1024;
+                break;
+            }
+        }
+
+        fclose(pFile);
+    }
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Arenas
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define DRGE_ARENA_ALIGNMENT    16
+
+// The slice the calling thread is allocating from. A thread only holds one slice at a time. If it switches between
+// arenas it claims a fresh slice, which wastes the rest of the old one, but that's rare.
+typedef struct
+{
+    drge_arena* pArena;
+    long long generation;
+    unsigned char* pCursor;
+    unsigned char* pEnd;
+} drge_arena_slice;
+
+static DRGE_THREAD_LOCAL drge_arena_slice g_drgeArenaSlice;
+
+// Arena generations are unique across every arena so that a slice left over from an arena that was uninitialized can't
+// be mistaken for a slice of a new arena that's been initialized at the same address.
+static volatile long long g_drgeArenaGeneration = 0;
+
+static long long drge_next_arena_generation()
+{
+    return drge_atomic_fetch_add_64(&g_drgeArenaGeneration, 1) + 1;
+}
+
+// Claims a range of the arena. Returns null if the arena doesn't have enough left, in which case the offset is left
+// alone so that a smaller claim can still use what's left.
+static unsigned char* drge_arena_claim(drge_arena* pArena, size_t size)
+{
+    assert(pArena != NULL);
+
+    long long offset = drge_atomic_load_64(&pArena->offset);
+    for (;;) {
+        if ((unsigned long long)offset + size > pArena->capacity) {
+            return NULL;
+        }
+
+        long long prevOffset = drge_atomic_compare_exchange_64(&pArena->offset, offset, offset + (long long)size);
+        if (prevOffset == offset) {
+            break;
+        }
+        offset = prevOffset;
+    }
+
+    long long endOffset = offset + (long long)size;
+    long long peakOffset = drge_atomic_load_64(&pArena->peakOffset);
+    while (endOffset > peakOffset) {
+        long long prevPeakOffset = drge_atomic_compare_exchange_64(&pArena->peakOffset, peakOffset, endOffset);
+        if (prevPeakOffset == peakOffset) {
+            break;
+        }
+        peakOffset = prevPeakOffset;
+    }
+
+    return pArena->pData + offset;
+}
+
+bool drge_init_arena(drge_arena* pArena, size_t capacity, int tag)
+{
+    if (pArena == NULL) {
+        return false;
+    }
+
+    memset(pArena, 0, sizeof(*pArena));
+
+    pArena->pData = DRGE_LARGE_ALLOC(capacity, tag);
+    if (pArena->pData == NULL) {
+        return false;
+    }
+
+    pArena->capacity   = capacity;
+    pArena->generation = drge_next_arena_generation();
+    return true;
+}
+
+void drge_uninit_arena(drge_arena* pArena)
+{
+    if (pArena == NULL) {
+        return;
+    }
+
+    drge_reset_arena(pArena);   // Makes sure no thread is left holding a slice of freed memory.
+    DRGE_FREE(pArena->pData);
+    pArena->pData    = NULL;
+    pArena->capacity = 0;
+}
+
+void* drge_arena_alloc(drge_arena* pArena, size_t size)
+{
+    if (pArena == NULL || size > pArena->capacity) {
+        return NULL;
+    }
+
+    size = (size + DRGE_ARENA_ALIGNMENT - 1) & ~(size_t)(DRGE_ARENA_ALIGNMENT - 1);
+
+    drge_arena_slice* pSlice = &g_drgeArenaSlice;
+    long long generation = drge_atomic_load_64(&pArena->generation);
+
+    if (pSlice->pArena == pArena && pSlice->generation == generation && (size_t)(pSlice->pEnd - pSlice->pCursor) >= size) {
+        void* p = pSlice->pCursor;
+        pSlice->pCursor += size;
+        return p;
+    }
+
+    // Big allocations are claimed directly so they don't waste most of a slice.
+    unsigned char* p;
+    if (size > DRGE_ARENA_SLICE_SIZE/4) {
+        p = drge_arena_claim(pArena, size);
+    } else {
+        p = drge_arena_claim(pArena, DRGE_ARENA_SLICE_SIZE);
+        if (p != NULL) {
+            pSlice->pArena     = pArena;
+            pSlice->generation = generation;
+            pSlice->pCursor    = p + size;
+            pSlice->pEnd       = p + DRGE_ARENA_SLICE_SIZE;
+        } else {
+            // There's not enough left for a whole slice, but there might be enough for this allocation.
+            p = drge_arena_claim(pArena, size);
+        }
+    }
+
+    if (p == NULL) {
+        drge_atomic_fetch_add_64(&pArena->failedAllocationCount, 1);
+    }
+
+    return p;
+}
+
+void drge_reset_arena(drge_arena* pArena)
+{
+    if (pArena == NULL) {
+        return;
+    }
+
+    drge_atomic_store_64(&pArena->generation, drge_next_arena_generation());
+    drge_atomic_store_64(&pArena->offset, 0);
+}
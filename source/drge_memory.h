@@ -0,0 +1,206 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Every heap allocation made by the engine, and by the dr_libs and stb libraries it's built with, goes through
+// DRGE_MALLOC() and DRGE_FREE(). Each allocation is tagged with the subsystem it belongs to so memory use can be broken
+// down by subsystem, and the underlying allocator can be replaced with drge_set_allocator().
+//
+// Each allocation has a small header in front of it which holds it's size and tag. This means memory from DRGE_MALLOC()
+// must only ever be freed with DRGE_FREE(), and never with free(), and vice versa.
+//
+// The counters are updated with atomic adds so they can be read at any time from any thread.
+
+// Memory tags. These identify which subsystem an allocation belongs to.
+#define DRGE_MEMORY_TAG_GENERAL     0
+#define DRGE_MEMORY_TAG_ASSETS      1
+#define DRGE_MEMORY_TAG_VFS         2
+#define DRGE_MEMORY_TAG_GUI         3
+#define DRGE_MEMORY_TAG_AUDIO       4
+#define DRGE_MEMORY_TAG_GRAPHICS    5
+#define DRGE_MEMORY_TAG_STRINGS     6
+#define DRGE_MEMORY_TAG_COUNT       7
+
+// Define DRGE_MALLOC, DRGE_CALLOC, DRGE_REALLOC and DRGE_FREE together before including dr_ge.h to bypass the engine's
+// allocator completely, in which case the counters are not updated. Defining only some of them doesn't work because the
+// rest are only defined here when DRGE_MALLOC isn't. DRGE_LARGE_ALLOC is the fifth and is optional. It falls back to
+// DRGE_MALLOC when it's left out, and if it is defined it must return memory DRGE_FREE can free. It can't be defined
+// without the other four, because drge_free() can't free memory from anywhere else.
+#ifndef DRGE_MALLOC
+#define DRGE_MALLOC(size, tag)          drge_malloc((size), (tag))
+#define DRGE_CALLOC(count, size, tag)   drge_calloc((count), (size), (tag))
+#define DRGE_REALLOC(p, size, tag)      drge_realloc((p), (size), (tag))
+#define DRGE_FREE(p)                    drge_free((p))
+#define DRGE_LARGE_ALLOC(size, tag)     drge_large_alloc((size), (tag))
+#endif
+
+// When the engine's allocator is bypassed, large blocks come from the replacement allocator as well.
+#ifndef DRGE_LARGE_ALLOC
+#define DRGE_LARGE_ALLOC(size, tag)     DRGE_MALLOC((size), (tag))
+#endif
+
+typedef void* (* drge_malloc_proc) (size_t size, void* pUserData);
+typedef void* (* drge_realloc_proc)(void* p, size_t size, void* pUserData);
+typedef void  (* drge_free_proc)   (void* p, void* pUserData);
+
+// The underlying allocator. Allocations made through it must be aligned to at least 16 bytes.
+typedef struct
+{
+    drge_malloc_proc onMalloc;
+    drge_realloc_proc onRealloc;
+    drge_free_proc onFree;
+    void* pUserData;
+} drge_allocator;
+
+// The memory counters for a tag.
+typedef struct
+{
+    // The number of bytes, and the number of allocations, that are currently allocated.
+    long long liveBytes;
+    long long liveAllocationCount;
+
+    // The most bytes that have been allocated at any one time.
+    long long peakBytes;
+
+    // The total number of allocations that have been made, and the total number of bytes they were for. Sample these
+    // at intervals to get an allocation rate. Reallocations count as allocations.
+    unsigned long long allocationCount;
+    unsigned long long allocatedBytes;
+} drge_memory_stats;
+
+
+// Replaces the allocator used by DRGE_MALLOC() and friends. Pass null to go back to malloc() and free().
+//
+// This must be called before anything is allocated, which is before creating a context.
+void drge_set_allocator(const drge_allocator* pAllocator);
+
+// Allocates memory and tags it with the given DRGE_MEMORY_TAG_*. Use DRGE_MALLOC() rather than calling this directly.
+void* drge_malloc(size_t size, int tag);
+
+// Allocates zeroed memory for an array and tags it.
+void* drge_calloc(size_t count, size_t size, int tag);
+
+// Resizes memory that was allocated with drge_malloc(). The memory keeps it's original tag, unless p is null in which
+// case this is the same as drge_malloc().
+void* drge_realloc(void* p, size_t size, int tag);
+
+// Frees memory that was allocated with drge_malloc().
+void drge_free(void* p);
+
+// Retrieves the counters for the given tag.
+void drge_get_memory_stats(int tag, drge_memory_stats* pStatsOut);
+
+// Retrieves the name of the given tag, for display. Returns null if the tag is invalid.
+const char* drge_get_memory_tag_name(int tag);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Large Blocks
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Large blocks are for big buffers that are swept over, such as decoded images, audio and arenas. They're mapped
+// straight from the operating system, and on Linux they're backed by 2 MB huge pages where possible so that sweeping
+// over them doesn't miss the TLB on every 4 KB page. Large blocks are freed with DRGE_FREE() like everything else, and
+// are counted under their tag.
+//
+// Anything smaller than DRGE_LARGE_BLOCK_MIN_SIZE can't make use of a huge page so it just comes from DRGE_MALLOC().
+
+#define DRGE_LARGE_BLOCK_MIN_SIZE   (2*1024*1024)
+
+// Large page modes.
+//
+// DRGE_LARGE_PAGES_TRANSPARENT asks Linux for transparent huge pages with MADV_HUGEPAGE. These work without any setup
+// but the kernel only gives them out when it has 2 MB of contiguous memory free. This is the default.
+//
+// DRGE_LARGE_PAGES_EXPLICIT uses pages from the hugetlbfs pool with MAP_HUGETLB, which is guaranteed to be huge pages
+// but the pool needs to be reserved ahead of time with vm.nr_hugepages. On Windows this uses MEM_LARGE_PAGES, which
+// needs the "Lock pages in memory" privilege. Blocks are rounded up to a whole number of huge pages, which on Linux
+// are the default hugetlbfs size from Hugepagesize in /proc/meminfo. When the pages can't be had it falls back to
+// transparent huge pages.
+#define DRGE_LARGE_PAGES_OFF            0
+#define DRGE_LARGE_PAGES_TRANSPARENT    1
+#define DRGE_LARGE_PAGES_EXPLICIT       2
+
+typedef struct
+{
+    // The number of large blocks that are mapped, and the number of bytes mapped for them.
+    long long blockCount;
+    long long mappedBytes;
+
+    // The number of bytes of large blocks that are backed by explicit huge pages. These are always huge pages.
+    long long hugePageBytes;
+
+    // The number of bytes of large blocks that were marked for transparent huge pages. The kernel gives these huge
+    // pages when it can, so this is an upper bound.
+    long long transparentHugePageBytes;
+
+    // The number of bytes of transparent huge pages the kernel has actually given the whole process, including memory
+    // that isn't from large blocks. This is AnonHugePages from /proc/self/smaps_rollup, and is 0 if that isn't
+    // available.
+    long long processTransparentHugePageBytes;
+
+    // The number of times huge pages were asked for but couldn't be had, and normal pages were used instead.
+    long long fallbackCount;
+} drge_large_block_stats;
+
+
+// Sets how large blocks are backed. This is one of DRGE_LARGE_PAGES_* and only affects blocks allocated after calling
+// this. Can be set with HugePages in the config.
+void drge_set_large_page_mode(int mode);
+
+// Allocates a large block and tags it. Use DRGE_LARGE_ALLOC() rather than calling this directly. The memory is aligned
+// to 64 bytes and must be freed with DRGE_FREE().
+void* drge_large_alloc(size_t size, int tag);
+
+// Retrieves the large block counters.
+void drge_get_large_block_stats(drge_large_block_stats* pStatsOut);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Arenas
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// An arena is a linear allocator for short lived memory. Allocating is a pointer increment and nothing is freed
+// individually. Instead the whole arena is reset at once, which is how the per-frame arenas work - see
+// drge_frame_alloc().
+//
+// Any number of threads can allocate from an arena at the same time. Each thread claims a slice of the arena with a
+// compare-and-swap and then allocates from that slice without touching shared state until it runs out.
+
+// The size of the slice each thread claims at a time. Allocations bigger than a quarter of this are claimed directly.
+#define DRGE_ARENA_SLICE_SIZE   65536
+
+typedef struct
+{
+    // The memory backing the arena.
+    unsigned char* pData;
+    size_t capacity;
+
+    // The number of bytes that have been handed out, to slices or directly.
+    volatile long long offset;
+
+    // Changed every time the arena is reset so that threads know to let go of their slice.
+    volatile long long generation;
+
+    // The largest offset the arena has reached, and the number of allocations that failed because it was full. Use
+    // these to size the arena.
+    volatile long long peakOffset;
+    volatile long long failedAllocationCount;
+} drge_arena;
+
+
+// Initializes an arena with the given capacity. The memory is allocated with the given tag.
+bool drge_init_arena(drge_arena* pArena, size_t capacity, int tag);
+
+// Frees the memory of an arena.
+void drge_uninit_arena(drge_arena* pArena);
+
+// Allocates memory from an arena. The memory is aligned to 16 bytes and is not cleared. Returns null if the arena is
+// full. This can be called from any thread.
+void* drge_arena_alloc(drge_arena* pArena, size_t size);
+
+// Resets an arena, making all of the memory that was allocated from it available again. This must only be called when
+// no other thread is allocating from the arena or using memory from it.
+void drge_reset_arena(drge_arena* pArena);
@@ -76,7 +76,8 @@ void drge_uninit_window_system()
 drge_window* drge_create_window(drge_context* pContext, const char* pTitle, unsigned int resolutionX, unsigned int resolutionY, unsigned int options)
 {
     // This assumes the window class has already been registered by drge_init_window_system().
-    HWND hWnd = CreateWindowExA(0, g_LTWndClassName, pTitle, WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, resolutionX, resolutionY, NULL, NULL, NULL, NULL);
+    DWORD dwStyle = ((options & DRGE_WINDOW_FULLSCREEN) != 0) ? WS_POPUP : WS_OVERLAPPEDWINDOW;
+    HWND hWnd = CreateWindowExA(0, g_LTWndClassName, pTitle, dwStyle, CW_USEDEFAULT, CW_USEDEFAULT, resolutionX, resolutionY, NULL, NULL, NULL, NULL);
     if (hWnd == NULL) {
         return NULL;
     }
@@ -116,12 +117,30 @@ drge_window* drge_create_window(drge_context* pContext, const char* pTitle, unsi
         }
     }
 
+    // Fullscreen windows are borderless popups covering the monitor. The compositor stops compositing these on it's own,
+    // and there's no way to ask it to keep going, so borderless is the same as fullscreen here.
+    if ((options & DRGE_WINDOW_FULLSCREEN) != 0)
+    {
+        MONITORINFO mi;
+        ZeroMemory(&mi, sizeof(mi));
+        mi.cbSize = sizeof(MONITORINFO);
+        if (GetMonitorInfoA(MonitorFromWindow(hWnd, MONITOR_DEFAULTTOPRIMARY), &mi))
+        {
+            windowPosX   = mi.rcMonitor.left;
+            windowPosY   = mi.rcMonitor.top;
+            windowWidth  = mi.rcMonitor.right  - mi.rcMonitor.left;
+            windowHeight = mi.rcMonitor.bottom - mi.rcMonitor.top;
+
+            swpflags &= ~SWP_NOMOVE;
+        }
+    }
+
     SetWindowPos(hWnd, NULL, windowPosX, windowPosY, windowWidth, windowHeight, swpflags);
 
 
     // At this point the window should be in the correct position and at the correct size. It should now be safe to create the window
     // object and show the window.
-    drge_window* pWindow = malloc(sizeof(*pWindow));
+    drge_window* pWindow = DRGE_MALLOC(sizeof(*pWindow), DRGE_MEMORY_TAG_GENERAL);
     if (pWindow == NULL) {
         DestroyWindow(hWnd);
         return NULL;
@@ -148,7 +167,7 @@ void drge_delete_window(drge_window* pWindow)
     }
 
     DestroyWindow(pWindow->hWnd);
-    free(pWindow);
+    DRGE_FREE(pWindow);
 }
 
 
@@ -174,29 +193,312 @@ void* drge_get_window_hdc(drge_window* pWindow)
 
 
 
+// Handles every message in the queue. Returns false if a quit message was received.
+static bool drge_handle_pending_messages_win32(int* pExitCodeOut)
+{
+    assert(pExitCodeOut != NULL);
+
+    MSG msg;
+    while (PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE))
+    {
+        if (msg.message == WM_QUIT) {
+            *pExitCodeOut = (int)msg.wParam;
+            return false;
+        }
+
+        TranslateMessage(&msg);
+        DispatchMessageA(&msg);
+    }
+
+    return true;
+}
+
 int drge_main_loop(drge_context* pContext)
 {
+    int exitCode = 0;
+    long long nextFrameTicks = drge_get_ticks();
+
     while (!drge_wants_to_close(pContext))
     {
-        // Handle window events.
+        // Handle every pending message before doing the frame. Handling only one per frame lets input back up when
+        // messages arrive faster than frames.
+        if (!drge_handle_pending_messages_win32(&exitCode)) {
+            return exitCode;
+        }
+
+        // When idle there's no point doing frames until something happens, so block until the next message arrives.
+        // The time spent waiting is discarded so the game doesn't try to step through it.
+        if (drge_is_idle(pContext)) {
+            WaitMessage();
+            if (!drge_handle_pending_messages_win32(&exitCode)) {
+                return exitCode;
+            }
+
+            drge_tick_timer(pContext->pTimer);
+        }
+
+        drge_do_frame(pContext);
+
+        // Frame limiting. Messages are handled while waiting so input isn't held up by the limiter.
+        unsigned int maxFrameRate = drge_get_max_frame_rate(pContext);
+        if (maxFrameRate > 0)
+        {
+            long long nowTicks = drge_get_ticks();
+            nextFrameTicks += drge_get_tick_frequency() / maxFrameRate;
+            if (nextFrameTicks < nowTicks) {
+                nextFrameTicks = nowTicks;  // Running behind. Don't try to catch up.
+            }
+
+            while (nowTicks < nextFrameTicks && !drge_wants_to_close(pContext))
+            {
+                DWORD timeoutMS = (DWORD)((nextFrameTicks - nowTicks) * 1000 / drge_get_tick_frequency());
+                if (MsgWaitForMultipleObjects(0, NULL, FALSE, timeoutMS, QS_ALLINPUT) == WAIT_OBJECT_0) {
+                    if (!drge_handle_pending_messages_win32(&exitCode)) {
+                        return exitCode;
+                    }
+                }
+
+                nowTicks = drge_get_ticks();
+            }
+        }
+    }
+
+    return exitCode;
+}
+
+
+static drge_context* g_pInterruptContext = NULL;
+
+static BOOL WINAPI drge_console_ctrl_handler_win32(DWORD ctrlType)
+{
+    if (ctrlType == CTRL_C_EVENT || ctrlType == CTRL_BREAK_EVENT) {
+        drge_request_close(g_pInterruptContext);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+void drge_close_on_interrupt(drge_context* pContext)
+{
+    g_pInterruptContext = pContext;
+    SetConsoleCtrlHandler(drge_console_ctrl_handler_win32, pContext != NULL);
+}
+
+
+
+static const char* g_drgeRawInputWndClassName = "drge_raw_input";
+
+struct drge_raw_input
+{
+    // The queue events are pushed onto.
+    drge_raw_input_queue* pQueue;
+
+    // Raw input is delivered as WM_INPUT messages to a message-only window owned by the input thread, so that it never
+    // goes through the main thread's message queue.
+    HWND hWnd;
+
+    // The ID of the input thread, for posting WM_QUIT to it.
+    DWORD threadID;
+
+    // Signaled once the input thread has either registered for raw input or failed to.
+    HANDLE hReadyEvent;
+    bool isReady;
+
+    // Wheel movement that hasn't added up to a whole notch yet. High resolution wheels report fractions of WHEEL_DELTA.
+    int wheelDelta;
+
+    dr_thread thread;
+};
+
+// Determines whether or not one of the application's windows is in the foreground. Raw input is delivered no matter
+// which window has focus, so this stops the game from seeing input that was meant for other applications.
+static bool drge_has_focus_win32()
+{
+    DWORD processID = 0;
+    GetWindowThreadProcessId(GetForegroundWindow(), &processID);
+    return processID == GetCurrentProcessId();
+}
+
+static void drge_push_raw_button_win32(drge_raw_input* pRawInput, int type, unsigned int button, long long ticks)
+{
+    drge_raw_input_event e;
+    memset(&e, 0, sizeof(e));
+    e.type   = type;
+    e.button = button;
+    e.ticks  = ticks;
+    drge_push_raw_input(pRawInput->pQueue, &e);
+}
+
+// Pushes the events for a WM_INPUT message onto the queue.
+static void drge_handle_raw_input_win32(drge_raw_input* pRawInput, HRAWINPUT hRawInput, long long ticks)
+{
+    assert(pRawInput != NULL);
+
+    RAWINPUT rawInput;
+    UINT rawInputSize = sizeof(rawInput);
+    if (GetRawInputData(hRawInput, RID_INPUT, &rawInput, &rawInputSize, sizeof(RAWINPUTHEADER)) == (UINT)-1) {
+        return;
+    }
+
+    if (rawInput.header.dwType != RIM_TYPEMOUSE || !drge_has_focus_win32()) {
+        return;
+    }
+
+    const RAWMOUSE* pMouse = &rawInput.data.mouse;
+
+    // Tablets and remote desktop sessions give absolute positions which don't make sense as raw motion.
+    if ((pMouse->usFlags & MOUSE_MOVE_ABSOLUTE) == 0 && (pMouse->lLastX != 0 || pMouse->lLastY != 0)) {
+        drge_raw_input_event e;
+        memset(&e, 0, sizeof(e));
+        e.type   = DRGE_RAW_INPUT_MOTION;
+        e.deltaX = (float)pMouse->lLastX;
+        e.deltaY = (float)pMouse->lLastY;
+        e.ticks  = ticks;
+        drge_push_raw_input(pRawInput->pQueue, &e);
+    }
+
+    // Button numbers match X11, where 1, 2 and 3 are the left, middle and right buttons.
+    USHORT buttonFlags = pMouse->usButtonFlags;
+    if (buttonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)   { drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_DOWN, 1, ticks); }
+    if (buttonFlags & RI_MOUSE_LEFT_BUTTON_UP)     { drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_UP,   1, ticks); }
+    if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN) { drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_DOWN, 2, ticks); }
+    if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)   { drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_UP,   2, ticks); }
+    if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)  { drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_DOWN, 3, ticks); }
+    if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_UP)    { drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_UP,   3, ticks); }
+
+    // X11 reports each notch of the wheel as a press and release of button 4 or 5, so the same is done here. A fast
+    // scroll can move several notches in one message.
+    if (buttonFlags & RI_MOUSE_WHEEL) {
+        pRawInput->wheelDelta += (SHORT)pMouse->usButtonData;
+        while (pRawInput->wheelDelta >= WHEEL_DELTA || pRawInput->wheelDelta <= -WHEEL_DELTA) {
+            unsigned int button = (pRawInput->wheelDelta > 0) ? 4 : 5;
+            drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_DOWN, button, ticks);
+            drge_push_raw_button_win32(pRawInput, DRGE_RAW_INPUT_BUTTON_UP,   button, ticks);
+            pRawInput->wheelDelta += (button == 4) ? -WHEEL_DELTA : WHEEL_DELTA;
+        }
+    }
+}
+
+static int drge_raw_input_thread_proc(void* pUserData)
+{
+    drge_raw_input* pRawInput = pUserData;
+    assert(pRawInput != NULL);
+
+    drge_profile_set_thread_name("Input");
+    drge_register_current_thread(DRGE_THREAD_ROLE_INPUT, "Input");
+
+    pRawInput->threadID = GetCurrentThreadId();
+
+    // The window has to be created on this thread since it's messages go to the thread that created it. The class
+    // might already be registered from an earlier call to drge_start_raw_input(), which is fine.
+    WNDCLASSEXA wc;
+    ZeroMemory(&wc, sizeof(wc));
+    wc.cbSize        = sizeof(wc);
+    wc.lpfnWndProc   = DefWindowProcA;
+    wc.hInstance     = GetModuleHandleA(NULL);
+    wc.lpszClassName = g_drgeRawInputWndClassName;
+    RegisterClassExA(&wc);
+
+    pRawInput->hWnd = CreateWindowExA(0, g_drgeRawInputWndClassName, NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, NULL);
+    if (pRawInput->hWnd != NULL)
+    {
+        // RIDEV_INPUTSINK is needed because a message-only window is never in the foreground.
+        RAWINPUTDEVICE device;
+        device.usUsagePage = 0x01;  // Generic desktop controls.
+        device.usUsage     = 0x02;  // Mouse.
+        device.dwFlags     = RIDEV_INPUTSINK;
+        device.hwndTarget  = pRawInput->hWnd;
+        pRawInput->isReady = RegisterRawInputDevices(&device, 1, sizeof(device)) != FALSE;
+    }
+
+    SetEvent(pRawInput->hReadyEvent);
+
+    if (pRawInput->isReady)
+    {
+        // Events are timestamped as soon as they're taken off the queue. GetMessageTime() is only milliseconds.
         MSG msg;
-        if (PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE))
+        while (GetMessageA(&msg, NULL, 0, 0) > 0)
         {
-            if (msg.message == WM_QUIT) {
-                return (int)msg.wParam;  // Received a quit message.
+            if (msg.message == WM_INPUT) {
+                drge_handle_raw_input_win32(pRawInput, (HRAWINPUT)msg.lParam, drge_get_ticks());
             }
 
-            TranslateMessage(&msg);
+            // WM_INPUT still needs to go to DefWindowProc() so the system can clean up after it.
             DispatchMessageA(&msg);
         }
 
-        // After handling the next event in the queue we let the game know it should do the next frame.
-        drge_do_frame(pContext);
+        RAWINPUTDEVICE device;
+        device.usUsagePage = 0x01;
+        device.usUsage     = 0x02;
+        device.dwFlags     = RIDEV_REMOVE;
+        device.hwndTarget  = NULL;
+        RegisterRawInputDevices(&device, 1, sizeof(device));
+    }
+
+    if (pRawInput->hWnd != NULL) {
+        DestroyWindow(pRawInput->hWnd);
     }
 
+    drge_unregister_current_thread();
     return 0;
 }
 
+drge_raw_input* drge_start_raw_input(drge_raw_input_queue* pQueue)
+{
+    if (pQueue == NULL) {
+        return NULL;
+    }
+
+    drge_raw_input* pRawInput = DRGE_MALLOC(sizeof(*pRawInput), DRGE_MEMORY_TAG_GENERAL);
+    if (pRawInput == NULL) {
+        return NULL;
+    }
+
+    memset(pRawInput, 0, sizeof(*pRawInput));
+    pRawInput->pQueue = pQueue;
+
+    pRawInput->hReadyEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    if (pRawInput->hReadyEvent == NULL) {
+        goto on_error;
+    }
+
+    pRawInput->thread = dr_create_thread(drge_raw_input_thread_proc, pRawInput);
+    if (pRawInput->thread == NULL) {
+        goto on_error;
+    }
+
+    WaitForSingleObject(pRawInput->hReadyEvent, INFINITE);
+    if (!pRawInput->isReady) {
+        dr_wait_and_delete_thread(pRawInput->thread);   // The thread exits straight away when it fails.
+        goto on_error;
+    }
+
+    return pRawInput;
+
+
+on_error:
+    if (pRawInput->hReadyEvent != NULL) {
+        CloseHandle(pRawInput->hReadyEvent);
+    }
+
+    DRGE_FREE(pRawInput);
+    return NULL;
+}
+
+void drge_stop_raw_input(drge_raw_input* pRawInput)
+{
+    if (pRawInput == NULL) {
+        return;
+    }
+
+    PostThreadMessageA(pRawInput->threadID, WM_QUIT, 0, 0);
+    dr_wait_and_delete_thread(pRawInput->thread);
+
+    CloseHandle(pRawInput->hReadyEvent);
+    DRGE_FREE(pRawInput);
+}
+
 
 
 struct drge_timer
@@ -210,13 +512,13 @@ struct drge_timer
 
 drge_timer* drge_create_timer()
 {
-    drge_timer* pTimer = malloc(sizeof(*pTimer));
+    drge_timer* pTimer = DRGE_MALLOC(sizeof(*pTimer), DRGE_MEMORY_TAG_GENERAL);
     if (pTimer == NULL) {
         return NULL;
     }
 
     if (!QueryPerformanceFrequency(&pTimer->frequency) || !QueryPerformanceCounter(&pTimer->counter)) {
-        free(pTimer);
+        DRGE_FREE(pTimer);
         return NULL;
     }
 
@@ -225,7 +527,7 @@ drge_timer* drge_create_timer()
 
 void drge_delete_timer(drge_timer* pTimer)
 {
-    free(pTimer);
+    DRGE_FREE(pTimer);
 }
 
 double drge_tick_timer(drge_timer* pTimer)
@@ -237,10 +539,153 @@ double drge_tick_timer(drge_timer* pTimer)
 
     return (pTimer->counter.QuadPart - oldCounter.QuadPart) / (double)pTimer->frequency.QuadPart;
 }
+
+
+long long drge_get_ticks()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);      // Never fails on XP and newer.
+
+    return counter.QuadPart;
+}
+
+long long drge_get_tick_frequency()
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);  // Never fails on XP and newer. Fixed at boot.
+
+    return frequency.QuadPart;
+}
+
+
+unsigned int drge_get_cpu_count()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    return (info.dwNumberOfProcessors > 0) ? info.dwNumberOfProcessors : 1;
+}
+
+void drge_yield_thread()
+{
+    SwitchToThread();
+}
+
+
+typedef HRESULT (WINAPI * drge_SetThreadDescription_proc)(HANDLE hThread, PCWSTR lpThreadDescription);
+
+// The handle of a registered thread. This is a real handle rather than the pseudo handle from GetCurrentThread() so
+// that it can be used from other threads.
+typedef HANDLE drge_os_thread;
+
+static bool drge_get_current_os_thread(drge_os_thread* pThreadOut)
+{
+    assert(pThreadOut != NULL);
+
+    *pThreadOut = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, GetCurrentThreadId());
+    return *pThreadOut != NULL;
+}
+
+static void drge_release_os_thread(drge_os_thread thread)
+{
+    CloseHandle(thread);
+}
+
+static unsigned long long drge_get_os_thread_affinity_mask(drge_os_thread thread)
+{
+    (void)thread;
+
+    // Threads start with the affinity of the process.
+    DWORD_PTR processMask;
+    DWORD_PTR systemMask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        return 0;
+    }
+
+    return processMask;
+}
+
+static bool drge_set_os_thread_affinity_mask(drge_os_thread thread, unsigned long long affinityMask)
+{
+    return SetThreadAffinityMask(thread, (DWORD_PTR)affinityMask) != 0;
+}
+
+// The priority of a thread as the OS sees it.
+typedef struct
+{
+    int priority;
+} drge_os_thread_priority;
+
+static void drge_to_os_thread_priority(int priority, drge_os_thread_priority* pPriorityOut)
+{
+    assert(pPriorityOut != NULL);
+
+    switch (priority)
+    {
+        case DRGE_THREAD_PRIORITY_LOWEST:   pPriorityOut->priority = THREAD_PRIORITY_LOWEST;        break;
+        case DRGE_THREAD_PRIORITY_LOW:      pPriorityOut->priority = THREAD_PRIORITY_BELOW_NORMAL;  break;
+        case DRGE_THREAD_PRIORITY_HIGH:     pPriorityOut->priority = THREAD_PRIORITY_ABOVE_NORMAL;  break;
+        case DRGE_THREAD_PRIORITY_HIGHEST:  pPriorityOut->priority = THREAD_PRIORITY_HIGHEST;       break;
+        case DRGE_THREAD_PRIORITY_REALTIME: pPriorityOut->priority = THREAD_PRIORITY_TIME_CRITICAL; break;
+        default:                            pPriorityOut->priority = THREAD_PRIORITY_NORMAL;        break;
+    }
+}
+
+static bool drge_get_os_thread_priority(drge_os_thread thread, drge_os_thread_priority* pPriorityOut)
+{
+    assert(pPriorityOut != NULL);
+
+    pPriorityOut->priority = GetThreadPriority(thread);
+    return pPriorityOut->priority != THREAD_PRIORITY_ERROR_RETURN;
+}
+
+static bool drge_set_os_thread_priority(drge_os_thread thread, const drge_os_thread_priority* pPriority)
+{
+    assert(pPriority != NULL);
+
+    return SetThreadPriority(thread, pPriority->priority) != 0;
+}
+
+static bool drge_are_os_thread_priorities_equal(const drge_os_thread_priority* pA, const drge_os_thread_priority* pB)
+{
+    return pA->priority == pB->priority;
+}
+
+void drge_set_current_thread_name(const char* name)
+{
+    if (name == NULL) {
+        return;
+    }
+
+    // SetThreadDescription() is only available on Windows 10 1607 and newer so it needs to be looked up at run time.
+    drge_SetThreadDescription_proc pSetThreadDescription = (drge_SetThreadDescription_proc)GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+    if (pSetThreadDescription == NULL) {
+        return;
+    }
+
+    wchar_t nameW[64];
+    if (MultiByteToWideChar(CP_UTF8, 0, name, -1, nameW, sizeof(nameW)/sizeof(nameW[0])) == 0) {
+        return;
+    }
+
+    pSetThreadDescription(GetCurrentThread(), nameW);
+}
 #endif
 
 #ifndef _WIN32
 #include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XI2.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 struct drge_window
 {
@@ -262,6 +707,15 @@ Display* g_X11Display = NULL;
 // The atom for the WM_DELETE_WINDOW event so we can cleanly handle the close button on the window.
 Atom g_WM_DELETE_WINDOW = 0;
 
+// The atoms for the EWMH properties used by fullscreen windows.
+Atom g_NET_WM_STATE = 0;
+Atom g_NET_WM_STATE_FULLSCREEN = 0;
+Atom g_NET_WM_BYPASS_COMPOSITOR = 0;
+
+// Whether or not the game window has focus. Raw input is global, so this stops the game from seeing input that was
+// meant for other windows. This is set on the main thread and read on the input thread.
+static volatile long long g_X11HasFocus = 1;
+
 
 bool drge_init_window_system()
 {
@@ -271,12 +725,19 @@ bool drge_init_window_system()
         return true;
     }
 
+    // The input thread has a display connection of it's own, but Xlib's global state is still shared between threads.
+    // This has to come before any other Xlib call.
+    XInitThreads();
+
     g_X11Display = XOpenDisplay(NULL);
     if (g_X11Display == NULL) {
         return false;
     }
 
-    g_WM_DELETE_WINDOW = XInternAtom(g_X11Display, "WM_DELETE_WINDOW", False);
+    g_WM_DELETE_WINDOW         = XInternAtom(g_X11Display, "WM_DELETE_WINDOW", False);
+    g_NET_WM_STATE             = XInternAtom(g_X11Display, "_NET_WM_STATE", False);
+    g_NET_WM_STATE_FULLSCREEN  = XInternAtom(g_X11Display, "_NET_WM_STATE_FULLSCREEN", False);
+    g_NET_WM_BYPASS_COMPOSITOR = XInternAtom(g_X11Display, "_NET_WM_BYPASS_COMPOSITOR", False);
 
     g_X11InitCounter = 1;
     return true;
@@ -302,15 +763,146 @@ void drge_uninit_window_system()
 }
 
 
+// XRandR and Xinerama are loaded at run time like libXi, so neither is needed to build or run the game.
+typedef struct
+{
+    Atom name;
+    Bool primary;
+    Bool automatic;
+    int noutput;
+    int x;
+    int y;
+    int width;
+    int height;
+    int mwidth;
+    int mheight;
+    XID* outputs;
+} drge_XRRMonitorInfo;
+
+typedef struct
+{
+    int screen_number;
+    short x_org;
+    short y_org;
+    short width;
+    short height;
+} drge_XineramaScreenInfo;
+
+typedef drge_XRRMonitorInfo*     (* drge_XRRGetMonitors_proc)      (Display* display, Window window, Bool getActive, int* pMonitorCount);
+typedef void                     (* drge_XRRFreeMonitors_proc)     (drge_XRRMonitorInfo* pMonitors);
+typedef Bool                     (* drge_XineramaIsActive_proc)    (Display* display);
+typedef drge_XineramaScreenInfo* (* drge_XineramaQueryScreens_proc)(Display* display, int* pScreenCount);
+
+// Retrieves the position and size of the monitor new windows are put on, which is the primary one. The screen can span
+// several monitors, so it's size is only used when neither XRandR 1.5 nor Xinerama can say where the monitors are.
+static void drge_get_x11_monitor_rect(int screen, int* pPosX, int* pPosY, int* pSizeX, int* pSizeY)
+{
+    assert(pPosX != NULL);
+    assert(pPosY != NULL);
+    assert(pSizeX != NULL);
+    assert(pSizeY != NULL);
+
+    *pPosX  = 0;
+    *pPosY  = 0;
+    *pSizeX = DisplayWidth(g_X11Display, screen);
+    *pSizeY = DisplayHeight(g_X11Display, screen);
+
+    void* pXrandrSO = dlopen("libXrandr.so.2", RTLD_LAZY | RTLD_LOCAL);
+    if (pXrandrSO != NULL)
+    {
+        drge_XRRGetMonitors_proc  pXRRGetMonitors  = (drge_XRRGetMonitors_proc)dlsym(pXrandrSO, "XRRGetMonitors");
+        drge_XRRFreeMonitors_proc pXRRFreeMonitors = (drge_XRRFreeMonitors_proc)dlsym(pXrandrSO, "XRRFreeMonitors");
+        if (pXRRGetMonitors != NULL && pXRRFreeMonitors != NULL)
+        {
+            int monitorCount = 0;
+            drge_XRRMonitorInfo* pMonitors = pXRRGetMonitors(g_X11Display, RootWindow(g_X11Display, screen), True, &monitorCount);
+            if (pMonitors != NULL)
+            {
+                if (monitorCount > 0) {
+                    int iMonitor = 0;
+                    for (int i = 0; i < monitorCount; ++i) {
+                        if (pMonitors[i].primary) {
+                            iMonitor = i;
+                            break;
+                        }
+                    }
+
+                    *pPosX  = pMonitors[iMonitor].x;
+                    *pPosY  = pMonitors[iMonitor].y;
+                    *pSizeX = pMonitors[iMonitor].width;
+                    *pSizeY = pMonitors[iMonitor].height;
+                }
+
+                pXRRFreeMonitors(pMonitors);
+            }
+
+            if (monitorCount > 0) {
+                dlclose(pXrandrSO);
+                return;
+            }
+        }
+
+        dlclose(pXrandrSO);
+    }
+
+    // Xinerama doesn't know which monitor is the primary one, but the first is the primary one in practice.
+    void* pXineramaSO = dlopen("libXinerama.so.1", RTLD_LAZY | RTLD_LOCAL);
+    if (pXineramaSO != NULL)
+    {
+        drge_XineramaIsActive_proc     pXineramaIsActive     = (drge_XineramaIsActive_proc)dlsym(pXineramaSO, "XineramaIsActive");
+        drge_XineramaQueryScreens_proc pXineramaQueryScreens = (drge_XineramaQueryScreens_proc)dlsym(pXineramaSO, "XineramaQueryScreens");
+        if (pXineramaIsActive != NULL && pXineramaQueryScreens != NULL && pXineramaIsActive(g_X11Display))
+        {
+            int screenCount = 0;
+            drge_XineramaScreenInfo* pScreens = pXineramaQueryScreens(g_X11Display, &screenCount);
+            if (pScreens != NULL)
+            {
+                if (screenCount > 0) {
+                    *pPosX  = pScreens[0].x_org;
+                    *pPosY  = pScreens[0].y_org;
+                    *pSizeX = pScreens[0].width;
+                    *pSizeY = pScreens[0].height;
+                }
+
+                XFree(pScreens);
+            }
+        }
+
+        dlclose(pXineramaSO);
+    }
+}
+
 drge_window* drge_create_window(drge_context* pContext, const char* pTitle, unsigned int resolutionX, unsigned int resolutionY, unsigned int options)
 {
     XSetWindowAttributes wa;
     wa.colormap          = CopyFromParent;
     wa.border_pixel      = 0;
     wa.event_mask        = StructureNotifyMask | SubstructureNotifyMask | ExposureMask | ButtonPressMask | ButtonReleaseMask | KeyPressMask | KeyReleaseMask | PointerMotionMask | ButtonMotionMask | FocusChangeMask | PropertyChangeMask;
-    wa.overrdrge_editor_redirect = false;
+    wa.override_redirect = false;
+
+    int screen = DefaultScreen(g_X11Display);
+    int monitorPosX;
+    int monitorPosY;
+    int monitorSizeX;
+    int monitorSizeY;
+    drge_get_x11_monitor_rect(screen, &monitorPosX, &monitorPosY, &monitorSizeX, &monitorSizeY);
+
+    // Fullscreen windows are sized to the monitor they're on by the window manager when they're mapped, but they're
+    // created on top of the monitor anyway so that the window manager picks that one, and so they still cover it when
+    // there's no window manager. The screen can't be used for this because it spans every monitor.
+    int windowPosX = monitorPosX;
+    int windowPosY = monitorPosY;
+    unsigned int windowSizeX = resolutionX;
+    unsigned int windowSizeY = resolutionY;
+    if ((options & DRGE_WINDOW_FULLSCREEN) != 0) {
+        windowSizeX = (unsigned int)monitorSizeX;
+        windowSizeY = (unsigned int)monitorSizeY;
+    } else if ((options & DRGE_WINDOW_CENTERED) != 0) {
+        windowPosX = monitorPosX + (monitorSizeX - (int)resolutionX) / 2;
+        windowPosY = monitorPosY + (monitorSizeY - (int)resolutionY) / 2;
+    }
 
-    Window x11Window = XCreateWindow(g_X11Display, RootWindow(g_X11Display, DefaultScreen(g_X11Display)), 0, 0, resolutionX, resolutionY, 0, CopyFromParent, InputOutput, CopyFromParent, CWBorderPixel | CWColormap | CWEventMask | CWOverrideRedirect, &wa);
+    Window x11Window = XCreateWindow(g_X11Display, RootWindow(g_X11Display, screen), windowPosX, windowPosY, windowSizeX, windowSizeY, 0, CopyFromParent, InputOutput, CopyFromParent, CWBorderPixel | CWColormap | CWEventMask | CWOverrideRedirect, &wa);
     if (x11Window == 0) {
         return NULL;
     }
@@ -321,8 +913,29 @@ drge_window* drge_create_window(drge_context* pContext, const char* pTitle, unsi
     // Set the title.
     XStoreName(g_X11Display, x11Window, pTitle);
 
-    // TODO: Handle options.
-    (void)options;
+    if ((options & DRGE_WINDOW_FULLSCREEN) != 0)
+    {
+        // Setting the state before the window is mapped is how EWMH says to create a window that starts out fullscreen.
+        // The window manager takes care of removing the borders and covering the monitor.
+        XChangeProperty(g_X11Display, x11Window, g_NET_WM_STATE, XA_ATOM, 32, PropModeReplace, (unsigned char*)&g_NET_WM_STATE_FULLSCREEN, 1);
+
+        // 1 asks the compositor to stop compositing the window, and 2 asks it to keep compositing it. Compositors that
+        // don't support the hint will usually stop compositing fullscreen windows anyway.
+        long bypassCompositor = ((options & DRGE_WINDOW_BORDERLESS) != 0) ? 2 : 1;
+        XChangeProperty(g_X11Display, x11Window, g_NET_WM_BYPASS_COMPOSITOR, XA_CARDINAL, 32, PropModeReplace, (unsigned char*)&bypassCompositor, 1);
+    }
+    else if ((options & DRGE_WINDOW_CENTERED) != 0)
+    {
+        // Window managers are free to ignore the position the window was created at unless it's asked for explicitly.
+        XSizeHints* pSizeHints = XAllocSizeHints();
+        if (pSizeHints != NULL) {
+            pSizeHints->flags = USPosition;
+            pSizeHints->x     = windowPosX;
+            pSizeHints->y     = windowPosY;
+            XSetWMNormalHints(g_X11Display, x11Window, pSizeHints);
+            XFree(pSizeHints);
+        }
+    }
 
     // Show the window.
     XMapWindow(g_X11Display, x11Window);
@@ -331,7 +944,7 @@ drge_window* drge_create_window(drge_context* pContext, const char* pTitle, unsi
 
     // At this point the window should be in the correct position and at the correct size. It should now be safe to create the window
     // object and show the window.
-    drge_window* pWindow = malloc(sizeof(*pWindow));
+    drge_window* pWindow = DRGE_MALLOC(sizeof(*pWindow), DRGE_MEMORY_TAG_GENERAL);
     if (pWindow == NULL) {
         return NULL;
     }
@@ -349,7 +962,7 @@ void drge_delete_window(drge_window* pWindow)
     }
 
     XDestroyWindow(g_X11Display, pWindow->x11Window);
-    free(pWindow);
+    DRGE_FREE(pWindow);
 }
 
 
@@ -364,57 +977,425 @@ drge_context* drge_get_window_context(drge_window* pWindow)
 
 
 
+// Handles every event in the queue, including any that are sitting unread on the connection.
+static void drge_handle_pending_events_x11(drge_context* pContext)
+{
+    while (XPending(g_X11Display) > 0)
+    {
+        XEvent e;
+        XNextEvent(g_X11Display, &e);
+
+        switch (e.type)
+        {
+            case ClientMessage:
+            {
+                if (e.xclient.data.l[0] == (long)g_WM_DELETE_WINDOW) {
+                    drge_request_close(pContext);
+                }
+            } break;
+
+            case FocusIn:
+            case FocusOut:
+            {
+                drge_atomic_store_64(&g_X11HasFocus, (e.type == FocusIn) ? 1 : 0);
+            } break;
+        }
+    }
+}
+
+// Blocks until there's something to read on the X connection or the timeout expires. A timeout of -1 waits forever.
+//
+// This must only be called when the event queue is empty, otherwise it can block with events waiting to be handled.
+static bool drge_wait_for_events_x11(int timeoutMS)
+{
+    struct pollfd pfd;
+    pfd.fd      = ConnectionNumber(g_X11Display);
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    return poll(&pfd, 1, timeoutMS) > 0;
+}
+
 int drge_main_loop(drge_context* pContext)
 {
+    long long nextFrameTicks = drge_get_ticks();
+
     while (!drge_wants_to_close(pContext))
     {
-        // Handle window events.
-        int eventCount = XPending(g_X11Display);
-        if (eventCount > 0)
+        // Handle every pending event before doing the frame. Handling only one per frame lets input back up when events
+        // arrive faster than frames.
+        drge_handle_pending_events_x11(pContext);
+
+        // When idle there's no point doing frames until something happens, so block on the X connection until the next
+        // event arrives. The time spent waiting is discarded so the game doesn't try to step through it.
+        if (drge_is_idle(pContext)) {
+            drge_wait_for_events_x11(-1);
+            drge_handle_pending_events_x11(pContext);
+            drge_tick_timer(pContext->pTimer);
+        }
+
+        drge_do_frame(pContext);
+
+        // Frame limiting. Events are handled while waiting so input isn't held up by the limiter. poll() only has
+        // millisecond precision so the last partial millisecond is slept off separately.
+        unsigned int maxFrameRate = drge_get_max_frame_rate(pContext);
+        if (maxFrameRate > 0)
         {
-            XEvent e;
-            XNextEvent(g_X11Display, &e);
+            long long nowTicks = drge_get_ticks();
+            nextFrameTicks += drge_get_tick_frequency() / maxFrameRate;
+            if (nextFrameTicks < nowTicks) {
+                nextFrameTicks = nowTicks;  // Running behind. Don't try to catch up.
+            }
 
-            switch (e.type)
+            while (nowTicks < nextFrameTicks && !drge_wants_to_close(pContext))
             {
-                case ClientMessage:
-                {
-                    if (e.xclient.data.l[0] == (long)g_WM_DELETE_WINDOW) {
-                        drge_request_close(pContext);
-                    }
-                } break;
+                long long remainingNS = nextFrameTicks - nowTicks;    // drge_get_ticks() is in nanoseconds.
+                if (remainingNS >= 1000000) {
+                    // The queue has to be emptied before every wait. The frame can make Xlib read events off the
+                    // connection into the queue, where poll() can't see them.
+                    drge_handle_pending_events_x11(pContext);
+                    drge_wait_for_events_x11((int)(remainingNS / 1000000));
+                } else {
+                    struct timespec ts;
+                    ts.tv_sec  = 0;
+                    ts.tv_nsec = (long)remainingNS;
+                    nanosleep(&ts, NULL);
+                }
+
+                nowTicks = drge_get_ticks();
             }
         }
-
-        // After handling the next event in the queue we let the game know it should do the next frame.
-        drge_do_frame(pContext);
     }
 
     return 0;
 }
 
 
+static drge_context* volatile g_pInterruptContext = NULL;
 
-struct drge_timer
+static void drge_interrupt_handler_linux(int signal)
 {
-    long long unused;
+    (void)signal;
+    drge_request_close(g_pInterruptContext);
+}
+
+void drge_close_on_interrupt(drge_context* pContext)
+{
+    g_pInterruptContext = pContext;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = (pContext != NULL) ? drge_interrupt_handler_linux : SIG_DFL;
+    sigemptyset(&action.sa_mask);
+
+    sigaction(SIGINT,  &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+
+
+// These mirror the parts of XInput2.h that are needed for raw input. libXi is loaded at run time so that it's not a
+// build or run time dependency, which means it's headers aren't needed either.
+typedef struct
+{
+    int deviceid;
+    int mask_len;
+    unsigned char* mask;
+} drge_XIEventMask;
+
+typedef struct
+{
+    int mask_len;
+    unsigned char* mask;
+    double* values;
+} drge_XIValuatorState;
+
+typedef struct
+{
+    int type;
+    unsigned long serial;
+    Bool send_event;
+    Display* display;
+    int extension;
+    int evtype;
+    Time time;
+    int deviceid;
+    int sourceid;
+    int detail;
+    int flags;
+    drge_XIValuatorState valuators;
+    double* raw_values;
+} drge_XIRawEvent;
+
+typedef Status (* drge_XIQueryVersion_proc)(Display* display, int* pMajorVersion, int* pMinorVersion);
+typedef int    (* drge_XISelectEvents_proc)(Display* display, Window window, drge_XIEventMask* pMasks, int maskCount);
+
+struct drge_raw_input
+{
+    // The queue events are pushed onto.
+    drge_raw_input_queue* pQueue;
+
+    // The input thread has a connection to the X server of it's own so that it never has to wait on the main thread's,
+    // and so that raw events don't go through the main thread's event queue.
+    Display* pDisplay;
+
+    // The major opcode of the XInput extension, for recognizing it's events.
+    int xiOpcode;
+
+    // libXi, which is loaded at run time.
+    void* pXiSO;
+
+    // A pipe that's written to when the input thread needs to exit, to wake it up.
+    int wakePipe[2];
+
+    dr_thread thread;
+};
+
+// Pushes a raw XInput 2 event onto the queue.
+static void drge_handle_raw_input_event_x11(drge_raw_input* pRawInput, const drge_XIRawEvent* pXIEvent, long long ticks)
+{
+    assert(pRawInput != NULL);
+    assert(pXIEvent != NULL);
+
+    if (drge_atomic_load_64(&g_X11HasFocus) == 0) {
+        return;
+    }
+
+    drge_raw_input_event e;
+    memset(&e, 0, sizeof(e));
+    e.ticks = ticks;
+
+    switch (pXIEvent->evtype)
+    {
+        case XI_RawMotion:
+        {
+            // The raw values are packed, with one for each valuator that's set in the mask. The first two valuators are
+            // the X and Y axes of a mouse.
+            const double* pValue = pXIEvent->raw_values;
+            for (int iValuator = 0; iValuator < 2 && iValuator < pXIEvent->valuators.mask_len*8; ++iValuator) {
+                if (XIMaskIsSet(pXIEvent->valuators.mask, iValuator)) {
+                    if (iValuator == 0) {
+                        e.deltaX = (float)*pValue;
+                    } else {
+                        e.deltaY = (float)*pValue;
+                    }
+                    pValue += 1;
+                }
+            }
+
+            if (e.deltaX == 0 && e.deltaY == 0) {
+                return; // Only other axes moved, such as smooth scrolling.
+            }
+
+            e.type = DRGE_RAW_INPUT_MOTION;
+        } break;
+
+        case XI_RawButtonPress:
+        case XI_RawButtonRelease:
+        {
+            e.type   = (pXIEvent->evtype == XI_RawButtonPress) ? DRGE_RAW_INPUT_BUTTON_DOWN : DRGE_RAW_INPUT_BUTTON_UP;
+            e.button = (unsigned int)pXIEvent->detail;
+        } break;
+
+        default: return;
+    }
+
+    drge_push_raw_input(pRawInput->pQueue, &e);
+}
+
+static int drge_raw_input_thread_proc(void* pUserData)
+{
+    drge_raw_input* pRawInput = pUserData;
+    assert(pRawInput != NULL);
+
+    drge_profile_set_thread_name("Input");
+    drge_register_current_thread(DRGE_THREAD_ROLE_INPUT, "Input");
+
+    struct pollfd pfds[2];
+    pfds[0].fd     = ConnectionNumber(pRawInput->pDisplay);
+    pfds[0].events = POLLIN;
+    pfds[1].fd     = pRawInput->wakePipe[0];
+    pfds[1].events = POLLIN;
+
+    for (;;)
+    {
+        // Events are timestamped as soon as they're read off the connection. The server's timestamps are only
+        // milliseconds, and are on a different clock.
+        while (XPending(pRawInput->pDisplay) > 0)
+        {
+            XEvent e;
+            XNextEvent(pRawInput->pDisplay, &e);
+            long long ticks = drge_get_ticks();
+
+            if (e.xcookie.type == GenericEvent && e.xcookie.extension == pRawInput->xiOpcode && XGetEventData(pRawInput->pDisplay, &e.xcookie)) {
+                drge_handle_raw_input_event_x11(pRawInput, (const drge_XIRawEvent*)e.xcookie.data, ticks);
+                XFreeEventData(pRawInput->pDisplay, &e.xcookie);
+            }
+        }
+
+        pfds[0].revents = 0;
+        pfds[1].revents = 0;
+        if (poll(pfds, 2, -1) < 0 && errno != EINTR) {
+            break;
+        }
+
+        if (pfds[1].revents != 0) {
+            break;  // drge_stop_raw_input() was called.
+        }
+    }
+
+    drge_unregister_current_thread();
+    return 0;
+}
+
+drge_raw_input* drge_start_raw_input(drge_raw_input_queue* pQueue)
+{
+    if (pQueue == NULL) {
+        return NULL;
+    }
+
+    drge_raw_input* pRawInput = DRGE_MALLOC(sizeof(*pRawInput), DRGE_MEMORY_TAG_GENERAL);
+    if (pRawInput == NULL) {
+        return NULL;
+    }
+
+    memset(pRawInput, 0, sizeof(*pRawInput));
+    pRawInput->pQueue      = pQueue;
+    pRawInput->wakePipe[0] = -1;
+    pRawInput->wakePipe[1] = -1;
+
+    pRawInput->pXiSO = dlopen("libXi.so.6", RTLD_LAZY | RTLD_LOCAL);
+    if (pRawInput->pXiSO == NULL) {
+        goto on_error;
+    }
+
+    drge_XIQueryVersion_proc pXIQueryVersion = (drge_XIQueryVersion_proc)dlsym(pRawInput->pXiSO, "XIQueryVersion");
+    drge_XISelectEvents_proc pXISelectEvents = (drge_XISelectEvents_proc)dlsym(pRawInput->pXiSO, "XISelectEvents");
+    if (pXIQueryVersion == NULL || pXISelectEvents == NULL) {
+        goto on_error;
+    }
+
+    // This does nothing if drge_init_window_system() has already done it, but headless mode doesn't call that.
+    XInitThreads();
+
+    pRawInput->pDisplay = XOpenDisplay(NULL);
+    if (pRawInput->pDisplay == NULL) {
+        goto on_error;
+    }
+
+    int firstEvent;
+    int firstError;
+    if (!XQueryExtension(pRawInput->pDisplay, "XInputExtension", &pRawInput->xiOpcode, &firstEvent, &firstError)) {
+        goto on_error;
+    }
+
+    // Raw events were added in XInput 2.0, but before 2.1 they stop being delivered while another client has the
+    // pointer grabbed, like while a menu is open. The server replies with the version it supports, which is used even
+    // if it's 2.0.
+    int majorVersion = 2;
+    int minorVersion = 1;
+    if (pXIQueryVersion(pRawInput->pDisplay, &majorVersion, &minorVersion) != Success) {
+        goto on_error;
+    }
+
+    // Raw events can only be selected on the root window, and are delivered no matter which window has focus.
+    unsigned char mask[XIMaskLen(XI_RawMotion)];
+    memset(mask, 0, sizeof(mask));
+    XISetMask(mask, XI_RawMotion);
+    XISetMask(mask, XI_RawButtonPress);
+    XISetMask(mask, XI_RawButtonRelease);
+
+    drge_XIEventMask eventMask;
+    eventMask.deviceid = XIAllMasterDevices;
+    eventMask.mask_len = sizeof(mask);
+    eventMask.mask     = mask;
+    pXISelectEvents(pRawInput->pDisplay, DefaultRootWindow(pRawInput->pDisplay), &eventMask, 1);
+    XFlush(pRawInput->pDisplay);
+
+    if (pipe(pRawInput->wakePipe) != 0) {
+        goto on_error;
+    }
+
+    pRawInput->thread = dr_create_thread(drge_raw_input_thread_proc, pRawInput);
+    if (pRawInput->thread == NULL) {
+        goto on_error;
+    }
+
+    return pRawInput;
+
+
+on_error:
+    if (pRawInput->wakePipe[0] != -1) {
+        close(pRawInput->wakePipe[0]);
+        close(pRawInput->wakePipe[1]);
+    }
+
+    if (pRawInput->pDisplay != NULL) {
+        XCloseDisplay(pRawInput->pDisplay);
+    }
+
+    if (pRawInput->pXiSO != NULL) {
+        dlclose(pRawInput->pXiSO);
+    }
+
+    DRGE_FREE(pRawInput);
+    return NULL;
+}
+
+void drge_stop_raw_input(drge_raw_input* pRawInput)
+{
+    if (pRawInput == NULL) {
+        return;
+    }
+
+    char wake = 1;
+    while (write(pRawInput->wakePipe[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+
+    dr_wait_and_delete_thread(pRawInput->thread);
+
+    close(pRawInput->wakePipe[0]);
+    close(pRawInput->wakePipe[1]);
+    XCloseDisplay(pRawInput->pDisplay);
+    dlclose(pRawInput->pXiSO);
+    DRGE_FREE(pRawInput);
+}
+
+
+
+// CLOCK_MONOTONIC_RAW is not subject to NTP slewing which would otherwise make frame times drift from real time while
+// the clock is being adjusted. The timer and drge_get_ticks() must use the same clock because their times are compared
+// with each other, such as when deciding which step raw input belongs to.
+#ifdef CLOCK_MONOTONIC_RAW
+#define DRGE_TIMER_CLOCK    CLOCK_MONOTONIC_RAW
+#else
+#define DRGE_TIMER_CLOCK    CLOCK_MONOTONIC
+#endif
+
+struct drge_timer
+{
+    /// The time at the point in time the timer was last ticked.
+    struct timespec counter;
 };
 
 drge_timer* drge_create_timer()
 {
-    drge_timer* pTimer = malloc(sizeof(*pTimer));
+    drge_timer* pTimer = DRGE_MALLOC(sizeof(*pTimer), DRGE_MEMORY_TAG_GENERAL);
     if (pTimer == NULL) {
         return NULL;
     }
 
-    pTimer->unused = 0;
+    if (clock_gettime(DRGE_TIMER_CLOCK, &pTimer->counter) != 0) {
+        DRGE_FREE(pTimer);
+        return NULL;
+    }
 
     return pTimer;
 }
 
 void drge_delete_timer(drge_timer* pTimer)
 {
-    free(pTimer);
+    DRGE_FREE(pTimer);
 }
 
 double drge_tick_timer(drge_timer* pTimer)
@@ -423,12 +1404,421 @@ double drge_tick_timer(drge_timer* pTimer)
         return 0;
     }
 
-    return 0;
+    struct timespec oldCounter = pTimer->counter;
+    if (clock_gettime(DRGE_TIMER_CLOCK, &pTimer->counter) != 0) {
+        return 0;
+    }
+
+    return (pTimer->counter.tv_sec - oldCounter.tv_sec) + (pTimer->counter.tv_nsec - oldCounter.tv_nsec) / 1000000000.0;
+}
+
+
+long long drge_get_ticks()
+{
+    struct timespec ts;
+    clock_gettime(DRGE_TIMER_CLOCK, &ts);
+
+    return (long long)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+long long drge_get_tick_frequency()
+{
+    return 1000000000LL;    // drge_get_ticks() returns nanoseconds.
+}
+
+
+unsigned int drge_get_cpu_count()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (unsigned int)count : 1;
+}
+
+void drge_yield_thread()
+{
+    sched_yield();
+}
+
+
+// Linux lets any thread change the settings of another through it's thread ID. The raw system calls are used for
+// affinity because the pthread versions need _GNU_SOURCE.
+typedef pid_t drge_os_thread;
+
+static bool drge_get_current_os_thread(drge_os_thread* pThreadOut)
+{
+    assert(pThreadOut != NULL);
+
+    *pThreadOut = (pid_t)syscall(SYS_gettid);
+    return true;
+}
+
+static void drge_release_os_thread(drge_os_thread thread)
+{
+    (void)thread;
+}
+
+static unsigned long long drge_get_os_thread_affinity_mask(drge_os_thread thread)
+{
+    unsigned long long mask = 0;
+    if (syscall(SYS_sched_getaffinity, thread, sizeof(mask), &mask) < 0) {
+        return 0;   // More than 64 processors.
+    }
+
+    return mask;
+}
+
+static bool drge_set_os_thread_affinity_mask(drge_os_thread thread, unsigned long long affinityMask)
+{
+    return syscall(SYS_sched_setaffinity, thread, sizeof(affinityMask), &affinityMask) == 0;
+}
+
+// The priority of a thread as the OS sees it. The nice value only means something for the policies that aren't realtime.
+typedef struct
+{
+    int policy;
+    int schedPriority;
+    int nice;
+} drge_os_thread_priority;
+
+static bool drge_is_realtime_sched_policy(int policy)
+{
+    return policy == SCHED_FIFO || policy == SCHED_RR;
+}
+
+static void drge_to_os_thread_priority(int priority, drge_os_thread_priority* pPriorityOut)
+{
+    assert(pPriorityOut != NULL);
+
+    if (priority == DRGE_THREAD_PRIORITY_REALTIME) {
+        // Low enough to fit within the limits that rtkit and most distros hand out to regular users.
+        pPriorityOut->policy        = SCHED_FIFO;
+        pPriorityOut->schedPriority = 10;
+        pPriorityOut->nice          = 0;
+    } else {
+        // Each step is 5 nice levels.
+        pPriorityOut->policy        = SCHED_OTHER;
+        pPriorityOut->schedPriority = 0;
+        pPriorityOut->nice          = -priority*5;
+    }
+}
+
+static bool drge_get_os_thread_priority(drge_os_thread thread, drge_os_thread_priority* pPriorityOut)
+{
+    assert(pPriorityOut != NULL);
+
+    struct sched_param param;
+    int policy = sched_getscheduler(thread);
+    if (policy < 0 || sched_getparam(thread, &param) != 0) {
+        return false;
+    }
+
+    // -1 is a valid nice value so errno is the only way to tell if this failed.
+    errno = 0;
+    int nice = getpriority(PRIO_PROCESS, (id_t)thread);
+    if (nice == -1 && errno != 0) {
+        return false;
+    }
+
+    pPriorityOut->policy        = policy;
+    pPriorityOut->schedPriority = param.sched_priority;
+    pPriorityOut->nice          = nice;
+    return true;
+}
+
+static bool drge_set_os_thread_priority(drge_os_thread thread, const drge_os_thread_priority* pPriority)
+{
+    assert(pPriority != NULL);
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = pPriority->schedPriority;
+
+    if (sched_setscheduler(thread, pPriority->policy, &param) != 0) {
+        return false;
+    }
+
+    // For a thread ID this only changes the one thread rather than the whole process.
+    if (!drge_is_realtime_sched_policy(pPriority->policy) && setpriority(PRIO_PROCESS, (id_t)thread, pPriority->nice) != 0) {
+        return false;
+    }
+
+    return true;
+}
+
+static bool drge_are_os_thread_priorities_equal(const drge_os_thread_priority* pA, const drge_os_thread_priority* pB)
+{
+    if (pA->policy != pB->policy || pA->schedPriority != pB->schedPriority) {
+        return false;
+    }
+
+    return drge_is_realtime_sched_policy(pA->policy) || pA->nice == pB->nice;
+}
+
+void drge_set_current_thread_name(const char* name)
+{
+    if (name == NULL) {
+        return;
+    }
+
+    prctl(PR_SET_NAME, name, 0, 0, 0);  // Truncated to 15 characters.
 }
 #endif
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Thread Registry
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define DRGE_MAX_REGISTERED_THREADS     (DRGE_MAX_JOB_WORKERS + 16)
+
+typedef struct
+{
+    // Whether or not this slot is in use.
+    bool isUsed;
+
+    // The DRGE_THREAD_ROLE_* the thread registered with.
+    int role;
+
+    // The position of the thread among the threads with the same role, for pinOneProcessorPerThread. This is the lowest
+    // index not used by another thread with the role so that a thread that's restarted gets it's old processor back.
+    unsigned int roleIndex;
+
+    drge_os_thread osThread;
+} drge_registered_thread;
+
+static const char* g_drgeThreadRoleNames[DRGE_THREAD_ROLE_COUNT] = {
+    "Main",
+    "Render",
+    "JobWorker",
+    "Log",
+    "Audio",
+    "Input"
+};
+
+// The registry is only touched when threads start and stop and when settings change, so a simple spin lock is fine.
+static volatile long long g_drgeThreadRegistryLock = 0;
+static drge_registered_thread g_drgeRegisteredThreads[DRGE_MAX_REGISTERED_THREADS];
+static drge_thread_config g_drgeThreadConfigs[DRGE_THREAD_ROLE_COUNT];
+
+// The affinity and priority threads are put back to when their role doesn't set one but they're different anyway. These
+// are what the first thread to register started with, which is normally the main thread before anything changes it.
+// They're needed because new threads inherit the affinity and priority of the thread that created them on Linux, which
+// may have been pinned or raised.
+static unsigned long long g_drgeDefaultAffinityMask = 0;
+static drge_os_thread_priority g_drgeDefaultPriority;
+static bool g_drgeHasDefaultPriority = false;
+static bool g_drgeHasThreadDefaults = false;
+
+// The registry slot of the calling thread, plus one so that 0 means it's not registered.
+static DRGE_THREAD_LOCAL unsigned int g_drgeCurrentThreadSlot = 0;
+
+static void drge_lock_thread_registry()
+{
+    while (drge_atomic_exchange_64(&g_drgeThreadRegistryLock, 1) != 0) {
+        drge_yield_thread();
+    }
+}
+
+static void drge_unlock_thread_registry()
+{
+    drge_atomic_store_64(&g_drgeThreadRegistryLock, 0);
+}
+
+// Determines whether or not a registered thread has the given role and role index. The registry must be locked.
+static bool drge_is_thread_role_index_used(int role, unsigned int roleIndex)
+{
+    for (unsigned int iSlot = 0; iSlot < DRGE_MAX_REGISTERED_THREADS; ++iSlot) {
+        const drge_registered_thread* pThread = &g_drgeRegisteredThreads[iSlot];
+        if (pThread->isUsed && pThread->role == role && pThread->roleIndex == roleIndex) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Applies the settings of it's role to a registered thread. The registry must be locked.
+static bool drge_apply_registered_thread_config(drge_registered_thread* pThread)
+{
+    assert(pThread != NULL);
+
+    const drge_thread_config* pConfig = &g_drgeThreadConfigs[pThread->role];
+    bool result = true;
+
+    // The OS is only asked to change what the role sets, so a thread keeps whatever it was given from outside the
+    // engine, like with nice or taskset. The exception is when it inherited something else from the thread that
+    // created it, in which case it's put back to the default.
+    unsigned long long affinityMask = 0;   // 0 leaves it alone.
+    if (pConfig->isAffinityMaskSet) {
+        affinityMask = pConfig->affinityMask;
+        if (affinityMask == 0) {
+            affinityMask = g_drgeDefaultAffinityMask;
+        } else if (pConfig->pinOneProcessorPerThread) {
+            unsigned int processorCount = 0;
+            for (unsigned int iBit = 0; iBit < 64; ++iBit) {
+                if (affinityMask & (1ULL << iBit)) {
+                    processorCount += 1;
+                }
+            }
+
+            unsigned int n = pThread->roleIndex % processorCount;
+            for (unsigned int iBit = 0; iBit < 64; ++iBit) {
+                if (affinityMask & (1ULL << iBit)) {
+                    if (n == 0) {
+                        affinityMask = 1ULL << iBit;
+                        break;
+                    }
+                    n -= 1;
+                }
+            }
+        }
+    } else if (g_drgeDefaultAffinityMask != 0 && drge_get_os_thread_affinity_mask(pThread->osThread) != g_drgeDefaultAffinityMask) {
+        affinityMask = g_drgeDefaultAffinityMask;
+    }
+
+    if (affinityMask != 0 && !drge_set_os_thread_affinity_mask(pThread->osThread, affinityMask)) {
+        result = false;
+    }
+
+    drge_os_thread_priority priority;
+    if (pConfig->isPrioritySet) {
+        drge_to_os_thread_priority(pConfig->priority, &priority);
+        if (!drge_set_os_thread_priority(pThread->osThread, &priority)) {
+            result = false;
+        }
+    } else if (g_drgeHasDefaultPriority && drge_get_os_thread_priority(pThread->osThread, &priority) && !drge_are_os_thread_priorities_equal(&priority, &g_drgeDefaultPriority)) {
+        if (!drge_set_os_thread_priority(pThread->osThread, &g_drgeDefaultPriority)) {
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+bool drge_register_current_thread(int role, const char* name)
+{
+    if (role < 0 || role >= DRGE_THREAD_ROLE_COUNT) {
+        return false;
+    }
+
+    drge_set_current_thread_name(name);
+
+    drge_os_thread osThread;
+    if (g_drgeCurrentThreadSlot != 0 || !drge_get_current_os_thread(&osThread)) {
+        return false;
+    }
+
+    bool result = false;
+    drge_lock_thread_registry();
+    {
+        if (!g_drgeHasThreadDefaults) {
+            g_drgeDefaultAffinityMask = drge_get_os_thread_affinity_mask(osThread);
+            g_drgeHasDefaultPriority  = drge_get_os_thread_priority(osThread, &g_drgeDefaultPriority);
+            g_drgeHasThreadDefaults   = true;
+        }
+
+        unsigned int roleIndex = 0;
+        while (drge_is_thread_role_index_used(role, roleIndex)) {
+            roleIndex += 1;
+        }
+
+        for (unsigned int iSlot = 0; iSlot < DRGE_MAX_REGISTERED_THREADS; ++iSlot) {
+            drge_registered_thread* pThread = &g_drgeRegisteredThreads[iSlot];
+            if (!pThread->isUsed) {
+                pThread->isUsed    = true;
+                pThread->role      = role;
+                pThread->roleIndex = roleIndex;
+                pThread->osThread  = osThread;
+                g_drgeCurrentThreadSlot = iSlot + 1;
+
+                result = drge_apply_registered_thread_config(pThread);
+                break;
+            }
+        }
+    }
+    drge_unlock_thread_registry();
+
+    if (g_drgeCurrentThreadSlot == 0) {
+        drge_release_os_thread(osThread);   // Too many threads.
+    }
+
+    return result;
+}
+
+void drge_unregister_current_thread()
+{
+    if (g_drgeCurrentThreadSlot == 0) {
+        return;
+    }
+
+    drge_lock_thread_registry();
+    {
+        drge_registered_thread* pThread = &g_drgeRegisteredThreads[g_drgeCurrentThreadSlot - 1];
+        drge_release_os_thread(pThread->osThread);
+        pThread->isUsed = false;
+    }
+    drge_unlock_thread_registry();
+
+    g_drgeCurrentThreadSlot = 0;
+}
+
+bool drge_set_thread_config(int role, const drge_thread_config* pConfig)
+{
+    if (role < 0 || role >= DRGE_THREAD_ROLE_COUNT || pConfig == NULL) {
+        return false;
+    }
+
+    bool result = true;
+    drge_lock_thread_registry();
+    {
+        g_drgeThreadConfigs[role] = *pConfig;
+
+        for (unsigned int iSlot = 0; iSlot < DRGE_MAX_REGISTERED_THREADS; ++iSlot) {
+            drge_registered_thread* pThread = &g_drgeRegisteredThreads[iSlot];
+            if (pThread->isUsed && pThread->role == role) {
+                if (!drge_apply_registered_thread_config(pThread)) {
+                    result = false;
+                }
+            }
+        }
+    }
+    drge_unlock_thread_registry();
+
+    return result;
+}
+
+void drge_get_thread_config(int role, drge_thread_config* pConfigOut)
+{
+    if (pConfigOut == NULL) {
+        return;
+    }
+
+    memset(pConfigOut, 0, sizeof(*pConfigOut));
+
+    if (role < 0 || role >= DRGE_THREAD_ROLE_COUNT) {
+        return;
+    }
+
+    drge_lock_thread_registry();
+    {
+        *pConfigOut = g_drgeThreadConfigs[role];
+    }
+    drge_unlock_thread_registry();
+}
+
+const char* drge_get_thread_role_name(int role)
+{
+    if (role < 0 || role >= DRGE_THREAD_ROLE_COUNT) {
+        return NULL;
+    }
+
+    return g_drgeThreadRoleNames[role];
+}
+
+
+
 /*
 This is free and unencumbered software released into the public domain.
 
@@ -3,8 +3,14 @@
 typedef struct drge_window drge_window;
 
 // Options for creating windows.
+//
+// DRGE_WINDOW_FULLSCREEN makes the window cover the whole screen and asks the compositor to stop compositing it, so
+// frames go straight to the screen rather than through the compositor, which saves at least a frame of latency. Add
+// DRGE_WINDOW_BORDERLESS to ask the compositor to keep compositing it instead. That's quicker to switch away from and
+// plays nicer with overlays and notifications, but costs the latency. On Windows the two are the same.
 #define DRGE_WINDOW_CENTERED      (1 << 0)
 #define DRGE_WINDOW_FULLSCREEN    (1 << 1)
+#define DRGE_WINDOW_BORDERLESS    (1 << 2)
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -48,6 +54,31 @@ void* drge_get_window_hdc(drge_window* pWindow);
 /// Enters into the main application window.
 int drge_main_loop(drge_context* pGame);
 
+/// Makes Ctrl+C request the given context to close rather than killing the process, so it can shut down cleanly. On
+/// Linux this applies to SIGTERM as well. Used in headless mode where there's no window to close. Pass null to restore
+/// the default behaviour.
+void drge_close_on_interrupt(drge_context* pContext);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Raw Input
+//
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct drge_raw_input drge_raw_input;
+
+/// Starts reading raw mouse input on a thread of it's own, pushing each event onto the given queue as it arrives. Events
+/// are only pushed while the game window has focus. The queue must stay alive until drge_stop_raw_input() is called.
+///
+/// On Linux this uses XInput 2, which is loaded at run time, and on Windows it uses WM_INPUT. Returns null if raw input
+/// isn't available, such as on X servers without XInput 2.
+drge_raw_input* drge_start_raw_input(drge_raw_input_queue* pQueue);
+
+/// Stops reading raw input and waits for the input thread to exit.
+void drge_stop_raw_input(drge_raw_input* pRawInput);
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -65,4 +96,133 @@ drge_timer* drge_create_timer();
 void drge_delete_timer(drge_timer* pTimer);
 
 /// "Ticks" the timer, and returns the time since the last tick, in seconds.
-double drge_tick_timer(drge_timer* pTimer);
\ No newline at end of file
+double drge_tick_timer(drge_timer* pTimer);
+
+/// Retrieves the current value of the monotonic high resolution clock, in ticks. This is cheap and can be called from any thread.
+long long drge_get_ticks();
+
+/// Retrieves the number of ticks per second of the clock used by drge_get_ticks().
+long long drge_get_tick_frequency();
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Atomics
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// These map directly to compiler intrinsics. Loads have acquire semantics, stores have release semantics and the
+// read-modify-write operations and drge_atomic_fence() are full barriers. Compare-exchange returns the value that was in memory before the
+// operation, so it succeeded if that is equal to the expected value.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define drge_atomic_load_64(pDst)                                   _InterlockedCompareExchange64((volatile long long*)(pDst), 0, 0)
+#define drge_atomic_store_64(pDst, value)                           (void)_InterlockedExchange64((volatile long long*)(pDst), (value))
+#define drge_atomic_exchange_64(pDst, value)                        _InterlockedExchange64((volatile long long*)(pDst), (value))
+#define drge_atomic_fetch_add_64(pDst, value)                       _InterlockedExchangeAdd64((volatile long long*)(pDst), (value))
+#define drge_atomic_compare_exchange_64(pDst, expected, desired)    _InterlockedCompareExchange64((volatile long long*)(pDst), (desired), (expected))
+#define drge_atomic_load_ptr(ppDst)                                 _InterlockedCompareExchangePointer((void* volatile*)(ppDst), NULL, NULL)
+#define drge_atomic_store_ptr(ppDst, pValue)                        (void)_InterlockedExchangePointer((void* volatile*)(ppDst), (pValue))
+#define drge_atomic_exchange_ptr(ppDst, pValue)                     _InterlockedExchangePointer((void* volatile*)(ppDst), (pValue))
+#define drge_atomic_compare_exchange_ptr(ppDst, pExpected, pDesired) _InterlockedCompareExchangePointer((void* volatile*)(ppDst), (pDesired), (pExpected))
+#define drge_atomic_fence()                                         MemoryBarrier()
+#else
+#define drge_atomic_load_64(pDst)                                   __atomic_load_n((pDst), __ATOMIC_ACQUIRE)
+#define drge_atomic_store_64(pDst, value)                           __atomic_store_n((pDst), (value), __ATOMIC_RELEASE)
+#define drge_atomic_exchange_64(pDst, value)                        __atomic_exchange_n((pDst), (value), __ATOMIC_ACQ_REL)
+#define drge_atomic_fetch_add_64(pDst, value)                       __atomic_fetch_add((pDst), (value), __ATOMIC_ACQ_REL)
+#define drge_atomic_compare_exchange_64(pDst, expected, desired)    __sync_val_compare_and_swap((pDst), (expected), (desired))
+#define drge_atomic_load_ptr(ppDst)                                 __atomic_load_n((ppDst), __ATOMIC_ACQUIRE)
+#define drge_atomic_store_ptr(ppDst, pValue)                        __atomic_store_n((ppDst), (pValue), __ATOMIC_RELEASE)
+#define drge_atomic_exchange_ptr(ppDst, pValue)                     __atomic_exchange_n((ppDst), (pValue), __ATOMIC_ACQ_REL)
+#define drge_atomic_compare_exchange_ptr(ppDst, pExpected, pDesired) __sync_val_compare_and_swap((ppDst), (pExpected), (pDesired))
+#define drge_atomic_fence()                                         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Declares a variable with one instance per thread. Only use this for variables with static storage duration.
+#if defined(_MSC_VER)
+#define DRGE_THREAD_LOCAL   __declspec(thread)
+#else
+#define DRGE_THREAD_LOCAL   __thread
+#endif
+
+/// Retrieves the number of logical processors available to the process. Always returns at least 1.
+unsigned int drge_get_cpu_count();
+
+/// Gives up the rest of the calling thread's time slice to any other thread that is ready to run.
+void drge_yield_thread();
+
+
+// Thread roles. Every thread the engine starts registers itself with one of these, and the settings for a role are
+// applied to every thread that has it. DRGE_THREAD_ROLE_AUDIO is for the game's audio thread, if it has one.
+#define DRGE_THREAD_ROLE_MAIN       0
+#define DRGE_THREAD_ROLE_RENDER     1
+#define DRGE_THREAD_ROLE_JOB_WORKER 2
+#define DRGE_THREAD_ROLE_LOG        3
+#define DRGE_THREAD_ROLE_AUDIO      4
+#define DRGE_THREAD_ROLE_INPUT      5
+#define DRGE_THREAD_ROLE_COUNT      6
+
+// Thread priorities. On Linux everything other than DRGE_THREAD_PRIORITY_REALTIME is a nice value and realtime is
+// SCHED_FIFO. Raising a thread above normal usually needs CAP_SYS_NICE, or RLIMIT_NICE and RLIMIT_RTPRIO limits that
+// allow it.
+#define DRGE_THREAD_PRIORITY_LOWEST     -2
+#define DRGE_THREAD_PRIORITY_LOW        -1
+#define DRGE_THREAD_PRIORITY_NORMAL     0
+#define DRGE_THREAD_PRIORITY_HIGH       1
+#define DRGE_THREAD_PRIORITY_HIGHEST    2
+#define DRGE_THREAD_PRIORITY_REALTIME   3
+
+typedef struct
+{
+    /// Whether or not affinityMask and priority have been set. The OS settings of a thread are only changed for the ones
+    /// that have been, so that threads keep what they were given from outside the engine otherwise. Threads that
+    /// inherited something different from the thread that created them are still put back to the defaults.
+    bool isAffinityMaskSet;
+    bool isPrioritySet;
+
+    /// The logical processors the threads are allowed to run on, one bit each. Only the first 64 processors can be
+    /// chosen. Set this to 0 to let them run on any processor.
+    unsigned long long affinityMask;
+
+    /// When set, each thread is pinned to a single processor of affinityMask, going through them in turn as threads
+    /// register. This is for the job workers, so each one stays on it's own core.
+    bool pinOneProcessorPerThread;
+
+    /// One of DRGE_THREAD_PRIORITY_*.
+    int priority;
+} drge_thread_config;
+
+/// Sets the name of the calling thread as seen by debuggers, perf and the like. Linux truncates names to 15 characters.
+void drge_set_current_thread_name(const char* name);
+
+/// Registers the calling thread as having the given role, names it, and applies the settings of the role to it. A
+/// thread that registers must unregister before it exits. Pass null for the name to leave the name alone.
+///
+/// Returns false if the settings could not be applied, or if too many threads are registered.
+bool drge_register_current_thread(int role, const char* name);
+
+/// Unregisters the calling thread.
+void drge_unregister_current_thread();
+
+/// Changes the settings of a role. These are applied straight away to every thread that's registered with the role, and
+/// to threads that register later.
+///
+/// Returns false if the settings could not be applied to one of the threads, which is usually because raising the
+/// priority is not allowed. The settings are kept either way.
+bool drge_set_thread_config(int role, const drge_thread_config* pConfig);
+
+/// Retrieves the settings of a role.
+void drge_get_thread_config(int role, drge_thread_config* pConfigOut);
+
+/// Retrieves the name of a role, for display and the config file. Returns null if the role is invalid.
+const char* drge_get_thread_role_name(int role);
@@ -0,0 +1,471 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The maximum depth of nested scopes that are recorded. Scopes nested deeper than this are ignored.
+#define DRGE_PROFILER_MAX_DEPTH     64
+
+// The track GPU scopes are shown on. Threads are numbered from 1.
+#define DRGE_PROFILER_GPU_TRACK     0
+
+#define DRGE_PROFILE_EVENT_BEGIN    0
+#define DRGE_PROFILE_EVENT_END      1
+#define DRGE_PROFILE_EVENT_GPU      2
+
+typedef struct
+{
+    // The time of the event, from drge_get_ticks(). For GPU events this is the time the scope began.
+    long long ticks;
+
+    // The length of a GPU scope. Unused for other events.
+    long long durationTicks;
+
+    // The name of the scope. Null for end events.
+    const char* name;
+
+    // The type of event, DRGE_PROFILE_EVENT_*.
+    unsigned int type;
+} drge_profile_event;
+
+typedef struct
+{
+    long long beginTicks;
+    long long endTicks;
+    const char* name;
+
+    // Set to 1 once the scope has been written. Until then it's slot has been claimed but must not be read.
+    volatile long long isReady;
+} drge_profile_early_gpu_scope;
+
+typedef struct drge_profiler_thread drge_profiler_thread;
+struct drge_profiler_thread
+{
+    // The next thread in the list of every thread that has recorded something.
+    drge_profiler_thread* pNext;
+
+    // The track the thread's events are shown on.
+    unsigned int trackID;
+
+    // The name of the track. Can be null.
+    const char* volatile pName;
+
+    // The trace the events in the buffer belong to. The thread clears it's buffer when it records the first event of a
+    // new trace, so a trace never has to touch another thread's buffer while it might be recording.
+    volatile long long session;
+
+    // The number of events in the buffer. Only ever written by the thread that owns the buffer.
+    volatile long long eventCount;
+
+    // The number of events that didn't fit in the buffer.
+    volatile long long droppedEventCount;
+
+    drge_profile_event events[DRGE_PROFILER_MAX_EVENTS_PER_THREAD];
+};
+
+static struct
+{
+    // Set to 1 while a trace is being recorded.
+    volatile long long isTracing;
+
+    // Incremented for each trace.
+    volatile long long session;
+
+    // The time the current trace started. Timestamps in the trace are relative to this.
+    volatile long long startTicks;
+
+    // Every thread that has recorded something. Threads are only ever added to the front, and are never removed until
+    // drge_uninit_profiler() is called.
+    drge_profiler_thread* volatile pFirstThread;
+
+    // The number of tracks that have been handed out to threads.
+    volatile long long trackCount;
+
+    // The GPU scopes recorded before the first trace started. Slots are claimed by incrementing the count, which can go
+    // past the end of the array when there are too many.
+    drge_profile_early_gpu_scope earlyGPUScopes[DRGE_PROFILER_MAX_EARLY_GPU_SCOPES];
+    volatile long long earlyGPUScopeCount;
+} g_drgeProfiler;
+
+// The calling thread's buffer. This is created when the thread first records something.
+static DRGE_THREAD_LOCAL drge_profiler_thread* g_drgeProfilerThread = NULL;
+
+// The name set with drge_profile_set_thread_name(), for when the buffer doesn't exist yet.
+static DRGE_THREAD_LOCAL const char* g_drgeProfilerThreadName = NULL;
+
+// The number of scopes that are open on the calling thread, whether or not they're being recorded.
+static DRGE_THREAD_LOCAL unsigned int g_drgeProfilerDepth = 0;
+
+// A bit for each depth at which the open scope was recorded, and so needs an end event.
+static DRGE_THREAD_LOCAL unsigned long long g_drgeProfilerRecordedScopes = 0;
+
+
+// Retrieves the calling thread's buffer, creating it if necessary, and clears it if it still holds an older trace.
+static drge_profiler_thread* drge_profiler_get_thread()
+{
+    drge_profiler_thread* pThread = g_drgeProfilerThread;
+    if (pThread == NULL)
+    {
+        pThread = DRGE_MALLOC(sizeof(*pThread), DRGE_MEMORY_TAG_GENERAL);
+        if (pThread == NULL) {
+            return NULL;
+        }
+
+        pThread->trackID           = (unsigned int)drge_atomic_fetch_add_64(&g_drgeProfiler.trackCount, 1) + 1;
+        pThread->pName             = g_drgeProfilerThreadName;
+        pThread->session           = -1;
+        pThread->eventCount        = 0;
+        pThread->droppedEventCount = 0;
+
+        drge_profiler_thread* pFirstThread;
+        do
+        {
+            pFirstThread = drge_atomic_load_ptr(&g_drgeProfiler.pFirstThread);
+            pThread->pNext = pFirstThread;
+        } while (drge_atomic_compare_exchange_ptr(&g_drgeProfiler.pFirstThread, pFirstThread, pThread) != pFirstThread);
+
+        g_drgeProfilerThread = pThread;
+    }
+
+    long long session = drge_atomic_load_64(&g_drgeProfiler.session);
+    if (pThread->session != session)
+    {
+        drge_atomic_store_64(&pThread->eventCount, 0);
+        drge_atomic_store_64(&pThread->droppedEventCount, 0);
+        drge_atomic_store_64(&pThread->session, session);
+
+        // Scopes that were opened during the previous trace would end up as unmatched end events.
+        g_drgeProfilerRecordedScopes = 0;
+    }
+
+    return pThread;
+}
+
+static void drge_profiler_push_event(drge_profiler_thread* pThread, unsigned int type, const char* name, long long ticks, long long durationTicks)
+{
+    assert(pThread != NULL);
+
+    long long eventCount = pThread->eventCount;
+    if (eventCount == DRGE_PROFILER_MAX_EVENTS_PER_THREAD) {
+        drge_atomic_store_64(&pThread->droppedEventCount, pThread->droppedEventCount + 1);
+        return;
+    }
+
+    drge_profile_event* pEvent = &pThread->events[eventCount];
+    pEvent->ticks         = ticks;
+    pEvent->durationTicks = durationTicks;
+    pEvent->name          = name;
+    pEvent->type          = type;
+
+    // Publishes the event to drge_write_trace().
+    drge_atomic_store_64(&pThread->eventCount, eventCount + 1);
+}
+
+
+void drge_profile_begin(const char* name)
+{
+    unsigned int depth = g_drgeProfilerDepth++;
+    if (drge_atomic_load_64(&g_drgeProfiler.isTracing) == 0 || depth >= DRGE_PROFILER_MAX_DEPTH) {
+        return;
+    }
+
+    drge_profiler_thread* pThread = drge_profiler_get_thread();
+    if (pThread == NULL) {
+        return;
+    }
+
+    drge_profiler_push_event(pThread, DRGE_PROFILE_EVENT_BEGIN, name, drge_get_ticks(), 0);
+    g_drgeProfilerRecordedScopes |= (1ULL << depth);
+}
+
+void drge_profile_end()
+{
+    if (g_drgeProfilerDepth == 0) {
+        return;     // Unbalanced.
+    }
+
+    unsigned int depth = --g_drgeProfilerDepth;
+    if (depth >= DRGE_PROFILER_MAX_DEPTH) {
+        return;
+    }
+
+    // The end is recorded even if the trace has stopped since the scope began so that every begin event has an end.
+    unsigned long long depthBit = 1ULL << depth;
+    if ((g_drgeProfilerRecordedScopes & depthBit) == 0) {
+        return;
+    }
+
+    g_drgeProfilerRecordedScopes &= ~depthBit;
+
+    drge_profiler_thread* pThread = g_drgeProfilerThread;
+    assert(pThread != NULL);
+
+    if (pThread->session != drge_atomic_load_64(&g_drgeProfiler.session)) {
+        return;     // A new trace has started since the scope began.
+    }
+
+    drge_profiler_push_event(pThread, DRGE_PROFILE_EVENT_END, NULL, drge_get_ticks(), 0);
+}
+
+void drge_profile_gpu_scope(const char* name, long long beginTicks, long long endTicks)
+{
+    if (drge_atomic_load_64(&g_drgeProfiler.isTracing) == 0)
+    {
+        if (drge_atomic_load_64(&g_drgeProfiler.session) == 0) {
+            long long iScope = drge_atomic_fetch_add_64(&g_drgeProfiler.earlyGPUScopeCount, 1);
+            if (iScope < DRGE_PROFILER_MAX_EARLY_GPU_SCOPES) {
+                drge_profile_early_gpu_scope* pScope = &g_drgeProfiler.earlyGPUScopes[iScope];
+                pScope->beginTicks = beginTicks;
+                pScope->endTicks   = endTicks;
+                pScope->name       = name;
+                drge_atomic_store_64(&pScope->isReady, 1);
+            }
+        }
+
+        return;
+    }
+
+    drge_profiler_thread* pThread = drge_profiler_get_thread();
+    if (pThread == NULL) {
+        return;
+    }
+
+    drge_profiler_push_event(pThread, DRGE_PROFILE_EVENT_GPU, name, beginTicks, endTicks - beginTicks);
+}
+
+void drge_profile_set_thread_name(const char* name)
+{
+    g_drgeProfilerThreadName = name;
+
+    if (g_drgeProfilerThread != NULL) {
+        drge_atomic_store_ptr(&g_drgeProfilerThread->pName, name);
+    }
+}
+
+
+void drge_begin_trace()
+{
+    drge_atomic_store_64(&g_drgeProfiler.startTicks, drge_get_ticks());
+    drge_atomic_fetch_add_64(&g_drgeProfiler.session, 1);
+    drge_atomic_store_64(&g_drgeProfiler.isTracing, 1);
+}
+
+void drge_end_trace()
+{
+    drge_atomic_store_64(&g_drgeProfiler.isTracing, 0);
+}
+
+bool drge_is_tracing()
+{
+    return drge_atomic_load_64(&g_drgeProfiler.isTracing) != 0;
+}
+
+
+typedef struct
+{
+    drfs_file* pFile;
+    char buffer[4096];
+    size_t bufferSize;
+    bool hasError;
+} drge_trace_writer;
+
+static void drge_trace_writer_flush(drge_trace_writer* pWriter)
+{
+    assert(pWriter != NULL);
+
+    if (pWriter->bufferSize > 0) {
+        if (drfs_write(pWriter->pFile, pWriter->buffer, pWriter->bufferSize, NULL) != drfs_success) {
+            pWriter->hasError = true;
+        }
+
+        pWriter->bufferSize = 0;
+    }
+}
+
+static void drge_trace_writef(drge_trace_writer* pWriter, const char* format, ...)
+{
+    assert(pWriter != NULL);
+
+    char text[256];
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (length < 0) {
+        return;
+    }
+
+    if ((size_t)length >= sizeof(text)) {
+        length = sizeof(text) - 1;
+    }
+
+    if (pWriter->bufferSize + length > sizeof(pWriter->buffer)) {
+        drge_trace_writer_flush(pWriter);
+    }
+
+    memcpy(pWriter->buffer + pWriter->bufferSize, text, length);
+    pWriter->bufferSize += length;
+}
+
+// Writes a string as a JSON string literal, including the quotes.
+static void drge_trace_write_string(drge_trace_writer* pWriter, const char* str)
+{
+    assert(pWriter != NULL);
+    assert(str != NULL);
+
+    drge_trace_writef(pWriter, "\"");
+
+    for (const char* pRun = str; *str != '\0'; pRun = str)
+    {
+        while (*str != '\0' && *str != '"' && *str != '\\' && (unsigned char)*str >= 0x20) {
+            str += 1;
+        }
+
+        if (str > pRun) {
+            drge_trace_writef(pWriter, "%.*s", (int)(str - pRun), pRun);
+        }
+
+        if (*str != '\0') {
+            drge_trace_writef(pWriter, "\\u%04x", (unsigned char)*str);
+            str += 1;
+        }
+    }
+
+    drge_trace_writef(pWriter, "\"");
+}
+
+static void drge_trace_write_thread_name(drge_trace_writer* pWriter, unsigned int trackID, const char* name)
+{
+    assert(pWriter != NULL);
+    assert(name != NULL);
+
+    drge_trace_writef(pWriter, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", trackID);
+    drge_trace_write_string(pWriter, name);
+    drge_trace_writef(pWriter, "}},\n");
+}
+
+bool drge_write_trace(drfs_file* pFile, drge_trace_stats* pStatsOut)
+{
+    if (pStatsOut != NULL) {
+        memset(pStatsOut, 0, sizeof(*pStatsOut));
+    }
+
+    if (pFile == NULL) {
+        return false;
+    }
+
+    drge_trace_writer writer;
+    writer.pFile      = pFile;
+    writer.bufferSize = 0;
+    writer.hasError   = false;
+
+    long long session = drge_atomic_load_64(&g_drgeProfiler.session);
+    long long startTicks = drge_atomic_load_64(&g_drgeProfiler.startTicks);
+    double microsecondsPerTick = 1000000.0 / drge_get_tick_frequency();
+    unsigned long long droppedEventCount = 0;
+    unsigned long long gpuScopeCount = 0;
+
+    // The GPU scopes from before the first trace are part of it. The trace is extended back to the earliest one so that
+    // no timestamps are negative.
+    long long earlyGPUScopeCount = 0;
+    if (session == 1) {
+        earlyGPUScopeCount = drge_atomic_load_64(&g_drgeProfiler.earlyGPUScopeCount);
+        if (earlyGPUScopeCount > DRGE_PROFILER_MAX_EARLY_GPU_SCOPES) {
+            earlyGPUScopeCount = DRGE_PROFILER_MAX_EARLY_GPU_SCOPES;
+        }
+
+        for (long long iScope = 0; iScope < earlyGPUScopeCount; ++iScope) {
+            const drge_profile_early_gpu_scope* pScope = &g_drgeProfiler.earlyGPUScopes[iScope];
+            if (drge_atomic_load_64(&pScope->isReady) && pScope->beginTicks < startTicks) {
+                startTicks = pScope->beginTicks;
+            }
+        }
+    }
+
+    drge_trace_writef(&writer, "{\"traceEvents\":[\n");
+    drge_trace_write_thread_name(&writer, DRGE_PROFILER_GPU_TRACK, "GPU");
+
+    for (long long iScope = 0; iScope < earlyGPUScopeCount; ++iScope)
+    {
+        const drge_profile_early_gpu_scope* pScope = &g_drgeProfiler.earlyGPUScopes[iScope];
+        if (drge_atomic_load_64(&pScope->isReady))
+        {
+            drge_trace_writef(&writer, "{\"name\":");
+            drge_trace_write_string(&writer, pScope->name);
+            drge_trace_writef(&writer, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u},\n", (pScope->beginTicks - startTicks) * microsecondsPerTick, (pScope->endTicks - pScope->beginTicks) * microsecondsPerTick, DRGE_PROFILER_GPU_TRACK);
+            gpuScopeCount += 1;
+        }
+    }
+
+    for (drge_profiler_thread* pThread = drge_atomic_load_ptr(&g_drgeProfiler.pFirstThread); pThread != NULL; pThread = pThread->pNext)
+    {
+        if (drge_atomic_load_64(&pThread->session) != session) {
+            continue;
+        }
+
+        const char* pName = drge_atomic_load_ptr(&pThread->pName);
+        if (pName != NULL) {
+            drge_trace_write_thread_name(&writer, pThread->trackID, pName);
+        }
+
+        long long eventCount = drge_atomic_load_64(&pThread->eventCount);
+        for (long long iEvent = 0; iEvent < eventCount; ++iEvent)
+        {
+            const drge_profile_event* pEvent = &pThread->events[iEvent];
+            double timestamp = (pEvent->ticks - startTicks) * microsecondsPerTick;
+
+            switch (pEvent->type)
+            {
+                case DRGE_PROFILE_EVENT_BEGIN:
+                {
+                    drge_trace_writef(&writer, "{\"name\":");
+                    drge_trace_write_string(&writer, pEvent->name);
+                    drge_trace_writef(&writer, ",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u},\n", timestamp, pThread->trackID);
+                } break;
+
+                case DRGE_PROFILE_EVENT_END:
+                {
+                    drge_trace_writef(&writer, "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u},\n", timestamp, pThread->trackID);
+                } break;
+
+                case DRGE_PROFILE_EVENT_GPU:
+                {
+                    drge_trace_writef(&writer, "{\"name\":");
+                    drge_trace_write_string(&writer, pEvent->name);
+                    drge_trace_writef(&writer, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u},\n", timestamp, pEvent->durationTicks * microsecondsPerTick, DRGE_PROFILER_GPU_TRACK);
+                    gpuScopeCount += 1;
+                } break;
+
+                default: break;
+            }
+        }
+
+        droppedEventCount += (unsigned long long)drge_atomic_load_64(&pThread->droppedEventCount);
+    }
+
+    // Every event is followed by a comma, and JSON doesn't allow a trailing one, so the list is finished off with a
+    // metadata event that doesn't need one.
+    drge_trace_writef(&writer, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"dr_ge\"}}\n]}\n");
+    drge_trace_writer_flush(&writer);
+
+    if (pStatsOut != NULL) {
+        pStatsOut->droppedEventCount = droppedEventCount;
+        pStatsOut->gpuScopeCount     = gpuScopeCount;
+    }
+
+    return !writer.hasError;
+}
+
+void drge_uninit_profiler()
+{
+    drge_end_trace();
+
+    drge_profiler_thread* pThread = drge_atomic_exchange_ptr(&g_drgeProfiler.pFirstThread, NULL);
+    while (pThread != NULL) {
+        drge_profiler_thread* pNextThread = pThread->pNext;
+        DRGE_FREE(pThread);
+        pThread = pNextThread;
+    }
+
+    g_drgeProfilerThread = NULL;
+    g_drgeProfilerRecordedScopes = 0;
+}
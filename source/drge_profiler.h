@@ -0,0 +1,82 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The profiler records named scopes on any thread and writes them out in the Chrome trace event format, which can be
+// opened in chrome://tracing or Perfetto. GPU timings are recorded by the graphics world and shown on their own track.
+//
+// Nothing is recorded unless a trace is in progress, in which case each thread records into it's own buffer without
+// taking any locks. Outside of a trace a scope marker costs a couple of thread-local increments and a branch, so they
+// can be left in. Define DR_GE_DISABLE_PROFILER to compile them out completely.
+//
+// Scopes are marked with DRGE_PROFILE_SCOPE():
+//
+//     DRGE_PROFILE_SCOPE("Physics")
+//     {
+//         ...
+//     }
+//
+// Don't return, break or goto out of a DRGE_PROFILE_SCOPE() block because that skips the end of the scope. Use
+// DRGE_PROFILE_BEGIN() and DRGE_PROFILE_END() for code with early exits.
+
+// The maximum number of events each thread can record in a single trace. Events past this are dropped.
+#ifndef DRGE_PROFILER_MAX_EVENTS_PER_THREAD
+#define DRGE_PROFILER_MAX_EVENTS_PER_THREAD 16384
+#endif
+
+// The maximum number of GPU scopes that are kept from before the first trace. See drge_profile_gpu_scope().
+#define DRGE_PROFILER_MAX_EARLY_GPU_SCOPES  64
+
+typedef struct
+{
+    // The number of events that were dropped because a thread's buffer filled up.
+    unsigned long long droppedEventCount;
+
+    // The number of scopes on the GPU track.
+    unsigned long long gpuScopeCount;
+} drge_trace_stats;
+
+#ifndef DR_GE_DISABLE_PROFILER
+#define DRGE_PROFILE_BEGIN(name)    drge_profile_begin(name)
+#define DRGE_PROFILE_END()          drge_profile_end()
+#define DRGE_PROFILE_SCOPE(name)    for (int drgeProfileScopeOnce = (drge_profile_begin(name), 1); drgeProfileScopeOnce; drge_profile_end(), drgeProfileScopeOnce = 0)
+#else
+#define DRGE_PROFILE_BEGIN(name)    ((void)0)
+#define DRGE_PROFILE_END()          ((void)0)
+#define DRGE_PROFILE_SCOPE(name)    if (0) {} else
+#endif
+
+
+// Marks the beginning of a scope on the calling thread. The name is not copied so it must stay valid until the trace has
+// been written. Use a string literal.
+void drge_profile_begin(const char* name);
+
+// Marks the end of the most recently begun scope on the calling thread.
+void drge_profile_end();
+
+// Records a scope that ran on the GPU. The times are in ticks, the same as drge_get_ticks(). GPU scopes are shown on
+// their own track regardless of which thread records them.
+//
+// Most GPU work that's worth looking at, like creating the graphics world, happens before the first trace can start, so
+// up to DRGE_PROFILER_MAX_EARLY_GPU_SCOPES scopes recorded before then are kept and written into the first trace.
+void drge_profile_gpu_scope(const char* name, long long beginTicks, long long endTicks);
+
+// Sets the name of the calling thread's track in the trace. The name is not copied.
+void drge_profile_set_thread_name(const char* name);
+
+
+// Starts recording a trace. Anything recorded by a previous trace is discarded.
+void drge_begin_trace();
+
+// Stops recording. Scopes that are still open when this is called are closed when they end.
+void drge_end_trace();
+
+// Determines whether or not a trace is being recorded.
+bool drge_is_tracing();
+
+// Writes the most recent trace to the given file as Chrome trace event JSON. Call drge_end_trace() first.
+//
+// pStatsOut is optional, and receives the number of events that were written and dropped. Returns false if writing to
+// the file failed.
+bool drge_write_trace(drfs_file* pFile, drge_trace_stats* pStatsOut);
+
+// Frees every thread's trace buffer. This must only be called when no other thread is recording, such as on shutdown.
+void drge_uninit_profiler();
@@ -0,0 +1,430 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+#define DRGE_REPLAY_MAGIC           0x50525244  // "DRRP"
+#define DRGE_REPLAY_VERSION         2
+#define DRGE_REPLAY_BUFFER_SIZE     4096
+
+// The largest a single record can be. A type byte and a 64-bit variable length integer for the time, followed by a raw
+// input event's type byte, it's button as a 32-bit variable length integer, two floats and it's age as a 64-bit
+// variable length integer.
+#define DRGE_REPLAY_MAX_RECORD_SIZE 35
+
+struct drge_replay
+{
+    // The file the replay is being written to or read from.
+    drfs_file* pFile;
+
+    // Whether or not the replay is being recorded, as opposed to played back.
+    bool isRecording;
+
+    // Set when a write fails. Nothing else is written after this.
+    bool hasWriteFailed;
+
+    // The time of the previous event, in microseconds. Times are stored relative to the previous event.
+    unsigned long long prevTimeUS;
+
+    // The event that was read by drge_replay_peek(), which is returned by the next call to drge_replay_read().
+    bool hasPeekedEvent;
+    drge_replay_event peekedEvent;
+
+    // Records are buffered so the file is only touched every few thousand bytes. When recording, bufferSize is the
+    // number of bytes waiting to be written. When playing back, it's the number of bytes that were read into the buffer
+    // and bufferPos is the next one to be used.
+    size_t bufferSize;
+    size_t bufferPos;
+    unsigned char buffer[DRGE_REPLAY_BUFFER_SIZE];
+};
+
+static void drge_replay_flush(drge_replay* pReplay)
+{
+    assert(pReplay != NULL);
+    assert(pReplay->isRecording);
+
+    if (pReplay->bufferSize > 0 && !pReplay->hasWriteFailed) {
+        size_t bytesWritten;
+        if (drfs_write(pReplay->pFile, pReplay->buffer, pReplay->bufferSize, &bytesWritten) != drfs_success || bytesWritten != pReplay->bufferSize) {
+            pReplay->hasWriteFailed = true;
+        }
+    }
+
+    pReplay->bufferSize = 0;
+}
+
+static void drge_replay_write_bytes(drge_replay* pReplay, const void* pData, size_t size)
+{
+    assert(pReplay != NULL);
+    assert(size <= DRGE_REPLAY_BUFFER_SIZE);
+
+    if (pReplay->bufferSize + size > DRGE_REPLAY_BUFFER_SIZE) {
+        drge_replay_flush(pReplay);
+    }
+
+    memcpy(pReplay->buffer + pReplay->bufferSize, pData, size);
+    pReplay->bufferSize += size;
+}
+
+// Reads bytes for playback, refilling the buffer from the file as needed. Returns false at the end of the file.
+static bool drge_replay_read_bytes(drge_replay* pReplay, void* pDataOut, size_t size)
+{
+    assert(pReplay != NULL);
+    assert(!pReplay->isRecording);
+
+    unsigned char* pBytesOut = pDataOut;
+    while (size > 0)
+    {
+        if (pReplay->bufferPos == pReplay->bufferSize) {
+            size_t bytesRead;
+            if (drfs_read(pReplay->pFile, pReplay->buffer, sizeof(pReplay->buffer), &bytesRead) != drfs_success || bytesRead == 0) {
+                return false;
+            }
+
+            pReplay->bufferSize = bytesRead;
+            pReplay->bufferPos  = 0;
+        }
+
+        size_t bytesToCopy = pReplay->bufferSize - pReplay->bufferPos;
+        if (bytesToCopy > size) {
+            bytesToCopy = size;
+        }
+
+        memcpy(pBytesOut, pReplay->buffer + pReplay->bufferPos, bytesToCopy);
+        pReplay->bufferPos += bytesToCopy;
+        pBytesOut += bytesToCopy;
+        size      -= bytesToCopy;
+    }
+
+    return true;
+}
+
+// Variable length integers are stored 7 bits at a time, lowest bits first, with the top bit of each byte set when there
+// are more bytes to come. Most events are a few milliseconds apart so their times fit in 2 bytes.
+static size_t drge_replay_encode_varint(unsigned long long value, unsigned char* pBytesOut)
+{
+    size_t size = 0;
+    while (value >= 0x80) {
+        pBytesOut[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+
+    pBytesOut[size++] = (unsigned char)value;
+    return size;
+}
+
+// Fixed size values are written a byte at a time so the file is little endian no matter what the host is. Floats and
+// doubles are written as their bits, which is what makes frame times play back exactly.
+static void drge_replay_encode_u32(uint32_t value, unsigned char* pBytesOut)
+{
+    for (int i = 0; i < 4; ++i) {
+        pBytesOut[i] = (unsigned char)(value >> (i*8));
+    }
+}
+
+static void drge_replay_encode_u64(uint64_t value, unsigned char* pBytesOut)
+{
+    for (int i = 0; i < 8; ++i) {
+        pBytesOut[i] = (unsigned char)(value >> (i*8));
+    }
+}
+
+static uint32_t drge_replay_decode_u32(const unsigned char* pBytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= (uint32_t)pBytes[i] << (i*8);
+    }
+
+    return value;
+}
+
+static uint64_t drge_replay_decode_u64(const unsigned char* pBytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= (uint64_t)pBytes[i] << (i*8);
+    }
+
+    return value;
+}
+
+static bool drge_replay_read_varint(drge_replay* pReplay, unsigned long long* pValueOut)
+{
+    assert(pValueOut != NULL);
+
+    unsigned long long value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        unsigned char byte;
+        if (!drge_replay_read_bytes(pReplay, &byte, 1)) {
+            return false;
+        }
+
+        value |= (unsigned long long)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *pValueOut = value;
+            return true;
+        }
+    }
+
+    return false;   // Too long. The replay is corrupt.
+}
+
+
+drge_replay* drge_create_replay_recorder(drfs_file* pFile, const drge_replay_header* pHeader)
+{
+    if (pFile == NULL || pHeader == NULL) {
+        return NULL;
+    }
+
+    drge_replay* pReplay = DRGE_MALLOC(sizeof(*pReplay), DRGE_MEMORY_TAG_GENERAL);
+    if (pReplay == NULL) {
+        return NULL;
+    }
+
+    pReplay->pFile          = pFile;
+    pReplay->isRecording    = true;
+    pReplay->hasWriteFailed = false;
+    pReplay->prevTimeUS     = 0;
+    pReplay->hasPeekedEvent = false;
+    pReplay->bufferSize     = 0;
+    pReplay->bufferPos      = 0;
+
+    unsigned char header[24];
+    drge_replay_encode_u32(DRGE_REPLAY_MAGIC,          header +  0);
+    drge_replay_encode_u32(DRGE_REPLAY_VERSION,        header +  4);
+    drge_replay_encode_u32(pHeader->stepRate,          header +  8);
+    drge_replay_encode_u32(pHeader->maxStepsPerFrame,  header + 12);
+    drge_replay_encode_u32(pHeader->actionCount,       header + 16);
+    drge_replay_encode_u32(pHeader->axisCount,         header + 20);
+    drge_replay_write_bytes(pReplay, header, sizeof(header));
+
+    return pReplay;
+}
+
+drge_replay* drge_open_replay(drfs_file* pFile, drge_replay_header* pHeaderOut)
+{
+    if (pFile == NULL || pHeaderOut == NULL) {
+        return NULL;
+    }
+
+    drge_replay* pReplay = DRGE_MALLOC(sizeof(*pReplay), DRGE_MEMORY_TAG_GENERAL);
+    if (pReplay == NULL) {
+        return NULL;
+    }
+
+    pReplay->pFile          = pFile;
+    pReplay->isRecording    = false;
+    pReplay->hasWriteFailed = false;
+    pReplay->prevTimeUS     = 0;
+    pReplay->hasPeekedEvent = false;
+    pReplay->bufferSize     = 0;
+    pReplay->bufferPos      = 0;
+
+    unsigned char header[24];
+    if (!drge_replay_read_bytes(pReplay, header, sizeof(header)) || drge_replay_decode_u32(header + 0) != DRGE_REPLAY_MAGIC || drge_replay_decode_u32(header + 4) != DRGE_REPLAY_VERSION) {
+        DRGE_FREE(pReplay);
+        return NULL;
+    }
+
+    pHeaderOut->stepRate         = drge_replay_decode_u32(header +  8);
+    pHeaderOut->maxStepsPerFrame = drge_replay_decode_u32(header + 12);
+    pHeaderOut->actionCount      = drge_replay_decode_u32(header + 16);
+    pHeaderOut->axisCount        = drge_replay_decode_u32(header + 20);
+
+    return pReplay;
+}
+
+bool drge_delete_replay(drge_replay* pReplay)
+{
+    if (pReplay == NULL) {
+        return false;
+    }
+
+    bool result = true;
+    if (pReplay->isRecording) {
+        drge_replay_flush(pReplay);
+        result = !pReplay->hasWriteFailed;
+    }
+
+    DRGE_FREE(pReplay);
+    return result;
+}
+
+void drge_replay_write(drge_replay* pReplay, const drge_replay_event* pEvent)
+{
+    if (pReplay == NULL || pEvent == NULL || !pReplay->isRecording) {
+        return;
+    }
+
+    unsigned char record[DRGE_REPLAY_MAX_RECORD_SIZE];
+    size_t recordSize = 0;
+
+    // Times should never go backwards, but if they do it's better to clamp than to wrap around.
+    unsigned long long deltaUS = (pEvent->timeUS > pReplay->prevTimeUS) ? pEvent->timeUS - pReplay->prevTimeUS : 0;
+    pReplay->prevTimeUS += deltaUS;
+
+    record[recordSize++] = (unsigned char)pEvent->type;
+    recordSize += drge_replay_encode_varint(deltaUS, record + recordSize);
+
+    switch (pEvent->type)
+    {
+        case DRGE_REPLAY_EVENT_FRAME:
+        {
+            uint64_t bits;
+            memcpy(&bits, &pEvent->frameSeconds, 8);
+            drge_replay_encode_u64(bits, record + recordSize);
+            recordSize += 8;
+        } break;
+
+        case DRGE_REPLAY_EVENT_STEP:
+        {
+        } break;
+
+        case DRGE_REPLAY_EVENT_ACTION_DOWN:
+        case DRGE_REPLAY_EVENT_ACTION_UP:
+        {
+            recordSize += drge_replay_encode_varint(pEvent->id, record + recordSize);
+        } break;
+
+        case DRGE_REPLAY_EVENT_AXIS:
+        {
+            recordSize += drge_replay_encode_varint(pEvent->id, record + recordSize);
+            uint32_t bits;
+            memcpy(&bits, &pEvent->axisValue, 4);
+            drge_replay_encode_u32(bits, record + recordSize);
+            recordSize += 4;
+        } break;
+
+        case DRGE_REPLAY_EVENT_RAW_INPUT:
+        {
+            record[recordSize++] = (unsigned char)pEvent->rawInput.type;
+            recordSize += drge_replay_encode_varint(pEvent->rawInput.button, record + recordSize);
+
+            uint32_t bits;
+            memcpy(&bits, &pEvent->rawInput.deltaX, 4);
+            drge_replay_encode_u32(bits, record + recordSize);
+            recordSize += 4;
+            memcpy(&bits, &pEvent->rawInput.deltaY, 4);
+            drge_replay_encode_u32(bits, record + recordSize);
+            recordSize += 4;
+
+            recordSize += drge_replay_encode_varint(pEvent->rawInputAgeUS, record + recordSize);
+        } break;
+
+        default: return;    // Unknown event type.
+    }
+
+    drge_replay_write_bytes(pReplay, record, recordSize);
+}
+
+bool drge_replay_read(drge_replay* pReplay, drge_replay_event* pEventOut)
+{
+    if (pReplay == NULL || pEventOut == NULL || pReplay->isRecording) {
+        return false;
+    }
+
+    if (pReplay->hasPeekedEvent) {
+        *pEventOut = pReplay->peekedEvent;
+        pReplay->hasPeekedEvent = false;
+        return true;
+    }
+
+    memset(pEventOut, 0, sizeof(*pEventOut));
+
+    unsigned char type;
+    unsigned long long deltaUS;
+    if (!drge_replay_read_bytes(pReplay, &type, 1) || !drge_replay_read_varint(pReplay, &deltaUS)) {
+        return false;
+    }
+
+    pReplay->prevTimeUS += deltaUS;
+    pEventOut->type   = type;
+    pEventOut->timeUS = pReplay->prevTimeUS;
+
+    unsigned long long id;
+    unsigned char bytes[8];
+    switch (type)
+    {
+        case DRGE_REPLAY_EVENT_FRAME:
+        {
+            if (!drge_replay_read_bytes(pReplay, bytes, 8)) {
+                return false;
+            }
+
+            uint64_t bits = drge_replay_decode_u64(bytes);
+            memcpy(&pEventOut->frameSeconds, &bits, 8);
+            return true;
+        }
+
+        case DRGE_REPLAY_EVENT_STEP:
+        {
+            return true;
+        }
+
+        case DRGE_REPLAY_EVENT_ACTION_DOWN:
+        case DRGE_REPLAY_EVENT_ACTION_UP:
+        {
+            if (!drge_replay_read_varint(pReplay, &id)) {
+                return false;
+            }
+
+            pEventOut->id = (unsigned int)id;
+            return true;
+        }
+
+        case DRGE_REPLAY_EVENT_AXIS:
+        {
+            if (!drge_replay_read_varint(pReplay, &id)) {
+                return false;
+            }
+
+            pEventOut->id = (unsigned int)id;
+            if (!drge_replay_read_bytes(pReplay, bytes, 4)) {
+                return false;
+            }
+
+            uint32_t bits = drge_replay_decode_u32(bytes);
+            memcpy(&pEventOut->axisValue, &bits, 4);
+            return true;
+        }
+
+        case DRGE_REPLAY_EVENT_RAW_INPUT:
+        {
+            unsigned long long button;
+            if (!drge_replay_read_bytes(pReplay, bytes, 1) || !drge_replay_read_varint(pReplay, &button)) {
+                return false;
+            }
+
+            pEventOut->rawInput.type   = bytes[0];
+            pEventOut->rawInput.button = (unsigned int)button;
+            if (!drge_replay_read_bytes(pReplay, bytes, 8) || !drge_replay_read_varint(pReplay, &pEventOut->rawInputAgeUS)) {
+                return false;
+            }
+
+            uint32_t bits = drge_replay_decode_u32(bytes + 0);
+            memcpy(&pEventOut->rawInput.deltaX, &bits, 4);
+            bits = drge_replay_decode_u32(bytes + 4);
+            memcpy(&pEventOut->rawInput.deltaY, &bits, 4);
+            return true;
+        }
+
+        default: return false;  // Unknown event type. The replay is corrupt.
+    }
+}
+
+bool drge_replay_peek(drge_replay* pReplay, drge_replay_event* pEventOut)
+{
+    if (pReplay == NULL || pEventOut == NULL || pReplay->isRecording) {
+        return false;
+    }
+
+    if (!pReplay->hasPeekedEvent) {
+        if (!drge_replay_read(pReplay, &pReplay->peekedEvent)) {
+            return false;
+        }
+
+        pReplay->hasPeekedEvent = true;
+    }
+
+    *pEventOut = pReplay->peekedEvent;
+    return true;
+}
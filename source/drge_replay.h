@@ -0,0 +1,82 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// A replay is a recording of everything that feeds into the simulation - the input, and how much time each frame moved
+// the game forward by - so that a play session can be run again and step through exactly the same states. This is
+// mostly for benchmarking, where the same session can be run over and over to compare builds.
+//
+// A replay is a stream of events. The input events for a frame come first and are followed by a frame event which
+// holds the time that frame advanced the game by. Each step of the frame then starts with the raw input that was handed
+// to it, and is followed by a step event, which comes after any input that changed while the step was running so that
+// it's applied as soon as the step has finished rather than a whole frame late. Each event is timestamped with the time
+// it happened, relative to when recording started.
+//
+// The stream is a small header followed by one record for each event. Each record is a type byte, the time since the
+// previous event in microseconds as a variable length integer, and then whatever data the type needs. Frame times are
+// stored as doubles so they play back bit for bit. Everything is little endian.
+
+typedef struct drge_replay drge_replay;
+
+// Event types.
+#define DRGE_REPLAY_EVENT_FRAME         0
+#define DRGE_REPLAY_EVENT_ACTION_DOWN   1
+#define DRGE_REPLAY_EVENT_ACTION_UP     2
+#define DRGE_REPLAY_EVENT_AXIS          3
+#define DRGE_REPLAY_EVENT_STEP          4
+#define DRGE_REPLAY_EVENT_RAW_INPUT     5
+
+typedef struct
+{
+    // One of DRGE_REPLAY_EVENT_*.
+    int type;
+
+    // When the event happened, in microseconds since recording started.
+    unsigned long long timeUS;
+
+    // The action or axis ID, for input events.
+    unsigned int id;
+
+    // The value of the axis, for DRGE_REPLAY_EVENT_AXIS.
+    float axisValue;
+
+    // The time the frame advanced the game by, for DRGE_REPLAY_EVENT_FRAME.
+    double frameSeconds;
+
+    // The raw input event, for DRGE_REPLAY_EVENT_RAW_INPUT. It's ticks aren't stored because they only mean something to
+    // the process that recorded them. Instead, rawInputAgeUS is how long before the end of it's step the event arrived.
+    drge_raw_input_event rawInput;
+    unsigned long long rawInputAgeUS;
+} drge_replay_event;
+
+// The settings a replay was recorded with. These affect how the game steps, so they need to be the same when playing it
+// back.
+typedef struct
+{
+    unsigned int stepRate;
+    unsigned int maxStepsPerFrame;
+    unsigned int actionCount;
+    unsigned int axisCount;
+} drge_replay_header;
+
+
+// Starts recording a replay to the given file, which must have been opened for writing. The file is not closed when
+// the replay is deleted.
+drge_replay* drge_create_replay_recorder(drfs_file* pFile, const drge_replay_header* pHeader);
+
+// Starts playing back a replay from the given file, which must have been opened for reading. The file is not closed
+// when the replay is deleted.
+//
+// Returns null if the file is not a replay or was recorded with a different version.
+drge_replay* drge_open_replay(drfs_file* pFile, drge_replay_header* pHeaderOut);
+
+// Finishes writing the replay if it's being recorded and deletes it. Returns false if anything failed to be written.
+bool drge_delete_replay(drge_replay* pReplay);
+
+// Adds an event to a replay that's being recorded. Events are buffered, and must be in order of time.
+void drge_replay_write(drge_replay* pReplay, const drge_replay_event* pEvent);
+
+// Reads the next event from a replay that's being played back. Returns false at the end of the replay, or if the rest
+// of it is corrupt.
+bool drge_replay_read(drge_replay* pReplay, drge_replay_event* pEventOut);
+
+// Retrieves the event that the next call to drge_replay_read() will return, without moving past it.
+bool drge_replay_peek(drge_replay* pReplay, drge_replay_event* pEventOut);
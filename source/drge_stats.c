@@ -0,0 +1,155 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Values under 16 microseconds each get their own bucket. Past that, each power of 2 is split into 8 buckets.
+#define DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT  16
+#define DRGE_HISTOGRAM_SUB_BUCKET_COUNT     8
+
+// Retrieves the value at the top of the given bucket, in microseconds.
+static unsigned long long drge_histogram_bucket_upper_bound(unsigned int index)
+{
+    if (index < DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT) {
+        return index + 1;
+    }
+
+    unsigned int exponent  = 4 + (index - DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT) / DRGE_HISTOGRAM_SUB_BUCKET_COUNT;
+    unsigned int subBucket =     (index - DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT) % DRGE_HISTOGRAM_SUB_BUCKET_COUNT;
+    return (unsigned long long)(DRGE_HISTOGRAM_SUB_BUCKET_COUNT + subBucket + 1) << (exponent - 3);
+}
+
+static unsigned int drge_histogram_bucket_index(unsigned long long us)
+{
+    if (us < DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT) {
+        return (unsigned int)us;
+    }
+
+    // Anything that reaches the last bucket goes straight in it. This keeps the shifts below in range for huge values.
+    if (us >= drge_histogram_bucket_upper_bound(DRGE_HISTOGRAM_BUCKET_COUNT - 2)) {
+        return DRGE_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+
+    unsigned int exponent = 4;  // log2(DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT)
+    while ((us >> (exponent + 1)) != 0) {
+        exponent += 1;
+    }
+
+    unsigned int subBucket = (unsigned int)(us >> (exponent - 3)) & (DRGE_HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    return DRGE_HISTOGRAM_LINEAR_BUCKET_COUNT + (exponent - 4)*DRGE_HISTOGRAM_SUB_BUCKET_COUNT + subBucket;
+}
+
+
+void drge_init_histogram(drge_histogram* pHistogram)
+{
+    if (pHistogram == NULL) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < DRGE_HISTOGRAM_BUCKET_COUNT; ++i) {
+        drge_atomic_store_64(&pHistogram->buckets[i], 0);
+    }
+
+    drge_atomic_store_64(&pHistogram->sampleCount, 0);
+    drge_atomic_store_64(&pHistogram->totalTicks,  0);
+    drge_atomic_store_64(&pHistogram->minTicks,    0x7FFFFFFFFFFFFFFFLL);
+    drge_atomic_store_64(&pHistogram->maxTicks,    0);
+}
+
+void drge_histogram_record(drge_histogram* pHistogram, long long ticks)
+{
+    if (pHistogram == NULL) {
+        return;
+    }
+
+    if (ticks < 0) {
+        ticks = 0;
+    }
+
+    // Anything over a day is just put in the last bucket. This also keeps the conversion from overflowing.
+    long long tickFrequency = drge_get_tick_frequency();
+    unsigned long long us = (ticks < tickFrequency*86400) ? (unsigned long long)(ticks * 1000000.0 / tickFrequency) : ~0ULL;
+
+    drge_atomic_fetch_add_64(&pHistogram->buckets[drge_histogram_bucket_index(us)], 1);
+    drge_atomic_fetch_add_64(&pHistogram->totalTicks, ticks);
+
+    long long minTicks = drge_atomic_load_64(&pHistogram->minTicks);
+    while (ticks < minTicks) {
+        long long prevTicks = drge_atomic_compare_exchange_64(&pHistogram->minTicks, minTicks, ticks);
+        if (prevTicks == minTicks) {
+            break;
+        }
+        minTicks = prevTicks;
+    }
+
+    long long maxTicks = drge_atomic_load_64(&pHistogram->maxTicks);
+    while (ticks > maxTicks) {
+        long long prevTicks = drge_atomic_compare_exchange_64(&pHistogram->maxTicks, maxTicks, ticks);
+        if (prevTicks == maxTicks) {
+            break;
+        }
+        maxTicks = prevTicks;
+    }
+
+    // The count is done last so that a reader never sees a sample counted before it's minimum and maximum are in.
+    drge_atomic_fetch_add_64(&pHistogram->sampleCount, 1);
+}
+
+double drge_histogram_get_percentile(const drge_histogram* pHistogram, double fraction)
+{
+    if (pHistogram == NULL) {
+        return 0;
+    }
+
+    long long sampleCount = drge_atomic_load_64(&pHistogram->sampleCount);
+    if (sampleCount == 0) {
+        return 0;
+    }
+
+    // The rank of the sample we're looking for, starting from 1.
+    long long rank = (long long)(fraction * sampleCount + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > sampleCount) {
+        rank = sampleCount;
+    }
+
+    double maxMS = drge_atomic_load_64(&pHistogram->maxTicks) * 1000.0 / drge_get_tick_frequency();
+
+    long long countSoFar = 0;
+    for (unsigned int i = 0; i < DRGE_HISTOGRAM_BUCKET_COUNT; ++i) {
+        countSoFar += drge_atomic_load_64(&pHistogram->buckets[i]);
+        if (countSoFar >= rank) {
+            double upperBoundMS = drge_histogram_bucket_upper_bound(i) / 1000.0;
+            return (upperBoundMS < maxMS) ? upperBoundMS : maxMS;
+        }
+    }
+
+    // Samples were recorded while we were counting.
+    return maxMS;
+}
+
+void drge_summarize_histogram(const drge_histogram* pHistogram, drge_histogram_summary* pSummaryOut)
+{
+    if (pSummaryOut == NULL) {
+        return;
+    }
+
+    memset(pSummaryOut, 0, sizeof(*pSummaryOut));
+
+    if (pHistogram == NULL) {
+        return;
+    }
+
+    long long sampleCount = drge_atomic_load_64(&pHistogram->sampleCount);
+    if (sampleCount == 0) {
+        return;
+    }
+
+    double msPerTick = 1000.0 / drge_get_tick_frequency();
+    pSummaryOut->sampleCount = (unsigned long long)sampleCount;
+    pSummaryOut->min = drge_atomic_load_64(&pHistogram->minTicks) * msPerTick;
+    pSummaryOut->avg = drge_atomic_load_64(&pHistogram->totalTicks) * msPerTick / sampleCount;
+    pSummaryOut->p50 = drge_histogram_get_percentile(pHistogram, 0.50);
+    pSummaryOut->p95 = drge_histogram_get_percentile(pHistogram, 0.95);
+    pSummaryOut->p99 = drge_histogram_get_percentile(pHistogram, 0.99);
+    pSummaryOut->max = drge_atomic_load_64(&pHistogram->maxTicks) * msPerTick;
+}
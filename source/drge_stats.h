@@ -0,0 +1,57 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// Histograms for timing things that happen over and over, such as frames. Recording a sample is a handful of integer
+// operations and a few atomic adds, so they are cheap enough to leave on all the time, including in shipping builds.
+//
+// Samples are counted in buckets rather than stored. Bucket widths grow with the value so that the relative error of a
+// percentile stays under 1/8th (12.5%) from one microsecond up to over a minute, using a fixed 208 buckets. The minimum,
+// maximum and average are exact.
+//
+// Any thread can record into a histogram while any other thread reads from it. Clearing one with drge_init_histogram()
+// must not overlap with recording into it.
+
+// The number of buckets in a histogram.
+#define DRGE_HISTOGRAM_BUCKET_COUNT 208
+
+typedef struct
+{
+    // The number of samples in each bucket. Samples are bucketed by their value in microseconds.
+    volatile long long buckets[DRGE_HISTOGRAM_BUCKET_COUNT];
+
+    // The number of samples.
+    volatile long long sampleCount;
+
+    // The sum of every sample, in ticks.
+    volatile long long totalTicks;
+
+    // The smallest and largest samples, in ticks. Only valid when sampleCount is not zero.
+    volatile long long minTicks;
+    volatile long long maxTicks;
+} drge_histogram;
+
+// A summary of a histogram. Times are in milliseconds.
+typedef struct
+{
+    unsigned long long sampleCount;
+    double min;
+    double avg;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+} drge_histogram_summary;
+
+
+// Initializes a histogram, or clears an existing one.
+void drge_init_histogram(drge_histogram* pHistogram);
+
+// Records a sample. The time is in ticks, the same as drge_get_ticks(). Negative times are recorded as 0.
+void drge_histogram_record(drge_histogram* pHistogram, long long ticks);
+
+// Retrieves the time below which the given fraction of samples fall, in milliseconds. For example, a fraction of 0.99
+// gives the 99th percentile. This is the upper end of the bucket the percentile falls in, capped to the maximum, so it
+// can be up to 12.5% higher than the actual value. Returns 0 if there are no samples.
+double drge_histogram_get_percentile(const drge_histogram* pHistogram, double fraction);
+
+// Summarizes a histogram.
+void drge_summarize_histogram(const drge_histogram* pHistogram, drge_histogram_summary* pSummaryOut);
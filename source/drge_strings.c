@@ -0,0 +1,157 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The table never grows, so this needs to be big enough that chains stay short with tens of thousands of strings.
+// Must be a power of 2.
+#define DRGE_STRING_TABLE_BUCKET_COUNT  16384
+
+// Strings are packed into blocks of this size so each one doesn't pay for a separate allocation. Strings bigger than a
+// quarter of this get an allocation of their own.
+#define DRGE_STRING_BLOCK_SIZE          65536
+
+typedef struct drge_string_block drge_string_block;
+struct drge_string_block
+{
+    // The block that was current before this one. Blocks are never freed, so this is only kept for debugging.
+    drge_string_block* pPrevBlock;
+
+    // The number of bytes of data that have been handed out.
+    volatile long long used;
+
+    unsigned char data[DRGE_STRING_BLOCK_SIZE];
+};
+
+// Each bucket is a singly linked list of strings. Strings are only ever added to the front of a list, with a
+// compare-exchange, and are never removed. This is what lets lookups run without a lock.
+static drge_string* volatile g_drgeStringBuckets[DRGE_STRING_TABLE_BUCKET_COUNT];
+static drge_string_block* volatile g_drgeStringBlock = NULL;
+static volatile long long g_drgeInternedStringCount = 0;
+
+// Allocates memory for a string. The memory is aligned to 8 bytes and is never freed.
+static void* drge_string_table_alloc(size_t size)
+{
+    size = (size + 7) & ~(size_t)7;
+
+    if (size > DRGE_STRING_BLOCK_SIZE/4) {
+        return DRGE_MALLOC(size, DRGE_MEMORY_TAG_STRINGS);
+    }
+
+    for (;;)
+    {
+        drge_string_block* pBlock = drge_atomic_load_ptr(&g_drgeStringBlock);
+        if (pBlock != NULL) {
+            long long offset = drge_atomic_fetch_add_64(&pBlock->used, (long long)size);
+            if ((unsigned long long)offset + size <= DRGE_STRING_BLOCK_SIZE) {
+                return pBlock->data + offset;
+            }
+        }
+
+        // The block is full. Whichever thread gets it's new block in first wins and the others use that one.
+        drge_string_block* pNewBlock = DRGE_MALLOC(sizeof(*pNewBlock), DRGE_MEMORY_TAG_STRINGS);
+        if (pNewBlock == NULL) {
+            return NULL;
+        }
+
+        pNewBlock->pPrevBlock = pBlock;
+        pNewBlock->used       = (long long)size;
+        if (drge_atomic_compare_exchange_ptr(&g_drgeStringBlock, pBlock, pNewBlock) == pBlock) {
+            return pNewBlock->data;
+        }
+
+        DRGE_FREE(pNewBlock);
+    }
+}
+
+static drge_string* drge_find_string_in_bucket(drge_string* pFirst, const char* str, size_t length, unsigned int hash)
+{
+    for (drge_string* pString = pFirst; pString != NULL; pString = pString->pNext) {
+        if (pString->hash == hash && pString->length == length && memcmp(pString->c_str, str, length) == 0) {
+            return pString;
+        }
+    }
+
+    return NULL;
+}
+
+
+const drge_string* drge_intern_string(const char* str)
+{
+    if (str == NULL) {
+        return NULL;
+    }
+
+    return drge_intern_string_n(str, strlen(str));
+}
+
+const drge_string* drge_intern_string_n(const char* str, size_t length)
+{
+    if (str == NULL || length > 0xFFFFFFFF) {
+        return NULL;
+    }
+
+    unsigned int hash = drge_hash_string(str, length);
+    drge_string* volatile* ppBucket = &g_drgeStringBuckets[hash & (DRGE_STRING_TABLE_BUCKET_COUNT - 1)];
+
+    drge_string* pFirst = drge_atomic_load_ptr(ppBucket);
+    drge_string* pExistingString = drge_find_string_in_bucket(pFirst, str, length, hash);
+    if (pExistingString != NULL) {
+        return pExistingString;
+    }
+
+    drge_string* pNewString = drge_string_table_alloc(sizeof(*pNewString) - sizeof(pNewString->c_str) + length + 1);
+    if (pNewString == NULL) {
+        return NULL;
+    }
+
+    pNewString->hash   = hash;
+    pNewString->length = (unsigned int)length;
+    memcpy(pNewString->c_str, str, length);
+    pNewString->c_str[length] = '\0';
+
+    for (;;)
+    {
+        pNewString->pNext = pFirst;
+
+        drge_string* pPrevFirst = drge_atomic_compare_exchange_ptr(ppBucket, pFirst, pNewString);
+        if (pPrevFirst == pFirst) {
+            drge_atomic_fetch_add_64(&g_drgeInternedStringCount, 1);
+            return pNewString;
+        }
+
+        // Another thread added to the bucket first. It might have added the same string, in which case ours is wasted,
+        // but that's rare enough to not be worth a lock.
+        pExistingString = drge_find_string_in_bucket(pPrevFirst, str, length, hash);
+        if (pExistingString != NULL) {
+            return pExistingString;
+        }
+
+        pFirst = pPrevFirst;
+    }
+}
+
+const drge_string* drge_find_interned_string(const char* str)
+{
+    if (str == NULL) {
+        return NULL;
+    }
+
+    size_t length = strlen(str);
+    unsigned int hash = drge_hash_string(str, length);
+    return drge_find_string_in_bucket(drge_atomic_load_ptr(&g_drgeStringBuckets[hash & (DRGE_STRING_TABLE_BUCKET_COUNT - 1)]), str, length, hash);
+}
+
+unsigned int drge_hash_string(const char* str, size_t length)
+{
+    // 32-bit FNV-1a.
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+unsigned int drge_get_interned_string_count()
+{
+    return (unsigned int)drge_atomic_load_64(&g_drgeInternedStringCount);
+}
@@ -0,0 +1,43 @@
+// Public domain. See "unlicense" statement at the end of dr_ge.h.
+
+// The string table interns strings so that each distinct string is only stored once. Interning a string returns a
+// pointer to the one copy of it, which stays valid for the life of the program. Two interned strings are equal if and
+// only if their pointers are equal, so comparing them is a pointer compare rather than a strcmp(). This is mostly used
+// for file paths, which are long and compared often, such as the paths of assets.
+//
+// The table is global and can be used from any thread. Looking up a string that's already been interned doesn't take
+// any locks. Interned strings are never freed, so only intern strings that there's a bounded number of.
+
+typedef struct drge_string drge_string;
+struct drge_string
+{
+    // The next string in the same bucket of the table. Internal use only.
+    drge_string* pNext;
+
+    // The hash of the string, as returned by drge_hash_string(). Use this for hash maps keyed on interned strings.
+    unsigned int hash;
+
+    // The length of the string in bytes, not including the null terminator.
+    unsigned int length;
+
+    // The null terminated string.
+    char c_str[1];
+};
+
+
+// Interns the given null terminated string. Returns null if str is null or there's not enough memory.
+const drge_string* drge_intern_string(const char* str);
+
+// Interns the first length bytes of the given string. The string does not need to be null terminated.
+const drge_string* drge_intern_string_n(const char* str, size_t length);
+
+// Retrieves the interned copy of the given string without interning it. Returns null if it's not been interned.
+const drge_string* drge_find_interned_string(const char* str);
+
+// Retrieves the hash of the given string. This is what the table uses and is the same hash that's stored in each
+// interned string.
+unsigned int drge_hash_string(const char* str, size_t length);
+
+// Retrieves the number of strings that have been interned. The memory they use is counted under
+// DRGE_MEMORY_TAG_STRINGS.
+unsigned int drge_get_interned_string_count();
@@ -6,7 +6,7 @@ drge_subeditor* drge_editor__create_sub_editor_by_type(drge_editor* pEditor, con
     // Sub-editors expect the file path to be absolute. We'll need to handle that.
     char absolutePath[DRFS_MAX_PATH];
     if (!drfs_find_absolute_path(pEditor->pContext->pVFS, filePath, absolutePath, sizeof(absolutePath))) {
-        drge_errorf(pEditor->pContext, "Failed to find absolute path of \"%s\". Check that the file exists.", filePath);
+        drge_log_messagef(pEditor->pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_EDITOR, "Failed to find absolute path of \"%s\". Check that the file exists.", filePath);
         return NULL;
     }
 
@@ -96,7 +96,7 @@ void drge_editor__on_log_from_appkit(ak_application* pAKApp, const char* message
     drge_editor* pEditor = *(drge_editor**)ak_get_application_extra_data(pAKApp);
     assert(pEditor != NULL);
 
-    drge_log(pEditor->pContext, message);
+    drge_log_message(pEditor->pContext, DRGE_LOG_LEVEL_INFO, DRGE_LOG_CATEGORY_EDITOR, message);
 }
 
 // Called from dr_appkit when the default config needs to be retrieved.
@@ -187,7 +187,7 @@ static drgui_element* drge_editor__on_create_tool(ak_application* pApplication,
         if (pEditor->pMainMenu == NULL) {
             pEditor->pMainMenu = drge_editor_create_main_menu_tool(pEditor, NULL, pWindow);
         } else {
-            drge_warning(pEditor->pContext, "Attempting to create more than one main menu.");
+            drge_log_message(pEditor->pContext, DRGE_LOG_LEVEL_WARNING, DRGE_LOG_CATEGORY_EDITOR, "Attempting to create more than one main menu.");
         }
 
         return pEditor->pMainMenu;
@@ -492,7 +492,7 @@ drgui_element* drge_editor__get_or_create_focused_tab_group(drge_editor* pEditor
     // If we get here it means there is no focused tab group and we need to create one. The initial one needs to be contained within the MainContent panel.
     drgui_element* pMainContent = ak_find_first_panel_by_type(pEditor->pAKApp, "MainContent");
     if (pMainContent == NULL) {
-        drge_error(pEditor->pContext, "Invalid editor config. Required panels are not defined.");
+        drge_log_message(pEditor->pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_EDITOR, "Invalid editor config. Required panels are not defined.");
         return NULL;
     }
 
@@ -518,7 +518,7 @@ drge_editor* drge_create_editor(drge_context* pContext)
         return NULL;
     }
 
-    drge_editor* pEditor = malloc(sizeof(*pEditor));
+    drge_editor* pEditor = DRGE_MALLOC(sizeof(*pEditor), DRGE_MEMORY_TAG_GUI);
     if (pEditor == NULL) {
         return NULL;
     }
@@ -534,7 +534,7 @@ drge_editor* drge_create_editor(drge_context* pContext)
     // ak_application configuration.
     pEditor->pAKApp = ak_create_application(pContext->name, sizeof(&pEditor), &pEditor);
     if (pEditor->pAKApp == NULL) {
-        free(pEditor);
+        DRGE_FREE(pEditor);
         return NULL;
     }
 
@@ -559,7 +559,7 @@ void drge_delete_editor(drge_editor* pEditor)
     }
 
     ak_delete_application(pEditor->pAKApp);
-    free(pEditor);
+    DRGE_FREE(pEditor);
 }
 
 
@@ -592,7 +592,7 @@ bool drge_editor_open_file(drge_editor* pEditor, const char* filePath)
     // the first thing we want to do is ensure we actually have one.
     drgui_element* pFocusedTabGroup = drge_editor__get_or_create_focused_tab_group(pEditor);
     if (pFocusedTabGroup == NULL) {
-        drge_errorf(pEditor->pContext, "Failed to open \"%s\" because there is no tab group to place it in.", filePath);
+        drge_log_messagef(pEditor->pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_EDITOR, "Failed to open \"%s\" because there is no tab group to place it in.", filePath);
         return false;
     }
 
@@ -312,7 +312,7 @@ static void drge_editor_command_bar__on_cmdtb_printable_key_down(drgui_element*
         int execResult = 0;
 
         size_t cmdLen = drgui_textbox_get_text(pCmdBar->pCmdTB, NULL, 0);
-        char* cmd = malloc(cmdLen + 1);
+        char* cmd = DRGE_MALLOC(cmdLen + 1, DRGE_MEMORY_TAG_GUI);
         if (drgui_textbox_get_text(pCmdBar->pCmdTB, cmd, cmdLen + 1) == cmdLen) {
             execResult = ak_exec(ak_get_tool_application(pCmdBarTool), cmd);
         }
@@ -325,7 +325,7 @@ static void drge_editor_command_bar__on_cmdtb_printable_key_down(drgui_element*
             drge_editor_command_bar_release_keyboard(pCmdBarTool);
         }
 
-        free(cmd);
+        DRGE_FREE(cmd);
     } else {
         drgui_textbox_on_printable_key_down(pCmdTB, utf32, stateFlags);
     }
@@ -132,7 +132,7 @@ drge_subeditor* drge_editor_create_model_editor(drge_editor* pEditor, const char
     assert(pMEData->pModelAsset != NULL);   // <-- The asset type should have been confirmed to be a model at a higher level.
     
 
-    pMEData->pGraphicsWorld = drge_create_graphics_world(pEditor->pContext->pVulkan);
+    pMEData->pGraphicsWorld = drge_create_graphics_world(drge_get_vulkan(pEditor->pContext));
     if (pMEData->pGraphicsWorld == NULL) {
         goto on_error;
     }
@@ -29,7 +29,7 @@ drge_subeditor* drge_editor_create_sub_editor(drge_editor* pEditor, const char*
 
     // Validate the type.
     if (!ak_is_of_tool_type(type, DRGE_EDITOR_TOOL_TYPE_SUB_EDITOR)) {
-        drge_errorf(pEditor->pContext, "Attempting to create a sub-editor of an incompatible type (\"%s\")", type);
+        drge_log_messagef(pEditor->pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_EDITOR, "Attempting to create a sub-editor of an incompatible type (\"%s\")", type);
         return NULL;
     }
 
@@ -45,7 +45,7 @@ drge_subeditor* drge_editor_create_sub_editor(drge_editor* pEditor, const char*
 
     drge_subeditor_data* pSEData = ak_get_tool_extra_data(pAKTool);
     if (strcpy_s(pSEData->fileAbsolutePath, sizeof(pSEData->fileAbsolutePath), (fileAbsolutePath != NULL) ? fileAbsolutePath : "") != 0) {
-        drge_errorf(pEditor->pContext, "Attempting to create a sub-editor with a file path that exceeds the maximum length (\"%s\")", fileAbsolutePath);
+        drge_log_messagef(pEditor->pContext, DRGE_LOG_LEVEL_ERROR, DRGE_LOG_CATEGORY_EDITOR, "Attempting to create a sub-editor with a file path that exceeds the maximum length (\"%s\")", fileAbsolutePath);
         ak_delete_tool(pAKTool);
         return NULL;
     }
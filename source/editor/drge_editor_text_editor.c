@@ -36,12 +36,12 @@ static void drge_text_editor__on_handle_action(drgui_element* pTextEditor, const
         size_t selectedTextLength = drgui_textbox_get_selected_text(pTEData->pTextBox, NULL, 0);
         if (selectedTextLength > 0)
         {
-            char* selectedText = malloc(selectedTextLength + 1);
+            char* selectedText = DRGE_MALLOC(selectedTextLength + 1, DRGE_MEMORY_TAG_GUI);
             drgui_textbox_get_selected_text(pTEData->pTextBox, selectedText, selectedTextLength + 1);
 
             ak_clipboard_set_text(selectedText, selectedTextLength);
 
-            free(selectedText);
+            DRGE_FREE(selectedText);
         }
 
         return;
@@ -51,13 +51,13 @@ static void drge_text_editor__on_handle_action(drgui_element* pTextEditor, const
         size_t selectedTextLength = drgui_textbox_get_selected_text(pTEData->pTextBox, NULL, 0);
         if (selectedTextLength > 0)
         {
-            char* selectedText = malloc(selectedTextLength + 1);
+            char* selectedText = DRGE_MALLOC(selectedTextLength + 1, DRGE_MEMORY_TAG_GUI);
             drgui_textbox_get_selected_text(pTEData->pTextBox, selectedText, selectedTextLength + 1);
 
             ak_clipboard_set_text(selectedText, selectedTextLength);
 
             drgui_textbox_delete_selected_text(pTEData->pTextBox);
-            free(selectedText);
+            DRGE_FREE(selectedText);
         }
 
         return;
@@ -96,7 +96,7 @@ static bool drge_text_editor__save(drge_subeditor* pTextEditor, const char* abso
 
     size_t textSize = drgui_textbox_get_text(pTEData->pTextBox, NULL, 0);
 
-    char* pText = malloc(textSize + 1); // +1 for null terminator.
+    char* pText = DRGE_MALLOC(textSize + 1, DRGE_MEMORY_TAG_GUI); // +1 for null terminator.
     drgui_textbox_get_text(pTEData->pTextBox, pText, textSize + 1);
 
     bool wasSuccessful = drfs_open_and_write_text_file(drge_subeditor_get_editor(pTextEditor)->pContext->pVFS, absolutePathToSaveAs, pText);
@@ -104,7 +104,7 @@ static bool drge_text_editor__save(drge_subeditor* pTextEditor, const char* abso
         pTEData->iUndoPointAtLastSave = drgui_textbox_get_undo_points_remaining_count(pTEData->pTextBox);
     }
 
-    free(pText);
+    DRGE_FREE(pText);
     return wasSuccessful;
 }
 
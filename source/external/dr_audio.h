@@ -763,6 +763,12 @@ draudio_3d_mode draudio_get_sound_3d_mode(draudio_sound* pSound);
 #include <math.h>
 #include <errno.h>
 
+// Define these to use a custom allocator. They must all be defined together.
+#ifndef DRAUDIO_MALLOC
+#define DRAUDIO_MALLOC(sz)          malloc((sz))
+#define DRAUDIO_FREE(p)             free((p))
+#endif
+
 
 // Annotations
 #ifndef DRAUDIO_PRIVATE
@@ -1470,7 +1476,7 @@ draudio_3d_mode draudio_get_3d_mode(draudio_buffer* pBuffer)
 
 draudio_mutex draudio_create_mutex()
 {
-    draudio_mutex mutex = malloc(sizeof(CRITICAL_SECTION));
+    draudio_mutex mutex = DRAUDIO_MALLOC(sizeof(CRITICAL_SECTION));
     if (mutex != NULL)
     {
         InitializeCriticalSection(mutex);
@@ -1482,7 +1488,7 @@ draudio_mutex draudio_create_mutex()
 void draudio_delete_mutex(draudio_mutex mutex)
 {
     DeleteCriticalSection(mutex);
-    free(mutex);
+    DRAUDIO_FREE(mutex);
 }
 
 void draudio_lock_mutex(draudio_mutex mutex)
@@ -1499,9 +1505,9 @@ void draudio_unlock_mutex(draudio_mutex mutex)
 
 draudio_mutex draudio_create_mutex()
 {
-    pthread_mutex_t* mutex = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_t* mutex = DRAUDIO_MALLOC(sizeof(pthread_mutex_t));
     if (pthread_mutex_init(mutex, NULL) != 0) {
-        free(mutex);
+        DRAUDIO_FREE(mutex);
         mutex = NULL;
     }
 
@@ -1849,7 +1855,7 @@ DRAUDIO_PRIVATE bool draudio_is_inline_sound(draudio_sound* pSound)
 
 draudio_world* draudio_create_world(draudio_device* pDevice)
 {
-    draudio_world* pWorld = malloc(sizeof(*pWorld));
+    draudio_world* pWorld = DRAUDIO_MALLOC(sizeof(*pWorld));
     if (pWorld != NULL)
     {
         pWorld->pDevice       = pDevice;
@@ -1874,7 +1880,7 @@ void draudio_delete_world(draudio_world* pWorld)
     draudio_delete_mutex(pWorld->lock);
 
     // Free the world last.
-    free(pWorld);
+    DRAUDIO_FREE(pWorld);
 }
 
 
@@ -1889,7 +1895,7 @@ draudio_sound* draudio_create_sound(draudio_world* pWorld, draudio_sound_desc de
         return NULL;
     }
 
-    draudio_sound* pSound = malloc(sizeof(*pSound));
+    draudio_sound* pSound = DRAUDIO_MALLOC(sizeof(*pSound));
     if (pSound == NULL) {
         return NULL;
     }
@@ -1938,7 +1944,7 @@ draudio_sound* draudio_create_sound(draudio_world* pWorld, draudio_sound_desc de
 
     // Return NULL if we failed to create the internal audio buffer.
     if (pSound->pBuffer == NULL) {
-        free(pSound);
+        DRAUDIO_FREE(pSound);
         return NULL;
     }
 
@@ -1992,7 +1998,7 @@ void draudio_delete_sound(draudio_sound* pSound)
 
 
     // Only free the sound after the application has been made aware the sound is being deleted.
-    free(pSound);
+    DRAUDIO_FREE(pSound);
 }
 
 void draudio_delete_all_sounds(draudio_world* pWorld)
@@ -2534,7 +2540,7 @@ DWORD WINAPI MessageHandlingThread_DSound(draudio_message_queue_dsound* pQueue)
                     IDirectSoundBuffer8_Release(msg.data.delete_buffer.pDSBuffer);
                 }
 
-                free(msg.pBuffer);
+                DRAUDIO_FREE(msg.pBuffer);
                 break;
             }
 
@@ -2552,7 +2558,7 @@ DWORD WINAPI MessageHandlingThread_DSound(draudio_message_queue_dsound* pQueue)
                     IDirectSound_Release(msg.data.delete_device.pDS);
                 }
 
-                free(msg.data.delete_device.pDevice);
+                DRAUDIO_FREE(msg.data.delete_device.pDevice);
                 break;
             }
 
@@ -2782,7 +2788,7 @@ void draudio_update_event_dsound(draudio_event_dsound* pEvent, draudio_event_cal
 ///     activated with draudio_activate_event_dsound().
 draudio_event_dsound* draudio_create_event_dsound(draudio_event_manager_dsound* pEventManager, draudio_event_callback_proc callback, draudio_buffer* pBuffer, unsigned int eventID, void* pUserData)
 {
-    draudio_event_dsound* pEvent = malloc(sizeof(draudio_event_dsound));
+    draudio_event_dsound* pEvent = DRAUDIO_MALLOC(sizeof(draudio_event_dsound));
     if (pEvent != NULL)
     {
         pEvent->pEventManager = pEventManager;
@@ -2831,7 +2837,7 @@ void draudio_delete_event_dsound(draudio_event_dsound* pEvent)
 
 
     // At this point everything has been closed so we can safely free the memory and return.
-    free(pEvent);
+    DRAUDIO_FREE(pEvent);
 }
 
 
@@ -3261,7 +3267,7 @@ void draudio_delete_context_dsound(draudio_context* pContext)
     draudio_uninit_message_queue_dsound(&pContextDS->messageQueue);
 
     FreeLibrary(pContextDS->hDSoundDLL);
-    free(pContextDS);
+    DRAUDIO_FREE(pContextDS);
 }
 
 
@@ -3367,7 +3373,7 @@ draudio_device* draudio_create_output_device_dsound(draudio_context* pContext, u
     }
 
 
-    draudio_device_dsound* pDeviceDS = malloc(sizeof(draudio_device_dsound));
+    draudio_device_dsound* pDeviceDS = DRAUDIO_MALLOC(sizeof(draudio_device_dsound));
     if (pDeviceDS != NULL)
     {
         pDeviceDS->base.pContext    = pContext;
@@ -3409,7 +3415,7 @@ void draudio_delete_output_device_dsound(draudio_device* pDevice)
     IDirectSound3DListener_Release(pDeviceDS->pDSListener);
     IDirectSoundBuffer_Release(pDeviceDS->pDSPrimaryBuffer);
     IDirectSound_Release(pDeviceDS->pDS);
-    free(pDeviceDS);
+    DRAUDIO_FREE(pDeviceDS);
 #endif
 }
 
@@ -3520,7 +3526,7 @@ draudio_buffer* draudio_create_buffer_dsound(draudio_device* pDevice, draudio_bu
     }
 
 
-    draudio_buffer_dsound* pBufferDS = malloc(sizeof(draudio_buffer_dsound) - sizeof(pBufferDS->pExtraData) + extraDataSize);
+    draudio_buffer_dsound* pBufferDS = DRAUDIO_MALLOC(sizeof(draudio_buffer_dsound) - sizeof(pBufferDS->pExtraData) + extraDataSize);
     if (pBufferDS == NULL) {
         IDirectSound3DBuffer_Release(pDSBuffer3D);
         IDirectSoundBuffer8_Release(pDSBuffer);
@@ -3584,7 +3590,7 @@ void draudio_delete_buffer_dsound(draudio_buffer* pBuffer)
         IDirectSoundBuffer8_Release(pBufferDS->pDSBuffer);
     }
 
-    free(pBufferDS);
+    DRAUDIO_FREE(pBufferDS);
 #endif
 }
 
@@ -4179,7 +4185,7 @@ draudio_context* draudio_create_context_dsound()
 
 
     // At this point we can almost certainly assume DirectSound is usable so we'll now go ahead and create the context.
-    draudio_context_dsound* pContext = malloc(sizeof(draudio_context_dsound));
+    draudio_context_dsound* pContext = DRAUDIO_MALLOC(sizeof(draudio_context_dsound));
     if (pContext != NULL)
     {
         pContext->base.delete_context             = draudio_delete_context_dsound;
@@ -4235,7 +4241,7 @@ draudio_context* draudio_create_context_dsound()
         {
             // Failed to initialize the event manager.
             FreeLibrary(hDSoundDLL);
-            free(pContext);
+            DRAUDIO_FREE(pContext);
 
             return NULL;
         }
@@ -331,6 +331,12 @@ drflac* drflac_open_memory(const void* data, size_t dataSize);
 #include <string.h>
 #include <assert.h>
 
+// Define these to use a custom allocator. They must all be defined together.
+#ifndef DRFLAC_MALLOC
+#define DRFLAC_MALLOC(sz)           malloc((sz))
+#define DRFLAC_FREE(p)              free((p))
+#endif
+
 #ifdef _MSC_VER
 #include <intrin.h>     // For _byteswap_ulong and _byteswap_uint64
 #endif
@@ -492,7 +498,7 @@ static bool drflac__on_seek_memory(void* pUserData, int offset)
 
 drflac* drflac_open_memory(const void* data, size_t dataSize)
 {
-    drflac_memory* pUserData = malloc(sizeof(*pUserData));
+    drflac_memory* pUserData = DRFLAC_MALLOC(sizeof(*pUserData));
     if (pUserData == NULL) {
         return false;
     }
@@ -2552,7 +2558,7 @@ drflac* drflac_open(drflac_read_proc onRead, drflac_seek_proc onSeek, void* user
     // At this point we should be sitting right at the start of the very first frame.
     tempFlac.firstFramePos = drflac__tell(&tempFlac);
 
-    drflac* pFlac = malloc(sizeof(*pFlac) - sizeof(pFlac->pExtraData) + (tempFlac.maxBlockSize * tempFlac.channels * sizeof(int32_t)));
+    drflac* pFlac = DRFLAC_MALLOC(sizeof(*pFlac) - sizeof(pFlac->pExtraData) + (tempFlac.maxBlockSize * tempFlac.channels * sizeof(int32_t)));
     memcpy(pFlac, &tempFlac, sizeof(tempFlac) - sizeof(pFlac->pExtraData));
     pFlac->pDecodedSamples = (int32_t*)pFlac->pExtraData;
 
@@ -2575,7 +2581,7 @@ void drflac_close(drflac* pFlac)
 
     // If we opened the file with drflac_open_memory() we will want to free() the user data.
     if (pFlac->onRead == drflac__on_read_memory) {
-        free(pFlac->userData);
+        DRFLAC_FREE(pFlac->userData);
     }
 }
 
@@ -87,20 +87,29 @@
 // #define DR_FS_NO_MTL
 //   Disable support for Wavefront MTL files.
 //
+// #define DR_FS_NO_FAST_INFLATE
+//   Disable the wide bit buffer fast path used when inflating Zip files. Decompression will always use the original
+//   byte-at-a-time loop from miniz. This is mainly useful for benchmarking and for tracking down decompression bugs.
+//
 //
 //
 // THREAD SAFETY
 //
 // dr_fs is not fully thread safe. Known unsafe functionality includes:
-// - Opening a file while adding or removing base directories and backends
 // - Closing a file while doing anything on that file object
-//   - drfs_open() will malloc() the drfs_file object, and drfs_close() will free() it with no garbage collection
-//     nor reference counting.
+//   - drfs_open() will take the drfs_file object from the context's pool, and drfs_close() will return it with no
+//     garbage collection nor reference counting.
+// - Using the string returned by drfs_get_base_directory_by_index() while base directories are being changed on
+//   another thread.
+//
+// The context itself is protected by a reader-writer lock. Opening files, getting file info, iterating and the other
+// path resolution APIs take a shared lock which means any number of threads can open files at the same time without
+// blocking each other. Adding or removing base directories, mount points and backends and changing the write directory
+// take an exclusive lock and will wait for any in-progress opens to finish. Only the path resolution is done inside the
+// lock - once a file is opened, reading and writing it does not touch the context.
 //
-// The issues mentioned above should not be an issue for the vast majority of cases. Base directories and backends
-// will typically be registered once during initialization when the context is created, and it's unlikely an
-// application will want to close a file while simultaneously trying to use it on another thread without doing it's
-// own synchronization anyway.
+// Mounted archives are reference counted so a mount point can be removed while files opened through it are still
+// open. The archive is closed when the last of those files are closed.
 //
 // Thread-safety has not been completely ignored either. It is possible to read, write and seek on multiple threads.
 // In this case it is a simple matter of first-in first-served. Also, APIs are in place to allow an application to
@@ -145,6 +154,12 @@
 //   file included in the .c file. This ensures the _LARGEFILE64_SOURCE macro is defined before any other header file
 //   as required for the use of 64-bit variants of the POSIX APIs.
 // - Base paths must be absolute and verbose.
+// - Files opened with DRFS_COMPRESSED are written as gzip streams and transparently decompressed when read back. Files
+//   that are not compressed are read as-is, so the flag can always be used when reading. Compressed files must be opened
+//   for either reading or writing, not both, and can only be written sequentially. Seeking backwards while reading is
+//   supported, but slow since decompression needs to restart from the beginning. Compression requires the Zip backend.
+// - Mount points are searched before base directories. Use mount points for layering patches and mods on top of the
+//   main game data since the cost of a lookup does not increase with the number of mount points.
 //
 //
 //
@@ -198,6 +213,7 @@ extern "C" {
 #define DRFS_EXISTING    (1 << 2)
 #define DRFS_TRUNCATE    (1 << 3)
 #define DRFS_CREATE_DIRS (1 << 4)    // Creates the directory structure if required.
+#define DRFS_COMPRESSED  (1 << 5)    // Reads and writes the file as a compressed stream. See notes at the top of this file.
 
 #define DRFS_FILE_ATTRIBUTE_DIRECTORY    0x00000001
 #define DRFS_FILE_ATTRIBUTE_READONLY     0x00000002
@@ -319,7 +335,8 @@ drfs_context* drfs_create_context();
 
 // Deletes the given context.
 //
-// This does not close any files or archives - it is up to the application to ensure those are tidied up.
+// This does not close any files or archives - it is up to the application to ensure those are tidied up. Files and archives
+// are allocated from pools owned by the context so they must all be closed before the context is deleted.
 void drfs_delete_context(drfs_context* pContext);
 
 
@@ -356,9 +373,39 @@ void drfs_remove_all_base_directories(drfs_context* pContext);
 unsigned int drfs_get_base_directory_count(drfs_context* pContext);
 
 // Retrieves the base directory at the given index.
+//
+// The returned string is owned by the context and will be invalidated when base directories are added or removed.
 const char* drfs_get_base_directory_by_index(drfs_context* pContext, unsigned int index);
 
 
+// Mounts a native directory or an archive file so that it's contents can be opened with relative paths.
+//
+// <absolutePath> must be an absolute, verbose path to a native directory or an archive file such as a .zip file. The
+// archive is kept open until the mount point is removed.
+//
+// When the same relative path exists in more than one mount point, the one with the highest priority is used. Mount points
+// of equal priority favour the one that was mounted last which means patches can simply be mounted after the content they
+// replace. For example, mounting "base.zip", then "patch1.zip", then "mods" will have files in "mods" override those in
+// "patch1.zip" which in turn override those in "base.zip".
+//
+// The contents of the mount point are indexed when it is mounted. Files that are added to a mounted directory afterwards
+// will not be visible through the mount point. Archives that are nested inside a mount point are not searched - mount
+// them explicitly instead.
+drfs_result drfs_mount(drfs_context* pContext, const char* absolutePath, int priority);
+
+// Removes the mount point that was created with the given path.
+//
+// Files that were opened through the mount point will continue to work, and the archive will be closed when the last
+// of them are closed.
+drfs_result drfs_unmount(drfs_context* pContext, const char* absolutePath);
+
+// Removes every mount point from the given context.
+void drfs_unmount_all(drfs_context* pContext);
+
+// Retrieves the number of mount points attached to the given context.
+unsigned int drfs_get_mount_count(drfs_context* pContext);
+
+
 // Sets the base directory for write operations (including delete).
 //
 // When doing a write operation using a relative path, the full path will be resolved using this directory as the base.
@@ -566,6 +613,15 @@ bool drfs_open_and_write_binary_file(drfs_context* pContext, const char* absolut
 // Helper function for opening a file, writing the given textual data, and then closing it. This deletes the contents of the existing file, if any.
 bool drfs_open_and_write_text_file(drfs_context* pContext, const char* absoluteOrRelativePath, const char* pTextData);
 
+// Same as drfs_open_and_write_binary_file(), except the data is compressed. Use this for save files and caches.
+bool drfs_open_and_write_compressed_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, const void* pData, size_t dataSize);
+
+// Same as drfs_open_and_read_binary_file(), except the data is decompressed if it was written with DRFS_COMPRESSED. Files
+// that are not compressed are returned as-is.
+//
+// Free the returned pointer with drfs_free()
+void* drfs_open_and_read_compressed_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, size_t* pSizeInBytesOut);
+
 
 // Helper function for determining whether or not the given path refers to an existing file or directory.
 bool drfs_exists(drfs_context* pContext, const char* absoluteOrRelativePath);
@@ -607,17 +663,97 @@ bool drfs_eof(drfs_file* pFile);
 #include <string.h>
 #include <assert.h>
 
+// Define these to use a custom allocator. They must all be defined together.
+#ifndef DRFS_MALLOC
+#define DRFS_MALLOC(sz)             malloc((sz))
+#define DRFS_CALLOC(count, sz)      calloc((count), (sz))
+#define DRFS_REALLOC(p, sz)         realloc((p), (sz))
+#define DRFS_FREE(p)                free((p))
+#endif
+
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <strings.h>
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #endif
 
 // Whether or not the file owns the archive object it's part of.
 #define DR_FS_OWNS_PARENT_ARCHIVE       0x00000001
 
+static long drfs__atomic_increment(volatile long* pValue)
+{
+#ifdef _WIN32
+    return InterlockedIncrement(pValue);
+#else
+    return __sync_add_and_fetch(pValue, 1);
+#endif
+}
+
+static long drfs__atomic_decrement(volatile long* pValue)
+{
+#ifdef _WIN32
+    return InterlockedDecrement(pValue);
+#else
+    return __sync_sub_and_fetch(pValue, 1);
+#endif
+}
+
+// Sets *pValue to <desired> if it is equal to <expected>. Returns the previous value.
+static long drfs__atomic_compare_exchange(volatile long* pValue, long expected, long desired)
+{
+#ifdef _WIN32
+    return InterlockedCompareExchange(pValue, desired, expected);
+#else
+    return __sync_val_compare_and_swap(pValue, expected, desired);
+#endif
+}
+
+static long drfs__atomic_load(volatile long* pValue)
+{
+#if defined(_WIN32)
+    return InterlockedCompareExchange(pValue, 0, 0);
+#elif defined(__ATOMIC_ACQUIRE)
+    return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+#else
+    return __sync_val_compare_and_swap(pValue, 0, 0);
+#endif
+}
+
+static void drfs__atomic_store(volatile long* pValue, long value)
+{
+#if defined(_WIN32)
+    InterlockedExchange(pValue, value);
+#elif defined(__ATOMIC_RELEASE)
+    __atomic_store_n(pValue, value, __ATOMIC_RELEASE);
+#else
+    __sync_synchronize();
+    *pValue = value;
+    __sync_synchronize();
+#endif
+}
+
+// A spinlock for protecting very short critical sections such as pushing and popping a free list.
+static void drfs__spinlock_lock(volatile long* pLock)
+{
+    while (drfs__atomic_compare_exchange(pLock, 0, 1) != 0) {
+        while (drfs__atomic_load(pLock) != 0) {
+#ifdef _WIN32
+            YieldProcessor();
+#else
+            sched_yield();
+#endif
+        }
+    }
+}
+
+static void drfs__spinlock_unlock(volatile long* pLock)
+{
+    drfs__atomic_store(pLock, 0);
+}
+
 
 static int drfs__strcpy_s(char* dst, size_t dstSizeInBytes, const char* src)
 {
@@ -827,7 +963,7 @@ static void drfs_basedirs_uninit(drfs_basedirs* pBasePaths)
         return;
     }
 
-    free(pBasePaths->pBuffer);
+    DRFS_FREE(pBasePaths->pBuffer);
 }
 
 static bool drfs_basedirs_inflateandinsert(drfs_basedirs* pBasePaths, const char* absolutePath, unsigned int index)
@@ -839,7 +975,7 @@ static bool drfs_basedirs_inflateandinsert(drfs_basedirs* pBasePaths, const char
     unsigned int newBufferSize = (pBasePaths->bufferSize == 0) ? 2 : pBasePaths->bufferSize*2;
 
     drfs_basepath* pOldBuffer = pBasePaths->pBuffer;
-    drfs_basepath* pNewBuffer = malloc(newBufferSize * sizeof(drfs_basepath));
+    drfs_basepath* pNewBuffer = DRFS_MALLOC(newBufferSize * sizeof(drfs_basepath));
     if (pNewBuffer == NULL) {
         return false;
     }
@@ -859,7 +995,7 @@ static bool drfs_basedirs_inflateandinsert(drfs_basedirs* pBasePaths, const char
     pBasePaths->bufferSize = newBufferSize;
     pBasePaths->count     += 1;
 
-    free(pOldBuffer);
+    DRFS_FREE(pOldBuffer);
     return true;
 }
 
@@ -954,7 +1090,7 @@ static void drfs_callbacklist_uninit(drfs_callbacklist* pList)
         return;
     }
 
-    free(pList->pBuffer);
+    DRFS_FREE(pList->pBuffer);
 }
 
 static bool drfs_callbacklist_inflate(drfs_callbacklist* pList)
@@ -964,7 +1100,7 @@ static bool drfs_callbacklist_inflate(drfs_callbacklist* pList)
     }
 
     drfs_archive_callbacks* pOldBuffer = pList->pBuffer;
-    drfs_archive_callbacks* pNewBuffer = malloc((pList->count + 1) * sizeof(drfs_archive_callbacks));
+    drfs_archive_callbacks* pNewBuffer = DRFS_MALLOC((pList->count + 1) * sizeof(drfs_archive_callbacks));
     if (pNewBuffer == NULL) {
         return false;
     }
@@ -975,7 +1111,7 @@ static bool drfs_callbacklist_inflate(drfs_callbacklist* pList)
 
     pList->pBuffer = pNewBuffer;
 
-    free(pOldBuffer);
+    DRFS_FREE(pOldBuffer);
     return true;
 }
 
@@ -996,1495 +1132,1564 @@ static bool drfs_callbacklist_pushback(drfs_callbacklist* pList, drfs_archive_ca
 }
 
 
-struct drfs_context
+typedef struct
 {
-    // The list of archive callbacks which are used for loading non-native archives. This does not include the native callbacks.
-    drfs_callbacklist archiveCallbacks;
+    // The archive that was opened for the mount point. This is kept open until the mount point is removed.
+    drfs_archive* pArchive;
 
-    // The list of base directories.
-    drfs_basedirs baseDirectories;
+    // The priority of the mount point. When a file exists in more than one mount point, the one with the higher priority wins.
+    int priority;
 
-    // The write base directory.
-    char writeBaseDirectory[DRFS_MAX_PATH];
+    // The order in which the mount point was added. This is used to break ties between mount points of the same priority.
+    unsigned int sequence;
 
-    // Keeps track of whether or not write directory guard is enabled.
-    bool isWriteGuardEnabled;
-};
+} drfs_mountpoint;
 
-struct drfs_archive
+typedef struct
 {
-    // A pointer to the context that owns this archive.
-    drfs_context* pContext;
-
-    // A pointer to the archive that contains this archive. This can be null in which case it is the top level archive (which is always native).
-    drfs_archive* pParentArchive;
-
-    // A pointer to the file containing the data of the archive file.
-    drfs_file* pFile;
-
-    // The internal handle that was returned when the archive was opened by the archive definition.
-    drfs_handle internalArchiveHandle;
+    // The hash of the path. A hash of 0 means the slot is empty.
+    uint32_t hash;
 
-    // Flags. Can be a combination of the following:
-    //   DR_FS_OWNS_PARENT_ARCHIVE
-    int flags;
+    // The index of the mount point that owns the winning copy of the file.
+    unsigned int mountIndex;
 
-    // The callbacks to use when working with on the archive. This contains all of the functions for opening files, reading
-    // files, etc.
-    drfs_archive_callbacks callbacks;
+    // The offset of the path within the path pool.
+    size_t pathOffset;
 
-    // The absolute, verbose path of the archive. For native archives, this will be the name of the folder on the native file
-    // system. For non-native archives (zip, etc.) this is the the path of the archive file.
-    char absolutePath[DRFS_MAX_PATH];    // Change this to char absolutePath[1] and have it sized exactly as needed.
-};
+} drfs_mountslot;
 
-struct drfs_file
+typedef struct
 {
-    // A pointer to the archive that contains the file. This should never be null. Retrieve a pointer to the contex from this
-    // by doing pArchive->pContext. The file containing the archive's raw data can be retrieved with pArchive->pFile.
-    drfs_archive* pArchive;
+    // A pointer to the buffer containing the list of mount points.
+    drfs_mountpoint* pMounts;
 
-    // The internal file handle for use by the archive that owns it.
-    drfs_handle internalFileHandle;
+    // The size of the mount point buffer, in drfs_mountpoint's.
+    unsigned int bufferSize;
 
+    // The number of mount points in the list.
+    unsigned int count;
 
-    // Flags. Can be a combination of the following:
-    //   DR_FS_OWNS_PARENT_ARCHIVE
-    int flags;
+    // The sequence number to assign to the next mount point.
+    unsigned int nextSequence;
 
 
-    // The critical section for locking and unlocking files.
-#ifdef _WIN32
-    CRITICAL_SECTION lock;
-#else
-    pthread_mutex_t lock;
-#endif
-};
+    // The merged index mapping a relative path to the mount point that owns it. This is an open addressing hash table
+    // using linear probing. The slot count is always 0 or a power of 2.
+    drfs_mountslot* pSlots;
 
+    // The number of slots in the index.
+    unsigned int slotCount;
 
-//// Path Manipulation ////
-//
-// Functionality below is taken straight from dr_path, but namespaced as "drfs" to avoid naming conflicts.
+    // The number of slots that are in use.
+    unsigned int usedSlotCount;
 
-// Structure representing a section of a path.
-typedef struct
-{
-    size_t offset;
-    size_t length;
+    // The buffer containing the null terminated path of every entry in the index.
+    char* pPathPool;
 
-} drfs_drpath_segment;
+    // The number of bytes used in the path pool.
+    size_t pathPoolSize;
 
-// Structure used for iterating over a path while at the same time providing useful and easy-to-use information about the iteration.
-typedef struct drfs_drpath_iterator
-{
-    const char* path;
-    drfs_drpath_segment segment;
+    // The capacity of the path pool, in bytes.
+    size_t pathPoolCapacity;
 
-} drfs_drpath_iterator;
+} drfs_mountlist;
 
-static bool drfs_drpath_next(drfs_drpath_iterator* i)
+static bool drfs_mountlist_init(drfs_mountlist* pList)
 {
-    if (i == NULL || i->path == NULL) {
+    if (pList == NULL) {
         return false;
     }
 
-    i->segment.offset = i->segment.offset + i->segment.length;
-    i->segment.length = 0;
+    memset(pList, 0, sizeof(*pList));
+    return true;
+}
 
-    while (i->path[i->segment.offset] != '\0' && (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\')) {
-        i->segment.offset += 1;
+static void drfs_mountlist_uninit(drfs_mountlist* pList)
+{
+    if (pList == NULL) {
+        return;
     }
 
-    if (i->path[i->segment.offset] == '\0') {
-        return false;
+    for (unsigned int i = 0; i < pList->count; ++i) {
+        drfs_close_archive(pList->pMounts[i].pArchive);
     }
 
+    DRFS_FREE(pList->pMounts);
+    DRFS_FREE(pList->pSlots);
+    DRFS_FREE(pList->pPathPool);
+}
 
-    while (i->path[i->segment.offset + i->segment.length] != '\0' && (i->path[i->segment.offset + i->segment.length] != '/' && i->path[i->segment.offset + i->segment.length] != '\\')) {
-        i->segment.length += 1;
+// Hashes a relative path with FNV-1a. Back slashes are treated the same as forward slashes. This never returns 0.
+static uint32_t drfs_mountlist_hash(const char* path)
+{
+    assert(path != NULL);
+
+    uint32_t hash = 2166136261u;
+    for (const char* c = path; *c != '\0'; ++c) {
+        hash ^= (*c == '\\') ? '/' : (unsigned char)*c;
+        hash *= 16777619u;
     }
 
-    return true;
+    return (hash == 0) ? 1 : hash;
 }
 
-static bool drfs_drpath_prev(drfs_drpath_iterator* i)
+static bool drfs_mountlist_paths_equal(const char* path1, const char* path2)
 {
-    if (i == NULL || i->path == NULL || i->segment.offset == 0) {
-        return false;
-    }
-
-    i->segment.length = 0;
+    assert(path1 != NULL);
+    assert(path2 != NULL);
 
-    do
+    for (;;)
     {
-        i->segment.offset -= 1;
-    } while (i->segment.offset > 0 && (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\'));
+        char c1 = (*path1 == '\\') ? '/' : *path1;
+        char c2 = (*path2 == '\\') ? '/' : *path2;
+        if (c1 != c2) {
+            return false;
+        }
 
-    if (i->segment.offset == 0) {
-        if (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\') {
-            i->segment.length = 0;
+        if (c1 == '\0') {
             return true;
         }
 
-        return false;
+        path1 += 1;
+        path2 += 1;
     }
+}
 
+// Determines whether or not the first mount point should win over the second when they both contain the same file.
+static bool drfs_mountlist_outranks(drfs_mountlist* pList, unsigned int mountIndex1, unsigned int mountIndex2)
+{
+    assert(pList != NULL);
 
-    size_t offsetEnd = i->segment.offset + 1;
-    while (i->segment.offset > 0 && (i->path[i->segment.offset] != '/' && i->path[i->segment.offset] != '\\')) {
-        i->segment.offset -= 1;
+    const drfs_mountpoint* pMount1 = pList->pMounts + mountIndex1;
+    const drfs_mountpoint* pMount2 = pList->pMounts + mountIndex2;
+    if (pMount1->priority != pMount2->priority) {
+        return pMount1->priority > pMount2->priority;
     }
 
-    if (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\') {
-        i->segment.offset += 1;
-    }
+    return pMount1->sequence > pMount2->sequence;
+}
 
+// Finds the slot for the given path. If the path is not in the index, the empty slot it would be placed in is returned.
+static drfs_mountslot* drfs_mountlist_find_slot(drfs_mountlist* pList, const char* path, uint32_t hash)
+{
+    assert(pList != NULL);
+    assert(pList->slotCount > 0);
 
-    i->segment.length = offsetEnd - i->segment.offset;
+    unsigned int mask = pList->slotCount - 1;
+    for (unsigned int iSlot = hash & mask; ; iSlot = (iSlot + 1) & mask)
+    {
+        drfs_mountslot* pSlot = pList->pSlots + iSlot;
+        if (pSlot->hash == 0) {
+            return pSlot;
+        }
 
-    return true;
+        if (pSlot->hash == hash && drfs_mountlist_paths_equal(pList->pPathPool + pSlot->pathOffset, path)) {
+            return pSlot;
+        }
+    }
 }
 
-static bool drfs_drpath_first(const char* path, drfs_drpath_iterator* i)
+static bool drfs_mountlist_grow_index(drfs_mountlist* pList)
 {
-    if (path == 0 || path[0] == '\0' || i == 0) {
+    assert(pList != NULL);
+
+    unsigned int newSlotCount = (pList->slotCount == 0) ? 256 : pList->slotCount*2;
+    drfs_mountslot* pNewSlots = DRFS_CALLOC(newSlotCount, sizeof(*pNewSlots));
+    if (pNewSlots == NULL) {
         return false;
     }
 
-    i->path = path;
-    i->segment.offset = 0;
-    i->segment.length = 0;
+    drfs_mountslot* pOldSlots = pList->pSlots;
+    unsigned int oldSlotCount = pList->slotCount;
 
-    while (i->path[i->segment.length] != '\0' && (i->path[i->segment.length] != '/' && i->path[i->segment.length] != '\\')) {
-        i->segment.length += 1;
+    pList->pSlots    = pNewSlots;
+    pList->slotCount = newSlotCount;
+
+    for (unsigned int iSlot = 0; iSlot < oldSlotCount; ++iSlot) {
+        if (pOldSlots[iSlot].hash != 0) {
+            *drfs_mountlist_find_slot(pList, pList->pPathPool + pOldSlots[iSlot].pathOffset, pOldSlots[iSlot].hash) = pOldSlots[iSlot];
+        }
     }
 
+    DRFS_FREE(pOldSlots);
     return true;
 }
 
-static bool drfs_drpath_last(const char* path, drfs_drpath_iterator* i)
+// Adds a path to the index. If the path is already owned by another mount point, ownership is only transferred if the new
+// mount point outranks it.
+static bool drfs_mountlist_add_path(drfs_mountlist* pList, const char* path, unsigned int mountIndex)
 {
-    if (path == 0 || path[0] == '\0' || i == 0) {
-        return false;
+    assert(pList != NULL);
+    assert(path != NULL);
+
+    // The index is kept at a load factor of at most 0.5 so that probe sequences stay short.
+    if ((pList->usedSlotCount + 1) * 2 > pList->slotCount) {
+        if (!drfs_mountlist_grow_index(pList)) {
+            return false;
+        }
     }
 
-    i->path = path;
-    i->segment.offset = strlen(path);
-    i->segment.length = 0;
+    uint32_t hash = drfs_mountlist_hash(path);
+    drfs_mountslot* pSlot = drfs_mountlist_find_slot(pList, path, hash);
+    if (pSlot->hash != 0) {
+        if (drfs_mountlist_outranks(pList, mountIndex, pSlot->mountIndex)) {
+            pSlot->mountIndex = mountIndex;
+        }
 
-    return drfs_drpath_prev(i);
+        return true;
+    }
+
+
+    size_t pathLength = strlen(path) + 1;
+    if (pList->pathPoolSize + pathLength > pList->pathPoolCapacity)
+    {
+        size_t newCapacity = (pList->pathPoolCapacity == 0) ? 4096 : pList->pathPoolCapacity*2;
+        while (newCapacity < pList->pathPoolSize + pathLength) {
+            newCapacity *= 2;
+        }
+
+        char* pNewPathPool = DRFS_REALLOC(pList->pPathPool, newCapacity);
+        if (pNewPathPool == NULL) {
+            return false;
+        }
+
+        pList->pPathPool        = pNewPathPool;
+        pList->pathPoolCapacity = newCapacity;
+    }
+
+    memcpy(pList->pPathPool + pList->pathPoolSize, path, pathLength);
+
+    pSlot->hash       = hash;
+    pSlot->mountIndex = mountIndex;
+    pSlot->pathOffset = pList->pathPoolSize;
+
+    pList->pathPoolSize  += pathLength;
+    pList->usedSlotCount += 1;
+
+    return true;
 }
 
-static bool drfs_drpath_segments_equal(const char* s0Path, const drfs_drpath_segment s0, const char* s1Path, const drfs_drpath_segment s1)
+// Finds the mount point that owns the file at the given relative path. Returns the path as it's stored in the mount point,
+// or NULL if the path is not in any mount point.
+static const char* drfs_mountlist_find(drfs_mountlist* pList, const char* path, unsigned int* pMountIndexOut)
 {
-    if (s0Path == NULL || s1Path == NULL) {
-        return false;
+    assert(pList != NULL);
+    assert(path != NULL);
+    assert(pMountIndexOut != NULL);
+
+    if (pList->usedSlotCount == 0) {
+        return NULL;
     }
 
-    if (s0.length != s1.length) {
-        return false;
+    drfs_mountslot* pSlot = drfs_mountlist_find_slot(pList, path, drfs_mountlist_hash(path));
+    if (pSlot->hash == 0) {
+        return NULL;
     }
 
-    return strncmp(s0Path + s0.offset, s1Path + s1.offset, s0.length) == 0;
+    *pMountIndexOut = pSlot->mountIndex;
+    return pList->pPathPool + pSlot->pathOffset;
 }
 
-static bool drfs_drpath_iterators_equal(const drfs_drpath_iterator i0, const drfs_drpath_iterator i1)
+static void drfs_mountlist_clear_index(drfs_mountlist* pList)
 {
-    return drfs_drpath_segments_equal(i0.path, i0.segment, i1.path, i1.segment);
+    assert(pList != NULL);
+
+    if (pList->pSlots != NULL) {
+        memset(pList->pSlots, 0, pList->slotCount * sizeof(*pList->pSlots));
+    }
+
+    pList->usedSlotCount = 0;
+    pList->pathPoolSize  = 0;
 }
 
-static bool drfs_drpath_is_linux_style_root_segment(const drfs_drpath_iterator i)
+static bool drfs_mountlist_pushback(drfs_mountlist* pList, drfs_archive* pArchive, int priority)
 {
-    if (i.path == NULL) {
-        return false;
-    }
+    assert(pList != NULL);
+    assert(pArchive != NULL);
 
-    if (i.segment.offset == 0 && i.segment.length == 0) {
-        return true;    // "/" style root.
+    if (pList->count == pList->bufferSize)
+    {
+        unsigned int newBufferSize = (pList->bufferSize == 0) ? 4 : pList->bufferSize*2;
+        drfs_mountpoint* pNewMounts = DRFS_REALLOC(pList->pMounts, newBufferSize * sizeof(*pNewMounts));
+        if (pNewMounts == NULL) {
+            return false;
+        }
+
+        pList->pMounts    = pNewMounts;
+        pList->bufferSize = newBufferSize;
     }
 
-    return false;
+    pList->pMounts[pList->count].pArchive = pArchive;
+    pList->pMounts[pList->count].priority = priority;
+    pList->pMounts[pList->count].sequence = pList->nextSequence++;
+    pList->count += 1;
+
+    return true;
 }
 
-static bool drfs_drpath_is_win32_style_root_segment(const drfs_drpath_iterator i)
+// Removes the mount point at the given index and closes it's archive. The index needs to be rebuilt after calling this.
+static void drfs_mountlist_remove(drfs_mountlist* pList, unsigned int index)
 {
-    if (i.path == NULL) {
-        return false;
-    }
+    assert(pList != NULL);
+    assert(index < pList->count);
 
-    if (i.segment.offset == 0 && i.segment.length == 2) {
-        if (((i.path[0] >= 'a' && i.path[0] <= 'z') || (i.path[0] >= 'A' && i.path[0] <= 'Z')) && i.path[1] == ':') {
-            return true;
-        }
+    drfs_close_archive(pList->pMounts[index].pArchive);
+
+    for (unsigned int iDst = index; iDst < pList->count - 1; ++iDst) {
+        pList->pMounts[iDst] = pList->pMounts[iDst + 1];
     }
 
-    return false;
+    pList->count -= 1;
 }
 
-static bool drfs_drpath_is_root_segment(const drfs_drpath_iterator i)
+
+// A thread-safe free list of fixed size objects. Objects are allocated from the heap in chunks and are not returned to it
+// until the pool is uninitialized, which means that once a pool has warmed up, allocating and freeing an object is just a
+// push or pop on the free list. Chunks are zero-initialized the first time they are allocated, but objects coming off the
+// free list keep whatever was left in them apart from the first pointer-sized field which is used for the link.
+typedef struct drfs_pool_chunk drfs_pool_chunk;
+struct drfs_pool_chunk
 {
-    return drfs_drpath_is_linux_style_root_segment(i) || drfs_drpath_is_win32_style_root_segment(i);
-}
+    // The next chunk in the pool.
+    drfs_pool_chunk* pNext;
 
-static bool drfs_drpath_append_iterator(char* base, size_t baseBufferSizeInBytes, drfs_drpath_iterator i)
-{
-    if (base == NULL) {
-        return false;
-    }
+    // Pads the header so that the objects that follow it are aligned.
+    void* padding;
+};
 
-    size_t path1Length = strlen(base);
-    size_t path2Length = i.segment.length;
+typedef struct
+{
+    // The size of each object, rounded up for alignment.
+    size_t objectSize;
 
-    if (path1Length >= baseBufferSizeInBytes) {
-        return false;
-    }
+    // The number of objects to allocate at a time when the free list is empty.
+    unsigned int objectsPerChunk;
 
-    if (drfs_drpath_is_linux_style_root_segment(i)) {
-        if (baseBufferSizeInBytes > 1) {
-            base[0] = '/';
-            base[1] = '\0';
-            return true;
-        }
-    }
+    // The first object in the free list. Each free object stores a pointer to the next one in it's first bytes.
+    void* pFreeList;
 
+    // Every chunk that has been allocated for the pool.
+    drfs_pool_chunk* pChunks;
 
-    // Slash.
-    if (path1Length > 0 && base[path1Length - 1] != '/' && base[path1Length - 1] != '\\') {
-        base[path1Length] = '/';
-        path1Length += 1;
-    }
+    // The spinlock protecting the free list and chunk list.
+    volatile long lock;
 
-    // Other part.
-    if (path1Length + path2Length >= baseBufferSizeInBytes) {
-        path2Length = baseBufferSizeInBytes - path1Length - 1;      // -1 for the null terminator.
-    }
+} drfs_pool;
 
-    drfs__strncpy_s(base + path1Length, baseBufferSizeInBytes - path1Length, i.path + i.segment.offset, path2Length);
+static void drfs_pool_init(drfs_pool* pPool, size_t objectSize, unsigned int objectsPerChunk)
+{
+    assert(pPool != NULL);
+    assert(objectSize >= sizeof(void*));
+    assert(objectsPerChunk > 0);
 
-    return true;
+    pPool->objectSize      = (objectSize + sizeof(drfs_pool_chunk) - 1) & ~(sizeof(drfs_pool_chunk) - 1);
+    pPool->objectsPerChunk = objectsPerChunk;
+    pPool->pFreeList       = NULL;
+    pPool->pChunks         = NULL;
+    pPool->lock            = 0;
 }
 
-static bool drfs_drpath_is_descendant(const char* descendantAbsolutePath, const char* parentAbsolutePath)
+// Frees every chunk in the pool. <onDestroy> is called for every object that has ever been allocated from the pool whether
+// or not it's currently in use, and is mainly for tearing down resources that are kept alive across reuse. It can be null.
+static void drfs_pool_uninit(drfs_pool* pPool, void (* onDestroy)(void* pObject))
 {
-    drfs_drpath_iterator iChild;
-    if (!drfs_drpath_first(descendantAbsolutePath, &iChild)) {
-        return false;   // The descendant is an empty string which makes it impossible for it to be a descendant.
-    }
+    assert(pPool != NULL);
 
-    drfs_drpath_iterator iParent;
-    if (drfs_drpath_first(parentAbsolutePath, &iParent))
+    drfs_pool_chunk* pChunk = pPool->pChunks;
+    while (pChunk != NULL)
     {
-        do
-        {
-            // If the segment is different, the paths are different and thus it is not a descendant.
-            if (!drfs_drpath_iterators_equal(iParent, iChild)) {
-                return false;
-            }
+        drfs_pool_chunk* pNextChunk = pChunk->pNext;
 
-            if (!drfs_drpath_next(&iChild)) {
-                return false;   // The descendant is shorter which means it's impossible for it to be a descendant.
+        if (onDestroy) {
+            for (unsigned int iObject = 0; iObject < pPool->objectsPerChunk; ++iObject) {
+                onDestroy((char*)(pChunk + 1) + (iObject * pPool->objectSize));
             }
+        }
 
-        } while (drfs_drpath_next(&iParent));
+        DRFS_FREE(pChunk);
+        pChunk = pNextChunk;
     }
 
-    return true;
+    pPool->pFreeList = NULL;
+    pPool->pChunks   = NULL;
 }
 
-static bool drfs_drpath_is_child(const char* childAbsolutePath, const char* parentAbsolutePath)
+static void* drfs_pool_alloc(drfs_pool* pPool)
 {
-    drfs_drpath_iterator iChild;
-    if (!drfs_drpath_first(childAbsolutePath, &iChild)) {
-        return false;   // The descendant is an empty string which makes it impossible for it to be a descendant.
-    }
+    assert(pPool != NULL);
 
-    drfs_drpath_iterator iParent;
-    if (drfs_drpath_first(parentAbsolutePath, &iParent))
+    drfs__spinlock_lock(&pPool->lock);
+
+    if (pPool->pFreeList == NULL)
     {
-        do
-        {
-            // If the segment is different, the paths are different and thus it is not a descendant.
-            if (!drfs_drpath_iterators_equal(iParent, iChild)) {
-                return false;
-            }
+        // The free list is empty so a new chunk is needed. The objects in the new chunk are linked in order.
+        drfs_pool_chunk* pChunk = DRFS_CALLOC(1, sizeof(*pChunk) + (pPool->objectsPerChunk * pPool->objectSize));
+        if (pChunk == NULL) {
+            drfs__spinlock_unlock(&pPool->lock);
+            return NULL;
+        }
 
-            if (!drfs_drpath_next(&iChild)) {
-                return false;   // The descendant is shorter which means it's impossible for it to be a descendant.
-            }
+        for (unsigned int iObject = pPool->objectsPerChunk; iObject > 0; --iObject) {
+            void** pObject = (void**)((char*)(pChunk + 1) + ((iObject - 1) * pPool->objectSize));
+            *pObject = pPool->pFreeList;
+            pPool->pFreeList = pObject;
+        }
 
-        } while (drfs_drpath_next(&iParent));
+        pChunk->pNext = pPool->pChunks;
+        pPool->pChunks = pChunk;
     }
 
-    // At this point we have finished iteration of the parent, which should be shorter one. We now do one more iterations of
-    // the child to ensure it is indeed a direct child and not a deeper descendant.
-    return !drfs_drpath_next(&iChild);
+    void** pObject = pPool->pFreeList;
+    pPool->pFreeList = *pObject;
+
+    drfs__spinlock_unlock(&pPool->lock);
+
+    *pObject = NULL;
+    return pObject;
 }
 
-static void drfs_drpath_base_path(char* path)
+static void drfs_pool_free(drfs_pool* pPool, void* pObject)
 {
-    if (path == NULL) {
+    assert(pPool != NULL);
+
+    if (pObject == NULL) {
         return;
     }
 
-    char* baseend = path;
+    drfs__spinlock_lock(&pPool->lock);
+    {
+        *(void**)pObject = pPool->pFreeList;
+        pPool->pFreeList = pObject;
+    }
+    drfs__spinlock_unlock(&pPool->lock);
+}
 
-    // We just loop through the path until we find the last slash.
-    while (path[0] != '\0') {
-        if (path[0] == '/' || path[0] == '\\') {
-            baseend = path;
-        }
 
-        path += 1;
-    }
+struct drfs_context
+{
+    // The list of archive callbacks which are used for loading non-native archives. This does not include the native callbacks.
+    drfs_callbacklist archiveCallbacks;
+
+    // The list of base directories.
+    drfs_basedirs baseDirectories;
 
+    // The list of mount points and the merged index of their contents.
+    drfs_mountlist mounts;
 
-    // Now we just loop backwards until we hit the first non-slash.
-    while (baseend > path) {
-        if (baseend[0] != '/' && baseend[0] != '\\') {
-            break;
-        }
+    // The write base directory.
+    char writeBaseDirectory[DRFS_MAX_PATH];
 
-        baseend -= 1;
-    }
+    // The pools that drfs_file and drfs_archive objects are allocated from. Native archives store their internal state in
+    // the same allocation as the drfs_archive object.
+    drfs_pool filePool;
+    drfs_pool archivePool;
 
+    // Keeps track of whether or not write directory guard is enabled.
+    bool isWriteGuardEnabled;
 
-    // We just put a null terminator on the end.
-    baseend[0] = '\0';
-}
+    // The reader-writer lock protecting everything above. Anything that resolves paths takes a shared lock and anything
+    // that changes the base directories, mount points, backends or write directory takes an exclusive lock.
+#ifdef _WIN32
+    SRWLOCK lock;
+#else
+    pthread_rwlock_t lock;
+#endif
+};
 
-static void drfs_drpath_copy_base_path(const char* path, char* baseOut, size_t baseSizeInBytes)
+struct drfs_archive
 {
-    if (path == NULL || baseOut == NULL || baseSizeInBytes == 0) {
-        return;
-    }
+    // A pointer to the context that owns this archive.
+    drfs_context* pContext;
 
-    drfs__strcpy_s(baseOut, baseSizeInBytes, path);
-    drfs_drpath_base_path(baseOut);
-}
+    // A pointer to the archive that contains this archive. This can be null in which case it is the top level archive (which is always native).
+    drfs_archive* pParentArchive;
 
-static const char* drfs_drpath_file_name(const char* path)
-{
-    if (path == NULL) {
-        return NULL;
-    }
+    // A pointer to the file containing the data of the archive file.
+    drfs_file* pFile;
 
-    const char* fileName = path;
+    // The internal handle that was returned when the archive was opened by the archive definition.
+    drfs_handle internalArchiveHandle;
 
-    // We just loop through the path until we find the last slash.
-    while (path[0] != '\0') {
-        if (path[0] == '/' || path[0] == '\\') {
-            fileName = path;
-        }
+    // Flags. Can be a combination of the following:
+    //   DR_FS_OWNS_PARENT_ARCHIVE
+    int flags;
 
-        path += 1;
-    }
+    // The number of references to the archive. This starts at 1 and is only ever incremented for mounted archives so that
+    // files opened through a mount point can outlive it. The archive is closed when this reaches 0.
+    volatile long referenceCount;
 
-    // At this point the file name is sitting on a slash, so just move forward.
-    while (fileName[0] != '\0' && (fileName[0] == '/' || fileName[0] == '\\')) {
-        fileName += 1;
-    }
+    // The callbacks to use when working with on the archive. This contains all of the functions for opening files, reading
+    // files, etc.
+    drfs_archive_callbacks callbacks;
 
-    return fileName;
-}
+    // The absolute, verbose path of the archive. For native archives, this will be the name of the folder on the native file
+    // system. For non-native archives (zip, etc.) this is the the path of the archive file.
+    char absolutePath[DRFS_MAX_PATH];    // Change this to char absolutePath[1] and have it sized exactly as needed.
+};
 
-static const char* drfs_drpath_extension(const char* path)
+struct drfs_file
 {
-    if (path == NULL) {
-        return NULL;
-    }
+    // A pointer to the archive that contains the file. This should never be null. Retrieve a pointer to the contex from this
+    // by doing pArchive->pContext. The file containing the archive's raw data can be retrieved with pArchive->pFile.
+    drfs_archive* pArchive;
 
-    const char* extension     = drfs_drpath_file_name(path);
-    const char* lastoccurance = 0;
+    // The internal file handle for use by the archive that owns it.
+    drfs_handle internalFileHandle;
 
-    // Just find the last '.' and return.
-    while (extension[0] != '\0')
-    {
-        extension += 1;
 
-        if (extension[0] == '.') {
-            extension    += 1;
-            lastoccurance = extension;
-        }
-    }
+    // Flags. Can be a combination of the following:
+    //   DR_FS_OWNS_PARENT_ARCHIVE
+    int flags;
 
-    return (lastoccurance != 0) ? lastoccurance : extension;
-}
+    // The compressed stream state for files opened with DRFS_COMPRESSED. This is null for normal files.
+    void* pCompressedStream;
 
-static bool drfs_drpath_equal(const char* path1, const char* path2)
-{
-    if (path1 == NULL || path2 == NULL) {
-        return false;
-    }
 
-    if (path1 == path2 || (path1[0] == '\0' && path2[0] == '\0')) {
-        return true;    // Two empty paths are treated as the same.
-    }
+    // The critical section for locking and unlocking files. This is initialized the first time the file is locked and is
+    // kept alive when the object goes back to the pool so that later files using the same object don't need to create it
+    // again. It's destroyed when the context is deleted.
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t lock;
+#endif
 
-    drfs_drpath_iterator iPath1;
-    drfs_drpath_iterator iPath2;
-    if (drfs_drpath_first(path1, &iPath1) && drfs_drpath_first(path2, &iPath2))
+    // The state of the lock. One of DRFS_FILE_LOCK_UNINITIALIZED, DRFS_FILE_LOCK_INITIALIZING or DRFS_FILE_LOCK_READY.
+    volatile long lockState;
+};
+
+#define DRFS_FILE_LOCK_UNINITIALIZED    0
+#define DRFS_FILE_LOCK_INITIALIZING     1
+#define DRFS_FILE_LOCK_READY            2
+
+// Initializes the lock of the given file if it hasn't been already. Returns false if the lock could not be initialized.
+static bool drfs_file_init_lock(drfs_file* pFile)
+{
+    assert(pFile != NULL);
+
+    for (;;)
     {
-        bool isPath1Valid;
-        bool isPath2Valid;
+        long lockState = drfs__atomic_load(&pFile->lockState);
+        if (lockState == DRFS_FILE_LOCK_READY) {
+            return true;
+        }
 
-        do
+        if (lockState == DRFS_FILE_LOCK_UNINITIALIZED && drfs__atomic_compare_exchange(&pFile->lockState, DRFS_FILE_LOCK_UNINITIALIZED, DRFS_FILE_LOCK_INITIALIZING) == DRFS_FILE_LOCK_UNINITIALIZED)
         {
-            if (!drfs_drpath_iterators_equal(iPath1, iPath2)) {
+#ifdef _WIN32
+            InitializeCriticalSection(&pFile->lock);
+#else
+            if (pthread_mutex_init(&pFile->lock, NULL) != 0) {
+                drfs__atomic_store(&pFile->lockState, DRFS_FILE_LOCK_UNINITIALIZED);
                 return false;
             }
+#endif
 
-            isPath1Valid = drfs_drpath_next(&iPath1);
-            isPath2Valid = drfs_drpath_next(&iPath2);
-
-        } while (isPath1Valid && isPath2Valid);
+            drfs__atomic_store(&pFile->lockState, DRFS_FILE_LOCK_READY);
+            return true;
+        }
 
-        // At this point either iPath1 and/or iPath2 have finished iterating. If both of them are at the end, the two paths are equal.
-        return isPath1Valid == isPath2Valid && iPath1.path[iPath1.segment.offset] == '\0' && iPath2.path[iPath2.segment.offset] == '\0';
+        // Another thread is initializing the lock.
+#ifdef _WIN32
+        YieldProcessor();
+#else
+        sched_yield();
+#endif
     }
-
-    return false;
 }
 
-static bool drfs_drpath_is_relative(const char* path)
+// Destroys the lock of a pooled file object. This is called for every object in the pool when the context is deleted.
+static void drfs_file_uninit_lock(void* pObject)
 {
-    if (path == NULL) {
-        return false;
-    }
+    drfs_file* pFile = pObject;
+    assert(pFile != NULL);
 
-    drfs_drpath_iterator seg;
-    if (drfs_drpath_first(path, &seg)) {
-        return !drfs_drpath_is_root_segment(seg);
+    if (pFile->lockState == DRFS_FILE_LOCK_READY) {
+#ifdef _WIN32
+        DeleteCriticalSection(&pFile->lock);
+#else
+        pthread_mutex_destroy(&pFile->lock);
+#endif
+        pFile->lockState = DRFS_FILE_LOCK_UNINITIALIZED;
     }
-
-    // We'll get here if the path is empty. We consider this to be a relative path.
-    return true;
 }
 
-static bool drfs_drpath_is_absolute(const char* path)
-{
-    return !drfs_drpath_is_relative(path);
-}
 
-static bool drfs_drpath_append(char* base, size_t baseBufferSizeInBytes, const char* other)
-{
-    if (base == NULL || other == NULL) {
-        return false;
-    }
+//// Path Manipulation ////
+//
+// Functionality below is taken straight from dr_path, but namespaced as "drfs" to avoid naming conflicts.
 
-    size_t path1Length = strlen(base);
-    size_t path2Length = strlen(other);
+// Structure representing a section of a path.
+typedef struct
+{
+    size_t offset;
+    size_t length;
 
-    if (path1Length >= baseBufferSizeInBytes) {
+} drfs_drpath_segment;
+
+// Structure used for iterating over a path while at the same time providing useful and easy-to-use information about the iteration.
+typedef struct drfs_drpath_iterator
+{
+    const char* path;
+    drfs_drpath_segment segment;
+
+} drfs_drpath_iterator;
+
+static bool drfs_drpath_next(drfs_drpath_iterator* i)
+{
+    if (i == NULL || i->path == NULL) {
         return false;
     }
 
+    i->segment.offset = i->segment.offset + i->segment.length;
+    i->segment.length = 0;
 
-    // Slash.
-    if (path1Length > 0 && base[path1Length - 1] != '/' && base[path1Length - 1] != '\\') {
-        base[path1Length] = '/';
-        path1Length += 1;
+    while (i->path[i->segment.offset] != '\0' && (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\')) {
+        i->segment.offset += 1;
     }
 
-    // Other part.
-    if (path1Length + path2Length >= baseBufferSizeInBytes) {
-        path2Length = baseBufferSizeInBytes - path1Length - 1;      // -1 for the null terminator.
+    if (i->path[i->segment.offset] == '\0') {
+        return false;
     }
 
-    drfs__strncpy_s(base + path1Length, baseBufferSizeInBytes - path1Length, other, path2Length);
-
-    return true;
-}
 
-static bool drfs_drpath_copy_and_append(char* dst, size_t dstSizeInBytes, const char* base, const char* other)
-{
-    if (dst == NULL || dstSizeInBytes == 0) {
-        return false;
+    while (i->path[i->segment.offset + i->segment.length] != '\0' && (i->path[i->segment.offset + i->segment.length] != '/' && i->path[i->segment.offset + i->segment.length] != '\\')) {
+        i->segment.length += 1;
     }
 
-    drfs__strcpy_s(dst, dstSizeInBytes, base);
-    return drfs_drpath_append(dst, dstSizeInBytes, other);
+    return true;
 }
 
-// This function recursively cleans a path which is defined as a chain of iterators. This function works backwards, which means at the time of calling this
-// function, each iterator in the chain should be placed at the end of the path.
-//
-// This does not write the null terminator, nor a leading slash for absolute paths.
-static size_t _drfs_drpath_clean_trywrite(drfs_drpath_iterator* iterators, unsigned int iteratorCount, char* pathOut, size_t pathOutSizeInBytes, unsigned int ignoreCounter)
+static bool drfs_drpath_prev(drfs_drpath_iterator* i)
 {
-    if (iteratorCount == 0) {
-        return 0;
+    if (i == NULL || i->path == NULL || i->segment.offset == 0) {
+        return false;
     }
 
-    drfs_drpath_iterator isegment = iterators[iteratorCount - 1];
-
-
-    // If this segment is a ".", we ignore it. If it is a ".." we ignore it and increment "ignoreCount".
-    int ignoreThisSegment = ignoreCounter > 0 && isegment.segment.length > 0;
+    i->segment.length = 0;
 
-    if (isegment.segment.length == 1 && isegment.path[isegment.segment.offset] == '.')
-    {
-        // "."
-        ignoreThisSegment = 1;
-    }
-    else
+    do
     {
-        if (isegment.segment.length == 2 && isegment.path[isegment.segment.offset] == '.' && isegment.path[isegment.segment.offset + 1] == '.')
-        {
-            // ".."
-            ignoreThisSegment = 1;
-            ignoreCounter += 1;
-        }
-        else
-        {
-            // It's a regular segment, so decrement the ignore counter.
-            if (ignoreCounter > 0) {
-                ignoreCounter -= 1;
-            }
+        i->segment.offset -= 1;
+    } while (i->segment.offset > 0 && (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\'));
+
+    if (i->segment.offset == 0) {
+        if (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\') {
+            i->segment.length = 0;
+            return true;
         }
-    }
 
+        return false;
+    }
 
-    // The previous segment needs to be written before we can write this one.
-    size_t bytesWritten = 0;
 
-    drfs_drpath_iterator prev = isegment;
-    if (!drfs_drpath_prev(&prev))
-    {
-        if (iteratorCount > 1)
-        {
-            iteratorCount -= 1;
-            prev = iterators[iteratorCount - 1];
-        }
-        else
-        {
-            prev.path           = NULL;
-            prev.segment.offset = 0;
-            prev.segment.length = 0;
-        }
+    size_t offsetEnd = i->segment.offset + 1;
+    while (i->segment.offset > 0 && (i->path[i->segment.offset] != '/' && i->path[i->segment.offset] != '\\')) {
+        i->segment.offset -= 1;
     }
 
-    if (prev.segment.length > 0)
-    {
-        iterators[iteratorCount - 1] = prev;
-        bytesWritten = _drfs_drpath_clean_trywrite(iterators, iteratorCount, pathOut, pathOutSizeInBytes, ignoreCounter);
+    if (i->path[i->segment.offset] == '/' || i->path[i->segment.offset] == '\\') {
+        i->segment.offset += 1;
     }
 
 
-    if (!ignoreThisSegment)
-    {
-        if (pathOutSizeInBytes > 0)
-        {
-            pathOut            += bytesWritten;
-            pathOutSizeInBytes -= bytesWritten;
+    i->segment.length = offsetEnd - i->segment.offset;
 
-            if (bytesWritten > 0)
-            {
-                pathOut[0] = '/';
-                bytesWritten += 1;
+    return true;
+}
 
-                pathOut            += 1;
-                pathOutSizeInBytes -= 1;
-            }
+static bool drfs_drpath_first(const char* path, drfs_drpath_iterator* i)
+{
+    if (path == 0 || path[0] == '\0' || i == 0) {
+        return false;
+    }
 
-            if (pathOutSizeInBytes >= isegment.segment.length)
-            {
-                drfs__strncpy_s(pathOut, pathOutSizeInBytes, isegment.path + isegment.segment.offset, isegment.segment.length);
-                bytesWritten += isegment.segment.length;
-            }
-            else
-            {
-                drfs__strncpy_s(pathOut, pathOutSizeInBytes, isegment.path + isegment.segment.offset, pathOutSizeInBytes);
-                bytesWritten += pathOutSizeInBytes;
-            }
-        }
+    i->path = path;
+    i->segment.offset = 0;
+    i->segment.length = 0;
+
+    while (i->path[i->segment.length] != '\0' && (i->path[i->segment.length] != '/' && i->path[i->segment.length] != '\\')) {
+        i->segment.length += 1;
     }
 
-    return bytesWritten;
+    return true;
 }
 
-static size_t drfs_drpath_append_and_clean(char* dst, size_t dstSizeInBytes, const char* base, const char* other)
+static bool drfs_drpath_last(const char* path, drfs_drpath_iterator* i)
 {
-    if (base == NULL || other == NULL) {
-        return 0;
+    if (path == 0 || path[0] == '\0' || i == 0) {
+        return false;
     }
 
-    drfs_drpath_iterator last[2];
-    bool isPathEmpty0 = !drfs_drpath_last(base,  last + 0);
-    bool isPathEmpty1 = !drfs_drpath_last(other, last + 1);
+    i->path = path;
+    i->segment.offset = strlen(path);
+    i->segment.length = 0;
 
-    if (isPathEmpty0 && isPathEmpty1) {
-        return 0;   // Both input strings are empty.
-    }
+    return drfs_drpath_prev(i);
+}
 
-    size_t bytesWritten = 0;
-    if (base[0] == '/') {
-        if (dst != NULL && dstSizeInBytes > 1) {
-            dst[0] = '/';
-            bytesWritten = 1;
-        }
+static bool drfs_drpath_segments_equal(const char* s0Path, const drfs_drpath_segment s0, const char* s1Path, const drfs_drpath_segment s1)
+{
+    if (s0Path == NULL || s1Path == NULL) {
+        return false;
     }
 
-    bytesWritten += _drfs_drpath_clean_trywrite(last, 2, dst + bytesWritten, dstSizeInBytes - bytesWritten - 1, 0);  // -1 to ensure there is enough room for a null terminator later on.
-    if (dstSizeInBytes > bytesWritten) {
-        dst[bytesWritten] = '\0';
+    if (s0.length != s1.length) {
+        return false;
     }
 
-    return bytesWritten + 1;
+    return strncmp(s0Path + s0.offset, s1Path + s1.offset, s0.length) == 0;
+}
+
+static bool drfs_drpath_iterators_equal(const drfs_drpath_iterator i0, const drfs_drpath_iterator i1)
+{
+    return drfs_drpath_segments_equal(i0.path, i0.segment, i1.path, i1.segment);
 }
 
+static bool drfs_drpath_is_linux_style_root_segment(const drfs_drpath_iterator i)
+{
+    if (i.path == NULL) {
+        return false;
+    }
 
-//// Private Utiltities ////
+    if (i.segment.offset == 0 && i.segment.length == 0) {
+        return true;    // "/" style root.
+    }
 
-// Recursively creates the given directory structure on the native file system.
-static bool drfs_mkdir_recursive_native(const char* absolutePath);
+    return false;
+}
 
-// Determines whether or not the given path is valid for writing based on the base write path and whether or not
-// the write guard is enabled.
-static bool drfs_validate_write_path(drfs_context* pContext, const char* absoluteOrRelativePath, char* absolutePathOut, unsigned int absolutePathOutSize)
+static bool drfs_drpath_is_win32_style_root_segment(const drfs_drpath_iterator i)
 {
-    // If the path is relative, we need to convert to absolute. Then, if the write directory guard is enabled, we need to check that it's a descendant of the base path.
-    if (drfs_drpath_is_relative(absoluteOrRelativePath)) {
-        if (drfs_drpath_append_and_clean(absolutePathOut, absolutePathOutSize, pContext->writeBaseDirectory, absoluteOrRelativePath)) {
-            absoluteOrRelativePath = absolutePathOut;
-        } else {
-            return false;
-        }
-    } else {
-        if (drfs__strcpy_s(absolutePathOut, absolutePathOutSize, absoluteOrRelativePath) != 0) {
-            return false;
-        }
+    if (i.path == NULL) {
+        return false;
     }
 
-    assert(drfs_drpath_is_absolute(absoluteOrRelativePath));
-
-    if (drfs_is_write_directory_guard_enabled(pContext)) {
-        if (drfs_drpath_is_descendant(absoluteOrRelativePath, pContext->writeBaseDirectory)) {
+    if (i.segment.offset == 0 && i.segment.length == 2) {
+        if (((i.path[0] >= 'a' && i.path[0] <= 'z') || (i.path[0] >= 'A' && i.path[0] <= 'Z')) && i.path[1] == ':') {
             return true;
-        } else {
-            return false;
         }
-    } else {
-        return true;
     }
+
+    return false;
 }
 
-// A simple helper function for determining the access mode to use for an archive file based on the access mode
-// of a file within that archive.
-static unsigned int drfs_archive_access_mode(unsigned int fileAccessMode)
+static bool drfs_drpath_is_root_segment(const drfs_drpath_iterator i)
 {
-    return (fileAccessMode == DRFS_READ) ? DRFS_READ : DRFS_READ | DRFS_WRITE | DRFS_EXISTING;
+    return drfs_drpath_is_linux_style_root_segment(i) || drfs_drpath_is_win32_style_root_segment(i);
 }
 
+static bool drfs_drpath_append_iterator(char* base, size_t baseBufferSizeInBytes, drfs_drpath_iterator i)
+{
+    if (base == NULL) {
+        return false;
+    }
 
+    size_t path1Length = strlen(base);
+    size_t path2Length = i.segment.length;
 
-//// Platform-Specific Section ////
-
-// The functions in this section implement a common abstraction for working with files on the native file system. When adding
-// support for a new platform you'll probably want to either implement a platform-specific back-end or force stdio.
+    if (path1Length >= baseBufferSizeInBytes) {
+        return false;
+    }
 
-#if defined(_WIN32)
-#define DR_FS_USE_WIN32
-#else
-#define DR_FS_USE_STDIO
-#endif
-
-// Low-level function for opening a file on the native file system.
-//
-// This will fail if attempting to open a file that's inside an archive such as a zip file. It can only open
-// files that are sitting on the native file system.
-//
-// The given file path must be absolute.
-static drfs_result drfs_open_native_file(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut);
-
-// Closes the given native file.
-static void drfs_close_native_file(drfs_handle file);
-
-// Determines whether or not the given path refers to a directory on the native file system.
-static bool drfs_is_native_directory(const char* absolutePath);
-
-// Determines whether or not the given path refers to a file on the native file system. This will return false for directories.
-static bool drfs_is_native_file(const char* absolutePath);
-
-// Deletes a native file.
-static drfs_result drfs_delete_native_file(const char* absolutePath);
-
-// Renames a native file. Fails if the target already exists.
-static drfs_result drfs_rename_native_file(const char* absolutePathOld, const char* absolutePathNew);
-
-// Creates a directory on the native file system.
-static drfs_result drfs_mkdir_native(const char* absolutePath);
+    if (drfs_drpath_is_linux_style_root_segment(i)) {
+        if (baseBufferSizeInBytes > 1) {
+            base[0] = '/';
+            base[1] = '\0';
+            return true;
+        }
+    }
 
-// Creates a copy of a native file.
-static drfs_result drfs_copy_native_file(const char* absolutePathSrc, const char* absolutePathDst, bool failIfExists);
 
-// Reads data from the given native file.
-static drfs_result drfs_read_native_file(drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut);
+    // Slash.
+    if (path1Length > 0 && base[path1Length - 1] != '/' && base[path1Length - 1] != '\\') {
+        base[path1Length] = '/';
+        path1Length += 1;
+    }
 
-// Writes data to the given native file.
-static drfs_result drfs_write_native_file(drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut);
+    // Other part.
+    if (path1Length + path2Length >= baseBufferSizeInBytes) {
+        path2Length = baseBufferSizeInBytes - path1Length - 1;      // -1 for the null terminator.
+    }
 
-// Seeks the given native file.
-static drfs_result drfs_seek_native_file(drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin);
+    drfs__strncpy_s(base + path1Length, baseBufferSizeInBytes - path1Length, i.path + i.segment.offset, path2Length);
 
-// Retrieves the read/write pointer of the given native file.
-static uint64_t drfs_tell_native_file(drfs_handle file);
+    return true;
+}
 
-// Retrieves the size of the given native file.
-static uint64_t drfs_get_native_file_size(drfs_handle file);
+static bool drfs_drpath_is_descendant(const char* descendantAbsolutePath, const char* parentAbsolutePath)
+{
+    drfs_drpath_iterator iChild;
+    if (!drfs_drpath_first(descendantAbsolutePath, &iChild)) {
+        return false;   // The descendant is an empty string which makes it impossible for it to be a descendant.
+    }
 
-// Flushes the given native file.
-static void drfs_flush_native_file(drfs_handle file);
+    drfs_drpath_iterator iParent;
+    if (drfs_drpath_first(parentAbsolutePath, &iParent))
+    {
+        do
+        {
+            // If the segment is different, the paths are different and thus it is not a descendant.
+            if (!drfs_drpath_iterators_equal(iParent, iChild)) {
+                return false;
+            }
 
-// Retrieves information about the file OR DIRECTORY at the given path on the native file system.
-//
-// <fi> is allowed to be null, in which case the call is equivalent to simply checking if the file or directory exists.
-static drfs_result drfs_get_native_file_info(const char* absolutePath, drfs_file_info* fi);
+            if (!drfs_drpath_next(&iChild)) {
+                return false;   // The descendant is shorter which means it's impossible for it to be a descendant.
+            }
 
-// Creates an iterator for iterating over the native files in the given directory.
-//
-// The iterator will be deleted with drfs_end_native_iteration().
-static drfs_handle drfs_begin_native_iteration(const char* absolutePath);
+        } while (drfs_drpath_next(&iParent));
+    }
 
-// Deletes the iterator that was returned with drfs_end_native_iteration().
-static void drfs_end_native_iteration(drfs_handle iterator);
+    return true;
+}
 
-// Retrieves information about the next native file based on the given iterator.
-static bool drfs_next_native_iteration(drfs_handle iterator, drfs_file_info* fi);
+static bool drfs_drpath_is_child(const char* childAbsolutePath, const char* parentAbsolutePath)
+{
+    drfs_drpath_iterator iChild;
+    if (!drfs_drpath_first(childAbsolutePath, &iChild)) {
+        return false;   // The descendant is an empty string which makes it impossible for it to be a descendant.
+    }
 
+    drfs_drpath_iterator iParent;
+    if (drfs_drpath_first(parentAbsolutePath, &iParent))
+    {
+        do
+        {
+            // If the segment is different, the paths are different and thus it is not a descendant.
+            if (!drfs_drpath_iterators_equal(iParent, iChild)) {
+                return false;
+            }
 
+            if (!drfs_drpath_next(&iChild)) {
+                return false;   // The descendant is shorter which means it's impossible for it to be a descendant.
+            }
 
-#ifdef DR_FS_USE_WIN32
-static drfs_result drfs__GetLastError_to_result()
-{
-    switch (GetLastError())
-    {
-    case ERROR_SUCCESS:             return drfs_success;
-    case ERROR_FILE_NOT_FOUND:      return drfs_does_not_exist;
-    case ERROR_PATH_NOT_FOUND:      return drfs_does_not_exist;
-    case ERROR_TOO_MANY_OPEN_FILES: return drfs_too_many_open_files;
-    case ERROR_ACCESS_DENIED:       return drfs_permission_denied;
-    case ERROR_NOT_ENOUGH_MEMORY:   return drfs_out_of_memory;
-    case ERROR_DISK_FULL:           return drfs_no_space;
-    case ERROR_HANDLE_EOF:          return drfs_at_end_of_file;
-    default: return drfs_unknown_error;
+        } while (drfs_drpath_next(&iParent));
     }
+
+    // At this point we have finished iteration of the parent, which should be shorter one. We now do one more iterations of
+    // the child to ensure it is indeed a direct child and not a deeper descendant.
+    return !drfs_drpath_next(&iChild);
 }
 
-static drfs_result drfs_open_native_file(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut)
+static void drfs_drpath_base_path(char* path)
 {
-    assert(absolutePath != NULL);
-    assert(pHandleOut != NULL);
-
-    DWORD dwDesiredAccess       = 0;
-    DWORD dwShareMode           = 0;
-    DWORD dwCreationDisposition = OPEN_EXISTING;
-
-    if ((accessMode & DRFS_READ) != 0) {
-        dwDesiredAccess |= FILE_GENERIC_READ;
-        dwShareMode     |= FILE_SHARE_READ;
+    if (path == NULL) {
+        return;
     }
 
-    if ((accessMode & DRFS_WRITE) != 0) {
-        dwDesiredAccess |= FILE_GENERIC_WRITE;
+    char* baseend = path;
 
-        if ((accessMode & DRFS_EXISTING) != 0) {
-            if ((accessMode & DRFS_TRUNCATE) != 0) {
-                dwCreationDisposition = TRUNCATE_EXISTING;
-            } else {
-                dwCreationDisposition = OPEN_EXISTING;
-            }
-        } else {
-            if ((accessMode & DRFS_TRUNCATE) != 0) {
-                dwCreationDisposition = CREATE_ALWAYS;
-            } else {
-                dwCreationDisposition = OPEN_ALWAYS;
-            }
+    // We just loop through the path until we find the last slash.
+    while (path[0] != '\0') {
+        if (path[0] == '/' || path[0] == '\\') {
+            baseend = path;
         }
-    }
 
+        path += 1;
+    }
 
-    HANDLE hFile = CreateFileA(absolutePath, dwDesiredAccess, dwShareMode, NULL, dwCreationDisposition, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (hFile == INVALID_HANDLE_VALUE)
-    {
-        // We failed to create the file, however it may be because we are trying to create the file and the directory structure does not exist yet. In this
-        // case we want to try creating the directory structure and try again.
-        if ((accessMode & DRFS_WRITE) != 0 && (accessMode & DRFS_CREATE_DIRS) != 0)
-        {
-            char dirAbsolutePath[DRFS_MAX_PATH];
-            drfs_drpath_copy_base_path(absolutePath, dirAbsolutePath, sizeof(dirAbsolutePath));
 
-            if (!drfs_is_native_directory(dirAbsolutePath) && drfs_mkdir_recursive_native(dirAbsolutePath)) {
-                hFile = CreateFileA(absolutePath, dwDesiredAccess, dwShareMode, NULL, dwCreationDisposition, FILE_ATTRIBUTE_NORMAL, NULL);
-            }
+    // Now we just loop backwards until we hit the first non-slash.
+    while (baseend > path) {
+        if (baseend[0] != '/' && baseend[0] != '\\') {
+            break;
         }
-    }
 
-    if (hFile != INVALID_HANDLE_VALUE) {
-        *pHandleOut = (drfs_handle)hFile;
-        return drfs_success;
+        baseend -= 1;
     }
 
-    return drfs__GetLastError_to_result();
-}
 
-static void drfs_close_native_file(drfs_handle file)
-{
-    CloseHandle((HANDLE)file);
+    // We just put a null terminator on the end.
+    baseend[0] = '\0';
 }
 
-static bool drfs_is_native_directory(const char* absolutePath)
+static void drfs_drpath_copy_base_path(const char* path, char* baseOut, size_t baseSizeInBytes)
 {
-    DWORD attributes = GetFileAttributesA(absolutePath);
-    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
-}
+    if (path == NULL || baseOut == NULL || baseSizeInBytes == 0) {
+        return;
+    }
 
-static bool drfs_is_native_file(const char* absolutePath)
-{
-    DWORD attributes = GetFileAttributesA(absolutePath);
-    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+    drfs__strcpy_s(baseOut, baseSizeInBytes, path);
+    drfs_drpath_base_path(baseOut);
 }
 
-static drfs_result drfs_delete_native_file(const char* absolutePath)
+static const char* drfs_drpath_file_name(const char* path)
 {
-    BOOL wasSuccessful;
-
-    DWORD attributes = GetFileAttributesA(absolutePath);
-    if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
-        wasSuccessful = DeleteFileA(absolutePath);
-    } else {
-        wasSuccessful = RemoveDirectoryA(absolutePath);
+    if (path == NULL) {
+        return NULL;
     }
 
-    if (wasSuccessful) {
-        return drfs_success;
-    }
+    const char* fileName = path;
 
-    return drfs__GetLastError_to_result();
-}
+    // We just loop through the path until we find the last slash.
+    while (path[0] != '\0') {
+        if (path[0] == '/' || path[0] == '\\') {
+            fileName = path;
+        }
 
-static drfs_result drfs_rename_native_file(const char* absolutePathOld, const char* absolutePathNew)
-{
-    BOOL wasSuccessful = MoveFileExA(absolutePathOld, absolutePathNew, 0);
-    if (wasSuccessful) {
-        return drfs_success;
+        path += 1;
     }
 
-    return drfs__GetLastError_to_result();
+    // At this point the file name is sitting on a slash, so just move forward.
+    while (fileName[0] != '\0' && (fileName[0] == '/' || fileName[0] == '\\')) {
+        fileName += 1;
+    }
+
+    return fileName;
 }
 
-static drfs_result drfs_mkdir_native(const char* absolutePath)
+static const char* drfs_drpath_extension(const char* path)
 {
-    bool wasSuccessful = CreateDirectoryA(absolutePath, NULL);
-    if (wasSuccessful) {
-        return drfs_success;
+    if (path == NULL) {
+        return NULL;
     }
 
-    return drfs__GetLastError_to_result();
-}
+    const char* extension     = drfs_drpath_file_name(path);
+    const char* lastoccurance = 0;
 
-static drfs_result drfs_copy_native_file(const char* absolutePathSrc, const char* absolutePathDst, bool failIfExists)
-{
-    BOOL wasSuccessful = CopyFileA(absolutePathSrc, absolutePathDst, failIfExists);
-    if (wasSuccessful) {
-        return drfs_success;
+    // Just find the last '.' and return.
+    while (extension[0] != '\0')
+    {
+        extension += 1;
+
+        if (extension[0] == '.') {
+            extension    += 1;
+            lastoccurance = extension;
+        }
     }
 
-    return drfs__GetLastError_to_result();
+    return (lastoccurance != 0) ? lastoccurance : extension;
 }
 
-static drfs_result drfs_read_native_file(drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+static bool drfs_drpath_equal(const char* path1, const char* path2)
 {
-    // Unfortunately Win32 expects a DWORD for the number of bytes to read, however we accept size_t. We need to loop to ensure
-    // we handle data > 4GB correctly.
+    if (path1 == NULL || path2 == NULL) {
+        return false;
+    }
 
-    size_t totalBytesRead = 0;
+    if (path1 == path2 || (path1[0] == '\0' && path2[0] == '\0')) {
+        return true;    // Two empty paths are treated as the same.
+    }
 
-    char* pDst = pDataOut;
-    uint64_t bytesRemaining = bytesToRead;
-    while (bytesRemaining > 0)
+    drfs_drpath_iterator iPath1;
+    drfs_drpath_iterator iPath2;
+    if (drfs_drpath_first(path1, &iPath1) && drfs_drpath_first(path2, &iPath2))
     {
-        DWORD bytesToProcess;
-        if (bytesRemaining > UINT_MAX) {
-            bytesToProcess = UINT_MAX;
-        } else {
-            bytesToProcess = (DWORD)bytesRemaining;
-        }
-
+        bool isPath1Valid;
+        bool isPath2Valid;
 
-        DWORD bytesRead;
-        BOOL wasSuccessful = ReadFile((HANDLE)file, pDst, bytesToProcess, &bytesRead, NULL);
-        if (!wasSuccessful || bytesRead != bytesToProcess)
+        do
         {
-            // We failed to read the chunk.
-            totalBytesRead += bytesRead;
-
-            if (pBytesReadOut) {
-                *pBytesReadOut = totalBytesRead;
+            if (!drfs_drpath_iterators_equal(iPath1, iPath2)) {
+                return false;
             }
 
-            return drfs__GetLastError_to_result();
-        }
-
-        pDst += bytesRead;
-        bytesRemaining -= bytesRead;
-        totalBytesRead += bytesRead;
-    }
+            isPath1Valid = drfs_drpath_next(&iPath1);
+            isPath2Valid = drfs_drpath_next(&iPath2);
 
+        } while (isPath1Valid && isPath2Valid);
 
-    if (pBytesReadOut != NULL) {
-        *pBytesReadOut = totalBytesRead;
+        // At this point either iPath1 and/or iPath2 have finished iterating. If both of them are at the end, the two paths are equal.
+        return isPath1Valid == isPath2Valid && iPath1.path[iPath1.segment.offset] == '\0' && iPath2.path[iPath2.segment.offset] == '\0';
     }
 
-    return drfs_success;
+    return false;
 }
 
-static drfs_result drfs_write_native_file(drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+static bool drfs_drpath_is_relative(const char* path)
 {
-    // Unfortunately Win32 expects a DWORD for the number of bytes to write, however we accept size_t. We need to loop to ensure
-    // we handle data > 4GB correctly.
-
-    size_t totalBytesWritten = 0;
-    const char* pSrc = pData;
-
-    size_t bytesRemaining = bytesToWrite;
-    while (bytesRemaining > 0)
-    {
-        DWORD bytesToProcess;
-        if (bytesRemaining > UINT_MAX) {
-            bytesToProcess = UINT_MAX;
-        } else {
-            bytesToProcess = (DWORD)bytesRemaining;
-        }
-
-        DWORD bytesWritten;
-        BOOL wasSuccessful = WriteFile((HANDLE)file, pSrc, bytesToProcess, &bytesWritten, NULL);
-        if (!wasSuccessful || bytesWritten != bytesToProcess)
-        {
-            // We failed to write the chunk.
-            totalBytesWritten += bytesWritten;
-
-            if (pBytesWrittenOut) {
-                *pBytesWrittenOut = totalBytesWritten;
-            }
-
-            return drfs__GetLastError_to_result();
-        }
-
-        pSrc += bytesWritten;
-        bytesRemaining -= bytesWritten;
-        totalBytesWritten += bytesWritten;
+    if (path == NULL) {
+        return false;
     }
 
-    if (pBytesWrittenOut) {
-        *pBytesWrittenOut = totalBytesWritten;
+    drfs_drpath_iterator seg;
+    if (drfs_drpath_first(path, &seg)) {
+        return !drfs_drpath_is_root_segment(seg);
     }
 
-    return drfs_success;;
+    // We'll get here if the path is empty. We consider this to be a relative path.
+    return true;
 }
 
-static drfs_result drfs_seek_native_file(drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
+static bool drfs_drpath_is_absolute(const char* path)
 {
-    LARGE_INTEGER lNewFilePointer;
-    LARGE_INTEGER lDistanceToMove;
-    lDistanceToMove.QuadPart = bytesToSeek;
+    return !drfs_drpath_is_relative(path);
+}
 
-    DWORD dwMoveMethod = FILE_CURRENT;
-    if (origin == drfs_origin_start) {
-        dwMoveMethod = FILE_BEGIN;
-    } else if (origin == drfs_origin_end) {
-        dwMoveMethod = FILE_END;
+static bool drfs_drpath_append(char* base, size_t baseBufferSizeInBytes, const char* other)
+{
+    if (base == NULL || other == NULL) {
+        return false;
     }
 
-    BOOL wasSuccessful = SetFilePointerEx((HANDLE)file, lDistanceToMove, &lNewFilePointer, dwMoveMethod);
-    if (!wasSuccessful) {
-        return drfs__GetLastError_to_result();
+    size_t path1Length = strlen(base);
+    size_t path2Length = strlen(other);
+
+    if (path1Length >= baseBufferSizeInBytes) {
+        return false;
     }
 
-    return drfs_success;
-}
 
-static uint64_t drfs_tell_native_file(drfs_handle file)
-{
-    LARGE_INTEGER lNewFilePointer;
-    LARGE_INTEGER lDistanceToMove;
-    lDistanceToMove.QuadPart = 0;
+    // Slash.
+    if (path1Length > 0 && base[path1Length - 1] != '/' && base[path1Length - 1] != '\\') {
+        base[path1Length] = '/';
+        path1Length += 1;
+    }
 
-    if (SetFilePointerEx((HANDLE)file, lDistanceToMove, &lNewFilePointer, FILE_CURRENT)) {
-        return (uint64_t)lNewFilePointer.QuadPart;
+    // Other part.
+    if (path1Length + path2Length >= baseBufferSizeInBytes) {
+        path2Length = baseBufferSizeInBytes - path1Length - 1;      // -1 for the null terminator.
     }
 
-    return 0;
+    drfs__strncpy_s(base + path1Length, baseBufferSizeInBytes - path1Length, other, path2Length);
+
+    return true;
 }
 
-static uint64_t drfs_get_native_file_size(drfs_handle file)
+static bool drfs_drpath_copy_and_append(char* dst, size_t dstSizeInBytes, const char* base, const char* other)
 {
-    LARGE_INTEGER fileSize;
-    if (GetFileSizeEx((HANDLE)file, &fileSize)) {
-        return (uint64_t)fileSize.QuadPart;
+    if (dst == NULL || dstSizeInBytes == 0) {
+        return false;
     }
 
-    return 0;
+    drfs__strcpy_s(dst, dstSizeInBytes, base);
+    return drfs_drpath_append(dst, dstSizeInBytes, other);
 }
 
-static void drfs_flush_native_file(drfs_handle file)
+// This function recursively cleans a path which is defined as a chain of iterators. This function works backwards, which means at the time of calling this
+// function, each iterator in the chain should be placed at the end of the path.
+//
+// This does not write the null terminator, nor a leading slash for absolute paths.
+static size_t _drfs_drpath_clean_trywrite(drfs_drpath_iterator* iterators, unsigned int iteratorCount, char* pathOut, size_t pathOutSizeInBytes, unsigned int ignoreCounter)
 {
-    FlushFileBuffers((HANDLE)file);
-}
+    if (iteratorCount == 0) {
+        return 0;
+    }
 
-static drfs_result drfs_get_native_file_info(const char* absolutePath, drfs_file_info* fi)
-{
-    assert(absolutePath != NULL);
+    drfs_drpath_iterator isegment = iterators[iteratorCount - 1];
 
-    // <fi> is allowed to be null, in which case the call is equivalent to simply checking if the file exists.
-    if (fi == NULL) {
-        if (GetFileAttributesA(absolutePath) == INVALID_FILE_ATTRIBUTES) {
-            return drfs_success;
-        }
 
-        return drfs_does_not_exist;
-    }
+    // If this segment is a ".", we ignore it. If it is a ".." we ignore it and increment "ignoreCount".
+    int ignoreThisSegment = ignoreCounter > 0 && isegment.segment.length > 0;
 
-    WIN32_FILE_ATTRIBUTE_DATA fad;
-    if (GetFileAttributesExA(absolutePath, GetFileExInfoStandard, &fad))
+    if (isegment.segment.length == 1 && isegment.path[isegment.segment.offset] == '.')
     {
-        ULARGE_INTEGER liSize;
-        liSize.LowPart  = fad.nFileSizeLow;
-        liSize.HighPart = fad.nFileSizeHigh;
+        // "."
+        ignoreThisSegment = 1;
+    }
+    else
+    {
+        if (isegment.segment.length == 2 && isegment.path[isegment.segment.offset] == '.' && isegment.path[isegment.segment.offset + 1] == '.')
+        {
+            // ".."
+            ignoreThisSegment = 1;
+            ignoreCounter += 1;
+        }
+        else
+        {
+            // It's a regular segment, so decrement the ignore counter.
+            if (ignoreCounter > 0) {
+                ignoreCounter -= 1;
+            }
+        }
+    }
 
-        ULARGE_INTEGER liTime;
-        liTime.LowPart  = fad.ftLastWriteTime.dwLowDateTime;
-        liTime.HighPart = fad.ftLastWriteTime.dwHighDateTime;
 
-        strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), absolutePath);
-        fi->sizeInBytes      = liSize.QuadPart;
-        fi->lastModifiedTime = liTime.QuadPart;
+    // The previous segment needs to be written before we can write this one.
+    size_t bytesWritten = 0;
 
-        fi->attributes = 0;
-        if ((fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
-            fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
+    drfs_drpath_iterator prev = isegment;
+    if (!drfs_drpath_prev(&prev))
+    {
+        if (iteratorCount > 1)
+        {
+            iteratorCount -= 1;
+            prev = iterators[iteratorCount - 1];
         }
-        if ((fad.dwFileAttributes & FILE_ATTRIBUTE_READONLY) != 0) {
-            fi->attributes |= DRFS_FILE_ATTRIBUTE_READONLY;
+        else
+        {
+            prev.path           = NULL;
+            prev.segment.offset = 0;
+            prev.segment.length = 0;
         }
+    }
 
-        return drfs_success;
+    if (prev.segment.length > 0)
+    {
+        iterators[iteratorCount - 1] = prev;
+        bytesWritten = _drfs_drpath_clean_trywrite(iterators, iteratorCount, pathOut, pathOutSizeInBytes, ignoreCounter);
     }
 
-    return drfs__GetLastError_to_result();
-}
 
-typedef struct
-{
-    HANDLE hFind;
-    WIN32_FIND_DATAA ffd;
-    char directoryPath[1];
-} drfs_iterator_win32;
-
-static drfs_handle drfs_begin_native_iteration(const char* absolutePath)
-{
-    assert(drfs_drpath_is_absolute(absolutePath));
-
-    char searchQuery[DRFS_MAX_PATH];
-    if (strcpy_s(searchQuery, sizeof(searchQuery), absolutePath) != 0) {
-        return NULL;
-    }
-
-    unsigned int searchQueryLength = (unsigned int)strlen(searchQuery);
-    if (searchQueryLength >= DRFS_MAX_PATH - 3) {
-        return NULL;    // Path is too long.
-    }
-
-    searchQuery[searchQueryLength + 0] = '\\';
-    searchQuery[searchQueryLength + 1] = '*';
-    searchQuery[searchQueryLength + 2] = '\0';
+    if (!ignoreThisSegment)
+    {
+        if (pathOutSizeInBytes > 0)
+        {
+            pathOut            += bytesWritten;
+            pathOutSizeInBytes -= bytesWritten;
 
-    drfs_iterator_win32* pIterator = malloc(sizeof(*pIterator) + searchQueryLength);
-    if (pIterator == NULL) {
-        return NULL;
-    }
+            if (bytesWritten > 0)
+            {
+                pathOut[0] = '/';
+                bytesWritten += 1;
 
-    ZeroMemory(pIterator, sizeof(*pIterator));
+                pathOut            += 1;
+                pathOutSizeInBytes -= 1;
+            }
 
-    pIterator->hFind = FindFirstFileA(searchQuery, &pIterator->ffd);
-    if (pIterator->hFind == INVALID_HANDLE_VALUE) {
-        free(pIterator);
-        return NULL;    // Failed to begin search.
+            if (pathOutSizeInBytes >= isegment.segment.length)
+            {
+                drfs__strncpy_s(pathOut, pathOutSizeInBytes, isegment.path + isegment.segment.offset, isegment.segment.length);
+                bytesWritten += isegment.segment.length;
+            }
+            else
+            {
+                drfs__strncpy_s(pathOut, pathOutSizeInBytes, isegment.path + isegment.segment.offset, pathOutSizeInBytes);
+                bytesWritten += pathOutSizeInBytes;
+            }
+        }
     }
 
-    strcpy_s(pIterator->directoryPath, searchQueryLength + 1, absolutePath);     // This won't fail in practice.
-    return (drfs_handle)pIterator;
+    return bytesWritten;
 }
 
-static void drfs_end_native_iteration(drfs_handle iterator)
+static size_t drfs_drpath_append_and_clean(char* dst, size_t dstSizeInBytes, const char* base, const char* other)
 {
-    drfs_iterator_win32* pIterator = iterator;
-    assert(pIterator != NULL);
-
-    if (pIterator->hFind) {
-        FindClose(pIterator->hFind);
+    if (base == NULL || other == NULL) {
+        return 0;
     }
 
-    free(pIterator);
-}
-
-static bool drfs_next_native_iteration(drfs_handle iterator, drfs_file_info* fi)
-{
-    drfs_iterator_win32* pIterator = iterator;
-    assert(pIterator != NULL);
-
-    if (pIterator->hFind != INVALID_HANDLE_VALUE && pIterator->hFind != NULL)
-    {
-        // Skip past "." and ".." directories.
-        while (strcmp(pIterator->ffd.cFileName, ".") == 0 || strcmp(pIterator->ffd.cFileName, "..") == 0) {
-            if (FindNextFileA(pIterator->hFind, &pIterator->ffd) == 0) {
-                return false;
-            }
-        }
-
-        if (fi != NULL)
-        {
-            // The absolute path actually needs to be set to the relative path. The higher level APIs are the once responsible for translating
-            // it back to an absolute path.
-            drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), pIterator->ffd.cFileName);
-
-            ULARGE_INTEGER liSize;
-            liSize.LowPart  = pIterator->ffd.nFileSizeLow;
-            liSize.HighPart = pIterator->ffd.nFileSizeHigh;
-            fi->sizeInBytes = liSize.QuadPart;
-
-            ULARGE_INTEGER liTime;
-            liTime.LowPart  = pIterator->ffd.ftLastWriteTime.dwLowDateTime;
-            liTime.HighPart = pIterator->ffd.ftLastWriteTime.dwHighDateTime;
-            fi->lastModifiedTime = liTime.QuadPart;
+    drfs_drpath_iterator last[2];
+    bool isPathEmpty0 = !drfs_drpath_last(base,  last + 0);
+    bool isPathEmpty1 = !drfs_drpath_last(other, last + 1);
 
-            fi->attributes = 0;
-            if ((pIterator->ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
-                fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
-            }
-            if ((pIterator->ffd.dwFileAttributes & FILE_ATTRIBUTE_READONLY) != 0) {
-                fi->attributes |= DRFS_FILE_ATTRIBUTE_READONLY;
-            }
-        }
+    if (isPathEmpty0 && isPathEmpty1) {
+        return 0;   // Both input strings are empty.
+    }
 
-        if (!FindNextFileA(pIterator->hFind, &pIterator->ffd)) {
-            FindClose(pIterator->hFind);
-            pIterator->hFind = NULL;
+    size_t bytesWritten = 0;
+    if (base[0] == '/') {
+        if (dst != NULL && dstSizeInBytes > 1) {
+            dst[0] = '/';
+            bytesWritten = 1;
         }
+    }
 
-        return true;
+    bytesWritten += _drfs_drpath_clean_trywrite(last, 2, dst + bytesWritten, dstSizeInBytes - bytesWritten - 1, 0);  // -1 to ensure there is enough room for a null terminator later on.
+    if (dstSizeInBytes > bytesWritten) {
+        dst[bytesWritten] = '\0';
     }
 
-    return false;
+    return bytesWritten + 1;
 }
-#endif //DR_FS_USE_WIN32
-
-
-#ifdef DR_FS_USE_STDIO
-#include <stdio.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <fcntl.h>
-#include <dirent.h>
-#include <unistd.h>
-#include <limits.h>
-
-#ifdef __linux__
-#include <sys/sendfile.h>
-#endif
 
-#define DRFS_HANDLE_TO_FD(file) ((int)((size_t)file) - 1)
-#define DRFS_FD_TO_HANDLE(fd)   ((drfs_handle)(size_t)(fd + 1))
 
-static drfs_result drfs__errno_to_result()
-{
-    switch (errno)
-    {
-    case EACCES:       return drfs_permission_denied;
-    case EEXIST:       return drfs_already_exists;
-    case EISDIR:       return drfs_permission_denied;
-    case EMFILE:       return drfs_too_many_open_files;
-    case ENFILE:       return drfs_too_many_open_files;
-    case ENAMETOOLONG: return drfs_path_too_long;
-    case ENOENT:       return drfs_does_not_exist;
-    case ENOMEM:       return drfs_out_of_memory;
-    case ENOSPC:       return drfs_no_space;
-    case ENOTDIR:      return drfs_not_directory;
-    case EOVERFLOW:    return drfs_too_large;
-    case EROFS:        return drfs_permission_denied;
-    case ETXTBSY:      return drfs_permission_denied;
-    case EBADF:        return drfs_invalid_args;
-    case EINVAL:       return drfs_invalid_args;
-    default:           return drfs_unknown_error;
-    }
-}
+//// Private Utiltities ////
 
-static int drfs__open_fd(const char* absolutePath, int flags)
-{
-    return open64(absolutePath, flags, 0666);
-}
+// Recursively creates the given directory structure on the native file system.
+static bool drfs_mkdir_recursive_native(const char* absolutePath);
 
-static int drfs__stat64(const char* filename, struct stat64* st)
+// Locks the context for reading. Any number of threads can hold a read lock at the same time.
+static void drfs_context_lock_read(drfs_context* pContext)
 {
-    return stat64(filename, st);
+#ifdef _WIN32
+    AcquireSRWLockShared(&pContext->lock);
+#else
+    pthread_rwlock_rdlock(&pContext->lock);
+#endif
 }
 
-static int drfs__fstat64(int fd, struct stat64* st)
+static void drfs_context_unlock_read(drfs_context* pContext)
 {
-    return fstat64(fd, st);
+#ifdef _WIN32
+    ReleaseSRWLockShared(&pContext->lock);
+#else
+    pthread_rwlock_unlock(&pContext->lock);
+#endif
 }
 
-static int drfs__mode_is_dir(int mode)
+// Locks the context for writing. This waits for every reader to finish. Locks are not recursive - functions that are called
+// while the lock is held must not try to lock it again.
+static void drfs_context_lock_write(drfs_context* pContext)
 {
-    return S_ISDIR(mode);
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&pContext->lock);
+#else
+    pthread_rwlock_wrlock(&pContext->lock);
+#endif
 }
 
-static int drfs__mode_has_write_permission(int mode)
+static void drfs_context_unlock_write(drfs_context* pContext)
 {
-    return (mode & S_IWUSR) != 0;
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&pContext->lock);
+#else
+    pthread_rwlock_unlock(&pContext->lock);
+#endif
 }
 
-
-static drfs_result drfs_open_native_file(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut)
+// Determines whether or not the given path is valid for writing based on the base write path and whether or not
+// the write guard is enabled. The context must be locked for reading.
+static bool drfs_validate_write_path(drfs_context* pContext, const char* absoluteOrRelativePath, char* absolutePathOut, unsigned int absolutePathOutSize)
 {
-    assert(absolutePath != NULL);
-    assert(pHandleOut != NULL);
-    
-    *pHandleOut = NULL;
-
-    int flags = 0;
-    if ((accessMode & DRFS_READ) != 0) {
-        if ((accessMode & DRFS_WRITE) != 0) {
-            flags = O_RDWR;
+    // If the path is relative, we need to convert to absolute. Then, if the write directory guard is enabled, we need to check that it's a descendant of the base path.
+    if (drfs_drpath_is_relative(absoluteOrRelativePath)) {
+        if (drfs_drpath_append_and_clean(absolutePathOut, absolutePathOutSize, pContext->writeBaseDirectory, absoluteOrRelativePath)) {
+            absoluteOrRelativePath = absolutePathOut;
         } else {
-            flags = O_RDONLY;
+            return false;
         }
     } else {
-        if ((accessMode & DRFS_WRITE) != 0) {
-            flags = O_WRONLY;
-        } else {
-            return drfs_permission_denied;    // Neither read nor write mode was specified.
+        if (drfs__strcpy_s(absolutePathOut, absolutePathOutSize, absoluteOrRelativePath) != 0) {
+            return false;
         }
     }
 
-    if ((accessMode & DRFS_TRUNCATE) != 0) {
-        flags |= O_TRUNC;
-    }
-
-    if ((accessMode & DRFS_EXISTING) == 0) {
-        flags |= O_CREAT;
-    }
-
-    int fd = drfs__open_fd(absolutePath, flags);
-    if (fd == -1)
-    {
-        // We failed to open the file, however it could be because the directory structure is not in place. We need to check
-        // the access mode flags for DRFS_CREATE_DIRS and try creating the directory structure.
-        if ((accessMode & DRFS_WRITE) != 0 && (accessMode & DRFS_CREATE_DIRS) != 0)
-        {
-            char dirAbsolutePath[DRFS_MAX_PATH];
-            drfs_drpath_copy_base_path(absolutePath, dirAbsolutePath, sizeof(dirAbsolutePath));
+    assert(drfs_drpath_is_absolute(absoluteOrRelativePath));
 
-            if (!drfs_is_native_directory(dirAbsolutePath) && drfs_mkdir_recursive_native(dirAbsolutePath)) {
-                fd = drfs__open_fd(absolutePath, flags);
-            }
+    if (pContext->isWriteGuardEnabled) {
+        if (drfs_drpath_is_descendant(absoluteOrRelativePath, pContext->writeBaseDirectory)) {
+            return true;
+        } else {
+            return false;
         }
+    } else {
+        return true;
     }
-
-    if (fd == -1) {
-        return drfs__errno_to_result();
-    }
-
-    *pHandleOut = DRFS_FD_TO_HANDLE(fd);
-    return drfs_success;
 }
 
-static void drfs_close_native_file(drfs_handle file)
+// A simple helper function for determining the access mode to use for an archive file based on the access mode
+// of a file within that archive.
+static unsigned int drfs_archive_access_mode(unsigned int fileAccessMode)
 {
-    close(DRFS_HANDLE_TO_FD(file));
+    return ((fileAccessMode & ~DRFS_COMPRESSED) == DRFS_READ) ? DRFS_READ : DRFS_READ | DRFS_WRITE | DRFS_EXISTING;
 }
 
-static bool drfs_is_native_directory(const char* absolutePath)
-{
-    struct stat64 info;
-    if (drfs__stat64(absolutePath, &info) != 0) {
-        return false;   // Likely the folder doesn't exist.
-    }
 
-    return drfs__mode_is_dir(info.st_mode);   // Only return true if it's a directory. Return false if it's a file.
-}
 
-static bool drfs_is_native_file(const char* absolutePath)
-{
-    struct stat64 info;
-    if (drfs__stat64(absolutePath, &info) != 0) {
-        return false;   // Likely the folder doesn't exist.
-    }
+//// Platform-Specific Section ////
 
-    return !drfs__mode_is_dir(info.st_mode);  // Only return true if it's a file. Return false if it's a directory.
-}
+// The functions in this section implement a common abstraction for working with files on the native file system. When adding
+// support for a new platform you'll probably want to either implement a platform-specific back-end or force stdio.
 
-static drfs_result drfs_delete_native_file(const char* absolutePath)
-{
-    if (remove(absolutePath) == 0) {
-        return drfs_success;
-    }
+#if defined(_WIN32)
+#define DR_FS_USE_WIN32
+#else
+#define DR_FS_USE_STDIO
+#endif
 
-    return drfs__errno_to_result();
-}
+// Low-level function for opening a file on the native file system.
+//
+// This will fail if attempting to open a file that's inside an archive such as a zip file. It can only open
+// files that are sitting on the native file system.
+//
+// The given file path must be absolute.
+static drfs_result drfs_open_native_file(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut);
 
-static drfs_result drfs_rename_native_file(const char* absolutePathOld, const char* absolutePathNew)
-{
-    if (rename(absolutePathOld, absolutePathNew) == 0) {
-        return drfs_success;
-    }
+// Closes the given native file.
+static void drfs_close_native_file(drfs_handle file);
 
-    return drfs__errno_to_result();
-}
+// Determines whether or not the given path refers to a directory on the native file system.
+static bool drfs_is_native_directory(const char* absolutePath);
 
-static drfs_result drfs_mkdir_native(const char* absolutePath)
+// Determines whether or not the given path refers to a file on the native file system. This will return false for directories.
+static bool drfs_is_native_file(const char* absolutePath);
+
+// Deletes a native file.
+static drfs_result drfs_delete_native_file(const char* absolutePath);
+
+// Renames a native file. Fails if the target already exists.
+static drfs_result drfs_rename_native_file(const char* absolutePathOld, const char* absolutePathNew);
+
+// Creates a directory on the native file system.
+static drfs_result drfs_mkdir_native(const char* absolutePath);
+
+// Creates a copy of a native file.
+static drfs_result drfs_copy_native_file(const char* absolutePathSrc, const char* absolutePathDst, bool failIfExists);
+
+// Reads data from the given native file.
+static drfs_result drfs_read_native_file(drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut);
+
+// Writes data to the given native file.
+static drfs_result drfs_write_native_file(drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut);
+
+// Seeks the given native file.
+static drfs_result drfs_seek_native_file(drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin);
+
+// Retrieves the read/write pointer of the given native file.
+static uint64_t drfs_tell_native_file(drfs_handle file);
+
+// Retrieves the size of the given native file.
+static uint64_t drfs_get_native_file_size(drfs_handle file);
+
+// Flushes the given native file.
+static void drfs_flush_native_file(drfs_handle file);
+
+// Retrieves information about the file OR DIRECTORY at the given path on the native file system.
+//
+// <fi> is allowed to be null, in which case the call is equivalent to simply checking if the file or directory exists.
+static drfs_result drfs_get_native_file_info(const char* absolutePath, drfs_file_info* fi);
+
+// Creates an iterator for iterating over the native files in the given directory.
+//
+// The iterator will be deleted with drfs_end_native_iteration().
+static drfs_handle drfs_begin_native_iteration(const char* absolutePath);
+
+// Deletes the iterator that was returned with drfs_end_native_iteration().
+static void drfs_end_native_iteration(drfs_handle iterator);
+
+// Retrieves information about the next native file based on the given iterator.
+static bool drfs_next_native_iteration(drfs_handle iterator, drfs_file_info* fi);
+
+
+
+#ifdef DR_FS_USE_WIN32
+static drfs_result drfs__GetLastError_to_result()
 {
-    if (mkdir(absolutePath, 0777) == 0) {
-        return drfs_success;
+    switch (GetLastError())
+    {
+    case ERROR_SUCCESS:             return drfs_success;
+    case ERROR_FILE_NOT_FOUND:      return drfs_does_not_exist;
+    case ERROR_PATH_NOT_FOUND:      return drfs_does_not_exist;
+    case ERROR_TOO_MANY_OPEN_FILES: return drfs_too_many_open_files;
+    case ERROR_ACCESS_DENIED:       return drfs_permission_denied;
+    case ERROR_NOT_ENOUGH_MEMORY:   return drfs_out_of_memory;
+    case ERROR_DISK_FULL:           return drfs_no_space;
+    case ERROR_HANDLE_EOF:          return drfs_at_end_of_file;
+    default: return drfs_unknown_error;
     }
-
-    return drfs__errno_to_result();
 }
 
-static drfs_result drfs_copy_native_file(const char* absolutePathSrc, const char* absolutePathDst, bool failIfExists)
+static drfs_result drfs_open_native_file(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut)
 {
-    if (drfs_drpath_equal(absolutePathSrc, absolutePathDst)) {
-        if (!failIfExists) {
-            return drfs_success;
-        } else {
-            return drfs_already_exists;
-        }
-    }
+    assert(absolutePath != NULL);
+    assert(pHandleOut != NULL);
 
-    int fdSrc = drfs__open_fd(absolutePathSrc, O_RDONLY);
-    if (fdSrc == -1) {
-        return drfs__errno_to_result();
-    }
+    DWORD dwDesiredAccess       = 0;
+    DWORD dwShareMode           = 0;
+    DWORD dwCreationDisposition = OPEN_EXISTING;
 
-    int fdDst = drfs__open_fd(absolutePathDst, O_WRONLY | O_TRUNC | O_CREAT | ((failIfExists) ? O_EXCL : 0));
-    if (fdDst == -1) {
-        close(fdSrc);
-        return drfs__errno_to_result();
+    if ((accessMode & DRFS_READ) != 0) {
+        dwDesiredAccess |= FILE_GENERIC_READ;
+        dwShareMode     |= FILE_SHARE_READ;
     }
 
-    drfs_result result = drfs_success;
+    if ((accessMode & DRFS_WRITE) != 0) {
+        dwDesiredAccess |= FILE_GENERIC_WRITE;
 
-    struct stat64 info;
-    if (drfs__fstat64(fdSrc, &info) == 0)
-    {
-#ifdef __linux__
-        ssize_t bytesRemaining = info.st_size;
-        while (bytesRemaining > 0) {
-            ssize_t bytesCopied = sendfile(fdDst, fdSrc, NULL, bytesRemaining);
-            if (bytesCopied == -1) {
-                result = drfs__errno_to_result();
-                break;
+        if ((accessMode & DRFS_EXISTING) != 0) {
+            if ((accessMode & DRFS_TRUNCATE) != 0) {
+                dwCreationDisposition = TRUNCATE_EXISTING;
+            } else {
+                dwCreationDisposition = OPEN_EXISTING;
             }
-
-            bytesRemaining -= bytesCopied;
-        }
-#else
-        char buffer[BUFSIZ];
-        int bytesRead;
-        while ((bytesRead = read(fdSrc, buffer, sizeof(buffer))) > 0) {
-            if (write(fdDst, buffer, bytesRead) != bytesRead) {
-                result = drfs__errno_to_result();
-                break;
+        } else {
+            if ((accessMode & DRFS_TRUNCATE) != 0) {
+                dwCreationDisposition = CREATE_ALWAYS;
+            } else {
+                dwCreationDisposition = OPEN_ALWAYS;
             }
         }
-#endif
     }
-    else
+
+
+    HANDLE hFile = CreateFileA(absolutePath, dwDesiredAccess, dwShareMode, NULL, dwCreationDisposition, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
     {
-        result = drfs__errno_to_result();
+        // We failed to create the file, however it may be because we are trying to create the file and the directory structure does not exist yet. In this
+        // case we want to try creating the directory structure and try again.
+        if ((accessMode & DRFS_WRITE) != 0 && (accessMode & DRFS_CREATE_DIRS) != 0)
+        {
+            char dirAbsolutePath[DRFS_MAX_PATH];
+            drfs_drpath_copy_base_path(absolutePath, dirAbsolutePath, sizeof(dirAbsolutePath));
+
+            if (!drfs_is_native_directory(dirAbsolutePath) && drfs_mkdir_recursive_native(dirAbsolutePath)) {
+                hFile = CreateFileA(absolutePath, dwDesiredAccess, dwShareMode, NULL, dwCreationDisposition, FILE_ATTRIBUTE_NORMAL, NULL);
+            }
+        }
     }
 
-    close(fdDst);
-    close(fdSrc);
+    if (hFile != INVALID_HANDLE_VALUE) {
+        *pHandleOut = (drfs_handle)hFile;
+        return drfs_success;
+    }
 
-    // Permissions.
-    chmod(absolutePathDst, info.st_mode & 07777);
+    return drfs__GetLastError_to_result();
+}
 
-    return result;
+static void drfs_close_native_file(drfs_handle file)
+{
+    CloseHandle((HANDLE)file);
 }
 
-static drfs_result drfs_read_native_file(drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+static bool drfs_is_native_directory(const char* absolutePath)
 {
-    // The documentation for read() states that if the number of bytes being read (bytesToRead) is larger than SSIZE_MAX,
-    // the result is unspecified. We'll make things a bit more robust by explicitly checking for this and handling it.
-    char* pDataOut8 = pDataOut;
-    drfs_result result = drfs_success;
+    DWORD attributes = GetFileAttributesA(absolutePath);
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+}
 
-    size_t totalBytesRead = 0;
-    while (bytesToRead > 0)
-    {
-        ssize_t bytesRead = read(DRFS_HANDLE_TO_FD(file), pDataOut8 + totalBytesRead, (bytesToRead > SSIZE_MAX) ? SSIZE_MAX : bytesToRead);
-        if (bytesRead == -1) {
-            result = drfs__errno_to_result();
-            break;
-        }
+static bool drfs_is_native_file(const char* absolutePath)
+{
+    DWORD attributes = GetFileAttributesA(absolutePath);
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+}
 
-        if (bytesRead == 0) {
-            break;  // Reached the end.
-        }
+static drfs_result drfs_delete_native_file(const char* absolutePath)
+{
+    BOOL wasSuccessful;
 
-        totalBytesRead += bytesRead;
-        bytesToRead    -= bytesRead;
+    DWORD attributes = GetFileAttributesA(absolutePath);
+    if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+        wasSuccessful = DeleteFileA(absolutePath);
+    } else {
+        wasSuccessful = RemoveDirectoryA(absolutePath);
     }
 
-    if (pBytesReadOut) {
-        *pBytesReadOut = totalBytesRead;
+    if (wasSuccessful) {
+        return drfs_success;
     }
 
-    return result;
+    return drfs__GetLastError_to_result();
 }
 
-static drfs_result drfs_write_native_file(drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+static drfs_result drfs_rename_native_file(const char* absolutePathOld, const char* absolutePathNew)
 {
-    // We want to handle writes in the same way as we do reads due to the return valid being signed.
-    const char* pDataIn8 = pData;
-    drfs_result result = drfs_success;
+    BOOL wasSuccessful = MoveFileExA(absolutePathOld, absolutePathNew, 0);
+    if (wasSuccessful) {
+        return drfs_success;
+    }
 
-    size_t totalBytesWritten = 0;
-    while (bytesToWrite > 0)
+    return drfs__GetLastError_to_result();
+}
+
+static drfs_result drfs_mkdir_native(const char* absolutePath)
+{
+    bool wasSuccessful = CreateDirectoryA(absolutePath, NULL);
+    if (wasSuccessful) {
+        return drfs_success;
+    }
+
+    return drfs__GetLastError_to_result();
+}
+
+static drfs_result drfs_copy_native_file(const char* absolutePathSrc, const char* absolutePathDst, bool failIfExists)
+{
+    BOOL wasSuccessful = CopyFileA(absolutePathSrc, absolutePathDst, failIfExists);
+    if (wasSuccessful) {
+        return drfs_success;
+    }
+
+    return drfs__GetLastError_to_result();
+}
+
+static drfs_result drfs_read_native_file(drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+{
+    // Unfortunately Win32 expects a DWORD for the number of bytes to read, however we accept size_t. We need to loop to ensure
+    // we handle data > 4GB correctly.
+
+    size_t totalBytesRead = 0;
+
+    char* pDst = pDataOut;
+    uint64_t bytesRemaining = bytesToRead;
+    while (bytesRemaining > 0)
     {
-        ssize_t bytesWritten = write(DRFS_HANDLE_TO_FD(file), pDataIn8 + totalBytesWritten, (bytesToWrite > SSIZE_MAX) ? SSIZE_MAX : bytesToWrite);
-        if (bytesWritten == -1) {
-            result = drfs__errno_to_result();
-            break;
+        DWORD bytesToProcess;
+        if (bytesRemaining > UINT_MAX) {
+            bytesToProcess = UINT_MAX;
+        } else {
+            bytesToProcess = (DWORD)bytesRemaining;
         }
 
-        if (bytesWritten == 0) {
-            result = drfs__errno_to_result();
-            break;
+
+        DWORD bytesRead;
+        BOOL wasSuccessful = ReadFile((HANDLE)file, pDst, bytesToProcess, &bytesRead, NULL);
+        if (!wasSuccessful || bytesRead != bytesToProcess)
+        {
+            // We failed to read the chunk.
+            totalBytesRead += bytesRead;
+
+            if (pBytesReadOut) {
+                *pBytesReadOut = totalBytesRead;
+            }
+
+            return drfs__GetLastError_to_result();
+        }
+
+        pDst += bytesRead;
+        bytesRemaining -= bytesRead;
+        totalBytesRead += bytesRead;
+    }
+
+
+    if (pBytesReadOut != NULL) {
+        *pBytesReadOut = totalBytesRead;
+    }
+
+    return drfs_success;
+}
+
+static drfs_result drfs_write_native_file(drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+{
+    // Unfortunately Win32 expects a DWORD for the number of bytes to write, however we accept size_t. We need to loop to ensure
+    // we handle data > 4GB correctly.
+
+    size_t totalBytesWritten = 0;
+    const char* pSrc = pData;
+
+    size_t bytesRemaining = bytesToWrite;
+    while (bytesRemaining > 0)
+    {
+        DWORD bytesToProcess;
+        if (bytesRemaining > UINT_MAX) {
+            bytesToProcess = UINT_MAX;
+        } else {
+            bytesToProcess = (DWORD)bytesRemaining;
+        }
+
+        DWORD bytesWritten;
+        BOOL wasSuccessful = WriteFile((HANDLE)file, pSrc, bytesToProcess, &bytesWritten, NULL);
+        if (!wasSuccessful || bytesWritten != bytesToProcess)
+        {
+            // We failed to write the chunk.
+            totalBytesWritten += bytesWritten;
+
+            if (pBytesWrittenOut) {
+                *pBytesWrittenOut = totalBytesWritten;
+            }
+
+            return drfs__GetLastError_to_result();
         }
 
+        pSrc += bytesWritten;
+        bytesRemaining -= bytesWritten;
         totalBytesWritten += bytesWritten;
-        bytesToWrite      -= bytesWritten;
     }
 
-    if (pBytesWrittenOut != NULL) {
+    if (pBytesWrittenOut) {
         *pBytesWrittenOut = totalBytesWritten;
     }
 
-    return result;
+    return drfs_success;;
 }
 
 static drfs_result drfs_seek_native_file(drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
 {
-    int stdioOrigin = SEEK_CUR;
+    LARGE_INTEGER lNewFilePointer;
+    LARGE_INTEGER lDistanceToMove;
+    lDistanceToMove.QuadPart = bytesToSeek;
+
+    DWORD dwMoveMethod = FILE_CURRENT;
     if (origin == drfs_origin_start) {
-        stdioOrigin = SEEK_SET;
+        dwMoveMethod = FILE_BEGIN;
     } else if (origin == drfs_origin_end) {
-        stdioOrigin = SEEK_END;
+        dwMoveMethod = FILE_END;
     }
 
-    if (lseek64(DRFS_HANDLE_TO_FD(file), bytesToSeek, stdioOrigin) == -1) {
-        return drfs__errno_to_result();
+    BOOL wasSuccessful = SetFilePointerEx((HANDLE)file, lDistanceToMove, &lNewFilePointer, dwMoveMethod);
+    if (!wasSuccessful) {
+        return drfs__GetLastError_to_result();
     }
 
     return drfs_success;
@@ -2492,163 +2697,170 @@ static drfs_result drfs_seek_native_file(drfs_handle file, int64_t bytesToSeek,
 
 static uint64_t drfs_tell_native_file(drfs_handle file)
 {
-    return lseek64(DRFS_HANDLE_TO_FD(file), 0, SEEK_CUR);
+    LARGE_INTEGER lNewFilePointer;
+    LARGE_INTEGER lDistanceToMove;
+    lDistanceToMove.QuadPart = 0;
+
+    if (SetFilePointerEx((HANDLE)file, lDistanceToMove, &lNewFilePointer, FILE_CURRENT)) {
+        return (uint64_t)lNewFilePointer.QuadPart;
+    }
+
+    return 0;
 }
 
 static uint64_t drfs_get_native_file_size(drfs_handle file)
 {
-    struct stat64 info;
-    if (drfs__fstat64(DRFS_HANDLE_TO_FD(file), &info) != 0) {
-        return 0;
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx((HANDLE)file, &fileSize)) {
+        return (uint64_t)fileSize.QuadPart;
     }
 
-    return info.st_size;
+    return 0;
 }
 
 static void drfs_flush_native_file(drfs_handle file)
 {
-    // The posix implementation does not require flushing.
-    (void)file;
+    FlushFileBuffers((HANDLE)file);
 }
 
 static drfs_result drfs_get_native_file_info(const char* absolutePath, drfs_file_info* fi)
 {
     assert(absolutePath != NULL);
 
-    struct stat64 info;
-    if (stat64(absolutePath, &info) != 0) {
-        return drfs__errno_to_result();
+    // <fi> is allowed to be null, in which case the call is equivalent to simply checking if the file exists.
+    if (fi == NULL) {
+        if (GetFileAttributesA(absolutePath) == INVALID_FILE_ATTRIBUTES) {
+            return drfs_success;
+        }
+
+        return drfs_does_not_exist;
     }
 
-    // <fi> is allowed to be null, in which case the call is equivalent to simply checking if the file exists.
-    if (fi != NULL)
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (GetFileAttributesExA(absolutePath, GetFileExInfoStandard, &fad))
     {
-        drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), absolutePath);
-        fi->sizeInBytes      = info.st_size;
-        fi->lastModifiedTime = info.st_mtime;
+        ULARGE_INTEGER liSize;
+        liSize.LowPart  = fad.nFileSizeLow;
+        liSize.HighPart = fad.nFileSizeHigh;
+
+        ULARGE_INTEGER liTime;
+        liTime.LowPart  = fad.ftLastWriteTime.dwLowDateTime;
+        liTime.HighPart = fad.ftLastWriteTime.dwHighDateTime;
+
+        strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), absolutePath);
+        fi->sizeInBytes      = liSize.QuadPart;
+        fi->lastModifiedTime = liTime.QuadPart;
 
         fi->attributes = 0;
-        if (drfs__mode_is_dir(info.st_mode)) {
+        if ((fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
             fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
         }
-        if (drfs__mode_has_write_permission(info.st_mode) == false) {
+        if ((fad.dwFileAttributes & FILE_ATTRIBUTE_READONLY) != 0) {
             fi->attributes |= DRFS_FILE_ATTRIBUTE_READONLY;
         }
+
+        return drfs_success;
     }
 
-    return drfs_success;
+    return drfs__GetLastError_to_result();
 }
 
 typedef struct
 {
-    DIR* dir;
+    HANDLE hFind;
+    WIN32_FIND_DATAA ffd;
     char directoryPath[1];
-} drfs_iterator_posix;
+} drfs_iterator_win32;
 
 static drfs_handle drfs_begin_native_iteration(const char* absolutePath)
 {
-    DIR* dir = opendir(absolutePath);
-    if (dir == NULL) {
+    assert(drfs_drpath_is_absolute(absolutePath));
+
+    char searchQuery[DRFS_MAX_PATH];
+    if (strcpy_s(searchQuery, sizeof(searchQuery), absolutePath) != 0) {
         return NULL;
     }
 
-    drfs_iterator_posix* pIterator = malloc(sizeof(drfs_iterator_posix) + strlen(absolutePath));
+    unsigned int searchQueryLength = (unsigned int)strlen(searchQuery);
+    if (searchQueryLength >= DRFS_MAX_PATH - 3) {
+        return NULL;    // Path is too long.
+    }
+
+    searchQuery[searchQueryLength + 0] = '\\';
+    searchQuery[searchQueryLength + 1] = '*';
+    searchQuery[searchQueryLength + 2] = '\0';
+
+    drfs_iterator_win32* pIterator = DRFS_MALLOC(sizeof(*pIterator) + searchQueryLength);
     if (pIterator == NULL) {
         return NULL;
     }
 
-    pIterator->dir = dir;
-    drfs__strcpy_s(pIterator->directoryPath, strlen(absolutePath) + 1, absolutePath);
+    ZeroMemory(pIterator, sizeof(*pIterator));
 
-    return pIterator;
+    pIterator->hFind = FindFirstFileA(searchQuery, &pIterator->ffd);
+    if (pIterator->hFind == INVALID_HANDLE_VALUE) {
+        DRFS_FREE(pIterator);
+        return NULL;    // Failed to begin search.
+    }
+
+    strcpy_s(pIterator->directoryPath, searchQueryLength + 1, absolutePath);     // This won't fail in practice.
+    return (drfs_handle)pIterator;
 }
 
 static void drfs_end_native_iteration(drfs_handle iterator)
 {
-    drfs_iterator_posix* pIterator = iterator;
-    if (pIterator == NULL) {
-        return;
+    drfs_iterator_win32* pIterator = iterator;
+    assert(pIterator != NULL);
+
+    if (pIterator->hFind) {
+        FindClose(pIterator->hFind);
     }
 
-    closedir(pIterator->dir);
-    free(pIterator);
+    DRFS_FREE(pIterator);
 }
 
 static bool drfs_next_native_iteration(drfs_handle iterator, drfs_file_info* fi)
 {
-    drfs_iterator_posix* pIterator = iterator;
-    if (pIterator == NULL || pIterator->dir == NULL) {
-        return false;
-    }
-
-    struct dirent* info = readdir(pIterator->dir);
-    if (info == NULL) {
-        return false;
-    }
+    drfs_iterator_win32* pIterator = iterator;
+    assert(pIterator != NULL);
 
-    // Skip over "." and ".." folders.
-    while (strcmp(info->d_name, ".") == 0 || strcmp(info->d_name, "..") == 0) {
-        info = readdir(pIterator->dir);
-        if (info == NULL) {
-            return false;
+    if (pIterator->hFind != INVALID_HANDLE_VALUE && pIterator->hFind != NULL)
+    {
+        // Skip past "." and ".." directories.
+        while (strcmp(pIterator->ffd.cFileName, ".") == 0 || strcmp(pIterator->ffd.cFileName, "..") == 0) {
+            if (FindNextFileA(pIterator->hFind, &pIterator->ffd) == 0) {
+                return false;
+            }
         }
-    }
 
-    char fileAbsolutePath[DRFS_MAX_PATH];
-    drfs_drpath_copy_and_append(fileAbsolutePath, sizeof(fileAbsolutePath), pIterator->directoryPath, info->d_name);
+        if (fi != NULL)
+        {
+            // The absolute path actually needs to be set to the relative path. The higher level APIs are the once responsible for translating
+            // it back to an absolute path.
+            drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), pIterator->ffd.cFileName);
 
-    if (drfs_get_native_file_info(fileAbsolutePath, fi)) {
-        drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), info->d_name);
-    }
-
-    return true;
-}
-#endif //DR_FS_USE_STDIO
-
-
-static bool drfs_mkdir_recursive_native(const char* absolutePath)
-{
-    char runningPath[DRFS_MAX_PATH];
-    runningPath[0] = '\0';
+            ULARGE_INTEGER liSize;
+            liSize.LowPart  = pIterator->ffd.nFileSizeLow;
+            liSize.HighPart = pIterator->ffd.nFileSizeHigh;
+            fi->sizeInBytes = liSize.QuadPart;
 
-    drfs_drpath_iterator iPathSeg;
-    if (!drfs_drpath_first(absolutePath, &iPathSeg)) {
-        return false;
-    }
+            ULARGE_INTEGER liTime;
+            liTime.LowPart  = pIterator->ffd.ftLastWriteTime.dwLowDateTime;
+            liTime.HighPart = pIterator->ffd.ftLastWriteTime.dwHighDateTime;
+            fi->lastModifiedTime = liTime.QuadPart;
 
-    // Never check the first segment because we can assume it always exists - it will always be the drive root.
-    if (drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg))
-    {
-        // Loop over every directory until we find one that does not exist.
-        while (drfs_drpath_next(&iPathSeg))
-        {
-            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
-                return false;
+            fi->attributes = 0;
+            if ((pIterator->ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+                fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
             }
-
-            if (!drfs_is_native_directory(runningPath)) {
-                if (drfs_mkdir_native(runningPath) != drfs_success) {
-                    return false;
-                }
-
-                break;
+            if ((pIterator->ffd.dwFileAttributes & FILE_ATTRIBUTE_READONLY) != 0) {
+                fi->attributes |= DRFS_FILE_ATTRIBUTE_READONLY;
             }
         }
 
-
-        // At this point all we need to do is create the remaining directories - we can assert that the directory does not exist
-        // rather than actually checking it which should be a bit more efficient.
-        while (drfs_drpath_next(&iPathSeg))
-        {
-            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
-                return false;
-            }
-
-            assert(!drfs_is_native_directory(runningPath));
-
-            if (drfs_mkdir_native(runningPath) != drfs_success) {
-                return false;
-            }
+        if (!FindNextFileA(pIterator->hFind, &pIterator->ffd)) {
+            FindClose(pIterator->hFind);
+            pIterator->hFind = NULL;
         }
 
         return true;
@@ -2656,2734 +2868,3950 @@ static bool drfs_mkdir_recursive_native(const char* absolutePath)
 
     return false;
 }
+#endif //DR_FS_USE_WIN32
 
 
+#ifdef DR_FS_USE_STDIO
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <limits.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
-//// Native Archive Implementation ////
+#define DRFS_HANDLE_TO_FD(file) ((int)((size_t)file) - 1)
+#define DRFS_FD_TO_HANDLE(fd)   ((drfs_handle)(size_t)(fd + 1))
 
-typedef struct
+static drfs_result drfs__errno_to_result()
 {
-    // The access mode.
-    unsigned int accessMode;
+    switch (errno)
+    {
+    case EACCES:       return drfs_permission_denied;
+    case EEXIST:       return drfs_already_exists;
+    case EISDIR:       return drfs_permission_denied;
+    case EMFILE:       return drfs_too_many_open_files;
+    case ENFILE:       return drfs_too_many_open_files;
+    case ENAMETOOLONG: return drfs_path_too_long;
+    case ENOENT:       return drfs_does_not_exist;
+    case ENOMEM:       return drfs_out_of_memory;
+    case ENOSPC:       return drfs_no_space;
+    case ENOTDIR:      return drfs_not_directory;
+    case EOVERFLOW:    return drfs_too_large;
+    case EROFS:        return drfs_permission_denied;
+    case ETXTBSY:      return drfs_permission_denied;
+    case EBADF:        return drfs_invalid_args;
+    case EINVAL:       return drfs_invalid_args;
+    default:           return drfs_unknown_error;
+    }
+}
 
-    // The absolute path of the directory.
-    char absolutePath[1];
+static int drfs__open_fd(const char* absolutePath, int flags)
+{
+    return open64(absolutePath, flags, 0666);
+}
 
-} drfs_archive_native;
+static int drfs__stat64(const char* filename, struct stat64* st)
+{
+    return stat64(filename, st);
+}
 
-static drfs_result drfs_open_archive__native(drfs_file* pArchiveFile, unsigned int accessMode, drfs_handle* pHandleOut)
+static int drfs__fstat64(int fd, struct stat64* st)
 {
-    (void)pArchiveFile;
-    (void)accessMode;
+    return fstat64(fd, st);
+}
 
-    // This function should never be called for native archives. Native archives are a special case because they are just directories
-    // on the file system rather than actual files, and as such they are handled just slightly differently. This function is only
-    // included here for this assert so we can ensure we don't incorrectly call this function.
-    assert(false);
+static int drfs__mode_is_dir(int mode)
+{
+    return S_ISDIR(mode);
+}
 
-    *pHandleOut = NULL;
-    return drfs_unknown_error;
+static int drfs__mode_has_write_permission(int mode)
+{
+    return (mode & S_IWUSR) != 0;
 }
 
-static drfs_result drfs_open_archive__native__special(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut)
+
+static drfs_result drfs_open_native_file(const char* absolutePath, unsigned int accessMode, drfs_handle* pHandleOut)
 {
-    assert(absolutePath != NULL);       // There is no notion of a file for native archives (which are just directories on the file system).
+    assert(absolutePath != NULL);
     assert(pHandleOut != NULL);
-
+    
     *pHandleOut = NULL;
 
-    size_t absolutePathLen = strlen(absolutePath);
+    int flags = 0;
+    if ((accessMode & DRFS_READ) != 0) {
+        if ((accessMode & DRFS_WRITE) != 0) {
+            flags = O_RDWR;
+        } else {
+            flags = O_RDONLY;
+        }
+    } else {
+        if ((accessMode & DRFS_WRITE) != 0) {
+            flags = O_WRONLY;
+        } else {
+            return drfs_permission_denied;    // Neither read nor write mode was specified.
+        }
+    }
+
+    if ((accessMode & DRFS_TRUNCATE) != 0) {
+        flags |= O_TRUNC;
+    }
 
-    drfs_archive_native* pNativeArchive = malloc(sizeof(*pNativeArchive) + absolutePathLen + 1);
-    if (pNativeArchive == NULL) {
-        return drfs_out_of_memory;
+    if ((accessMode & DRFS_EXISTING) == 0) {
+        flags |= O_CREAT;
     }
 
-    drfs__strcpy_s(pNativeArchive->absolutePath, absolutePathLen + 1, absolutePath);
-    pNativeArchive->accessMode = accessMode;
+    int fd = drfs__open_fd(absolutePath, flags);
+    if (fd == -1)
+    {
+        // We failed to open the file, however it could be because the directory structure is not in place. We need to check
+        // the access mode flags for DRFS_CREATE_DIRS and try creating the directory structure.
+        if ((accessMode & DRFS_WRITE) != 0 && (accessMode & DRFS_CREATE_DIRS) != 0)
+        {
+            char dirAbsolutePath[DRFS_MAX_PATH];
+            drfs_drpath_copy_base_path(absolutePath, dirAbsolutePath, sizeof(dirAbsolutePath));
+
+            if (!drfs_is_native_directory(dirAbsolutePath) && drfs_mkdir_recursive_native(dirAbsolutePath)) {
+                fd = drfs__open_fd(absolutePath, flags);
+            }
+        }
+    }
+
+    if (fd == -1) {
+        return drfs__errno_to_result();
+    }
 
-    *pHandleOut = (drfs_handle)pNativeArchive;
+    *pHandleOut = DRFS_FD_TO_HANDLE(fd);
     return drfs_success;
 }
 
-static void drfs_close_archive__native(drfs_handle archive)
+static void drfs_close_native_file(drfs_handle file)
 {
-    // Nothing to do except free the object.
-    free(archive);
+    close(DRFS_HANDLE_TO_FD(file));
 }
 
-static drfs_result drfs_get_file_info__native(drfs_handle archive, const char* relativePath, drfs_file_info* fi)
+static bool drfs_is_native_directory(const char* absolutePath)
 {
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
-
-    char absolutePath[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
-        return drfs_path_too_long;
-    }
-
-    if (fi != NULL) {
-        memset(fi, 0, sizeof(*fi));
+    struct stat64 info;
+    if (drfs__stat64(absolutePath, &info) != 0) {
+        return false;   // Likely the folder doesn't exist.
     }
 
-    return drfs_get_native_file_info(absolutePath, fi);
+    return drfs__mode_is_dir(info.st_mode);   // Only return true if it's a directory. Return false if it's a file.
 }
 
-static drfs_handle drfs_begin_iteration__native(drfs_handle archive, const char* relativePath)
+static bool drfs_is_native_file(const char* absolutePath)
 {
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
-
-    char absolutePath[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
-        return NULL;
+    struct stat64 info;
+    if (drfs__stat64(absolutePath, &info) != 0) {
+        return false;   // Likely the folder doesn't exist.
     }
 
-    return drfs_begin_native_iteration(absolutePath);
+    return !drfs__mode_is_dir(info.st_mode);  // Only return true if it's a file. Return false if it's a directory.
 }
 
-static void drfs_end_iteration__native(drfs_handle archive, drfs_handle iterator)
+static drfs_result drfs_delete_native_file(const char* absolutePath)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(iterator != NULL);
+    if (remove(absolutePath) == 0) {
+        return drfs_success;
+    }
 
-    drfs_end_native_iteration(iterator);
+    return drfs__errno_to_result();
 }
 
-static bool drfs_next_iteration__native(drfs_handle archive, drfs_handle iterator, drfs_file_info* fi)
+static drfs_result drfs_rename_native_file(const char* absolutePathOld, const char* absolutePathNew)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(iterator != NULL);
+    if (rename(absolutePathOld, absolutePathNew) == 0) {
+        return drfs_success;
+    }
 
-    return drfs_next_native_iteration(iterator, fi);
+    return drfs__errno_to_result();
 }
 
-static drfs_result drfs_delete_file__native(drfs_handle archive, const char* relativePath)
+static drfs_result drfs_mkdir_native(const char* absolutePath)
 {
-    assert(relativePath != NULL);
-
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
-
-    char absolutePath[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
-        return drfs_path_too_long;
+    if (mkdir(absolutePath, 0777) == 0) {
+        return drfs_success;
     }
 
-    return drfs_delete_native_file(absolutePath);
+    return drfs__errno_to_result();
 }
 
-static drfs_result drfs_rename_file__native(drfs_handle archive, const char* relativePathOld, const char* relativePathNew)
+static drfs_result drfs_copy_native_file(const char* absolutePathSrc, const char* absolutePathDst, bool failIfExists)
 {
-    assert(relativePathOld != NULL);
-    assert(relativePathNew != NULL);
+    if (drfs_drpath_equal(absolutePathSrc, absolutePathDst)) {
+        if (!failIfExists) {
+            return drfs_success;
+        } else {
+            return drfs_already_exists;
+        }
+    }
 
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
-
-    char absolutePathOld[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePathOld, sizeof(absolutePathOld), pNativeArchive->absolutePath, relativePathOld)) {
-        return drfs_path_too_long;
+    int fdSrc = drfs__open_fd(absolutePathSrc, O_RDONLY);
+    if (fdSrc == -1) {
+        return drfs__errno_to_result();
     }
 
-    char absolutePathNew[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePathNew, sizeof(absolutePathNew), pNativeArchive->absolutePath, relativePathNew)) {
-        return drfs_path_too_long;
+    int fdDst = drfs__open_fd(absolutePathDst, O_WRONLY | O_TRUNC | O_CREAT | ((failIfExists) ? O_EXCL : 0));
+    if (fdDst == -1) {
+        close(fdSrc);
+        return drfs__errno_to_result();
     }
 
-    return drfs_rename_native_file(absolutePathOld, absolutePathNew);
-}
-
-static drfs_result drfs_create_directory__native(drfs_handle archive, const char* relativePath)
-{
-    assert(relativePath != NULL);
+    drfs_result result = drfs_success;
 
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
+    struct stat64 info;
+    if (drfs__fstat64(fdSrc, &info) == 0)
+    {
+#ifdef __linux__
+        ssize_t bytesRemaining = info.st_size;
+        while (bytesRemaining > 0) {
+            ssize_t bytesCopied = sendfile(fdDst, fdSrc, NULL, bytesRemaining);
+            if (bytesCopied == -1) {
+                result = drfs__errno_to_result();
+                break;
+            }
 
-    char absolutePath[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
-        return drfs_path_too_long;
+            bytesRemaining -= bytesCopied;
+        }
+#else
+        char buffer[BUFSIZ];
+        int bytesRead;
+        while ((bytesRead = read(fdSrc, buffer, sizeof(buffer))) > 0) {
+            if (write(fdDst, buffer, bytesRead) != bytesRead) {
+                result = drfs__errno_to_result();
+                break;
+            }
+        }
+#endif
+    }
+    else
+    {
+        result = drfs__errno_to_result();
     }
 
-    return drfs_mkdir_native(absolutePath);
+    close(fdDst);
+    close(fdSrc);
+
+    // Permissions.
+    chmod(absolutePathDst, info.st_mode & 07777);
+
+    return result;
 }
 
-static drfs_result drfs_copy_file__native(drfs_handle archive, const char* relativePathSrc, const char* relativePathDst, bool failIfExists)
+static drfs_result drfs_read_native_file(drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
 {
-    assert(relativePathSrc != NULL);
-    assert(relativePathDst != NULL);
+    // The documentation for read() states that if the number of bytes being read (bytesToRead) is larger than SSIZE_MAX,
+    // the result is unspecified. We'll make things a bit more robust by explicitly checking for this and handling it.
+    char* pDataOut8 = pDataOut;
+    drfs_result result = drfs_success;
 
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
+    size_t totalBytesRead = 0;
+    while (bytesToRead > 0)
+    {
+        ssize_t bytesRead = read(DRFS_HANDLE_TO_FD(file), pDataOut8 + totalBytesRead, (bytesToRead > SSIZE_MAX) ? SSIZE_MAX : bytesToRead);
+        if (bytesRead == -1) {
+            result = drfs__errno_to_result();
+            break;
+        }
 
-    char absolutePathSrc[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePathSrc, sizeof(absolutePathSrc), pNativeArchive->absolutePath, relativePathSrc)) {
-        return drfs_path_too_long;
+        if (bytesRead == 0) {
+            break;  // Reached the end.
+        }
+
+        totalBytesRead += bytesRead;
+        bytesToRead    -= bytesRead;
     }
 
-    char absolutePathDst[DRFS_MAX_PATH];
-    if (!drfs_drpath_copy_and_append(absolutePathDst, sizeof(absolutePathDst), pNativeArchive->absolutePath, relativePathDst)) {
-        return drfs_path_too_long;
+    if (pBytesReadOut) {
+        *pBytesReadOut = totalBytesRead;
     }
 
-    return drfs_copy_native_file(absolutePathSrc, absolutePathDst, failIfExists);
+    return result;
 }
 
-static drfs_result drfs_open_file__native(drfs_handle archive, const char* relativePath, unsigned int accessMode, drfs_handle* pHandleOut)
+static drfs_result drfs_write_native_file(drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
 {
-    assert(archive != NULL);
-    assert(relativePath != NULL);
+    // We want to handle writes in the same way as we do reads due to the return valid being signed.
+    const char* pDataIn8 = pData;
+    drfs_result result = drfs_success;
 
-    drfs_archive_native* pNativeArchive = archive;
-    assert(pNativeArchive != NULL);
+    size_t totalBytesWritten = 0;
+    while (bytesToWrite > 0)
+    {
+        ssize_t bytesWritten = write(DRFS_HANDLE_TO_FD(file), pDataIn8 + totalBytesWritten, (bytesToWrite > SSIZE_MAX) ? SSIZE_MAX : bytesToWrite);
+        if (bytesWritten == -1) {
+            result = drfs__errno_to_result();
+            break;
+        }
 
-    char absolutePath[DRFS_MAX_PATH];
-    if (drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
-        return drfs_open_native_file(absolutePath, accessMode, pHandleOut);
-    }
+        if (bytesWritten == 0) {
+            result = drfs__errno_to_result();
+            break;
+        }
 
-    return drfs_path_too_long;
-}
+        totalBytesWritten += bytesWritten;
+        bytesToWrite      -= bytesWritten;
+    }
 
-static void drfs_close_file__native(drfs_handle archive, drfs_handle file)
-{
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
+    if (pBytesWrittenOut != NULL) {
+        *pBytesWrittenOut = totalBytesWritten;
+    }
 
-    drfs_close_native_file(file);
+    return result;
 }
 
-static drfs_result drfs_read_file__native(drfs_handle archive, drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+static drfs_result drfs_seek_native_file(drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
+    int stdioOrigin = SEEK_CUR;
+    if (origin == drfs_origin_start) {
+        stdioOrigin = SEEK_SET;
+    } else if (origin == drfs_origin_end) {
+        stdioOrigin = SEEK_END;
+    }
 
-    return drfs_read_native_file(file, pDataOut, bytesToRead, pBytesReadOut);
+    if (lseek64(DRFS_HANDLE_TO_FD(file), bytesToSeek, stdioOrigin) == -1) {
+        return drfs__errno_to_result();
+    }
+
+    return drfs_success;
 }
 
-static drfs_result drfs_write_file__native(drfs_handle archive, drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+static uint64_t drfs_tell_native_file(drfs_handle file)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
-
-    return drfs_write_native_file(file, pData, bytesToWrite, pBytesWrittenOut);
+    return lseek64(DRFS_HANDLE_TO_FD(file), 0, SEEK_CUR);
 }
 
-static drfs_result drfs_seek_file__native(drfs_handle archive, drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
+static uint64_t drfs_get_native_file_size(drfs_handle file)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
+    struct stat64 info;
+    if (drfs__fstat64(DRFS_HANDLE_TO_FD(file), &info) != 0) {
+        return 0;
+    }
 
-    return drfs_seek_native_file(file, bytesToSeek, origin);
+    return info.st_size;
 }
 
-static uint64_t drfs_tell_file__native(drfs_handle archive, drfs_handle file)
+static void drfs_flush_native_file(drfs_handle file)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
-
-    return drfs_tell_native_file(file);
+    // The posix implementation does not require flushing.
+    (void)file;
 }
 
-static uint64_t drfs_file_size__native(drfs_handle archive, drfs_handle file)
+static drfs_result drfs_get_native_file_info(const char* absolutePath, drfs_file_info* fi)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
+    assert(absolutePath != NULL);
 
-    return drfs_get_native_file_size(file);
-}
+    struct stat64 info;
+    if (stat64(absolutePath, &info) != 0) {
+        return drfs__errno_to_result();
+    }
 
-static void drfs_flush__native(drfs_handle archive, drfs_handle file)
-{
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
+    // <fi> is allowed to be null, in which case the call is equivalent to simply checking if the file exists.
+    if (fi != NULL)
+    {
+        drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), absolutePath);
+        fi->sizeInBytes      = info.st_size;
+        fi->lastModifiedTime = info.st_mtime;
 
-    drfs_flush_native_file(file);
+        fi->attributes = 0;
+        if (drfs__mode_is_dir(info.st_mode)) {
+            fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
+        }
+        if (drfs__mode_has_write_permission(info.st_mode) == false) {
+            fi->attributes |= DRFS_FILE_ATTRIBUTE_READONLY;
+        }
+    }
+
+    return drfs_success;
 }
 
+typedef struct
+{
+    DIR* dir;
+    char directoryPath[1];
+} drfs_iterator_posix;
 
-// Finds the back-end callbacks by the given extension.
-static bool drfs_find_backend_by_extension(drfs_context* pContext, const char* extension, drfs_archive_callbacks* pCallbacksOut)
+static drfs_handle drfs_begin_native_iteration(const char* absolutePath)
 {
-    if (pContext == NULL || extension == NULL || extension[0] == '\0') {
-        return false;
+    DIR* dir = opendir(absolutePath);
+    if (dir == NULL) {
+        return NULL;
     }
 
-    for (unsigned int i = 0; i < pContext->archiveCallbacks.count; ++i)
-    {
-        if (pContext->archiveCallbacks.pBuffer[i].is_valid_extension) {
-            if (pContext->archiveCallbacks.pBuffer[i].is_valid_extension(extension)) {
-                if (pCallbacksOut) {
-                    *pCallbacksOut = pContext->archiveCallbacks.pBuffer[i];
-                }
-                return true;
-            }
-        }
+    drfs_iterator_posix* pIterator = DRFS_MALLOC(sizeof(drfs_iterator_posix) + strlen(absolutePath));
+    if (pIterator == NULL) {
+        return NULL;
     }
 
-    return false;
+    pIterator->dir = dir;
+    drfs__strcpy_s(pIterator->directoryPath, strlen(absolutePath) + 1, absolutePath);
+
+    return pIterator;
 }
 
-// Recursively claims ownership of parent archives so that when the child archive is deleted, so are it's parents.
-static void drfs_recursively_claim_ownership_or_parent_archive(drfs_archive* pArchive)
+static void drfs_end_native_iteration(drfs_handle iterator)
 {
-    if (pArchive == NULL) {
+    drfs_iterator_posix* pIterator = iterator;
+    if (pIterator == NULL) {
         return;
     }
 
-    pArchive->flags |= DR_FS_OWNS_PARENT_ARCHIVE;
-    drfs_recursively_claim_ownership_or_parent_archive(pArchive->pParentArchive);
+    closedir(pIterator->dir);
+    DRFS_FREE(pIterator);
 }
 
-// Opens a native archive.
-static drfs_result drfs_open_native_archive(drfs_context* pContext, const char* absolutePath, unsigned int accessMode, drfs_archive** ppArchive)
+static bool drfs_next_native_iteration(drfs_handle iterator, drfs_file_info* fi)
 {
-    assert(pContext != NULL);
-    assert(ppArchive != NULL);
-    assert(absolutePath != NULL);
-
-    *ppArchive = NULL;
+    drfs_iterator_posix* pIterator = iterator;
+    if (pIterator == NULL || pIterator->dir == NULL) {
+        return false;
+    }
 
-    drfs_handle internalArchiveHandle;
-    drfs_result result = drfs_open_archive__native__special(absolutePath, accessMode, &internalArchiveHandle);
-    if (result != drfs_success) {
-        return result;
+    struct dirent* info = readdir(pIterator->dir);
+    if (info == NULL) {
+        return false;
     }
 
-    drfs_archive* pArchive = malloc(sizeof(*pArchive));
-    if (pArchive == NULL) {
-        drfs_close_archive__native(internalArchiveHandle);
-        return drfs_out_of_memory;
+    // Skip over "." and ".." folders.
+    while (strcmp(info->d_name, ".") == 0 || strcmp(info->d_name, "..") == 0) {
+        info = readdir(pIterator->dir);
+        if (info == NULL) {
+            return false;
+        }
     }
 
-    pArchive->pContext                     = pContext;
-    pArchive->pParentArchive               = NULL;
-    pArchive->pFile                        = NULL;
-    pArchive->internalArchiveHandle        = internalArchiveHandle;
-    pArchive->flags                        = 0;
-    pArchive->callbacks.is_valid_extension = NULL;
-    pArchive->callbacks.open_archive       = drfs_open_archive__native;
-    pArchive->callbacks.close_archive      = drfs_close_archive__native;
-    pArchive->callbacks.get_file_info      = drfs_get_file_info__native;
-    pArchive->callbacks.begin_iteration    = drfs_begin_iteration__native;
-    pArchive->callbacks.end_iteration      = drfs_end_iteration__native;
-    pArchive->callbacks.next_iteration     = drfs_next_iteration__native;
-    pArchive->callbacks.delete_file        = drfs_delete_file__native;
-    pArchive->callbacks.rename_file        = drfs_rename_file__native;
-    pArchive->callbacks.create_directory   = drfs_create_directory__native;
-    pArchive->callbacks.copy_file          = drfs_copy_file__native;
-    pArchive->callbacks.open_file          = drfs_open_file__native;
-    pArchive->callbacks.close_file         = drfs_close_file__native;
-    pArchive->callbacks.read_file          = drfs_read_file__native;
-    pArchive->callbacks.write_file         = drfs_write_file__native;
-    pArchive->callbacks.seek_file          = drfs_seek_file__native;
-    pArchive->callbacks.tell_file          = drfs_tell_file__native;
-    pArchive->callbacks.file_size          = drfs_file_size__native;
-    pArchive->callbacks.flush_file         = drfs_flush__native;
-    drfs__strcpy_s(pArchive->absolutePath, sizeof(pArchive->absolutePath), absolutePath);
+    char fileAbsolutePath[DRFS_MAX_PATH];
+    drfs_drpath_copy_and_append(fileAbsolutePath, sizeof(fileAbsolutePath), pIterator->directoryPath, info->d_name);
 
-    *ppArchive = pArchive;
-    return drfs_success;
+    if (drfs_get_native_file_info(fileAbsolutePath, fi)) {
+        drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), info->d_name);
+    }
+
+    return true;
 }
+#endif //DR_FS_USE_STDIO
 
-// Opens an archive from a file and callbacks.
-static drfs_result drfs_open_non_native_archive(drfs_archive* pParentArchive, drfs_file* pArchiveFile, drfs_archive_callbacks* pBackEndCallbacks, const char* relativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
-{
-    assert(pParentArchive != NULL);
-    assert(pArchiveFile != NULL);
-    assert(pBackEndCallbacks != NULL);
-    assert(ppArchiveOut != NULL);
 
-    *ppArchiveOut = NULL;
+static bool drfs_mkdir_recursive_native(const char* absolutePath)
+{
+    char runningPath[DRFS_MAX_PATH];
+    runningPath[0] = '\0';
 
-    if (pBackEndCallbacks->open_archive == NULL) {
-        return drfs_no_backend;
+    drfs_drpath_iterator iPathSeg;
+    if (!drfs_drpath_first(absolutePath, &iPathSeg)) {
+        return false;
     }
 
-    drfs_handle internalArchiveHandle;
-    drfs_result result = pBackEndCallbacks->open_archive(pArchiveFile, accessMode, &internalArchiveHandle);
-    if (result != drfs_success) {
-        return result;
-    }
+    // Never check the first segment because we can assume it always exists - it will always be the drive root.
+    if (drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg))
+    {
+        // Loop over every directory until we find one that does not exist.
+        while (drfs_drpath_next(&iPathSeg))
+        {
+            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
+                return false;
+            }
 
-    drfs_archive* pArchive = malloc(sizeof(*pArchive));
-    if (pArchive == NULL) {
-        pBackEndCallbacks->close_archive(internalArchiveHandle);
-        return drfs_out_of_memory;
-    }
+            if (!drfs_is_native_directory(runningPath)) {
+                if (drfs_mkdir_native(runningPath) != drfs_success) {
+                    return false;
+                }
 
-    pArchive->pContext              = pParentArchive->pContext;
-    pArchive->pParentArchive        = pParentArchive;
-    pArchive->pFile                 = pArchiveFile;
-    pArchive->internalArchiveHandle = internalArchiveHandle;
-    pArchive->flags                 = 0;
-    pArchive->callbacks             = *pBackEndCallbacks;
-    drfs_drpath_copy_and_append(pArchive->absolutePath, sizeof(pArchive->absolutePath), pParentArchive->absolutePath, relativePath);
+                break;
+            }
+        }
 
-    *ppArchiveOut = pArchive;
-    return drfs_success;
+
+        // At this point all we need to do is create the remaining directories - we can assert that the directory does not exist
+        // rather than actually checking it which should be a bit more efficient.
+        while (drfs_drpath_next(&iPathSeg))
+        {
+            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
+                return false;
+            }
+
+            assert(!drfs_is_native_directory(runningPath));
+
+            if (drfs_mkdir_native(runningPath) != drfs_success) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    return false;
 }
 
-// Attempts to open an archive from another archive.
-static drfs_result drfs_open_non_native_archive_from_path(drfs_archive* pParentArchive, const char* relativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
+
+
+//// Native Archive Implementation ////
+
+typedef struct
 {
-    assert(pParentArchive != NULL);
-    assert(ppArchiveOut != NULL);
-    assert(relativePath != NULL);
+    // The access mode.
+    unsigned int accessMode;
 
-    *ppArchiveOut = NULL;
+    // The absolute path of the directory.
+    char absolutePath[DRFS_MAX_PATH];
 
-    drfs_archive_callbacks backendCallbacks;
-    if (!drfs_find_backend_by_extension(pParentArchive->pContext, drfs_drpath_extension(relativePath), &backendCallbacks)) {
-        return drfs_no_backend;
-    }
+} drfs_archive_native;
 
-    drfs_file* pArchiveFile;
-    drfs_result result = drfs_open_file_from_archive(pParentArchive, relativePath, accessMode, &pArchiveFile);
-    if (result != drfs_success) {
-        return result;
-    }
+static drfs_result drfs_open_archive__native(drfs_file* pArchiveFile, unsigned int accessMode, drfs_handle* pHandleOut)
+{
+    (void)pArchiveFile;
+    (void)accessMode;
 
-    drfs_archive* pArchive;
-    result = drfs_open_non_native_archive(pParentArchive, pArchiveFile, &backendCallbacks, relativePath, accessMode, &pArchive);
-    if (pArchive == NULL) {
-        return result;
+    // This function should never be called for native archives. Native archives are a special case because they are just directories
+    // on the file system rather than actual files, and as such they are handled just slightly differently. This function is only
+    // included here for this assert so we can ensure we don't incorrectly call this function.
+    assert(false);
+
+    *pHandleOut = NULL;
+    return drfs_unknown_error;
+}
+
+// The internal state of native archives is stored in the same pool allocation as the drfs_archive object, straight after
+// it, so this just initializes it in place rather than allocating anything.
+static drfs_result drfs_open_archive__native__special(const char* absolutePath, unsigned int accessMode, drfs_archive_native* pNativeArchive)
+{
+    assert(absolutePath != NULL);       // There is no notion of a file for native archives (which are just directories on the file system).
+    assert(pNativeArchive != NULL);
+
+    if (drfs__strcpy_s(pNativeArchive->absolutePath, sizeof(pNativeArchive->absolutePath), absolutePath) != 0) {
+        return drfs_path_too_long;
     }
 
-    *ppArchiveOut = pArchive;
+    pNativeArchive->accessMode = accessMode;
     return drfs_success;
 }
 
+static void drfs_close_archive__native(drfs_handle archive)
+{
+    // Nothing to do. The object is released along with the drfs_archive object that owns it.
+    (void)archive;
+}
 
-// Recursively opens the archive that owns the file at the given verbose path.
-static drfs_result drfs_open_owner_archive_recursively_from_verbose_path(drfs_archive* pParentArchive, const char* relativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
+static drfs_result drfs_get_file_info__native(drfs_handle archive, const char* relativePath, drfs_file_info* fi)
 {
-    assert(pParentArchive != NULL);
-    assert(relativePath != NULL);
-    assert(ppArchiveOut != NULL);
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
 
-    *ppArchiveOut = NULL;
+    char absolutePath[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
+        return drfs_path_too_long;
+    }
 
-    if (pParentArchive->callbacks.get_file_info == NULL) {
-        return drfs_no_backend;
+    if (fi != NULL) {
+        memset(fi, 0, sizeof(*fi));
     }
 
-    drfs_file_info fi;
-    if (pParentArchive->callbacks.get_file_info(pParentArchive->internalArchiveHandle, relativePath, &fi) == drfs_success)
-    {
-        // The file is in this archive.
-        drfs__strcpy_s(relativePathOut, relativePathOutSize, relativePath);
-        *ppArchiveOut = pParentArchive;
-        return drfs_success;
+    return drfs_get_native_file_info(absolutePath, fi);
+}
+
+static drfs_handle drfs_begin_iteration__native(drfs_handle archive, const char* relativePath)
+{
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
+
+    char absolutePath[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
+        return NULL;
     }
-    else
-    {
-        char runningPath[DRFS_MAX_PATH];
-        runningPath[0] = '\0';
 
-        drfs_drpath_iterator segment;
-        if (drfs_drpath_first(relativePath, &segment))
-        {
-            do
-            {
-                if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), segment)) {
-                    return drfs_path_too_long;
-                }
+    return drfs_begin_native_iteration(absolutePath);
+}
 
-                if (pParentArchive->callbacks.get_file_info(pParentArchive->internalArchiveHandle, runningPath, &fi) == drfs_success)
-                {
-                    if ((fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0)
-                    {
-                        // The running path points to an actual file. It could be a sub-archive.
-                        drfs_archive_callbacks backendCallbacks;
-                        if (drfs_find_backend_by_extension(pParentArchive->pContext, drfs_drpath_extension(runningPath), &backendCallbacks))
-                        {
-                            drfs_file* pNextArchiveFile;
-                            drfs_result result = drfs_open_file_from_archive(pParentArchive, runningPath, accessMode, &pNextArchiveFile);
-                            if (pNextArchiveFile == NULL) {
-                                break;    // Failed to open the archive file.
-                            }
+static void drfs_end_iteration__native(drfs_handle archive, drfs_handle iterator)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(iterator != NULL);
 
-                            drfs_archive* pNextArchive;
-                            result = drfs_open_non_native_archive(pParentArchive, pNextArchiveFile, &backendCallbacks, runningPath, accessMode, &pNextArchive);
-                            if (pNextArchive == NULL) {
-                                drfs_close(pNextArchiveFile);
-                                break;
-                            }
+    drfs_end_native_iteration(iterator);
+}
 
-                            // At this point we should have an archive. We now need to call this function recursively if there are any segments left.
-                            drfs_drpath_iterator nextsegment = segment;
-                            if (drfs_drpath_next(&nextsegment))
-                            {
-                                drfs_archive* pOwnerArchive;
-                                result = drfs_open_owner_archive_recursively_from_verbose_path(pNextArchive, nextsegment.path + nextsegment.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
-                                if (pOwnerArchive == NULL) {
-                                    drfs_close_archive(pNextArchive);
-                                    break;
-                                }
+static bool drfs_next_iteration__native(drfs_handle archive, drfs_handle iterator, drfs_file_info* fi)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(iterator != NULL);
 
-                                *ppArchiveOut = pOwnerArchive;
-                                return drfs_success;
-                            }
-                            else
-                            {
-                                // We reached the end of the path. If we get here it means the file doesn't exist, because otherwise we would have caught it in the check right at the top.
-                                drfs_close_archive(pNextArchive);
-                                break;
-                            }
-                        }
-                    }
-                }
-            } while (drfs_drpath_next(&segment));
-        }
+    return drfs_next_native_iteration(iterator, fi);
+}
 
-        // The running path is not part of this archive.
-        // NOTE: Is this the correct return value we should be using? Should we be returning an error and setting the output archive to NULL?
-        drfs__strcpy_s(relativePathOut, relativePathOutSize, relativePath);
-        *ppArchiveOut = pParentArchive;
-        return drfs_does_not_exist;
+static drfs_result drfs_delete_file__native(drfs_handle archive, const char* relativePath)
+{
+    assert(relativePath != NULL);
+
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
+
+    char absolutePath[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
+        return drfs_path_too_long;
     }
+
+    return drfs_delete_native_file(absolutePath);
 }
 
-// Opens the archive that owns the file at the given verbose path.
-static drfs_result drfs_open_owner_archive_from_absolute_path(drfs_context* pContext, const char* absolutePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
+static drfs_result drfs_rename_file__native(drfs_handle archive, const char* relativePathOld, const char* relativePathNew)
 {
-    assert(pContext != NULL);
-    assert(absolutePath != NULL);
-    assert(ppArchiveOut != NULL);
-
-    *ppArchiveOut = NULL;
+    assert(relativePathOld != NULL);
+    assert(relativePathNew != NULL);
 
-    // We are currently assuming absolute path's are verbose. This means we don't need to do any searching on the file system. We just
-    // move through the path and look for a segment with an extension matching one of the registered back-ends.
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
 
-    char runningPath[DRFS_MAX_PATH];
-    runningPath[0] = '\0';
+    char absolutePathOld[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePathOld, sizeof(absolutePathOld), pNativeArchive->absolutePath, relativePathOld)) {
+        return drfs_path_too_long;
+    }
 
-    if (absolutePath[0] == '/') {
-        runningPath[0] = '/';
-        runningPath[1] = '\0';
+    char absolutePathNew[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePathNew, sizeof(absolutePathNew), pNativeArchive->absolutePath, relativePathNew)) {
+        return drfs_path_too_long;
     }
 
-    drfs_drpath_iterator segment;
-    if (drfs_drpath_first(absolutePath, &segment))
-    {
-        do
-        {
-            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), segment)) {
-                return drfs_path_too_long;
-            }
+    return drfs_rename_native_file(absolutePathOld, absolutePathNew);
+}
 
-            if (!drfs_is_native_directory(runningPath))
-            {
-                char dirAbsolutePath[DRFS_MAX_PATH];
-                drfs_drpath_copy_base_path(runningPath, dirAbsolutePath, sizeof(dirAbsolutePath));
+static drfs_result drfs_create_directory__native(drfs_handle archive, const char* relativePath)
+{
+    assert(relativePath != NULL);
 
-                drfs_archive* pNativeArchive;
-                drfs_result result = drfs_open_native_archive(pContext, dirAbsolutePath, accessMode, &pNativeArchive);
-                if (result != drfs_success) {
-                    return result;    // Failed to open the native archive.
-                }
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
 
+    char absolutePath[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
+        return drfs_path_too_long;
+    }
 
-                // The running path is not a native directory. It could be an archive file.
-                drfs_archive_callbacks backendCallbacks;
-                if (drfs_find_backend_by_extension(pContext, drfs_drpath_extension(runningPath), &backendCallbacks))
-                {
-                    // The running path refers to an archive file. We need to try opening the archive here. If this fails, we
-                    // need to return NULL.
-                    drfs_archive* pArchive;
-                    drfs_result result = drfs_open_owner_archive_recursively_from_verbose_path(pNativeArchive, segment.path + segment.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pArchive);
-                    if (pArchive == NULL) {
-                        drfs_close_archive(pNativeArchive);
-                        return result;
-                    }
+    return drfs_mkdir_native(absolutePath);
+}
 
-                    *ppArchiveOut = pArchive;
-                    return drfs_success;
-                }
-                else
-                {
-                    drfs__strcpy_s(relativePathOut, relativePathOutSize, segment.path + segment.segment.offset);
-                    *ppArchiveOut = pNativeArchive;
-                    return drfs_success;
-                }
-            }
+static drfs_result drfs_copy_file__native(drfs_handle archive, const char* relativePathSrc, const char* relativePathDst, bool failIfExists)
+{
+    assert(relativePathSrc != NULL);
+    assert(relativePathDst != NULL);
 
-        } while (drfs_drpath_next(&segment));
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
+
+    char absolutePathSrc[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePathSrc, sizeof(absolutePathSrc), pNativeArchive->absolutePath, relativePathSrc)) {
+        return drfs_path_too_long;
     }
 
-    return drfs_does_not_exist;
+    char absolutePathDst[DRFS_MAX_PATH];
+    if (!drfs_drpath_copy_and_append(absolutePathDst, sizeof(absolutePathDst), pNativeArchive->absolutePath, relativePathDst)) {
+        return drfs_path_too_long;
+    }
+
+    return drfs_copy_native_file(absolutePathSrc, absolutePathDst, failIfExists);
 }
 
-// Recursively opens the archive that owns the file specified by the given relative path.
-static drfs_result drfs_open_owner_archive_recursively_from_relative_path(drfs_archive* pParentArchive, const char* rootSearchPath, const char* relativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
+static drfs_result drfs_open_file__native(drfs_handle archive, const char* relativePath, unsigned int accessMode, drfs_handle* pHandleOut)
 {
-    assert(pParentArchive != NULL);
+    assert(archive != NULL);
     assert(relativePath != NULL);
-    assert(ppArchiveOut != NULL);
 
-    *ppArchiveOut = NULL;
+    drfs_archive_native* pNativeArchive = archive;
+    assert(pNativeArchive != NULL);
 
-    if (pParentArchive->callbacks.get_file_info == NULL) {
-        return drfs_no_backend;
+    char absolutePath[DRFS_MAX_PATH];
+    if (drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), pNativeArchive->absolutePath, relativePath)) {
+        return drfs_open_native_file(absolutePath, accessMode, pHandleOut);
     }
 
-    // Always try the direct route by checking if the file exists within the archive first.
-    drfs_file_info fi;
-    if (pParentArchive->callbacks.get_file_info(pParentArchive->internalArchiveHandle, relativePath, &fi) == drfs_success)
-    {
-        // The file is in this archive.
-        drfs__strcpy_s(relativePathOut, relativePathOutSize, relativePath);
-        *ppArchiveOut = pParentArchive;
-        return drfs_success;
-    }
-    else
-    {
-        // The file does not exist within this archive. We need to search the parent archive recursively. We never search above
-        // the path specified by rootSearchPath.
-        char runningPath[DRFS_MAX_PATH];
-        drfs__strcpy_s(runningPath, sizeof(runningPath), rootSearchPath);
+    return drfs_path_too_long;
+}
 
-        // Part of rootSearchPath and relativePath will be overlapping. We want to begin searching at the non-overlapping section.
-        drfs_drpath_iterator pathSeg0;
-        drfs_drpath_iterator pathSeg1;
-        bool isSeg0Valid = drfs_drpath_first(rootSearchPath, &pathSeg0);
-        bool isSeg1Valid = drfs_drpath_first(relativePath,   &pathSeg1);
-        while (isSeg0Valid && isSeg1Valid) {
-            isSeg0Valid = drfs_drpath_next(&pathSeg0);
-            isSeg1Valid = drfs_drpath_next(&pathSeg1);
-        }
+static void drfs_close_file__native(drfs_handle archive, drfs_handle file)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-        relativePath = pathSeg1.path + pathSeg1.segment.offset;
+    drfs_close_native_file(file);
+}
 
-        // Searching works as such:
-        //   For each segment in "relativePath"
-        //       If segment is archive then
-        //           Open and search archive
-        //       Else
-        //           Search each archive file in this directory
-        //       Endif
-        drfs_drpath_iterator pathseg;
-        if (drfs_drpath_first(relativePath, &pathseg))
-        {
-            do
-            {
-                char runningPathBase[DRFS_MAX_PATH];
-                drfs__strcpy_s(runningPathBase, sizeof(runningPathBase), runningPath);
+static drfs_result drfs_read_file__native(drfs_handle archive, drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-                if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), pathseg)) {
-                    return drfs_path_too_long;
-                }
+    return drfs_read_native_file(file, pDataOut, bytesToRead, pBytesReadOut);
+}
 
-                drfs_archive* pNextArchive;
-                drfs_result result = drfs_open_non_native_archive_from_path(pParentArchive, runningPath, accessMode, &pNextArchive);
-                if (pNextArchive != NULL)
-                {
-                    // It's an archive segment. We need to check this archive recursively, starting from the next segment.
-                    drfs_drpath_iterator nextseg = pathseg;
-                    if (!drfs_drpath_next(&nextseg)) {
-                        // Should never actually get here, but if we do it means we've reached the end of the path. Assume the file could not be found.
-                        drfs_close_archive(pNextArchive);
-                        return drfs_unknown_error;
-                    }
+static drfs_result drfs_write_file__native(drfs_handle archive, drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-                    drfs_archive* pOwnerArchive;
-                    result = drfs_open_owner_archive_recursively_from_relative_path(pNextArchive, "", nextseg.path + nextseg.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
-                    if (pOwnerArchive == NULL) {
-                        drfs_close_archive(pNextArchive);
-                        return drfs_does_not_exist;
-                    }
+    return drfs_write_native_file(file, pData, bytesToWrite, pBytesWrittenOut);
+}
 
-                    *ppArchiveOut = pOwnerArchive;
-                    return drfs_success;
-                }
-                else
-                {
-                    // It's not an archive segment. We need to search.
-                    if (pParentArchive->callbacks.begin_iteration == NULL || pParentArchive->callbacks.next_iteration == NULL || pParentArchive->callbacks.end_iteration == NULL) {
-                        return drfs_no_backend;
-                    }
+static drfs_result drfs_seek_file__native(drfs_handle archive, drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-                    drfs_handle iterator = pParentArchive->callbacks.begin_iteration(pParentArchive->internalArchiveHandle, runningPathBase);
-                    if (iterator == NULL) {
-                        return drfs_no_backend;
-                    }
+    return drfs_seek_native_file(file, bytesToSeek, origin);
+}
 
-                    while (pParentArchive->callbacks.next_iteration(pParentArchive->internalArchiveHandle, iterator, &fi))
-                    {
-                        if ((fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0)
-                        {
-                            // It's a file which means it could be an archive. Note that fi.absolutePath is actually relative to the parent archive.
-                            drfs_open_non_native_archive_from_path(pParentArchive, fi.absolutePath, accessMode, &pNextArchive);
-                            if (pNextArchive != NULL)
-                            {
-                                // It's an archive, so check it.
-                                drfs_archive* pOwnerArchive;
-                                result = drfs_open_owner_archive_recursively_from_relative_path(pNextArchive, "", pathseg.path + pathseg.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
-                                if (pOwnerArchive != NULL) {
-                                    pParentArchive->callbacks.end_iteration(pParentArchive->internalArchiveHandle, iterator);
-                                    *ppArchiveOut = pOwnerArchive;
-                                    return drfs_success;
-                                } else {
-                                    drfs_close_archive(pNextArchive);
-                                }
-                            }
-                        }
-                    }
+static uint64_t drfs_tell_file__native(drfs_handle archive, drfs_handle file)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-                    pParentArchive->callbacks.end_iteration(pParentArchive->internalArchiveHandle, iterator);
-                }
+    return drfs_tell_native_file(file);
+}
 
-            } while (drfs_drpath_next(&pathseg));
-        }
-    }
+static uint64_t drfs_file_size__native(drfs_handle archive, drfs_handle file)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-    return drfs_does_not_exist;
+    return drfs_get_native_file_size(file);
 }
 
-// Opens the archive that owns the file at the given path that's relative to the given base path. This supports non-verbose paths and will search
-// the file system for the archive.
-static drfs_result drfs_open_owner_archive_from_relative_path(drfs_context* pContext, const char* absoluteBasePath, const char* relativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
+static void drfs_flush__native(drfs_handle archive, drfs_handle file)
 {
-    assert(pContext != NULL);
-    assert(absoluteBasePath != NULL);
-    assert(relativePath != NULL);
-    assert(drfs_drpath_is_absolute(absoluteBasePath));
-    assert(ppArchiveOut != NULL);
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
 
-    *ppArchiveOut = NULL;
+    drfs_flush_native_file(file);
+}
 
-    char adjustedRelativePath[DRFS_MAX_PATH];
-    char relativeBasePath[DRFS_MAX_PATH];
-    relativeBasePath[0] = '\0';
 
-    // The base path should be absolute and verbose. It does not need to be an actual directory.
-    drfs_archive* pBaseArchive = NULL;
-    if (drfs_is_native_directory(absoluteBasePath))
-    {
-        drfs_result result = drfs_open_native_archive(pContext, absoluteBasePath, accessMode, &pBaseArchive);
-        if (result != drfs_success) {
-            return result;
-        }
+// The implementations of drfs_open_archive() and drfs_open_owner_archive(). The context must be locked for reading.
+static drfs_result drfs_open_archive_nolock(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_archive** ppArchiveOut);
+static drfs_result drfs_open_owner_archive_nolock(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut);
 
-        if (drfs__strcpy_s(adjustedRelativePath, sizeof(adjustedRelativePath), relativePath) != 0) {
-            drfs_close_archive(pBaseArchive);
-            return drfs_path_too_long;
-        }
+// Finds the back-end callbacks by the given extension. The context must be locked for reading.
+static bool drfs_find_backend_by_extension(drfs_context* pContext, const char* extension, drfs_archive_callbacks* pCallbacksOut)
+{
+    if (pContext == NULL || extension == NULL || extension[0] == '\0') {
+        return false;
     }
-    else
+
+    for (unsigned int i = 0; i < pContext->archiveCallbacks.count; ++i)
     {
-        drfs_result result = drfs_open_owner_archive(pContext, absoluteBasePath, accessMode, relativeBasePath, sizeof(relativeBasePath), &pBaseArchive);
-        if (result != drfs_success) {
-            return result;
+        if (pContext->archiveCallbacks.pBuffer[i].is_valid_extension) {
+            if (pContext->archiveCallbacks.pBuffer[i].is_valid_extension(extension)) {
+                if (pCallbacksOut) {
+                    *pCallbacksOut = pContext->archiveCallbacks.pBuffer[i];
+                }
+                return true;
+            }
         }
+    }
 
-        if (!drfs_drpath_copy_and_append(adjustedRelativePath, sizeof(adjustedRelativePath), relativeBasePath, relativePath)) {
-            drfs_close_archive(pBaseArchive);
-            return drfs_path_too_long;
-        }
+    return false;
+}
+
+// Recursively claims ownership of parent archives so that when the child archive is deleted, so are it's parents.
+static void drfs_recursively_claim_ownership_or_parent_archive(drfs_archive* pArchive)
+{
+    if (pArchive == NULL) {
+        return;
     }
 
+    pArchive->flags |= DR_FS_OWNS_PARENT_ARCHIVE;
+    drfs_recursively_claim_ownership_or_parent_archive(pArchive->pParentArchive);
+}
 
-    // We couldn't open the archive file from here, so we'll need to search for the owner archive recursively.
-    drfs_archive* pOwnerArchive;
-    drfs_result result = drfs_open_owner_archive_recursively_from_relative_path(pBaseArchive, relativeBasePath, adjustedRelativePath, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
-    if (pOwnerArchive == NULL) {
+// Opens a native archive.
+static drfs_result drfs_open_native_archive(drfs_context* pContext, const char* absolutePath, unsigned int accessMode, drfs_archive** ppArchive)
+{
+    assert(pContext != NULL);
+    assert(ppArchive != NULL);
+    assert(absolutePath != NULL);
+
+    *ppArchive = NULL;
+
+    drfs_archive* pArchive = drfs_pool_alloc(&pContext->archivePool);
+    if (pArchive == NULL) {
+        return drfs_out_of_memory;
+    }
+
+    drfs_archive_native* pNativeArchive = (drfs_archive_native*)(pArchive + 1);
+    drfs_result result = drfs_open_archive__native__special(absolutePath, accessMode, pNativeArchive);
+    if (result != drfs_success) {
+        drfs_pool_free(&pContext->archivePool, pArchive);
         return result;
     }
 
-    drfs_recursively_claim_ownership_or_parent_archive(pOwnerArchive);
+    pArchive->pContext                     = pContext;
+    pArchive->pParentArchive               = NULL;
+    pArchive->pFile                        = NULL;
+    pArchive->internalArchiveHandle        = pNativeArchive;
+    pArchive->flags                        = 0;
+    pArchive->referenceCount               = 1;
+    pArchive->callbacks.is_valid_extension = NULL;
+    pArchive->callbacks.open_archive       = drfs_open_archive__native;
+    pArchive->callbacks.close_archive      = drfs_close_archive__native;
+    pArchive->callbacks.get_file_info      = drfs_get_file_info__native;
+    pArchive->callbacks.begin_iteration    = drfs_begin_iteration__native;
+    pArchive->callbacks.end_iteration      = drfs_end_iteration__native;
+    pArchive->callbacks.next_iteration     = drfs_next_iteration__native;
+    pArchive->callbacks.delete_file        = drfs_delete_file__native;
+    pArchive->callbacks.rename_file        = drfs_rename_file__native;
+    pArchive->callbacks.create_directory   = drfs_create_directory__native;
+    pArchive->callbacks.copy_file          = drfs_copy_file__native;
+    pArchive->callbacks.open_file          = drfs_open_file__native;
+    pArchive->callbacks.close_file         = drfs_close_file__native;
+    pArchive->callbacks.read_file          = drfs_read_file__native;
+    pArchive->callbacks.write_file         = drfs_write_file__native;
+    pArchive->callbacks.seek_file          = drfs_seek_file__native;
+    pArchive->callbacks.tell_file          = drfs_tell_file__native;
+    pArchive->callbacks.file_size          = drfs_file_size__native;
+    pArchive->callbacks.flush_file         = drfs_flush__native;
+    drfs__strcpy_s(pArchive->absolutePath, sizeof(pArchive->absolutePath), absolutePath);
 
-    *ppArchiveOut = pOwnerArchive;
+    *ppArchive = pArchive;
     return drfs_success;
 }
 
-// Opens an archive from a path that's relative to the given base path. This supports non-verbose paths and will search
-// the file system for the archive.
-static drfs_result drfs_open_archive_from_relative_path(drfs_context* pContext, const char* absoluteBasePath, const char* relativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
+// Opens an archive from a file and callbacks.
+static drfs_result drfs_open_non_native_archive(drfs_archive* pParentArchive, drfs_file* pArchiveFile, drfs_archive_callbacks* pBackEndCallbacks, const char* relativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
 {
-    assert(pContext != NULL);
-    assert(absoluteBasePath != NULL);
-    assert(relativePath != NULL);
-    assert(drfs_drpath_is_absolute(absoluteBasePath));
+    assert(pParentArchive != NULL);
+    assert(pArchiveFile != NULL);
+    assert(pBackEndCallbacks != NULL);
     assert(ppArchiveOut != NULL);
 
     *ppArchiveOut = NULL;
 
-    char adjustedRelativePath[DRFS_MAX_PATH];
-    char relativeBasePath[DRFS_MAX_PATH];
-    relativeBasePath[0] = '\0';
-
-    // The base path should be absolute and verbose. It does not need to be an actual directory.
-    drfs_archive* pBaseArchive = NULL;
-    if (drfs_is_native_directory(absoluteBasePath))
-    {
-        drfs_result result = drfs_open_native_archive(pContext, absoluteBasePath, accessMode, &pBaseArchive);
-        if (result != drfs_success) {
-            return result;
-        }
+    if (pBackEndCallbacks->open_archive == NULL) {
+        return drfs_no_backend;
+    }
 
-        if (drfs__strcpy_s(adjustedRelativePath, sizeof(adjustedRelativePath), relativePath) != 0) {
-            drfs_close_archive(pBaseArchive);
-            return drfs_path_too_long;
-        }
+    drfs_handle internalArchiveHandle;
+    drfs_result result = pBackEndCallbacks->open_archive(pArchiveFile, accessMode, &internalArchiveHandle);
+    if (result != drfs_success) {
+        return result;
     }
-    else
-    {
-        drfs_result result = drfs_open_owner_archive(pContext, absoluteBasePath, accessMode, relativeBasePath, sizeof(relativeBasePath), &pBaseArchive);
-        if (result != drfs_success) {
-            return result;
-        }
 
-        if (!drfs_drpath_copy_and_append(adjustedRelativePath, sizeof(adjustedRelativePath), relativeBasePath, relativePath)) {
-            drfs_close_archive(pBaseArchive);
-            return drfs_path_too_long;
-        }
+    drfs_archive* pArchive = drfs_pool_alloc(&pParentArchive->pContext->archivePool);
+    if (pArchive == NULL) {
+        pBackEndCallbacks->close_archive(internalArchiveHandle);
+        return drfs_out_of_memory;
     }
 
+    pArchive->pContext              = pParentArchive->pContext;
+    pArchive->pParentArchive        = pParentArchive;
+    pArchive->pFile                 = pArchiveFile;
+    pArchive->internalArchiveHandle = internalArchiveHandle;
+    pArchive->flags                 = 0;
+    pArchive->referenceCount        = 1;
+    pArchive->callbacks             = *pBackEndCallbacks;
+    drfs_drpath_copy_and_append(pArchive->absolutePath, sizeof(pArchive->absolutePath), pParentArchive->absolutePath, relativePath);
 
-    // We can try opening the file directly from the base path. If this doesn't work, we can try recursively opening the owner archive
-    // an open from there.
-    drfs_archive* pArchive;
-    drfs_result result = drfs_open_non_native_archive_from_path(pBaseArchive, adjustedRelativePath, accessMode, &pArchive);
-    if (pArchive == NULL)
-    {
-        // We couldn't open the archive file from here, so we'll need to search for the owner archive recursively.
-        char archiveRelativePath[DRFS_MAX_PATH];
-        drfs_archive* pOwnerArchive;
-        result = drfs_open_owner_archive_recursively_from_relative_path(pBaseArchive, relativeBasePath, adjustedRelativePath, accessMode, archiveRelativePath, sizeof(archiveRelativePath), &pOwnerArchive);
-        if (pOwnerArchive != NULL)
-        {
-            drfs_recursively_claim_ownership_or_parent_archive(pOwnerArchive);
+    *ppArchiveOut = pArchive;
+    return drfs_success;
+}
 
-            result = drfs_open_non_native_archive_from_path(pOwnerArchive, archiveRelativePath, accessMode, &pArchive);
-            if (pArchive == NULL) {
-                drfs_close_archive(pOwnerArchive);
-                return result;
-            }
-        }
+// Attempts to open an archive from another archive.
+static drfs_result drfs_open_non_native_archive_from_path(drfs_archive* pParentArchive, const char* relativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
+{
+    assert(pParentArchive != NULL);
+    assert(ppArchiveOut != NULL);
+    assert(relativePath != NULL);
+
+    *ppArchiveOut = NULL;
+
+    drfs_archive_callbacks backendCallbacks;
+    if (!drfs_find_backend_by_extension(pParentArchive->pContext, drfs_drpath_extension(relativePath), &backendCallbacks)) {
+        return drfs_no_backend;
+    }
+
+    drfs_file* pArchiveFile;
+    drfs_result result = drfs_open_file_from_archive(pParentArchive, relativePath, accessMode, &pArchiveFile);
+    if (result != drfs_success) {
+        return result;
     }
 
+    drfs_archive* pArchive;
+    result = drfs_open_non_native_archive(pParentArchive, pArchiveFile, &backendCallbacks, relativePath, accessMode, &pArchive);
     if (pArchive == NULL) {
-        drfs_close_archive(pBaseArchive);
-        return drfs_does_not_exist;
+        return result;
     }
 
     *ppArchiveOut = pArchive;
     return drfs_success;
 }
 
-//// Back-End Registration ////
-
-#ifndef DR_FS_NO_ZIP
-// Registers the archive callbacks which enables support for Zip files.
-static void drfs_register_zip_backend(drfs_context* pContext);
-#endif
-
-#ifndef DR_FS_NO_PAK
-// Registers the archive callbacks which enables support for Quake 2 pak files.
-static void drfs_register_pak_backend(drfs_context* pContext);
-#endif
-
-#ifndef DR_FS_NO_MTL
-// Registers the archive callbacks which enables support for Quake 2 pak files.
-static void drfs_register_mtl_backend(drfs_context* pContext);
-#endif
-
 
+// Recursively opens the archive that owns the file at the given verbose path.
+static drfs_result drfs_open_owner_archive_recursively_from_verbose_path(drfs_archive* pParentArchive, const char* relativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
+{
+    assert(pParentArchive != NULL);
+    assert(relativePath != NULL);
+    assert(ppArchiveOut != NULL);
 
-//// Public API Implementation ////
+    *ppArchiveOut = NULL;
 
-drfs_context* drfs_create_context()
-{
-    drfs_context* pContext = malloc(sizeof(*pContext));
-    if (pContext == NULL) {
-        return NULL;
+    if (pParentArchive->callbacks.get_file_info == NULL) {
+        return drfs_no_backend;
     }
 
-    if (!drfs_callbacklist_init(&pContext->archiveCallbacks) || !drfs_basedirs_init(&pContext->baseDirectories)) {
-        free(pContext);
-        return NULL;
+    drfs_file_info fi;
+    if (pParentArchive->callbacks.get_file_info(pParentArchive->internalArchiveHandle, relativePath, &fi) == drfs_success)
+    {
+        // The file is in this archive.
+        drfs__strcpy_s(relativePathOut, relativePathOutSize, relativePath);
+        *ppArchiveOut = pParentArchive;
+        return drfs_success;
     }
+    else
+    {
+        char runningPath[DRFS_MAX_PATH];
+        runningPath[0] = '\0';
 
-    memset(pContext->writeBaseDirectory, 0, DRFS_MAX_PATH);
-    pContext->isWriteGuardEnabled = 0;
+        drfs_drpath_iterator segment;
+        if (drfs_drpath_first(relativePath, &segment))
+        {
+            do
+            {
+                if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), segment)) {
+                    return drfs_path_too_long;
+                }
 
-#ifndef DR_FS_NO_ZIP
-    drfs_register_zip_backend(pContext);
-#endif
+                if (pParentArchive->callbacks.get_file_info(pParentArchive->internalArchiveHandle, runningPath, &fi) == drfs_success)
+                {
+                    if ((fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0)
+                    {
+                        // The running path points to an actual file. It could be a sub-archive.
+                        drfs_archive_callbacks backendCallbacks;
+                        if (drfs_find_backend_by_extension(pParentArchive->pContext, drfs_drpath_extension(runningPath), &backendCallbacks))
+                        {
+                            drfs_file* pNextArchiveFile;
+                            drfs_result result = drfs_open_file_from_archive(pParentArchive, runningPath, accessMode, &pNextArchiveFile);
+                            if (pNextArchiveFile == NULL) {
+                                break;    // Failed to open the archive file.
+                            }
 
-#ifndef DR_FS_NO_PAK
-    drfs_register_pak_backend(pContext);
-#endif
+                            drfs_archive* pNextArchive;
+                            result = drfs_open_non_native_archive(pParentArchive, pNextArchiveFile, &backendCallbacks, runningPath, accessMode, &pNextArchive);
+                            if (pNextArchive == NULL) {
+                                drfs_close(pNextArchiveFile);
+                                break;
+                            }
 
-#ifndef DR_FS_NO_MTL
-    drfs_register_mtl_backend(pContext);
-#endif
+                            // At this point we should have an archive. We now need to call this function recursively if there are any segments left.
+                            drfs_drpath_iterator nextsegment = segment;
+                            if (drfs_drpath_next(&nextsegment))
+                            {
+                                drfs_archive* pOwnerArchive;
+                                result = drfs_open_owner_archive_recursively_from_verbose_path(pNextArchive, nextsegment.path + nextsegment.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
+                                if (pOwnerArchive == NULL) {
+                                    drfs_close_archive(pNextArchive);
+                                    break;
+                                }
 
-    return pContext;
-}
+                                *ppArchiveOut = pOwnerArchive;
+                                return drfs_success;
+                            }
+                            else
+                            {
+                                // We reached the end of the path. If we get here it means the file doesn't exist, because otherwise we would have caught it in the check right at the top.
+                                drfs_close_archive(pNextArchive);
+                                break;
+                            }
+                        }
+                    }
+                }
+            } while (drfs_drpath_next(&segment));
+        }
 
-void drfs_delete_context(drfs_context* pContext)
-{
-    if (pContext == NULL) {
-        return;
+        // The running path is not part of this archive.
+        // NOTE: Is this the correct return value we should be using? Should we be returning an error and setting the output archive to NULL?
+        drfs__strcpy_s(relativePathOut, relativePathOutSize, relativePath);
+        *ppArchiveOut = pParentArchive;
+        return drfs_does_not_exist;
     }
-
-    drfs_basedirs_uninit(&pContext->baseDirectories);
-    drfs_callbacklist_uninit(&pContext->archiveCallbacks);
-    free(pContext);
 }
 
-
-void drfs_register_archive_backend(drfs_context* pContext, drfs_archive_callbacks callbacks)
+// Opens the archive that owns the file at the given verbose path.
+static drfs_result drfs_open_owner_archive_from_absolute_path(drfs_context* pContext, const char* absolutePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
 {
-    if (pContext == NULL) {
-        return;
-    }
-
-    drfs_callbacklist_pushback(&pContext->archiveCallbacks, callbacks);
-}
+    assert(pContext != NULL);
+    assert(absolutePath != NULL);
+    assert(ppArchiveOut != NULL);
 
+    *ppArchiveOut = NULL;
 
-void drfs_insert_base_directory(drfs_context* pContext, const char* absolutePath, unsigned int index)
-{
-    if (pContext == NULL) {
-        return;
-    }
+    // We are currently assuming absolute path's are verbose. This means we don't need to do any searching on the file system. We just
+    // move through the path and look for a segment with an extension matching one of the registered back-ends.
 
-    drfs_basedirs_insert(&pContext->baseDirectories, absolutePath, index);
-}
+    char runningPath[DRFS_MAX_PATH];
+    runningPath[0] = '\0';
 
-void drfs_add_base_directory(drfs_context* pContext, const char* absolutePath)
-{
-    if (pContext == NULL) {
-        return;
+    if (absolutePath[0] == '/') {
+        runningPath[0] = '/';
+        runningPath[1] = '\0';
     }
 
-    drfs_insert_base_directory(pContext, absolutePath, drfs_get_base_directory_count(pContext));
-}
-
-void drfs_remove_base_directory(drfs_context* pContext, const char* absolutePath)
-{
-    if (pContext == NULL) {
-        return;
-    }
+    drfs_drpath_iterator segment;
+    if (drfs_drpath_first(absolutePath, &segment))
+    {
+        do
+        {
+            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), segment)) {
+                return drfs_path_too_long;
+            }
 
-    for (unsigned int iPath = 0; iPath < pContext->baseDirectories.count; /*DO NOTHING*/) {
-        if (drfs_drpath_equal(pContext->baseDirectories.pBuffer[iPath].absolutePath, absolutePath)) {
-            drfs_basedirs_remove(&pContext->baseDirectories, iPath);
-        } else {
-            ++iPath;
-        }
-    }
-}
+            if (!drfs_is_native_directory(runningPath))
+            {
+                char dirAbsolutePath[DRFS_MAX_PATH];
+                drfs_drpath_copy_base_path(runningPath, dirAbsolutePath, sizeof(dirAbsolutePath));
 
-void drfs_remove_base_directory_by_index(drfs_context* pContext, unsigned int index)
-{
-    if (pContext == NULL) {
-        return;
-    }
+                drfs_archive* pNativeArchive;
+                drfs_result result = drfs_open_native_archive(pContext, dirAbsolutePath, accessMode, &pNativeArchive);
+                if (result != drfs_success) {
+                    return result;    // Failed to open the native archive.
+                }
 
-    drfs_basedirs_remove(&pContext->baseDirectories, index);
-}
 
-void drfs_remove_all_base_directories(drfs_context* pContext)
-{
-    if (pContext == NULL) {
-        return;
-    }
+                // The running path is not a native directory. It could be an archive file.
+                drfs_archive_callbacks backendCallbacks;
+                if (drfs_find_backend_by_extension(pContext, drfs_drpath_extension(runningPath), &backendCallbacks))
+                {
+                    // The running path refers to an archive file. We need to try opening the archive here. If this fails, we
+                    // need to return NULL.
+                    drfs_archive* pArchive;
+                    drfs_result result = drfs_open_owner_archive_recursively_from_verbose_path(pNativeArchive, segment.path + segment.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pArchive);
+                    if (pArchive == NULL) {
+                        drfs_close_archive(pNativeArchive);
+                        return result;
+                    }
 
-    drfs_basedirs_clear(&pContext->baseDirectories);
-}
+                    *ppArchiveOut = pArchive;
+                    return drfs_success;
+                }
+                else
+                {
+                    drfs__strcpy_s(relativePathOut, relativePathOutSize, segment.path + segment.segment.offset);
+                    *ppArchiveOut = pNativeArchive;
+                    return drfs_success;
+                }
+            }
 
-unsigned int drfs_get_base_directory_count(drfs_context* pContext)
-{
-    if (pContext == NULL) {
-        return 0;
+        } while (drfs_drpath_next(&segment));
     }
 
-    return pContext->baseDirectories.count;
+    return drfs_does_not_exist;
 }
 
-const char* drfs_get_base_directory_by_index(drfs_context* pContext, unsigned int index)
+// Recursively opens the archive that owns the file specified by the given relative path.
+static drfs_result drfs_open_owner_archive_recursively_from_relative_path(drfs_archive* pParentArchive, const char* rootSearchPath, const char* relativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
 {
-    if (pContext == NULL || index >= pContext->baseDirectories.count) {
-        return NULL;
-    }
-
-    return pContext->baseDirectories.pBuffer[index].absolutePath;
-}
-
+    assert(pParentArchive != NULL);
+    assert(relativePath != NULL);
+    assert(ppArchiveOut != NULL);
 
-void drfs_set_base_write_directory(drfs_context* pContext, const char* absolutePath)
-{
-    if (pContext == NULL) {
-        return;
-    }
+    *ppArchiveOut = NULL;
 
-    if (absolutePath == NULL) {
-        memset(pContext->writeBaseDirectory, 0, sizeof(pContext->writeBaseDirectory));
-    } else {
-        drfs__strcpy_s(pContext->writeBaseDirectory, sizeof(pContext->writeBaseDirectory), absolutePath);
+    if (pParentArchive->callbacks.get_file_info == NULL) {
+        return drfs_no_backend;
     }
-}
 
-bool drfs_get_base_write_directory(drfs_context* pContext, char* absolutePathOut, unsigned int absolutePathOutSize)
-{
-    if (pContext == NULL || absolutePathOut == NULL || absolutePathOutSize == 0) {
-        return false;
+    // Always try the direct route by checking if the file exists within the archive first.
+    drfs_file_info fi;
+    if (pParentArchive->callbacks.get_file_info(pParentArchive->internalArchiveHandle, relativePath, &fi) == drfs_success)
+    {
+        // The file is in this archive.
+        drfs__strcpy_s(relativePathOut, relativePathOutSize, relativePath);
+        *ppArchiveOut = pParentArchive;
+        return drfs_success;
     }
+    else
+    {
+        // The file does not exist within this archive. We need to search the parent archive recursively. We never search above
+        // the path specified by rootSearchPath.
+        char runningPath[DRFS_MAX_PATH];
+        drfs__strcpy_s(runningPath, sizeof(runningPath), rootSearchPath);
 
-    return drfs__strcpy_s(absolutePathOut, absolutePathOutSize, pContext->writeBaseDirectory) == 0;
-}
-
-void drfs_enable_write_directory_guard(drfs_context* pContext)
-{
-    if (pContext == NULL) {
-        return;
-    }
+        // Part of rootSearchPath and relativePath will be overlapping. We want to begin searching at the non-overlapping section.
+        drfs_drpath_iterator pathSeg0;
+        drfs_drpath_iterator pathSeg1;
+        bool isSeg0Valid = drfs_drpath_first(rootSearchPath, &pathSeg0);
+        bool isSeg1Valid = drfs_drpath_first(relativePath,   &pathSeg1);
+        while (isSeg0Valid && isSeg1Valid) {
+            isSeg0Valid = drfs_drpath_next(&pathSeg0);
+            isSeg1Valid = drfs_drpath_next(&pathSeg1);
+        }
 
-    pContext->isWriteGuardEnabled = true;
-}
+        relativePath = pathSeg1.path + pathSeg1.segment.offset;
 
-void drfs_disable_write_directory_guard(drfs_context* pContext)
-{
-    if (pContext == NULL) {
-        return;
-    }
+        // Searching works as such:
+        //   For each segment in "relativePath"
+        //       If segment is archive then
+        //           Open and search archive
+        //       Else
+        //           Search each archive file in this directory
+        //       Endif
+        drfs_drpath_iterator pathseg;
+        if (drfs_drpath_first(relativePath, &pathseg))
+        {
+            do
+            {
+                char runningPathBase[DRFS_MAX_PATH];
+                drfs__strcpy_s(runningPathBase, sizeof(runningPathBase), runningPath);
 
-    pContext->isWriteGuardEnabled = false;
-}
+                if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), pathseg)) {
+                    return drfs_path_too_long;
+                }
 
-bool drfs_is_write_directory_guard_enabled(drfs_context* pContext)
-{
-    if (pContext == NULL) {
-        return false;
-    }
+                drfs_archive* pNextArchive;
+                drfs_result result = drfs_open_non_native_archive_from_path(pParentArchive, runningPath, accessMode, &pNextArchive);
+                if (pNextArchive != NULL)
+                {
+                    // It's an archive segment. We need to check this archive recursively, starting from the next segment.
+                    drfs_drpath_iterator nextseg = pathseg;
+                    if (!drfs_drpath_next(&nextseg)) {
+                        // Should never actually get here, but if we do it means we've reached the end of the path. Assume the file could not be found.
+                        drfs_close_archive(pNextArchive);
+                        return drfs_unknown_error;
+                    }
 
-    return pContext->isWriteGuardEnabled;
-}
+                    drfs_archive* pOwnerArchive;
+                    result = drfs_open_owner_archive_recursively_from_relative_path(pNextArchive, "", nextseg.path + nextseg.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
+                    if (pOwnerArchive == NULL) {
+                        drfs_close_archive(pNextArchive);
+                        return drfs_does_not_exist;
+                    }
+
+                    *ppArchiveOut = pOwnerArchive;
+                    return drfs_success;
+                }
+                else
+                {
+                    // It's not an archive segment. We need to search.
+                    if (pParentArchive->callbacks.begin_iteration == NULL || pParentArchive->callbacks.next_iteration == NULL || pParentArchive->callbacks.end_iteration == NULL) {
+                        return drfs_no_backend;
+                    }
+
+                    drfs_handle iterator = pParentArchive->callbacks.begin_iteration(pParentArchive->internalArchiveHandle, runningPathBase);
+                    if (iterator == NULL) {
+                        return drfs_no_backend;
+                    }
+
+                    while (pParentArchive->callbacks.next_iteration(pParentArchive->internalArchiveHandle, iterator, &fi))
+                    {
+                        if ((fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0)
+                        {
+                            // It's a file which means it could be an archive. Note that fi.absolutePath is actually relative to the parent archive.
+                            drfs_open_non_native_archive_from_path(pParentArchive, fi.absolutePath, accessMode, &pNextArchive);
+                            if (pNextArchive != NULL)
+                            {
+                                // It's an archive, so check it.
+                                drfs_archive* pOwnerArchive;
+                                result = drfs_open_owner_archive_recursively_from_relative_path(pNextArchive, "", pathseg.path + pathseg.segment.offset, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
+                                if (pOwnerArchive != NULL) {
+                                    pParentArchive->callbacks.end_iteration(pParentArchive->internalArchiveHandle, iterator);
+                                    *ppArchiveOut = pOwnerArchive;
+                                    return drfs_success;
+                                } else {
+                                    drfs_close_archive(pNextArchive);
+                                }
+                            }
+                        }
+                    }
 
+                    pParentArchive->callbacks.end_iteration(pParentArchive->internalArchiveHandle, iterator);
+                }
 
+            } while (drfs_drpath_next(&pathseg));
+        }
+    }
 
+    return drfs_does_not_exist;
+}
 
-drfs_result drfs_open_archive(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
+// Opens the archive that owns the file at the given path that's relative to the given base path. This supports non-verbose paths and will search
+// the file system for the archive.
+static drfs_result drfs_open_owner_archive_from_relative_path(drfs_context* pContext, const char* absoluteBasePath, const char* relativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
 {
-    if (ppArchiveOut == NULL) {
-        return drfs_invalid_args;
-    }
+    assert(pContext != NULL);
+    assert(absoluteBasePath != NULL);
+    assert(relativePath != NULL);
+    assert(drfs_drpath_is_absolute(absoluteBasePath));
+    assert(ppArchiveOut != NULL);
 
     *ppArchiveOut = NULL;
 
-    if (pContext == NULL || absoluteOrRelativePath == NULL) {
-        return drfs_invalid_args;
-    }
+    char adjustedRelativePath[DRFS_MAX_PATH];
+    char relativeBasePath[DRFS_MAX_PATH];
+    relativeBasePath[0] = '\0';
 
-    if (drfs_drpath_is_absolute(absoluteOrRelativePath))
+    // The base path should be absolute and verbose. It does not need to be an actual directory.
+    drfs_archive* pBaseArchive = NULL;
+    if (drfs_is_native_directory(absoluteBasePath))
     {
-        if (drfs_is_native_directory(absoluteOrRelativePath))
-        {
-            // It's a native directory.
-            return drfs_open_native_archive(pContext, absoluteOrRelativePath, accessMode, ppArchiveOut);
+        drfs_result result = drfs_open_native_archive(pContext, absoluteBasePath, accessMode, &pBaseArchive);
+        if (result != drfs_success) {
+            return result;
         }
-        else
-        {
-            // It's not a native directory. We can just use drfs_open_owner_archive() in this case.
-            char relativePath[DRFS_MAX_PATH];
-            drfs_archive* pOwnerArchive;
-            drfs_result result = drfs_open_owner_archive(pContext, absoluteOrRelativePath, accessMode, relativePath, sizeof(relativePath), &pOwnerArchive);
-            if (result != drfs_success) {
-                return result;
-            }
-
-            drfs_archive* pArchive;
-            result = drfs_open_non_native_archive_from_path(pOwnerArchive, relativePath, accessMode, &pArchive);
-            if (result != drfs_success) {
-                drfs_close_archive(pOwnerArchive);
-                return result;
-            }
-
-            drfs_recursively_claim_ownership_or_parent_archive(pArchive);
 
-            *ppArchiveOut = pArchive;
-            return drfs_success;
+        if (drfs__strcpy_s(adjustedRelativePath, sizeof(adjustedRelativePath), relativePath) != 0) {
+            drfs_close_archive(pBaseArchive);
+            return drfs_path_too_long;
         }
     }
     else
     {
-        // The input path is not absolute. We need to check each base directory.
-
-        for (unsigned int iBaseDir = 0; iBaseDir < drfs_get_base_directory_count(pContext); ++iBaseDir)
-        {
-            drfs_archive* pArchive;
-            drfs_result result = drfs_open_archive_from_relative_path(pContext, drfs_get_base_directory_by_index(pContext, iBaseDir), absoluteOrRelativePath, accessMode, &pArchive);
-            if (pArchive != NULL) {
-                drfs_recursively_claim_ownership_or_parent_archive(pArchive);
+        drfs_result result = drfs_open_owner_archive_nolock(pContext, absoluteBasePath, accessMode, relativeBasePath, sizeof(relativeBasePath), &pBaseArchive);
+        if (result != drfs_success) {
+            return result;
+        }
 
-                *ppArchiveOut = pArchive;
-                return drfs_success;
-            }
+        if (!drfs_drpath_copy_and_append(adjustedRelativePath, sizeof(adjustedRelativePath), relativeBasePath, relativePath)) {
+            drfs_close_archive(pBaseArchive);
+            return drfs_path_too_long;
         }
     }
 
-    return drfs_does_not_exist;
-}
 
-drfs_result drfs_open_owner_archive(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
-{
-    if (ppArchiveOut == NULL) {
-        return drfs_invalid_args;
+    // We couldn't open the archive file from here, so we'll need to search for the owner archive recursively.
+    drfs_archive* pOwnerArchive;
+    drfs_result result = drfs_open_owner_archive_recursively_from_relative_path(pBaseArchive, relativeBasePath, adjustedRelativePath, accessMode, relativePathOut, relativePathOutSize, &pOwnerArchive);
+    if (pOwnerArchive == NULL) {
+        drfs_close_archive(pBaseArchive);
+        return result;
     }
 
-    *ppArchiveOut = NULL;
+    drfs_recursively_claim_ownership_or_parent_archive(pOwnerArchive);
 
-    if (pContext == NULL || absoluteOrRelativePath == NULL) {
-        return drfs_invalid_args;
-    }
+    *ppArchiveOut = pOwnerArchive;
+    return drfs_success;
+}
 
-    if (drfs_drpath_is_absolute(absoluteOrRelativePath))
-    {
-        if (drfs_is_native_file(absoluteOrRelativePath) || drfs_is_native_directory(absoluteOrRelativePath))
-        {
-            // It's a native file. The owner archive is the directory it's directly sitting in.
-            char dirAbsolutePath[DRFS_MAX_PATH];
-            drfs_drpath_copy_base_path(absoluteOrRelativePath, dirAbsolutePath, sizeof(dirAbsolutePath));
+// Opens an archive from a path that's relative to the given base path. This supports non-verbose paths and will search
+// the file system for the archive.
+static drfs_result drfs_open_archive_from_relative_path(drfs_context* pContext, const char* absoluteBasePath, const char* relativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
+{
+    assert(pContext != NULL);
+    assert(absoluteBasePath != NULL);
+    assert(relativePath != NULL);
+    assert(drfs_drpath_is_absolute(absoluteBasePath));
+    assert(ppArchiveOut != NULL);
 
-            drfs_archive* pArchive;
-            drfs_result result = drfs_open_archive(pContext, dirAbsolutePath, accessMode, &pArchive);
-            if (result != drfs_success) {
-                return result;
-            }
+    *ppArchiveOut = NULL;
 
-            if (relativePathOut) {
-                if (drfs__strcpy_s(relativePathOut, relativePathOutSize, drfs_drpath_file_name(absoluteOrRelativePath)) != 0) {
-                    drfs_close_archive(pArchive);
-                    return drfs_path_too_long;
-                }
-            }
+    char adjustedRelativePath[DRFS_MAX_PATH];
+    char relativeBasePath[DRFS_MAX_PATH];
+    relativeBasePath[0] = '\0';
 
-            *ppArchiveOut = pArchive;
-            return drfs_success;
+    // The base path should be absolute and verbose. It does not need to be an actual directory.
+    drfs_archive* pBaseArchive = NULL;
+    if (drfs_is_native_directory(absoluteBasePath))
+    {
+        drfs_result result = drfs_open_native_archive(pContext, absoluteBasePath, accessMode, &pBaseArchive);
+        if (result != drfs_success) {
+            return result;
         }
-        else
-        {
-            // It's not a native file or directory.
-            drfs_archive* pArchive;
-            drfs_result result = drfs_open_owner_archive_from_absolute_path(pContext, absoluteOrRelativePath, accessMode, relativePathOut, relativePathOutSize, &pArchive);
-            if (pArchive == NULL) {
-                return result;
-            }
 
-            drfs_recursively_claim_ownership_or_parent_archive(pArchive);
-
-            *ppArchiveOut = pArchive;
-            return drfs_success;
+        if (drfs__strcpy_s(adjustedRelativePath, sizeof(adjustedRelativePath), relativePath) != 0) {
+            drfs_close_archive(pBaseArchive);
+            return drfs_path_too_long;
         }
     }
     else
     {
-        // The input path is not absolute. We need to loop through each base directory.
-
-        for (unsigned int iBaseDir = 0; iBaseDir < drfs_get_base_directory_count(pContext); ++iBaseDir)
-        {
-            drfs_archive* pArchive;
-            drfs_result result = drfs_open_owner_archive_from_relative_path(pContext, drfs_get_base_directory_by_index(pContext, iBaseDir), absoluteOrRelativePath, accessMode, relativePathOut, relativePathOutSize, &pArchive);
-            if (pArchive != NULL)
-            {
-                drfs_recursively_claim_ownership_or_parent_archive(pArchive);
-
-                *ppArchiveOut = pArchive;
-                return drfs_success;
-            }
+        drfs_result result = drfs_open_owner_archive_nolock(pContext, absoluteBasePath, accessMode, relativeBasePath, sizeof(relativeBasePath), &pBaseArchive);
+        if (result != drfs_success) {
+            return result;
+        }
+
+        if (!drfs_drpath_copy_and_append(adjustedRelativePath, sizeof(adjustedRelativePath), relativeBasePath, relativePath)) {
+            drfs_close_archive(pBaseArchive);
+            return drfs_path_too_long;
         }
     }
 
-    return drfs_does_not_exist;
-}
 
-void drfs_close_archive(drfs_archive* pArchive)
-{
-    if (pArchive == NULL) {
-        return;
+    // We can try opening the file directly from the base path. If this doesn't work, we can try recursively opening the owner archive
+    // an open from there.
+    drfs_archive* pArchive;
+    drfs_result result = drfs_open_non_native_archive_from_path(pBaseArchive, adjustedRelativePath, accessMode, &pArchive);
+    if (pArchive == NULL)
+    {
+        // We couldn't open the archive file from here, so we'll need to search for the owner archive recursively.
+        char archiveRelativePath[DRFS_MAX_PATH];
+        drfs_archive* pOwnerArchive;
+        result = drfs_open_owner_archive_recursively_from_relative_path(pBaseArchive, relativeBasePath, adjustedRelativePath, accessMode, archiveRelativePath, sizeof(archiveRelativePath), &pOwnerArchive);
+        if (pOwnerArchive != NULL)
+        {
+            drfs_recursively_claim_ownership_or_parent_archive(pOwnerArchive);
+
+            result = drfs_open_non_native_archive_from_path(pOwnerArchive, archiveRelativePath, accessMode, &pArchive);
+            if (pArchive == NULL) {
+                drfs_close_archive(pOwnerArchive);
+                return result;
+            }
+        }
     }
 
-    // The internal handle needs to be closed.
-    if (pArchive->callbacks.close_archive) {
-        pArchive->callbacks.close_archive(pArchive->internalArchiveHandle);
+    if (pArchive == NULL) {
+        drfs_close_archive(pBaseArchive);
+        return drfs_does_not_exist;
     }
 
-    drfs_close(pArchive->pFile);
+    *ppArchiveOut = pArchive;
+    return drfs_success;
+}
 
+//// Back-End Registration ////
 
-    if ((pArchive->flags & DR_FS_OWNS_PARENT_ARCHIVE) != 0) {
-        drfs_close_archive(pArchive->pParentArchive);
-    }
+#ifndef DR_FS_NO_ZIP
+// Registers the archive callbacks which enables support for Zip files.
+static void drfs_register_zip_backend(drfs_context* pContext);
+static drfs_result drfs_begin_compressed_stream(drfs_file* pFile, unsigned int accessMode);
+static drfs_result drfs_end_compressed_stream(drfs_file* pFile);
+static drfs_result drfs_read_compressed_stream(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut);
+static drfs_result drfs_write_compressed_stream(drfs_file* pFile, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut);
+static drfs_result drfs_seek_compressed_stream(drfs_file* pFile, int64_t bytesToSeek, drfs_seek_origin origin);
+static uint64_t drfs_tell_compressed_stream(drfs_file* pFile);
+static uint64_t drfs_size_compressed_stream(drfs_file* pFile);
+#endif
 
-    free(pArchive);
-}
+#ifndef DR_FS_NO_PAK
+// Registers the archive callbacks which enables support for Quake 2 pak files.
+static void drfs_register_pak_backend(drfs_context* pContext);
+#endif
 
-drfs_result drfs_open_file_from_archive(drfs_archive* pArchive, const char* relativePath, unsigned int accessMode, drfs_file** ppFileOut)
-{
-    if (ppFileOut == NULL) {
-        return drfs_invalid_args;
-    }
+#ifndef DR_FS_NO_MTL
+// Registers the archive callbacks which enables support for Quake 2 pak files.
+static void drfs_register_mtl_backend(drfs_context* pContext);
+#endif
 
-    *ppFileOut = NULL;
 
-    if (pArchive == NULL || relativePath == NULL || pArchive->callbacks.open_file == NULL) {
-        return drfs_invalid_args;
+
+// Recursively adds every file and folder in the given directory of a mount point to the merged index.
+static drfs_result drfs_mountlist_index_directory(drfs_mountlist* pList, unsigned int mountIndex, const char* relativePath)
+{
+    assert(pList != NULL);
+    assert(relativePath != NULL);
+
+    drfs_archive* pArchive = pList->pMounts[mountIndex].pArchive;
+    if (pArchive->callbacks.begin_iteration == NULL || pArchive->callbacks.next_iteration == NULL || pArchive->callbacks.end_iteration == NULL) {
+        return drfs_no_backend;
     }
 
-    drfs_handle internalFileHandle;
-    drfs_result result = pArchive->callbacks.open_file(pArchive->internalArchiveHandle, relativePath, accessMode, &internalFileHandle);
-    if (result != drfs_success) {
-        return result;
+    drfs_handle iterator = pArchive->callbacks.begin_iteration(pArchive->internalArchiveHandle, relativePath);
+    if (iterator == NULL) {
+        return drfs_success;    // Nothing to index.
     }
 
-    // At this point the file is opened and we can create the file object.
-    drfs_file* pFile = malloc(sizeof(*pFile));
-    if (pFile == NULL) {
-        pArchive->callbacks.close_file(pArchive->internalArchiveHandle, internalFileHandle);
-        return drfs_out_of_memory;
+    drfs_result result = drfs_success;
+
+    drfs_file_info fi;
+    while (pArchive->callbacks.next_iteration(pArchive->internalArchiveHandle, iterator, &fi))
+    {
+        // Some backends return the full path relative to the archive, and others return just the file name so we normalize
+        // it by only looking at the file name.
+        char childPath[DRFS_MAX_PATH];
+        if (!drfs_drpath_copy_and_append(childPath, sizeof(childPath), relativePath, drfs_drpath_file_name(fi.absolutePath))) {
+            result = drfs_path_too_long;
+            break;
+        }
+
+        if (!drfs_mountlist_add_path(pList, childPath, mountIndex)) {
+            result = drfs_out_of_memory;
+            break;
+        }
+
+        if ((fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) != 0) {
+            result = drfs_mountlist_index_directory(pList, mountIndex, childPath);
+            if (result != drfs_success) {
+                break;
+            }
+        }
     }
 
-    pFile->pArchive           = pArchive;
-    pFile->internalFileHandle = internalFileHandle;
-    pFile->flags              = 0;
+    pArchive->callbacks.end_iteration(pArchive->internalArchiveHandle, iterator);
+    return result;
+}
 
-    // The lock.
-#ifdef _WIN32
-    InitializeCriticalSection(&pFile->lock);
-#else
-    if (pthread_mutex_init(&pFile->lock, NULL) != 0) {
-        drfs_close(pFile);
-        return drfs_unknown_error;
+// Rebuilds the merged index from scratch. This is used when a mount point is removed.
+static drfs_result drfs_mountlist_rebuild_index(drfs_mountlist* pList)
+{
+    assert(pList != NULL);
+
+    drfs_mountlist_clear_index(pList);
+
+    for (unsigned int iMount = 0; iMount < pList->count; ++iMount) {
+        drfs_result result = drfs_mountlist_index_directory(pList, iMount, "");
+        if (result != drfs_success) {
+            return result;
+        }
     }
-#endif
 
-    *ppFileOut = pFile;
     return drfs_success;
 }
 
-
-drfs_result drfs_open(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_file** ppFile)
+// Resolves the "." and ".." segments of a relative path and removes redundant slashes so it can be looked up in the mount
+// index. Returns false if the path goes above it's root or doesn't fit.
+static bool drfs_mountlist_normalize_path(const char* path, char* pathOut, size_t pathOutSize)
 {
-    if (ppFile == NULL) {
-        return drfs_invalid_args;
-    }
+    assert(path != NULL);
+    assert(pathOut != NULL);
+    assert(pathOutSize > 0);
 
-    // Always set the output file to null at the start for safety.
-    *ppFile = NULL;
+    size_t length = 0;
+    pathOut[0] = '\0';
 
-    if (pContext == NULL || absoluteOrRelativePath == NULL) {
-        return drfs_invalid_args;
+    drfs_drpath_iterator i;
+    if (!drfs_drpath_first(path, &i)) {
+        return true;
     }
 
-    char absolutePathForWriteMode[DRFS_MAX_PATH];
-    if ((accessMode & DRFS_WRITE) != 0) {
-        if (drfs_validate_write_path(pContext, absoluteOrRelativePath, absolutePathForWriteMode, sizeof(absolutePathForWriteMode))) {
-            absoluteOrRelativePath = absolutePathForWriteMode;
-        } else {
-            return drfs_not_in_write_directory;
+    do
+    {
+        const char* segment = path + i.segment.offset;
+        if (i.segment.length == 0 || (i.segment.length == 1 && segment[0] == '.')) {
+            continue;
         }
-    }
 
-    char relativePath[DRFS_MAX_PATH];
-    drfs_archive* pArchive;
-    drfs_result result = drfs_open_owner_archive(pContext, absoluteOrRelativePath, drfs_archive_access_mode(accessMode), relativePath, sizeof(relativePath), &pArchive);
-    if (result != drfs_success) {
-        return result;
-    }
+        if (i.segment.length == 2 && segment[0] == '.' && segment[1] == '.') {
+            if (length == 0) {
+                return false;
+            }
 
-    drfs_file* pFile;
-    result = drfs_open_file_from_archive(pArchive, relativePath, accessMode, &pFile);
-    if (result != drfs_success) {
-        drfs_close_archive(pArchive);
-        return result;
-    }
+            // Drop the last segment, including the slash in front of it.
+            while (length > 0 && pathOut[length - 1] != '/') {
+                length -= 1;
+            }
+            if (length > 0) {
+                length -= 1;
+            }
+        } else {
+            size_t separatorLength = (length > 0) ? 1 : 0;
+            if (length + separatorLength + i.segment.length + 1 > pathOutSize) {
+                return false;
+            }
 
-    // When using this API, we want to claim ownership of the archive so that it's closed when we close this file.
-    pFile->flags |= DR_FS_OWNS_PARENT_ARCHIVE;
+            if (separatorLength > 0) {
+                pathOut[length++] = '/';
+            }
 
-    *ppFile = pFile;
-    return drfs_success;
+            memcpy(pathOut + length, segment, i.segment.length);
+            length += i.segment.length;
+        }
+
+        pathOut[length] = '\0';
+    } while (drfs_drpath_next(&i));
+
+    return true;
 }
 
-void drfs_close(drfs_file* pFile)
+// Finds the mounted archive that owns the file at the given relative path. Returns NULL if the file is not in any mount point.
+//
+// The context must be locked for reading.
+static drfs_archive* drfs_find_mounted_archive(drfs_context* pContext, const char* relativePath, const char** pMountedPathOut)
 {
-    if (!drfs_lock(pFile)) {
-        return;
+    assert(pContext != NULL);
+    assert(relativePath != NULL);
+    assert(pMountedPathOut != NULL);
+
+    // The index is keyed on clean paths, so "./" and ".." segments need to be resolved first. A path that goes above the
+    // root of the mount points can't be in any of them.
+    char normalizedPath[DRFS_MAX_PATH];
+    if (!drfs_mountlist_normalize_path(relativePath, normalizedPath, sizeof(normalizedPath))) {
+        return NULL;
     }
 
-    if (pFile->pArchive != NULL && pFile->pArchive->callbacks.close_file) {
-        pFile->pArchive->callbacks.close_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
-        pFile->internalFileHandle = NULL;
+    unsigned int mountIndex;
+    const char* mountedPath = drfs_mountlist_find(&pContext->mounts, normalizedPath, &mountIndex);
+    if (mountedPath == NULL) {
+        return NULL;
     }
 
-    if ((pFile->flags & DR_FS_OWNS_PARENT_ARCHIVE) != 0) {
-        drfs_close_archive(pFile->pArchive);
-        pFile->pArchive = NULL;
+    *pMountedPathOut = mountedPath;
+    return pContext->mounts.pMounts[mountIndex].pArchive;
+}
+
+
+
+//// Public API Implementation ////
+
+drfs_context* drfs_create_context()
+{
+    drfs_context* pContext = DRFS_MALLOC(sizeof(*pContext));
+    if (pContext == NULL) {
+        return NULL;
     }
 
-    drfs_unlock(pFile);
+    if (!drfs_callbacklist_init(&pContext->archiveCallbacks) || !drfs_basedirs_init(&pContext->baseDirectories) || !drfs_mountlist_init(&pContext->mounts)) {
+        DRFS_FREE(pContext);
+        return NULL;
+    }
+
+    memset(pContext->writeBaseDirectory, 0, DRFS_MAX_PATH);
+    pContext->isWriteGuardEnabled = 0;
 
+    drfs_pool_init(&pContext->filePool, sizeof(drfs_file), 32);
+    drfs_pool_init(&pContext->archivePool, sizeof(drfs_archive) + sizeof(drfs_archive_native), 16);
 
-    // The lock.
 #ifdef _WIN32
-    DeleteCriticalSection(&pFile->lock);
+    InitializeSRWLock(&pContext->lock);
 #else
-    pthread_mutex_destroy(&pFile->lock);
+    // glibc's default reader-writer lock prefers readers which means a steady stream of opens from loader threads can stop
+    // a mount or base directory change from ever getting through. The lock is never taken recursively so it's safe to
+    // prefer writers instead.
+    pthread_rwlockattr_t lockAttributes;
+    pthread_rwlockattr_init(&lockAttributes);
+#if defined(__GLIBC__) && (defined(__USE_UNIX98) || defined(__USE_XOPEN2K))
+    pthread_rwlockattr_setkind_np(&lockAttributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
 #endif
 
-    free(pFile);
-}
+    int lockResult = pthread_rwlock_init(&pContext->lock, &lockAttributes);
+    pthread_rwlockattr_destroy(&lockAttributes);
 
-drfs_result drfs_read_nolock(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
-{
-    if (pFile == NULL || pDataOut == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.read_file == NULL) {
-        return drfs_invalid_args;
+    if (lockResult != 0) {
+        drfs_mountlist_uninit(&pContext->mounts);
+        drfs_basedirs_uninit(&pContext->baseDirectories);
+        drfs_callbacklist_uninit(&pContext->archiveCallbacks);
+        DRFS_FREE(pContext);
+        return NULL;
     }
+#endif
 
-    return pFile->pArchive->callbacks.read_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, pDataOut, bytesToRead, pBytesReadOut);
+#ifndef DR_FS_NO_ZIP
+    drfs_register_zip_backend(pContext);
+#endif
+
+#ifndef DR_FS_NO_PAK
+    drfs_register_pak_backend(pContext);
+#endif
+
+#ifndef DR_FS_NO_MTL
+    drfs_register_mtl_backend(pContext);
+#endif
+
+    return pContext;
 }
 
-drfs_result drfs_read(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+void drfs_delete_context(drfs_context* pContext)
 {
-    if (!drfs_lock(pFile)) {
-        return drfs_unknown_error;
+    if (pContext == NULL) {
+        return;
     }
 
-    drfs_result result = drfs_read_nolock(pFile, pDataOut, bytesToRead, pBytesReadOut);
+    drfs_mountlist_uninit(&pContext->mounts);
+    drfs_basedirs_uninit(&pContext->baseDirectories);
+    drfs_callbacklist_uninit(&pContext->archiveCallbacks);
+    drfs_pool_uninit(&pContext->filePool, drfs_file_uninit_lock);
+    drfs_pool_uninit(&pContext->archivePool, NULL);
 
-    drfs_unlock(pFile);
-    return result;
+#ifndef _WIN32
+    pthread_rwlock_destroy(&pContext->lock);
+#endif
+
+    DRFS_FREE(pContext);
 }
 
-drfs_result drfs_write_nolock(drfs_file* pFile, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+
+void drfs_register_archive_backend(drfs_context* pContext, drfs_archive_callbacks callbacks)
 {
-    if (pFile == NULL || pData == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.write_file == NULL) {
-        return drfs_invalid_args;
+    if (pContext == NULL) {
+        return;
     }
 
-    return pFile->pArchive->callbacks.write_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, pData, bytesToWrite, pBytesWrittenOut);
+    drfs_context_lock_write(pContext);
+    {
+        drfs_callbacklist_pushback(&pContext->archiveCallbacks, callbacks);
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-drfs_result drfs_write(drfs_file* pFile, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+
+void drfs_insert_base_directory(drfs_context* pContext, const char* absolutePath, unsigned int index)
 {
-    if (!drfs_lock(pFile)) {
-        return drfs_unknown_error;
+    if (pContext == NULL) {
+        return;
     }
 
-    drfs_result result = drfs_write_nolock(pFile, pData, bytesToWrite, pBytesWrittenOut);
-
-    drfs_unlock(pFile);
-    return result;
+    drfs_context_lock_write(pContext);
+    {
+        drfs_basedirs_insert(&pContext->baseDirectories, absolutePath, index);
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-drfs_result drfs_seek_nolock(drfs_file* pFile, int64_t bytesToSeek, drfs_seek_origin origin)
+void drfs_add_base_directory(drfs_context* pContext, const char* absolutePath)
 {
-    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.seek_file == NULL) {
-        return drfs_invalid_args;
+    if (pContext == NULL) {
+        return;
     }
 
-    return pFile->pArchive->callbacks.seek_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, bytesToSeek, origin);
+    drfs_context_lock_write(pContext);
+    {
+        drfs_basedirs_insert(&pContext->baseDirectories, absolutePath, pContext->baseDirectories.count);
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-drfs_result drfs_seek(drfs_file* pFile, int64_t bytesToSeek, drfs_seek_origin origin)
+void drfs_remove_base_directory(drfs_context* pContext, const char* absolutePath)
 {
-    if (!drfs_lock(pFile)) {
-        return drfs_unknown_error;
+    if (pContext == NULL) {
+        return;
     }
 
-    drfs_result result = drfs_seek_nolock(pFile, bytesToSeek, origin);
-
-    drfs_unlock(pFile);
-    return result;
+    drfs_context_lock_write(pContext);
+    {
+        for (unsigned int iPath = 0; iPath < pContext->baseDirectories.count; /*DO NOTHING*/) {
+            if (drfs_drpath_equal(pContext->baseDirectories.pBuffer[iPath].absolutePath, absolutePath)) {
+                drfs_basedirs_remove(&pContext->baseDirectories, iPath);
+            } else {
+                ++iPath;
+            }
+        }
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-uint64_t drfs_tell_nolock(drfs_file* pFile)
+void drfs_remove_base_directory_by_index(drfs_context* pContext, unsigned int index)
 {
-    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.tell_file == NULL) {
-        return false;
+    if (pContext == NULL) {
+        return;
     }
 
-    return pFile->pArchive->callbacks.tell_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
+    drfs_context_lock_write(pContext);
+    {
+        drfs_basedirs_remove(&pContext->baseDirectories, index);
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-uint64_t drfs_tell(drfs_file* pFile)
+void drfs_remove_all_base_directories(drfs_context* pContext)
 {
-    if (!drfs_lock(pFile)) {
-        return 0;
+    if (pContext == NULL) {
+        return;
     }
 
-    uint64_t result = drfs_tell_nolock(pFile);
-
-    drfs_unlock(pFile);
-    return result;
+    drfs_context_lock_write(pContext);
+    {
+        drfs_basedirs_clear(&pContext->baseDirectories);
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-uint64_t drfs_size_nolock(drfs_file* pFile)
+unsigned int drfs_get_base_directory_count(drfs_context* pContext)
 {
-    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.file_size == NULL) {
+    if (pContext == NULL) {
         return 0;
     }
 
-    return pFile->pArchive->callbacks.file_size(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
+    drfs_context_lock_read(pContext);
+    unsigned int count = pContext->baseDirectories.count;
+    drfs_context_unlock_read(pContext);
+
+    return count;
 }
 
-uint64_t drfs_size(drfs_file* pFile)
+const char* drfs_get_base_directory_by_index(drfs_context* pContext, unsigned int index)
 {
-    if (!drfs_lock(pFile)) {
-        return false;
+    if (pContext == NULL) {
+        return NULL;
     }
 
-    uint64_t result = drfs_size_nolock(pFile);
+    const char* absolutePath = NULL;
+    drfs_context_lock_read(pContext);
+    {
+        if (index < pContext->baseDirectories.count) {
+            absolutePath = pContext->baseDirectories.pBuffer[index].absolutePath;
+        }
+    }
+    drfs_context_unlock_read(pContext);
 
-    drfs_unlock(pFile);
-    return result;
+    return absolutePath;
 }
 
-void drfs_flush(drfs_file* pFile)
+
+void drfs_set_base_write_directory(drfs_context* pContext, const char* absolutePath)
 {
-    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.flush_file == NULL) {
+    if (pContext == NULL) {
         return;
     }
 
-    pFile->pArchive->callbacks.flush_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
+    drfs_context_lock_write(pContext);
+    {
+        if (absolutePath == NULL) {
+            memset(pContext->writeBaseDirectory, 0, sizeof(pContext->writeBaseDirectory));
+        } else {
+            drfs__strcpy_s(pContext->writeBaseDirectory, sizeof(pContext->writeBaseDirectory), absolutePath);
+        }
+    }
+    drfs_context_unlock_write(pContext);
 }
 
-
-bool drfs_lock(drfs_file* pFile)
+bool drfs_get_base_write_directory(drfs_context* pContext, char* absolutePathOut, unsigned int absolutePathOutSize)
 {
-    if (pFile == NULL || pFile->internalFileHandle == NULL) {
+    if (pContext == NULL || absolutePathOut == NULL || absolutePathOutSize == 0) {
         return false;
     }
 
-#ifdef _WIN32
-    EnterCriticalSection(&pFile->lock);
-#else
-    pthread_mutex_lock(&pFile->lock);
-#endif
+    drfs_context_lock_read(pContext);
+    bool result = drfs__strcpy_s(absolutePathOut, absolutePathOutSize, pContext->writeBaseDirectory) == 0;
+    drfs_context_unlock_read(pContext);
 
-    return true;
+    return result;
 }
 
-void drfs_unlock(drfs_file* pFile)
+void drfs_enable_write_directory_guard(drfs_context* pContext)
 {
-    if (pFile == NULL || pFile->internalFileHandle == NULL) {
+    if (pContext == NULL) {
         return;
     }
 
-#ifdef _WIN32
-    EnterCriticalSection(&pFile->lock);
-#else
-    pthread_mutex_unlock(&pFile->lock);
-#endif
+    drfs_context_lock_write(pContext);
+    pContext->isWriteGuardEnabled = true;
+    drfs_context_unlock_write(pContext);
 }
 
-
-drfs_result drfs_get_file_info(drfs_context* pContext, const char* absoluteOrRelativePath, drfs_file_info* fi)
+void drfs_disable_write_directory_guard(drfs_context* pContext)
 {
-    if (pContext == NULL || absoluteOrRelativePath == NULL) {
-        return drfs_invalid_args;
+    if (pContext == NULL) {
+        return;
     }
 
-    char relativePath[DRFS_MAX_PATH];
-    drfs_archive* pOwnerArchive;
-    drfs_result result = drfs_open_owner_archive(pContext, absoluteOrRelativePath, DRFS_READ, relativePath, sizeof(relativePath), &pOwnerArchive);
-    if (result != drfs_success) {
-        return result;
-    }
+    drfs_context_lock_write(pContext);
+    pContext->isWriteGuardEnabled = false;
+    drfs_context_unlock_write(pContext);
+}
 
-    result = drfs_no_backend;
-    if (pOwnerArchive->callbacks.get_file_info) {
-        result = pOwnerArchive->callbacks.get_file_info(pOwnerArchive->internalArchiveHandle, relativePath, fi);
+bool drfs_is_write_directory_guard_enabled(drfs_context* pContext)
+{
+    if (pContext == NULL) {
+        return false;
     }
 
-    if (result == drfs_success && fi != NULL) {
-        drfs_drpath_copy_and_append(fi->absolutePath, sizeof(fi->absolutePath), pOwnerArchive->absolutePath, relativePath);
-    }
+    drfs_context_lock_read(pContext);
+    bool isEnabled = pContext->isWriteGuardEnabled;
+    drfs_context_unlock_read(pContext);
 
-    drfs_close_archive(pOwnerArchive);
-    return result;
+    return isEnabled;
 }
 
 
-bool drfs_begin(drfs_context* pContext, const char* absoluteOrRelativePath, drfs_iterator* pIteratorOut)
+drfs_result drfs_mount(drfs_context* pContext, const char* absolutePath, int priority)
 {
-    if (pIteratorOut == NULL) {
-        return false;
+    if (pContext == NULL || absolutePath == NULL || !drfs_drpath_is_absolute(absolutePath)) {
+        return drfs_invalid_args;
     }
 
-    memset(pIteratorOut, 0, sizeof(*pIteratorOut));
-
-    if (pContext == NULL || absoluteOrRelativePath == NULL || pIteratorOut == NULL) {
-        return false;
+    drfs_archive* pArchive;
+    drfs_result result = drfs_open_archive(pContext, absolutePath, DRFS_READ, &pArchive);
+    if (result != drfs_success) {
+        return result;
     }
 
-    // We need to open the archive that the given folder is in. The path could, however, point to an actual archive which is allowed
-    // in which case we just iterate over the root directory within that archive. What we do is first try using the path as an actual
-    // archive. If it fails we assume the path is to a folder within an archive (such as a zip file) in which case we just try opening
-    // the owner archive. If both fail, we return false.
+    // The archive is opened before taking the exclusive lock so that other threads can keep opening files in the meantime.
+    drfs_context_lock_write(pContext);
+    {
+        if (!drfs_mountlist_pushback(&pContext->mounts, pArchive, priority)) {
+            drfs_context_unlock_write(pContext);
+            drfs_close_archive(pArchive);
+            return drfs_out_of_memory;
+        }
 
-    char relativePath[DRFS_MAX_PATH];
-    drfs_result result = drfs_open_archive(pContext, absoluteOrRelativePath, DRFS_READ, &pIteratorOut->pArchive);
-    if (result == drfs_success) {
-        relativePath[0] = '\0';
-    } else {
-        result = drfs_open_owner_archive(pContext, absoluteOrRelativePath, DRFS_READ, relativePath, sizeof(relativePath), &pIteratorOut->pArchive);
+        // Only the new mount point needs to be indexed. Anything it doesn't outrank will be left alone.
+        result = drfs_mountlist_index_directory(&pContext->mounts, pContext->mounts.count - 1, "");
         if (result != drfs_success) {
-            return false;
+            // The index may be partially referencing the new mount point so it needs to be rebuilt without it.
+            drfs_mountlist_remove(&pContext->mounts, pContext->mounts.count - 1);
+            drfs_mountlist_rebuild_index(&pContext->mounts);
         }
     }
+    drfs_context_unlock_write(pContext);
 
-    assert(pIteratorOut->pArchive != NULL);
-
-
-    if (pIteratorOut->pArchive->callbacks.begin_iteration) {
-        pIteratorOut->internalIteratorHandle = pIteratorOut->pArchive->callbacks.begin_iteration(pIteratorOut->pArchive->internalArchiveHandle, relativePath);
-    }
+    return result;
+}
 
-    if (pIteratorOut->internalIteratorHandle == NULL) {
-        drfs_close_archive(pIteratorOut->pArchive);
-        pIteratorOut->pArchive = NULL;
-        return false;
+drfs_result drfs_unmount(drfs_context* pContext, const char* absolutePath)
+{
+    if (pContext == NULL || absolutePath == NULL) {
+        return drfs_invalid_args;
     }
 
-
-    bool foundFirst = drfs_next(pContext, pIteratorOut);
-    if (!foundFirst) {
-        drfs_end(pContext, pIteratorOut);
+    drfs_result result = drfs_does_not_exist;
+    drfs_context_lock_write(pContext);
+    {
+        for (unsigned int iMount = 0; iMount < pContext->mounts.count; ++iMount)
+        {
+            if (drfs_drpath_equal(pContext->mounts.pMounts[iMount].pArchive->absolutePath, absolutePath)) {
+                drfs_mountlist_remove(&pContext->mounts, iMount);
+                result = drfs_mountlist_rebuild_index(&pContext->mounts);
+                break;
+            }
+        }
     }
+    drfs_context_unlock_write(pContext);
 
-    return foundFirst;
+    return result;
 }
 
-bool drfs_next(drfs_context* pContext, drfs_iterator* pIterator)
+void drfs_unmount_all(drfs_context* pContext)
 {
-    if (pIterator == NULL) {
-        return false;
+    if (pContext == NULL) {
+        return;
     }
 
-    memset(&pIterator->info, 0, sizeof(pIterator->info));
-
-    if (pContext == NULL || pIterator->pArchive == NULL) {
-        return false;
+    drfs_context_lock_write(pContext);
+    {
+        drfs_mountlist_uninit(&pContext->mounts);
+        drfs_mountlist_init(&pContext->mounts);
     }
+    drfs_context_unlock_write(pContext);
+}
 
-    bool result = false;
-    if (pIterator->pArchive->callbacks.next_iteration) {
-        result = pIterator->pArchive->callbacks.next_iteration(pIterator->pArchive->internalArchiveHandle, pIterator->internalIteratorHandle, &pIterator->info);
+unsigned int drfs_get_mount_count(drfs_context* pContext)
+{
+    if (pContext == NULL) {
+        return 0;
     }
 
-    // At this point the pIterator->info.absolutePath is actually referring to a relative path. We need to convert it to an absolute path.
-    if (result) {
-        char relativePath[DRFS_MAX_PATH];
-        drfs__strcpy_s(relativePath, sizeof(relativePath), pIterator->info.absolutePath);
-        drfs_drpath_copy_and_append(pIterator->info.absolutePath, sizeof(pIterator->info.absolutePath), pIterator->pArchive->absolutePath, relativePath);
-    }
+    drfs_context_lock_read(pContext);
+    unsigned int count = pContext->mounts.count;
+    drfs_context_unlock_read(pContext);
 
-    return result;
+    return count;
 }
 
-void drfs_end(drfs_context* pContext, drfs_iterator* pIterator)
-{
-    if (pContext == NULL || pIterator == NULL) {
-        return;
-    }
 
-    if (pIterator->pArchive != NULL && pIterator->pArchive->callbacks.end_iteration) {
-        pIterator->pArchive->callbacks.end_iteration(pIterator->pArchive->internalArchiveHandle, pIterator->internalIteratorHandle);
-    }
 
-    drfs_close_archive(pIterator->pArchive);
-    memset(pIterator, 0, sizeof(*pIterator));
-}
 
-drfs_result drfs_delete_file(drfs_context* pContext, const char* path)
+static drfs_result drfs_open_archive_nolock(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
 {
-    if (pContext == NULL || path == NULL) {
+    if (ppArchiveOut == NULL) {
         return drfs_invalid_args;
     }
 
-    char absolutePath[DRFS_MAX_PATH];
-    if (!drfs_validate_write_path(pContext, path, absolutePath, sizeof(absolutePath))) {
-        return drfs_not_in_write_directory;
+    *ppArchiveOut = NULL;
+
+    if (pContext == NULL || absoluteOrRelativePath == NULL) {
+        return drfs_invalid_args;
     }
 
+    if (drfs_drpath_is_absolute(absoluteOrRelativePath))
+    {
+        if (drfs_is_native_directory(absoluteOrRelativePath))
+        {
+            // It's a native directory.
+            return drfs_open_native_archive(pContext, absoluteOrRelativePath, accessMode, ppArchiveOut);
+        }
+        else
+        {
+            // It's not a native directory. We can just use drfs_open_owner_archive() in this case.
+            char relativePath[DRFS_MAX_PATH];
+            drfs_archive* pOwnerArchive;
+            drfs_result result = drfs_open_owner_archive_nolock(pContext, absoluteOrRelativePath, accessMode, relativePath, sizeof(relativePath), &pOwnerArchive);
+            if (result != drfs_success) {
+                return result;
+            }
+
+            drfs_archive* pArchive;
+            result = drfs_open_non_native_archive_from_path(pOwnerArchive, relativePath, accessMode, &pArchive);
+            if (result != drfs_success) {
+                drfs_close_archive(pOwnerArchive);
+                return result;
+            }
+
+            drfs_recursively_claim_ownership_or_parent_archive(pArchive);
 
-    char relativePath[DRFS_MAX_PATH];
-    drfs_archive* pArchive;
-    drfs_result result = drfs_open_owner_archive(pContext, absolutePath, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePath, sizeof(relativePath), &pArchive);
-    if (result != drfs_success) {
-        return result;
+            *ppArchiveOut = pArchive;
+            return drfs_success;
+        }
     }
+    else
+    {
+        // The input path is not absolute. We need to check each base directory.
 
-    result = drfs_no_backend;
-    if (pArchive->callbacks.delete_file) {
-        result = pArchive->callbacks.delete_file(pArchive->internalArchiveHandle, relativePath);
+        for (unsigned int iBaseDir = 0; iBaseDir < pContext->baseDirectories.count; ++iBaseDir)
+        {
+            drfs_archive* pArchive;
+            drfs_open_archive_from_relative_path(pContext, pContext->baseDirectories.pBuffer[iBaseDir].absolutePath, absoluteOrRelativePath, accessMode, &pArchive);
+            if (pArchive != NULL) {
+                drfs_recursively_claim_ownership_or_parent_archive(pArchive);
+
+                *ppArchiveOut = pArchive;
+                return drfs_success;
+            }
+        }
     }
 
-    drfs_close_archive(pArchive);
-    return result;
+    return drfs_does_not_exist;
 }
 
-drfs_result drfs_rename_file(drfs_context* pContext, const char* pathOld, const char* pathNew)
+static drfs_result drfs_open_owner_archive_nolock(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
 {
-    // Renaming/moving is not supported across different archives.
-
-    if (pContext == NULL || pathOld == NULL || pathNew == NULL) {
+    if (ppArchiveOut == NULL) {
         return drfs_invalid_args;
     }
 
+    *ppArchiveOut = NULL;
 
-    char absolutePathOld[DRFS_MAX_PATH];
-    if (drfs_validate_write_path(pContext, pathOld, absolutePathOld, sizeof(absolutePathOld))) {
-        pathOld = absolutePathOld;
-    } else {
-        return drfs_not_in_write_directory;
+    if (pContext == NULL || absoluteOrRelativePath == NULL) {
+        return drfs_invalid_args;
     }
 
-    char absolutePathNew[DRFS_MAX_PATH];
-    if (drfs_validate_write_path(pContext, pathNew, absolutePathNew, sizeof(absolutePathNew))) {
-        pathNew = absolutePathNew;
-    } else {
-        return drfs_not_in_write_directory;
-    }
+    if (drfs_drpath_is_absolute(absoluteOrRelativePath))
+    {
+        if (drfs_is_native_file(absoluteOrRelativePath) || drfs_is_native_directory(absoluteOrRelativePath))
+        {
+            // It's a native file. The owner archive is the directory it's directly sitting in.
+            char dirAbsolutePath[DRFS_MAX_PATH];
+            drfs_drpath_copy_base_path(absoluteOrRelativePath, dirAbsolutePath, sizeof(dirAbsolutePath));
 
+            drfs_archive* pArchive;
+            drfs_result result = drfs_open_archive_nolock(pContext, dirAbsolutePath, accessMode, &pArchive);
+            if (result != drfs_success) {
+                return result;
+            }
 
-    char relativePathOld[DRFS_MAX_PATH];
-    drfs_archive* pArchiveOld;
-    drfs_result result = drfs_open_owner_archive(pContext, pathOld, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePathOld, sizeof(relativePathOld), &pArchiveOld);
-    if (pArchiveOld != NULL)
-    {
-        char relativePathNew[DRFS_MAX_PATH];
-        drfs_archive* pArchiveNew;
-        result = drfs_open_owner_archive(pContext, pathNew, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePathNew, sizeof(relativePathNew), &pArchiveNew);
-        if (pArchiveNew != NULL)
+            if (relativePathOut) {
+                if (drfs__strcpy_s(relativePathOut, relativePathOutSize, drfs_drpath_file_name(absoluteOrRelativePath)) != 0) {
+                    drfs_close_archive(pArchive);
+                    return drfs_path_too_long;
+                }
+            }
+
+            *ppArchiveOut = pArchive;
+            return drfs_success;
+        }
+        else
         {
-            if (drfs_drpath_equal(pArchiveOld->absolutePath, pArchiveNew->absolutePath) && pArchiveOld->callbacks.rename_file) {
-                result = pArchiveOld->callbacks.rename_file(pArchiveOld, relativePathOld, relativePathNew);
-            } else {
-                result = drfs_permission_denied; // Attempting to rename across different archives which is not supported.
+            // It's not a native file or directory.
+            drfs_archive* pArchive;
+            drfs_result result = drfs_open_owner_archive_from_absolute_path(pContext, absoluteOrRelativePath, accessMode, relativePathOut, relativePathOutSize, &pArchive);
+            if (pArchive == NULL) {
+                return result;
             }
 
-            drfs_close_archive(pArchiveNew);
+            drfs_recursively_claim_ownership_or_parent_archive(pArchive);
+
+            *ppArchiveOut = pArchive;
+            return drfs_success;
         }
+    }
+    else
+    {
+        // The input path is not absolute. We need to loop through each base directory.
 
-        drfs_close_archive(pArchiveOld);
+        for (unsigned int iBaseDir = 0; iBaseDir < pContext->baseDirectories.count; ++iBaseDir)
+        {
+            drfs_archive* pArchive;
+            drfs_open_owner_archive_from_relative_path(pContext, pContext->baseDirectories.pBuffer[iBaseDir].absolutePath, absoluteOrRelativePath, accessMode, relativePathOut, relativePathOutSize, &pArchive);
+            if (pArchive != NULL)
+            {
+                drfs_recursively_claim_ownership_or_parent_archive(pArchive);
+
+                *ppArchiveOut = pArchive;
+                return drfs_success;
+            }
+        }
     }
 
-    return result;
+    return drfs_does_not_exist;
 }
 
-drfs_result drfs_create_directory(drfs_context* pContext, const char* path)
+drfs_result drfs_open_archive(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_archive** ppArchiveOut)
 {
-    if (pContext == NULL || path == NULL) {
+    if (pContext == NULL) {
+        if (ppArchiveOut != NULL) {
+            *ppArchiveOut = NULL;
+        }
         return drfs_invalid_args;
     }
 
-    char absolutePath[DRFS_MAX_PATH];
-    if (!drfs_validate_write_path(pContext, path, absolutePath, sizeof(absolutePath))) {
-        return drfs_not_in_write_directory;
-    }
+    drfs_context_lock_read(pContext);
+    drfs_result result = drfs_open_archive_nolock(pContext, absoluteOrRelativePath, accessMode, ppArchiveOut);
+    drfs_context_unlock_read(pContext);
 
-    char relativePath[DRFS_MAX_PATH];
-    drfs_archive* pArchive;
-    drfs_result result = drfs_open_owner_archive(pContext, absolutePath, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePath, sizeof(relativePath), &pArchive);
-    if (result != drfs_success) {
-        return result;
-    }
+    return result;
+}
 
-    result = drfs_no_backend;
-    if (pArchive->callbacks.create_directory) {
-        result = pArchive->callbacks.create_directory(pArchive->internalArchiveHandle, relativePath);
+drfs_result drfs_open_owner_archive(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, char* relativePathOut, size_t relativePathOutSize, drfs_archive** ppArchiveOut)
+{
+    if (pContext == NULL) {
+        if (ppArchiveOut != NULL) {
+            *ppArchiveOut = NULL;
+        }
+        return drfs_invalid_args;
     }
 
-    drfs_close_archive(pArchive);
+    drfs_context_lock_read(pContext);
+    drfs_result result = drfs_open_owner_archive_nolock(pContext, absoluteOrRelativePath, accessMode, relativePathOut, relativePathOutSize, ppArchiveOut);
+    drfs_context_unlock_read(pContext);
+
     return result;
 }
 
-drfs_result drfs_copy_file(drfs_context* pContext, const char* srcPath, const char* dstPath, bool failIfExists)
+void drfs_close_archive(drfs_archive* pArchive)
 {
-    if (pContext == NULL || srcPath == NULL || dstPath == NULL) {
-        return drfs_invalid_args;
+    if (pArchive == NULL) {
+        return;
     }
 
-    char dstPathAbsolute[DRFS_MAX_PATH];
-    if (!drfs_validate_write_path(pContext, dstPath, dstPathAbsolute, sizeof(dstPathAbsolute))) {
-        return drfs_not_in_write_directory;
+    // Mounted archives are shared with the files that were opened through them. Only the last reference closes it.
+    if (drfs__atomic_decrement(&pArchive->referenceCount) > 0) {
+        return;
     }
 
-
-    // We want to open the archive of both the source and destination. If they are the same archive we'll do an intra-archive copy.
-    char srcRelativePath[DRFS_MAX_PATH];
-    drfs_archive* pSrcArchive;
-    drfs_result result = drfs_open_owner_archive(pContext, srcPath, drfs_archive_access_mode(DRFS_READ), srcRelativePath, sizeof(srcRelativePath), &pSrcArchive);
-    if (result != drfs_success) {
-        return result;
+    // The internal handle needs to be closed.
+    if (pArchive->callbacks.close_archive) {
+        pArchive->callbacks.close_archive(pArchive->internalArchiveHandle);
     }
 
-    char dstRelativePath[DRFS_MAX_PATH];
-    drfs_archive* pDstArchive;
-    result = drfs_open_owner_archive(pContext, dstPathAbsolute, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), dstRelativePath, sizeof(dstRelativePath), &pDstArchive);
-    if (result != drfs_success) {
-        drfs_close_archive(pSrcArchive);
-        return result;
-    }
+    drfs_close(pArchive->pFile);
 
 
+    if ((pArchive->flags & DR_FS_OWNS_PARENT_ARCHIVE) != 0) {
+        drfs_close_archive(pArchive->pParentArchive);
+    }
 
-    result = drfs_success;
-    if (strcmp(pSrcArchive->absolutePath, pDstArchive->absolutePath) == 0 && pDstArchive->callbacks.copy_file)
-    {
-        // Intra-archive copy.
-        result = pDstArchive->callbacks.copy_file(pDstArchive->internalArchiveHandle, srcRelativePath, dstRelativePath, failIfExists);
+    drfs_pool_free(&pArchive->pContext->archivePool, pArchive);
+}
+
+drfs_result drfs_open_file_from_archive(drfs_archive* pArchive, const char* relativePath, unsigned int accessMode, drfs_file** ppFileOut)
+{
+    if (ppFileOut == NULL) {
+        return drfs_invalid_args;
     }
-    else
-    {
-        bool areBothArchivesNative = (pSrcArchive->callbacks.copy_file == pDstArchive->callbacks.copy_file && pDstArchive->callbacks.copy_file == drfs_copy_file__native);
-        if (areBothArchivesNative)
-        {
-            char srcPathAbsolute[DRFS_MAX_PATH];
-            drfs_drpath_copy_and_append(srcPathAbsolute, sizeof(srcPathAbsolute), pSrcArchive->absolutePath, srcPath);
 
-            result = drfs_copy_native_file(srcPathAbsolute, dstPathAbsolute, failIfExists);
-        }
-        else
-        {
-            // Inter-archive copy. This is a theoretically slower path because we do everything manually. Probably not much slower in practice, though.
-            if (failIfExists && pDstArchive->callbacks.get_file_info(pDstArchive, dstRelativePath, NULL) == drfs_success)
-            {
-                result = drfs_already_exists;
-            }
-            else
-            {
-                drfs_file* pSrcFile;
-                result = drfs_open_file_from_archive(pSrcArchive, srcRelativePath, DRFS_READ, &pSrcFile);
-                if (result != drfs_success) {
-                    return result;
-                }
+    *ppFileOut = NULL;
 
-                drfs_file* pDstFile;
-                result = drfs_open_file_from_archive(pDstArchive, dstRelativePath, DRFS_WRITE | DRFS_TRUNCATE, &pDstFile);
-                if (result != drfs_success) {
-                    drfs_close(pSrcFile);
-                    return result;
-                }
+    if (pArchive == NULL || relativePath == NULL || pArchive->callbacks.open_file == NULL) {
+        return drfs_invalid_args;
+    }
 
-                assert(pSrcFile != NULL);
-                assert(pDstFile != NULL);
+#ifdef DR_FS_NO_ZIP
+    if ((accessMode & DRFS_COMPRESSED) != 0) {
+        return drfs_no_backend;
+    }
+#endif
 
-                char chunk[4096];
-                size_t bytesRead;
-                while (drfs_read(pSrcFile, chunk, sizeof(chunk), &bytesRead) == drfs_success && bytesRead > 0)
-                {
-                    result = drfs_write(pDstFile, chunk, bytesRead, NULL);
-                    if (result != drfs_success) {
-                        break;
-                    }
-                }
+    drfs_handle internalFileHandle;
+    drfs_result result = pArchive->callbacks.open_file(pArchive->internalArchiveHandle, relativePath, accessMode & ~DRFS_COMPRESSED, &internalFileHandle);
+    if (result != drfs_success) {
+        return result;
+    }
 
-                drfs_close(pSrcFile);
-                drfs_close(pDstFile);
-            }
-        }
+    // At this point the file is opened and we can create the file object. The lock is left alone - it's either still
+    // initialized from the last time the object was used or it will be initialized when it's first needed.
+    drfs_file* pFile = drfs_pool_alloc(&pArchive->pContext->filePool);
+    if (pFile == NULL) {
+        pArchive->callbacks.close_file(pArchive->internalArchiveHandle, internalFileHandle);
+        return drfs_out_of_memory;
     }
 
+    pFile->pArchive           = pArchive;
+    pFile->internalFileHandle = internalFileHandle;
+    pFile->flags              = 0;
+    pFile->pCompressedStream  = NULL;
 
-    drfs_close_archive(pSrcArchive);
-    drfs_close_archive(pDstArchive);
+#ifndef DR_FS_NO_ZIP
+    if ((accessMode & DRFS_COMPRESSED) != 0) {
+        result = drfs_begin_compressed_stream(pFile, accessMode);
+        if (result != drfs_success) {
+            drfs_close(pFile);
+            return result;
+        }
+    }
+#endif
 
-    return result;
+    *ppFileOut = pFile;
+    return drfs_success;
 }
 
 
-bool drfs_is_archive_path(drfs_context* pContext, const char* path)
+// The implementation of drfs_open(). The context must be locked for reading.
+static drfs_result drfs_open_nolock(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_file** ppFile)
 {
-    return drfs_find_backend_by_extension(pContext, drfs_drpath_extension(path), NULL);
-}
+    assert(pContext != NULL);
+    assert(absoluteOrRelativePath != NULL);
+    assert(ppFile != NULL);
 
+    char absolutePathForWriteMode[DRFS_MAX_PATH];
+    if ((accessMode & DRFS_WRITE) != 0) {
+        if (drfs_validate_write_path(pContext, absoluteOrRelativePath, absolutePathForWriteMode, sizeof(absolutePathForWriteMode))) {
+            absoluteOrRelativePath = absolutePathForWriteMode;
+        } else {
+            return drfs_not_in_write_directory;
+        }
+    }
 
+    // Relative paths are looked up in the mount index first. Write paths will have been made absolute by this point so
+    // they are never routed through a mount point. The file takes a reference to the mounted archive so that it stays
+    // valid if the mount point is removed while the file is still open.
+    if (drfs_drpath_is_relative(absoluteOrRelativePath)) {
+        const char* mountedPath;
+        drfs_archive* pMountedArchive = drfs_find_mounted_archive(pContext, absoluteOrRelativePath, &mountedPath);
+        if (pMountedArchive != NULL) {
+            drfs__atomic_increment(&pMountedArchive->referenceCount);
 
-///////////////////////////////////////////////////////////////////////////////
-//
-// High Level API
-//
-///////////////////////////////////////////////////////////////////////////////
-#include <stdint.h>
-void drfs_free(void* p)
-{
-    free(p);
-}
+            drfs_result result = drfs_open_file_from_archive(pMountedArchive, mountedPath, accessMode, ppFile);
+            if (result != drfs_success) {
+                drfs_close_archive(pMountedArchive);
+                return result;
+            }
 
-bool drfs_find_absolute_path(drfs_context* pContext, const char* relativePath, char* absolutePathOut, size_t absolutePathOutSize)
-{
-    if (pContext == NULL || relativePath == NULL || absolutePathOut == NULL || absolutePathOutSize == 0) {
-        return false;
+            (*ppFile)->flags |= DR_FS_OWNS_PARENT_ARCHIVE;
+            return drfs_success;
+        }
     }
 
-    drfs_file_info fi;
-    if (drfs_get_file_info(pContext, relativePath, &fi) == drfs_success) {
-        return drfs__strcpy_s(absolutePathOut, absolutePathOutSize, fi.absolutePath) == 0;
+    char relativePath[DRFS_MAX_PATH];
+    drfs_archive* pArchive;
+    drfs_result result = drfs_open_owner_archive_nolock(pContext, absoluteOrRelativePath, drfs_archive_access_mode(accessMode), relativePath, sizeof(relativePath), &pArchive);
+    if (result != drfs_success) {
+        return result;
     }
 
-    return false;
+    drfs_file* pFile;
+    result = drfs_open_file_from_archive(pArchive, relativePath, accessMode, &pFile);
+    if (result != drfs_success) {
+        drfs_close_archive(pArchive);
+        return result;
+    }
+
+    // When using this API, we want to claim ownership of the archive so that it's closed when we close this file.
+    pFile->flags |= DR_FS_OWNS_PARENT_ARCHIVE;
+
+    *ppFile = pFile;
+    return drfs_success;
 }
 
-bool drfs_find_absolute_path_explicit_base(drfs_context* pContext, const char* relativePath, const char* highestPriorityBasePath, char* absolutePathOut, size_t absolutePathOutSize)
+drfs_result drfs_open(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, drfs_file** ppFile)
 {
-    if (pContext == NULL || relativePath == NULL || highestPriorityBasePath == NULL || absolutePathOut == NULL || absolutePathOutSize == 0) {
-        return false;
+    if (ppFile == NULL) {
+        return drfs_invalid_args;
     }
 
-    bool result = 0;
-    drfs_insert_base_directory(pContext, highestPriorityBasePath, 0);
-    {
-        result = drfs_find_absolute_path(pContext, relativePath, absolutePathOut, absolutePathOutSize);
+    // Always set the output file to null at the start for safety.
+    *ppFile = NULL;
+
+    if (pContext == NULL || absoluteOrRelativePath == NULL) {
+        return drfs_invalid_args;
     }
-    drfs_remove_base_directory_by_index(pContext, 0);
+
+    drfs_context_lock_read(pContext);
+    drfs_result result = drfs_open_nolock(pContext, absoluteOrRelativePath, accessMode, ppFile);
+    drfs_context_unlock_read(pContext);
 
     return result;
 }
 
-bool drfs_is_base_directory(drfs_context* pContext, const char* baseDir)
+void drfs_close(drfs_file* pFile)
 {
-    if (pContext == NULL) {
-        return false;
+    if (!drfs_lock(pFile)) {
+        return;
     }
 
-    for (unsigned int i = 0; i < drfs_get_base_directory_count(pContext); ++i) {
-        if (drfs_drpath_equal(drfs_get_base_directory_by_index(pContext, i), baseDir)) {
-            return true;
-        }
+    drfs_archive* pArchive = pFile->pArchive;
+    drfs_context* pContext = pArchive->pContext;
+
+#ifndef DR_FS_NO_ZIP
+    if (pFile->pCompressedStream != NULL) {
+        drfs_end_compressed_stream(pFile);
     }
+#endif
 
-    return false;
-}
+    if (pArchive->callbacks.close_file) {
+        pArchive->callbacks.close_file(pArchive->internalArchiveHandle, pFile->internalFileHandle);
+        pFile->internalFileHandle = NULL;
+    }
 
-bool drfs_write_string(drfs_file* pFile, const char* str)
-{
-    return drfs_write(pFile, str, (unsigned int)strlen(str), NULL) == drfs_success;
-}
+    bool ownsArchive = (pFile->flags & DR_FS_OWNS_PARENT_ARCHIVE) != 0;
+    pFile->pArchive = NULL;
 
-bool drfs_write_line(drfs_file* pFile, const char* str)
-{
-    return drfs_write_string(pFile, str) && drfs_write_string(pFile, "\n");
-}
+    // drfs_unlock() can't be used here because the internal file handle has been cleared. The lock itself is not destroyed
+    // so that it can be reused by the next file that gets this object from the pool.
+#ifdef _WIN32
+    LeaveCriticalSection(&pFile->lock);
+#else
+    pthread_mutex_unlock(&pFile->lock);
+#endif
 
+    drfs_pool_free(&pContext->filePool, pFile);
 
-void* drfs_open_and_read_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, size_t* pSizeInBytesOut)
+    // The archive is closed after the file has been unlocked so that the lock of the file containing the archive's data is
+    // never taken while holding this one.
+    if (ownsArchive) {
+        drfs_close_archive(pArchive);
+    }
+}
+
+drfs_result drfs_read_nolock(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
 {
-    drfs_file* pFile;
-    if (drfs_open(pContext, absoluteOrRelativePath, DRFS_READ, &pFile) != drfs_success) {
-        return NULL;
+    if (pFile == NULL || pDataOut == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.read_file == NULL) {
+        return drfs_invalid_args;
     }
 
-    uint64_t fileSize = drfs_size(pFile);
-    if (fileSize > SIZE_MAX)
-    {
-        // File's too big.
-        drfs_close(pFile);
-        return NULL;
+#ifndef DR_FS_NO_ZIP
+    if (pFile->pCompressedStream != NULL) {
+        return drfs_read_compressed_stream(pFile, pDataOut, bytesToRead, pBytesReadOut);
     }
+#endif
 
+    return pFile->pArchive->callbacks.read_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, pDataOut, bytesToRead, pBytesReadOut);
+}
 
-    void* pData = malloc((size_t)fileSize);
-    if (pData == NULL)
-    {
-        // Failed to allocate memory.
-        drfs_close(pFile);
-        return NULL;
+drfs_result drfs_read(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+{
+    if (!drfs_lock(pFile)) {
+        return drfs_unknown_error;
     }
 
+    drfs_result result = drfs_read_nolock(pFile, pDataOut, bytesToRead, pBytesReadOut);
 
-    if (drfs_read(pFile, pData, (size_t)fileSize, NULL) != drfs_success)
-    {
-        free(pData);
-        if (pSizeInBytesOut != NULL) {
-            *pSizeInBytesOut = 0;
-        }
+    drfs_unlock(pFile);
+    return result;
+}
 
-        drfs_close(pFile);
-        return NULL;
+drfs_result drfs_write_nolock(drfs_file* pFile, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+{
+    if (pFile == NULL || pData == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.write_file == NULL) {
+        return drfs_invalid_args;
     }
 
-
-    if (pSizeInBytesOut != NULL) {
-        *pSizeInBytesOut = (size_t)fileSize;
+#ifndef DR_FS_NO_ZIP
+    if (pFile->pCompressedStream != NULL) {
+        return drfs_write_compressed_stream(pFile, pData, bytesToWrite, pBytesWrittenOut);
     }
+#endif
 
-    drfs_close(pFile);
-    return pData;
+    return pFile->pArchive->callbacks.write_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, pData, bytesToWrite, pBytesWrittenOut);
 }
 
-char* drfs_open_and_read_text_file(drfs_context* pContext, const char* absoluteOrRelativePath, size_t* pSizeInBytesOut)
+drfs_result drfs_write(drfs_file* pFile, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
 {
-    drfs_file* pFile;
-    if (drfs_open(pContext, absoluteOrRelativePath, DRFS_READ, &pFile) != drfs_success) {
-        return NULL;
+    if (!drfs_lock(pFile)) {
+        return drfs_unknown_error;
     }
 
-    uint64_t fileSize = drfs_size(pFile);
-    if (fileSize > SIZE_MAX)
-    {
-        // File's too big.
-        drfs_close(pFile);
-        return NULL;
-    }
+    drfs_result result = drfs_write_nolock(pFile, pData, bytesToWrite, pBytesWrittenOut);
 
+    drfs_unlock(pFile);
+    return result;
+}
 
-    void* pData = malloc((size_t)fileSize + 1);     // +1 for null terminator.
-    if (pData == NULL)
-    {
-        // Failed to allocate memory.
-        drfs_close(pFile);
-        return NULL;
+drfs_result drfs_seek_nolock(drfs_file* pFile, int64_t bytesToSeek, drfs_seek_origin origin)
+{
+    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.seek_file == NULL) {
+        return drfs_invalid_args;
     }
 
+#ifndef DR_FS_NO_ZIP
+    if (pFile->pCompressedStream != NULL) {
+        return drfs_seek_compressed_stream(pFile, bytesToSeek, origin);
+    }
+#endif
 
-    if (drfs_read(pFile, pData, (size_t)fileSize, NULL) != drfs_success)
-    {
-        free(pData);
-        if (pSizeInBytesOut != NULL) {
-            *pSizeInBytesOut = 0;
-        }
+    return pFile->pArchive->callbacks.seek_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, bytesToSeek, origin);
+}
 
-        drfs_close(pFile);
-        return NULL;
+drfs_result drfs_seek(drfs_file* pFile, int64_t bytesToSeek, drfs_seek_origin origin)
+{
+    if (!drfs_lock(pFile)) {
+        return drfs_unknown_error;
     }
 
-    // Null terminator.
-    ((char*)pData)[fileSize] = '\0';
+    drfs_result result = drfs_seek_nolock(pFile, bytesToSeek, origin);
+
+    drfs_unlock(pFile);
+    return result;
+}
 
+uint64_t drfs_tell_nolock(drfs_file* pFile)
+{
+    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.tell_file == NULL) {
+        return false;
+    }
 
-    if (pSizeInBytesOut != NULL) {
-        *pSizeInBytesOut = (size_t)fileSize;
+#ifndef DR_FS_NO_ZIP
+    if (pFile->pCompressedStream != NULL) {
+        return drfs_tell_compressed_stream(pFile);
     }
+#endif
 
-    drfs_close(pFile);
-    return pData;
+    return pFile->pArchive->callbacks.tell_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
 }
 
-bool drfs_open_and_write_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, const void* pData, size_t dataSize)
+uint64_t drfs_tell(drfs_file* pFile)
 {
-    drfs_file* pFile;
-    if (drfs_open(pContext, absoluteOrRelativePath, DRFS_WRITE | DRFS_TRUNCATE, &pFile) != drfs_success) {
-        return false;
+    if (!drfs_lock(pFile)) {
+        return 0;
     }
 
-    drfs_result result = drfs_write(pFile, pData, dataSize, NULL);
+    uint64_t result = drfs_tell_nolock(pFile);
 
-    drfs_close(pFile);
-    return result == drfs_success;
+    drfs_unlock(pFile);
+    return result;
 }
 
-bool drfs_open_and_write_text_file(drfs_context* pContext, const char* absoluteOrRelativePath, const char* pTextData)
+uint64_t drfs_size_nolock(drfs_file* pFile)
 {
-    return drfs_open_and_write_binary_file(pContext, absoluteOrRelativePath, pTextData, strlen(pTextData));
-}
+    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.file_size == NULL) {
+        return 0;
+    }
 
+#ifndef DR_FS_NO_ZIP
+    if (pFile->pCompressedStream != NULL) {
+        return drfs_size_compressed_stream(pFile);
+    }
+#endif
 
-bool drfs_exists(drfs_context* pContext, const char* absoluteOrRelativePath)
-{
-    drfs_file_info fi;
-    return drfs_get_file_info(pContext, absoluteOrRelativePath, &fi) == drfs_success;
+    return pFile->pArchive->callbacks.file_size(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
 }
 
-bool drfs_is_existing_file(drfs_context* pContext, const char* absoluteOrRelativePath)
+uint64_t drfs_size(drfs_file* pFile)
 {
-    drfs_file_info fi;
-    if (drfs_get_file_info(pContext, absoluteOrRelativePath, &fi) == drfs_success)
-    {
-        return (fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0;
+    if (!drfs_lock(pFile)) {
+        return false;
     }
 
-    return false;
+    uint64_t result = drfs_size_nolock(pFile);
+
+    drfs_unlock(pFile);
+    return result;
 }
 
-bool drfs_is_existing_directory(drfs_context* pContext, const char* absoluteOrRelativePath)
+void drfs_flush(drfs_file* pFile)
 {
-    drfs_file_info fi;
-    if (drfs_get_file_info(pContext, absoluteOrRelativePath, &fi) == drfs_success)
-    {
-        return (fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) != 0;
+    if (pFile == NULL || pFile->pArchive == NULL || pFile->pArchive->callbacks.flush_file == NULL) {
+        return;
     }
 
-    return false;
+    pFile->pArchive->callbacks.flush_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
 }
 
-drfs_result drfs_create_directory_recursive(drfs_context* pContext, const char* path)
+
+bool drfs_lock(drfs_file* pFile)
 {
-    if (pContext == NULL || path == NULL) {
-        return drfs_invalid_args;
+    if (pFile == NULL || pFile->internalFileHandle == NULL) {
+        return false;
     }
 
-    // We just iterate over each segment and try creating each directory if it doesn't exist.
-    char absolutePath[DRFS_MAX_PATH];
-    if (drfs_validate_write_path(pContext, path, absolutePath, DRFS_MAX_PATH)) {
-        path = absolutePath;
-    } else {
-        return drfs_not_in_write_directory;
+    if (!drfs_file_init_lock(pFile)) {
+        return false;
     }
 
+#ifdef _WIN32
+    EnterCriticalSection(&pFile->lock);
+#else
+    pthread_mutex_lock(&pFile->lock);
+#endif
 
-    char runningPath[DRFS_MAX_PATH];
-    runningPath[0] = '\0';
+    return true;
+}
 
-    drfs_drpath_iterator iPathSeg;
-    if (!drfs_drpath_first(absolutePath, &iPathSeg)) {
-        return drfs_invalid_args;
+void drfs_unlock(drfs_file* pFile)
+{
+    if (pFile == NULL || pFile->internalFileHandle == NULL) {
+        return;
     }
 
-    // Never check the first segment because we can assume it always exists - it will always be the drive root.
-    if (drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg))
-    {
-        // Loop over every directory until we find one that does not exist.
-        while (drfs_drpath_next(&iPathSeg))
-        {
-            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
-                return drfs_path_too_long;
-            }
-
-            if (!drfs_is_existing_directory(pContext, runningPath)) {
-                drfs_result result = drfs_create_directory(pContext, runningPath);
-                if (result != drfs_success) {
-                    return result;
-                }
+#ifdef _WIN32
+    LeaveCriticalSection(&pFile->lock);
+#else
+    pthread_mutex_unlock(&pFile->lock);
+#endif
+}
 
-                break;
-            }
-        }
 
+// The implementation of drfs_get_file_info(). The context must be locked for reading.
+static drfs_result drfs_get_file_info_nolock(drfs_context* pContext, const char* absoluteOrRelativePath, drfs_file_info* fi)
+{
+    assert(pContext != NULL);
+    assert(absoluteOrRelativePath != NULL);
 
-        // At this point all we need to do is create the remaining directories - we can assert that the directory does not exist
-        // rather than actually checking it which should be a bit more efficient.
-        while (drfs_drpath_next(&iPathSeg))
-        {
-            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
-                return drfs_path_too_long;
+    if (drfs_drpath_is_relative(absoluteOrRelativePath)) {
+        const char* mountedPath;
+        drfs_archive* pMountedArchive = drfs_find_mounted_archive(pContext, absoluteOrRelativePath, &mountedPath);
+        if (pMountedArchive != NULL) {
+            drfs_result result = drfs_no_backend;
+            if (pMountedArchive->callbacks.get_file_info) {
+                result = pMountedArchive->callbacks.get_file_info(pMountedArchive->internalArchiveHandle, mountedPath, fi);
             }
 
-            assert(!drfs_is_existing_directory(pContext, runningPath));
+            if (result == drfs_success && fi != NULL) {
+                drfs_drpath_copy_and_append(fi->absolutePath, sizeof(fi->absolutePath), pMountedArchive->absolutePath, mountedPath);
+            }
 
-            drfs_result result = drfs_create_directory(pContext, runningPath);
-            if (result != drfs_success) {
-                return result;
-            }
+            return result;
         }
+    }
 
+    char relativePath[DRFS_MAX_PATH];
+    drfs_archive* pOwnerArchive;
+    drfs_result result = drfs_open_owner_archive_nolock(pContext, absoluteOrRelativePath, DRFS_READ, relativePath, sizeof(relativePath), &pOwnerArchive);
+    if (result != drfs_success) {
+        return result;
+    }
 
-        return drfs_success;
+    result = drfs_no_backend;
+    if (pOwnerArchive->callbacks.get_file_info) {
+        result = pOwnerArchive->callbacks.get_file_info(pOwnerArchive->internalArchiveHandle, relativePath, fi);
     }
-    else
-    {
-        return drfs_invalid_args;
+
+    if (result == drfs_success && fi != NULL) {
+        drfs_drpath_copy_and_append(fi->absolutePath, sizeof(fi->absolutePath), pOwnerArchive->absolutePath, relativePath);
     }
+
+    drfs_close_archive(pOwnerArchive);
+    return result;
 }
 
-bool drfs_eof(drfs_file* pFile)
+drfs_result drfs_get_file_info(drfs_context* pContext, const char* absoluteOrRelativePath, drfs_file_info* fi)
 {
-    return drfs_tell(pFile) == drfs_size(pFile);
-}
+    if (pContext == NULL || absoluteOrRelativePath == NULL) {
+        return drfs_invalid_args;
+    }
 
+    drfs_context_lock_read(pContext);
+    drfs_result result = drfs_get_file_info_nolock(pContext, absoluteOrRelativePath, fi);
+    drfs_context_unlock_read(pContext);
 
+    return result;
+}
 
 
-///////////////////////////////////////////////////////////////////////////////
-//
-// ZIP
-//
-///////////////////////////////////////////////////////////////////////////////
-#ifndef DR_FS_NO_ZIP
+bool drfs_begin(drfs_context* pContext, const char* absoluteOrRelativePath, drfs_iterator* pIteratorOut)
+{
+    if (pIteratorOut == NULL) {
+        return false;
+    }
 
-#if defined(__clang__)
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wunused-macros"
-    #pragma GCC diagnostic ignored "-Wcast-align"
-#endif
+    memset(pIteratorOut, 0, sizeof(*pIteratorOut));
 
-#ifndef MINIZ_HEADER_INCLUDED
-#define MINIZ_HEADER_INCLUDED
+    if (pContext == NULL || absoluteOrRelativePath == NULL || pIteratorOut == NULL) {
+        return false;
+    }
 
-// If MINIZ_NO_TIME is specified then the ZIP archive functions will not be able to get the current time, or
-// get/set file times, and the C run-time funcs that get/set times won't be called.
-// The current downside is the times written to your archives will be from 1979.
-//#define MINIZ_NO_TIME
+    // We need to open the archive that the given folder is in. The path could, however, point to an actual archive which is allowed
+    // in which case we just iterate over the root directory within that archive. What we do is first try using the path as an actual
+    // archive. If it fails we assume the path is to a folder within an archive (such as a zip file) in which case we just try opening
+    // the owner archive. If both fail, we return false.
 
-// Define MINIZ_NO_ARCHIVE_APIS to disable all ZIP archive API's.
-//#define MINIZ_NO_ARCHIVE_APIS
+    char relativePath[DRFS_MAX_PATH];
+    drfs_context_lock_read(pContext);
+    drfs_result result = drfs_open_archive_nolock(pContext, absoluteOrRelativePath, DRFS_READ, &pIteratorOut->pArchive);
+    if (result == drfs_success) {
+        relativePath[0] = '\0';
+    } else {
+        result = drfs_open_owner_archive_nolock(pContext, absoluteOrRelativePath, DRFS_READ, relativePath, sizeof(relativePath), &pIteratorOut->pArchive);
+    }
+    drfs_context_unlock_read(pContext);
 
-#if defined(__TINYC__) && (defined(__linux) || defined(__linux__))
-  // TODO: Work around "error: include file 'sys\utime.h' when compiling with tcc on Linux
-  #define MINIZ_NO_TIME
-#endif
+    if (result != drfs_success) {
+        return false;
+    }
 
-#if !defined(MINIZ_NO_TIME) && !defined(MINIZ_NO_ARCHIVE_APIS)
-  #include <time.h>
-#endif
+    assert(pIteratorOut->pArchive != NULL);
 
-#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__i386) || defined(__i486__) || defined(__i486) || defined(i386) || defined(__ia64__) || defined(__x86_64__)
-// MINIZ_X86_OR_X64_CPU is only used to help set the below macros.
-#define MINIZ_X86_OR_X64_CPU 1
-#endif
 
-#if (__BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__) || MINIZ_X86_OR_X64_CPU
-// Set MINIZ_LITTLE_ENDIAN to 1 if the processor is little endian.
-#define MINIZ_LITTLE_ENDIAN 1
-#endif
+    if (pIteratorOut->pArchive->callbacks.begin_iteration) {
+        pIteratorOut->internalIteratorHandle = pIteratorOut->pArchive->callbacks.begin_iteration(pIteratorOut->pArchive->internalArchiveHandle, relativePath);
+    }
 
-#if MINIZ_X86_OR_X64_CPU
-// Set MINIZ_USE_UNALIGNED_LOADS_AND_STORES to 1 on CPU's that permit efficient integer loads and stores from unaligned addresses.
-#define MINIZ_USE_UNALIGNED_LOADS_AND_STORES 1
-#endif
+    if (pIteratorOut->internalIteratorHandle == NULL) {
+        drfs_close_archive(pIteratorOut->pArchive);
+        pIteratorOut->pArchive = NULL;
+        return false;
+    }
 
-#if defined(_M_X64) || defined(_WIN64) || defined(__MINGW64__) || defined(_LP64) || defined(__LP64__) || defined(__ia64__) || defined(__x86_64__)
-// Set MINIZ_HAS_64BIT_REGISTERS to 1 if operations on 64-bit integers are reasonably fast (and don't involve compiler generated calls to helper functions).
-#define MINIZ_HAS_64BIT_REGISTERS 1
-#endif
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+    bool foundFirst = drfs_next(pContext, pIteratorOut);
+    if (!foundFirst) {
+        drfs_end(pContext, pIteratorOut);
+    }
 
-// ------------------- zlib-style API Definitions.
+    return foundFirst;
+}
 
-// For more compatibility with zlib, miniz.c uses unsigned long for some parameters/struct members. Beware: mz_ulong can be either 32 or 64-bits!
-typedef unsigned long mz_ulong;
+bool drfs_next(drfs_context* pContext, drfs_iterator* pIterator)
+{
+    if (pIterator == NULL) {
+        return false;
+    }
 
-// drfs_mz_free() internally uses the MZ_FREE() macro (which by default calls free() unless you've modified the MZ_MALLOC macro) to release a block allocated from the heap.
-void drfs_mz_free(void *p);
+    memset(&pIterator->info, 0, sizeof(pIterator->info));
 
-#define MZ_ADLER32_INIT (1)
-// drfs_mz_adler32() returns the initial adler-32 value to use when called with ptr==NULL.
-mz_ulong drfs_mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len);
+    if (pContext == NULL || pIterator->pArchive == NULL) {
+        return false;
+    }
 
-#define MZ_CRC32_INIT (0)
-// drfs_mz_crc32() returns the initial CRC-32 value to use when called with ptr==NULL.
-mz_ulong drfs_mz_crc32(mz_ulong crc, const unsigned char *ptr, size_t buf_len);
+    bool result = false;
+    if (pIterator->pArchive->callbacks.next_iteration) {
+        result = pIterator->pArchive->callbacks.next_iteration(pIterator->pArchive->internalArchiveHandle, pIterator->internalIteratorHandle, &pIterator->info);
+    }
 
-// Compression strategies.
-enum { MZ_DEFAULT_STRATEGY = 0, MZ_FILTERED = 1, MZ_HUFFMAN_ONLY = 2, MZ_RLE = 3, MZ_FIXED = 4 };
+    // At this point the pIterator->info.absolutePath is actually referring to a relative path. We need to convert it to an absolute path.
+    if (result) {
+        char relativePath[DRFS_MAX_PATH];
+        drfs__strcpy_s(relativePath, sizeof(relativePath), pIterator->info.absolutePath);
+        drfs_drpath_copy_and_append(pIterator->info.absolutePath, sizeof(pIterator->info.absolutePath), pIterator->pArchive->absolutePath, relativePath);
+    }
 
-// Method
-#define MZ_DEFLATED 8
+    return result;
+}
 
-// Heap allocation callbacks.
-// Note that mz_alloc_func parameter types purpsosely differ from zlib's: items/size is size_t, not unsigned long.
-typedef void *(*mz_alloc_func)(void *opaque, size_t items, size_t size);
-typedef void (*mz_free_func)(void *opaque, void *address);
-typedef void *(*mz_realloc_func)(void *opaque, void *address, size_t items, size_t size);
+void drfs_end(drfs_context* pContext, drfs_iterator* pIterator)
+{
+    if (pContext == NULL || pIterator == NULL) {
+        return;
+    }
 
-// ------------------- Types and macros
+    if (pIterator->pArchive != NULL && pIterator->pArchive->callbacks.end_iteration) {
+        pIterator->pArchive->callbacks.end_iteration(pIterator->pArchive->internalArchiveHandle, pIterator->internalIteratorHandle);
+    }
 
-typedef unsigned char mz_uint8;
-typedef signed short mz_int16;
-typedef unsigned short mz_uint16;
-typedef unsigned int mz_uint32;
-typedef unsigned int mz_uint;
-typedef long long mz_int64;
-typedef unsigned long long mz_uint64;
-typedef int mz_bool;
+    drfs_close_archive(pIterator->pArchive);
+    memset(pIterator, 0, sizeof(*pIterator));
+}
 
-#define MZ_FALSE (0)
-#define MZ_TRUE (1)
+drfs_result drfs_delete_file(drfs_context* pContext, const char* path)
+{
+    if (pContext == NULL || path == NULL) {
+        return drfs_invalid_args;
+    }
 
-// An attempt to work around MSVC's spammy "warning C4127: conditional expression is constant" message.
-#ifdef _MSC_VER
-   #define MZ_MACRO_END while (0, 0)
-#else
-   #define MZ_MACRO_END while (0)
-#endif
+    char absolutePath[DRFS_MAX_PATH];
+    char relativePath[DRFS_MAX_PATH];
+    drfs_archive* pArchive;
+    drfs_result result = drfs_not_in_write_directory;
+    drfs_context_lock_read(pContext);
+    {
+        if (drfs_validate_write_path(pContext, path, absolutePath, sizeof(absolutePath))) {
+            result = drfs_open_owner_archive_nolock(pContext, absolutePath, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePath, sizeof(relativePath), &pArchive);
+        }
+    }
+    drfs_context_unlock_read(pContext);
 
-// ------------------- ZIP archive reading/writing
+    if (result != drfs_success) {
+        return result;
+    }
 
-#ifndef MINIZ_NO_ARCHIVE_APIS
+    result = drfs_no_backend;
+    if (pArchive->callbacks.delete_file) {
+        result = pArchive->callbacks.delete_file(pArchive->internalArchiveHandle, relativePath);
+    }
 
-enum
-{
-  MZ_ZIP_MAX_IO_BUF_SIZE = 64*1024,
-  MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE = 260,
-  MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE = 256
-};
+    drfs_close_archive(pArchive);
+    return result;
+}
 
-typedef struct
+drfs_result drfs_rename_file(drfs_context* pContext, const char* pathOld, const char* pathNew)
 {
-  mz_uint32 m_file_index;
-  mz_uint32 m_central_dir_ofs;
-  mz_uint16 m_version_made_by;
-  mz_uint16 m_version_needed;
-  mz_uint16 m_bit_flag;
-  mz_uint16 m_method;
-#ifndef MINIZ_NO_TIME
-  time_t m_time;
-#endif
-  mz_uint32 m_crc32;
-  mz_uint64 m_comp_size;
-  mz_uint64 m_uncomp_size;
-  mz_uint16 m_internal_attr;
-  mz_uint32 m_external_attr;
-  mz_uint64 m_local_header_ofs;
-  mz_uint32 m_comment_size;
-  char m_filename[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
-  char m_comment[MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE];
-} mz_zip_archive_file_stat;
+    // Renaming/moving is not supported across different archives.
 
-typedef size_t (*mz_file_read_func)(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n);
-typedef size_t (*mz_file_write_func)(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n);
+    if (pContext == NULL || pathOld == NULL || pathNew == NULL) {
+        return drfs_invalid_args;
+    }
 
-struct mz_zip_internal_state_tag;
-typedef struct mz_zip_internal_state_tag mz_zip_internal_state;
 
-typedef enum
-{
-  MZ_ZIP_MODE_INVALID = 0,
-  MZ_ZIP_MODE_READING = 1,
-  MZ_ZIP_MODE_WRITING = 2,
-  MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED = 3
-} mz_zip_mode;
+    char absolutePathOld[DRFS_MAX_PATH];
+    char absolutePathNew[DRFS_MAX_PATH];
+    char relativePathOld[DRFS_MAX_PATH];
+    char relativePathNew[DRFS_MAX_PATH];
+    drfs_archive* pArchiveOld = NULL;
+    drfs_archive* pArchiveNew = NULL;
+    drfs_result result = drfs_not_in_write_directory;
+    drfs_context_lock_read(pContext);
+    {
+        if (drfs_validate_write_path(pContext, pathOld, absolutePathOld, sizeof(absolutePathOld)) && drfs_validate_write_path(pContext, pathNew, absolutePathNew, sizeof(absolutePathNew))) {
+            result = drfs_open_owner_archive_nolock(pContext, absolutePathOld, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePathOld, sizeof(relativePathOld), &pArchiveOld);
+            if (pArchiveOld != NULL) {
+                result = drfs_open_owner_archive_nolock(pContext, absolutePathNew, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePathNew, sizeof(relativePathNew), &pArchiveNew);
+            }
+        }
+    }
+    drfs_context_unlock_read(pContext);
 
-typedef struct mz_zip_archive_tag
-{
-  mz_uint64 m_archive_size;
-  mz_uint64 m_central_directory_file_ofs;
-  mz_uint m_total_files;
-  mz_zip_mode m_zip_mode;
-
-  mz_uint m_file_offset_alignment;
-
-  mz_alloc_func m_pAlloc;
-  mz_free_func m_pFree;
-  mz_realloc_func m_pRealloc;
-  void *m_pAlloc_opaque;
+    if (pArchiveOld != NULL)
+    {
+        if (pArchiveNew != NULL)
+        {
+            if (drfs_drpath_equal(pArchiveOld->absolutePath, pArchiveNew->absolutePath) && pArchiveOld->callbacks.rename_file) {
+                result = pArchiveOld->callbacks.rename_file(pArchiveOld, relativePathOld, relativePathNew);
+            } else {
+                result = drfs_permission_denied; // Attempting to rename across different archives which is not supported.
+            }
 
-  mz_file_read_func m_pRead;
-  mz_file_write_func m_pWrite;
-  void *m_pIO_opaque;
+            drfs_close_archive(pArchiveNew);
+        }
 
-  mz_zip_internal_state *m_pState;
+        drfs_close_archive(pArchiveOld);
+    }
 
-} mz_zip_archive;
+    return result;
+}
 
-typedef enum
+drfs_result drfs_create_directory(drfs_context* pContext, const char* path)
 {
-  MZ_ZIP_FLAG_CASE_SENSITIVE                = 0x0100,
-  MZ_ZIP_FLAG_IGNORE_PATH                   = 0x0200,
-  MZ_ZIP_FLAG_COMPRESSED_DATA               = 0x0400,
-  MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY = 0x0800
-} mz_zip_flags;
+    if (pContext == NULL || path == NULL) {
+        return drfs_invalid_args;
+    }
 
-// ZIP archive reading
+    char absolutePath[DRFS_MAX_PATH];
+    char relativePath[DRFS_MAX_PATH];
+    drfs_archive* pArchive;
+    drfs_result result = drfs_not_in_write_directory;
+    drfs_context_lock_read(pContext);
+    {
+        if (drfs_validate_write_path(pContext, path, absolutePath, sizeof(absolutePath))) {
+            result = drfs_open_owner_archive_nolock(pContext, absolutePath, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), relativePath, sizeof(relativePath), &pArchive);
+        }
+    }
+    drfs_context_unlock_read(pContext);
 
-// Inits a ZIP archive reader.
-// These functions read and validate the archive's central directory.
-mz_bool drfs_mz_zip_reader_init(mz_zip_archive *pZip, mz_uint64 size, mz_uint32 flags);
+    if (result != drfs_success) {
+        return result;
+    }
 
-// Returns the total number of files in the archive.
-mz_uint drfs_mz_zip_reader_get_num_files(mz_zip_archive *pZip);
+    result = drfs_no_backend;
+    if (pArchive->callbacks.create_directory) {
+        result = pArchive->callbacks.create_directory(pArchive->internalArchiveHandle, relativePath);
+    }
 
-// Returns detailed information about an archive file entry.
-mz_bool drfs_mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_file_stat *pStat);
+    drfs_close_archive(pArchive);
+    return result;
+}
 
-// Determines if an archive file entry is a directory entry.
-mz_bool drfs_mz_zip_reader_is_file_a_directory(mz_zip_archive *pZip, mz_uint file_index);
+drfs_result drfs_copy_file(drfs_context* pContext, const char* srcPath, const char* dstPath, bool failIfExists)
+{
+    if (pContext == NULL || srcPath == NULL || dstPath == NULL) {
+        return drfs_invalid_args;
+    }
 
-// Retrieves the filename of an archive file entry.
-// Returns the number of bytes written to pFilename, or if filename_buf_size is 0 this function returns the number of bytes needed to fully store the filename.
-mz_uint drfs_mz_zip_reader_get_filename(mz_zip_archive *pZip, mz_uint file_index, char *pFilename, mz_uint filename_buf_size);
+    // We want to open the archive of both the source and destination. If they are the same archive we'll do an intra-archive copy.
+    char dstPathAbsolute[DRFS_MAX_PATH];
+    char srcRelativePath[DRFS_MAX_PATH];
+    char dstRelativePath[DRFS_MAX_PATH];
+    drfs_archive* pSrcArchive = NULL;
+    drfs_archive* pDstArchive = NULL;
+    drfs_result result = drfs_not_in_write_directory;
+    drfs_context_lock_read(pContext);
+    {
+        if (drfs_validate_write_path(pContext, dstPath, dstPathAbsolute, sizeof(dstPathAbsolute))) {
+            result = drfs_open_owner_archive_nolock(pContext, srcPath, drfs_archive_access_mode(DRFS_READ), srcRelativePath, sizeof(srcRelativePath), &pSrcArchive);
+            if (result == drfs_success) {
+                result = drfs_open_owner_archive_nolock(pContext, dstPathAbsolute, drfs_archive_access_mode(DRFS_READ | DRFS_WRITE), dstRelativePath, sizeof(dstRelativePath), &pDstArchive);
+            }
+        }
+    }
+    drfs_context_unlock_read(pContext);
 
-// Attempts to locates a file in the archive's central directory.
-// Valid flags: MZ_ZIP_FLAG_CASE_SENSITIVE, MZ_ZIP_FLAG_IGNORE_PATH
-// Returns -1 if the file cannot be found.
-int drfs_mz_zip_reader_locate_file(mz_zip_archive *pZip, const char *pName, const char *pComment, mz_uint flags);
+    if (result != drfs_success) {
+        drfs_close_archive(pSrcArchive);
+        return result;
+    }
 
-// Extracts a archive file to a memory buffer using no memory allocation.
-mz_bool drfs_mz_zip_reader_extract_to_mem_no_alloc(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size);
-mz_bool drfs_mz_zip_reader_extract_file_to_mem_no_alloc(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size);
 
-// Extracts a archive file to a memory buffer.
-mz_bool drfs_mz_zip_reader_extract_to_mem(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags);
-mz_bool drfs_mz_zip_reader_extract_file_to_mem(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags);
 
-// Extracts a archive file to a dynamically allocated heap buffer.
-void *drfs_mz_zip_reader_extract_to_heap(mz_zip_archive *pZip, mz_uint file_index, size_t *pSize, mz_uint flags);
+    result = drfs_success;
+    if (strcmp(pSrcArchive->absolutePath, pDstArchive->absolutePath) == 0 && pDstArchive->callbacks.copy_file)
+    {
+        // Intra-archive copy.
+        result = pDstArchive->callbacks.copy_file(pDstArchive->internalArchiveHandle, srcRelativePath, dstRelativePath, failIfExists);
+    }
+    else
+    {
+        bool areBothArchivesNative = (pSrcArchive->callbacks.copy_file == pDstArchive->callbacks.copy_file && pDstArchive->callbacks.copy_file == drfs_copy_file__native);
+        if (areBothArchivesNative)
+        {
+            char srcPathAbsolute[DRFS_MAX_PATH];
+            drfs_drpath_copy_and_append(srcPathAbsolute, sizeof(srcPathAbsolute), pSrcArchive->absolutePath, srcPath);
 
-// Ends archive reading, freeing all allocations, and closing the input archive file if mz_zip_reader_init_file() was used.
-mz_bool drfs_mz_zip_reader_end(mz_zip_archive *pZip);
+            result = drfs_copy_native_file(srcPathAbsolute, dstPathAbsolute, failIfExists);
+        }
+        else
+        {
+            // Inter-archive copy. This is a theoretically slower path because we do everything manually. Probably not much slower in practice, though.
+            if (failIfExists && pDstArchive->callbacks.get_file_info(pDstArchive, dstRelativePath, NULL) == drfs_success)
+            {
+                result = drfs_already_exists;
+            }
+            else
+            {
+                drfs_file* pSrcFile;
+                result = drfs_open_file_from_archive(pSrcArchive, srcRelativePath, DRFS_READ, &pSrcFile);
+                if (result != drfs_success) {
+                    return result;
+                }
 
-#endif // #ifndef MINIZ_NO_ARCHIVE_APIS
+                drfs_file* pDstFile;
+                result = drfs_open_file_from_archive(pDstArchive, dstRelativePath, DRFS_WRITE | DRFS_TRUNCATE, &pDstFile);
+                if (result != drfs_success) {
+                    drfs_close(pSrcFile);
+                    return result;
+                }
 
-// ------------------- Low-level Decompression API Definitions
+                assert(pSrcFile != NULL);
+                assert(pDstFile != NULL);
 
-// Decompression flags used by drfs_tinfl_decompress().
-// TINFL_FLAG_PARSE_ZLIB_HEADER: If set, the input has a valid zlib header and ends with an adler32 checksum (it's a valid zlib stream). Otherwise, the input is a raw deflate stream.
-// TINFL_FLAG_HAS_MORE_INPUT: If set, there are more input bytes available beyond the end of the supplied input buffer. If clear, the input buffer contains all remaining input.
-// TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF: If set, the output buffer is large enough to hold the entire decompressed stream. If clear, the output buffer is at least the size of the dictionary (typically 32KB).
-// TINFL_FLAG_COMPUTE_ADLER32: Force adler-32 checksum computation of the decompressed bytes.
-enum
-{
-  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
-  TINFL_FLAG_HAS_MORE_INPUT = 2,
-  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
-  TINFL_FLAG_COMPUTE_ADLER32 = 8
-};
+                char chunk[4096];
+                size_t bytesRead;
+                while (drfs_read(pSrcFile, chunk, sizeof(chunk), &bytesRead) == drfs_success && bytesRead > 0)
+                {
+                    result = drfs_write(pDstFile, chunk, bytesRead, NULL);
+                    if (result != drfs_success) {
+                        break;
+                    }
+                }
 
-// High level decompression functions:
-// drfs_tinfl_decompress_mem_to_heap() decompresses a block in memory to a heap block allocated via malloc().
-// On entry:
-//  pSrc_buf, src_buf_len: Pointer and size of the Deflate or zlib source data to decompress.
-// On return:
-//  Function returns a pointer to the decompressed data, or NULL on failure.
-//  *pOut_len will be set to the decompressed data's size, which could be larger than src_buf_len on uncompressible data.
-//  The caller must call drfs_mz_free() on the returned block when it's no longer needed.
-void *drfs_tinfl_decompress_mem_to_heap(const void *pSrc_buf, size_t src_buf_len, size_t *pOut_len, int flags);
+                drfs_close(pSrcFile);
+                drfs_close(pDstFile);
+            }
+        }
+    }
 
-// drfs_tinfl_decompress_mem_to_mem() decompresses a block in memory to another block in memory.
-// Returns TINFL_DECOMPRESS_MEM_TO_MEM_FAILED on failure, or the number of bytes written on success.
-#define TINFL_DECOMPRESS_MEM_TO_MEM_FAILED ((size_t)(-1))
-size_t drfs_tinfl_decompress_mem_to_mem(void *pOut_buf, size_t out_buf_len, const void *pSrc_buf, size_t src_buf_len, int flags);
 
-// drfs_tinfl_decompress_mem_to_callback() decompresses a block in memory to an internal 32KB buffer, and a user provided callback function will be called to flush the buffer.
-// Returns 1 on success or 0 on failure.
-typedef int (*tinfl_put_buf_func_ptr)(const void* pBuf, int len, void *pUser);
-int drfs_tinfl_decompress_mem_to_callback(const void *pIn_buf, size_t *pIn_buf_size, tinfl_put_buf_func_ptr pPut_buf_func, void *pPut_buf_user, int flags);
+    drfs_close_archive(pSrcArchive);
+    drfs_close_archive(pDstArchive);
 
-struct tinfl_decompressor_tag; typedef struct tinfl_decompressor_tag tinfl_decompressor;
+    return result;
+}
 
-// Max size of LZ dictionary.
-#define TINFL_LZ_DICT_SIZE 32768
 
-// Return status.
-typedef enum
+bool drfs_is_archive_path(drfs_context* pContext, const char* path)
 {
-  TINFL_STATUS_BAD_PARAM = -3,
-  TINFL_STATUS_ADLER32_MISMATCH = -2,
-  TINFL_STATUS_FAILED = -1,
-  TINFL_STATUS_DONE = 0,
-  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
-  TINFL_STATUS_HAS_MORE_OUTPUT = 2
-} tinfl_status;
+    if (pContext == NULL || path == NULL) {
+        return false;
+    }
 
-// Initializes the decompressor to its initial state.
-#define tinfl_init(r) do { (r)->m_state = 0; } MZ_MACRO_END
-#define tinfl_get_adler32(r) (r)->m_check_adler32
+    drfs_context_lock_read(pContext);
+    bool result = drfs_find_backend_by_extension(pContext, drfs_drpath_extension(path), NULL);
+    drfs_context_unlock_read(pContext);
 
-// Main low-level decompressor coroutine function. This is the only function actually needed for decompression. All the other functions are just high-level helpers for improved usability.
-// This is a universal API, i.e. it can be used as a building block to build any desired higher level decompression API. In the limit case, it can be called once per every byte input or output.
-tinfl_status drfs_tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags);
+    return result;
+}
 
-// Internal/private bits follow.
-enum
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// High Level API
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+void drfs_free(void* p)
 {
-  TINFL_MAX_HUFF_TABLES = 3, TINFL_MAX_HUFF_SYMBOLS_0 = 288, TINFL_MAX_HUFF_SYMBOLS_1 = 32, TINFL_MAX_HUFF_SYMBOLS_2 = 19,
-  TINFL_FAST_LOOKUP_BITS = 10, TINFL_FAST_LOOKUP_SIZE = 1 << TINFL_FAST_LOOKUP_BITS
-};
+    DRFS_FREE(p);
+}
 
-typedef struct
+bool drfs_find_absolute_path(drfs_context* pContext, const char* relativePath, char* absolutePathOut, size_t absolutePathOutSize)
 {
-  mz_uint8 m_code_size[TINFL_MAX_HUFF_SYMBOLS_0];
-  mz_int16 m_look_up[TINFL_FAST_LOOKUP_SIZE], m_tree[TINFL_MAX_HUFF_SYMBOLS_0 * 2];
-} tinfl_huff_table;
+    if (pContext == NULL || relativePath == NULL || absolutePathOut == NULL || absolutePathOutSize == 0) {
+        return false;
+    }
 
-#if MINIZ_HAS_64BIT_REGISTERS
-  #define TINFL_USE_64BIT_BITBUF 1
-#endif
+    drfs_file_info fi;
+    if (drfs_get_file_info(pContext, relativePath, &fi) == drfs_success) {
+        return drfs__strcpy_s(absolutePathOut, absolutePathOutSize, fi.absolutePath) == 0;
+    }
 
-#if TINFL_USE_64BIT_BITBUF
-  typedef mz_uint64 tinfl_bit_buf_t;
-  #define TINFL_BITBUF_SIZE (64)
-#else
-  typedef mz_uint32 tinfl_bit_buf_t;
-  #define TINFL_BITBUF_SIZE (32)
-#endif
+    return false;
+}
 
-struct tinfl_decompressor_tag
+bool drfs_find_absolute_path_explicit_base(drfs_context* pContext, const char* relativePath, const char* highestPriorityBasePath, char* absolutePathOut, size_t absolutePathOutSize)
 {
-  mz_uint32 m_state, m_num_bits, m_zhdr0, m_zhdr1, m_z_adler32, m_final, m_type, m_check_adler32, m_dist, m_counter, m_num_extra, m_table_sizes[TINFL_MAX_HUFF_TABLES];
-  tinfl_bit_buf_t m_bit_buf;
-  size_t m_dist_from_out_buf_start;
-  tinfl_huff_table m_tables[TINFL_MAX_HUFF_TABLES];
-  mz_uint8 m_raw_header[4], m_len_codes[TINFL_MAX_HUFF_SYMBOLS_0 + TINFL_MAX_HUFF_SYMBOLS_1 + 137];
-};
+    if (pContext == NULL || relativePath == NULL || highestPriorityBasePath == NULL || absolutePathOut == NULL || absolutePathOutSize == 0) {
+        return false;
+    }
 
-#ifdef __cplusplus
+    // The explicit base path is checked directly rather than temporarily inserting it as a base directory so that this does
+    // not need to modify the context, which would block and race with other threads.
+    char absolutePath[DRFS_MAX_PATH];
+    if (drfs_drpath_copy_and_append(absolutePath, sizeof(absolutePath), highestPriorityBasePath, relativePath)) {
+        drfs_file_info fi;
+        if (drfs_get_file_info(pContext, absolutePath, &fi) == drfs_success) {
+            return drfs__strcpy_s(absolutePathOut, absolutePathOutSize, fi.absolutePath) == 0;
+        }
+    }
+
+    return drfs_find_absolute_path(pContext, relativePath, absolutePathOut, absolutePathOutSize);
 }
-#endif
 
-#endif // MINIZ_HEADER_INCLUDED
+bool drfs_is_base_directory(drfs_context* pContext, const char* baseDir)
+{
+    if (pContext == NULL) {
+        return false;
+    }
 
-// ------------------- End of Header: Implementation follows. (If you only want the header, define MINIZ_HEADER_FILE_ONLY.)
+    bool result = false;
+    drfs_context_lock_read(pContext);
+    {
+        for (unsigned int i = 0; i < pContext->baseDirectories.count; ++i) {
+            if (drfs_drpath_equal(pContext->baseDirectories.pBuffer[i].absolutePath, baseDir)) {
+                result = true;
+                break;
+            }
+        }
+    }
+    drfs_context_unlock_read(pContext);
 
-#ifndef MINIZ_HEADER_FILE_ONLY
+    return result;
+}
 
-typedef unsigned char mz_validate_uint16[sizeof(mz_uint16)==2 ? 1 : -1];
-typedef unsigned char mz_validate_uint32[sizeof(mz_uint32)==4 ? 1 : -1];
-typedef unsigned char mz_validate_uint64[sizeof(mz_uint64)==8 ? 1 : -1];
+bool drfs_write_string(drfs_file* pFile, const char* str)
+{
+    return drfs_write(pFile, str, (unsigned int)strlen(str), NULL) == drfs_success;
+}
 
-#include <string.h>
-#include <assert.h>
+bool drfs_write_line(drfs_file* pFile, const char* str)
+{
+    return drfs_write_string(pFile, str) && drfs_write_string(pFile, "\n");
+}
 
-#define MZ_ASSERT(x) assert(x)
 
-#define MZ_MALLOC(x) malloc(x)
-#define MZ_FREE(x) free(x)
-#define MZ_REALLOC(p, x) realloc(p, x)
+static void* drfs_open_and_read_binary_file_ex(drfs_context* pContext, const char* absoluteOrRelativePath, unsigned int accessMode, size_t* pSizeInBytesOut)
+{
+    drfs_file* pFile;
+    if (drfs_open(pContext, absoluteOrRelativePath, accessMode, &pFile) != drfs_success) {
+        return NULL;
+    }
 
-#define MZ_MAX(a,b) (((a)>(b))?(a):(b))
-#define MZ_MIN(a,b) (((a)<(b))?(a):(b))
-#define MZ_CLEAR_OBJ(obj) memset(&(obj), 0, sizeof(obj))
+    uint64_t fileSize = drfs_size(pFile);
+    if (fileSize > SIZE_MAX)
+    {
+        // File's too big.
+        drfs_close(pFile);
+        return NULL;
+    }
 
-#if MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN
-  #define MZ_READ_LE16(p) *((const mz_uint16 *)(p))
-  #define MZ_READ_LE32(p) *((const mz_uint32 *)(p))
-#else
-  #define MZ_READ_LE16(p) ((mz_uint32)(((const mz_uint8 *)(p))[0]) | ((mz_uint32)(((const mz_uint8 *)(p))[1]) << 8U))
-  #define MZ_READ_LE32(p) ((mz_uint32)(((const mz_uint8 *)(p))[0]) | ((mz_uint32)(((const mz_uint8 *)(p))[1]) << 8U) | ((mz_uint32)(((const mz_uint8 *)(p))[2]) << 16U) | ((mz_uint32)(((const mz_uint8 *)(p))[3]) << 24U))
-#endif
 
-#ifdef _MSC_VER
-  #define MZ_FORCEINLINE __forceinline
-#elif defined(__GNUC__)
-  #define MZ_FORCEINLINE inline __attribute__((__always_inline__))
-#else
-  #define MZ_FORCEINLINE inline
-#endif
+    void* pData = DRFS_MALLOC((size_t)fileSize);
+    if (pData == NULL)
+    {
+        // Failed to allocate memory.
+        drfs_close(pFile);
+        return NULL;
+    }
 
-#ifdef __cplusplus
-  extern "C" {
-#endif
 
-static void *def_alloc_func(void *opaque, size_t items, size_t size) { (void)opaque, (void)items, (void)size; return MZ_MALLOC(items * size); }
-static void def_free_func(void *opaque, void *address) { (void)opaque, (void)address; MZ_FREE(address); }
-static void *def_realloc_func(void *opaque, void *address, size_t items, size_t size) { (void)opaque, (void)address, (void)items, (void)size; return MZ_REALLOC(address, items * size); }
+    if (drfs_read(pFile, pData, (size_t)fileSize, NULL) != drfs_success)
+    {
+        DRFS_FREE(pData);
+        if (pSizeInBytesOut != NULL) {
+            *pSizeInBytesOut = 0;
+        }
 
-// ------------------- zlib-style API's
+        drfs_close(pFile);
+        return NULL;
+    }
 
-mz_ulong drfs_mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len)
-{
-  mz_uint32 i, s1 = (mz_uint32)(adler & 0xffff), s2 = (mz_uint32)(adler >> 16); size_t block_len = buf_len % 5552;
-  if (!ptr) return MZ_ADLER32_INIT;
-  while (buf_len) {
-    for (i = 0; i + 7 < block_len; i += 8, ptr += 8) {
-      s1 += ptr[0], s2 += s1; s1 += ptr[1], s2 += s1; s1 += ptr[2], s2 += s1; s1 += ptr[3], s2 += s1;
-      s1 += ptr[4], s2 += s1; s1 += ptr[5], s2 += s1; s1 += ptr[6], s2 += s1; s1 += ptr[7], s2 += s1;
+
+    if (pSizeInBytesOut != NULL) {
+        *pSizeInBytesOut = (size_t)fileSize;
     }
-    for ( ; i < block_len; ++i) s1 += *ptr++, s2 += s1;
-    s1 %= 65521U, s2 %= 65521U; buf_len -= block_len; block_len = 5552;
-  }
-  return (s2 << 16) + s1;
+
+    drfs_close(pFile);
+    return pData;
 }
 
-// Karl Malbrain's compact CRC-32. See "A compact CCITT crc16 and crc32 C implementation that balances processor cache usage against speed": http://www.geocities.com/malbrain/
-mz_ulong drfs_mz_crc32(mz_ulong crc, const mz_uint8 *ptr, size_t buf_len)
+void* drfs_open_and_read_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, size_t* pSizeInBytesOut)
 {
-  static const mz_uint32 s_crc32[16] = { 0, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
-    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
-  mz_uint32 crcu32 = (mz_uint32)crc;
-  if (!ptr) return MZ_CRC32_INIT;
-  crcu32 = ~crcu32; while (buf_len--) { mz_uint8 b = *ptr++; crcu32 = (crcu32 >> 4) ^ s_crc32[(crcu32 & 0xF) ^ (b & 0xF)]; crcu32 = (crcu32 >> 4) ^ s_crc32[(crcu32 & 0xF) ^ (b >> 4)]; }
-  return ~crcu32;
+    return drfs_open_and_read_binary_file_ex(pContext, absoluteOrRelativePath, DRFS_READ, pSizeInBytesOut);
 }
 
-void drfs_mz_free(void *p)
+void* drfs_open_and_read_compressed_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, size_t* pSizeInBytesOut)
 {
-  MZ_FREE(p);
+    return drfs_open_and_read_binary_file_ex(pContext, absoluteOrRelativePath, DRFS_READ | DRFS_COMPRESSED, pSizeInBytesOut);
 }
 
+char* drfs_open_and_read_text_file(drfs_context* pContext, const char* absoluteOrRelativePath, size_t* pSizeInBytesOut)
+{
+    drfs_file* pFile;
+    if (drfs_open(pContext, absoluteOrRelativePath, DRFS_READ, &pFile) != drfs_success) {
+        return NULL;
+    }
 
-// ------------------- Low-level Decompression (completely independent from all compression API's)
+    uint64_t fileSize = drfs_size(pFile);
+    if (fileSize > SIZE_MAX)
+    {
+        // File's too big.
+        drfs_close(pFile);
+        return NULL;
+    }
 
-#define TINFL_MEMCPY(d, s, l) memcpy(d, s, l)
-#define TINFL_MEMSET(p, c, l) memset(p, c, l)
 
-#define TINFL_CR_BEGIN switch(r->m_state) { case 0:
-#define TINFL_CR_RETURN(state_index, result) do { status = result; r->m_state = state_index; goto common_exit; case state_index:; } MZ_MACRO_END
-#define TINFL_CR_RETURN_FOREVER(state_index, result) do { for ( ; ; ) { TINFL_CR_RETURN(state_index, result); } } MZ_MACRO_END
-#define TINFL_CR_FINISH }
+    void* pData = DRFS_MALLOC((size_t)fileSize + 1);     // +1 for null terminator.
+    if (pData == NULL)
+    {
+        // Failed to allocate memory.
+        drfs_close(pFile);
+        return NULL;
+    }
 
-// TODO: If the caller has indicated that there's no more input, and we attempt to read beyond the input buf, then something is wrong with the input because the inflator never
-// reads ahead more than it needs to. Currently TINFL_GET_BYTE() pads the end of the stream with 0's in this scenario.
-#define TINFL_GET_BYTE(state_index, c) do { \
-  if (pIn_buf_cur >= pIn_buf_end) { \
-    for ( ; ; ) { \
-      if (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) { \
-        TINFL_CR_RETURN(state_index, TINFL_STATUS_NEEDS_MORE_INPUT); \
-        if (pIn_buf_cur < pIn_buf_end) { \
-          c = *pIn_buf_cur++; \
-          break; \
-        } \
-      } else { \
-        c = 0; \
-        break; \
-      } \
-    } \
-  } else c = *pIn_buf_cur++; } MZ_MACRO_END
 
-#define TINFL_NEED_BITS(state_index, n) do { mz_uint c; TINFL_GET_BYTE(state_index, c); bit_buf |= (((tinfl_bit_buf_t)c) << num_bits); num_bits += 8; } while (num_bits < (mz_uint)(n))
-#define TINFL_SKIP_BITS(state_index, n) do { if (num_bits < (mz_uint)(n)) { TINFL_NEED_BITS(state_index, n); } bit_buf >>= (n); num_bits -= (n); } MZ_MACRO_END
-#define TINFL_GET_BITS(state_index, b, n) do { if (num_bits < (mz_uint)(n)) { TINFL_NEED_BITS(state_index, n); } b = bit_buf & ((1 << (n)) - 1); bit_buf >>= (n); num_bits -= (n); } MZ_MACRO_END
+    if (drfs_read(pFile, pData, (size_t)fileSize, NULL) != drfs_success)
+    {
+        DRFS_FREE(pData);
+        if (pSizeInBytesOut != NULL) {
+            *pSizeInBytesOut = 0;
+        }
 
-// TINFL_HUFF_BITBUF_FILL() is only used rarely, when the number of bytes remaining in the input buffer falls below 2.
-// It reads just enough bytes from the input stream that are needed to decode the next Huffman code (and absolutely no more). It works by trying to fully decode a
-// Huffman code by using whatever bits are currently present in the bit buffer. If this fails, it reads another byte, and tries again until it succeeds or until the
-// bit buffer contains >=15 bits (deflate's max. Huffman code size).
-#define TINFL_HUFF_BITBUF_FILL(state_index, pHuff) \
-  do { \
-    temp = (pHuff)->m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]; \
-    if (temp >= 0) { \
-      code_len = temp >> 9; \
-      if ((code_len) && (num_bits >= code_len)) \
-      break; \
-    } else if (num_bits > TINFL_FAST_LOOKUP_BITS) { \
-       code_len = TINFL_FAST_LOOKUP_BITS; \
-       do { \
-          temp = (pHuff)->m_tree[~temp + ((bit_buf >> code_len++) & 1)]; \
-       } while ((temp < 0) && (num_bits >= (code_len + 1))); if (temp >= 0) break; \
-    } TINFL_GET_BYTE(state_index, c); bit_buf |= (((tinfl_bit_buf_t)c) << num_bits); num_bits += 8; \
-  } while (num_bits < 15);
+        drfs_close(pFile);
+        return NULL;
+    }
 
-// TINFL_HUFF_DECODE() decodes the next Huffman coded symbol. It's more complex than you would initially expect because the zlib API expects the decompressor to never read
-// beyond the final byte of the deflate stream. (In other words, when this macro wants to read another byte from the input, it REALLY needs another byte in order to fully
-// decode the next Huffman code.) Handling this properly is particularly important on raw deflate (non-zlib) streams, which aren't followed by a byte aligned adler-32.
-// The slow path is only executed at the very end of the input buffer.
-#define TINFL_HUFF_DECODE(state_index, sym, pHuff) do { \
-  int temp; mz_uint code_len, c; \
-  if (num_bits < 15) { \
-    if ((pIn_buf_end - pIn_buf_cur) < 2) { \
-       TINFL_HUFF_BITBUF_FILL(state_index, pHuff); \
-    } else { \
-       bit_buf |= (((tinfl_bit_buf_t)pIn_buf_cur[0]) << num_bits) | (((tinfl_bit_buf_t)pIn_buf_cur[1]) << (num_bits + 8)); pIn_buf_cur += 2; num_bits += 16; \
-    } \
-  } \
-  if ((temp = (pHuff)->m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0) \
-    code_len = temp >> 9, temp &= 511; \
-  else { \
-    code_len = TINFL_FAST_LOOKUP_BITS; do { temp = (pHuff)->m_tree[~temp + ((bit_buf >> code_len++) & 1)]; } while (temp < 0); \
-  } sym = temp; bit_buf >>= code_len; num_bits -= code_len; } MZ_MACRO_END
+    // Null terminator.
+    ((char*)pData)[fileSize] = '\0';
 
-tinfl_status drfs_tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags)
+
+    if (pSizeInBytesOut != NULL) {
+        *pSizeInBytesOut = (size_t)fileSize;
+    }
+
+    drfs_close(pFile);
+    return pData;
+}
+
+bool drfs_open_and_write_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, const void* pData, size_t dataSize)
 {
-  static const int s_length_base[31] = { 3,4,5,6,7,8,9,10,11,13, 15,17,19,23,27,31,35,43,51,59, 67,83,99,115,131,163,195,227,258,0,0 };
-  static const int s_length_extra[31]= { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0,0,0 };
-  static const int s_dist_base[32] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193, 257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0};
-  static const int s_dist_extra[32] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
-  static const mz_uint8 s_length_dezigzag[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
-  static const int s_min_table_sizes[3] = { 257, 1, 4 };
+    drfs_file* pFile;
+    if (drfs_open(pContext, absoluteOrRelativePath, DRFS_WRITE | DRFS_TRUNCATE, &pFile) != drfs_success) {
+        return false;
+    }
 
-  tinfl_status status = TINFL_STATUS_FAILED; mz_uint32 num_bits, dist, counter, num_extra; tinfl_bit_buf_t bit_buf;
-  const mz_uint8 *pIn_buf_cur = pIn_buf_next, *const pIn_buf_end = pIn_buf_next + *pIn_buf_size;
-  mz_uint8 *pOut_buf_cur = pOut_buf_next, *const pOut_buf_end = pOut_buf_next + *pOut_buf_size;
-  size_t out_buf_size_mask = (decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF) ? (size_t)-1 : ((pOut_buf_next - pOut_buf_start) + *pOut_buf_size) - 1, dist_from_out_buf_start;
+    drfs_result result = drfs_write(pFile, pData, dataSize, NULL);
 
-  // Ensure the output buffer's size is a power of 2, unless the output buffer is large enough to hold the entire output file (in which case it doesn't matter).
-  if (((out_buf_size_mask + 1) & out_buf_size_mask) || (pOut_buf_next < pOut_buf_start)) { *pIn_buf_size = *pOut_buf_size = 0; return TINFL_STATUS_BAD_PARAM; }
+    drfs_close(pFile);
+    return result == drfs_success;
+}
 
-  num_bits = r->m_num_bits; bit_buf = r->m_bit_buf; dist = r->m_dist; counter = r->m_counter; num_extra = r->m_num_extra; dist_from_out_buf_start = r->m_dist_from_out_buf_start;
-  TINFL_CR_BEGIN
+bool drfs_open_and_write_text_file(drfs_context* pContext, const char* absoluteOrRelativePath, const char* pTextData)
+{
+    return drfs_open_and_write_binary_file(pContext, absoluteOrRelativePath, pTextData, strlen(pTextData));
+}
 
-  bit_buf = num_bits = dist = counter = num_extra = r->m_zhdr0 = r->m_zhdr1 = 0; r->m_z_adler32 = r->m_check_adler32 = 1;
-  if (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER)
-  {
-    TINFL_GET_BYTE(1, r->m_zhdr0); TINFL_GET_BYTE(2, r->m_zhdr1);
-    counter = (((r->m_zhdr0 * 256 + r->m_zhdr1) % 31 != 0) || (r->m_zhdr1 & 32) || ((r->m_zhdr0 & 15) != 8));
-    if (!(decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)) counter |= (((1U << (8U + (r->m_zhdr0 >> 4))) > 32768U) || ((out_buf_size_mask + 1) < (size_t)(1U << (8U + (r->m_zhdr0 >> 4)))));
-    if (counter) { TINFL_CR_RETURN_FOREVER(36, TINFL_STATUS_FAILED); }
-  }
+bool drfs_open_and_write_compressed_binary_file(drfs_context* pContext, const char* absoluteOrRelativePath, const void* pData, size_t dataSize)
+{
+    drfs_file* pFile;
+    if (drfs_open(pContext, absoluteOrRelativePath, DRFS_WRITE | DRFS_TRUNCATE | DRFS_COMPRESSED, &pFile) != drfs_success) {
+        return false;
+    }
 
-  do
-  {
-    TINFL_GET_BITS(3, r->m_final, 3); r->m_type = r->m_final >> 1;
-    if (r->m_type == 0)
+    // The stream is finished explicitly rather than through drfs_close() so that errors writing the end of the stream are
+    // reported.
+    drfs_result result = drfs_write(pFile, pData, dataSize, NULL);
+#ifndef DR_FS_NO_ZIP
+    if (result == drfs_success) {
+        result = drfs_end_compressed_stream(pFile);
+    }
+#endif
+
+    drfs_close(pFile);
+    return result == drfs_success;
+}
+
+
+bool drfs_exists(drfs_context* pContext, const char* absoluteOrRelativePath)
+{
+    drfs_file_info fi;
+    return drfs_get_file_info(pContext, absoluteOrRelativePath, &fi) == drfs_success;
+}
+
+bool drfs_is_existing_file(drfs_context* pContext, const char* absoluteOrRelativePath)
+{
+    drfs_file_info fi;
+    if (drfs_get_file_info(pContext, absoluteOrRelativePath, &fi) == drfs_success)
     {
-      TINFL_SKIP_BITS(5, num_bits & 7);
-      for (counter = 0; counter < 4; ++counter) { if (num_bits) TINFL_GET_BITS(6, r->m_raw_header[counter], 8); else TINFL_GET_BYTE(7, r->m_raw_header[counter]); }
-      if ((counter = (r->m_raw_header[0] | (r->m_raw_header[1] << 8))) != (mz_uint)(0xFFFF ^ (r->m_raw_header[2] | (r->m_raw_header[3] << 8)))) { TINFL_CR_RETURN_FOREVER(39, TINFL_STATUS_FAILED); }
-      while ((counter) && (num_bits))
-      {
-        TINFL_GET_BITS(51, dist, 8);
-        while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(52, TINFL_STATUS_HAS_MORE_OUTPUT); }
-        *pOut_buf_cur++ = (mz_uint8)dist;
-        counter--;
-      }
-      while (counter)
-      {
-        size_t n; while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(9, TINFL_STATUS_HAS_MORE_OUTPUT); }
-        while (pIn_buf_cur >= pIn_buf_end)
-        {
-          if (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT)
-          {
-            TINFL_CR_RETURN(38, TINFL_STATUS_NEEDS_MORE_INPUT);
-          }
-          else
-          {
-            TINFL_CR_RETURN_FOREVER(40, TINFL_STATUS_FAILED);
-          }
-        }
-        n = MZ_MIN(MZ_MIN((size_t)(pOut_buf_end - pOut_buf_cur), (size_t)(pIn_buf_end - pIn_buf_cur)), counter);
-        TINFL_MEMCPY(pOut_buf_cur, pIn_buf_cur, n); pIn_buf_cur += n; pOut_buf_cur += n; counter -= (mz_uint)n;
-      }
+        return (fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) == 0;
     }
-    else if (r->m_type == 3)
+
+    return false;
+}
+
+bool drfs_is_existing_directory(drfs_context* pContext, const char* absoluteOrRelativePath)
+{
+    drfs_file_info fi;
+    if (drfs_get_file_info(pContext, absoluteOrRelativePath, &fi) == drfs_success)
     {
-      TINFL_CR_RETURN_FOREVER(10, TINFL_STATUS_FAILED);
+        return (fi.attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) != 0;
     }
-    else
+
+    return false;
+}
+
+drfs_result drfs_create_directory_recursive(drfs_context* pContext, const char* path)
+{
+    if (pContext == NULL || path == NULL) {
+        return drfs_invalid_args;
+    }
+
+    // We just iterate over each segment and try creating each directory if it doesn't exist.
+    char absolutePath[DRFS_MAX_PATH];
+    drfs_context_lock_read(pContext);
+    bool isValidWritePath = drfs_validate_write_path(pContext, path, absolutePath, DRFS_MAX_PATH);
+    drfs_context_unlock_read(pContext);
+
+    if (isValidWritePath) {
+        path = absolutePath;
+    } else {
+        return drfs_not_in_write_directory;
+    }
+
+
+    char runningPath[DRFS_MAX_PATH];
+    runningPath[0] = '\0';
+
+    drfs_drpath_iterator iPathSeg;
+    if (!drfs_drpath_first(absolutePath, &iPathSeg)) {
+        return drfs_invalid_args;
+    }
+
+    // Never check the first segment because we can assume it always exists - it will always be the drive root.
+    if (drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg))
     {
-      if (r->m_type == 1)
-      {
-        mz_uint8 *p = r->m_tables[0].m_code_size; mz_uint i;
-        r->m_table_sizes[0] = 288; r->m_table_sizes[1] = 32; TINFL_MEMSET(r->m_tables[1].m_code_size, 5, 32);
-        for ( i = 0; i <= 143; ++i) *p++ = 8; for ( ; i <= 255; ++i) *p++ = 9; for ( ; i <= 279; ++i) *p++ = 7; for ( ; i <= 287; ++i) *p++ = 8;
-      }
-      else
-      {
-        for (counter = 0; counter < 3; counter++) { TINFL_GET_BITS(11, r->m_table_sizes[counter], "\05\05\04"[counter]); r->m_table_sizes[counter] += s_min_table_sizes[counter]; }
-        MZ_CLEAR_OBJ(r->m_tables[2].m_code_size); for (counter = 0; counter < r->m_table_sizes[2]; counter++) { mz_uint s; TINFL_GET_BITS(14, s, 3); r->m_tables[2].m_code_size[s_length_dezigzag[counter]] = (mz_uint8)s; }
-        r->m_table_sizes[2] = 19;
-      }
-      for ( ; (int)r->m_type >= 0; r->m_type--)
-      {
-        int tree_next, tree_cur; tinfl_huff_table *pTable;
-        mz_uint i, j, used_syms, total, sym_index, next_code[17], total_syms[16]; pTable = &r->m_tables[r->m_type]; MZ_CLEAR_OBJ(total_syms); MZ_CLEAR_OBJ(pTable->m_look_up); MZ_CLEAR_OBJ(pTable->m_tree);
-        for (i = 0; i < r->m_table_sizes[r->m_type]; ++i) total_syms[pTable->m_code_size[i]]++;
-        used_syms = 0, total = 0; next_code[0] = next_code[1] = 0;
-        for (i = 1; i <= 15; ++i) { used_syms += total_syms[i]; next_code[i + 1] = (total = ((total + total_syms[i]) << 1)); }
-        if ((65536 != total) && (used_syms > 1))
-        {
-          TINFL_CR_RETURN_FOREVER(35, TINFL_STATUS_FAILED);
-        }
-        for (tree_next = -1, sym_index = 0; sym_index < r->m_table_sizes[r->m_type]; ++sym_index)
-        {
-          mz_uint rev_code = 0, l, cur_code, code_size = pTable->m_code_size[sym_index]; if (!code_size) continue;
-          cur_code = next_code[code_size]++; for (l = code_size; l > 0; l--, cur_code >>= 1) rev_code = (rev_code << 1) | (cur_code & 1);
-          if (code_size <= TINFL_FAST_LOOKUP_BITS) { mz_int16 k = (mz_int16)((code_size << 9) | sym_index); while (rev_code < TINFL_FAST_LOOKUP_SIZE) { pTable->m_look_up[rev_code] = k; rev_code += (1 << code_size); } continue; }
-          if (0 == (tree_cur = pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)])) { pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)] = (mz_int16)tree_next; tree_cur = tree_next; tree_next -= 2; }
-          rev_code >>= (TINFL_FAST_LOOKUP_BITS - 1);
-          for (j = code_size; j > (TINFL_FAST_LOOKUP_BITS + 1); j--)
-          {
-            tree_cur -= ((rev_code >>= 1) & 1);
-            if (!pTable->m_tree[-tree_cur - 1]) { pTable->m_tree[-tree_cur - 1] = (mz_int16)tree_next; tree_cur = tree_next; tree_next -= 2; } else tree_cur = pTable->m_tree[-tree_cur - 1];
-          }
-          tree_cur -= ((rev_code >>= 1) & 1); pTable->m_tree[-tree_cur - 1] = (mz_int16)sym_index;
-        }
-        if (r->m_type == 2)
+        // Loop over every directory until we find one that does not exist.
+        while (drfs_drpath_next(&iPathSeg))
         {
-          for (counter = 0; counter < (r->m_table_sizes[0] + r->m_table_sizes[1]); )
-          {
-            mz_uint s; TINFL_HUFF_DECODE(16, dist, &r->m_tables[2]); if (dist < 16) { r->m_len_codes[counter++] = (mz_uint8)dist; continue; }
-            if ((dist == 16) && (!counter))
-            {
-              TINFL_CR_RETURN_FOREVER(17, TINFL_STATUS_FAILED);
+            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
+                return drfs_path_too_long;
+            }
+
+            if (!drfs_is_existing_directory(pContext, runningPath)) {
+                drfs_result result = drfs_create_directory(pContext, runningPath);
+                if (result != drfs_success) {
+                    return result;
+                }
+
+                break;
             }
-            num_extra = "\02\03\07"[dist - 16]; TINFL_GET_BITS(18, s, num_extra); s += "\03\03\013"[dist - 16];
-            TINFL_MEMSET(r->m_len_codes + counter, (dist == 16) ? r->m_len_codes[counter - 1] : 0, s); counter += s;
-          }
-          if ((r->m_table_sizes[0] + r->m_table_sizes[1]) != counter)
-          {
-            TINFL_CR_RETURN_FOREVER(21, TINFL_STATUS_FAILED);
-          }
-          TINFL_MEMCPY(r->m_tables[0].m_code_size, r->m_len_codes, r->m_table_sizes[0]); TINFL_MEMCPY(r->m_tables[1].m_code_size, r->m_len_codes + r->m_table_sizes[0], r->m_table_sizes[1]);
         }
-      }
-      for ( ; ; )
-      {
-        mz_uint8 *pSrc;
-        for ( ; ; )
+
+
+        // At this point all we need to do is create the remaining directories - we can assert that the directory does not exist
+        // rather than actually checking it which should be a bit more efficient.
+        while (drfs_drpath_next(&iPathSeg))
         {
-          if (((pIn_buf_end - pIn_buf_cur) < 4) || ((pOut_buf_end - pOut_buf_cur) < 2))
-          {
-            TINFL_HUFF_DECODE(23, counter, &r->m_tables[0]);
-            if (counter >= 256)
-              break;
-            while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(24, TINFL_STATUS_HAS_MORE_OUTPUT); }
-            *pOut_buf_cur++ = (mz_uint8)counter;
-          }
-          else
-          {
-            int sym2; mz_uint code_len;
-#if TINFL_USE_64BIT_BITBUF
-            if (num_bits < 30) { bit_buf |= (((tinfl_bit_buf_t)MZ_READ_LE32(pIn_buf_cur)) << num_bits); pIn_buf_cur += 4; num_bits += 32; }
-#else
-            if (num_bits < 15) { bit_buf |= (((tinfl_bit_buf_t)MZ_READ_LE16(pIn_buf_cur)) << num_bits); pIn_buf_cur += 2; num_bits += 16; }
-#endif
-            if ((sym2 = r->m_tables[0].m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0)
-              code_len = sym2 >> 9;
-            else
-            {
-              code_len = TINFL_FAST_LOOKUP_BITS; do { sym2 = r->m_tables[0].m_tree[~sym2 + ((bit_buf >> code_len++) & 1)]; } while (sym2 < 0);
+            if (!drfs_drpath_append_iterator(runningPath, sizeof(runningPath), iPathSeg)) {
+                return drfs_path_too_long;
             }
-            counter = sym2; bit_buf >>= code_len; num_bits -= code_len;
-            if (counter & 256)
-              break;
 
-#if !TINFL_USE_64BIT_BITBUF
-            if (num_bits < 15) { bit_buf |= (((tinfl_bit_buf_t)MZ_READ_LE16(pIn_buf_cur)) << num_bits); pIn_buf_cur += 2; num_bits += 16; }
-#endif
-            if ((sym2 = r->m_tables[0].m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0)
-              code_len = sym2 >> 9;
-            else
-            {
-              code_len = TINFL_FAST_LOOKUP_BITS; do { sym2 = r->m_tables[0].m_tree[~sym2 + ((bit_buf >> code_len++) & 1)]; } while (sym2 < 0);
-            }
-            bit_buf >>= code_len; num_bits -= code_len;
+            assert(!drfs_is_existing_directory(pContext, runningPath));
 
-            pOut_buf_cur[0] = (mz_uint8)counter;
-            if (sym2 & 256)
-            {
-              pOut_buf_cur++;
-              counter = sym2;
-              break;
+            drfs_result result = drfs_create_directory(pContext, runningPath);
+            if (result != drfs_success) {
+                return result;
             }
-            pOut_buf_cur[1] = (mz_uint8)sym2;
-            pOut_buf_cur += 2;
-          }
         }
-        if ((counter &= 511) == 256) break;
 
-        num_extra = s_length_extra[counter - 257]; counter = s_length_base[counter - 257];
-        if (num_extra) { mz_uint extra_bits; TINFL_GET_BITS(25, extra_bits, num_extra); counter += extra_bits; }
 
-        TINFL_HUFF_DECODE(26, dist, &r->m_tables[1]);
-        num_extra = s_dist_extra[dist]; dist = s_dist_base[dist];
-        if (num_extra) { mz_uint extra_bits; TINFL_GET_BITS(27, extra_bits, num_extra); dist += extra_bits; }
+        return drfs_success;
+    }
+    else
+    {
+        return drfs_invalid_args;
+    }
+}
 
-        dist_from_out_buf_start = pOut_buf_cur - pOut_buf_start;
-        if ((dist > dist_from_out_buf_start) && (decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF))
-        {
-          TINFL_CR_RETURN_FOREVER(37, TINFL_STATUS_FAILED);
-        }
+bool drfs_eof(drfs_file* pFile)
+{
+    return drfs_tell(pFile) == drfs_size(pFile);
+}
 
-        pSrc = pOut_buf_start + ((dist_from_out_buf_start - dist) & out_buf_size_mask);
 
-        if ((MZ_MAX(pOut_buf_cur, pSrc) + counter) > pOut_buf_end)
-        {
-          while (counter--)
-          {
-            while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(53, TINFL_STATUS_HAS_MORE_OUTPUT); }
-            *pOut_buf_cur++ = pOut_buf_start[(dist_from_out_buf_start++ - dist) & out_buf_size_mask];
-          }
-          continue;
-        }
-#if MINIZ_USE_UNALIGNED_LOADS_AND_STORES
-        else if ((counter >= 9) && (counter <= dist))
-        {
-          const mz_uint8 *pSrc_end = pSrc + (counter & ~7);
-          do
-          {
-            ((mz_uint32 *)pOut_buf_cur)[0] = ((const mz_uint32 *)pSrc)[0];
-            ((mz_uint32 *)pOut_buf_cur)[1] = ((const mz_uint32 *)pSrc)[1];
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// ZIP
+//
+///////////////////////////////////////////////////////////////////////////////
+#ifndef DR_FS_NO_ZIP
+
+#if defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wunused-macros"
+    #pragma GCC diagnostic ignored "-Wcast-align"
+#endif
+
+#ifndef MINIZ_HEADER_INCLUDED
+#define MINIZ_HEADER_INCLUDED
+
+// If MINIZ_NO_TIME is specified then the ZIP archive functions will not be able to get the current time, or
+// get/set file times, and the C run-time funcs that get/set times won't be called.
+// The current downside is the times written to your archives will be from 1979.
+//#define MINIZ_NO_TIME
+
+// Define MINIZ_NO_ARCHIVE_APIS to disable all ZIP archive API's.
+//#define MINIZ_NO_ARCHIVE_APIS
+
+#if defined(__TINYC__) && (defined(__linux) || defined(__linux__))
+  // TODO: Work around "error: include file 'sys\utime.h' when compiling with tcc on Linux
+  #define MINIZ_NO_TIME
+#endif
+
+#if !defined(MINIZ_NO_TIME) && !defined(MINIZ_NO_ARCHIVE_APIS)
+  #include <time.h>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__i386) || defined(__i486__) || defined(__i486) || defined(i386) || defined(__ia64__) || defined(__x86_64__)
+// MINIZ_X86_OR_X64_CPU is only used to help set the below macros.
+#define MINIZ_X86_OR_X64_CPU 1
+#endif
+
+#if (__BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__) || MINIZ_X86_OR_X64_CPU
+// Set MINIZ_LITTLE_ENDIAN to 1 if the processor is little endian.
+#define MINIZ_LITTLE_ENDIAN 1
+#endif
+
+#if MINIZ_X86_OR_X64_CPU
+// Set MINIZ_USE_UNALIGNED_LOADS_AND_STORES to 1 on CPU's that permit efficient integer loads and stores from unaligned addresses.
+#define MINIZ_USE_UNALIGNED_LOADS_AND_STORES 1
+#endif
+
+#if defined(_M_X64) || defined(_WIN64) || defined(__MINGW64__) || defined(_LP64) || defined(__LP64__) || defined(__ia64__) || defined(__x86_64__)
+// Set MINIZ_HAS_64BIT_REGISTERS to 1 if operations on 64-bit integers are reasonably fast (and don't involve compiler generated calls to helper functions).
+#define MINIZ_HAS_64BIT_REGISTERS 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ------------------- zlib-style API Definitions.
+
+// For more compatibility with zlib, miniz.c uses unsigned long for some parameters/struct members. Beware: mz_ulong can be either 32 or 64-bits!
+typedef unsigned long mz_ulong;
+
+// drfs_mz_free() internally uses the MZ_FREE() macro (which by default calls free() unless you've modified the MZ_MALLOC macro) to release a block allocated from the heap.
+void drfs_mz_free(void *p);
+
+#define MZ_ADLER32_INIT (1)
+// drfs_mz_adler32() returns the initial adler-32 value to use when called with ptr==NULL.
+mz_ulong drfs_mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len);
+
+#define MZ_CRC32_INIT (0)
+// drfs_mz_crc32() returns the initial CRC-32 value to use when called with ptr==NULL.
+mz_ulong drfs_mz_crc32(mz_ulong crc, const unsigned char *ptr, size_t buf_len);
+
+// Compression strategies.
+enum { MZ_DEFAULT_STRATEGY = 0, MZ_FILTERED = 1, MZ_HUFFMAN_ONLY = 2, MZ_RLE = 3, MZ_FIXED = 4 };
+
+// Method
+#define MZ_DEFLATED 8
+
+// Heap allocation callbacks.
+// Note that mz_alloc_func parameter types purpsosely differ from zlib's: items/size is size_t, not unsigned long.
+typedef void *(*mz_alloc_func)(void *opaque, size_t items, size_t size);
+typedef void (*mz_free_func)(void *opaque, void *address);
+typedef void *(*mz_realloc_func)(void *opaque, void *address, size_t items, size_t size);
+
+// ------------------- Types and macros
+
+typedef unsigned char mz_uint8;
+typedef signed short mz_int16;
+typedef unsigned short mz_uint16;
+typedef unsigned int mz_uint32;
+typedef unsigned int mz_uint;
+typedef long long mz_int64;
+typedef unsigned long long mz_uint64;
+typedef int mz_bool;
+
+#define MZ_FALSE (0)
+#define MZ_TRUE (1)
+
+// An attempt to work around MSVC's spammy "warning C4127: conditional expression is constant" message.
+#ifdef _MSC_VER
+   #define MZ_MACRO_END while (0, 0)
+#else
+   #define MZ_MACRO_END while (0)
+#endif
+
+// ------------------- ZIP archive reading/writing
+
+#ifndef MINIZ_NO_ARCHIVE_APIS
+
+enum
+{
+  MZ_ZIP_MAX_IO_BUF_SIZE = 64*1024,
+  MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE = 260,
+  MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE = 256
+};
+
+typedef struct
+{
+  mz_uint32 m_file_index;
+  mz_uint32 m_central_dir_ofs;
+  mz_uint16 m_version_made_by;
+  mz_uint16 m_version_needed;
+  mz_uint16 m_bit_flag;
+  mz_uint16 m_method;
+#ifndef MINIZ_NO_TIME
+  time_t m_time;
+#endif
+  mz_uint32 m_crc32;
+  mz_uint64 m_comp_size;
+  mz_uint64 m_uncomp_size;
+  mz_uint16 m_internal_attr;
+  mz_uint32 m_external_attr;
+  mz_uint64 m_local_header_ofs;
+  mz_uint32 m_comment_size;
+  char m_filename[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
+  char m_comment[MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE];
+} mz_zip_archive_file_stat;
+
+typedef size_t (*mz_file_read_func)(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n);
+typedef size_t (*mz_file_write_func)(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n);
+
+struct mz_zip_internal_state_tag;
+typedef struct mz_zip_internal_state_tag mz_zip_internal_state;
+
+typedef enum
+{
+  MZ_ZIP_MODE_INVALID = 0,
+  MZ_ZIP_MODE_READING = 1,
+  MZ_ZIP_MODE_WRITING = 2,
+  MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED = 3
+} mz_zip_mode;
+
+typedef struct mz_zip_archive_tag
+{
+  mz_uint64 m_archive_size;
+  mz_uint64 m_central_directory_file_ofs;
+  mz_uint m_total_files;
+  mz_zip_mode m_zip_mode;
+
+  mz_uint m_file_offset_alignment;
+
+  mz_alloc_func m_pAlloc;
+  mz_free_func m_pFree;
+  mz_realloc_func m_pRealloc;
+  void *m_pAlloc_opaque;
+
+  mz_file_read_func m_pRead;
+  mz_file_write_func m_pWrite;
+  void *m_pIO_opaque;
+
+  mz_zip_internal_state *m_pState;
+
+} mz_zip_archive;
+
+typedef enum
+{
+  MZ_ZIP_FLAG_CASE_SENSITIVE                = 0x0100,
+  MZ_ZIP_FLAG_IGNORE_PATH                   = 0x0200,
+  MZ_ZIP_FLAG_COMPRESSED_DATA               = 0x0400,
+  MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY = 0x0800
+} mz_zip_flags;
+
+// ZIP archive reading
+
+// Inits a ZIP archive reader.
+// These functions read and validate the archive's central directory.
+mz_bool drfs_mz_zip_reader_init(mz_zip_archive *pZip, mz_uint64 size, mz_uint32 flags);
+
+// Returns the total number of files in the archive.
+mz_uint drfs_mz_zip_reader_get_num_files(mz_zip_archive *pZip);
+
+// Returns detailed information about an archive file entry.
+mz_bool drfs_mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_file_stat *pStat);
+
+// Determines if an archive file entry is a directory entry.
+mz_bool drfs_mz_zip_reader_is_file_a_directory(mz_zip_archive *pZip, mz_uint file_index);
+
+// Retrieves the filename of an archive file entry.
+// Returns the number of bytes written to pFilename, or if filename_buf_size is 0 this function returns the number of bytes needed to fully store the filename.
+mz_uint drfs_mz_zip_reader_get_filename(mz_zip_archive *pZip, mz_uint file_index, char *pFilename, mz_uint filename_buf_size);
+
+// Attempts to locates a file in the archive's central directory.
+// Valid flags: MZ_ZIP_FLAG_CASE_SENSITIVE, MZ_ZIP_FLAG_IGNORE_PATH
+// Returns -1 if the file cannot be found.
+int drfs_mz_zip_reader_locate_file(mz_zip_archive *pZip, const char *pName, const char *pComment, mz_uint flags);
+
+// Extracts a archive file to a memory buffer using no memory allocation.
+mz_bool drfs_mz_zip_reader_extract_to_mem_no_alloc(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size);
+mz_bool drfs_mz_zip_reader_extract_file_to_mem_no_alloc(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size);
+
+// Extracts a archive file to a memory buffer.
+mz_bool drfs_mz_zip_reader_extract_to_mem(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags);
+mz_bool drfs_mz_zip_reader_extract_file_to_mem(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags);
+
+// Extracts a archive file to a dynamically allocated heap buffer.
+void *drfs_mz_zip_reader_extract_to_heap(mz_zip_archive *pZip, mz_uint file_index, size_t *pSize, mz_uint flags);
+
+// Ends archive reading, freeing all allocations, and closing the input archive file if mz_zip_reader_init_file() was used.
+mz_bool drfs_mz_zip_reader_end(mz_zip_archive *pZip);
+
+#endif // #ifndef MINIZ_NO_ARCHIVE_APIS
+
+// ------------------- Low-level Decompression API Definitions
+
+// Decompression flags used by drfs_tinfl_decompress().
+// TINFL_FLAG_PARSE_ZLIB_HEADER: If set, the input has a valid zlib header and ends with an adler32 checksum (it's a valid zlib stream). Otherwise, the input is a raw deflate stream.
+// TINFL_FLAG_HAS_MORE_INPUT: If set, there are more input bytes available beyond the end of the supplied input buffer. If clear, the input buffer contains all remaining input.
+// TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF: If set, the output buffer is large enough to hold the entire decompressed stream. If clear, the output buffer is at least the size of the dictionary (typically 32KB).
+// TINFL_FLAG_COMPUTE_ADLER32: Force adler-32 checksum computation of the decompressed bytes.
+enum
+{
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+// High level decompression functions:
+// drfs_tinfl_decompress_mem_to_heap() decompresses a block in memory to a heap block allocated via malloc().
+// On entry:
+//  pSrc_buf, src_buf_len: Pointer and size of the Deflate or zlib source data to decompress.
+// On return:
+//  Function returns a pointer to the decompressed data, or NULL on failure.
+//  *pOut_len will be set to the decompressed data's size, which could be larger than src_buf_len on uncompressible data.
+//  The caller must call drfs_mz_free() on the returned block when it's no longer needed.
+void *drfs_tinfl_decompress_mem_to_heap(const void *pSrc_buf, size_t src_buf_len, size_t *pOut_len, int flags);
+
+// drfs_tinfl_decompress_mem_to_mem() decompresses a block in memory to another block in memory.
+// Returns TINFL_DECOMPRESS_MEM_TO_MEM_FAILED on failure, or the number of bytes written on success.
+#define TINFL_DECOMPRESS_MEM_TO_MEM_FAILED ((size_t)(-1))
+size_t drfs_tinfl_decompress_mem_to_mem(void *pOut_buf, size_t out_buf_len, const void *pSrc_buf, size_t src_buf_len, int flags);
+
+// drfs_tinfl_decompress_mem_to_callback() decompresses a block in memory to an internal 32KB buffer, and a user provided callback function will be called to flush the buffer.
+// Returns 1 on success or 0 on failure.
+typedef int (*tinfl_put_buf_func_ptr)(const void* pBuf, int len, void *pUser);
+int drfs_tinfl_decompress_mem_to_callback(const void *pIn_buf, size_t *pIn_buf_size, tinfl_put_buf_func_ptr pPut_buf_func, void *pPut_buf_user, int flags);
+
+struct tinfl_decompressor_tag; typedef struct tinfl_decompressor_tag tinfl_decompressor;
+
+// Max size of LZ dictionary.
+#define TINFL_LZ_DICT_SIZE 32768
+
+// Return status.
+typedef enum
+{
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+// Initializes the decompressor to its initial state.
+#define tinfl_init(r) do { (r)->m_state = 0; } MZ_MACRO_END
+#define tinfl_get_adler32(r) (r)->m_check_adler32
+
+// Main low-level decompressor coroutine function. This is the only function actually needed for decompression. All the other functions are just high-level helpers for improved usability.
+// This is a universal API, i.e. it can be used as a building block to build any desired higher level decompression API. In the limit case, it can be called once per every byte input or output.
+tinfl_status drfs_tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags);
+
+// Internal/private bits follow.
+enum
+{
+  TINFL_MAX_HUFF_TABLES = 3, TINFL_MAX_HUFF_SYMBOLS_0 = 288, TINFL_MAX_HUFF_SYMBOLS_1 = 32, TINFL_MAX_HUFF_SYMBOLS_2 = 19,
+  TINFL_FAST_LOOKUP_BITS = 10, TINFL_FAST_LOOKUP_SIZE = 1 << TINFL_FAST_LOOKUP_BITS
+};
+
+typedef struct
+{
+  mz_uint8 m_code_size[TINFL_MAX_HUFF_SYMBOLS_0];
+  mz_int16 m_look_up[TINFL_FAST_LOOKUP_SIZE], m_tree[TINFL_MAX_HUFF_SYMBOLS_0 * 2];
+} tinfl_huff_table;
+
+#if MINIZ_HAS_64BIT_REGISTERS
+  #define TINFL_USE_64BIT_BITBUF 1
+#endif
+
+#if TINFL_USE_64BIT_BITBUF
+  typedef mz_uint64 tinfl_bit_buf_t;
+  #define TINFL_BITBUF_SIZE (64)
+#else
+  typedef mz_uint32 tinfl_bit_buf_t;
+  #define TINFL_BITBUF_SIZE (32)
+#endif
+
+// The fast decoding loop is only used when the bit buffer is 64 bits and unaligned little-endian loads are available. Define
+// DR_FS_NO_FAST_INFLATE to always use the byte-at-a-time loop (useful for benchmarking against it).
+#if TINFL_USE_64BIT_BITBUF && MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN && !defined(DR_FS_NO_FAST_INFLATE)
+  #define TINFL_USE_FAST_LOOP 1
+#endif
+
+struct tinfl_decompressor_tag
+{
+  mz_uint32 m_state, m_num_bits, m_zhdr0, m_zhdr1, m_z_adler32, m_final, m_type, m_check_adler32, m_dist, m_counter, m_num_extra, m_table_sizes[TINFL_MAX_HUFF_TABLES];
+  tinfl_bit_buf_t m_bit_buf;
+  size_t m_dist_from_out_buf_start;
+  tinfl_huff_table m_tables[TINFL_MAX_HUFF_TABLES];
+  mz_uint8 m_raw_header[4], m_len_codes[TINFL_MAX_HUFF_SYMBOLS_0 + TINFL_MAX_HUFF_SYMBOLS_1 + 137];
+#if TINFL_USE_FAST_LOOP
+  // Combined lookup tables for the fast loop. Each entry packs the code length, extra bit count, symbol kind and the literal or base value.
+  mz_uint32 m_fast_litlen[TINFL_FAST_LOOKUP_SIZE], m_fast_dist[TINFL_FAST_LOOKUP_SIZE];
+#endif
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MINIZ_HEADER_INCLUDED
+
+// ------------------- End of Header: Implementation follows. (If you only want the header, define MINIZ_HEADER_FILE_ONLY.)
+
+#ifndef MINIZ_HEADER_FILE_ONLY
+
+typedef unsigned char mz_validate_uint16[sizeof(mz_uint16)==2 ? 1 : -1];
+typedef unsigned char mz_validate_uint32[sizeof(mz_uint32)==4 ? 1 : -1];
+typedef unsigned char mz_validate_uint64[sizeof(mz_uint64)==8 ? 1 : -1];
+
+#include <string.h>
+#include <assert.h>
+
+#define MZ_ASSERT(x) assert(x)
+
+#define MZ_MALLOC(x) DRFS_MALLOC(x)
+#define MZ_FREE(x) DRFS_FREE(x)
+#define MZ_REALLOC(p, x) DRFS_REALLOC(p, x)
+
+#define MZ_MAX(a,b) (((a)>(b))?(a):(b))
+#define MZ_MIN(a,b) (((a)<(b))?(a):(b))
+#define MZ_CLEAR_OBJ(obj) memset(&(obj), 0, sizeof(obj))
+
+#if MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN
+  #define MZ_READ_LE16(p) *((const mz_uint16 *)(p))
+  #define MZ_READ_LE32(p) *((const mz_uint32 *)(p))
+#else
+  #define MZ_READ_LE16(p) ((mz_uint32)(((const mz_uint8 *)(p))[0]) | ((mz_uint32)(((const mz_uint8 *)(p))[1]) << 8U))
+  #define MZ_READ_LE32(p) ((mz_uint32)(((const mz_uint8 *)(p))[0]) | ((mz_uint32)(((const mz_uint8 *)(p))[1]) << 8U) | ((mz_uint32)(((const mz_uint8 *)(p))[2]) << 16U) | ((mz_uint32)(((const mz_uint8 *)(p))[3]) << 24U))
+#endif
+
+#define MZ_READ_LE64(p) (((mz_uint64)MZ_READ_LE32(p)) | (((mz_uint64)MZ_READ_LE32((const mz_uint8 *)(p) + sizeof(mz_uint32))) << 32U))
+
+#ifdef _MSC_VER
+  #define MZ_FORCEINLINE __forceinline
+#elif defined(__GNUC__)
+  #define MZ_FORCEINLINE inline __attribute__((__always_inline__))
+#else
+  #define MZ_FORCEINLINE inline
+#endif
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+static void *def_alloc_func(void *opaque, size_t items, size_t size) { (void)opaque, (void)items, (void)size; return MZ_MALLOC(items * size); }
+static void def_free_func(void *opaque, void *address) { (void)opaque, (void)address; MZ_FREE(address); }
+static void *def_realloc_func(void *opaque, void *address, size_t items, size_t size) { (void)opaque, (void)address, (void)items, (void)size; return MZ_REALLOC(address, items * size); }
+
+// ------------------- zlib-style API's
+
+mz_ulong drfs_mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len)
+{
+  mz_uint32 i, s1 = (mz_uint32)(adler & 0xffff), s2 = (mz_uint32)(adler >> 16); size_t block_len = buf_len % 5552;
+  if (!ptr) return MZ_ADLER32_INIT;
+  while (buf_len) {
+    for (i = 0; i + 7 < block_len; i += 8, ptr += 8) {
+      s1 += ptr[0], s2 += s1; s1 += ptr[1], s2 += s1; s1 += ptr[2], s2 += s1; s1 += ptr[3], s2 += s1;
+      s1 += ptr[4], s2 += s1; s1 += ptr[5], s2 += s1; s1 += ptr[6], s2 += s1; s1 += ptr[7], s2 += s1;
+    }
+    for ( ; i < block_len; ++i) s1 += *ptr++, s2 += s1;
+    s1 %= 65521U, s2 %= 65521U; buf_len -= block_len; block_len = 5552;
+  }
+  return (s2 << 16) + s1;
+}
+
+// Karl Malbrain's compact CRC-32. See "A compact CCITT crc16 and crc32 C implementation that balances processor cache usage against speed": http://www.geocities.com/malbrain/
+// Zip extraction checks the CRC of every file it inflates, so this uses a full byte-wise table rather than miniz's nibble table.
+mz_ulong drfs_mz_crc32(mz_ulong crc, const mz_uint8 *ptr, size_t buf_len)
+{
+  static const mz_uint32 s_crc32[256] = {
+    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
+    0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
+    0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+    0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
+    0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
+    0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+    0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+    0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
+    0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+    0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
+    0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
+    0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+    0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
+    0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+    0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+    0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
+    0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
+    0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+    0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
+    0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
+    0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+    0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
+    0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
+    0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+    0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
+    0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
+    0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+    0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+    0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
+    0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+    0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
+    0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+  };
+  mz_uint32 crcu32 = (mz_uint32)crc;
+  if (!ptr) return MZ_CRC32_INIT;
+  crcu32 = ~crcu32;
+  while (buf_len >= 4)
+  {
+    crcu32 = (crcu32 >> 8) ^ s_crc32[(crcu32 ^ ptr[0]) & 0xFF];
+    crcu32 = (crcu32 >> 8) ^ s_crc32[(crcu32 ^ ptr[1]) & 0xFF];
+    crcu32 = (crcu32 >> 8) ^ s_crc32[(crcu32 ^ ptr[2]) & 0xFF];
+    crcu32 = (crcu32 >> 8) ^ s_crc32[(crcu32 ^ ptr[3]) & 0xFF];
+    ptr += 4; buf_len -= 4;
+  }
+  while (buf_len--) { crcu32 = (crcu32 >> 8) ^ s_crc32[(crcu32 ^ *ptr++) & 0xFF]; }
+  return ~crcu32;
+}
+
+void drfs_mz_free(void *p)
+{
+  MZ_FREE(p);
+}
+
+
+// ------------------- Low-level Decompression (completely independent from all compression API's)
+
+#define TINFL_MEMCPY(d, s, l) memcpy(d, s, l)
+#define TINFL_MEMSET(p, c, l) memset(p, c, l)
+
+#define TINFL_CR_BEGIN switch(r->m_state) { case 0:
+#define TINFL_CR_RETURN(state_index, result) do { status = result; r->m_state = state_index; goto common_exit; case state_index:; } MZ_MACRO_END
+#define TINFL_CR_RETURN_FOREVER(state_index, result) do { for ( ; ; ) { TINFL_CR_RETURN(state_index, result); } } MZ_MACRO_END
+#define TINFL_CR_FINISH }
+
+// TODO: If the caller has indicated that there's no more input, and we attempt to read beyond the input buf, then something is wrong with the input because the inflator never
+// reads ahead more than it needs to. Currently TINFL_GET_BYTE() pads the end of the stream with 0's in this scenario.
+#define TINFL_GET_BYTE(state_index, c) do { \
+  if (pIn_buf_cur >= pIn_buf_end) { \
+    for ( ; ; ) { \
+      if (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) { \
+        TINFL_CR_RETURN(state_index, TINFL_STATUS_NEEDS_MORE_INPUT); \
+        if (pIn_buf_cur < pIn_buf_end) { \
+          c = *pIn_buf_cur++; \
+          break; \
+        } \
+      } else { \
+        c = 0; \
+        break; \
+      } \
+    } \
+  } else c = *pIn_buf_cur++; } MZ_MACRO_END
+
+#define TINFL_NEED_BITS(state_index, n) do { mz_uint c; TINFL_GET_BYTE(state_index, c); bit_buf |= (((tinfl_bit_buf_t)c) << num_bits); num_bits += 8; } while (num_bits < (mz_uint)(n))
+#define TINFL_SKIP_BITS(state_index, n) do { if (num_bits < (mz_uint)(n)) { TINFL_NEED_BITS(state_index, n); } bit_buf >>= (n); num_bits -= (n); } MZ_MACRO_END
+#define TINFL_GET_BITS(state_index, b, n) do { if (num_bits < (mz_uint)(n)) { TINFL_NEED_BITS(state_index, n); } b = bit_buf & ((1 << (n)) - 1); bit_buf >>= (n); num_bits -= (n); } MZ_MACRO_END
+
+// TINFL_HUFF_BITBUF_FILL() is only used rarely, when the number of bytes remaining in the input buffer falls below 2.
+// It reads just enough bytes from the input stream that are needed to decode the next Huffman code (and absolutely no more). It works by trying to fully decode a
+// Huffman code by using whatever bits are currently present in the bit buffer. If this fails, it reads another byte, and tries again until it succeeds or until the
+// bit buffer contains >=15 bits (deflate's max. Huffman code size).
+#define TINFL_HUFF_BITBUF_FILL(state_index, pHuff) \
+  do { \
+    temp = (pHuff)->m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]; \
+    if (temp >= 0) { \
+      code_len = temp >> 9; \
+      if ((code_len) && (num_bits >= code_len)) \
+      break; \
+    } else if (num_bits > TINFL_FAST_LOOKUP_BITS) { \
+       code_len = TINFL_FAST_LOOKUP_BITS; \
+       do { \
+          temp = (pHuff)->m_tree[~temp + ((bit_buf >> code_len++) & 1)]; \
+       } while ((temp < 0) && (num_bits >= (code_len + 1))); if (temp >= 0) break; \
+    } TINFL_GET_BYTE(state_index, c); bit_buf |= (((tinfl_bit_buf_t)c) << num_bits); num_bits += 8; \
+  } while (num_bits < 15);
+
+// TINFL_HUFF_DECODE() decodes the next Huffman coded symbol. It's more complex than you would initially expect because the zlib API expects the decompressor to never read
+// beyond the final byte of the deflate stream. (In other words, when this macro wants to read another byte from the input, it REALLY needs another byte in order to fully
+// decode the next Huffman code.) Handling this properly is particularly important on raw deflate (non-zlib) streams, which aren't followed by a byte aligned adler-32.
+// The slow path is only executed at the very end of the input buffer.
+#define TINFL_HUFF_DECODE(state_index, sym, pHuff) do { \
+  int temp; mz_uint code_len, c; \
+  if (num_bits < 15) { \
+    if ((pIn_buf_end - pIn_buf_cur) < 2) { \
+       TINFL_HUFF_BITBUF_FILL(state_index, pHuff); \
+    } else { \
+       bit_buf |= (((tinfl_bit_buf_t)pIn_buf_cur[0]) << num_bits) | (((tinfl_bit_buf_t)pIn_buf_cur[1]) << (num_bits + 8)); pIn_buf_cur += 2; num_bits += 16; \
+    } \
+  } \
+  if ((temp = (pHuff)->m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0) \
+    code_len = temp >> 9, temp &= 511; \
+  else { \
+    code_len = TINFL_FAST_LOOKUP_BITS; do { temp = (pHuff)->m_tree[~temp + ((bit_buf >> code_len++) & 1)]; } while (temp < 0); \
+  } sym = temp; bit_buf >>= code_len; num_bits -= code_len; } MZ_MACRO_END
+
+static const int s_length_base[31] = { 3,4,5,6,7,8,9,10,11,13, 15,17,19,23,27,31,35,43,51,59, 67,83,99,115,131,163,195,227,258,0,0 };
+static const int s_length_extra[31]= { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0,0,0 };
+static const int s_dist_base[32] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193, 257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0};
+static const int s_dist_extra[32] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+
+#if TINFL_USE_FAST_LOOP
+// Fast loop entry layout: bits 0-3 are the code length, bits 4-7 the number of extra bits, bits 8-9 the kind of symbol and bits 16-31
+// the literal byte or the length/distance base. An entry of 0 means the code is longer than TINFL_FAST_LOOKUP_BITS or invalid.
+#define TINFL_FAST_KIND_LITERAL (1 << 8)
+#define TINFL_FAST_KIND_COPY    (2 << 8)
+#define TINFL_FAST_KIND_END     (3 << 8)
+#define TINFL_FAST_KIND_MASK    (3 << 8)
+
+// The fast loop needs 8 readable input bytes for each refill, and room for the longest match plus the overrun of an 8-byte wide copy.
+#define TINFL_FAST_INPUT_SLACK  8
+#define TINFL_FAST_OUTPUT_SLACK (258 + 8)
+
+enum { TINFL_FAST_CONTINUE, TINFL_FAST_END_OF_BLOCK, TINFL_FAST_FAILED };
+
+static mz_uint32 tinfl_fast_litlen_entry(mz_uint sym, mz_uint code_len)
+{
+  if (sym < 256) return code_len | TINFL_FAST_KIND_LITERAL | (sym << 16);
+  if (sym == 256) return code_len | TINFL_FAST_KIND_END;
+  if (sym < 286) return code_len | (s_length_extra[sym - 257] << 4) | TINFL_FAST_KIND_COPY | ((mz_uint32)s_length_base[sym - 257] << 16);
+  return 0;
+}
+
+static mz_uint32 tinfl_fast_dist_entry(mz_uint sym, mz_uint code_len)
+{
+  if (sym < 30) return code_len | (s_dist_extra[sym] << 4) | TINFL_FAST_KIND_COPY | ((mz_uint32)s_dist_base[sym] << 16);
+  return 0;
+}
+
+static void tinfl_build_fast_tables(tinfl_decompressor *r)
+{
+  mz_uint i;
+  for (i = 0; i < TINFL_FAST_LOOKUP_SIZE; ++i)
+  {
+    int lit = r->m_tables[0].m_look_up[i], dst = r->m_tables[1].m_look_up[i];
+    r->m_fast_litlen[i] = (lit > 0) ? tinfl_fast_litlen_entry(lit & 511, lit >> 9) : 0;
+    r->m_fast_dist[i]   = (dst > 0) ? tinfl_fast_dist_entry(dst & 511, dst >> 9) : 0;
+  }
+}
+
+// Resolves codes that are longer than TINFL_FAST_LOOKUP_BITS by walking the tree. Returns 0 if the code is not valid.
+static mz_uint32 tinfl_fast_decode_long(const tinfl_huff_table *pTable, tinfl_bit_buf_t bit_buf, int is_dist)
+{
+  int sym = pTable->m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]; mz_uint code_len = TINFL_FAST_LOOKUP_BITS;
+  if (sym >= 0) return 0;
+  do { sym = pTable->m_tree[~sym + ((bit_buf >> code_len++) & 1)]; } while ((sym < 0) && (code_len < 16));
+  if (sym < 0) return 0;
+  return is_dist ? tinfl_fast_dist_entry((mz_uint)sym, code_len) : tinfl_fast_litlen_entry((mz_uint)sym, code_len);
+}
+
+// Decodes literals and matches with a 64-bit bit buffer that is refilled 8 bytes at a time. This never needs to suspend, so it stays
+// out of the coroutine and simply stops when it reaches the end of the block or gets within the slack of either buffer. On exit the
+// bits above num_bits are cleared so the byte-at-a-time loop can carry on from where this left off.
+static int tinfl_decode_fast(tinfl_decompressor *r, const mz_uint8 **ppIn_buf_cur, const mz_uint8 *pIn_buf_end, mz_uint8 **ppOut_buf_cur, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_end, tinfl_bit_buf_t *pBit_buf, mz_uint32 *pNum_bits)
+{
+  const mz_uint8 *pIn = *ppIn_buf_cur; mz_uint8 *pOut = *ppOut_buf_cur;
+  tinfl_bit_buf_t bit_buf = *pBit_buf; mz_uint32 num_bits = *pNum_bits;
+  int result = TINFL_FAST_CONTINUE;
+
+  while (((pIn_buf_end - pIn) >= TINFL_FAST_INPUT_SLACK) && ((pOut_buf_end - pOut) >= TINFL_FAST_OUTPUT_SLACK))
+  {
+    mz_uint32 entry, len, dist, extra; const mz_uint8 *pSrc;
+
+    // Refill to at least 56 bits. Bits above num_bits may hold part of the next unconsumed byte, but the next refill ORs in the same
+    // bits at the same position so they never need to be cleared inside the loop. 56 bits covers the worst case of a 15-bit length
+    // code, 5 extra bits, a 15-bit distance code and 13 extra bits.
+    bit_buf |= MZ_READ_LE64(pIn) << num_bits; pIn += (63 - num_bits) >> 3; num_bits |= 56;
+
+    entry = r->m_fast_litlen[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)];
+    if (!entry && !(entry = tinfl_fast_decode_long(&r->m_tables[0], bit_buf, 0))) { result = TINFL_FAST_FAILED; break; }
+    bit_buf >>= (entry & 15); num_bits -= (entry & 15);
+
+    if ((entry & TINFL_FAST_KIND_MASK) == TINFL_FAST_KIND_LITERAL)
+    {
+      *pOut++ = (mz_uint8)(entry >> 16);
+
+      // There are at least 41 bits left which is always enough for a second literal, so try for one without refilling.
+      entry = r->m_fast_litlen[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)];
+      if ((entry & TINFL_FAST_KIND_MASK) == TINFL_FAST_KIND_LITERAL)
+      {
+        bit_buf >>= (entry & 15); num_bits -= (entry & 15);
+        *pOut++ = (mz_uint8)(entry >> 16);
+      }
+      continue;
+    }
+    if ((entry & TINFL_FAST_KIND_MASK) == TINFL_FAST_KIND_END) { result = TINFL_FAST_END_OF_BLOCK; break; }
+
+    extra = (entry >> 4) & 15; len = (entry >> 16) + (mz_uint32)(bit_buf & ((1U << extra) - 1)); bit_buf >>= extra; num_bits -= extra;
+
+    entry = r->m_fast_dist[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)];
+    if (!entry && !(entry = tinfl_fast_decode_long(&r->m_tables[1], bit_buf, 1))) { result = TINFL_FAST_FAILED; break; }
+    bit_buf >>= (entry & 15); num_bits -= (entry & 15);
+    extra = (entry >> 4) & 15; dist = (entry >> 16) + (mz_uint32)(bit_buf & ((1U << extra) - 1)); bit_buf >>= extra; num_bits -= extra;
+
+    if (dist > (size_t)(pOut - pOut_buf_start)) { result = TINFL_FAST_FAILED; break; }
+    pSrc = pOut - dist;
+
+    if (dist >= 8)
+    {
+      // Wide copy. This can write up to 7 bytes past the end of the match, which the output slack allows for.
+      mz_uint8 *pEnd = pOut + len;
+      do { TINFL_MEMCPY(pOut, pSrc, 8); pOut += 8; pSrc += 8; } while (pOut < pEnd);
+      pOut = pEnd;
+    }
+    else if (dist == 1)
+    {
+      TINFL_MEMSET(pOut, pSrc[0], len); pOut += len;
+    }
+    else
+    {
+      // The pattern is shorter than a word. Lay it out byte by byte until it spans at least 8 bytes, then keep going with wide copies
+      // from a multiple of the distance back, which holds the same pattern.
+      mz_uint8 *pEnd = pOut + len; mz_uint32 stride = dist * ((8 + dist - 1) / dist);
+      mz_uint32 head = MZ_MIN(len, stride);
+      do { *pOut++ = *pSrc++; } while (--head);
+      for (pSrc = pOut - stride; pOut < pEnd; pOut += 8, pSrc += 8) TINFL_MEMCPY(pOut, pSrc, 8);
+      pOut = pEnd;
+    }
+  }
+
+  bit_buf &= (((tinfl_bit_buf_t)1) << num_bits) - 1;
+  *ppIn_buf_cur = pIn; *ppOut_buf_cur = pOut; *pBit_buf = bit_buf; *pNum_bits = num_bits;
+  return result;
+}
+#endif
+
+tinfl_status drfs_tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags)
+{
+  static const mz_uint8 s_length_dezigzag[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+  static const int s_min_table_sizes[3] = { 257, 1, 4 };
+
+  tinfl_status status = TINFL_STATUS_FAILED; mz_uint32 num_bits, dist, counter, num_extra; tinfl_bit_buf_t bit_buf;
+  const mz_uint8 *pIn_buf_cur = pIn_buf_next, *const pIn_buf_end = pIn_buf_next + *pIn_buf_size;
+  mz_uint8 *pOut_buf_cur = pOut_buf_next, *const pOut_buf_end = pOut_buf_next + *pOut_buf_size;
+  size_t out_buf_size_mask = (decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF) ? (size_t)-1 : ((pOut_buf_next - pOut_buf_start) + *pOut_buf_size) - 1, dist_from_out_buf_start;
+
+  // Ensure the output buffer's size is a power of 2, unless the output buffer is large enough to hold the entire output file (in which case it doesn't matter).
+  if (((out_buf_size_mask + 1) & out_buf_size_mask) || (pOut_buf_next < pOut_buf_start)) { *pIn_buf_size = *pOut_buf_size = 0; return TINFL_STATUS_BAD_PARAM; }
+
+  num_bits = r->m_num_bits; bit_buf = r->m_bit_buf; dist = r->m_dist; counter = r->m_counter; num_extra = r->m_num_extra; dist_from_out_buf_start = r->m_dist_from_out_buf_start;
+  TINFL_CR_BEGIN
+
+  bit_buf = num_bits = dist = counter = num_extra = r->m_zhdr0 = r->m_zhdr1 = 0; r->m_z_adler32 = r->m_check_adler32 = 1;
+  if (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER)
+  {
+    TINFL_GET_BYTE(1, r->m_zhdr0); TINFL_GET_BYTE(2, r->m_zhdr1);
+    counter = (((r->m_zhdr0 * 256 + r->m_zhdr1) % 31 != 0) || (r->m_zhdr1 & 32) || ((r->m_zhdr0 & 15) != 8));
+    if (!(decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)) counter |= (((1U << (8U + (r->m_zhdr0 >> 4))) > 32768U) || ((out_buf_size_mask + 1) < (size_t)(1U << (8U + (r->m_zhdr0 >> 4)))));
+    if (counter) { TINFL_CR_RETURN_FOREVER(36, TINFL_STATUS_FAILED); }
+  }
+
+  do
+  {
+    TINFL_GET_BITS(3, r->m_final, 3); r->m_type = r->m_final >> 1;
+    if (r->m_type == 0)
+    {
+      TINFL_SKIP_BITS(5, num_bits & 7);
+      for (counter = 0; counter < 4; ++counter) { if (num_bits) TINFL_GET_BITS(6, r->m_raw_header[counter], 8); else TINFL_GET_BYTE(7, r->m_raw_header[counter]); }
+      if ((counter = (r->m_raw_header[0] | (r->m_raw_header[1] << 8))) != (mz_uint)(0xFFFF ^ (r->m_raw_header[2] | (r->m_raw_header[3] << 8)))) { TINFL_CR_RETURN_FOREVER(39, TINFL_STATUS_FAILED); }
+      while ((counter) && (num_bits))
+      {
+        TINFL_GET_BITS(51, dist, 8);
+        while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(52, TINFL_STATUS_HAS_MORE_OUTPUT); }
+        *pOut_buf_cur++ = (mz_uint8)dist;
+        counter--;
+      }
+      while (counter)
+      {
+        size_t n; while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(9, TINFL_STATUS_HAS_MORE_OUTPUT); }
+        while (pIn_buf_cur >= pIn_buf_end)
+        {
+          if (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT)
+          {
+            TINFL_CR_RETURN(38, TINFL_STATUS_NEEDS_MORE_INPUT);
+          }
+          else
+          {
+            TINFL_CR_RETURN_FOREVER(40, TINFL_STATUS_FAILED);
+          }
+        }
+        n = MZ_MIN(MZ_MIN((size_t)(pOut_buf_end - pOut_buf_cur), (size_t)(pIn_buf_end - pIn_buf_cur)), counter);
+        TINFL_MEMCPY(pOut_buf_cur, pIn_buf_cur, n); pIn_buf_cur += n; pOut_buf_cur += n; counter -= (mz_uint)n;
+      }
+    }
+    else if (r->m_type == 3)
+    {
+      TINFL_CR_RETURN_FOREVER(10, TINFL_STATUS_FAILED);
+    }
+    else
+    {
+      if (r->m_type == 1)
+      {
+        mz_uint8 *p = r->m_tables[0].m_code_size; mz_uint i;
+        r->m_table_sizes[0] = 288; r->m_table_sizes[1] = 32; TINFL_MEMSET(r->m_tables[1].m_code_size, 5, 32);
+        for ( i = 0; i <= 143; ++i) *p++ = 8; for ( ; i <= 255; ++i) *p++ = 9; for ( ; i <= 279; ++i) *p++ = 7; for ( ; i <= 287; ++i) *p++ = 8;
+      }
+      else
+      {
+        for (counter = 0; counter < 3; counter++) { TINFL_GET_BITS(11, r->m_table_sizes[counter], "\05\05\04"[counter]); r->m_table_sizes[counter] += s_min_table_sizes[counter]; }
+        MZ_CLEAR_OBJ(r->m_tables[2].m_code_size); for (counter = 0; counter < r->m_table_sizes[2]; counter++) { mz_uint s; TINFL_GET_BITS(14, s, 3); r->m_tables[2].m_code_size[s_length_dezigzag[counter]] = (mz_uint8)s; }
+        r->m_table_sizes[2] = 19;
+      }
+      for ( ; (int)r->m_type >= 0; r->m_type--)
+      {
+        int tree_next, tree_cur; tinfl_huff_table *pTable;
+        mz_uint i, j, used_syms, total, sym_index, next_code[17], total_syms[16]; pTable = &r->m_tables[r->m_type]; MZ_CLEAR_OBJ(total_syms); MZ_CLEAR_OBJ(pTable->m_look_up); MZ_CLEAR_OBJ(pTable->m_tree);
+        for (i = 0; i < r->m_table_sizes[r->m_type]; ++i) total_syms[pTable->m_code_size[i]]++;
+        used_syms = 0, total = 0; next_code[0] = next_code[1] = 0;
+        for (i = 1; i <= 15; ++i) { used_syms += total_syms[i]; next_code[i + 1] = (total = ((total + total_syms[i]) << 1)); }
+        if ((65536 != total) && (used_syms > 1))
+        {
+          TINFL_CR_RETURN_FOREVER(35, TINFL_STATUS_FAILED);
+        }
+        for (tree_next = -1, sym_index = 0; sym_index < r->m_table_sizes[r->m_type]; ++sym_index)
+        {
+          mz_uint rev_code = 0, l, cur_code, code_size = pTable->m_code_size[sym_index]; if (!code_size) continue;
+          cur_code = next_code[code_size]++; for (l = code_size; l > 0; l--, cur_code >>= 1) rev_code = (rev_code << 1) | (cur_code & 1);
+          if (code_size <= TINFL_FAST_LOOKUP_BITS) { mz_int16 k = (mz_int16)((code_size << 9) | sym_index); while (rev_code < TINFL_FAST_LOOKUP_SIZE) { pTable->m_look_up[rev_code] = k; rev_code += (1 << code_size); } continue; }
+          if (0 == (tree_cur = pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)])) { pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)] = (mz_int16)tree_next; tree_cur = tree_next; tree_next -= 2; }
+          rev_code >>= (TINFL_FAST_LOOKUP_BITS - 1);
+          for (j = code_size; j > (TINFL_FAST_LOOKUP_BITS + 1); j--)
+          {
+            tree_cur -= ((rev_code >>= 1) & 1);
+            if (!pTable->m_tree[-tree_cur - 1]) { pTable->m_tree[-tree_cur - 1] = (mz_int16)tree_next; tree_cur = tree_next; tree_next -= 2; } else tree_cur = pTable->m_tree[-tree_cur - 1];
+          }
+          tree_cur -= ((rev_code >>= 1) & 1); pTable->m_tree[-tree_cur - 1] = (mz_int16)sym_index;
+        }
+        if (r->m_type == 2)
+        {
+          for (counter = 0; counter < (r->m_table_sizes[0] + r->m_table_sizes[1]); )
+          {
+            mz_uint s; TINFL_HUFF_DECODE(16, dist, &r->m_tables[2]); if (dist < 16) { r->m_len_codes[counter++] = (mz_uint8)dist; continue; }
+            if ((dist == 16) && (!counter))
+            {
+              TINFL_CR_RETURN_FOREVER(17, TINFL_STATUS_FAILED);
+            }
+            num_extra = "\02\03\07"[dist - 16]; TINFL_GET_BITS(18, s, num_extra); s += "\03\03\013"[dist - 16];
+            TINFL_MEMSET(r->m_len_codes + counter, (dist == 16) ? r->m_len_codes[counter - 1] : 0, s); counter += s;
+          }
+          if ((r->m_table_sizes[0] + r->m_table_sizes[1]) != counter)
+          {
+            TINFL_CR_RETURN_FOREVER(21, TINFL_STATUS_FAILED);
+          }
+          TINFL_MEMCPY(r->m_tables[0].m_code_size, r->m_len_codes, r->m_table_sizes[0]); TINFL_MEMCPY(r->m_tables[1].m_code_size, r->m_len_codes + r->m_table_sizes[0], r->m_table_sizes[1]);
+        }
+      }
+#if TINFL_USE_FAST_LOOP
+      if (decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF) tinfl_build_fast_tables(r);
+#endif
+      for ( ; ; )
+      {
+        mz_uint8 *pSrc;
+#if TINFL_USE_FAST_LOOP
+        // The fast loop only runs on non-wrapping output buffers so that matches never need the wrap-around mask.
+        if ((decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF) && ((pIn_buf_end - pIn_buf_cur) >= TINFL_FAST_INPUT_SLACK) && ((pOut_buf_end - pOut_buf_cur) >= TINFL_FAST_OUTPUT_SLACK))
+        {
+          int fast_result = tinfl_decode_fast(r, &pIn_buf_cur, pIn_buf_end, &pOut_buf_cur, pOut_buf_start, pOut_buf_end, &bit_buf, &num_bits);
+          if (fast_result == TINFL_FAST_END_OF_BLOCK)
+            break;
+          if (fast_result == TINFL_FAST_FAILED)
+          {
+            TINFL_CR_RETURN_FOREVER(43, TINFL_STATUS_FAILED);
+          }
+        }
+#endif
+        for ( ; ; )
+        {
+          if (((pIn_buf_end - pIn_buf_cur) < 4) || ((pOut_buf_end - pOut_buf_cur) < 2))
+          {
+            TINFL_HUFF_DECODE(23, counter, &r->m_tables[0]);
+            if (counter >= 256)
+              break;
+            while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(24, TINFL_STATUS_HAS_MORE_OUTPUT); }
+            *pOut_buf_cur++ = (mz_uint8)counter;
+          }
+          else
+          {
+            int sym2; mz_uint code_len;
+#if TINFL_USE_64BIT_BITBUF
+            if (num_bits < 30) { bit_buf |= (((tinfl_bit_buf_t)MZ_READ_LE32(pIn_buf_cur)) << num_bits); pIn_buf_cur += 4; num_bits += 32; }
+#else
+            if (num_bits < 15) { bit_buf |= (((tinfl_bit_buf_t)MZ_READ_LE16(pIn_buf_cur)) << num_bits); pIn_buf_cur += 2; num_bits += 16; }
+#endif
+            if ((sym2 = r->m_tables[0].m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0)
+              code_len = sym2 >> 9;
+            else
+            {
+              code_len = TINFL_FAST_LOOKUP_BITS; do { sym2 = r->m_tables[0].m_tree[~sym2 + ((bit_buf >> code_len++) & 1)]; } while (sym2 < 0);
+            }
+            counter = sym2; bit_buf >>= code_len; num_bits -= code_len;
+            if (counter & 256)
+              break;
+
+#if !TINFL_USE_64BIT_BITBUF
+            if (num_bits < 15) { bit_buf |= (((tinfl_bit_buf_t)MZ_READ_LE16(pIn_buf_cur)) << num_bits); pIn_buf_cur += 2; num_bits += 16; }
+#endif
+            if ((sym2 = r->m_tables[0].m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0)
+              code_len = sym2 >> 9;
+            else
+            {
+              code_len = TINFL_FAST_LOOKUP_BITS; do { sym2 = r->m_tables[0].m_tree[~sym2 + ((bit_buf >> code_len++) & 1)]; } while (sym2 < 0);
+            }
+            bit_buf >>= code_len; num_bits -= code_len;
+
+            pOut_buf_cur[0] = (mz_uint8)counter;
+            if (sym2 & 256)
+            {
+              pOut_buf_cur++;
+              counter = sym2;
+              break;
+            }
+            pOut_buf_cur[1] = (mz_uint8)sym2;
+            pOut_buf_cur += 2;
+          }
+        }
+        if ((counter &= 511) == 256) break;
+
+        num_extra = s_length_extra[counter - 257]; counter = s_length_base[counter - 257];
+        if (num_extra) { mz_uint extra_bits; TINFL_GET_BITS(25, extra_bits, num_extra); counter += extra_bits; }
+
+        TINFL_HUFF_DECODE(26, dist, &r->m_tables[1]);
+        num_extra = s_dist_extra[dist]; dist = s_dist_base[dist];
+        if (num_extra) { mz_uint extra_bits; TINFL_GET_BITS(27, extra_bits, num_extra); dist += extra_bits; }
+
+        dist_from_out_buf_start = pOut_buf_cur - pOut_buf_start;
+        if ((dist > dist_from_out_buf_start) && (decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF))
+        {
+          TINFL_CR_RETURN_FOREVER(37, TINFL_STATUS_FAILED);
+        }
+
+        pSrc = pOut_buf_start + ((dist_from_out_buf_start - dist) & out_buf_size_mask);
+
+        if ((MZ_MAX(pOut_buf_cur, pSrc) + counter) > pOut_buf_end)
+        {
+          while (counter--)
+          {
+            while (pOut_buf_cur >= pOut_buf_end) { TINFL_CR_RETURN(53, TINFL_STATUS_HAS_MORE_OUTPUT); }
+            *pOut_buf_cur++ = pOut_buf_start[(dist_from_out_buf_start++ - dist) & out_buf_size_mask];
+          }
+          continue;
+        }
+#if MINIZ_USE_UNALIGNED_LOADS_AND_STORES
+        else if ((counter >= 9) && (counter <= dist))
+        {
+          const mz_uint8 *pSrc_end = pSrc + (counter & ~7);
+          do
+          {
+            ((mz_uint32 *)pOut_buf_cur)[0] = ((const mz_uint32 *)pSrc)[0];
+            ((mz_uint32 *)pOut_buf_cur)[1] = ((const mz_uint32 *)pSrc)[1];
             pOut_buf_cur += 8;
           } while ((pSrc += 8) < pSrc_end);
           if ((counter &= 7) < 3)
@@ -5396,1310 +6824,2587 @@ tinfl_status drfs_tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_bu
               pOut_buf_cur += counter;
             }
             continue;
-          }
+          }
+        }
+#endif
+        do
+        {
+          pOut_buf_cur[0] = pSrc[0];
+          pOut_buf_cur[1] = pSrc[1];
+          pOut_buf_cur[2] = pSrc[2];
+          pOut_buf_cur += 3; pSrc += 3;
+        } while ((int)(counter -= 3) > 2);
+        if ((int)counter > 0)
+        {
+          pOut_buf_cur[0] = pSrc[0];
+          if ((int)counter > 1)
+            pOut_buf_cur[1] = pSrc[1];
+          pOut_buf_cur += counter;
+        }
+      }
+    }
+  } while (!(r->m_final & 1));
+  if (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER)
+  {
+    TINFL_SKIP_BITS(32, num_bits & 7); for (counter = 0; counter < 4; ++counter) { mz_uint s; if (num_bits) TINFL_GET_BITS(41, s, 8); else TINFL_GET_BYTE(42, s); r->m_z_adler32 = (r->m_z_adler32 << 8) | s; }
+  }
+  TINFL_CR_RETURN_FOREVER(34, TINFL_STATUS_DONE);
+  TINFL_CR_FINISH
+
+common_exit:
+  r->m_num_bits = num_bits; r->m_bit_buf = bit_buf; r->m_dist = dist; r->m_counter = counter; r->m_num_extra = num_extra; r->m_dist_from_out_buf_start = dist_from_out_buf_start;
+  *pIn_buf_size = pIn_buf_cur - pIn_buf_next; *pOut_buf_size = pOut_buf_cur - pOut_buf_next;
+  if ((decomp_flags & (TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32)) && (status >= 0))
+  {
+    const mz_uint8 *ptr = pOut_buf_next; size_t buf_len = *pOut_buf_size;
+    mz_uint32 i, s1 = r->m_check_adler32 & 0xffff, s2 = r->m_check_adler32 >> 16; size_t block_len = buf_len % 5552;
+    while (buf_len)
+    {
+      for (i = 0; i + 7 < block_len; i += 8, ptr += 8)
+      {
+        s1 += ptr[0], s2 += s1; s1 += ptr[1], s2 += s1; s1 += ptr[2], s2 += s1; s1 += ptr[3], s2 += s1;
+        s1 += ptr[4], s2 += s1; s1 += ptr[5], s2 += s1; s1 += ptr[6], s2 += s1; s1 += ptr[7], s2 += s1;
+      }
+      for ( ; i < block_len; ++i) s1 += *ptr++, s2 += s1;
+      s1 %= 65521U, s2 %= 65521U; buf_len -= block_len; block_len = 5552;
+    }
+    r->m_check_adler32 = (s2 << 16) + s1; if ((status == TINFL_STATUS_DONE) && (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) && (r->m_check_adler32 != r->m_z_adler32)) status = TINFL_STATUS_ADLER32_MISMATCH;
+  }
+  return status;
+}
+
+// Higher level helper functions.
+void *drfs_tinfl_decompress_mem_to_heap(const void *pSrc_buf, size_t src_buf_len, size_t *pOut_len, int flags)
+{
+  tinfl_decompressor decomp; void *pBuf = NULL, *pNew_buf; size_t src_buf_ofs = 0, out_buf_capacity = 0;
+  *pOut_len = 0;
+  tinfl_init(&decomp);
+  for ( ; ; )
+  {
+    size_t src_buf_size = src_buf_len - src_buf_ofs, dst_buf_size = out_buf_capacity - *pOut_len, new_out_buf_capacity;
+    tinfl_status status = drfs_tinfl_decompress(&decomp, (const mz_uint8*)pSrc_buf + src_buf_ofs, &src_buf_size, (mz_uint8*)pBuf, pBuf ? (mz_uint8*)pBuf + *pOut_len : NULL, &dst_buf_size,
+      (flags & ~TINFL_FLAG_HAS_MORE_INPUT) | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    if ((status < 0) || (status == TINFL_STATUS_NEEDS_MORE_INPUT))
+    {
+      MZ_FREE(pBuf); *pOut_len = 0; return NULL;
+    }
+    src_buf_ofs += src_buf_size;
+    *pOut_len += dst_buf_size;
+    if (status == TINFL_STATUS_DONE) break;
+    new_out_buf_capacity = out_buf_capacity * 2; if (new_out_buf_capacity < 128) new_out_buf_capacity = 128;
+    pNew_buf = MZ_REALLOC(pBuf, new_out_buf_capacity);
+    if (!pNew_buf)
+    {
+      MZ_FREE(pBuf); *pOut_len = 0; return NULL;
+    }
+    pBuf = pNew_buf; out_buf_capacity = new_out_buf_capacity;
+  }
+  return pBuf;
+}
+
+size_t drfs_tinfl_decompress_mem_to_mem(void *pOut_buf, size_t out_buf_len, const void *pSrc_buf, size_t src_buf_len, int flags)
+{
+  tinfl_decompressor decomp; tinfl_status status; tinfl_init(&decomp);
+  status = drfs_tinfl_decompress(&decomp, (const mz_uint8*)pSrc_buf, &src_buf_len, (mz_uint8*)pOut_buf, (mz_uint8*)pOut_buf, &out_buf_len, (flags & ~TINFL_FLAG_HAS_MORE_INPUT) | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+  return (status != TINFL_STATUS_DONE) ? TINFL_DECOMPRESS_MEM_TO_MEM_FAILED : out_buf_len;
+}
+
+int drfs_tinfl_decompress_mem_to_callback(const void *pIn_buf, size_t *pIn_buf_size, tinfl_put_buf_func_ptr pPut_buf_func, void *pPut_buf_user, int flags)
+{
+  int result = 0;
+  tinfl_decompressor decomp;
+  mz_uint8 *pDict = (mz_uint8*)MZ_MALLOC(TINFL_LZ_DICT_SIZE); size_t in_buf_ofs = 0, dict_ofs = 0;
+  if (!pDict)
+    return TINFL_STATUS_FAILED;
+  tinfl_init(&decomp);
+  for ( ; ; )
+  {
+    size_t in_buf_size = *pIn_buf_size - in_buf_ofs, dst_buf_size = TINFL_LZ_DICT_SIZE - dict_ofs;
+    tinfl_status status = drfs_tinfl_decompress(&decomp, (const mz_uint8*)pIn_buf + in_buf_ofs, &in_buf_size, pDict, pDict + dict_ofs, &dst_buf_size,
+      (flags & ~(TINFL_FLAG_HAS_MORE_INPUT | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)));
+    in_buf_ofs += in_buf_size;
+    if ((dst_buf_size) && (!(*pPut_buf_func)(pDict + dict_ofs, (int)dst_buf_size, pPut_buf_user)))
+      break;
+    if (status != TINFL_STATUS_HAS_MORE_OUTPUT)
+    {
+      result = (status == TINFL_STATUS_DONE);
+      break;
+    }
+    dict_ofs = (dict_ofs + dst_buf_size) & (TINFL_LZ_DICT_SIZE - 1);
+  }
+  MZ_FREE(pDict);
+  *pIn_buf_size = in_buf_ofs;
+  return result;
+}
+
+
+// ------------------- .ZIP archive reading
+
+#ifndef MINIZ_NO_ARCHIVE_APIS
+
+#define MZ_TOLOWER(c) ((((c) >= 'A') && ((c) <= 'Z')) ? ((c) - 'A' + 'a') : (c))
+
+// Various ZIP archive enums. To completely avoid cross platform compiler alignment and platform endian issues, miniz.c doesn't use structs for any of this stuff.
+enum
+{
+  // ZIP archive identifiers and record sizes
+  MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG = 0x06054b50, MZ_ZIP_CENTRAL_DIR_HEADER_SIG = 0x02014b50, MZ_ZIP_LOCAL_DIR_HEADER_SIG = 0x04034b50,
+  MZ_ZIP_LOCAL_DIR_HEADER_SIZE = 30, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE = 46, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE = 22,
+  // Central directory header record offsets
+  MZ_ZIP_CDH_SIG_OFS = 0, MZ_ZIP_CDH_VERSION_MADE_BY_OFS = 4, MZ_ZIP_CDH_VERSION_NEEDED_OFS = 6, MZ_ZIP_CDH_BIT_FLAG_OFS = 8,
+  MZ_ZIP_CDH_METHOD_OFS = 10, MZ_ZIP_CDH_FILE_TIME_OFS = 12, MZ_ZIP_CDH_FILE_DATE_OFS = 14, MZ_ZIP_CDH_CRC32_OFS = 16,
+  MZ_ZIP_CDH_COMPRESSED_SIZE_OFS = 20, MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS = 24, MZ_ZIP_CDH_FILENAME_LEN_OFS = 28, MZ_ZIP_CDH_EXTRA_LEN_OFS = 30,
+  MZ_ZIP_CDH_COMMENT_LEN_OFS = 32, MZ_ZIP_CDH_DISK_START_OFS = 34, MZ_ZIP_CDH_INTERNAL_ATTR_OFS = 36, MZ_ZIP_CDH_EXTERNAL_ATTR_OFS = 38, MZ_ZIP_CDH_LOCAL_HEADER_OFS = 42,
+  // Local directory header offsets
+  MZ_ZIP_LDH_SIG_OFS = 0, MZ_ZIP_LDH_VERSION_NEEDED_OFS = 4, MZ_ZIP_LDH_BIT_FLAG_OFS = 6, MZ_ZIP_LDH_METHOD_OFS = 8, MZ_ZIP_LDH_FILE_TIME_OFS = 10,
+  MZ_ZIP_LDH_FILE_DATE_OFS = 12, MZ_ZIP_LDH_CRC32_OFS = 14, MZ_ZIP_LDH_COMPRESSED_SIZE_OFS = 18, MZ_ZIP_LDH_DECOMPRESSED_SIZE_OFS = 22,
+  MZ_ZIP_LDH_FILENAME_LEN_OFS = 26, MZ_ZIP_LDH_EXTRA_LEN_OFS = 28,
+  // End of central directory offsets
+  MZ_ZIP_ECDH_SIG_OFS = 0, MZ_ZIP_ECDH_NUM_THIS_DISK_OFS = 4, MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS = 6, MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS = 8,
+  MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS = 10, MZ_ZIP_ECDH_CDIR_SIZE_OFS = 12, MZ_ZIP_ECDH_CDIR_OFS_OFS = 16, MZ_ZIP_ECDH_COMMENT_SIZE_OFS = 20,
+};
+
+typedef struct
+{
+  void *m_p;
+  size_t m_size, m_capacity;
+  mz_uint m_element_size;
+} mz_zip_array;
+
+struct mz_zip_internal_state_tag
+{
+  mz_zip_array m_central_dir;
+  mz_zip_array m_central_dir_offsets;
+  mz_zip_array m_sorted_central_dir_offsets;
+  void* *m_pFile;
+  void *m_pMem;
+  size_t m_mem_size;
+  size_t m_mem_capacity;
+};
+
+#define MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(array_ptr, element_size) (array_ptr)->m_element_size = element_size
+#define MZ_ZIP_ARRAY_ELEMENT(array_ptr, element_type, index) ((element_type *)((array_ptr)->m_p))[index]
+
+static MZ_FORCEINLINE void mz_zip_array_clear(mz_zip_archive *pZip, mz_zip_array *pArray)
+{
+  pZip->m_pFree(pZip->m_pAlloc_opaque, pArray->m_p);
+  memset(pArray, 0, sizeof(mz_zip_array));
+}
+
+static mz_bool mz_zip_array_ensure_capacity(mz_zip_archive *pZip, mz_zip_array *pArray, size_t min_new_capacity, mz_uint growing)
+{
+  void *pNew_p; size_t new_capacity = min_new_capacity; MZ_ASSERT(pArray->m_element_size); if (pArray->m_capacity >= min_new_capacity) return MZ_TRUE;
+  if (growing) { new_capacity = MZ_MAX(1, pArray->m_capacity); while (new_capacity < min_new_capacity) new_capacity *= 2; }
+  if (NULL == (pNew_p = pZip->m_pRealloc(pZip->m_pAlloc_opaque, pArray->m_p, pArray->m_element_size, new_capacity))) return MZ_FALSE;
+  pArray->m_p = pNew_p; pArray->m_capacity = new_capacity;
+  return MZ_TRUE;
+}
+
+static MZ_FORCEINLINE mz_bool mz_zip_array_reserve(mz_zip_archive *pZip, mz_zip_array *pArray, size_t new_capacity, mz_uint growing)
+{
+  if (new_capacity > pArray->m_capacity) { if (!mz_zip_array_ensure_capacity(pZip, pArray, new_capacity, growing)) return MZ_FALSE; }
+  return MZ_TRUE;
+}
+
+static MZ_FORCEINLINE mz_bool mz_zip_array_resize(mz_zip_archive *pZip, mz_zip_array *pArray, size_t new_size, mz_uint growing)
+{
+  if (new_size > pArray->m_capacity) { if (!mz_zip_array_ensure_capacity(pZip, pArray, new_size, growing)) return MZ_FALSE; }
+  pArray->m_size = new_size;
+  return MZ_TRUE;
+}
+
+static MZ_FORCEINLINE mz_bool mz_zip_array_ensure_room(mz_zip_archive *pZip, mz_zip_array *pArray, size_t n)
+{
+  return mz_zip_array_reserve(pZip, pArray, pArray->m_size + n, MZ_TRUE);
+}
+
+static MZ_FORCEINLINE mz_bool mz_zip_array_push_back(mz_zip_archive *pZip, mz_zip_array *pArray, const void *pElements, size_t n)
+{
+  size_t orig_size = pArray->m_size; if (!mz_zip_array_resize(pZip, pArray, orig_size + n, MZ_TRUE)) return MZ_FALSE;
+  memcpy((mz_uint8*)pArray->m_p + orig_size * pArray->m_element_size, pElements, n * pArray->m_element_size);
+  return MZ_TRUE;
+}
+
+#ifndef MINIZ_NO_TIME
+static time_t mz_zip_dos_to_time_t(int dos_time, int dos_date)
+{
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm)); tm.tm_isdst = -1;
+  tm.tm_year = ((dos_date >> 9) & 127) + 1980 - 1900; tm.tm_mon = ((dos_date >> 5) & 15) - 1; tm.tm_mday = dos_date & 31;
+  tm.tm_hour = (dos_time >> 11) & 31; tm.tm_min = (dos_time >> 5) & 63; tm.tm_sec = (dos_time << 1) & 62;
+  return mktime(&tm);
+}
+#endif
+
+static mz_bool mz_zip_reader_init_internal(mz_zip_archive *pZip, mz_uint32 flags)
+{
+  (void)flags;
+  if ((!pZip) || (pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_INVALID))
+    return MZ_FALSE;
+
+  if (!pZip->m_pAlloc) pZip->m_pAlloc = def_alloc_func;
+  if (!pZip->m_pFree) pZip->m_pFree = def_free_func;
+  if (!pZip->m_pRealloc) pZip->m_pRealloc = def_realloc_func;
+
+  pZip->m_zip_mode = MZ_ZIP_MODE_READING;
+  pZip->m_archive_size = 0;
+  pZip->m_central_directory_file_ofs = 0;
+  pZip->m_total_files = 0;
+
+  if (NULL == (pZip->m_pState = (mz_zip_internal_state *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(mz_zip_internal_state))))
+    return MZ_FALSE;
+  memset(pZip->m_pState, 0, sizeof(mz_zip_internal_state));
+  MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir, sizeof(mz_uint8));
+  MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir_offsets, sizeof(mz_uint32));
+  MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_sorted_central_dir_offsets, sizeof(mz_uint32));
+  return MZ_TRUE;
+}
+
+static MZ_FORCEINLINE mz_bool mz_zip_reader_filename_less(const mz_zip_array *pCentral_dir_array, const mz_zip_array *pCentral_dir_offsets, mz_uint l_index, mz_uint r_index)
+{
+  const mz_uint8 *pL = &MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_array, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_offsets, mz_uint32, l_index)), *pE;
+  const mz_uint8 *pR = &MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_array, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_offsets, mz_uint32, r_index));
+  mz_uint l_len = MZ_READ_LE16(pL + MZ_ZIP_CDH_FILENAME_LEN_OFS), r_len = MZ_READ_LE16(pR + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+  mz_uint8 l = 0, r = 0;
+  pL += MZ_ZIP_CENTRAL_DIR_HEADER_SIZE; pR += MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
+  pE = pL + MZ_MIN(l_len, r_len);
+  while (pL < pE)
+  {
+    if ((l = MZ_TOLOWER(*pL)) != (r = MZ_TOLOWER(*pR)))
+      break;
+    pL++; pR++;
+  }
+  return (pL == pE) ? (l_len < r_len) : (l < r);
+}
+
+#define MZ_SWAP_UINT32(a, b) do { mz_uint32 t = a; a = b; b = t; } MZ_MACRO_END
+
+// Heap sort of lowercased filenames, used to help accelerate plain central directory searches by drfs_mz_zip_reader_locate_file(). (Could also use qsort(), but it could allocate memory.)
+static void mz_zip_reader_sort_central_dir_offsets_by_filename(mz_zip_archive *pZip)
+{
+  mz_zip_internal_state *pState = pZip->m_pState;
+  const mz_zip_array *pCentral_dir_offsets = &pState->m_central_dir_offsets;
+  const mz_zip_array *pCentral_dir = &pState->m_central_dir;
+  mz_uint32 *pIndices = &MZ_ZIP_ARRAY_ELEMENT(&pState->m_sorted_central_dir_offsets, mz_uint32, 0);
+  const int size = pZip->m_total_files;
+  int start = (size - 2) >> 1, end;
+  while (start >= 0)
+  {
+    int child, root = start;
+    for ( ; ; )
+    {
+      if ((child = (root << 1) + 1) >= size)
+        break;
+      child += (((child + 1) < size) && (mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[child], pIndices[child + 1])));
+      if (!mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[root], pIndices[child]))
+        break;
+      MZ_SWAP_UINT32(pIndices[root], pIndices[child]); root = child;
+    }
+    start--;
+  }
+
+  end = size - 1;
+  while (end > 0)
+  {
+    int child, root = 0;
+    MZ_SWAP_UINT32(pIndices[end], pIndices[0]);
+    for ( ; ; )
+    {
+      if ((child = (root << 1) + 1) >= end)
+        break;
+      child += (((child + 1) < end) && mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[child], pIndices[child + 1]));
+      if (!mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[root], pIndices[child]))
+        break;
+      MZ_SWAP_UINT32(pIndices[root], pIndices[child]); root = child;
+    }
+    end--;
+  }
+}
+
+static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive *pZip, mz_uint32 flags)
+{
+  mz_uint cdir_size, num_this_disk, cdir_disk_index;
+  mz_uint64 cdir_ofs;
+  mz_int64 cur_file_ofs;
+  const mz_uint8 *p;
+  mz_uint32 buf_u32[4096 / sizeof(mz_uint32)]; mz_uint8 *pBuf = (mz_uint8 *)buf_u32;
+  mz_bool sort_central_dir = ((flags & MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY) == 0);
+  // Basic sanity checks - reject files which are too small, and check the first 4 bytes of the file to make sure a local header is there.
+  if (pZip->m_archive_size < MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
+    return MZ_FALSE;
+  // Find the end of central directory record by scanning the file from the end towards the beginning.
+  cur_file_ofs = MZ_MAX((mz_int64)pZip->m_archive_size - (mz_int64)sizeof(buf_u32), 0);
+  for ( ; ; )
+  {
+    int i, n = (int)MZ_MIN(sizeof(buf_u32), pZip->m_archive_size - cur_file_ofs);
+    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, n) != (mz_uint)n)
+      return MZ_FALSE;
+    for (i = n - 4; i >= 0; --i)
+      if (MZ_READ_LE32(pBuf + i) == MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG)
+        break;
+    if (i >= 0)
+    {
+      cur_file_ofs += i;
+      break;
+    }
+    if ((!cur_file_ofs) || ((pZip->m_archive_size - cur_file_ofs) >= (0xFFFF + MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)))
+      return MZ_FALSE;
+    cur_file_ofs = MZ_MAX(cur_file_ofs - (sizeof(buf_u32) - 3), 0);
+  }
+  // Read and verify the end of central directory record.
+  if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
+    return MZ_FALSE;
+  if ((MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_SIG_OFS) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG) ||
+      ((pZip->m_total_files = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS)) != MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS)))
+    return MZ_FALSE;
+
+  num_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_THIS_DISK_OFS);
+  cdir_disk_index = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS);
+  if (((num_this_disk | cdir_disk_index) != 0) && ((num_this_disk != 1) || (cdir_disk_index != 1)))
+    return MZ_FALSE;
+
+  if ((cdir_size = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_SIZE_OFS)) < pZip->m_total_files * MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)
+    return MZ_FALSE;
+
+  cdir_ofs = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_OFS_OFS);
+  if ((cdir_ofs + (mz_uint64)cdir_size) > pZip->m_archive_size)
+    return MZ_FALSE;
+
+  pZip->m_central_directory_file_ofs = cdir_ofs;
+
+  if (pZip->m_total_files)
+  {
+     mz_uint i, n;
+
+    // Read the entire central directory into a heap block, and allocate another heap block to hold the unsorted central dir file record offsets, and another to hold the sorted indices.
+    if ((!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir, cdir_size, MZ_FALSE)) ||
+        (!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir_offsets, pZip->m_total_files, MZ_FALSE)))
+      return MZ_FALSE;
+
+    if (sort_central_dir)
+    {
+      if (!mz_zip_array_resize(pZip, &pZip->m_pState->m_sorted_central_dir_offsets, pZip->m_total_files, MZ_FALSE))
+        return MZ_FALSE;
+    }
+
+    if (pZip->m_pRead(pZip->m_pIO_opaque, cdir_ofs, pZip->m_pState->m_central_dir.m_p, cdir_size) != cdir_size)
+      return MZ_FALSE;
+
+    // Now create an index into the central directory file records, do some basic sanity checking on each record, and check for zip64 entries (which are not yet supported).
+    p = (const mz_uint8 *)pZip->m_pState->m_central_dir.m_p;
+    for (n = cdir_size, i = 0; i < pZip->m_total_files; ++i)
+    {
+      mz_uint total_header_size, comp_size, decomp_size, disk_index;
+      if ((n < MZ_ZIP_CENTRAL_DIR_HEADER_SIZE) || (MZ_READ_LE32(p) != MZ_ZIP_CENTRAL_DIR_HEADER_SIG))
+        return MZ_FALSE;
+      MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, i) = (mz_uint32)(p - (const mz_uint8 *)pZip->m_pState->m_central_dir.m_p);
+      if (sort_central_dir)
+        MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_sorted_central_dir_offsets, mz_uint32, i) = i;
+      comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
+      decomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+      if (((!MZ_READ_LE32(p + MZ_ZIP_CDH_METHOD_OFS)) && (decomp_size != comp_size)) || (decomp_size && !comp_size) || (decomp_size == 0xFFFFFFFF) || (comp_size == 0xFFFFFFFF))
+        return MZ_FALSE;
+      disk_index = MZ_READ_LE16(p + MZ_ZIP_CDH_DISK_START_OFS);
+      if ((disk_index != num_this_disk) && (disk_index != 1))
+        return MZ_FALSE;
+      if (((mz_uint64)MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS) + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + comp_size) > pZip->m_archive_size)
+        return MZ_FALSE;
+      if ((total_header_size = MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_COMMENT_LEN_OFS)) > n)
+        return MZ_FALSE;
+      n -= total_header_size; p += total_header_size;
+    }
+  }
+
+  if (sort_central_dir)
+    mz_zip_reader_sort_central_dir_offsets_by_filename(pZip);
+
+  return MZ_TRUE;
+}
+
+mz_bool drfs_mz_zip_reader_init(mz_zip_archive *pZip, mz_uint64 size, mz_uint32 flags)
+{
+  if ((!pZip) || (!pZip->m_pRead))
+    return MZ_FALSE;
+  if (!mz_zip_reader_init_internal(pZip, flags))
+    return MZ_FALSE;
+  pZip->m_archive_size = size;
+  if (!mz_zip_reader_read_central_dir(pZip, flags))
+  {
+    drfs_mz_zip_reader_end(pZip);
+    return MZ_FALSE;
+  }
+  return MZ_TRUE;
+}
+
+mz_uint drfs_mz_zip_reader_get_num_files(mz_zip_archive *pZip)
+{
+  return pZip ? pZip->m_total_files : 0;
+}
+
+static MZ_FORCEINLINE const mz_uint8 *mz_zip_reader_get_cdh(mz_zip_archive *pZip, mz_uint file_index)
+{
+  if ((!pZip) || (!pZip->m_pState) || (file_index >= pZip->m_total_files) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
+    return NULL;
+  return &MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, file_index));
+}
+
+mz_bool drfs_mz_zip_reader_is_file_a_directory(mz_zip_archive *pZip, mz_uint file_index)
+{
+  mz_uint filename_len, external_attr;
+  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
+  if (!p)
+    return MZ_FALSE;
+
+  // First see if the filename ends with a '/' character.
+  filename_len = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+  if (filename_len)
+  {
+    if (*(p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + filename_len - 1) == '/')
+      return MZ_TRUE;
+  }
+
+  // Bugfix: This code was also checking if the internal attribute was non-zero, which wasn't correct.
+  // Most/all zip writers (hopefully) set DOS file/directory attributes in the low 16-bits, so check for the DOS directory flag and ignore the source OS ID in the created by field.
+  // FIXME: Remove this check? Is it necessary - we already check the filename.
+  external_attr = MZ_READ_LE32(p + MZ_ZIP_CDH_EXTERNAL_ATTR_OFS);
+  if ((external_attr & 0x10) != 0)
+    return MZ_TRUE;
+
+  return MZ_FALSE;
+}
+
+mz_bool drfs_mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_file_stat *pStat)
+{
+  mz_uint n;
+  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
+  if ((!p) || (!pStat))
+    return MZ_FALSE;
+
+  // Unpack the central directory record.
+  pStat->m_file_index = file_index;
+  pStat->m_central_dir_ofs = MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, file_index);
+  pStat->m_version_made_by = MZ_READ_LE16(p + MZ_ZIP_CDH_VERSION_MADE_BY_OFS);
+  pStat->m_version_needed = MZ_READ_LE16(p + MZ_ZIP_CDH_VERSION_NEEDED_OFS);
+  pStat->m_bit_flag = MZ_READ_LE16(p + MZ_ZIP_CDH_BIT_FLAG_OFS);
+  pStat->m_method = MZ_READ_LE16(p + MZ_ZIP_CDH_METHOD_OFS);
+#ifndef MINIZ_NO_TIME
+  pStat->m_time = mz_zip_dos_to_time_t(MZ_READ_LE16(p + MZ_ZIP_CDH_FILE_TIME_OFS), MZ_READ_LE16(p + MZ_ZIP_CDH_FILE_DATE_OFS));
+#endif
+  pStat->m_crc32 = MZ_READ_LE32(p + MZ_ZIP_CDH_CRC32_OFS);
+  pStat->m_comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
+  pStat->m_uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+  pStat->m_internal_attr = MZ_READ_LE16(p + MZ_ZIP_CDH_INTERNAL_ATTR_OFS);
+  pStat->m_external_attr = MZ_READ_LE32(p + MZ_ZIP_CDH_EXTERNAL_ATTR_OFS);
+  pStat->m_local_header_ofs = MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS);
+
+  // Copy as much of the filename and comment as possible.
+  n = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS); n = MZ_MIN(n, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE - 1);
+  memcpy(pStat->m_filename, p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE, n); pStat->m_filename[n] = '\0';
+
+  n = MZ_READ_LE16(p + MZ_ZIP_CDH_COMMENT_LEN_OFS); n = MZ_MIN(n, MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE - 1);
+  pStat->m_comment_size = n;
+  memcpy(pStat->m_comment, p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS), n); pStat->m_comment[n] = '\0';
+
+  return MZ_TRUE;
+}
+
+mz_uint drfs_mz_zip_reader_get_filename(mz_zip_archive *pZip, mz_uint file_index, char *pFilename, mz_uint filename_buf_size)
+{
+  mz_uint n;
+  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
+  if (!p) { if (filename_buf_size) pFilename[0] = '\0'; return 0; }
+  n = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+  if (filename_buf_size)
+  {
+    n = MZ_MIN(n, filename_buf_size - 1);
+    memcpy(pFilename, p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE, n);
+    pFilename[n] = '\0';
+  }
+  return n + 1;
+}
+
+static MZ_FORCEINLINE mz_bool mz_zip_reader_string_equal(const char *pA, const char *pB, mz_uint len, mz_uint flags)
+{
+  mz_uint i;
+  if (flags & MZ_ZIP_FLAG_CASE_SENSITIVE)
+    return 0 == memcmp(pA, pB, len);
+  for (i = 0; i < len; ++i)
+    if (MZ_TOLOWER(pA[i]) != MZ_TOLOWER(pB[i]))
+      return MZ_FALSE;
+  return MZ_TRUE;
+}
+
+static MZ_FORCEINLINE int mz_zip_reader_filename_compare(const mz_zip_array *pCentral_dir_array, const mz_zip_array *pCentral_dir_offsets, mz_uint l_index, const char *pR, mz_uint r_len)
+{
+  const mz_uint8 *pL = &MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_array, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_offsets, mz_uint32, l_index)), *pE;
+  mz_uint l_len = MZ_READ_LE16(pL + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+  mz_uint8 l = 0, r = 0;
+  pL += MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
+  pE = pL + MZ_MIN(l_len, r_len);
+  while (pL < pE)
+  {
+    if ((l = MZ_TOLOWER(*pL)) != (r = MZ_TOLOWER(*pR)))
+      break;
+    pL++; pR++;
+  }
+  return (pL == pE) ? (int)(l_len - r_len) : (l - r);
+}
+
+static int mz_zip_reader_locate_file_binary_search(mz_zip_archive *pZip, const char *pFilename)
+{
+  mz_zip_internal_state *pState = pZip->m_pState;
+  const mz_zip_array *pCentral_dir_offsets = &pState->m_central_dir_offsets;
+  const mz_zip_array *pCentral_dir = &pState->m_central_dir;
+  mz_uint32 *pIndices = &MZ_ZIP_ARRAY_ELEMENT(&pState->m_sorted_central_dir_offsets, mz_uint32, 0);
+  const int size = pZip->m_total_files;
+  const mz_uint filename_len = (mz_uint)strlen(pFilename);
+  int l = 0, h = size - 1;
+  while (l <= h)
+  {
+    int m = (l + h) >> 1, file_index = pIndices[m], comp = mz_zip_reader_filename_compare(pCentral_dir, pCentral_dir_offsets, file_index, pFilename, filename_len);
+    if (!comp)
+      return file_index;
+    else if (comp < 0)
+      l = m + 1;
+    else
+      h = m - 1;
+  }
+  return -1;
+}
+
+int drfs_mz_zip_reader_locate_file(mz_zip_archive *pZip, const char *pName, const char *pComment, mz_uint flags)
+{
+  mz_uint file_index; size_t name_len, comment_len;
+  if ((!pZip) || (!pZip->m_pState) || (!pName) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
+    return -1;
+  if (((flags & (MZ_ZIP_FLAG_IGNORE_PATH | MZ_ZIP_FLAG_CASE_SENSITIVE)) == 0) && (!pComment) && (pZip->m_pState->m_sorted_central_dir_offsets.m_size))
+    return mz_zip_reader_locate_file_binary_search(pZip, pName);
+  name_len = strlen(pName); if (name_len > 0xFFFF) return -1;
+  comment_len = pComment ? strlen(pComment) : 0; if (comment_len > 0xFFFF) return -1;
+  for (file_index = 0; file_index < pZip->m_total_files; file_index++)
+  {
+    const mz_uint8 *pHeader = &MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, file_index));
+    mz_uint filename_len = MZ_READ_LE16(pHeader + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+    const char *pFilename = (const char *)pHeader + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
+    if (filename_len < name_len)
+      continue;
+    if (comment_len)
+    {
+      mz_uint file_extra_len = MZ_READ_LE16(pHeader + MZ_ZIP_CDH_EXTRA_LEN_OFS), file_comment_len = MZ_READ_LE16(pHeader + MZ_ZIP_CDH_COMMENT_LEN_OFS);
+      const char *pFile_comment = pFilename + filename_len + file_extra_len;
+      if ((file_comment_len != comment_len) || (!mz_zip_reader_string_equal(pComment, pFile_comment, file_comment_len, flags)))
+        continue;
+    }
+    if ((flags & MZ_ZIP_FLAG_IGNORE_PATH) && (filename_len))
+    {
+      int ofs = filename_len - 1;
+      do
+      {
+        if ((pFilename[ofs] == '/') || (pFilename[ofs] == '\\') || (pFilename[ofs] == ':'))
+          break;
+      } while (--ofs >= 0);
+      ofs++;
+      pFilename += ofs; filename_len -= ofs;
+    }
+    if ((filename_len == name_len) && (mz_zip_reader_string_equal(pName, pFilename, filename_len, flags)))
+      return file_index;
+  }
+  return -1;
+}
+
+mz_bool drfs_mz_zip_reader_extract_to_mem_no_alloc(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size)
+{
+  int status = TINFL_STATUS_DONE;
+  mz_uint64 needed_size, cur_file_ofs, comp_remaining, out_buf_ofs = 0, read_buf_size, read_buf_ofs = 0, read_buf_avail;
+  mz_zip_archive_file_stat file_stat;
+  void *pRead_buf;
+  mz_uint32 local_header_u32[(MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)]; mz_uint8 *pLocal_header = (mz_uint8 *)local_header_u32;
+  tinfl_decompressor inflator;
+
+  if ((buf_size) && (!pBuf))
+    return MZ_FALSE;
+
+  if (!drfs_mz_zip_reader_file_stat(pZip, file_index, &file_stat))
+    return MZ_FALSE;
+
+  // Empty file, or a directory (but not always a directory - I've seen odd zips with directories that have compressed data which inflates to 0 bytes)
+  if (!file_stat.m_comp_size)
+    return MZ_TRUE;
+
+  // Entry is a subdirectory (I've seen old zips with dir entries which have compressed deflate data which inflates to 0 bytes, but these entries claim to uncompress to 512 bytes in the headers).
+  // I'm torn how to handle this case - should it fail instead?
+  if (drfs_mz_zip_reader_is_file_a_directory(pZip, file_index))
+    return MZ_TRUE;
+
+  // Encryption and patch files are not supported.
+  if (file_stat.m_bit_flag & (1 | 32))
+    return MZ_FALSE;
+
+  // This function only supports stored and deflate.
+  if ((!(flags & MZ_ZIP_FLAG_COMPRESSED_DATA)) && (file_stat.m_method != 0) && (file_stat.m_method != MZ_DEFLATED))
+    return MZ_FALSE;
+
+  // Ensure supplied output buffer is large enough.
+  needed_size = (flags & MZ_ZIP_FLAG_COMPRESSED_DATA) ? file_stat.m_comp_size : file_stat.m_uncomp_size;
+  if (buf_size < needed_size)
+    return MZ_FALSE;
+
+  // Read and parse the local directory entry.
+  cur_file_ofs = file_stat.m_local_header_ofs;
+  if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pLocal_header, MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
+    return MZ_FALSE;
+  if (MZ_READ_LE32(pLocal_header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+    return MZ_FALSE;
+
+  cur_file_ofs += MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+  if ((cur_file_ofs + file_stat.m_comp_size) > pZip->m_archive_size)
+    return MZ_FALSE;
+
+  if ((flags & MZ_ZIP_FLAG_COMPRESSED_DATA) || (!file_stat.m_method))
+  {
+    // The file is stored or the caller has requested the compressed data.
+    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, (size_t)needed_size) != needed_size)
+      return MZ_FALSE;
+    return ((flags & MZ_ZIP_FLAG_COMPRESSED_DATA) != 0) || (drfs_mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)pBuf, (size_t)file_stat.m_uncomp_size) == file_stat.m_crc32);
+  }
+
+  // Decompress the file either directly from memory or from a file input buffer.
+  tinfl_init(&inflator);
+
+  if (pZip->m_pState->m_pMem)
+  {
+    // Read directly from the archive in memory.
+    pRead_buf = (mz_uint8 *)pZip->m_pState->m_pMem + cur_file_ofs;
+    read_buf_size = read_buf_avail = file_stat.m_comp_size;
+    comp_remaining = 0;
+  }
+  else if (pUser_read_buf)
+  {
+    // Use a user provided read buffer.
+    if (!user_read_buf_size)
+      return MZ_FALSE;
+    pRead_buf = (mz_uint8 *)pUser_read_buf;
+    read_buf_size = user_read_buf_size;
+    read_buf_avail = 0;
+    comp_remaining = file_stat.m_comp_size;
+  }
+  else
+  {
+    // Temporarily allocate a read buffer.
+    read_buf_size = MZ_MIN(file_stat.m_comp_size, MZ_ZIP_MAX_IO_BUF_SIZE);
+#ifdef _MSC_VER
+    if (((0, sizeof(size_t) == sizeof(mz_uint32))) && (read_buf_size > 0x7FFFFFFF))
+#else
+    if (((sizeof(size_t) == sizeof(mz_uint32))) && (read_buf_size > 0x7FFFFFFF))
+#endif
+      return MZ_FALSE;
+    if (NULL == (pRead_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)read_buf_size)))
+      return MZ_FALSE;
+    read_buf_avail = 0;
+    comp_remaining = file_stat.m_comp_size;
+  }
+
+  do
+  {
+    size_t in_buf_size, out_buf_size = (size_t)(file_stat.m_uncomp_size - out_buf_ofs);
+    if ((!read_buf_avail) && (!pZip->m_pState->m_pMem))
+    {
+      read_buf_avail = MZ_MIN(read_buf_size, comp_remaining);
+      if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pRead_buf, (size_t)read_buf_avail) != read_buf_avail)
+      {
+        status = TINFL_STATUS_FAILED;
+        break;
+      }
+      cur_file_ofs += read_buf_avail;
+      comp_remaining -= read_buf_avail;
+      read_buf_ofs = 0;
+    }
+    in_buf_size = (size_t)read_buf_avail;
+    status = drfs_tinfl_decompress(&inflator, (mz_uint8 *)pRead_buf + read_buf_ofs, &in_buf_size, (mz_uint8 *)pBuf, (mz_uint8 *)pBuf + out_buf_ofs, &out_buf_size, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF | (comp_remaining ? TINFL_FLAG_HAS_MORE_INPUT : 0));
+    read_buf_avail -= in_buf_size;
+    read_buf_ofs += in_buf_size;
+    out_buf_ofs += out_buf_size;
+  } while (status == TINFL_STATUS_NEEDS_MORE_INPUT);
+
+  if (status == TINFL_STATUS_DONE)
+  {
+    // Make sure the entire file was decompressed, and check its CRC.
+    if ((out_buf_ofs != file_stat.m_uncomp_size) || (drfs_mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)pBuf, (size_t)file_stat.m_uncomp_size) != file_stat.m_crc32))
+      status = TINFL_STATUS_FAILED;
+  }
+
+  if ((!pZip->m_pState->m_pMem) && (!pUser_read_buf))
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
+
+  return status == TINFL_STATUS_DONE;
+}
+
+mz_bool drfs_mz_zip_reader_extract_file_to_mem_no_alloc(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size)
+{
+  int file_index = drfs_mz_zip_reader_locate_file(pZip, pFilename, NULL, flags);
+  if (file_index < 0)
+    return MZ_FALSE;
+  return drfs_mz_zip_reader_extract_to_mem_no_alloc(pZip, file_index, pBuf, buf_size, flags, pUser_read_buf, user_read_buf_size);
+}
+
+mz_bool drfs_mz_zip_reader_extract_to_mem(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags)
+{
+  return drfs_mz_zip_reader_extract_to_mem_no_alloc(pZip, file_index, pBuf, buf_size, flags, NULL, 0);
+}
+
+mz_bool drfs_mz_zip_reader_extract_file_to_mem(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags)
+{
+  return drfs_mz_zip_reader_extract_file_to_mem_no_alloc(pZip, pFilename, pBuf, buf_size, flags, NULL, 0);
+}
+
+void *drfs_mz_zip_reader_extract_to_heap(mz_zip_archive *pZip, mz_uint file_index, size_t *pSize, mz_uint flags)
+{
+  mz_uint64 comp_size, uncomp_size, alloc_size;
+  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
+  void *pBuf;
+
+  if (pSize)
+    *pSize = 0;
+  if (!p)
+    return NULL;
+
+  comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
+  uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+
+  alloc_size = (flags & MZ_ZIP_FLAG_COMPRESSED_DATA) ? comp_size : uncomp_size;
+#ifdef _MSC_VER
+  if (((0, sizeof(size_t) == sizeof(mz_uint32))) && (alloc_size > 0x7FFFFFFF))
+#else
+  if (((sizeof(size_t) == sizeof(mz_uint32))) && (alloc_size > 0x7FFFFFFF))
+#endif
+    return NULL;
+  if (NULL == (pBuf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)alloc_size)))
+    return NULL;
+
+  if (!drfs_mz_zip_reader_extract_to_mem(pZip, file_index, pBuf, (size_t)alloc_size, flags))
+  {
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pBuf);
+    return NULL;
+  }
+
+  if (pSize) *pSize = (size_t)alloc_size;
+  return pBuf;
+}
+
+mz_bool drfs_mz_zip_reader_end(mz_zip_archive *pZip)
+{
+  if ((!pZip) || (!pZip->m_pState) || (!pZip->m_pAlloc) || (!pZip->m_pFree) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
+    return MZ_FALSE;
+
+  if (pZip->m_pState)
+  {
+    mz_zip_internal_state *pState = pZip->m_pState; pZip->m_pState = NULL;
+    mz_zip_array_clear(pZip, &pState->m_central_dir);
+    mz_zip_array_clear(pZip, &pState->m_central_dir_offsets);
+    mz_zip_array_clear(pZip, &pState->m_sorted_central_dir_offsets);
+
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pState);
+  }
+  pZip->m_zip_mode = MZ_ZIP_MODE_INVALID;
+
+  return MZ_TRUE;
+}
+
+#endif // #ifndef MINIZ_NO_ARCHIVE_APIS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MINIZ_HEADER_FILE_ONLY
+
+#if defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+
+
+
+// The value of drfs_zip_listing_entry::fileIndex for directories that don't have an entry of their own.
+#define DRFS_ZIP_IMPLIED_DIRECTORY  0xFFFFFFFF
+
+// Zip files are a flat list of paths, and most tools don't write entries for directories, so directories have to be
+// implied from the paths of the files inside them. To make iteration fast, every file and directory in the archive is put
+// in a list that's sorted by the directory it's in when the archive is opened. The children of a directory are then a
+// contiguous range of the list.
+typedef struct
+{
+    // The path of the entry in the central directory that this was found in. The entry's own path is the first pathLength
+    // characters of this, and the path of the directory it's in is the first parentLength characters.
+    const char* pPath;
+    unsigned short pathLength;
+    unsigned short parentLength;
+
+    // The index of the entry in the central directory, or DRFS_ZIP_IMPLIED_DIRECTORY.
+    mz_uint fileIndex;
+
+}drfs_zip_listing_entry;
+
+typedef struct
+{
+    // The current index of the iterator within the listing, and the index one past the last child of the directory.
+    size_t index;
+    size_t endIndex;
+
+}drfs_iterator_zip;
+
+typedef struct
+{
+    // The file index within the archive.
+    mz_uint index;
+
+    // A pointer to the buffer containing the entire uncompressed data of the file. Unfortunately this is the only way I'm aware of for
+    // reading file data from miniz.c so we'll just stick with it for now. We use a pointer to an 8-bit type so we can easily calculate
+    // offsets.
+    mz_uint8* pData;
+
+    // The size of the file in bytes so we can guard against overflowing reads.
+    size_t sizeInBytes;
+
+    // The current position of the file's read pointer.
+    size_t readPointer;
+
+}drfs_openedfile_zip;
+
+typedef struct
+{
+    // The miniz archive. This must be the first member because the handle is passed straight to miniz.
+    mz_zip_archive zip;
+
+    // The pool that drfs_openedfile_zip objects are allocated from.
+    drfs_pool openedFilePool;
+
+    // The listing of every file and directory, sorted by the directory they're in. pListingPaths holds the path of each
+    // entry in the central directory, which the listing entries point into.
+    drfs_zip_listing_entry* pListing;
+    size_t listingCount;
+    char* pListingPaths;
+
+}drfs_archive_zip;
+
+static size_t drfs_mz_file_read_func(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n)
+{
+    // The opaque type is a pointer to a drfs_file object which represents the file of the archive.
+    drfs_file* pZipFile = pOpaque;
+    assert(pZipFile != NULL);
+
+    if (!drfs_lock(pZipFile)) {
+        return 0;
+    }
+
+    drfs_seek_nolock(pZipFile, (int64_t)file_ofs, drfs_origin_start);
+
+    size_t bytesRead;
+    drfs_result result = drfs_read_nolock(pZipFile, pBuf, (unsigned int)n, &bytesRead);
+    if (result != drfs_success) {
+        // Failed to read the file.
+        bytesRead = 0;
+    }
+
+    drfs_unlock(pZipFile);
+    return (size_t)bytesRead;
+}
+
+
+static int drfs_zip_compare_path_prefixes(const char* path1, size_t length1, const char* path2, size_t length2)
+{
+    int result = memcmp(path1, path2, (length1 < length2) ? length1 : length2);
+    if (result != 0) {
+        return result;
+    }
+
+    return (length1 < length2) ? -1 : (length1 > length2) ? 1 : 0;
+}
+
+// Sorts by the directory, then by the path, with the real entry for a directory before any implied ones.
+static int drfs_zip_listing_compare(const void* a, const void* b)
+{
+    const drfs_zip_listing_entry* pEntry1 = a;
+    const drfs_zip_listing_entry* pEntry2 = b;
+
+    int result = drfs_zip_compare_path_prefixes(pEntry1->pPath, pEntry1->parentLength, pEntry2->pPath, pEntry2->parentLength);
+    if (result != 0) {
+        return result;
+    }
+
+    result = drfs_zip_compare_path_prefixes(pEntry1->pPath, pEntry1->pathLength, pEntry2->pPath, pEntry2->pathLength);
+    if (result != 0) {
+        return result;
+    }
+
+    return (pEntry1->fileIndex == DRFS_ZIP_IMPLIED_DIRECTORY) - (pEntry2->fileIndex == DRFS_ZIP_IMPLIED_DIRECTORY);
+}
+
+// Builds the listing of every file and directory in the archive. Each path in the central directory adds an entry for
+// itself and one for every directory above it. The duplicates this makes are skipped during iteration.
+static bool drfs_zip_build_listing(drfs_archive_zip* pZipArchive)
+{
+    assert(pZipArchive != NULL);
+
+    mz_zip_archive* pZip = &pZipArchive->zip;
+    mz_uint fileCount = drfs_mz_zip_reader_get_num_files(pZip);
+
+    size_t pathsSize = 0;
+    for (mz_uint iFile = 0; iFile < fileCount; ++iFile) {
+        pathsSize += drfs_mz_zip_reader_get_filename(pZip, iFile, NULL, 0);
+    }
+
+    size_t listingCapacity = fileCount;
+    pZipArchive->pListingPaths = DRFS_MALLOC(pathsSize + 1);
+    pZipArchive->pListing      = DRFS_MALLOC((listingCapacity + 1) * sizeof(*pZipArchive->pListing));
+    pZipArchive->listingCount  = 0;
+    if (pZipArchive->pListingPaths == NULL || pZipArchive->pListing == NULL) {
+        return false;
+    }
+
+    size_t pathsOffset = 0;
+    for (mz_uint iFile = 0; iFile < fileCount; ++iFile)
+    {
+        char* pPath = pZipArchive->pListingPaths + pathsOffset;
+        mz_uint pathSize = drfs_mz_zip_reader_get_filename(pZip, iFile, pPath, (mz_uint)(pathsSize + 1 - pathsOffset));
+        if (pathSize == 0) {
+            continue;
+        }
+
+        pathsOffset += pathSize;
+
+        // Paths longer than this can't be opened anyway.
+        if (pathSize > DRFS_MAX_PATH) {
+            continue;
+        }
+
+        drfs_drpath_iterator iSegment;
+        if (!drfs_drpath_first(pPath, &iSegment)) {
+            continue;
         }
-#endif
-        do
-        {
-          pOut_buf_cur[0] = pSrc[0];
-          pOut_buf_cur[1] = pSrc[1];
-          pOut_buf_cur[2] = pSrc[2];
-          pOut_buf_cur += 3; pSrc += 3;
-        } while ((int)(counter -= 3) > 2);
-        if ((int)counter > 0)
+
+        unsigned short parentLength = 0;
+        for (;;)
         {
-          pOut_buf_cur[0] = pSrc[0];
-          if ((int)counter > 1)
-            pOut_buf_cur[1] = pSrc[1];
-          pOut_buf_cur += counter;
+            if (pZipArchive->listingCount == listingCapacity) {
+                listingCapacity *= 2;
+                drfs_zip_listing_entry* pNewListing = DRFS_REALLOC(pZipArchive->pListing, listingCapacity * sizeof(*pNewListing));
+                if (pNewListing == NULL) {
+                    return false;
+                }
+
+                pZipArchive->pListing = pNewListing;
+            }
+
+            drfs_zip_listing_entry* pEntry = pZipArchive->pListing + pZipArchive->listingCount;
+            pEntry->pPath        = pPath;
+            pEntry->pathLength   = (unsigned short)(iSegment.segment.offset + iSegment.segment.length);
+            pEntry->parentLength = parentLength;
+            pZipArchive->listingCount += 1;
+
+            parentLength = pEntry->pathLength;
+            if (!drfs_drpath_next(&iSegment)) {
+                pEntry->fileIndex = iFile;
+                break;
+            }
+
+            pEntry->fileIndex = DRFS_ZIP_IMPLIED_DIRECTORY;
         }
-      }
     }
-  } while (!(r->m_final & 1));
-  if (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER)
-  {
-    TINFL_SKIP_BITS(32, num_bits & 7); for (counter = 0; counter < 4; ++counter) { mz_uint s; if (num_bits) TINFL_GET_BITS(41, s, 8); else TINFL_GET_BYTE(42, s); r->m_z_adler32 = (r->m_z_adler32 << 8) | s; }
-  }
-  TINFL_CR_RETURN_FOREVER(34, TINFL_STATUS_DONE);
-  TINFL_CR_FINISH
 
-common_exit:
-  r->m_num_bits = num_bits; r->m_bit_buf = bit_buf; r->m_dist = dist; r->m_counter = counter; r->m_num_extra = num_extra; r->m_dist_from_out_buf_start = dist_from_out_buf_start;
-  *pIn_buf_size = pIn_buf_cur - pIn_buf_next; *pOut_buf_size = pOut_buf_cur - pOut_buf_next;
-  if ((decomp_flags & (TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32)) && (status >= 0))
-  {
-    const mz_uint8 *ptr = pOut_buf_next; size_t buf_len = *pOut_buf_size;
-    mz_uint32 i, s1 = r->m_check_adler32 & 0xffff, s2 = r->m_check_adler32 >> 16; size_t block_len = buf_len % 5552;
-    while (buf_len)
-    {
-      for (i = 0; i + 7 < block_len; i += 8, ptr += 8)
-      {
-        s1 += ptr[0], s2 += s1; s1 += ptr[1], s2 += s1; s1 += ptr[2], s2 += s1; s1 += ptr[3], s2 += s1;
-        s1 += ptr[4], s2 += s1; s1 += ptr[5], s2 += s1; s1 += ptr[6], s2 += s1; s1 += ptr[7], s2 += s1;
-      }
-      for ( ; i < block_len; ++i) s1 += *ptr++, s2 += s1;
-      s1 %= 65521U, s2 %= 65521U; buf_len -= block_len; block_len = 5552;
-    }
-    r->m_check_adler32 = (s2 << 16) + s1; if ((status == TINFL_STATUS_DONE) && (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) && (r->m_check_adler32 != r->m_z_adler32)) status = TINFL_STATUS_ADLER32_MISMATCH;
-  }
-  return status;
+    qsort(pZipArchive->pListing, pZipArchive->listingCount, sizeof(*pZipArchive->pListing), drfs_zip_listing_compare);
+    return true;
 }
 
-// Higher level helper functions.
-void *drfs_tinfl_decompress_mem_to_heap(const void *pSrc_buf, size_t src_buf_len, size_t *pOut_len, int flags)
+// Finds the range of the listing that holds the children of the given directory. Returns false if it has no children.
+static bool drfs_zip_find_children(drfs_archive_zip* pZipArchive, const char* directoryPath, size_t* pBeginIndexOut, size_t* pEndIndexOut)
 {
-  tinfl_decompressor decomp; void *pBuf = NULL, *pNew_buf; size_t src_buf_ofs = 0, out_buf_capacity = 0;
-  *pOut_len = 0;
-  tinfl_init(&decomp);
-  for ( ; ; )
-  {
-    size_t src_buf_size = src_buf_len - src_buf_ofs, dst_buf_size = out_buf_capacity - *pOut_len, new_out_buf_capacity;
-    tinfl_status status = drfs_tinfl_decompress(&decomp, (const mz_uint8*)pSrc_buf + src_buf_ofs, &src_buf_size, (mz_uint8*)pBuf, pBuf ? (mz_uint8*)pBuf + *pOut_len : NULL, &dst_buf_size,
-      (flags & ~TINFL_FLAG_HAS_MORE_INPUT) | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
-    if ((status < 0) || (status == TINFL_STATUS_NEEDS_MORE_INPUT))
-    {
-      MZ_FREE(pBuf); *pOut_len = 0; return NULL;
+    assert(pZipArchive != NULL);
+    assert(directoryPath != NULL);
+
+    size_t directoryPathLength = strlen(directoryPath);
+    while (directoryPathLength > 0 && (directoryPath[directoryPathLength - 1] == '/' || directoryPath[directoryPathLength - 1] == '\\')) {
+        directoryPathLength -= 1;
     }
-    src_buf_ofs += src_buf_size;
-    *pOut_len += dst_buf_size;
-    if (status == TINFL_STATUS_DONE) break;
-    new_out_buf_capacity = out_buf_capacity * 2; if (new_out_buf_capacity < 128) new_out_buf_capacity = 128;
-    pNew_buf = MZ_REALLOC(pBuf, new_out_buf_capacity);
-    if (!pNew_buf)
-    {
-      MZ_FREE(pBuf); *pOut_len = 0; return NULL;
+
+    // Binary search for the first child, and then the first entry after the last child.
+    size_t lo = 0;
+    size_t hi = pZipArchive->listingCount;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo)/2;
+        const drfs_zip_listing_entry* pEntry = pZipArchive->pListing + mid;
+        if (drfs_zip_compare_path_prefixes(pEntry->pPath, pEntry->parentLength, directoryPath, directoryPathLength) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
-    pBuf = pNew_buf; out_buf_capacity = new_out_buf_capacity;
-  }
-  return pBuf;
+
+    size_t beginIndex = lo;
+
+    hi = pZipArchive->listingCount;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo)/2;
+        const drfs_zip_listing_entry* pEntry = pZipArchive->pListing + mid;
+        if (drfs_zip_compare_path_prefixes(pEntry->pPath, pEntry->parentLength, directoryPath, directoryPathLength) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *pBeginIndexOut = beginIndex;
+    *pEndIndexOut   = lo;
+    return lo > beginIndex;
 }
 
-size_t drfs_tinfl_decompress_mem_to_mem(void *pOut_buf, size_t out_buf_len, const void *pSrc_buf, size_t src_buf_len, int flags)
+static bool drfs_is_valid_extension__zip(const char* extension)
 {
-  tinfl_decompressor decomp; tinfl_status status; tinfl_init(&decomp);
-  status = drfs_tinfl_decompress(&decomp, (const mz_uint8*)pSrc_buf, &src_buf_len, (mz_uint8*)pOut_buf, (mz_uint8*)pOut_buf, &out_buf_len, (flags & ~TINFL_FLAG_HAS_MORE_INPUT) | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
-  return (status != TINFL_STATUS_DONE) ? TINFL_DECOMPRESS_MEM_TO_MEM_FAILED : out_buf_len;
+    return drfs__stricmp(extension, "zip") == 0;
 }
 
-int drfs_tinfl_decompress_mem_to_callback(const void *pIn_buf, size_t *pIn_buf_size, tinfl_put_buf_func_ptr pPut_buf_func, void *pPut_buf_user, int flags)
+static drfs_result drfs_open_archive__zip(drfs_file* pArchiveFile, unsigned int accessMode, drfs_handle* pHandleOut)
 {
-  int result = 0;
-  tinfl_decompressor decomp;
-  mz_uint8 *pDict = (mz_uint8*)MZ_MALLOC(TINFL_LZ_DICT_SIZE); size_t in_buf_ofs = 0, dict_ofs = 0;
-  if (!pDict)
-    return TINFL_STATUS_FAILED;
-  tinfl_init(&decomp);
-  for ( ; ; )
-  {
-    size_t in_buf_size = *pIn_buf_size - in_buf_ofs, dst_buf_size = TINFL_LZ_DICT_SIZE - dict_ofs;
-    tinfl_status status = drfs_tinfl_decompress(&decomp, (const mz_uint8*)pIn_buf + in_buf_ofs, &in_buf_size, pDict, pDict + dict_ofs, &dst_buf_size,
-      (flags & ~(TINFL_FLAG_HAS_MORE_INPUT | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)));
-    in_buf_ofs += in_buf_size;
-    if ((dst_buf_size) && (!(*pPut_buf_func)(pDict + dict_ofs, (int)dst_buf_size, pPut_buf_user)))
-      break;
-    if (status != TINFL_STATUS_HAS_MORE_OUTPUT)
-    {
-      result = (status == TINFL_STATUS_DONE);
-      break;
+    assert(pArchiveFile != NULL);
+    assert(pHandleOut != NULL);
+    assert(drfs_tell(pArchiveFile) == 0);
+
+    *pHandleOut = NULL;
+
+    // Only support read-only mode at the moment.
+    if ((accessMode & DRFS_WRITE) != 0) {
+        return drfs_permission_denied;
     }
-    dict_ofs = (dict_ofs + dst_buf_size) & (TINFL_LZ_DICT_SIZE - 1);
-  }
-  MZ_FREE(pDict);
-  *pIn_buf_size = in_buf_ofs;
-  return result;
-}
 
 
-// ------------------- .ZIP archive reading
+    drfs_archive_zip* pZipArchive = DRFS_MALLOC(sizeof(*pZipArchive));
+    if (pZipArchive == NULL) {
+        return drfs_out_of_memory;
+    }
 
-#ifndef MINIZ_NO_ARCHIVE_APIS
+    mz_zip_archive* pZip = &pZipArchive->zip;
+    memset(pZip, 0, sizeof(mz_zip_archive));
 
-#define MZ_TOLOWER(c) ((((c) >= 'A') && ((c) <= 'Z')) ? ((c) - 'A' + 'a') : (c))
+    pZip->m_pRead = drfs_mz_file_read_func;
+    pZip->m_pIO_opaque = pArchiveFile;
+    if (!drfs_mz_zip_reader_init(pZip, drfs_size(pArchiveFile), 0)) {
+        DRFS_FREE(pZipArchive);
+        return drfs_invalid_archive;
+    }
 
-// Various ZIP archive enums. To completely avoid cross platform compiler alignment and platform endian issues, miniz.c doesn't use structs for any of this stuff.
-enum
-{
-  // ZIP archive identifiers and record sizes
-  MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG = 0x06054b50, MZ_ZIP_CENTRAL_DIR_HEADER_SIG = 0x02014b50, MZ_ZIP_LOCAL_DIR_HEADER_SIG = 0x04034b50,
-  MZ_ZIP_LOCAL_DIR_HEADER_SIZE = 30, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE = 46, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE = 22,
-  // Central directory header record offsets
-  MZ_ZIP_CDH_SIG_OFS = 0, MZ_ZIP_CDH_VERSION_MADE_BY_OFS = 4, MZ_ZIP_CDH_VERSION_NEEDED_OFS = 6, MZ_ZIP_CDH_BIT_FLAG_OFS = 8,
-  MZ_ZIP_CDH_METHOD_OFS = 10, MZ_ZIP_CDH_FILE_TIME_OFS = 12, MZ_ZIP_CDH_FILE_DATE_OFS = 14, MZ_ZIP_CDH_CRC32_OFS = 16,
-  MZ_ZIP_CDH_COMPRESSED_SIZE_OFS = 20, MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS = 24, MZ_ZIP_CDH_FILENAME_LEN_OFS = 28, MZ_ZIP_CDH_EXTRA_LEN_OFS = 30,
-  MZ_ZIP_CDH_COMMENT_LEN_OFS = 32, MZ_ZIP_CDH_DISK_START_OFS = 34, MZ_ZIP_CDH_INTERNAL_ATTR_OFS = 36, MZ_ZIP_CDH_EXTERNAL_ATTR_OFS = 38, MZ_ZIP_CDH_LOCAL_HEADER_OFS = 42,
-  // Local directory header offsets
-  MZ_ZIP_LDH_SIG_OFS = 0, MZ_ZIP_LDH_VERSION_NEEDED_OFS = 4, MZ_ZIP_LDH_BIT_FLAG_OFS = 6, MZ_ZIP_LDH_METHOD_OFS = 8, MZ_ZIP_LDH_FILE_TIME_OFS = 10,
-  MZ_ZIP_LDH_FILE_DATE_OFS = 12, MZ_ZIP_LDH_CRC32_OFS = 14, MZ_ZIP_LDH_COMPRESSED_SIZE_OFS = 18, MZ_ZIP_LDH_DECOMPRESSED_SIZE_OFS = 22,
-  MZ_ZIP_LDH_FILENAME_LEN_OFS = 26, MZ_ZIP_LDH_EXTRA_LEN_OFS = 28,
-  // End of central directory offsets
-  MZ_ZIP_ECDH_SIG_OFS = 0, MZ_ZIP_ECDH_NUM_THIS_DISK_OFS = 4, MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS = 6, MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS = 8,
-  MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS = 10, MZ_ZIP_ECDH_CDIR_SIZE_OFS = 12, MZ_ZIP_ECDH_CDIR_OFS_OFS = 16, MZ_ZIP_ECDH_COMMENT_SIZE_OFS = 20,
-};
+    drfs_pool_init(&pZipArchive->openedFilePool, sizeof(drfs_openedfile_zip), 32);
 
-typedef struct
-{
-  void *m_p;
-  size_t m_size, m_capacity;
-  mz_uint m_element_size;
-} mz_zip_array;
+    if (!drfs_zip_build_listing(pZipArchive)) {
+        drfs_mz_zip_reader_end(pZip);
+        drfs_pool_uninit(&pZipArchive->openedFilePool, NULL);
+        DRFS_FREE(pZipArchive->pListing);
+        DRFS_FREE(pZipArchive->pListingPaths);
+        DRFS_FREE(pZipArchive);
+        return drfs_out_of_memory;
+    }
 
-struct mz_zip_internal_state_tag
+    *pHandleOut = pZipArchive;
+    return drfs_success;
+}
+
+static void drfs_close_archive__zip(drfs_handle archive)
 {
-  mz_zip_array m_central_dir;
-  mz_zip_array m_central_dir_offsets;
-  mz_zip_array m_sorted_central_dir_offsets;
-  void* *m_pFile;
-  void *m_pMem;
-  size_t m_mem_size;
-  size_t m_mem_capacity;
-};
+    drfs_archive_zip* pZipArchive = archive;
+    assert(pZipArchive != NULL);
 
-#define MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(array_ptr, element_size) (array_ptr)->m_element_size = element_size
-#define MZ_ZIP_ARRAY_ELEMENT(array_ptr, element_type, index) ((element_type *)((array_ptr)->m_p))[index]
+    drfs_mz_zip_reader_end(&pZipArchive->zip);
+    drfs_pool_uninit(&pZipArchive->openedFilePool, NULL);
+    DRFS_FREE(pZipArchive->pListing);
+    DRFS_FREE(pZipArchive->pListingPaths);
+    DRFS_FREE(pZipArchive);
+}
 
-static MZ_FORCEINLINE void mz_zip_array_clear(mz_zip_archive *pZip, mz_zip_array *pArray)
+static drfs_result drfs_get_file_info__zip(drfs_handle archive, const char* relativePath, drfs_file_info* fi)
 {
-  pZip->m_pFree(pZip->m_pAlloc_opaque, pArray->m_p);
-  memset(pArray, 0, sizeof(mz_zip_array));
+    assert(archive != NULL);
+
+    mz_zip_archive* pZip = archive;
+    int fileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
+    if (fileIndex == -1)
+    {
+        // We failed to locate the file, but there's a chance it could actually be a folder. Here's the problem - folders
+        // can be named such that they include a trailing slash. We'll want to check for that. Another problem is that
+        // sometimes the folders won't actually be included in the central directory at all which means we need to do a
+        // manual check across every file in the archive.
+        char relativePathWithSlash[DRFS_MAX_PATH];
+        drfs__strcpy_s(relativePathWithSlash, sizeof(relativePathWithSlash), relativePath);
+        drfs__strcat_s(relativePathWithSlash, sizeof(relativePathWithSlash), "/");
+        fileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePathWithSlash, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
+        if (fileIndex == -1)
+        {
+            // We still couldn't find the directory even with the trailing slash. There's a chace it's a folder that's
+            // simply not included in the central directory. It's appears the "Send to -> Compressed (zipped) folder"
+            // functionality in Windows does this. If anything in the listing is inside it, it's a folder.
+            size_t beginIndex;
+            size_t endIndex;
+            if (!drfs_zip_find_children(archive, relativePath, &beginIndex, &endIndex)) {
+                return drfs_does_not_exist;
+            }
+
+            if (fi != NULL) {
+                drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), relativePath);
+                fi->sizeInBytes      = 0;
+                fi->lastModifiedTime = 0;
+                fi->attributes       = DRFS_FILE_ATTRIBUTE_READONLY | DRFS_FILE_ATTRIBUTE_DIRECTORY;
+            }
+
+            return drfs_success;
+        }
+    }
+
+    assert(fileIndex != -1);
+
+    if (fi != NULL)
+    {
+        mz_zip_archive_file_stat zipStat;
+        if (drfs_mz_zip_reader_file_stat(pZip, (mz_uint)fileIndex, &zipStat))
+        {
+            drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), relativePath);
+            fi->sizeInBytes      = zipStat.m_uncomp_size;
+            fi->lastModifiedTime = (uint64_t)zipStat.m_time;
+            fi->attributes       = DRFS_FILE_ATTRIBUTE_READONLY;
+            if (drfs_mz_zip_reader_is_file_a_directory(pZip, (mz_uint)fileIndex)) {
+                fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
+            }
+
+            return drfs_success;
+        }
+    }
+
+    return drfs_success;
 }
 
-static mz_bool mz_zip_array_ensure_capacity(mz_zip_archive *pZip, mz_zip_array *pArray, size_t min_new_capacity, mz_uint growing)
+static drfs_handle drfs_begin_iteration__zip(drfs_handle archive, const char* relativePath)
 {
-  void *pNew_p; size_t new_capacity = min_new_capacity; MZ_ASSERT(pArray->m_element_size); if (pArray->m_capacity >= min_new_capacity) return MZ_TRUE;
-  if (growing) { new_capacity = MZ_MAX(1, pArray->m_capacity); while (new_capacity < min_new_capacity) new_capacity *= 2; }
-  if (NULL == (pNew_p = pZip->m_pRealloc(pZip->m_pAlloc_opaque, pArray->m_p, pArray->m_element_size, new_capacity))) return MZ_FALSE;
-  pArray->m_p = pNew_p; pArray->m_capacity = new_capacity;
-  return MZ_TRUE;
+    assert(relativePath != NULL);
+
+    drfs_archive_zip* pZipArchive = archive;
+    assert(pZipArchive != NULL);
+
+    size_t beginIndex;
+    size_t endIndex;
+    bool hasChildren = drfs_zip_find_children(pZipArchive, relativePath, &beginIndex, &endIndex);
+
+    // A directory without anything in it only exists if it has an entry of it's own, which might have a trailing slash.
+    if (!hasChildren && relativePath[0] != '\0')
+    {
+        if (drfs_mz_zip_reader_locate_file(&pZipArchive->zip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE) == -1)
+        {
+            char relativePathWithSlash[DRFS_MAX_PATH];
+            drfs__strcpy_s(relativePathWithSlash, sizeof(relativePathWithSlash), relativePath);
+            drfs__strcat_s(relativePathWithSlash, sizeof(relativePathWithSlash), "/");
+            if (drfs_mz_zip_reader_locate_file(&pZipArchive->zip, relativePathWithSlash, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE) == -1) {
+                return NULL;
+            }
+        }
+    }
+
+    drfs_iterator_zip* pZipIterator = DRFS_MALLOC(sizeof(drfs_iterator_zip));
+    if (pZipIterator != NULL)
+    {
+        pZipIterator->index    = beginIndex;
+        pZipIterator->endIndex = endIndex;
+    }
+
+    return pZipIterator;
 }
 
-static MZ_FORCEINLINE mz_bool mz_zip_array_reserve(mz_zip_archive *pZip, mz_zip_array *pArray, size_t new_capacity, mz_uint growing)
+static void drfs_end_iteration__zip(drfs_handle archive, drfs_handle iterator)
 {
-  if (new_capacity > pArray->m_capacity) { if (!mz_zip_array_ensure_capacity(pZip, pArray, new_capacity, growing)) return MZ_FALSE; }
-  return MZ_TRUE;
-}
+    (void)archive;
+    assert(archive != NULL);
+    assert(iterator != NULL);
 
-static MZ_FORCEINLINE mz_bool mz_zip_array_resize(mz_zip_archive *pZip, mz_zip_array *pArray, size_t new_size, mz_uint growing)
-{
-  if (new_size > pArray->m_capacity) { if (!mz_zip_array_ensure_capacity(pZip, pArray, new_size, growing)) return MZ_FALSE; }
-  pArray->m_size = new_size;
-  return MZ_TRUE;
+    DRFS_FREE(iterator);
 }
 
-static MZ_FORCEINLINE mz_bool mz_zip_array_ensure_room(mz_zip_archive *pZip, mz_zip_array *pArray, size_t n)
+static bool drfs_next_iteration__zip(drfs_handle archive, drfs_handle iterator, drfs_file_info* fi)
 {
-  return mz_zip_array_reserve(pZip, pArray, pArray->m_size + n, MZ_TRUE);
-}
+    assert(archive != NULL);
+    assert(iterator != NULL);
 
-static MZ_FORCEINLINE mz_bool mz_zip_array_push_back(mz_zip_archive *pZip, mz_zip_array *pArray, const void *pElements, size_t n)
-{
-  size_t orig_size = pArray->m_size; if (!mz_zip_array_resize(pZip, pArray, orig_size + n, MZ_TRUE)) return MZ_FALSE;
-  memcpy((mz_uint8*)pArray->m_p + orig_size * pArray->m_element_size, pElements, n * pArray->m_element_size);
-  return MZ_TRUE;
-}
+    drfs_iterator_zip* pZipIterator = iterator;
+    if (pZipIterator == NULL) {
+        return false;
+    }
 
-#ifndef MINIZ_NO_TIME
-static time_t mz_zip_dos_to_time_t(int dos_time, int dos_date)
-{
-  struct tm tm;
-  memset(&tm, 0, sizeof(tm)); tm.tm_isdst = -1;
-  tm.tm_year = ((dos_date >> 9) & 127) + 1980 - 1900; tm.tm_mon = ((dos_date >> 5) & 15) - 1; tm.tm_mday = dos_date & 31;
-  tm.tm_hour = (dos_time >> 11) & 31; tm.tm_min = (dos_time >> 5) & 63; tm.tm_sec = (dos_time << 1) & 62;
-  return mktime(&tm);
-}
-#endif
+    drfs_archive_zip* pZipArchive = archive;
+    while (pZipIterator->index < pZipIterator->endIndex)
+    {
+        const drfs_zip_listing_entry* pEntry = pZipArchive->pListing + pZipIterator->index;
+        pZipIterator->index += 1;
+
+        // A directory is in the listing once for every file inside it. The listing is sorted so these are all together.
+        if (pZipIterator->index > 1) {
+            const drfs_zip_listing_entry* pPrevEntry = pEntry - 1;
+            if (drfs_zip_compare_path_prefixes(pPrevEntry->pPath, pPrevEntry->pathLength, pEntry->pPath, pEntry->pathLength) == 0) {
+                continue;
+            }
+        }
 
-static mz_bool mz_zip_reader_init_internal(mz_zip_archive *pZip, mz_uint32 flags)
-{
-  (void)flags;
-  if ((!pZip) || (pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_INVALID))
-    return MZ_FALSE;
+        if (fi != NULL)
+        {
+            drfs__strncpy_s(fi->absolutePath, sizeof(fi->absolutePath), pEntry->pPath, pEntry->pathLength);
+            fi->sizeInBytes      = 0;
+            fi->lastModifiedTime = 0;
+            fi->attributes       = DRFS_FILE_ATTRIBUTE_READONLY | DRFS_FILE_ATTRIBUTE_DIRECTORY;
 
-  if (!pZip->m_pAlloc) pZip->m_pAlloc = def_alloc_func;
-  if (!pZip->m_pFree) pZip->m_pFree = def_free_func;
-  if (!pZip->m_pRealloc) pZip->m_pRealloc = def_realloc_func;
+            mz_zip_archive_file_stat zipStat;
+            if (pEntry->fileIndex != DRFS_ZIP_IMPLIED_DIRECTORY && drfs_mz_zip_reader_file_stat(&pZipArchive->zip, pEntry->fileIndex, &zipStat))
+            {
+                fi->sizeInBytes      = zipStat.m_uncomp_size;
+                fi->lastModifiedTime = (uint64_t)zipStat.m_time;
+                if (!drfs_mz_zip_reader_is_file_a_directory(&pZipArchive->zip, pEntry->fileIndex)) {
+                    fi->attributes = DRFS_FILE_ATTRIBUTE_READONLY;
+                }
+            }
+        }
 
-  pZip->m_zip_mode = MZ_ZIP_MODE_READING;
-  pZip->m_archive_size = 0;
-  pZip->m_central_directory_file_ofs = 0;
-  pZip->m_total_files = 0;
+        return true;
+    }
 
-  if (NULL == (pZip->m_pState = (mz_zip_internal_state *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(mz_zip_internal_state))))
-    return MZ_FALSE;
-  memset(pZip->m_pState, 0, sizeof(mz_zip_internal_state));
-  MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir, sizeof(mz_uint8));
-  MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir_offsets, sizeof(mz_uint32));
-  MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_sorted_central_dir_offsets, sizeof(mz_uint32));
-  return MZ_TRUE;
+    return false;
 }
 
-static MZ_FORCEINLINE mz_bool mz_zip_reader_filename_less(const mz_zip_array *pCentral_dir_array, const mz_zip_array *pCentral_dir_offsets, mz_uint l_index, mz_uint r_index)
+static drfs_result drfs_open_file__zip(drfs_handle archive, const char* relativePath, unsigned int accessMode, drfs_handle* pHandleOut)
 {
-  const mz_uint8 *pL = &MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_array, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_offsets, mz_uint32, l_index)), *pE;
-  const mz_uint8 *pR = &MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_array, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_offsets, mz_uint32, r_index));
-  mz_uint l_len = MZ_READ_LE16(pL + MZ_ZIP_CDH_FILENAME_LEN_OFS), r_len = MZ_READ_LE16(pR + MZ_ZIP_CDH_FILENAME_LEN_OFS);
-  mz_uint8 l = 0, r = 0;
-  pL += MZ_ZIP_CENTRAL_DIR_HEADER_SIZE; pR += MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
-  pE = pL + MZ_MIN(l_len, r_len);
-  while (pL < pE)
-  {
-    if ((l = MZ_TOLOWER(*pL)) != (r = MZ_TOLOWER(*pR)))
-      break;
-    pL++; pR++;
-  }
-  return (pL == pE) ? (l_len < r_len) : (l < r);
-}
+    assert(archive != NULL);
+    assert(pHandleOut != NULL);
+    assert(relativePath != NULL);
 
-#define MZ_SWAP_UINT32(a, b) do { mz_uint32 t = a; a = b; b = t; } MZ_MACRO_END
+    *pHandleOut = NULL;
 
-// Heap sort of lowercased filenames, used to help accelerate plain central directory searches by drfs_mz_zip_reader_locate_file(). (Could also use qsort(), but it could allocate memory.)
-static void mz_zip_reader_sort_central_dir_offsets_by_filename(mz_zip_archive *pZip)
-{
-  mz_zip_internal_state *pState = pZip->m_pState;
-  const mz_zip_array *pCentral_dir_offsets = &pState->m_central_dir_offsets;
-  const mz_zip_array *pCentral_dir = &pState->m_central_dir;
-  mz_uint32 *pIndices = &MZ_ZIP_ARRAY_ELEMENT(&pState->m_sorted_central_dir_offsets, mz_uint32, 0);
-  const int size = pZip->m_total_files;
-  int start = (size - 2) >> 1, end;
-  while (start >= 0)
-  {
-    int child, root = start;
-    for ( ; ; )
-    {
-      if ((child = (root << 1) + 1) >= size)
-        break;
-      child += (((child + 1) < size) && (mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[child], pIndices[child + 1])));
-      if (!mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[root], pIndices[child]))
-        break;
-      MZ_SWAP_UINT32(pIndices[root], pIndices[child]); root = child;
+    // Only supporting read-only for now.
+    if ((accessMode & DRFS_WRITE) != 0) {
+        return drfs_permission_denied;
     }
-    start--;
-  }
 
-  end = size - 1;
-  while (end > 0)
-  {
-    int child, root = 0;
-    MZ_SWAP_UINT32(pIndices[end], pIndices[0]);
-    for ( ; ; )
-    {
-      if ((child = (root << 1) + 1) >= end)
-        break;
-      child += (((child + 1) < end) && mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[child], pIndices[child + 1]));
-      if (!mz_zip_reader_filename_less(pCentral_dir, pCentral_dir_offsets, pIndices[root], pIndices[child]))
-        break;
-      MZ_SWAP_UINT32(pIndices[root], pIndices[child]); root = child;
+
+    mz_zip_archive* pZip = archive;
+    int fileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
+    if (fileIndex == -1) {
+        return drfs_does_not_exist;
     }
-    end--;
-  }
-}
 
-static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive *pZip, mz_uint32 flags)
-{
-  mz_uint cdir_size, num_this_disk, cdir_disk_index;
-  mz_uint64 cdir_ofs;
-  mz_int64 cur_file_ofs;
-  const mz_uint8 *p;
-  mz_uint32 buf_u32[4096 / sizeof(mz_uint32)]; mz_uint8 *pBuf = (mz_uint8 *)buf_u32;
-  mz_bool sort_central_dir = ((flags & MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY) == 0);
-  // Basic sanity checks - reject files which are too small, and check the first 4 bytes of the file to make sure a local header is there.
-  if (pZip->m_archive_size < MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
-    return MZ_FALSE;
-  // Find the end of central directory record by scanning the file from the end towards the beginning.
-  cur_file_ofs = MZ_MAX((mz_int64)pZip->m_archive_size - (mz_int64)sizeof(buf_u32), 0);
-  for ( ; ; )
-  {
-    int i, n = (int)MZ_MIN(sizeof(buf_u32), pZip->m_archive_size - cur_file_ofs);
-    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, n) != (mz_uint)n)
-      return MZ_FALSE;
-    for (i = n - 4; i >= 0; --i)
-      if (MZ_READ_LE32(pBuf + i) == MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG)
-        break;
-    if (i >= 0)
-    {
-      cur_file_ofs += i;
-      break;
+    drfs_archive_zip* pZipArchive = archive;
+    drfs_openedfile_zip* pOpenedFile = drfs_pool_alloc(&pZipArchive->openedFilePool);
+    if (pOpenedFile == NULL) {
+        return drfs_out_of_memory;
     }
-    if ((!cur_file_ofs) || ((pZip->m_archive_size - cur_file_ofs) >= (0xFFFF + MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)))
-      return MZ_FALSE;
-    cur_file_ofs = MZ_MAX(cur_file_ofs - (sizeof(buf_u32) - 3), 0);
-  }
-  // Read and verify the end of central directory record.
-  if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
-    return MZ_FALSE;
-  if ((MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_SIG_OFS) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG) ||
-      ((pZip->m_total_files = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS)) != MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS)))
-    return MZ_FALSE;
 
-  num_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_THIS_DISK_OFS);
-  cdir_disk_index = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS);
-  if (((num_this_disk | cdir_disk_index) != 0) && ((num_this_disk != 1) || (cdir_disk_index != 1)))
-    return MZ_FALSE;
+    pOpenedFile->pData = drfs_mz_zip_reader_extract_to_heap(pZip, (mz_uint)fileIndex, &pOpenedFile->sizeInBytes, 0);
+    if (pOpenedFile->pData == NULL) {
+        drfs_pool_free(&pZipArchive->openedFilePool, pOpenedFile);
+        return drfs_unknown_error;
+    }
 
-  if ((cdir_size = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_SIZE_OFS)) < pZip->m_total_files * MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)
-    return MZ_FALSE;
+    pOpenedFile->index = (mz_uint)fileIndex;
+    pOpenedFile->readPointer = 0;
 
-  cdir_ofs = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_OFS_OFS);
-  if ((cdir_ofs + (mz_uint64)cdir_size) > pZip->m_archive_size)
-    return MZ_FALSE;
+    *pHandleOut = pOpenedFile;
+    return drfs_success;
+}
 
-  pZip->m_central_directory_file_ofs = cdir_ofs;
+static void drfs_close_file__zip(drfs_handle archive, drfs_handle file)
+{
+    drfs_openedfile_zip* pOpenedFile = file;
+    assert(pOpenedFile != NULL);
 
-  if (pZip->m_total_files)
-  {
-     mz_uint i, n;
+    mz_zip_archive* pZip = archive;
+    assert(pZip != NULL);
 
-    // Read the entire central directory into a heap block, and allocate another heap block to hold the unsorted central dir file record offsets, and another to hold the sorted indices.
-    if ((!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir, cdir_size, MZ_FALSE)) ||
-        (!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir_offsets, pZip->m_total_files, MZ_FALSE)))
-      return MZ_FALSE;
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pOpenedFile->pData);
+    drfs_pool_free(&((drfs_archive_zip*)archive)->openedFilePool, pOpenedFile);
+}
 
-    if (sort_central_dir)
-    {
-      if (!mz_zip_array_resize(pZip, &pZip->m_pState->m_sorted_central_dir_offsets, pZip->m_total_files, MZ_FALSE))
-        return MZ_FALSE;
+static drfs_result drfs_read_file__zip(drfs_handle archive, drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+{
+    (void)archive;
+    assert(archive != NULL);
+    assert(file != NULL);
+    assert(pDataOut != NULL);
+    assert(bytesToRead > 0);
+
+    drfs_openedfile_zip* pOpenedFile = file;
+    if (pOpenedFile == NULL) {
+        return drfs_invalid_args;
     }
 
-    if (pZip->m_pRead(pZip->m_pIO_opaque, cdir_ofs, pZip->m_pState->m_central_dir.m_p, cdir_size) != cdir_size)
-      return MZ_FALSE;
+    size_t bytesAvailable = pOpenedFile->sizeInBytes - pOpenedFile->readPointer;
+    if (bytesAvailable < bytesToRead) {
+        bytesToRead = bytesAvailable;
+    }
 
-    // Now create an index into the central directory file records, do some basic sanity checking on each record, and check for zip64 entries (which are not yet supported).
-    p = (const mz_uint8 *)pZip->m_pState->m_central_dir.m_p;
-    for (n = cdir_size, i = 0; i < pZip->m_total_files; ++i)
-    {
-      mz_uint total_header_size, comp_size, decomp_size, disk_index;
-      if ((n < MZ_ZIP_CENTRAL_DIR_HEADER_SIZE) || (MZ_READ_LE32(p) != MZ_ZIP_CENTRAL_DIR_HEADER_SIG))
-        return MZ_FALSE;
-      MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, i) = (mz_uint32)(p - (const mz_uint8 *)pZip->m_pState->m_central_dir.m_p);
-      if (sort_central_dir)
-        MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_sorted_central_dir_offsets, mz_uint32, i) = i;
-      comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
-      decomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
-      if (((!MZ_READ_LE32(p + MZ_ZIP_CDH_METHOD_OFS)) && (decomp_size != comp_size)) || (decomp_size && !comp_size) || (decomp_size == 0xFFFFFFFF) || (comp_size == 0xFFFFFFFF))
-        return MZ_FALSE;
-      disk_index = MZ_READ_LE16(p + MZ_ZIP_CDH_DISK_START_OFS);
-      if ((disk_index != num_this_disk) && (disk_index != 1))
-        return MZ_FALSE;
-      if (((mz_uint64)MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS) + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + comp_size) > pZip->m_archive_size)
-        return MZ_FALSE;
-      if ((total_header_size = MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_COMMENT_LEN_OFS)) > n)
-        return MZ_FALSE;
-      n -= total_header_size; p += total_header_size;
+    if (bytesToRead == 0) {
+        return drfs_at_end_of_file;   // Nothing left to read.
     }
-  }
-
-  if (sort_central_dir)
-    mz_zip_reader_sort_central_dir_offsets_by_filename(pZip);
 
-  return MZ_TRUE;
-}
 
-mz_bool drfs_mz_zip_reader_init(mz_zip_archive *pZip, mz_uint64 size, mz_uint32 flags)
-{
-  if ((!pZip) || (!pZip->m_pRead))
-    return MZ_FALSE;
-  if (!mz_zip_reader_init_internal(pZip, flags))
-    return MZ_FALSE;
-  pZip->m_archive_size = size;
-  if (!mz_zip_reader_read_central_dir(pZip, flags))
-  {
-    drfs_mz_zip_reader_end(pZip);
-    return MZ_FALSE;
-  }
-  return MZ_TRUE;
-}
+    memcpy(pDataOut, pOpenedFile->pData + pOpenedFile->readPointer, bytesToRead);
+    pOpenedFile->readPointer += bytesToRead;
 
-mz_uint drfs_mz_zip_reader_get_num_files(mz_zip_archive *pZip)
-{
-  return pZip ? pZip->m_total_files : 0;
-}
+    if (pBytesReadOut) {
+        *pBytesReadOut = bytesToRead;
+    }
 
-static MZ_FORCEINLINE const mz_uint8 *mz_zip_reader_get_cdh(mz_zip_archive *pZip, mz_uint file_index)
-{
-  if ((!pZip) || (!pZip->m_pState) || (file_index >= pZip->m_total_files) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
-    return NULL;
-  return &MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, file_index));
+    return drfs_success;
 }
 
-mz_bool drfs_mz_zip_reader_is_file_a_directory(mz_zip_archive *pZip, mz_uint file_index)
+static drfs_result drfs_write_file__zip(drfs_handle archive, drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
 {
-  mz_uint filename_len, external_attr;
-  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
-  if (!p)
-    return MZ_FALSE;
+    (void)archive;
+    (void)file;
+    (void)pData;
+    (void)bytesToWrite;
 
-  // First see if the filename ends with a '/' character.
-  filename_len = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
-  if (filename_len)
-  {
-    if (*(p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + filename_len - 1) == '/')
-      return MZ_TRUE;
-  }
+    assert(archive != NULL);
+    assert(file != NULL);
+    assert(pData != NULL);
+    assert(bytesToWrite > 0);
 
-  // Bugfix: This code was also checking if the internal attribute was non-zero, which wasn't correct.
-  // Most/all zip writers (hopefully) set DOS file/directory attributes in the low 16-bits, so check for the DOS directory flag and ignore the source OS ID in the created by field.
-  // FIXME: Remove this check? Is it necessary - we already check the filename.
-  external_attr = MZ_READ_LE32(p + MZ_ZIP_CDH_EXTERNAL_ATTR_OFS);
-  if ((external_attr & 0x10) != 0)
-    return MZ_TRUE;
+    // All files are read-only for now.
+    if (pBytesWrittenOut) {
+        *pBytesWrittenOut = 0;
+    }
 
-  return MZ_FALSE;
+    return drfs_permission_denied;
 }
 
-mz_bool drfs_mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_file_stat *pStat)
+static drfs_result drfs_seek_file__zip(drfs_handle archive, drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
 {
-  mz_uint n;
-  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
-  if ((!p) || (!pStat))
-    return MZ_FALSE;
+    (void)archive;
 
-  // Unpack the central directory record.
-  pStat->m_file_index = file_index;
-  pStat->m_central_dir_ofs = MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, file_index);
-  pStat->m_version_made_by = MZ_READ_LE16(p + MZ_ZIP_CDH_VERSION_MADE_BY_OFS);
-  pStat->m_version_needed = MZ_READ_LE16(p + MZ_ZIP_CDH_VERSION_NEEDED_OFS);
-  pStat->m_bit_flag = MZ_READ_LE16(p + MZ_ZIP_CDH_BIT_FLAG_OFS);
-  pStat->m_method = MZ_READ_LE16(p + MZ_ZIP_CDH_METHOD_OFS);
-#ifndef MINIZ_NO_TIME
-  pStat->m_time = mz_zip_dos_to_time_t(MZ_READ_LE16(p + MZ_ZIP_CDH_FILE_TIME_OFS), MZ_READ_LE16(p + MZ_ZIP_CDH_FILE_DATE_OFS));
-#endif
-  pStat->m_crc32 = MZ_READ_LE32(p + MZ_ZIP_CDH_CRC32_OFS);
-  pStat->m_comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
-  pStat->m_uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
-  pStat->m_internal_attr = MZ_READ_LE16(p + MZ_ZIP_CDH_INTERNAL_ATTR_OFS);
-  pStat->m_external_attr = MZ_READ_LE32(p + MZ_ZIP_CDH_EXTERNAL_ATTR_OFS);
-  pStat->m_local_header_ofs = MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS);
+    assert(archive != NULL);
+    assert(file != NULL);
 
-  // Copy as much of the filename and comment as possible.
-  n = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS); n = MZ_MIN(n, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE - 1);
-  memcpy(pStat->m_filename, p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE, n); pStat->m_filename[n] = '\0';
+    drfs_openedfile_zip* pOpenedFile = file;
+    if (pOpenedFile == NULL) {
+        return drfs_invalid_args;
+    }
 
-  n = MZ_READ_LE16(p + MZ_ZIP_CDH_COMMENT_LEN_OFS); n = MZ_MIN(n, MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE - 1);
-  pStat->m_comment_size = n;
-  memcpy(pStat->m_comment, p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS), n); pStat->m_comment[n] = '\0';
+    uint64_t newPos = pOpenedFile->readPointer;
+    if (origin == drfs_origin_current)
+    {
+        if ((int64_t)newPos + bytesToSeek >= 0)
+        {
+            newPos = (uint64_t)((int64_t)newPos + bytesToSeek);
+        }
+        else
+        {
+            // Trying to seek to before the beginning of the file.
+            return drfs_invalid_args;
+        }
+    }
+    else if (origin == drfs_origin_start)
+    {
+        assert(bytesToSeek >= 0);
+        newPos = (uint64_t)bytesToSeek;
+    }
+    else if (origin == drfs_origin_end)
+    {
+        assert(bytesToSeek >= 0);
+        if ((uint64_t)bytesToSeek <= pOpenedFile->sizeInBytes)
+        {
+            newPos = pOpenedFile->sizeInBytes - (uint64_t)bytesToSeek;
+        }
+        else
+        {
+            // Trying to seek to before the beginning of the file.
+            return drfs_invalid_args;
+        }
+    }
+    else
+    {
+        // Should never get here.
+        return drfs_unknown_error;
+    }
 
-  return MZ_TRUE;
-}
 
-mz_uint drfs_mz_zip_reader_get_filename(mz_zip_archive *pZip, mz_uint file_index, char *pFilename, mz_uint filename_buf_size)
-{
-  mz_uint n;
-  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
-  if (!p) { if (filename_buf_size) pFilename[0] = '\0'; return 0; }
-  n = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
-  if (filename_buf_size)
-  {
-    n = MZ_MIN(n, filename_buf_size - 1);
-    memcpy(pFilename, p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE, n);
-    pFilename[n] = '\0';
-  }
-  return n + 1;
+    if (newPos > pOpenedFile->sizeInBytes) {
+        return drfs_invalid_args;
+    }
+
+    pOpenedFile->readPointer = (size_t)newPos;
+    return drfs_success;
 }
 
-static MZ_FORCEINLINE mz_bool mz_zip_reader_string_equal(const char *pA, const char *pB, mz_uint len, mz_uint flags)
+static uint64_t drfs_tell_file__zip(drfs_handle archive, drfs_handle file)
 {
-  mz_uint i;
-  if (flags & MZ_ZIP_FLAG_CASE_SENSITIVE)
-    return 0 == memcmp(pA, pB, len);
-  for (i = 0; i < len; ++i)
-    if (MZ_TOLOWER(pA[i]) != MZ_TOLOWER(pB[i]))
-      return MZ_FALSE;
-  return MZ_TRUE;
+    (void)archive;
+
+    drfs_openedfile_zip* pOpenedFile = file;
+    assert(pOpenedFile != NULL);
+
+    return pOpenedFile->readPointer;
 }
 
-static MZ_FORCEINLINE int mz_zip_reader_filename_compare(const mz_zip_array *pCentral_dir_array, const mz_zip_array *pCentral_dir_offsets, mz_uint l_index, const char *pR, mz_uint r_len)
+static uint64_t drfs_file_size__zip(drfs_handle archive, drfs_handle file)
 {
-  const mz_uint8 *pL = &MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_array, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(pCentral_dir_offsets, mz_uint32, l_index)), *pE;
-  mz_uint l_len = MZ_READ_LE16(pL + MZ_ZIP_CDH_FILENAME_LEN_OFS);
-  mz_uint8 l = 0, r = 0;
-  pL += MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
-  pE = pL + MZ_MIN(l_len, r_len);
-  while (pL < pE)
-  {
-    if ((l = MZ_TOLOWER(*pL)) != (r = MZ_TOLOWER(*pR)))
-      break;
-    pL++; pR++;
-  }
-  return (pL == pE) ? (int)(l_len - r_len) : (l - r);
+    (void)archive;
+
+    drfs_openedfile_zip* pOpenedFile = file;
+    assert(pOpenedFile != NULL);
+
+    return pOpenedFile->sizeInBytes;
 }
 
-static int mz_zip_reader_locate_file_binary_search(mz_zip_archive *pZip, const char *pFilename)
+static void drfs_flush__zip(drfs_handle archive, drfs_handle file)
 {
-  mz_zip_internal_state *pState = pZip->m_pState;
-  const mz_zip_array *pCentral_dir_offsets = &pState->m_central_dir_offsets;
-  const mz_zip_array *pCentral_dir = &pState->m_central_dir;
-  mz_uint32 *pIndices = &MZ_ZIP_ARRAY_ELEMENT(&pState->m_sorted_central_dir_offsets, mz_uint32, 0);
-  const int size = pZip->m_total_files;
-  const mz_uint filename_len = (mz_uint)strlen(pFilename);
-  int l = 0, h = size - 1;
-  while (l <= h)
-  {
-    int m = (l + h) >> 1, file_index = pIndices[m], comp = mz_zip_reader_filename_compare(pCentral_dir, pCentral_dir_offsets, file_index, pFilename, filename_len);
-    if (!comp)
-      return file_index;
-    else if (comp < 0)
-      l = m + 1;
-    else
-      h = m - 1;
-  }
-  return -1;
+    (void)archive;
+    (void)file;
+
+    assert(archive != NULL);
+    assert(file != NULL);
+
+    // All files are read-only for now.
 }
 
-int drfs_mz_zip_reader_locate_file(mz_zip_archive *pZip, const char *pName, const char *pComment, mz_uint flags)
-{
-  mz_uint file_index; size_t name_len, comment_len;
-  if ((!pZip) || (!pZip->m_pState) || (!pName) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
-    return -1;
-  if (((flags & (MZ_ZIP_FLAG_IGNORE_PATH | MZ_ZIP_FLAG_CASE_SENSITIVE)) == 0) && (!pComment) && (pZip->m_pState->m_sorted_central_dir_offsets.m_size))
-    return mz_zip_reader_locate_file_binary_search(pZip, pName);
-  name_len = strlen(pName); if (name_len > 0xFFFF) return -1;
-  comment_len = pComment ? strlen(pComment) : 0; if (comment_len > 0xFFFF) return -1;
-  for (file_index = 0; file_index < pZip->m_total_files; file_index++)
-  {
-    const mz_uint8 *pHeader = &MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir, mz_uint8, MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, file_index));
-    mz_uint filename_len = MZ_READ_LE16(pHeader + MZ_ZIP_CDH_FILENAME_LEN_OFS);
-    const char *pFilename = (const char *)pHeader + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
-    if (filename_len < name_len)
-      continue;
-    if (comment_len)
-    {
-      mz_uint file_extra_len = MZ_READ_LE16(pHeader + MZ_ZIP_CDH_EXTRA_LEN_OFS), file_comment_len = MZ_READ_LE16(pHeader + MZ_ZIP_CDH_COMMENT_LEN_OFS);
-      const char *pFile_comment = pFilename + filename_len + file_extra_len;
-      if ((file_comment_len != comment_len) || (!mz_zip_reader_string_equal(pComment, pFile_comment, file_comment_len, flags)))
-        continue;
-    }
-    if ((flags & MZ_ZIP_FLAG_IGNORE_PATH) && (filename_len))
-    {
-      int ofs = filename_len - 1;
-      do
-      {
-        if ((pFilename[ofs] == '/') || (pFilename[ofs] == '\\') || (pFilename[ofs] == ':'))
-          break;
-      } while (--ofs >= 0);
-      ofs++;
-      pFilename += ofs; filename_len -= ofs;
+
+static void drfs_register_zip_backend(drfs_context* pContext)
+{
+    if (pContext == NULL) {
+        return;
     }
-    if ((filename_len == name_len) && (mz_zip_reader_string_equal(pName, pFilename, filename_len, flags)))
-      return file_index;
-  }
-  return -1;
+
+    drfs_archive_callbacks callbacks;
+    callbacks.is_valid_extension = drfs_is_valid_extension__zip;
+    callbacks.open_archive       = drfs_open_archive__zip;
+    callbacks.close_archive      = drfs_close_archive__zip;
+    callbacks.get_file_info      = drfs_get_file_info__zip;
+    callbacks.begin_iteration    = drfs_begin_iteration__zip;
+    callbacks.end_iteration      = drfs_end_iteration__zip;
+    callbacks.next_iteration     = drfs_next_iteration__zip;
+    callbacks.delete_file        = NULL;
+    callbacks.rename_file        = NULL;
+    callbacks.create_directory   = NULL;
+    callbacks.copy_file          = NULL;
+    callbacks.open_file          = drfs_open_file__zip;
+    callbacks.close_file         = drfs_close_file__zip;
+    callbacks.read_file          = drfs_read_file__zip;
+    callbacks.write_file         = drfs_write_file__zip;
+    callbacks.seek_file          = drfs_seek_file__zip;
+    callbacks.tell_file          = drfs_tell_file__zip;
+    callbacks.file_size          = drfs_file_size__zip;
+    callbacks.flush_file         = drfs_flush__zip;
+    drfs_register_archive_backend(pContext, callbacks);
 }
 
-mz_bool drfs_mz_zip_reader_extract_to_mem_no_alloc(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size)
+//// Compressed Streams ////
+//
+// Files opened with DRFS_COMPRESSED are stored as gzip streams so they can be inspected with standard tools. The stripped
+// down version of miniz above only includes the inflater, so writing is done with the small deflate encoder below. It's
+// a standard LZ77 encoder using hash chains and one step of lazy matching, followed by dynamic Huffman coding. Blocks that
+// don't compress are stored as-is. Reading uses the miniz inflater with a circular dictionary so that memory usage does
+// not depend on the size of the file.
+//
+// miniz's own encoder, tdefl, was left out when miniz was stripped down for this file, and bringing it back would add
+// more code than this encoder and it's own copies of the tables shared with tinfl. This encoder only needs to handle
+// one stream per file at a fixed level. Changes to it should be checked with build_tools/drfs_deflate_fuzz, which
+// compares it's output against zlib's inflater.
+
+#define DRFS_DEFLATE_WINDOW_SIZE    32768
+#define DRFS_DEFLATE_BLOCK_SIZE     65536
+#define DRFS_DEFLATE_BUFFER_SIZE    (DRFS_DEFLATE_WINDOW_SIZE + DRFS_DEFLATE_BLOCK_SIZE)
+#define DRFS_DEFLATE_OUTPUT_SIZE    (DRFS_DEFLATE_BLOCK_SIZE + 1024)
+#define DRFS_DEFLATE_HASH_BITS      15
+#define DRFS_DEFLATE_HASH_SIZE      (1 << DRFS_DEFLATE_HASH_BITS)
+#define DRFS_DEFLATE_MIN_MATCH      3
+#define DRFS_DEFLATE_MAX_MATCH      258
+#define DRFS_DEFLATE_MAX_CHAIN      128     // The maximum number of hash chain links to follow when searching for a match.
+#define DRFS_DEFLATE_NICE_LENGTH    128     // Stop searching once a match of at least this length has been found.
+#define DRFS_DEFLATE_LAZY_LENGTH    32      // Don't bother looking for a better match at the next byte when the current one is at least this long.
+#define DRFS_DEFLATE_GOOD_LENGTH    8       // Only follow a quarter of the chain when looking for a better match than one that is at least this long.
+#define DRFS_INFLATE_INPUT_SIZE     16384
+
+typedef struct
 {
-  int status = TINFL_STATUS_DONE;
-  mz_uint64 needed_size, cur_file_ofs, comp_remaining, out_buf_ofs = 0, read_buf_size, read_buf_ofs = 0, read_buf_avail;
-  mz_zip_archive_file_stat file_stat;
-  void *pRead_buf;
-  mz_uint32 local_header_u32[(MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)]; mz_uint8 *pLocal_header = (mz_uint8 *)local_header_u32;
-  tinfl_decompressor inflator;
+    // The length of the match, or the literal byte if <dist> is 0.
+    uint16_t litlen;
 
-  if ((buf_size) && (!pBuf))
-    return MZ_FALSE;
+    // The distance of the match, or 0 if it's a literal.
+    uint16_t dist;
 
-  if (!drfs_mz_zip_reader_file_stat(pZip, file_index, &file_stat))
-    return MZ_FALSE;
+} drfs_deflate_symbol;
 
-  // Empty file, or a directory (but not always a directory - I've seen odd zips with directories that have compressed data which inflates to 0 bytes)
-  if (!file_stat.m_comp_size)
-    return MZ_TRUE;
+typedef struct
+{
+    // The frequency of the symbol while the code is being built, and then the length of the symbol's code.
+    uint32_t key;
 
-  // Entry is a subdirectory (I've seen old zips with dir entries which have compressed deflate data which inflates to 0 bytes, but these entries claim to uncompress to 512 bytes in the headers).
-  // I'm torn how to handle this case - should it fail instead?
-  if (drfs_mz_zip_reader_is_file_a_directory(pZip, file_index))
-    return MZ_TRUE;
+    // The index of the symbol.
+    uint16_t symbol;
 
-  // Encryption and patch files are not supported.
-  if (file_stat.m_bit_flag & (1 | 32))
-    return MZ_FALSE;
+} drfs_deflate_symfreq;
 
-  // This function only supports stored and deflate.
-  if ((!(flags & MZ_ZIP_FLAG_COMPRESSED_DATA)) && (file_stat.m_method != 0) && (file_stat.m_method != MZ_DEFLATED))
-    return MZ_FALSE;
+typedef struct
+{
+    // The sliding window followed by the data that has not yet been compressed.
+    uint8_t buffer[DRFS_DEFLATE_BUFFER_SIZE];
 
-  // Ensure supplied output buffer is large enough.
-  needed_size = (flags & MZ_ZIP_FLAG_COMPRESSED_DATA) ? file_stat.m_comp_size : file_stat.m_uncomp_size;
-  if (buf_size < needed_size)
-    return MZ_FALSE;
+    // The number of bytes in the buffer.
+    unsigned int bufferSize;
 
-  // Read and parse the local directory entry.
-  cur_file_ofs = file_stat.m_local_header_ofs;
-  if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pLocal_header, MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
-    return MZ_FALSE;
-  if (MZ_READ_LE32(pLocal_header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
-    return MZ_FALSE;
+    // The position in the buffer of the first byte that has not been compressed.
+    unsigned int blockStart;
 
-  cur_file_ofs += MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  if ((cur_file_ofs + file_stat.m_comp_size) > pZip->m_archive_size)
-    return MZ_FALSE;
+    // The next position in the buffer that needs to be added to the hash chains.
+    unsigned int insertPos;
 
-  if ((flags & MZ_ZIP_FLAG_COMPRESSED_DATA) || (!file_stat.m_method))
-  {
-    // The file is stored or the caller has requested the compressed data.
-    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, (size_t)needed_size) != needed_size)
-      return MZ_FALSE;
-    return ((flags & MZ_ZIP_FLAG_COMPRESSED_DATA) != 0) || (drfs_mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)pBuf, (size_t)file_stat.m_uncomp_size) == file_stat.m_crc32);
-  }
+    // The most recent position in the buffer for each hash, or -1 if there is none.
+    int32_t head[DRFS_DEFLATE_HASH_SIZE];
 
-  // Decompress the file either directly from memory or from a file input buffer.
-  tinfl_init(&inflator);
+    // The previous position in the buffer with the same hash, indexed by the position modulo the window size.
+    int32_t prev[DRFS_DEFLATE_WINDOW_SIZE];
 
-  if (pZip->m_pState->m_pMem)
-  {
-    // Read directly from the archive in memory.
-    pRead_buf = (mz_uint8 *)pZip->m_pState->m_pMem + cur_file_ofs;
-    read_buf_size = read_buf_avail = file_stat.m_comp_size;
-    comp_remaining = 0;
-  }
-  else if (pUser_read_buf)
-  {
-    // Use a user provided read buffer.
-    if (!user_read_buf_size)
-      return MZ_FALSE;
-    pRead_buf = (mz_uint8 *)pUser_read_buf;
-    read_buf_size = user_read_buf_size;
-    read_buf_avail = 0;
-    comp_remaining = file_stat.m_comp_size;
-  }
-  else
-  {
-    // Temporarily allocate a read buffer.
-    read_buf_size = MZ_MIN(file_stat.m_comp_size, MZ_ZIP_MAX_IO_BUF_SIZE);
-#ifdef _MSC_VER
-    if (((0, sizeof(size_t) == sizeof(mz_uint32))) && (read_buf_size > 0x7FFFFFFF))
-#else
-    if (((sizeof(size_t) == sizeof(mz_uint32))) && (read_buf_size > 0x7FFFFFFF))
-#endif
-      return MZ_FALSE;
-    if (NULL == (pRead_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)read_buf_size)))
-      return MZ_FALSE;
-    read_buf_avail = 0;
-    comp_remaining = file_stat.m_comp_size;
-  }
+    // The symbols making up the current block.
+    drfs_deflate_symbol symbols[DRFS_DEFLATE_BLOCK_SIZE];
+    unsigned int symbolCount;
 
-  do
-  {
-    size_t in_buf_size, out_buf_size = (size_t)(file_stat.m_uncomp_size - out_buf_ofs);
-    if ((!read_buf_avail) && (!pZip->m_pState->m_pMem))
-    {
-      read_buf_avail = MZ_MIN(read_buf_size, comp_remaining);
-      if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pRead_buf, (size_t)read_buf_avail) != read_buf_avail)
-      {
-        status = TINFL_STATUS_FAILED;
-        break;
-      }
-      cur_file_ofs += read_buf_avail;
-      comp_remaining -= read_buf_avail;
-      read_buf_ofs = 0;
-    }
-    in_buf_size = (size_t)read_buf_avail;
-    status = drfs_tinfl_decompress(&inflator, (mz_uint8 *)pRead_buf + read_buf_ofs, &in_buf_size, (mz_uint8 *)pBuf, (mz_uint8 *)pBuf + out_buf_ofs, &out_buf_size, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF | (comp_remaining ? TINFL_FLAG_HAS_MORE_INPUT : 0));
-    read_buf_avail -= in_buf_size;
-    read_buf_ofs += in_buf_size;
-    out_buf_ofs += out_buf_size;
-  } while (status == TINFL_STATUS_NEEDS_MORE_INPUT);
+    // The symbol frequencies of the current block.
+    unsigned int litlenFreq[286];
+    unsigned int distFreq[30];
 
-  if (status == TINFL_STATUS_DONE)
-  {
-    // Make sure the entire file was decompressed, and check its CRC.
-    if ((out_buf_ofs != file_stat.m_uncomp_size) || (drfs_mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)pBuf, (size_t)file_stat.m_uncomp_size) != file_stat.m_crc32))
-      status = TINFL_STATUS_FAILED;
-  }
+    // Maps a match length to it's length code, minus 257.
+    uint8_t lengthCodes[DRFS_DEFLATE_MAX_MATCH + 1];
 
-  if ((!pZip->m_pState->m_pMem) && (!pUser_read_buf))
-    pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
+    // The bit buffer for the compressed output. Bits are written from the least significant bit.
+    uint64_t bitBuffer;
+    unsigned int bitCount;
 
-  return status == TINFL_STATUS_DONE;
+    // The compressed output that has not yet been written to the file.
+    uint8_t output[DRFS_DEFLATE_OUTPUT_SIZE];
+    unsigned int outputSize;
+
+} drfs_deflate_state;
+
+typedef struct
+{
+    // The miniz decompressor.
+    tinfl_decompressor decompressor;
+
+    // The compressed data that has been read from the file, but not yet decompressed.
+    uint8_t input[DRFS_INFLATE_INPUT_SIZE];
+    size_t inputPos;
+    size_t inputSize;
+
+    // Whether or not every byte of the compressed data has been read from the file.
+    bool isInputExhausted;
+
+    // The circular dictionary the decompressor writes to.
+    uint8_t dictionary[TINFL_LZ_DICT_SIZE];
+    size_t dictionaryPos;
+
+    // The range of decompressed data in the dictionary that has not yet been returned to the application.
+    size_t pendingPos;
+    size_t pendingSize;
+
+    // Whether or not the end of the deflate stream has been reached.
+    bool isAtEnd;
+
+    // The CRC-32 stored in the gzip trailer.
+    mz_ulong expectedCRC32;
+
+} drfs_inflate_state;
+
+typedef struct
+{
+    // The encoder state. This is only set when the file was opened for writing.
+    drfs_deflate_state* pDeflate;
+
+    // The decoder state. This is only set when the file was opened for reading.
+    drfs_inflate_state* pInflate;
+
+    // The position of the deflate data within the underlying file. This is used for seeking backwards while reading.
+    uint64_t compressedDataPos;
+
+    // The uncompressed size of the file.
+    uint64_t uncompressedSize;
+
+    // The position within the uncompressed data.
+    uint64_t position;
+
+    // The running CRC-32 of the uncompressed data.
+    mz_ulong crc32;
+
+} drfs_compressed_stream;
+
+
+// The functions below operate on the file's underlying data, bypassing the compressed stream.
+static drfs_result drfs_compressed_stream_read_raw(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+{
+    return pFile->pArchive->callbacks.read_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, pDataOut, bytesToRead, pBytesReadOut);
 }
 
-mz_bool drfs_mz_zip_reader_extract_file_to_mem_no_alloc(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags, void *pUser_read_buf, size_t user_read_buf_size)
+static drfs_result drfs_compressed_stream_write_raw(drfs_file* pFile, const void* pData, size_t bytesToWrite)
 {
-  int file_index = drfs_mz_zip_reader_locate_file(pZip, pFilename, NULL, flags);
-  if (file_index < 0)
-    return MZ_FALSE;
-  return drfs_mz_zip_reader_extract_to_mem_no_alloc(pZip, file_index, pBuf, buf_size, flags, pUser_read_buf, user_read_buf_size);
+    size_t bytesWritten;
+    drfs_result result = pFile->pArchive->callbacks.write_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, pData, bytesToWrite, &bytesWritten);
+    if (result == drfs_success && bytesWritten != bytesToWrite) {
+        result = drfs_no_space;
+    }
+
+    return result;
 }
 
-mz_bool drfs_mz_zip_reader_extract_to_mem(mz_zip_archive *pZip, mz_uint file_index, void *pBuf, size_t buf_size, mz_uint flags)
+static drfs_result drfs_compressed_stream_seek_raw(drfs_file* pFile, uint64_t position)
 {
-  return drfs_mz_zip_reader_extract_to_mem_no_alloc(pZip, file_index, pBuf, buf_size, flags, NULL, 0);
+    return pFile->pArchive->callbacks.seek_file(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle, (int64_t)position, drfs_origin_start);
 }
 
-mz_bool drfs_mz_zip_reader_extract_file_to_mem(mz_zip_archive *pZip, const char *pFilename, void *pBuf, size_t buf_size, mz_uint flags)
+
+static void drfs_deflate_put_bits(drfs_deflate_state* pState, uint32_t bits, unsigned int bitCount)
 {
-  return drfs_mz_zip_reader_extract_file_to_mem_no_alloc(pZip, pFilename, pBuf, buf_size, flags, NULL, 0);
+    assert(bitCount <= 32);
+    assert(pState->outputSize + 8 <= DRFS_DEFLATE_OUTPUT_SIZE);
+
+    pState->bitBuffer |= (uint64_t)bits << pState->bitCount;
+    pState->bitCount  += bitCount;
+
+    while (pState->bitCount >= 8) {
+        pState->output[pState->outputSize++] = (uint8_t)pState->bitBuffer;
+        pState->bitBuffer >>= 8;
+        pState->bitCount   -= 8;
+    }
 }
 
-void *drfs_mz_zip_reader_extract_to_heap(mz_zip_archive *pZip, mz_uint file_index, size_t *pSize, mz_uint flags)
+static void drfs_deflate_align_to_byte(drfs_deflate_state* pState)
 {
-  mz_uint64 comp_size, uncomp_size, alloc_size;
-  const mz_uint8 *p = mz_zip_reader_get_cdh(pZip, file_index);
-  void *pBuf;
+    if (pState->bitCount > 0) {
+        drfs_deflate_put_bits(pState, 0, 8 - pState->bitCount);
+    }
+}
 
-  if (pSize)
-    *pSize = 0;
-  if (!p)
-    return NULL;
+static unsigned int drfs_deflate_dist_code(unsigned int dist)
+{
+    assert(dist >= 1 && dist <= DRFS_DEFLATE_WINDOW_SIZE);
 
-  comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
-  uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+    // Distances 1 to 4 have their own codes. After that, each pair of codes covers a power of two range.
+    unsigned int d = dist - 1;
+    if (d < 4) {
+        return d;
+    }
 
-  alloc_size = (flags & MZ_ZIP_FLAG_COMPRESSED_DATA) ? comp_size : uncomp_size;
-#ifdef _MSC_VER
-  if (((0, sizeof(size_t) == sizeof(mz_uint32))) && (alloc_size > 0x7FFFFFFF))
-#else
-  if (((sizeof(size_t) == sizeof(mz_uint32))) && (alloc_size > 0x7FFFFFFF))
-#endif
-    return NULL;
-  if (NULL == (pBuf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)alloc_size)))
-    return NULL;
+    unsigned int highestBit = 2;
+    while ((2u << highestBit) <= d) {
+        highestBit += 1;
+    }
 
-  if (!drfs_mz_zip_reader_extract_to_mem(pZip, file_index, pBuf, (size_t)alloc_size, flags))
-  {
-    pZip->m_pFree(pZip->m_pAlloc_opaque, pBuf);
-    return NULL;
-  }
+    return 2*highestBit + ((d >> (highestBit - 1)) & 1);
+}
 
-  if (pSize) *pSize = (size_t)alloc_size;
-  return pBuf;
+static unsigned int drfs_deflate_hash(const uint8_t* p)
+{
+    uint32_t value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (value * 2654435761u) >> (32 - DRFS_DEFLATE_HASH_BITS);
 }
 
-mz_bool drfs_mz_zip_reader_end(mz_zip_archive *pZip)
+// Adds every position before <pos> to the hash chains. Positions too close to the end of the buffer to be hashed are left
+// until more data arrives.
+static void drfs_deflate_insert_up_to(drfs_deflate_state* pState, unsigned int pos)
 {
-  if ((!pZip) || (!pZip->m_pState) || (!pZip->m_pAlloc) || (!pZip->m_pFree) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
-    return MZ_FALSE;
+    while (pState->insertPos < pos && pState->insertPos + DRFS_DEFLATE_MIN_MATCH <= pState->bufferSize)
+    {
+        unsigned int hash = drfs_deflate_hash(pState->buffer + pState->insertPos);
+        pState->prev[pState->insertPos & (DRFS_DEFLATE_WINDOW_SIZE - 1)] = pState->head[hash];
+        pState->head[hash] = (int32_t)pState->insertPos;
+        pState->insertPos += 1;
+    }
+}
 
-  if (pZip->m_pState)
-  {
-    mz_zip_internal_state *pState = pZip->m_pState; pZip->m_pState = NULL;
-    mz_zip_array_clear(pZip, &pState->m_central_dir);
-    mz_zip_array_clear(pZip, &pState->m_central_dir_offsets);
-    mz_zip_array_clear(pZip, &pState->m_sorted_central_dir_offsets);
+// Finds the longest match for the data at the given position. Returns 0 if there is no match of at least the minimum length.
+static unsigned int drfs_deflate_find_match(drfs_deflate_state* pState, unsigned int pos, unsigned int chainLength, unsigned int* pDistOut)
+{
+    unsigned int maxLength = pState->bufferSize - pos;
+    if (maxLength > DRFS_DEFLATE_MAX_MATCH) {
+        maxLength = DRFS_DEFLATE_MAX_MATCH;
+    }
 
-    pZip->m_pFree(pZip->m_pAlloc_opaque, pState);
-  }
-  pZip->m_zip_mode = MZ_ZIP_MODE_INVALID;
+    if (maxLength < DRFS_DEFLATE_MIN_MATCH) {
+        return 0;
+    }
+
+    const uint8_t* pCurrent = pState->buffer + pos;
+    int32_t limit = (pos > DRFS_DEFLATE_WINDOW_SIZE) ? (int32_t)(pos - DRFS_DEFLATE_WINDOW_SIZE) : 0;
+    int32_t candidate = pState->head[drfs_deflate_hash(pCurrent)];
+
+    unsigned int bestLength = DRFS_DEFLATE_MIN_MATCH - 1;
+    while (candidate >= limit && chainLength > 0)
+    {
+        const uint8_t* pCandidate = pState->buffer + candidate;
+        if (pCandidate[bestLength] == pCurrent[bestLength] && pCandidate[0] == pCurrent[0] && pCandidate[1] == pCurrent[1])
+        {
+            // Compare 8 bytes at a time while there's room, and then finish off byte by byte.
+            unsigned int length = 2;
+            while (length + 8 <= maxLength) {
+                uint64_t a;
+                uint64_t b;
+                memcpy(&a, pCandidate + length, 8);
+                memcpy(&b, pCurrent   + length, 8);
+                if (a != b) {
+                    break;
+                }
+
+                length += 8;
+            }
+
+            while (length < maxLength && pCandidate[length] == pCurrent[length]) {
+                length += 1;
+            }
+
+            if (length > bestLength) {
+                bestLength = length;
+                *pDistOut  = pos - (unsigned int)candidate;
+                if (length >= maxLength || length >= DRFS_DEFLATE_NICE_LENGTH) {
+                    break;
+                }
+            }
+        }
+
+        int32_t next = pState->prev[candidate & (DRFS_DEFLATE_WINDOW_SIZE - 1)];
+        if (next >= candidate) {
+            break;  // Stale link from a position that has since been overwritten.
+        }
+
+        candidate    = next;
+        chainLength -= 1;
+    }
 
-  return MZ_TRUE;
+    return (bestLength >= DRFS_DEFLATE_MIN_MATCH) ? bestLength : 0;
 }
 
-#endif // #ifndef MINIZ_NO_ARCHIVE_APIS
+static int drfs_deflate_symfreq_compare(const void* a, const void* b)
+{
+    const drfs_deflate_symfreq* pA = a;
+    const drfs_deflate_symfreq* pB = b;
+    if (pA->key != pB->key) {
+        return (pA->key < pB->key) ? -1 : 1;
+    }
 
-#ifdef __cplusplus
+    return (int)pA->symbol - (int)pB->symbol;
 }
-#endif
 
-#endif // MINIZ_HEADER_FILE_ONLY
+// Builds a length limited canonical Huffman code from the given symbol frequencies. The code lengths are calculated in-place
+// with the algorithm by Moffat and Katajainen and then limited by moving codes around until the Kraft sum is satisfied. This
+// is the same approach taken by miniz's compressor.
+static void drfs_deflate_build_code(const unsigned int* pFreq, unsigned int symbolCount, unsigned int maxLength, uint8_t* pLengths, uint16_t* pCodes)
+{
+    assert(symbolCount <= 286);
 
-#if defined(__clang__)
-    #pragma GCC diagnostic pop
-#endif
+    drfs_deflate_symfreq syms[286];
+    unsigned int usedCount = 0;
+    for (unsigned int i = 0; i < symbolCount; ++i) {
+        pLengths[i] = 0;
+        if (pFreq[i] > 0) {
+            syms[usedCount].key    = pFreq[i];
+            syms[usedCount].symbol = (uint16_t)i;
+            usedCount += 1;
+        }
+    }
 
+    // A code with only one symbol is not decodable by all inflaters so always use at least two.
+    for (unsigned int i = 0; usedCount < 2 && i < symbolCount; ++i) {
+        if (pFreq[i] == 0) {
+            syms[usedCount].key    = 1;
+            syms[usedCount].symbol = (uint16_t)i;
+            usedCount += 1;
+        }
+    }
 
+    qsort(syms, usedCount, sizeof(*syms), drfs_deflate_symfreq_compare);
 
 
-typedef struct
-{
-    // The current index of the iterator. When this hits the file count, the iteration is finished.
-    unsigned int index;
+    // Minimum redundancy code lengths.
+    int n = (int)usedCount;
+    syms[0].key += syms[1].key;
+    int root = 0;
+    int leaf = 2;
+    for (int next = 1; next < n - 1; ++next)
+    {
+        if (leaf >= n || syms[root].key < syms[leaf].key) {
+            syms[next].key = syms[root].key;
+            syms[root++].key = (uint32_t)next;
+        } else {
+            syms[next].key = syms[leaf++].key;
+        }
 
-    // The directory being iterated.
-    char directoryPath[DRFS_MAX_PATH];
+        if (leaf >= n || (root < next && syms[root].key < syms[leaf].key)) {
+            syms[next].key += syms[root].key;
+            syms[root++].key = (uint32_t)next;
+        } else {
+            syms[next].key += syms[leaf++].key;
+        }
+    }
 
-}drfs_iterator_zip;
+    syms[n - 2].key = 0;
+    for (int next = n - 3; next >= 0; --next) {
+        syms[next].key = syms[syms[next].key].key + 1;
+    }
 
-typedef struct
-{
-    // The file index within the archive.
-    mz_uint index;
+    int available = 1;
+    int used  = 0;
+    int depth = 0;
+    root = n - 2;
+    int next = n - 1;
+    while (available > 0)
+    {
+        while (root >= 0 && (int)syms[root].key == depth) {
+            used += 1;
+            root -= 1;
+        }
 
-    // A pointer to the buffer containing the entire uncompressed data of the file. Unfortunately this is the only way I'm aware of for
-    // reading file data from miniz.c so we'll just stick with it for now. We use a pointer to an 8-bit type so we can easily calculate
-    // offsets.
-    mz_uint8* pData;
+        while (available > used) {
+            syms[next--].key = (uint32_t)depth;
+            available -= 1;
+        }
 
-    // The size of the file in bytes so we can guard against overflowing reads.
-    size_t sizeInBytes;
+        available = 2*used;
+        depth += 1;
+        used = 0;
+    }
 
-    // The current position of the file's read pointer.
-    size_t readPointer;
 
-}drfs_openedfile_zip;
+    // Length limiting.
+    unsigned int lengthCounts[33];
+    memset(lengthCounts, 0, sizeof(lengthCounts));
+    for (unsigned int i = 0; i < usedCount; ++i) {
+        lengthCounts[(syms[i].key > maxLength) ? maxLength : syms[i].key] += 1;
+    }
 
-static size_t drfs_mz_file_read_func(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n)
-{
-    // The opaque type is a pointer to a drfs_file object which represents the file of the archive.
-    drfs_file* pZipFile = pOpaque;
-    assert(pZipFile != NULL);
+    uint32_t total = 0;
+    for (unsigned int i = 1; i <= maxLength; ++i) {
+        total += lengthCounts[i] << (maxLength - i);
+    }
 
-    if (!drfs_lock(pZipFile)) {
-        return 0;
+    while (total != (1u << maxLength))
+    {
+        lengthCounts[maxLength] -= 1;
+        for (unsigned int i = maxLength - 1; i > 0; --i) {
+            if (lengthCounts[i] > 0) {
+                lengthCounts[i]     -= 1;
+                lengthCounts[i + 1] += 2;
+                break;
+            }
+        }
+
+        total -= 1;
     }
 
-    drfs_seek_nolock(pZipFile, (int64_t)file_ofs, drfs_origin_start);
+    // The symbols are sorted by frequency so the least frequent get the longest codes.
+    unsigned int iSym = 0;
+    for (unsigned int length = maxLength; length > 0; --length) {
+        for (unsigned int i = 0; i < lengthCounts[length]; ++i) {
+            pLengths[syms[iSym++].symbol] = (uint8_t)length;
+        }
+    }
 
-    size_t bytesRead;
-    drfs_result result = drfs_read_nolock(pZipFile, pBuf, (unsigned int)n, &bytesRead);
-    if (result != drfs_success) {
-        // Failed to read the file.
-        bytesRead = 0;
+
+    // Canonical codes. Deflate writes codes starting from the most significant bit so they need to be reversed.
+    unsigned int nextCode[16];
+    unsigned int code = 0;
+    memset(lengthCounts, 0, sizeof(lengthCounts));
+    for (unsigned int i = 0; i < symbolCount; ++i) {
+        lengthCounts[pLengths[i]] += 1;
     }
 
-    drfs_unlock(pZipFile);
-    return (size_t)bytesRead;
-}
+    lengthCounts[0] = 0;
+    for (unsigned int length = 1; length <= 15; ++length) {
+        code = (code + lengthCounts[length - 1]) << 1;
+        nextCode[length] = code;
+    }
 
+    for (unsigned int i = 0; i < symbolCount; ++i)
+    {
+        unsigned int length = pLengths[i];
+        if (length > 0) {
+            unsigned int c = nextCode[length]++;
+            unsigned int reversed = 0;
+            for (unsigned int iBit = 0; iBit < length; ++iBit) {
+                reversed = (reversed << 1) | ((c >> iBit) & 1);
+            }
 
-static bool drfs_is_valid_extension__zip(const char* extension)
-{
-    return drfs__stricmp(extension, "zip") == 0;
+            pCodes[i] = (uint16_t)reversed;
+        }
+    }
 }
 
-static drfs_result drfs_open_archive__zip(drfs_file* pArchiveFile, unsigned int accessMode, drfs_handle* pHandleOut)
+static void drfs_deflate_write_stored_block(drfs_deflate_state* pState, const uint8_t* pData, unsigned int dataSize, bool isFinal)
 {
-    assert(pArchiveFile != NULL);
-    assert(pHandleOut != NULL);
-    assert(drfs_tell(pArchiveFile) == 0);
+    do
+    {
+        unsigned int chunkSize = (dataSize > 65535) ? 65535 : dataSize;
+        bool isLastChunk = chunkSize == dataSize;
 
-    *pHandleOut = NULL;
+        drfs_deflate_put_bits(pState, (isFinal && isLastChunk) ? 1 : 0, 1);
+        drfs_deflate_put_bits(pState, 0, 2);
+        drfs_deflate_align_to_byte(pState);
+        drfs_deflate_put_bits(pState, chunkSize, 16);
+        drfs_deflate_put_bits(pState, ~chunkSize & 0xFFFF, 16);
 
-    // Only support read-only mode at the moment.
-    if ((accessMode & DRFS_WRITE) != 0) {
-        return drfs_permission_denied;
-    }
+        memcpy(pState->output + pState->outputSize, pData, chunkSize);
+        pState->outputSize += chunkSize;
 
+        pData    += chunkSize;
+        dataSize -= chunkSize;
+    } while (dataSize > 0);
+}
 
-    mz_zip_archive* pZip = malloc(sizeof(mz_zip_archive));
-    if (pZip == NULL) {
-        return drfs_out_of_memory;
-    }
+// Encodes the symbols of the current block and writes them to the output buffer, choosing between a dynamic Huffman block
+// and a stored block depending on which is smaller.
+static void drfs_deflate_write_block(drfs_deflate_state* pState, const uint8_t* pBlockData, unsigned int blockSize, bool isFinal)
+{
+    static const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
 
-    memset(pZip, 0, sizeof(mz_zip_archive));
+    uint8_t  litlenLengths[286];
+    uint16_t litlenCodes[286];
+    uint8_t  distLengths[30];
+    uint16_t distCodes[30];
 
-    pZip->m_pRead = drfs_mz_file_read_func;
-    pZip->m_pIO_opaque = pArchiveFile;
-    if (!drfs_mz_zip_reader_init(pZip, drfs_size(pArchiveFile), 0)) {
-        free(pZip);
-        return drfs_invalid_archive;
+    pState->litlenFreq[256] = 1;
+    drfs_deflate_build_code(pState->litlenFreq, 286, 15, litlenLengths, litlenCodes);
+    drfs_deflate_build_code(pState->distFreq,    30, 15, distLengths,   distCodes);
+
+    unsigned int litlenCount = 286;
+    while (litlenCount > 257 && litlenLengths[litlenCount - 1] == 0) {
+        litlenCount -= 1;
     }
 
-    *pHandleOut = pZip;
-    return drfs_success;
-}
+    unsigned int distCount = 30;
+    while (distCount > 1 && distLengths[distCount - 1] == 0) {
+        distCount -= 1;
+    }
 
-static void drfs_close_archive__zip(drfs_handle archive)
-{
-    assert(archive != NULL);
 
-    drfs_mz_zip_reader_end(archive);
-    free(archive);
-}
+    // The code lengths of both codes are run-length encoded as a single sequence.
+    uint8_t lengths[286 + 30];
+    memcpy(lengths, litlenLengths, litlenCount);
+    memcpy(lengths + litlenCount, distLengths, distCount);
+    unsigned int lengthCount = litlenCount + distCount;
 
-static drfs_result drfs_get_file_info__zip(drfs_handle archive, const char* relativePath, drfs_file_info* fi)
-{
-    assert(archive != NULL);
+    uint8_t  rleSymbols[286 + 30];
+    uint8_t  rleExtra[286 + 30];
+    unsigned int rleCount = 0;
+    unsigned int codeLengthFreq[19];
+    memset(codeLengthFreq, 0, sizeof(codeLengthFreq));
 
-    mz_zip_archive* pZip = archive;
-    int fileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
-    if (fileIndex == -1)
+    for (unsigned int i = 0; i < lengthCount; )
     {
-        // We failed to locate the file, but there's a chance it could actually be a folder. Here's the problem - folders
-        // can be named such that they include a trailing slash. We'll want to check for that. Another problem is that
-        // sometimes the folders won't actually be included in the central directory at all which means we need to do a
-        // manual check across every file in the archive.
-        char relativePathWithSlash[DRFS_MAX_PATH];
-        drfs__strcpy_s(relativePathWithSlash, sizeof(relativePathWithSlash), relativePath);
-        drfs__strcat_s(relativePathWithSlash, sizeof(relativePathWithSlash), "/");
-        fileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
-        if (fileIndex == -1)
+        uint8_t length = lengths[i];
+        unsigned int runLength = 1;
+        while (i + runLength < lengthCount && lengths[i + runLength] == length) {
+            runLength += 1;
+        }
+
+        i += runLength;
+
+        if (length == 0)
         {
-            // We still couldn't find the directory even with the trailing slash. There's a chace it's a folder that's
-            // simply not included in the central directory. It's appears the "Send to -> Compressed (zipped) folder"
-            // functionality in Windows does this.
-            mz_uint numFiles = drfs_mz_zip_reader_get_num_files(pZip);
-            for (mz_uint iFile = 0; iFile < numFiles; ++iFile)
-            {
-                char filePath[DRFS_MAX_PATH];
-                if (drfs_mz_zip_reader_get_filename(pZip, iFile, filePath, DRFS_MAX_PATH) > 0)
-                {
-                    if (drfs_drpath_is_child(filePath, relativePath))
-                    {
-                        // This file is within a folder with a path of relativePath which means we can imply that relativePath
-                        // is a folder.
-                        drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), relativePath);
-                        fi->sizeInBytes      = 0;
-                        fi->lastModifiedTime = 0;
-                        fi->attributes       = DRFS_FILE_ATTRIBUTE_READONLY | DRFS_FILE_ATTRIBUTE_DIRECTORY;
-
-                        return drfs_success;
-                    }
-                }
+            while (runLength >= 11) {
+                unsigned int count = (runLength > 138) ? 138 : runLength;
+                rleSymbols[rleCount] = 18; rleExtra[rleCount++] = (uint8_t)(count - 11);
+                runLength -= count;
+            }
+
+            if (runLength >= 3) {
+                rleSymbols[rleCount] = 17; rleExtra[rleCount++] = (uint8_t)(runLength - 3);
+                runLength = 0;
+            }
+        }
+        else
+        {
+            rleSymbols[rleCount] = length; rleExtra[rleCount++] = 0;
+            runLength -= 1;
+
+            while (runLength >= 3) {
+                unsigned int count = (runLength > 6) ? 6 : runLength;
+                rleSymbols[rleCount] = 16; rleExtra[rleCount++] = (uint8_t)(count - 3);
+                runLength -= count;
             }
+        }
 
-            return drfs_does_not_exist;
+        while (runLength > 0) {
+            rleSymbols[rleCount] = length; rleExtra[rleCount++] = 0;
+            runLength -= 1;
         }
     }
 
-    assert(fileIndex != -1);
+    for (unsigned int i = 0; i < rleCount; ++i) {
+        codeLengthFreq[rleSymbols[i]] += 1;
+    }
 
-    if (fi != NULL)
+    uint8_t  codeLengthLengths[19];
+    uint16_t codeLengthCodes[19];
+    drfs_deflate_build_code(codeLengthFreq, 19, 7, codeLengthLengths, codeLengthCodes);
+
+    unsigned int codeLengthCount = 19;
+    while (codeLengthCount > 4 && codeLengthLengths[codeLengthOrder[codeLengthCount - 1]] == 0) {
+        codeLengthCount -= 1;
+    }
+
+
+    // Compare the exact size of the dynamic block against a stored block.
+    uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3*codeLengthCount;
+    for (unsigned int i = 0; i < 19; ++i) {
+        dynamicBits += (uint64_t)codeLengthFreq[i] * codeLengthLengths[i];
+    }
+
+    dynamicBits += codeLengthFreq[16]*2 + codeLengthFreq[17]*3 + codeLengthFreq[18]*7;
+
+    for (unsigned int i = 0; i < 286; ++i) {
+        dynamicBits += (uint64_t)pState->litlenFreq[i] * (litlenLengths[i] + ((i > 256) ? s_length_extra[i - 257] : 0));
+    }
+
+    for (unsigned int i = 0; i < 30; ++i) {
+        dynamicBits += (uint64_t)pState->distFreq[i] * (distLengths[i] + s_dist_extra[i]);
+    }
+
+    uint64_t storedBits = ((uint64_t)blockSize + 5 * (blockSize/65535 + 1)) * 8 + 7;
+    if (storedBits <= dynamicBits) {
+        drfs_deflate_write_stored_block(pState, pBlockData, blockSize, isFinal);
+        return;
+    }
+
+
+    drfs_deflate_put_bits(pState, isFinal ? 1 : 0, 1);
+    drfs_deflate_put_bits(pState, 2, 2);
+    drfs_deflate_put_bits(pState, litlenCount - 257, 5);
+    drfs_deflate_put_bits(pState, distCount - 1, 5);
+    drfs_deflate_put_bits(pState, codeLengthCount - 4, 4);
+
+    for (unsigned int i = 0; i < codeLengthCount; ++i) {
+        drfs_deflate_put_bits(pState, codeLengthLengths[codeLengthOrder[i]], 3);
+    }
+
+    for (unsigned int i = 0; i < rleCount; ++i)
     {
-        mz_zip_archive_file_stat zipStat;
-        if (drfs_mz_zip_reader_file_stat(pZip, (mz_uint)fileIndex, &zipStat))
-        {
-            drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), relativePath);
-            fi->sizeInBytes      = zipStat.m_uncomp_size;
-            fi->lastModifiedTime = (uint64_t)zipStat.m_time;
-            fi->attributes       = DRFS_FILE_ATTRIBUTE_READONLY;
-            if (drfs_mz_zip_reader_is_file_a_directory(pZip, (mz_uint)fileIndex)) {
-                fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
-            }
+        uint8_t symbol = rleSymbols[i];
+        drfs_deflate_put_bits(pState, codeLengthCodes[symbol], codeLengthLengths[symbol]);
+        if (symbol == 16) {
+            drfs_deflate_put_bits(pState, rleExtra[i], 2);
+        } else if (symbol == 17) {
+            drfs_deflate_put_bits(pState, rleExtra[i], 3);
+        } else if (symbol == 18) {
+            drfs_deflate_put_bits(pState, rleExtra[i], 7);
+        }
+    }
 
-            return drfs_success;
+    for (unsigned int i = 0; i < pState->symbolCount; ++i)
+    {
+        drfs_deflate_symbol symbol = pState->symbols[i];
+        if (symbol.dist == 0) {
+            drfs_deflate_put_bits(pState, litlenCodes[symbol.litlen], litlenLengths[symbol.litlen]);
+        } else {
+            unsigned int lengthCode = pState->lengthCodes[symbol.litlen];
+            drfs_deflate_put_bits(pState, litlenCodes[257 + lengthCode], litlenLengths[257 + lengthCode]);
+            drfs_deflate_put_bits(pState, symbol.litlen - s_length_base[lengthCode], s_length_extra[lengthCode]);
+
+            unsigned int distCode = drfs_deflate_dist_code(symbol.dist);
+            drfs_deflate_put_bits(pState, distCodes[distCode], distLengths[distCode]);
+            drfs_deflate_put_bits(pState, symbol.dist - s_dist_base[distCode], s_dist_extra[distCode]);
         }
     }
 
-    return drfs_success;
+    drfs_deflate_put_bits(pState, litlenCodes[256], litlenLengths[256]);
 }
 
-static drfs_handle drfs_begin_iteration__zip(drfs_handle archive, const char* relativePath)
+// Compresses everything in the buffer that has not yet been compressed and writes it to the file.
+static drfs_result drfs_deflate_compress_block(drfs_file* pFile, drfs_deflate_state* pState, bool isFinal)
 {
-    assert(relativePath != NULL);
-
-    mz_zip_archive* pZip = archive;
-    assert(pZip != NULL);
+    assert(pFile != NULL);
+    assert(pState != NULL);
 
-    int directoryFileIndex = -1;
-    if (relativePath[0] == '\0') {
-        directoryFileIndex = 0;
-    } else {
-        directoryFileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
-    }
+    pState->symbolCount = 0;
+    memset(pState->litlenFreq, 0, sizeof(pState->litlenFreq));
+    memset(pState->distFreq,   0, sizeof(pState->distFreq));
 
-    if (directoryFileIndex == -1)
+    unsigned int pos = pState->blockStart;
+    while (pos < pState->bufferSize)
     {
-        // The same issue applies here as documented in drfs_get_file_info__zip().
-        char relativePathWithSlash[DRFS_MAX_PATH];
-        drfs__strcpy_s(relativePathWithSlash, sizeof(relativePathWithSlash), relativePath);
-        drfs__strcat_s(relativePathWithSlash, sizeof(relativePathWithSlash), "/");
-        directoryFileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
-        if (directoryFileIndex == -1)
+        drfs_deflate_insert_up_to(pState, pos);
+
+        unsigned int dist = 0;
+        unsigned int length = drfs_deflate_find_match(pState, pos, DRFS_DEFLATE_MAX_CHAIN, &dist);
+
+        // Lazy matching. If the next byte starts a longer match, emit this byte as a literal and use that instead.
+        if (length > 0 && length < DRFS_DEFLATE_LAZY_LENGTH && pos + 1 < pState->bufferSize)
         {
-            // We still couldn't find the directory even with the trailing slash. There's a chace it's a folder that's
-            // simply not included in the central directory. It's appears the "Send to -> Compressed (zipped) folder"
-            // functionality in Windows does this.
-            mz_uint numFiles = drfs_mz_zip_reader_get_num_files(pZip);
-            for (mz_uint iFile = 0; iFile < numFiles; ++iFile)
-            {
-                char filePath[DRFS_MAX_PATH];
-                if (drfs_mz_zip_reader_get_filename(pZip, iFile, filePath, DRFS_MAX_PATH) > 0)
-                {
-                    if (drfs_drpath_is_child(filePath, relativePath))
-                    {
-                        // This file is within a folder with a path of relativePath which means we can imply that relativePath
-                        // is a folder.
-                        goto on_success;
-                    }
-                }
+            drfs_deflate_insert_up_to(pState, pos + 1);
+
+            unsigned int nextDist = 0;
+            unsigned int nextLength = drfs_deflate_find_match(pState, pos + 1, (length >= DRFS_DEFLATE_GOOD_LENGTH) ? DRFS_DEFLATE_MAX_CHAIN/4 : DRFS_DEFLATE_MAX_CHAIN, &nextDist);
+            if (nextLength > length) {
+                uint8_t literal = pState->buffer[pos];
+                pState->symbols[pState->symbolCount].litlen = literal;
+                pState->symbols[pState->symbolCount].dist   = 0;
+                pState->symbolCount += 1;
+                pState->litlenFreq[literal] += 1;
+
+                pos   += 1;
+                length = nextLength;
+                dist   = nextDist;
             }
+        }
 
-            return NULL;
+        if (length > 0) {
+            pState->symbols[pState->symbolCount].litlen = (uint16_t)length;
+            pState->symbols[pState->symbolCount].dist   = (uint16_t)dist;
+            pState->symbolCount += 1;
+            pState->litlenFreq[257 + pState->lengthCodes[length]] += 1;
+            pState->distFreq[drfs_deflate_dist_code(dist)] += 1;
+            pos += length;
+        } else {
+            uint8_t literal = pState->buffer[pos];
+            pState->symbols[pState->symbolCount].litlen = literal;
+            pState->symbols[pState->symbolCount].dist   = 0;
+            pState->symbolCount += 1;
+            pState->litlenFreq[literal] += 1;
+            pos += 1;
         }
     }
 
+    drfs_deflate_write_block(pState, pState->buffer + pState->blockStart, pState->bufferSize - pState->blockStart, isFinal);
+    pState->blockStart = pState->bufferSize;
+
+    if (isFinal) {
+        drfs_deflate_align_to_byte(pState);
+    }
 
+    drfs_result result = drfs_compressed_stream_write_raw(pFile, pState->output, pState->outputSize);
+    pState->outputSize = 0;
 
-on_success:;
-    drfs_iterator_zip* pZipIterator = malloc(sizeof(drfs_iterator_zip));
-    if (pZipIterator != NULL)
+
+    // Slide the window once the buffer is full. The slide amount is always a multiple of the window size so positions keep
+    // the same slot in the prev table.
+    if (pState->bufferSize == DRFS_DEFLATE_BUFFER_SIZE)
     {
-        pZipIterator->index = 0;
-        drfs__strcpy_s(pZipIterator->directoryPath, sizeof(pZipIterator->directoryPath), relativePath);
-    }
+        const unsigned int slide = DRFS_DEFLATE_BUFFER_SIZE - DRFS_DEFLATE_WINDOW_SIZE;
+        memmove(pState->buffer, pState->buffer + slide, DRFS_DEFLATE_WINDOW_SIZE);
 
-    return pZipIterator;
-}
+        for (unsigned int i = 0; i < DRFS_DEFLATE_HASH_SIZE; ++i) {
+            pState->head[i] = (pState->head[i] >= (int32_t)slide) ? pState->head[i] - (int32_t)slide : -1;
+        }
 
-static void drfs_end_iteration__zip(drfs_handle archive, drfs_handle iterator)
-{
-    (void)archive;
-    assert(archive != NULL);
-    assert(iterator != NULL);
+        for (unsigned int i = 0; i < DRFS_DEFLATE_WINDOW_SIZE; ++i) {
+            pState->prev[i] = (pState->prev[i] >= (int32_t)slide) ? pState->prev[i] - (int32_t)slide : -1;
+        }
+
+        pState->bufferSize -= slide;
+        pState->blockStart -= slide;
+        pState->insertPos  -= slide;
+    }
 
-    free(iterator);
+    return result;
 }
 
-static bool drfs_next_iteration__zip(drfs_handle archive, drfs_handle iterator, drfs_file_info* fi)
-{
-    (void)archive;
-    assert(archive != NULL);
-    assert(iterator != NULL);
 
-    drfs_iterator_zip* pZipIterator = iterator;
-    if (pZipIterator == NULL) {
-        return false;
+static drfs_result drfs_begin_compressed_write_stream(drfs_file* pFile, drfs_compressed_stream* pStream)
+{
+    drfs_deflate_state* pState = DRFS_MALLOC(sizeof(*pState));
+    if (pState == NULL) {
+        return drfs_out_of_memory;
     }
 
-    mz_zip_archive* pZip = archive;
-    while (pZipIterator->index < drfs_mz_zip_reader_get_num_files(pZip))
-    {
-        unsigned int iFile = pZipIterator->index++;
+    pState->bufferSize  = 0;
+    pState->blockStart  = 0;
+    pState->insertPos   = 0;
+    pState->symbolCount = 0;
+    pState->bitBuffer   = 0;
+    pState->bitCount    = 0;
+    pState->outputSize  = 0;
+    memset(pState->head, 0xFF, sizeof(pState->head));
+    memset(pState->prev, 0xFF, sizeof(pState->prev));
 
-        char filePath[DRFS_MAX_PATH];
-        if (drfs_mz_zip_reader_get_filename(pZip, iFile, filePath, DRFS_MAX_PATH) > 0)
-        {
-            if (drfs_drpath_is_child(filePath, pZipIterator->directoryPath))
-            {
-                if (fi != NULL)
-                {
-                    mz_zip_archive_file_stat zipStat;
-                    if (drfs_mz_zip_reader_file_stat(pZip, iFile, &zipStat))
-                    {
-                        drfs__strcpy_s(fi->absolutePath, sizeof(fi->absolutePath), filePath);
-                        fi->sizeInBytes      = zipStat.m_uncomp_size;
-                        fi->lastModifiedTime = (uint64_t)zipStat.m_time;
-                        fi->attributes       = DRFS_FILE_ATTRIBUTE_READONLY;
-                        if (drfs_mz_zip_reader_is_file_a_directory(pZip, iFile)) {
-                            fi->attributes |= DRFS_FILE_ATTRIBUTE_DIRECTORY;
-                        }
+    for (unsigned int code = 0; code < 28; ++code) {
+        for (int i = 0; i < (1 << s_length_extra[code]); ++i) {
+            pState->lengthCodes[s_length_base[code] + i] = (uint8_t)code;
+        }
+    }
 
-                        // If we have a directory we need to ensure we don't have a trailing slash.
-                        if ((fi->attributes & DRFS_FILE_ATTRIBUTE_DIRECTORY) != 0) {
-                            size_t absolutePathLen = strlen(fi->absolutePath);
-                            if (absolutePathLen > 0 && (fi->absolutePath[absolutePathLen - 1] == '/' || fi->absolutePath[absolutePathLen - 1] == '\\')) {
-                                fi->absolutePath[absolutePathLen - 1] = '\0';
-                            }
-                        }
-                    }
-                }
+    pState->lengthCodes[DRFS_DEFLATE_MAX_MATCH] = 28;
 
-                return true;
-            }
-        }
+
+    // The gzip header. No optional fields, no timestamp and an unknown OS.
+    static const uint8_t header[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+    drfs_result result = drfs_compressed_stream_write_raw(pFile, header, sizeof(header));
+    if (result != drfs_success) {
+        DRFS_FREE(pState);
+        return result;
     }
 
-    return false;
+    pStream->pDeflate = pState;
+    return drfs_success;
 }
 
-static drfs_result drfs_open_file__zip(drfs_handle archive, const char* relativePath, unsigned int accessMode, drfs_handle* pHandleOut)
+static drfs_result drfs_begin_compressed_read_stream(drfs_file* pFile, drfs_compressed_stream* pStream)
 {
-    assert(archive != NULL);
-    assert(pHandleOut != NULL);
-    assert(relativePath != NULL);
+    uint64_t fileSize = pFile->pArchive->callbacks.file_size(pFile->pArchive->internalArchiveHandle, pFile->internalFileHandle);
+
+    uint8_t header[10];
+    size_t bytesRead = 0;
+    drfs_result result = drfs_compressed_stream_read_raw(pFile, header, sizeof(header), &bytesRead);
+    if (result != drfs_success) {
+        return result;
+    }
 
-    *pHandleOut = NULL;
+    if (fileSize < 18 || bytesRead != sizeof(header) || header[0] != 0x1F || header[1] != 0x8B || header[2] != 8) {
+        return drfs_invalid_archive;
+    }
 
-    // Only supporting read-only for now.
-    if ((accessMode & DRFS_WRITE) != 0) {
-        return drfs_permission_denied;
+    // Skip past the optional fields.
+    uint64_t position = sizeof(header);
+    uint8_t flags = header[3];
+    if ((flags & 0x04) != 0) {   // FEXTRA
+        uint8_t extraSize[2];
+        if (drfs_compressed_stream_read_raw(pFile, extraSize, 2, &bytesRead) != drfs_success || bytesRead != 2) {
+            return drfs_invalid_archive;
+        }
+
+        position += 2 + (extraSize[0] | (extraSize[1] << 8));
+        drfs_compressed_stream_seek_raw(pFile, position);
     }
 
+    for (int iString = 0; iString < 2; ++iString) {
+        if ((flags & ((iString == 0) ? 0x08 : 0x10)) != 0) {   // FNAME, FCOMMENT
+            uint8_t c;
+            do {
+                if (drfs_compressed_stream_read_raw(pFile, &c, 1, &bytesRead) != drfs_success || bytesRead != 1) {
+                    return drfs_invalid_archive;
+                }
 
-    mz_zip_archive* pZip = archive;
-    int fileIndex = drfs_mz_zip_reader_locate_file(pZip, relativePath, NULL, MZ_ZIP_FLAG_CASE_SENSITIVE);
-    if (fileIndex == -1) {
-        return drfs_does_not_exist;
+                position += 1;
+            } while (c != '\0');
+        }
     }
 
-    drfs_openedfile_zip* pOpenedFile = malloc(sizeof(*pOpenedFile));
-    if (pOpenedFile == NULL) {
-        return drfs_out_of_memory;
+    if ((flags & 0x02) != 0) {   // FHCRC
+        position += 2;
     }
 
-    pOpenedFile->pData = drfs_mz_zip_reader_extract_to_heap(pZip, (mz_uint)fileIndex, &pOpenedFile->sizeInBytes, 0);
-    if (pOpenedFile->pData == NULL) {
-        free(pOpenedFile);
-        return drfs_unknown_error;
+    if (position + 8 > fileSize) {
+        return drfs_invalid_archive;
     }
 
-    pOpenedFile->index = (mz_uint)fileIndex;
-    pOpenedFile->readPointer = 0;
+    // The trailer contains the CRC-32 and size of the uncompressed data.
+    uint8_t trailer[8];
+    drfs_compressed_stream_seek_raw(pFile, fileSize - 8);
+    if (drfs_compressed_stream_read_raw(pFile, trailer, sizeof(trailer), &bytesRead) != drfs_success || bytesRead != sizeof(trailer)) {
+        return drfs_invalid_archive;
+    }
 
-    *pHandleOut = pOpenedFile;
-    return drfs_success;
-}
+    result = drfs_compressed_stream_seek_raw(pFile, position);
+    if (result != drfs_success) {
+        return result;
+    }
 
-static void drfs_close_file__zip(drfs_handle archive, drfs_handle file)
-{
-    drfs_openedfile_zip* pOpenedFile = file;
-    assert(pOpenedFile != NULL);
 
-    mz_zip_archive* pZip = archive;
-    assert(pZip != NULL);
+    drfs_inflate_state* pState = DRFS_MALLOC(sizeof(*pState));
+    if (pState == NULL) {
+        return drfs_out_of_memory;
+    }
 
-    pZip->m_pFree(pZip->m_pAlloc_opaque, pOpenedFile->pData);
-    free(pOpenedFile);
+    tinfl_init(&pState->decompressor);
+    pState->inputPos         = 0;
+    pState->inputSize        = 0;
+    pState->isInputExhausted = false;
+    pState->dictionaryPos    = 0;
+    pState->pendingPos       = 0;
+    pState->pendingSize      = 0;
+    pState->isAtEnd          = false;
+    pState->expectedCRC32    = (mz_ulong)MZ_READ_LE32(trailer);
+
+    pStream->pInflate          = pState;
+    pStream->compressedDataPos = position;
+    pStream->uncompressedSize  = (uint64_t)MZ_READ_LE32(trailer + 4);
+    return drfs_success;
 }
 
-static drfs_result drfs_read_file__zip(drfs_handle archive, drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
+static drfs_result drfs_begin_compressed_stream(drfs_file* pFile, unsigned int accessMode)
 {
-    (void)archive;
-    assert(archive != NULL);
-    assert(file != NULL);
-    assert(pDataOut != NULL);
-    assert(bytesToRead > 0);
+    assert(pFile != NULL);
 
-    drfs_openedfile_zip* pOpenedFile = file;
-    if (pOpenedFile == NULL) {
+    // Compressed streams can't be read and written at the same time.
+    if ((accessMode & DRFS_READ) != 0 && (accessMode & DRFS_WRITE) != 0) {
         return drfs_invalid_args;
     }
 
-    size_t bytesAvailable = pOpenedFile->sizeInBytes - pOpenedFile->readPointer;
-    if (bytesAvailable < bytesToRead) {
-        bytesToRead = bytesAvailable;
-    }
-
-    if (bytesToRead == 0) {
-        return drfs_at_end_of_file;   // Nothing left to read.
+    drfs_compressed_stream* pStream = DRFS_MALLOC(sizeof(*pStream));
+    if (pStream == NULL) {
+        return drfs_out_of_memory;
     }
 
+    pStream->pDeflate          = NULL;
+    pStream->pInflate          = NULL;
+    pStream->compressedDataPos = 0;
+    pStream->uncompressedSize  = 0;
+    pStream->position          = 0;
+    pStream->crc32             = MZ_CRC32_INIT;
 
-    memcpy(pDataOut, pOpenedFile->pData + pOpenedFile->readPointer, bytesToRead);
-    pOpenedFile->readPointer += bytesToRead;
+    drfs_result result;
+    if ((accessMode & DRFS_WRITE) != 0) {
+        result = drfs_begin_compressed_write_stream(pFile, pStream);
+    } else {
+        result = drfs_begin_compressed_read_stream(pFile, pStream);
+        if (result == drfs_invalid_archive) {
+            // The file is not compressed so it's read as-is. This allows compression to be enabled for files that were
+            // previously written uncompressed without breaking anything.
+            DRFS_FREE(pStream);
+            return drfs_compressed_stream_seek_raw(pFile, 0);
+        }
+    }
 
-    if (pBytesReadOut) {
-        *pBytesReadOut = bytesToRead;
+    if (result != drfs_success) {
+        DRFS_FREE(pStream);
+        return result;
     }
 
+    pFile->pCompressedStream = pStream;
     return drfs_success;
 }
 
-static drfs_result drfs_write_file__zip(drfs_handle archive, drfs_handle file, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+static drfs_result drfs_end_compressed_stream(drfs_file* pFile)
 {
-    (void)archive;
-    (void)file;
-    (void)pData;
-    (void)bytesToWrite;
+    assert(pFile != NULL);
 
-    assert(archive != NULL);
-    assert(file != NULL);
-    assert(pData != NULL);
-    assert(bytesToWrite > 0);
+    drfs_compressed_stream* pStream = pFile->pCompressedStream;
+    if (pStream == NULL) {
+        return drfs_success;
+    }
 
-    // All files are read-only for now.
-    if (pBytesWrittenOut) {
-        *pBytesWrittenOut = 0;
+    drfs_result result = drfs_success;
+    if (pStream->pDeflate != NULL)
+    {
+        result = drfs_deflate_compress_block(pFile, pStream->pDeflate, true);
+        if (result == drfs_success) {
+            uint8_t trailer[8];
+            for (int i = 0; i < 4; ++i) {
+                trailer[i]     = (uint8_t)(pStream->crc32 >> (i*8));
+                trailer[i + 4] = (uint8_t)(pStream->uncompressedSize >> (i*8));
+            }
+
+            result = drfs_compressed_stream_write_raw(pFile, trailer, sizeof(trailer));
+        }
     }
 
-    return drfs_permission_denied;
+    DRFS_FREE(pStream->pDeflate);
+    DRFS_FREE(pStream->pInflate);
+    DRFS_FREE(pStream);
+
+    pFile->pCompressedStream = NULL;
+    return result;
 }
 
-static drfs_result drfs_seek_file__zip(drfs_handle archive, drfs_handle file, int64_t bytesToSeek, drfs_seek_origin origin)
+static drfs_result drfs_read_compressed_stream(drfs_file* pFile, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
 {
-    (void)archive;
+    assert(pFile != NULL);
+    assert(pFile->pCompressedStream != NULL);
 
-    assert(archive != NULL);
-    assert(file != NULL);
-
-    drfs_openedfile_zip* pOpenedFile = file;
-    if (pOpenedFile == NULL) {
-        return drfs_invalid_args;
+    drfs_compressed_stream* pStream = pFile->pCompressedStream;
+    drfs_inflate_state* pState = pStream->pInflate;
+    if (pState == NULL) {
+        return drfs_permission_denied;
     }
 
-    uint64_t newPos = pOpenedFile->readPointer;
-    if (origin == drfs_origin_current)
+    drfs_result result = drfs_success;
+    size_t totalBytesRead = 0;
+    while (totalBytesRead < bytesToRead)
     {
-        if ((int64_t)newPos + bytesToSeek >= 0)
+        if (pState->pendingSize > 0)
         {
-            newPos = (uint64_t)((int64_t)newPos + bytesToSeek);
+            size_t bytesToCopy = bytesToRead - totalBytesRead;
+            if (bytesToCopy > pState->pendingSize) {
+                bytesToCopy = pState->pendingSize;
+            }
+
+            memcpy((uint8_t*)pDataOut + totalBytesRead, pState->dictionary + pState->pendingPos, bytesToCopy);
+            pState->pendingPos  += bytesToCopy;
+            pState->pendingSize -= bytesToCopy;
+            totalBytesRead      += bytesToCopy;
+            continue;
         }
-        else
+
+        if (pState->isAtEnd) {
+            break;
+        }
+
+        if (pState->inputPos == pState->inputSize && !pState->isInputExhausted)
         {
-            // Trying to seek to before the beginning of the file.
-            return drfs_invalid_args;
+            size_t bytesRead = 0;
+            result = drfs_compressed_stream_read_raw(pFile, pState->input, sizeof(pState->input), &bytesRead);
+            if (result != drfs_success) {
+                break;
+            }
+
+            pState->inputPos  = 0;
+            pState->inputSize = bytesRead;
+            pState->isInputExhausted = bytesRead < sizeof(pState->input);
+        }
+
+        size_t inputBytes  = pState->inputSize - pState->inputPos;
+        size_t outputBytes = TINFL_LZ_DICT_SIZE - pState->dictionaryPos;
+        tinfl_status status = drfs_tinfl_decompress(&pState->decompressor, pState->input + pState->inputPos, &inputBytes, pState->dictionary, pState->dictionary + pState->dictionaryPos, &outputBytes, pState->isInputExhausted ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+
+        pState->inputPos     += inputBytes;
+        pState->pendingPos    = pState->dictionaryPos;
+        pState->pendingSize   = outputBytes;
+        pState->dictionaryPos = (pState->dictionaryPos + outputBytes) & (TINFL_LZ_DICT_SIZE - 1);
+        pStream->crc32 = drfs_mz_crc32(pStream->crc32, pState->dictionary + pState->pendingPos, outputBytes);
+
+        if (status == TINFL_STATUS_DONE) {
+            pState->isAtEnd = true;
+            if (pStream->crc32 != pState->expectedCRC32) {
+                result = drfs_invalid_archive;
+                break;
+            }
+        } else if (status < 0 || (status == TINFL_STATUS_NEEDS_MORE_INPUT && pState->isInputExhausted)) {
+            result = drfs_invalid_archive;
+            break;
         }
     }
-    else if (origin == drfs_origin_start)
-    {
-        assert(bytesToSeek >= 0);
-        newPos = (uint64_t)bytesToSeek;
+
+    pStream->position += totalBytesRead;
+
+    if (pBytesReadOut) {
+        *pBytesReadOut = totalBytesRead;
     }
-    else if (origin == drfs_origin_end)
+
+    return result;
+}
+
+static drfs_result drfs_write_compressed_stream(drfs_file* pFile, const void* pData, size_t bytesToWrite, size_t* pBytesWrittenOut)
+{
+    assert(pFile != NULL);
+    assert(pFile->pCompressedStream != NULL);
+
+    drfs_compressed_stream* pStream = pFile->pCompressedStream;
+    drfs_deflate_state* pState = pStream->pDeflate;
+    if (pState == NULL) {
+        return drfs_permission_denied;
+    }
+
+    const uint8_t* pRunningData = pData;
+    size_t bytesRemaining = bytesToWrite;
+    while (bytesRemaining > 0)
     {
-        assert(bytesToSeek >= 0);
-        if ((uint64_t)bytesToSeek <= pOpenedFile->sizeInBytes)
-        {
-            newPos = pOpenedFile->sizeInBytes - (uint64_t)bytesToSeek;
+        // Data is compressed in blocks, each of which can refer back to the window that precedes it.
+        size_t bytesToCopy = DRFS_DEFLATE_BLOCK_SIZE - (pState->bufferSize - pState->blockStart);
+        if (bytesToCopy > DRFS_DEFLATE_BUFFER_SIZE - pState->bufferSize) {
+            bytesToCopy = DRFS_DEFLATE_BUFFER_SIZE - pState->bufferSize;
         }
-        else
-        {
-            // Trying to seek to before the beginning of the file.
-            return drfs_invalid_args;
+        if (bytesToCopy > bytesRemaining) {
+            bytesToCopy = bytesRemaining;
+        }
+
+        memcpy(pState->buffer + pState->bufferSize, pRunningData, bytesToCopy);
+        pStream->crc32      = drfs_mz_crc32(pStream->crc32, pRunningData, bytesToCopy);
+        pState->bufferSize += (unsigned int)bytesToCopy;
+        pRunningData       += bytesToCopy;
+        bytesRemaining     -= bytesToCopy;
+
+        if (pState->bufferSize - pState->blockStart == DRFS_DEFLATE_BLOCK_SIZE || pState->bufferSize == DRFS_DEFLATE_BUFFER_SIZE) {
+            drfs_result result = drfs_deflate_compress_block(pFile, pState, false);
+            if (result != drfs_success) {
+                return result;
+            }
         }
-    }
-    else
-    {
-        // Should never get here.
-        return drfs_unknown_error;
     }
 
+    pStream->uncompressedSize += bytesToWrite;
+    pStream->position         += bytesToWrite;
 
-    if (newPos > pOpenedFile->sizeInBytes) {
-        return drfs_invalid_args;
+    if (pBytesWrittenOut) {
+        *pBytesWrittenOut = bytesToWrite;
     }
 
-    pOpenedFile->readPointer = (size_t)newPos;
     return drfs_success;
 }
 
-static uint64_t drfs_tell_file__zip(drfs_handle archive, drfs_handle file)
+static drfs_result drfs_seek_compressed_stream(drfs_file* pFile, int64_t bytesToSeek, drfs_seek_origin origin)
 {
-    (void)archive;
+    assert(pFile != NULL);
+    assert(pFile->pCompressedStream != NULL);
 
-    drfs_openedfile_zip* pOpenedFile = file;
-    assert(pOpenedFile != NULL);
+    drfs_compressed_stream* pStream = pFile->pCompressedStream;
 
-    return pOpenedFile->readPointer;
-}
+    int64_t target = bytesToSeek;
+    if (origin == drfs_origin_current) {
+        target += (int64_t)pStream->position;
+    } else if (origin == drfs_origin_end) {
+        target += (int64_t)pStream->uncompressedSize;
+    }
 
-static uint64_t drfs_file_size__zip(drfs_handle archive, drfs_handle file)
-{
-    (void)archive;
+    if (target < 0) {
+        return drfs_invalid_args;
+    }
 
-    drfs_openedfile_zip* pOpenedFile = file;
-    assert(pOpenedFile != NULL);
+    if ((uint64_t)target == pStream->position) {
+        return drfs_success;
+    }
 
-    return pOpenedFile->sizeInBytes;
-}
+    // Compressed data can only be written sequentially.
+    drfs_inflate_state* pState = pStream->pInflate;
+    if (pState == NULL) {
+        return drfs_invalid_args;
+    }
 
-static void drfs_flush__zip(drfs_handle archive, drfs_handle file)
-{
-    (void)archive;
-    (void)file;
+    // Seeking backwards restarts decompression from the beginning. Seeking forwards decompresses and discards.
+    if ((uint64_t)target < pStream->position)
+    {
+        drfs_result result = drfs_compressed_stream_seek_raw(pFile, pStream->compressedDataPos);
+        if (result != drfs_success) {
+            return result;
+        }
 
-    assert(archive != NULL);
-    assert(file != NULL);
+        tinfl_init(&pState->decompressor);
+        pState->inputPos         = 0;
+        pState->inputSize        = 0;
+        pState->isInputExhausted = false;
+        pState->dictionaryPos    = 0;
+        pState->pendingSize      = 0;
+        pState->isAtEnd          = false;
+        pStream->position        = 0;
+        pStream->crc32           = MZ_CRC32_INIT;
+    }
 
-    // All files are read-only for now.
+    while (pStream->position < (uint64_t)target)
+    {
+        uint8_t discard[4096];
+        size_t bytesToDiscard = sizeof(discard);
+        if (bytesToDiscard > (uint64_t)target - pStream->position) {
+            bytesToDiscard = (size_t)((uint64_t)target - pStream->position);
+        }
+
+        size_t bytesRead;
+        drfs_result result = drfs_read_compressed_stream(pFile, discard, bytesToDiscard, &bytesRead);
+        if (result != drfs_success) {
+            return result;
+        }
+
+        if (bytesRead == 0) {
+            return drfs_at_end_of_file;
+        }
+    }
+
+    return drfs_success;
 }
 
+static uint64_t drfs_tell_compressed_stream(drfs_file* pFile)
+{
+    assert(pFile != NULL);
+    assert(pFile->pCompressedStream != NULL);
 
-static void drfs_register_zip_backend(drfs_context* pContext)
+    return ((drfs_compressed_stream*)pFile->pCompressedStream)->position;
+}
+
+static uint64_t drfs_size_compressed_stream(drfs_file* pFile)
 {
-    if (pContext == NULL) {
-        return;
-    }
+    assert(pFile != NULL);
+    assert(pFile->pCompressedStream != NULL);
 
-    drfs_archive_callbacks callbacks;
-    callbacks.is_valid_extension = drfs_is_valid_extension__zip;
-    callbacks.open_archive       = drfs_open_archive__zip;
-    callbacks.close_archive      = drfs_close_archive__zip;
-    callbacks.get_file_info      = drfs_get_file_info__zip;
-    callbacks.begin_iteration    = drfs_begin_iteration__zip;
-    callbacks.end_iteration      = drfs_end_iteration__zip;
-    callbacks.next_iteration     = drfs_next_iteration__zip;
-    callbacks.delete_file        = NULL;
-    callbacks.rename_file        = NULL;
-    callbacks.create_directory   = NULL;
-    callbacks.copy_file          = NULL;
-    callbacks.open_file          = drfs_open_file__zip;
-    callbacks.close_file         = drfs_close_file__zip;
-    callbacks.read_file          = drfs_read_file__zip;
-    callbacks.write_file         = drfs_write_file__zip;
-    callbacks.seek_file          = drfs_seek_file__zip;
-    callbacks.tell_file          = drfs_tell_file__zip;
-    callbacks.file_size          = drfs_file_size__zip;
-    callbacks.flush_file         = drfs_flush__zip;
-    drfs_register_archive_backend(pContext, callbacks);
+    return ((drfs_compressed_stream*)pFile->pCompressedStream)->uncompressedSize;
 }
 #endif  //DR_FS_NO_ZIP
 
@@ -6752,6 +9457,9 @@ typedef struct
     // A pointer to the buffer containing the file information. The number of items in this array is equal to directoryLength / 64.
     drfs_file_pak* pFiles;
 
+    // The pool that drfs_openedfile_pak objects are allocated from.
+    drfs_pool openedFilePool;
+
 }drfs_archive_pak;
 
 
@@ -6777,7 +9485,7 @@ static bool drfs_iterator_pak_append_processed_dir(drfs_iterator_pak* pIterator,
     if (pIterator != NULL && path != NULL)
     {
         drfs_path_pak* pOldBuffer = pIterator->pProcessedDirs;
-        drfs_path_pak* pNewBuffer = malloc(sizeof(drfs_path_pak) * (pIterator->processedDirCount + 1));
+        drfs_path_pak* pNewBuffer = DRFS_MALLOC(sizeof(drfs_path_pak) * (pIterator->processedDirCount + 1));
 
         if (pNewBuffer != 0)
         {
@@ -6832,7 +9540,7 @@ typedef struct
 
 static drfs_archive_pak* drfs_pak_create(drfs_file* pArchiveFile, unsigned int accessMode)
 {
-    drfs_archive_pak* pak = malloc(sizeof(*pak));
+    drfs_archive_pak* pak = DRFS_MALLOC(sizeof(*pak));
     if (pak != NULL)
     {
         pak->pArchiveFile    = pArchiveFile;
@@ -6840,6 +9548,7 @@ static drfs_archive_pak* drfs_pak_create(drfs_file* pArchiveFile, unsigned int a
         pak->directoryLength = 0;
         pak->accessMode      = accessMode;
         pak->pFiles          = NULL;
+        drfs_pool_init(&pak->openedFilePool, sizeof(drfs_openedfile_pak), 32);
     }
 
     return pak;
@@ -6847,8 +9556,9 @@ static drfs_archive_pak* drfs_pak_create(drfs_file* pArchiveFile, unsigned int a
 
 static void drfs_pak_delete(drfs_archive_pak* pArchive)
 {
-    free(pArchive->pFiles);
-    free(pArchive);
+    drfs_pool_uninit(&pArchive->openedFilePool, NULL);
+    DRFS_FREE(pArchive->pFiles);
+    DRFS_FREE(pArchive);
 }
 
 
@@ -6894,7 +9604,7 @@ static drfs_result drfs_open_archive__pak(drfs_file* pArchiveFile, unsigned int
                             {
                                 assert((sizeof(drfs_file_pak) * fileCount) == pak->directoryLength);
 
-                                pak->pFiles = malloc(pak->directoryLength);
+                                pak->pFiles = DRFS_MALLOC(pak->directoryLength);
                                 if (pak->pFiles != NULL)
                                 {
                                     // Seek to the directory listing before trying to read it.
@@ -7025,7 +9735,7 @@ static drfs_handle drfs_begin_iteration__pak(drfs_handle archive, const char* re
     (void)archive;
     assert(relativePath != NULL);
 
-    drfs_iterator_pak* pIterator = malloc(sizeof(drfs_iterator_pak));
+    drfs_iterator_pak* pIterator = DRFS_MALLOC(sizeof(drfs_iterator_pak));
     if (pIterator != NULL)
     {
         pIterator->index = 0;
@@ -7044,7 +9754,7 @@ static void drfs_end_iteration__pak(drfs_handle archive, drfs_handle iterator)
     drfs_iterator_pak* pIterator = iterator;
     assert(pIterator != NULL);
 
-    free(pIterator);
+    DRFS_FREE(pIterator);
 }
 
 static bool drfs_next_iteration__pak(drfs_handle archive, drfs_handle iterator, drfs_file_info* fi)
@@ -7121,7 +9831,7 @@ static drfs_result drfs_open_file__pak(drfs_handle archive, const char* relative
         if (strcmp(relativePath, pak->pFiles[iFile].name) == 0)
         {
             // We found the file.
-            drfs_openedfile_pak* pOpenedFile = malloc(sizeof(*pOpenedFile));
+            drfs_openedfile_pak* pOpenedFile = drfs_pool_alloc(&pak->openedFilePool);
             if (pOpenedFile != NULL)
             {
                 pOpenedFile->offsetInArchive = pak->pFiles[iFile].offset;
@@ -7140,12 +9850,13 @@ static drfs_result drfs_open_file__pak(drfs_handle archive, const char* relative
 
 static void drfs_close_file__pak(drfs_handle archive, drfs_handle file)
 {
-    (void)archive;
-
     drfs_openedfile_pak* pOpenedFile = file;
     assert(pOpenedFile != NULL);
 
-    free(pOpenedFile);
+    drfs_archive_pak* pak = archive;
+    assert(pak != NULL);
+
+    drfs_pool_free(&pak->openedFilePool, pOpenedFile);
 }
 
 static drfs_result drfs_read_file__pak(drfs_handle archive, drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
@@ -7351,6 +10062,9 @@ typedef struct
     // The number of files in the archive.
     unsigned int fileCount;
 
+    // The pool that drfs_openedfile_mtl objects are allocated from.
+    drfs_pool openedFilePool;
+
 }drfs_archive_mtl;
 
 typedef struct
@@ -7376,13 +10090,14 @@ typedef struct
 
 static drfs_archive_mtl* drfs_mtl_create(drfs_file* pArchiveFile, unsigned int accessMode)
 {
-    drfs_archive_mtl* mtl = malloc(sizeof(drfs_archive_mtl));
+    drfs_archive_mtl* mtl = DRFS_MALLOC(sizeof(drfs_archive_mtl));
     if (mtl != NULL)
     {
         mtl->pArchiveFile = pArchiveFile;
         mtl->accessMode   = accessMode;
         mtl->pFiles       = NULL;
         mtl->fileCount    = 0;
+        drfs_pool_init(&mtl->openedFilePool, sizeof(drfs_openedfile_mtl), 32);
     }
 
     return mtl;
@@ -7390,8 +10105,9 @@ static drfs_archive_mtl* drfs_mtl_create(drfs_file* pArchiveFile, unsigned int a
 
 static void drfs_mtl_delete(drfs_archive_mtl* pArchive)
 {
-    free(pArchive->pFiles);
-    free(pArchive);
+    drfs_pool_uninit(&pArchive->openedFilePool, NULL);
+    DRFS_FREE(pArchive->pFiles);
+    DRFS_FREE(pArchive);
 }
 
 static void drfs_mtl_addfile(drfs_archive_mtl* pArchive, drfs_file_mtl* pFile)
@@ -7399,7 +10115,7 @@ static void drfs_mtl_addfile(drfs_archive_mtl* pArchive, drfs_file_mtl* pFile)
     if (pArchive != NULL && pFile != NULL)
     {
         drfs_file_mtl* pOldBuffer = pArchive->pFiles;
-        drfs_file_mtl* pNewBuffer = malloc(sizeof(drfs_file_mtl) * (pArchive->fileCount + 1));
+        drfs_file_mtl* pNewBuffer = DRFS_MALLOC(sizeof(drfs_file_mtl) * (pArchive->fileCount + 1));
 
         if (pNewBuffer != 0)
         {
@@ -7412,7 +10128,7 @@ static void drfs_mtl_addfile(drfs_archive_mtl* pArchive, drfs_file_mtl* pFile)
             pArchive->pFiles     = pNewBuffer;
             pArchive->fileCount += 1;
 
-            free(pOldBuffer);
+            DRFS_FREE(pOldBuffer);
         }
     }
 }
@@ -7726,7 +10442,7 @@ static drfs_handle drfs_begin_iteration__mtl(drfs_handle archive, const char* re
     {
         if (relativePath[0] == '\0' || (relativePath[0] == '/' && relativePath[1] == '\0'))     // This is a flat archive, so no sub-folders.
         {
-            drfs_iterator_mtl* pIterator = malloc(sizeof(*pIterator));
+            drfs_iterator_mtl* pIterator = DRFS_MALLOC(sizeof(*pIterator));
             if (pIterator != NULL)
             {
                 pIterator->index = 0;
@@ -7743,7 +10459,7 @@ static void drfs_end_iteration__mtl(drfs_handle archive, drfs_handle iterator)
     (void)archive;
 
     drfs_iterator_mtl* pIterator = iterator;
-    free(pIterator);
+    DRFS_FREE(pIterator);
 }
 
 static bool drfs_next_iteration__mtl(drfs_handle archive, drfs_handle iterator, drfs_file_info* fi)
@@ -7791,7 +10507,7 @@ static drfs_result drfs_open_file__mtl(drfs_handle archive, const char* relative
         if (strcmp(relativePath, mtl->pFiles[iFile].name) == 0)
         {
             // We found the file.
-            drfs_openedfile_mtl* pOpenedFile = malloc(sizeof(drfs_openedfile_mtl));
+            drfs_openedfile_mtl* pOpenedFile = drfs_pool_alloc(&mtl->openedFilePool);
             if (pOpenedFile != NULL)
             {
                 pOpenedFile->offsetInArchive = mtl->pFiles[iFile].offset;
@@ -7809,12 +10525,13 @@ static drfs_result drfs_open_file__mtl(drfs_handle archive, const char* relative
 
 static void drfs_close_file__mtl(drfs_handle archive, drfs_handle file)
 {
-    (void)archive;
-
     drfs_openedfile_mtl* pOpenedFile = file;
     assert(pOpenedFile != NULL);
 
-    free(pOpenedFile);
+    drfs_archive_mtl* mtl = archive;
+    assert(mtl != NULL);
+
+    drfs_pool_free(&mtl->openedFilePool, pOpenedFile);
 }
 
 static drfs_result drfs_read_file__mtl(drfs_handle archive, drfs_handle file, void* pDataOut, size_t bytesToRead, size_t* pBytesReadOut)
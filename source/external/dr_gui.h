@@ -1411,6 +1411,12 @@ void drgui_register_dr_2d_callbacks(drgui_context* pContext, dr2d_context* pDraw
 #include <float.h>
 #include <math.h>
 
+// Define these to use a custom allocator. They must all be defined together.
+#ifndef DRGUI_MALLOC
+#define DRGUI_MALLOC(sz)            malloc((sz))
+#define DRGUI_FREE(p)               free((p))
+#endif
+
 #ifndef DRGUI_PRIVATE
 #define DRGUI_PRIVATE static
 #endif
@@ -1794,14 +1800,14 @@ void drgui_delete_context_for_real(drgui_context* pContext)
     // All elements marked as dead need to be deleted.
     drgui_delete_elements_marked_as_dead(pContext);
 
-    free(pContext);
+    DRGUI_FREE(pContext);
 }
 
 void drgui_delete_element_for_real(drgui_element* pElement)
 {
     assert(pElement != NULL);
 
-    free(pElement);
+    DRGUI_FREE(pElement);
 }
 
 
@@ -2419,7 +2425,7 @@ DRGUI_PRIVATE drgui_resource drgui_get_internal_font_by_scale(drgui_font* pFont,
     }
 
     drgui_resource* pOldInternalFonts = pFont->pInternalFonts;
-    drgui_resource* pNewInternalFonts = malloc(sizeof(*pNewInternalFonts) * (pFont->internalFontCount + 1));
+    drgui_resource* pNewInternalFonts = DRGUI_MALLOC(sizeof(*pNewInternalFonts) * (pFont->internalFontCount + 1));
 
     for (size_t i = 0; i < pFont->internalFontCount; ++i) {
         pNewInternalFonts[i] = pOldInternalFonts[i];
@@ -2430,7 +2436,7 @@ DRGUI_PRIVATE drgui_resource drgui_get_internal_font_by_scale(drgui_font* pFont,
     pFont->internalFontCount += 1;
 
 
-    free(pOldInternalFonts);
+    DRGUI_FREE(pOldInternalFonts);
     return internalFont;
 }
 
@@ -2443,7 +2449,7 @@ DRGUI_PRIVATE drgui_resource drgui_get_internal_font_by_scale(drgui_font* pFont,
 
 drgui_context* drgui_create_context()
 {
-    drgui_context* pContext = malloc(sizeof(drgui_context));
+    drgui_context* pContext = DRGUI_MALLOC(sizeof(drgui_context));
     if (pContext != NULL) {
         pContext->pPaintingContext                           = NULL;
         pContext->paintingCallbacks.drawBegin                = NULL;
@@ -2841,7 +2847,7 @@ drgui_element* drgui_create_element(drgui_context* pContext, drgui_element* pPar
 {
     if (pContext != NULL)
     {
-        drgui_element* pElement = (drgui_element*)malloc(sizeof(drgui_element) - sizeof(pElement->pExtraData) + extraDataSize);
+        drgui_element* pElement = (drgui_element*)DRGUI_MALLOC(sizeof(drgui_element) - sizeof(pElement->pExtraData) + extraDataSize);
         if (pElement != NULL)
         {
             pElement->pContext              = pContext;
@@ -4393,7 +4399,7 @@ drgui_font* drgui_create_font(drgui_context* pContext, const char* family, unsig
         return NULL;
     }
 
-    drgui_font* pFont = malloc(sizeof(drgui_font));
+    drgui_font* pFont = DRGUI_MALLOC(sizeof(drgui_font));
     if (pFont == NULL) {
         return NULL;
     }
@@ -4405,7 +4411,7 @@ drgui_font* drgui_create_font(drgui_context* pContext, const char* family, unsig
     pFont->slant             = slant;
     pFont->rotation          = rotation;
     pFont->internalFontCount = 1;
-    pFont->pInternalFonts    = malloc(sizeof(drgui_resource) * pFont->internalFontCount);
+    pFont->pInternalFonts    = DRGUI_MALLOC(sizeof(drgui_resource) * pFont->internalFontCount);
     pFont->pInternalFonts[0] = internalFont;
 
     if (family != NULL) {
@@ -4430,8 +4436,8 @@ void drgui_delete_font(drgui_font* pFont)
         }
     }
 
-    free(pFont->pInternalFonts);
-    free(pFont);
+    DRGUI_FREE(pFont->pInternalFonts);
+    DRGUI_FREE(pFont);
 }
 
 bool drgui_get_font_metrics(drgui_font* pFont, float scaleX, float scaleY, drgui_font_metrics* pMetricsOut)
@@ -4643,7 +4649,7 @@ drgui_image* drgui_create_image(drgui_context* pContext, unsigned int width, uns
         return NULL;
     }
 
-    drgui_image* pImage = malloc(sizeof(*pImage));
+    drgui_image* pImage = DRGUI_MALLOC(sizeof(*pImage));
     if (pImage == NULL) {
         return NULL;
     }
@@ -4669,7 +4675,7 @@ void drgui_delete_image(drgui_image* pImage)
     }
 
     // Free the font object last.
-    free(pImage);
+    DRGUI_FREE(pImage);
 }
 
 void drgui_get_image_size(drgui_image* pImage, unsigned int* pWidthOut, unsigned int* pHeightOut)
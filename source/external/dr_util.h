@@ -1843,7 +1843,7 @@ typedef struct
     void* pData;
 
     /// Set to true by the entry function. We use this to wait for the entry function to start.
-    bool isInEntryProc;
+    volatile bool isInEntryProc;
 
 } drutil_thread_win32;
 
@@ -1989,7 +1989,7 @@ typedef struct
     void* pData;
 
     /// Set to true by the entry function. We use this to wait for the entry function to start.
-    bool isInEntryProc;
+    volatile bool isInEntryProc;
 
 } drutil_thread_posix;
 
@@ -2047,6 +2047,12 @@ void dr_wait_thread(dr_thread thread)
     }
 }
 
+void dr_wait_and_delete_thread(dr_thread thread)
+{
+    dr_wait_thread(thread);
+    dr_delete_thread(thread);
+}
+
 
 
 dr_mutex drutil_create_mutex()
@@ -2063,6 +2069,7 @@ dr_mutex drutil_create_mutex()
 void dr_delete_mutex(dr_mutex mutex)
 {
     pthread_mutex_destroy(mutex);
+    free(mutex);
 }
 
 void dr_lock_mutex(dr_mutex mutex)
@@ -2090,7 +2097,8 @@ dr_semaphore dr_create_semaphore(int initialValue)
 
 void dr_delete_semaphore(dr_semaphore semaphore)
 {
-    sem_close(semaphore);
+    sem_destroy(semaphore);     // <-- Not sem_close() which is for named semaphores.
+    free(semaphore);
 }
 
 bool dr_wait_semaphore(dr_semaphore semaphore)
@@ -3303,6 +3303,13 @@ PFN_vkDebugReportMessageEXT vkDebugReportMessageEXT;
 //
 ///////////////////////////////////////////////////////////////////////////////
 #ifdef DR_VULKAN_IMPLEMENTATION
+
+// Define these to use a custom allocator. They must all be defined together.
+#ifndef DRVK_MALLOC
+#define DRVK_MALLOC(sz)             malloc((sz))
+#define DRVK_FREE(p)                free((p))
+#endif
+
 static unsigned int g_drvkInitCount = 0;
 static VkFlags g_drvkInitFlags = 0;
 
@@ -3670,7 +3677,7 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
         return NULL;
     }
 
-    pPhysicalDevices = malloc(sizeof(VkPhysicalDevice) * deviceCount);
+    pPhysicalDevices = DRVK_MALLOC(sizeof(VkPhysicalDevice) * deviceCount);
     if (pPhysicalDevices == NULL) {
         goto on_error;
     }
@@ -3680,14 +3687,14 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
     }
 
 
-    pDevices = malloc(sizeof(*pDevices) * deviceCount);
+    pDevices = DRVK_MALLOC(sizeof(*pDevices) * deviceCount);
     if (pDevices == NULL) {
         goto on_error;
     }
 
 
     // Logical devices. This abstraction creates one logical device per physical device.
-    pLogicalDevices = malloc(sizeof(VkDevice) * deviceCount);
+    pLogicalDevices = DRVK_MALLOC(sizeof(VkDevice) * deviceCount);
     if (pLogicalDevices == NULL) {
         goto on_error;
     }
@@ -3702,7 +3709,7 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
         uint32_t queueFamilyCount;
         vkGetPhysicalDeviceQueueFamilyProperties(pPhysicalDevices[iDevice], &queueFamilyCount, NULL);
 
-        pQueueFamilyProps = malloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
+        pQueueFamilyProps = DRVK_MALLOC(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
         if (pQueueFamilyProps == NULL) {
             goto on_create_device_error;
         }
@@ -3710,12 +3717,12 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
         vkGetPhysicalDeviceQueueFamilyProperties(pPhysicalDevices[iDevice], &queueFamilyCount, pQueueFamilyProps);
 
 
-        pQueuePriorities = malloc(sizeof(float) * queueFamilyCount);
+        pQueuePriorities = DRVK_MALLOC(sizeof(float) * queueFamilyCount);
         if (pQueuePriorities == NULL) {
             goto on_create_device_error;
         }
 
-        pDeviceQueueInfo = malloc(sizeof(VkDeviceQueueCreateInfo) * queueFamilyCount);
+        pDeviceQueueInfo = DRVK_MALLOC(sizeof(VkDeviceQueueCreateInfo) * queueFamilyCount);
         if (pDeviceQueueInfo == NULL) {
             goto on_create_device_error;
         }
@@ -3756,13 +3763,13 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
         }
 
         pDevices[iDevice].queueCount = queueCount;
-        pDevices[iDevice].pQueues = malloc(sizeof(drvk_queue) * queueCount);
+        pDevices[iDevice].pQueues = DRVK_MALLOC(sizeof(drvk_queue) * queueCount);
         if (pDevices[iDevice].pQueues == NULL) {
             goto on_create_device_error;
         }
 
         pDevices[iDevice].commandPoolCount = queueFamilyCount;
-        pDevices[iDevice].pCommandPools = malloc(sizeof(VkCommandPool) * queueFamilyCount);
+        pDevices[iDevice].pCommandPools = DRVK_MALLOC(sizeof(VkCommandPool) * queueFamilyCount);
 
 
         uint32_t iRunningQueue = 0;
@@ -3807,15 +3814,15 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
             vkDestroyDevice(pDevices[iPrevDevice].vkDevice, NULL);
         }
 
-        free(pQueuePriorities);
-        free(pDeviceQueueInfo);
-        free(pQueueFamilyProps);
+        DRVK_FREE(pQueuePriorities);
+        DRVK_FREE(pDeviceQueueInfo);
+        DRVK_FREE(pQueueFamilyProps);
         goto on_error;
     }
 
 
     // At this point we should have our devices and queues all ready to go which means we can now create our main context object and return.
-    drvk_context* pContext = malloc(sizeof(*pContext));
+    drvk_context* pContext = DRVK_MALLOC(sizeof(*pContext));
     if (pContext == NULL) {
         goto on_error;
     }
@@ -3828,9 +3835,9 @@ drvk_context* drvkCreateContext(const VkApplicationInfo* pApplicationInfo)
 
 
 on_error:
-    free(pPhysicalDevices);
-    free(pLogicalDevices);
-    free(pDevices);
+    DRVK_FREE(pPhysicalDevices);
+    DRVK_FREE(pLogicalDevices);
+    DRVK_FREE(pDevices);
     vkDestroyInstance(instance, NULL);
     drvkUninit();
     return NULL;
@@ -3845,11 +3852,11 @@ void drvkDeleteContext(drvk_context* pVulkan)
 
     for (uint32_t i = 0; i < pVulkan->deviceCount; ++i) {
         vkDestroyDevice(pVulkan->pDevices[i].vkDevice, NULL);
-        free(pVulkan->pDevices[i].pQueues);
+        DRVK_FREE(pVulkan->pDevices[i].pQueues);
     }
 
-    free(pVulkan->pDevices);
-    free(pVulkan);
+    DRVK_FREE(pVulkan->pDevices);
+    DRVK_FREE(pVulkan);
     drvkUninit();
 }
 
@@ -258,6 +258,12 @@ drwav* drwav_open_memory(const void* data, size_t dataSize);
 #include <limits.h>
 #include <assert.h>
 
+// Define these to use a custom allocator. They must all be defined together.
+#ifndef DRWAV_MALLOC
+#define DRWAV_MALLOC(sz)            malloc((sz))
+#define DRWAV_FREE(p)               free((p))
+#endif
+
 #ifndef DR_WAV_NO_STDIO
 #include <stdio.h>
 #endif
@@ -441,7 +447,7 @@ static int drwav__on_seek_memory(void* pUserData, int offset)
 
 drwav* drwav_open_memory(const void* data, size_t dataSize)
 {
-    drwav_memory* pUserData = malloc(sizeof(*pUserData));
+    drwav_memory* pUserData = DRWAV_MALLOC(sizeof(*pUserData));
     if (pUserData == NULL) {
         return NULL;
     }
@@ -536,7 +542,7 @@ drwav* drwav_open(drwav_read_proc onRead, drwav_seek_proc onSeek, void* pUserDat
 
     // At this point we should be sitting on the first byte of the raw audio data.
 
-    drwav* pWav = malloc(sizeof(*pWav));
+    drwav* pWav = DRWAV_MALLOC(sizeof(*pWav));
     if (pWav == NULL) {
         return NULL;
     }
@@ -572,10 +578,10 @@ void drwav_close(drwav* pWav)
 
     // If we opened the file with drwav_open_memory() we will want to free() the user data.
     if (pWav->onRead == drwav__on_read_memory && pWav->onSeek == drwav__on_seek_memory) {
-        free(pWav->pUserData);
+        DRWAV_FREE(pWav->pUserData);
     }
 
-    free(pWav);
+    DRWAV_FREE(pWav);
 }
 
 